@@ -10,10 +10,13 @@
 #include <benchmark/benchmark.h>
 
 #include <kcenon/file_transfer/core/compression_engine.h>
+#include <kcenon/file_transfer/core/stream_compression.h>
 
 #include "utils/benchmark_helpers.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <span>
 #include <vector>
 
 namespace kcenon::file_transfer::benchmark {
@@ -261,6 +264,98 @@ static void BM_Adaptive_Compression_Full(::benchmark::State& state) {
                            static_cast<int64_t>(state.iterations()));
 }
 
+/// Size of the corpus the chunk benchmarks split
+constexpr std::size_t chunked_corpus_size = 4 * sizes::MB;
+
+/**
+ * @brief Corpus for the chunk benchmarks: 0 = log lines, 1 = CSV rows
+ */
+static auto chunked_corpus(int64_t kind) -> std::vector<std::byte> {
+    return kind == 0 ? test_data_generator::generate_log_data(chunked_corpus_size, 42)
+                     : test_data_generator::generate_csv_data(chunked_corpus_size, 42);
+}
+
+/**
+ * @brief Benchmark compressing a transfer chunk by chunk, each on its own
+ *
+ * Baseline for BM_Stream_Compression: the same corpus, chunk sizes and
+ * adaptive mode.
+ */
+static void BM_Chunk_Compression_Independent(::benchmark::State& state) {
+    const auto chunk_size = static_cast<std::size_t>(state.range(0));
+    auto data = chunked_corpus(state.range(1));
+
+    compression_engine engine(compression_level::fast);
+
+    std::size_t wire_bytes = 0;
+    for (auto _ : state) {
+        wire_bytes = 0;
+        for (std::size_t offset = 0; offset < data.size(); offset += chunk_size) {
+            auto piece = std::span<const std::byte>(data).subspan(
+                offset, std::min(chunk_size, data.size() - offset));
+            auto result = engine.compress_adaptive(piece, compression_mode::adaptive);
+            if (!result) {
+                state.SkipWithError("Compression failed");
+                return;
+            }
+            wire_bytes += std::min(result.value().first.size(), piece.size());
+            ::benchmark::DoNotOptimize(result.value());
+        }
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(data.size()) *
+                           static_cast<int64_t>(state.iterations()));
+    state.counters["ratio"] = ::benchmark::Counter(
+        static_cast<double>(data.size()) / static_cast<double>(wire_bytes));
+}
+
+/**
+ * @brief Benchmark compressing a transfer's chunks as one stream
+ *
+ * Each chunk may refer to the 64KB before it, with the history starting
+ * over every 16 chunks. Small chunks gain the most.
+ */
+static void BM_Stream_Compression(::benchmark::State& state) {
+    const auto chunk_size = static_cast<std::size_t>(state.range(0));
+    auto data = chunked_corpus(state.range(1));
+
+    std::vector<chunk> chunks;
+    for (std::size_t offset = 0; offset < data.size(); offset += chunk_size) {
+        auto size = std::min(chunk_size, data.size() - offset);
+        chunk c;
+        c.header.chunk_index = chunks.size();
+        c.header.chunk_offset = offset;
+        c.header.original_size = static_cast<uint32_t>(size);
+        c.header.compressed_size = static_cast<uint32_t>(size);
+        c.data.assign(data.begin() + static_cast<std::ptrdiff_t>(offset),
+                      data.begin() + static_cast<std::ptrdiff_t>(offset + size));
+        chunks.push_back(std::move(c));
+    }
+
+    std::size_t wire_bytes = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto batch = chunks;
+        stream_compressor compressor;
+        state.ResumeTiming();
+
+        wire_bytes = 0;
+        for (auto& c : batch) {
+            if (!compressor.compress(c)) {
+                state.SkipWithError("Compression failed");
+                return;
+            }
+            wire_bytes += c.data.size();
+        }
+        ::benchmark::DoNotOptimize(batch);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(data.size()) *
+                           static_cast<int64_t>(state.iterations()));
+    state.counters["ratio"] = ::benchmark::Counter(
+        static_cast<double>(data.size()) / static_cast<double>(wire_bytes));
+}
+
 // Register compression benchmarks
 
 // LZ4 Fast Compression - various sizes
@@ -321,4 +416,17 @@ BENCHMARK(BM_Adaptive_Compression_Full)
     ->Args({static_cast<int64_t>(1 * sizes::MB), 100})  // Highly compressible
     ->Unit(::benchmark::kMillisecond);
 
+// Chunked transfer: {chunk size, corpus (0 = log, 1 = CSV)}
+BENCHMARK(BM_Chunk_Compression_Independent)
+    ->ArgsProduct({{static_cast<int64_t>(4 * sizes::KB), static_cast<int64_t>(16 * sizes::KB),
+                    static_cast<int64_t>(64 * sizes::KB), static_cast<int64_t>(256 * sizes::KB)},
+                   {0, 1}})
+    ->Unit(::benchmark::kMillisecond);
+
+BENCHMARK(BM_Stream_Compression)
+    ->ArgsProduct({{static_cast<int64_t>(4 * sizes::KB), static_cast<int64_t>(16 * sizes::KB),
+                    static_cast<int64_t>(64 * sizes::KB), static_cast<int64_t>(256 * sizes::KB)},
+                   {0, 1}})
+    ->Unit(::benchmark::kMillisecond);
+
 }  // namespace kcenon::file_transfer::benchmark
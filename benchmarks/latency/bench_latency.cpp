@@ -9,6 +9,7 @@
 
 #include <benchmark/benchmark.h>
 
+#include <kcenon/file_transfer/core/chunk_splitter.h>
 #include <kcenon/file_transfer/file_transfer.h>
 
 #include "utils/benchmark_helpers.h"
@@ -361,6 +362,41 @@ static void BM_Upload_TTFB(::benchmark::State& state) {
                            static_cast<int64_t>(state.iterations()));
 }
 
+/**
+ * @brief Time until the first upload chunk is ready on the sending side
+ *
+ * Compares the two ways an uploader can obtain the SHA-256 it must send:
+ * hashing the whole file before the UPLOAD_REQUEST (arg 1 = 0), or
+ * hashing while streaming and sending the digest with UPLOAD_COMPLETE
+ * (arg 1 = 1, transfer_options::deferred_digest). The first grows with the
+ * file size; the second stays at the cost of reading one chunk.
+ */
+static void BM_Upload_TTFB_Source(::benchmark::State& state) {
+    const auto file_size = static_cast<std::size_t>(state.range(0));
+    const bool single_pass = state.range(1) != 0;
+
+    temp_file_manager temp_files;
+    auto test_file = temp_files.create_random_file("ttfb_source.bin", file_size, 42);
+    chunk_splitter splitter;
+
+    for (auto _ : state) {
+        auto metadata = splitter.calculate_metadata(test_file, !single_pass);
+        auto iterator = splitter.split(test_file, transfer_id::generate(), single_pass);
+        if (!metadata || !iterator) {
+            state.SkipWithError("Failed to open file");
+            return;
+        }
+        auto first = iterator.value().next();
+        if (!first) {
+            state.SkipWithError("Failed to read first chunk");
+            return;
+        }
+        ::benchmark::DoNotOptimize(first.value().data.data());
+    }
+
+    state.SetLabel(single_pass ? "single-pass" : "pre-pass");
+}
+
 /**
  * @brief Benchmark for time to first byte (TTFB) - download
  */
@@ -521,6 +557,12 @@ BENCHMARK(BM_Upload_TTFB)
     ->Unit(::benchmark::kMillisecond)
     ->UseManualTime();
 
+BENCHMARK(BM_Upload_TTFB_Source)
+    ->ArgsProduct({{static_cast<int64_t>(1 * sizes::MB), static_cast<int64_t>(16 * sizes::MB),
+                    static_cast<int64_t>(256 * sizes::MB)},
+                   {0, 1}})
+    ->Unit(::benchmark::kMillisecond);
+
 BENCHMARK(BM_Download_TTFB)
     ->Arg(static_cast<int64_t>(64 * sizes::KB))
     ->Arg(static_cast<int64_t>(256 * sizes::KB))
@@ -7,14 +7,19 @@
  * - Linear performance scaling with concurrent connections
  * - Consistent performance across file sizes
  * - Long-running memory stability
+ * - Bounded thread count for 1000 concurrent async storage requests
  */
 
 #include <benchmark/benchmark.h>
 
+#include <kcenon/file_transfer/core/io_executor.h>
+#include <kcenon/file_transfer/core/transfer_registry.h>
 #include <kcenon/file_transfer/file_transfer.h>
+#include <kcenon/file_transfer/server/storage_manager.h>
 
 #include "utils/benchmark_helpers.h"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
@@ -23,6 +28,9 @@
 #include <future>
 #include <mutex>
 #include <random>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
 #include <thread>
 #include <vector>
 
@@ -68,6 +76,60 @@ auto get_memory_usage() -> std::size_t {
 #endif
 }
 
+/**
+ * @brief Get the current number of threads in the process
+ */
+auto get_thread_count() -> std::size_t {
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("Threads:", 0) == 0) {
+            return static_cast<std::size_t>(std::stoul(line.substr(8)));
+        }
+    }
+#endif
+    return 0;
+}
+
+/**
+ * @brief Samples the process thread count until stopped
+ */
+class thread_count_sampler {
+public:
+    thread_count_sampler() : thread_([this] { run(); }) {}
+
+    ~thread_count_sampler() { stop(); }
+
+    auto stop() -> std::size_t {
+        running_ = false;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        return peak_;
+    }
+
+private:
+    void run() {
+        while (running_) {
+            peak_ = std::max(peak_.load(), get_thread_count());
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    }
+
+    std::atomic<bool> running_{true};
+    std::atomic<std::size_t> peak_{0};
+    std::thread thread_;
+};
+
+auto percentile_ms(std::vector<double>& samples, double fraction) -> double {
+    if (samples.empty()) return 0.0;
+    auto index = static_cast<std::size_t>(fraction * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(index),
+                     samples.end());
+    return samples[index];
+}
+
 /**
  * @brief Helper class for scalability benchmark fixture
  */
@@ -654,6 +716,149 @@ static void BM_Scalability_ConcurrentUploads(::benchmark::State& state) {
                            static_cast<int64_t>(state.iterations()));
 }
 
+/**
+ * @brief Dispatch N concurrent local store requests and report threads and latency
+ *
+ * state.range(1) selects the dispatch: 0 = one std::async thread per call
+ * (the previous *_async implementation), 1 = the shared io_executor.
+ */
+static void BM_Scalability_AsyncStorageDispatch(::benchmark::State& state) {
+    const auto num_requests = static_cast<std::size_t>(state.range(0));
+    const bool use_executor = state.range(1) != 0;
+    constexpr std::size_t payload_size = 4 * sizes::KB;
+
+    auto base_dir = std::filesystem::temp_directory_path() /
+                    ("bench_async_dispatch_" + std::to_string(std::random_device{}()));
+    auto backend_ptr = local_storage_backend::create(base_dir);
+    if (!backend_ptr || !backend_ptr->connect().has_value()) {
+        state.SkipWithError("Failed to connect local storage");
+        return;
+    }
+    auto& backend = *backend_ptr;
+
+    std::vector<std::byte> payload(payload_size, std::byte{0x5a});
+    store_options options;
+    options.overwrite = true;
+
+    for (auto _ : state) {
+        std::vector<double> latencies_ms(num_requests, 0.0);
+        std::atomic<std::size_t> failures{0};
+
+        thread_count_sampler sampler;
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::future<void>> futures;
+        futures.reserve(num_requests);
+        for (std::size_t i = 0; i < num_requests; ++i) {
+            auto submitted = std::chrono::steady_clock::now();
+            auto request = [&, i, submitted] {
+                auto res = backend.store("req_" + std::to_string(i) + ".bin", payload, options);
+                if (!res.has_value()) {
+                    ++failures;
+                }
+                latencies_ms[i] = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - submitted).count();
+            };
+
+            if (use_executor) {
+                futures.push_back(io_executor::shared().submit("bench.local", request));
+            } else {
+                futures.push_back(std::async(std::launch::async, request));
+            }
+        }
+        for (auto& future : futures) {
+            future.wait();
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        auto peak_threads = sampler.stop();
+        state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+
+        state.counters["peak_threads"] = static_cast<double>(peak_threads);
+        state.counters["p50_latency_ms"] = percentile_ms(latencies_ms, 0.50);
+        state.counters["p99_latency_ms"] = percentile_ms(latencies_ms, 0.99);
+        state.counters["failures"] = static_cast<double>(failures.load());
+    }
+
+    (void)backend.disconnect();
+    std::error_code ec;
+    std::filesystem::remove_all(base_dir, ec);
+}
+
+/**
+ * @brief Per-chunk transfer lookups from many threads across 1000 transfers
+ *
+ * Each lookup finds a transfer's state and updates it under the state's own
+ * lock, as chunk_assembler::process_chunk does. state.range(1) selects the
+ * registry: 0 = one std::unordered_map behind a std::shared_mutex (the
+ * previous layout), 1 = the sharded transfer_registry.
+ */
+static void BM_Scalability_TransferRegistryContention(::benchmark::State& state) {
+    constexpr std::size_t num_transfers = 1000;
+    constexpr std::size_t lookups_per_thread = 200'000;
+    const auto num_threads = static_cast<std::size_t>(state.range(0));
+    const bool sharded = state.range(1) != 0;
+
+    struct transfer_entry {
+        std::mutex mutex;
+        uint64_t chunks = 0;
+    };
+
+    std::vector<transfer_id> ids(num_transfers);
+    std::unordered_map<transfer_id, std::shared_ptr<transfer_entry>> global_map;
+    std::shared_mutex global_mutex;
+    transfer_registry<transfer_entry> registry;
+    for (auto& id : ids) {
+        id = transfer_id::generate();
+        auto entry = std::make_shared<transfer_entry>();
+        global_map.emplace(id, entry);
+        registry.insert(id, entry);
+    }
+
+    auto find = [&](const transfer_id& id) -> std::shared_ptr<transfer_entry> {
+        if (sharded) {
+            return registry.find(id);
+        }
+        std::shared_lock lock(global_mutex);
+        auto it = global_map.find(id);
+        return it != global_map.end() ? it->second : nullptr;
+    };
+
+    for (auto _ : state) {
+        std::atomic<bool> go{false};
+        std::vector<std::thread> threads;
+        threads.reserve(num_threads);
+        for (std::size_t t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t] {
+                std::mt19937 rng(static_cast<uint32_t>(t));
+                std::uniform_int_distribution<std::size_t> pick(0, num_transfers - 1);
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                for (std::size_t i = 0; i < lookups_per_thread; ++i) {
+                    if (auto entry = find(ids[pick(rng)])) {
+                        std::lock_guard lock(entry->mutex);
+                        ++entry->chunks;
+                    }
+                }
+            });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+        state.SetIterationTime(elapsed.count());
+
+        state.counters["lookups_per_sec"] =
+            static_cast<double>(num_threads * lookups_per_thread) / elapsed.count();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(num_threads * lookups_per_thread) *
+                            static_cast<int64_t>(state.iterations()));
+}
+
 // Register scalability benchmarks
 
 BENCHMARK(BM_Scalability_ConcurrentConnections)
@@ -701,4 +906,19 @@ BENCHMARK(BM_Scalability_ConcurrentUploads)
     ->UseManualTime()
     ->Iterations(3);
 
+BENCHMARK(BM_Scalability_AsyncStorageDispatch)
+    ->Args({1000, 0})   // std::async per request
+    ->Args({1000, 1})   // shared io_executor
+    ->ArgNames({"requests", "executor"})
+    ->Unit(::benchmark::kMillisecond)
+    ->UseManualTime()
+    ->Iterations(3);
+
+BENCHMARK(BM_Scalability_TransferRegistryContention)
+    ->ArgsProduct({{1, 4, 16, 64}, {0, 1}})   // threads x (global map, sharded registry)
+    ->ArgNames({"threads", "sharded"})
+    ->Unit(::benchmark::kMillisecond)
+    ->UseManualTime()
+    ->Iterations(3);
+
 }  // namespace kcenon::file_transfer::benchmark
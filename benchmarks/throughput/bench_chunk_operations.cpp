@@ -11,12 +11,40 @@
 
 #include "utils/benchmark_helpers.h"
 
+#include <array>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <memory>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#define FILE_TRANS_BENCH_HAS_TSC 1
+#endif
+
 namespace kcenon::file_transfer::benchmark {
 
+/**
+ * @brief Time stamp counter, in reference cycles; 0 where there is none
+ */
+static auto read_cycles() -> uint64_t {
+#ifdef FILE_TRANS_BENCH_HAS_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Report bytes per reference cycle, where a cycle counter exists
+ */
+static void report_bytes_per_cycle(::benchmark::State& state, uint64_t bytes, uint64_t cycles) {
+    if (cycles > 0) {
+        state.counters["bytes_per_cycle"] =
+            static_cast<double>(bytes) / static_cast<double>(cycles);
+    }
+}
+
 /**
  * @brief Benchmark for chunk_splitter with various file sizes
  */
@@ -187,6 +215,79 @@ static void BM_Checksum_SHA256_File(::benchmark::State& state) {
                            static_cast<int64_t>(state.iterations()));
 }
 
+/**
+ * @brief CRC32 and byte histogram as the read stage used to get them: two passes
+ */
+static void BM_Checksum_CRC32ThenHistogram(::benchmark::State& state) {
+    const auto data_size = static_cast<std::size_t>(state.range(0));
+    auto data = test_data_generator::generate_random_data(data_size, 42);
+
+    uint64_t cycles = 0;
+    for (auto _ : state) {
+        auto start = read_cycles();
+        auto crc = checksum::crc32(data);
+        std::array<uint64_t, 256> histogram{};
+        for (auto b : data) {
+            ++histogram[static_cast<uint8_t>(b)];
+        }
+        cycles += read_cycles() - start;
+        ::benchmark::DoNotOptimize(crc);
+        ::benchmark::DoNotOptimize(histogram);
+    }
+
+    auto bytes = static_cast<uint64_t>(data_size) * state.iterations();
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    report_bytes_per_cycle(state, bytes, cycles);
+}
+
+/**
+ * @brief CRC32 and byte histogram from the fused single-pass kernel
+ */
+static void BM_Checksum_FusedScan(::benchmark::State& state) {
+    const auto data_size = static_cast<std::size_t>(state.range(0));
+    auto data = test_data_generator::generate_random_data(data_size, 42);
+
+    uint64_t cycles = 0;
+    for (auto _ : state) {
+        auto start = read_cycles();
+        auto scan = checksum::scan(data);
+        auto entropy = scan.entropy();
+        cycles += read_cycles() - start;
+        ::benchmark::DoNotOptimize(scan);
+        ::benchmark::DoNotOptimize(entropy);
+    }
+
+    auto bytes = static_cast<uint64_t>(data_size) * state.iterations();
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    report_bytes_per_cycle(state, bytes, cycles);
+}
+
+/**
+ * @brief Chunk digest with each integrity algorithm; range(1) is a chunk_integrity
+ */
+static void BM_Checksum_Integrity(::benchmark::State& state) {
+    const auto data_size = static_cast<std::size_t>(state.range(0));
+    const auto algorithm = static_cast<chunk_integrity>(state.range(1));
+    if (!checksum::is_supported(algorithm)) {
+        state.SkipWithError("algorithm not built in");
+        return;
+    }
+    auto data = test_data_generator::generate_random_data(data_size, 42);
+
+    uint64_t cycles = 0;
+    for (auto _ : state) {
+        auto start = read_cycles();
+        auto digest = checksum::digest(algorithm, data);
+        cycles += read_cycles() - start;
+        ::benchmark::DoNotOptimize(digest);
+    }
+
+    auto bytes = static_cast<uint64_t>(data_size) * state.iterations();
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    state.SetLabel(to_string(algorithm));
+    report_bytes_per_cycle(state, bytes, cycles);
+}
+
 // Register benchmarks with various sizes
 
 // Chunk Splitter benchmarks
@@ -213,6 +314,27 @@ BENCHMARK(BM_Checksum_CRC32)
     ->Arg(static_cast<int64_t>(1 * sizes::MB))
     ->Unit(::benchmark::kMicrosecond);
 
+// Fused read-stage kernel vs. separate passes
+BENCHMARK(BM_Checksum_CRC32ThenHistogram)
+    ->Arg(static_cast<int64_t>(64 * sizes::KB))
+    ->Arg(static_cast<int64_t>(256 * sizes::KB))
+    ->Arg(static_cast<int64_t>(1 * sizes::MB))
+    ->Unit(::benchmark::kMicrosecond);
+
+BENCHMARK(BM_Checksum_FusedScan)
+    ->Arg(static_cast<int64_t>(64 * sizes::KB))
+    ->Arg(static_cast<int64_t>(256 * sizes::KB))
+    ->Arg(static_cast<int64_t>(1 * sizes::MB))
+    ->Unit(::benchmark::kMicrosecond);
+
+// Integrity algorithms side by side
+BENCHMARK(BM_Checksum_Integrity)
+    ->ArgsProduct({{static_cast<int64_t>(64 * sizes::KB), static_cast<int64_t>(1 * sizes::MB)},
+                   {static_cast<int64_t>(chunk_integrity::crc32),
+                    static_cast<int64_t>(chunk_integrity::crc32c),
+                    static_cast<int64_t>(chunk_integrity::xxh3_64)}})
+    ->Unit(::benchmark::kMicrosecond);
+
 // SHA-256 benchmarks
 BENCHMARK(BM_Checksum_SHA256)
     ->Arg(static_cast<int64_t>(1 * sizes::KB))
@@ -0,0 +1,255 @@
+/**
+ * @file bench_server_receive_pipeline.cpp
+ * @brief Benchmarks for the server upload receive path
+ *
+ * Replays a pre-encoded CHUNK_DATA frame stream through the same steps the
+ * server runs per connection: frame decoding, chunk decoding, pipeline
+ * submission with the upload window, CRC verification and assembler writes.
+ * The socket is the only part left out, so the result is the server-side
+ * ceiling against the LAN throughput target.
+ *
+ * A second benchmark measures small-upload latency under a competing bulk
+ * upload to check the pipeline's per-client fair scheduling.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <kcenon/file_transfer/core/checksum.h>
+#include <kcenon/file_transfer/core/chunk_assembler.h>
+#include <kcenon/file_transfer/core/frame_codec.h>
+#include <kcenon/file_transfer/server/server_pipeline.h>
+
+#include "utils/benchmark_helpers.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace kcenon::file_transfer::benchmark {
+
+namespace {
+
+// Socket read size used to slice the frame stream
+constexpr std::size_t read_size = 64 * sizes::KB;
+
+auto build_frame_stream(const transfer_id& id, const std::vector<std::byte>& data,
+                        std::size_t chunk_size) -> std::vector<uint8_t> {
+    std::vector<uint8_t> stream;
+    uint64_t index = 0;
+    for (std::size_t offset = 0; offset < data.size(); offset += chunk_size, ++index) {
+        auto size = std::min(chunk_size, data.size() - offset);
+        chunk c;
+        c.header.id = id;
+        c.header.chunk_index = index;
+        c.header.chunk_offset = offset;
+        c.data.assign(data.begin() + static_cast<std::ptrdiff_t>(offset),
+                      data.begin() + static_cast<std::ptrdiff_t>(offset + size));
+        c.header.original_size = static_cast<uint32_t>(size);
+        c.header.compressed_size = static_cast<uint32_t>(size);
+        c.header.checksum = checksum::crc32(c.data);
+        if (offset + size == data.size()) {
+            c.header.flags = chunk_flags::last_chunk;
+        }
+        auto f = encode_frame(message_type::chunk_data, encode_chunk_data(c));
+        stream.insert(stream.end(), f.begin(), f.end());
+    }
+    return stream;
+}
+
+}  // namespace
+
+/**
+ * @brief Decode, verify and store an upload received as a frame stream
+ */
+static void BM_ServerReceive_Pipeline(::benchmark::State& state) {
+    const auto file_size = static_cast<std::size_t>(state.range(0));
+    const auto chunk_size = static_cast<std::size_t>(state.range(1));
+    const auto total_chunks = (file_size + chunk_size - 1) / chunk_size;
+
+    temp_file_manager temp_files;
+    auto data = test_data_generator::generate_random_data(file_size, 42);
+    auto stream_id = transfer_id::generate();
+    auto stream = build_frame_stream(stream_id, data, chunk_size);
+
+    auto assembler = std::make_shared<chunk_assembler>(temp_files.base_dir());
+    auto pipeline_result = server_pipeline::create(pipeline_config::auto_detect());
+    if (!pipeline_result) {
+        state.SkipWithError("Failed to create pipeline");
+        return;
+    }
+    auto& pipeline = pipeline_result.value();
+    pipeline.set_chunk_assembler(assembler);
+
+    std::mutex mutex;
+    std::condition_variable written_cv;
+    uint64_t written = 0;
+    pipeline.on_stage_complete([&](pipeline_stage stage, const pipeline_chunk&) {
+        if (stage == pipeline_stage::file_write) {
+            std::lock_guard lock(mutex);
+            ++written;
+            written_cv.notify_one();
+        }
+    });
+    if (!pipeline.start()) {
+        state.SkipWithError("Failed to start pipeline");
+        return;
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        // The stream is pre-encoded with one ID; give each pass its own session
+        auto id = transfer_id::generate();
+        if (!assembler->start_session(id, "upload.bin", file_size, total_chunks)) {
+            state.SkipWithError("Failed to start assembly session");
+            break;
+        }
+        written = 0;
+        state.ResumeTiming();
+
+        frame_decoder decoder;
+        for (std::size_t pos = 0; pos < stream.size(); pos += read_size) {
+            auto len = std::min(read_size, stream.size() - pos);
+            decoder.feed(std::span<const uint8_t>(stream.data() + pos, len));
+            while (auto f = decoder.next()) {
+                auto c = decode_chunk_data(f->payload);
+                if (!c) {
+                    state.SkipWithError("Failed to decode chunk");
+                    break;
+                }
+                pipeline_chunk pc;
+                pc.id = id;
+                pc.chunk_index = c.value().header.chunk_index;
+                pc.chunk_offset = c.value().header.chunk_offset;
+                pc.checksum = c.value().header.checksum;
+                pc.is_compressed = false;
+                pc.original_size = c.value().header.original_size;
+                pc.data = std::move(c.value().data);
+                if (!pipeline.submit_upload_chunk(std::move(pc), std::chrono::seconds(30))) {
+                    state.SkipWithError("Pipeline stalled");
+                    break;
+                }
+            }
+        }
+
+        {
+            std::unique_lock lock(mutex);
+            written_cv.wait(lock, [&] { return written == total_chunks; });
+        }
+        auto finalized = assembler->finalize(id);
+        if (!finalized) {
+            state.SkipWithError("Failed to finalize upload");
+            break;
+        }
+
+        state.PauseTiming();
+        std::error_code ec;
+        std::filesystem::remove(finalized.value(), ec);
+        state.ResumeTiming();
+    }
+
+    (void)pipeline.stop(true);
+
+    state.SetBytesProcessed(static_cast<int64_t>(file_size) *
+                           static_cast<int64_t>(state.iterations()));
+    state.counters["target_MBps"] = targets::lan_throughput_mbps;
+}
+
+/**
+ * @brief Latency of small uploads while another client saturates the pipeline
+ *
+ * A background thread keeps one client's bulk upload backlogged; each
+ * iteration submits one small chunk from a second client and waits until
+ * it is written. With fair scheduling the time stays close to the
+ * processing time of a chunk instead of growing with the bulk backlog.
+ */
+static void BM_ServerReceive_SmallUnderBulkLoad(::benchmark::State& state) {
+    const auto bulk_chunk = static_cast<std::size_t>(state.range(0));
+
+    auto pipeline_result = server_pipeline::create(pipeline_config::auto_detect());
+    if (!pipeline_result) {
+        state.SkipWithError("Failed to create pipeline");
+        return;
+    }
+    auto& pipeline = pipeline_result.value();
+
+    auto small_id = transfer_id::generate();
+    std::mutex mutex;
+    std::condition_variable written_cv;
+    uint64_t small_written = 0;
+    pipeline.on_upload_complete([&](const transfer_id& id, uint64_t) {
+        if (id == small_id) {
+            std::lock_guard lock(mutex);
+            ++small_written;
+            written_cv.notify_one();
+        }
+    });
+    if (!pipeline.start()) {
+        state.SkipWithError("Failed to start pipeline");
+        return;
+    }
+
+    auto make = [](const transfer_id& id, client_id client, uint64_t index,
+                   const std::vector<std::byte>& data) {
+        pipeline_chunk pc;
+        pc.id = id;
+        pc.client = client;
+        pc.chunk_index = index;
+        pc.data = data;
+        pc.checksum = checksum::crc32(data);
+        pc.is_compressed = false;
+        pc.original_size = data.size();
+        return pc;
+    };
+
+    std::atomic<bool> loading{true};
+    std::thread bulk([&] {
+        auto id = transfer_id::generate();
+        auto data = test_data_generator::generate_random_data(bulk_chunk, 7);
+        for (uint64_t i = 0; loading; ++i) {
+            (void)pipeline.submit_upload_chunk(make(id, client_id{1}, i, data),
+                                               std::chrono::milliseconds(100));
+        }
+    });
+
+    auto small_data = test_data_generator::generate_random_data(4 * sizes::KB, 9);
+    uint64_t index = 0;
+    for (auto _ : state) {
+        if (!pipeline.submit_upload_chunk(make(small_id, client_id{2}, index, small_data),
+                                          std::chrono::seconds(30))) {
+            state.SkipWithError("Pipeline stalled");
+            break;
+        }
+        ++index;
+        std::unique_lock lock(mutex);
+        written_cv.wait(lock, [&] { return small_written == index; });
+    }
+
+    loading = false;
+    bulk.join();
+
+    for (const auto& flow : pipeline.flow_statistics()) {
+        if (flow.key.transfer == small_id) {
+            state.counters["queue_p50_us"] = static_cast<double>(flow.wait.percentile(50).count());
+            state.counters["queue_p99_us"] = static_cast<double>(flow.wait.percentile(99).count());
+        }
+    }
+    (void)pipeline.stop(false);
+}
+
+BENCHMARK(BM_ServerReceive_Pipeline)
+    ->Args({static_cast<int64_t>(sizes::medium_file), static_cast<int64_t>(sizes::default_chunk)})
+    ->Args({static_cast<int64_t>(sizes::large_file), static_cast<int64_t>(sizes::default_chunk)})
+    ->Args({static_cast<int64_t>(sizes::large_file), static_cast<int64_t>(sizes::max_chunk)})
+    ->Unit(::benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(BM_ServerReceive_SmallUnderBulkLoad)
+    ->Arg(static_cast<int64_t>(sizes::default_chunk))
+    ->Arg(static_cast<int64_t>(sizes::max_chunk))
+    ->Unit(::benchmark::kMicrosecond)
+    ->UseRealTime();
+
+}  // namespace kcenon::file_transfer::benchmark
@@ -0,0 +1,168 @@
+/**
+ * @file bench_fec_lossy_link.cpp
+ * @brief Completion time over a lossy, high-RTT link with and without FEC
+ *
+ * An in-process link shim drops chunks at a fixed rate and charges each
+ * chunk's serialisation time at a fixed bandwidth; every round of NACKs
+ * and retransmissions costs one more round trip. The receiver is a real
+ * chunk_assembler and the parity comes from fec_encoder. The reported
+ * (manual) time is the simulated completion time plus the CPU time
+ * actually spent encoding and assembling.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <kcenon/file_transfer/core/chunk_assembler.h>
+#include <kcenon/file_transfer/core/chunk_splitter.h>
+#include <kcenon/file_transfer/core/fec_codec.h>
+
+#include "utils/benchmark_helpers.h"
+
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+namespace kcenon::file_transfer::benchmark {
+
+namespace {
+
+constexpr double link_bytes_per_second = 50e6 / 8;  // 50 Mbit/s
+constexpr double link_rtt_seconds = 0.6;            // Geostationary satellite
+constexpr std::size_t transfer_size = 16 * sizes::MB;
+constexpr std::size_t transfer_chunk_size = 256 * sizes::KB;
+
+/**
+ * @brief Drops chunks at random and accounts for the bytes put on the wire
+ */
+class lossy_link {
+public:
+    lossy_link(double loss_rate, uint32_t seed) : loss_rate_(loss_rate), gen_(seed) {}
+
+    /**
+     * @brief Send a chunk
+     * @return true if it arrives
+     */
+    auto send(const chunk& c) -> bool {
+        wire_bytes_ += c.total_size();
+        return dist_(gen_) >= loss_rate_;
+    }
+
+    [[nodiscard]] auto wire_seconds() const -> double {
+        return static_cast<double>(wire_bytes_) / link_bytes_per_second;
+    }
+
+private:
+    double loss_rate_;
+    std::mt19937 gen_;
+    std::uniform_real_distribution<double> dist_{0.0, 1.0};
+    uint64_t wire_bytes_ = 0;
+};
+
+}  // namespace
+
+/**
+ * @brief Transfer 16MB in 256KB chunks over a 50 Mbit/s, 600ms RTT link
+ *
+ * range(0): chunk loss rate in per mille
+ * range(1): parity chunks per 16 data chunks; -1 picks them from the link
+ */
+static void BM_Fec_LossyLink(::benchmark::State& state) {
+    auto loss_rate = static_cast<double>(state.range(0)) / 1000.0;
+    auto config = state.range(1) < 0
+        ? fec_config::for_link(loss_rate,
+                               std::chrono::microseconds(
+                                   static_cast<int64_t>(link_rtt_seconds * 1e6)),
+                               link_bytes_per_second, transfer_chunk_size)
+        : fec_config{fec_config::default_data_chunks, static_cast<std::size_t>(state.range(1))};
+
+    temp_file_manager temp_files;
+    auto source = temp_files.create_random_file("fec_source.bin", transfer_size);
+    chunk_splitter splitter(chunk_config{transfer_chunk_size});
+    auto split = splitter.split(source, transfer_id::generate());
+    if (!split) {
+        state.SkipWithError("Failed to split source file");
+        return;
+    }
+    std::vector<chunk> source_chunks;
+    while (split.value().has_next()) {
+        auto next = split.value().next();
+        if (!next) {
+            state.SkipWithError("Failed to read chunk");
+            return;
+        }
+        source_chunks.push_back(std::move(next.value()));
+    }
+
+    auto output_dir = temp_files.base_dir() / "fec_output";
+    std::filesystem::create_directories(output_dir);
+
+    uint32_t seed = 1;
+    double total_rounds = 0;
+    double total_recovered = 0;
+    for (auto _ : state) {
+        auto id = transfer_id::generate();
+        auto chunks = source_chunks;
+        for (auto& c : chunks) {
+            c.header.id = id;
+        }
+        chunk_assembler assembler(output_dir);
+        if (!assembler.start_session(id, "fec_output.bin", transfer_size, chunks.size())) {
+            state.SkipWithError("Failed to start session");
+            return;
+        }
+
+        lossy_link link(loss_rate, seed++);
+        auto deliver = [&](const chunk& c) {
+            if (link.send(c)) {
+                ::benchmark::DoNotOptimize(assembler.process_chunk(c));
+            }
+        };
+
+        auto cpu_start = std::chrono::steady_clock::now();
+
+        // First round: every data chunk, each group followed by its parity
+        fec_encoder encoder(config);
+        for (const auto& c : chunks) {
+            deliver(c);
+            auto parity = encoder.add(c);
+            for (const auto& p : parity.value()) {
+                deliver(p);
+            }
+        }
+        for (const auto& p : encoder.flush()) {
+            deliver(p);
+        }
+
+        // Each further round NACKs what is still missing and resends it
+        int rounds = 1;
+        while (!assembler.is_complete(id)) {
+            for (auto index : assembler.get_missing_chunks(id)) {
+                deliver(chunks[index]);
+            }
+            ++rounds;
+        }
+
+        std::chrono::duration<double> cpu = std::chrono::steady_clock::now() - cpu_start;
+        state.SetIterationTime(link.wire_seconds() + rounds * link_rtt_seconds + cpu.count());
+
+        total_rounds += rounds;
+        total_recovered += static_cast<double>(assembler.get_progress(id)->recovered_chunks);
+        assembler.cancel_session(id);
+    }
+
+    auto iterations = static_cast<double>(state.iterations());
+    state.counters["parity"] = static_cast<double>(config.parity_chunks);
+    state.counters["overhead_pct"] = config.overhead() * 100.0;
+    state.counters["rounds"] = total_rounds / iterations;
+    state.counters["recovered"] = total_recovered / iterations;
+}
+
+BENCHMARK(BM_Fec_LossyLink)
+    ->ArgNames({"loss_permille", "parity"})
+    ->ArgsProduct({{0, 10, 50, 100}, {0, 2, 4, -1}})
+    ->Unit(::benchmark::kMillisecond)
+    ->UseManualTime()
+    ->Iterations(10);
+
+}  // namespace kcenon::file_transfer::benchmark
@@ -5,6 +5,8 @@
 
 #include "utils/benchmark_helpers.h"
 
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <sstream>
@@ -69,6 +71,62 @@ auto test_data_generator::generate_text_data(std::size_t size, uint32_t seed)
     return data;
 }
 
+auto test_data_generator::generate_log_data(std::size_t size, uint32_t seed)
+    -> std::vector<std::byte> {
+    static const char* const templates[] = {
+        "2024-05-%02u INFO  [worker-%02u] chunk %u of transfer %04x written in %u us\n",
+        "2024-05-%02u DEBUG [session-%02u] heartbeat ack after %u ms, window %u, rtt %u us\n",
+        "2024-05-%02u WARN  [pipeline-%02u] queue %u above high-water mark, %u stalls, %u us\n",
+        "2024-05-%02u INFO  [server-%02u] client %u connected from 10.0.%u.%u\n",
+    };
+
+    std::mt19937 gen(seed == 0 ? std::random_device{}() : seed);
+
+    std::string text;
+    text.reserve(size + 128);
+    char line[160];
+    while (text.size() < size) {
+        auto n = std::snprintf(line, sizeof(line), templates[gen() % 4],
+                               static_cast<unsigned>(1 + gen() % 28),
+                               static_cast<unsigned>(gen() % 16),
+                               static_cast<unsigned>(gen() % 100000),
+                               static_cast<unsigned>(gen() % 256),
+                               static_cast<unsigned>(gen() % 10000));
+        text.append(line, static_cast<std::size_t>(n));
+    }
+
+    std::vector<std::byte> data(size);
+    std::memcpy(data.data(), text.data(), size);
+    return data;
+}
+
+auto test_data_generator::generate_csv_data(std::size_t size, uint32_t seed)
+    -> std::vector<std::byte> {
+    std::mt19937 gen(seed == 0 ? std::random_device{}() : seed);
+    std::uniform_real_distribution<double> price(10.0, 500.0);
+
+    std::string text = "id,timestamp,symbol,price,volume,side\n";
+    text.reserve(size + 128);
+    static const char* const symbols[] = {"AAPL", "MSFT", "GOOG", "AMZN", "NVDA", "TSLA"};
+    char line[128];
+    uint64_t id = 0;
+    uint64_t timestamp = 1700000000000;
+    while (text.size() < size) {
+        timestamp += gen() % 50;
+        auto n = std::snprintf(line, sizeof(line), "%llu,%llu,%s,%.2f,%u,%s\n",
+                               static_cast<unsigned long long>(++id),
+                               static_cast<unsigned long long>(timestamp),
+                               symbols[gen() % 6], price(gen),
+                               static_cast<unsigned>(gen() % 10000),
+                               gen() % 2 == 0 ? "buy" : "sell");
+        text.append(line, static_cast<std::size_t>(n));
+    }
+
+    std::vector<std::byte> data(size);
+    std::memcpy(data.data(), text.data(), size);
+    return data;
+}
+
 auto test_data_generator::generate_data_with_compressibility(
     std::size_t size,
     double compressibility_ratio,
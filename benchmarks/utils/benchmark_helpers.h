@@ -37,6 +37,28 @@ public:
     static auto generate_text_data(std::size_t size, uint32_t seed = 0)
         -> std::vector<std::byte>;
 
+    /**
+     * @brief Generate application log lines
+     *
+     * Lines follow a few templates with varying fields, so most repeats
+     * are a line or more apart rather than within a few bytes.
+     *
+     * @param size Size in bytes
+     * @param seed Random seed (0 for random)
+     * @return Vector of log text
+     */
+    static auto generate_log_data(std::size_t size, uint32_t seed = 0)
+        -> std::vector<std::byte>;
+
+    /**
+     * @brief Generate CSV rows of numeric records
+     * @param size Size in bytes
+     * @param seed Random seed (0 for random)
+     * @return Vector of CSV text, starting with a header row
+     */
+    static auto generate_csv_data(std::size_t size, uint32_t seed = 0)
+        -> std::vector<std::byte>;
+
     /**
      * @brief Generate data with specified compressibility ratio
      * @param size Size in bytes
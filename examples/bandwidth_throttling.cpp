@@ -7,11 +7,17 @@
  * - Monitoring actual transfer rates
  * - Comparing throttled vs unlimited transfers
  * - Dynamic bandwidth adjustment scenarios
+ * - Accuracy and overhead of hierarchical shaping at 10k acquires/s
+ *   (--shaper-bench, no server needed)
  */
 
 #include <kcenon/file_transfer/client/file_transfer_client.h>
+#include <kcenon/file_transfer/core/bandwidth_limiter.h>
+#include <kcenon/file_transfer/core/bandwidth_shaper.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cstring>
 #include <filesystem>
@@ -139,12 +145,16 @@ void print_usage(const char* program) {
     std::cout << "  --file-size <size>          Size for test file (default: 5M)" << std::endl;
     std::cout << "  --compare                   Compare different bandwidth settings" << std::endl;
     std::cout << "  --list-presets              Show available presets" << std::endl;
+    std::cout << "  --shaper-bench              Measure shaping accuracy and overhead locally" << std::endl;
+    std::cout << "                              (rate from --upload-limit, default 10M)" << std::endl;
+    std::cout << "  --duration <seconds>        Length of --shaper-bench (default: 4)" << std::endl;
     std::cout << "  --help                      Show this help message" << std::endl;
     std::cout << std::endl;
     std::cout << "Examples:" << std::endl;
     std::cout << "  " << program << " --upload-limit 1M --download-limit 2M" << std::endl;
     std::cout << "  " << program << " --preset cable --file data.bin" << std::endl;
     std::cout << "  " << program << " --compare --file-size 10M" << std::endl;
+    std::cout << "  " << program << " --shaper-bench --upload-limit 10M" << std::endl;
 }
 
 void list_presets() {
@@ -287,6 +297,151 @@ auto run_throttled_upload(
     return {true, avg_rate};
 }
 
+/**
+ * @brief Nanoseconds per call of fn, averaged over iterations
+ */
+template <typename F>
+auto time_per_call(std::size_t iterations, F&& fn) -> double {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(
+               std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+           static_cast<double>(iterations);
+}
+
+/**
+ * @brief Measure shaper overhead and rate accuracy at 10k acquires/s
+ *
+ * Two tenants share the global limit with half of it guaranteed each.
+ * Each keeps at most 32 acquires parked, like a pipeline flow window, and
+ * together they offer 120% of the limit. In the second phase tenant 2
+ * goes idle and tenant 1 should borrow the whole limit.
+ */
+auto run_shaper_benchmark(std::size_t limit, double seconds) -> int {
+    constexpr std::size_t acquires_per_second = 10000;
+    constexpr int max_parked_per_tenant = 32;
+    constexpr std::size_t overhead_iterations = 1'000'000;
+
+    std::cout << "Bandwidth Shaper Benchmark" << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+    std::cout << "Global limit: " << format_rate(static_cast<double>(limit)) << std::endl;
+    std::cout << "Target acquire rate: " << acquires_per_second << "/s" << std::endl;
+    std::cout << std::endl;
+
+    // Overhead of an acquire that finds tokens available
+    {
+        bandwidth_limiter limiter(std::size_t{1} << 50);
+        bandwidth_shaper shaper;
+        auto id = transfer_id::generate();
+        shaper.set_tenant_limits(1, {std::size_t{1} << 49, std::size_t{1} << 50});
+        shaper.set_transfer_limits(1, id, {0, std::size_t{1} << 50});
+        auto path = shaper.resolve(1, id);
+
+        std::cout << "Fast-path overhead (tokens available):" << std::endl;
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "  " << std::left << std::setw(38) << "bandwidth_limiter::try_acquire"
+                  << time_per_call(overhead_iterations, [&] { (void)limiter.try_acquire(1024); })
+                  << " ns" << std::endl;
+        std::cout << "  " << std::setw(38) << "bandwidth_shaper (lookup, 3 levels)"
+                  << time_per_call(overhead_iterations,
+                                   [&] { (void)shaper.try_acquire(1, id, 1024); })
+                  << " ns" << std::endl;
+        std::cout << "  " << std::setw(38) << "bandwidth_shaper (resolved path)"
+                  << time_per_call(overhead_iterations,
+                                   [&] { (void)shaper.try_acquire(path, 1024); })
+                  << " ns" << std::endl;
+        std::cout << std::endl;
+    }
+
+    // Counters first: parked callbacks use them until the shaper is gone
+    std::array<std::atomic<uint64_t>, 2> granted{};
+    std::array<std::atomic<int>, 2> parked{};
+    const auto chunk = std::max<std::size_t>(limit * 12 / 10 / acquires_per_second, 1);
+
+    bandwidth_shaper shaper(limit, std::chrono::milliseconds(20));
+    shaper.set_tenant_limits(1, {limit / 2, limit});
+    shaper.set_tenant_limits(2, {limit / 2, limit});
+    std::array<transfer_id, 2> ids{transfer_id::generate(), transfer_id::generate()};
+    uint64_t attempts = 0;
+    uint64_t refused = 0;
+    double call_ns = 0.0;
+
+    auto run_phase = [&](std::chrono::duration<double> length, int tenants) {
+        std::array<uint64_t, 2> before{granted[0].load(), granted[1].load()};
+        auto start = std::chrono::steady_clock::now();
+        auto next = start;
+        auto interval = std::chrono::nanoseconds(1'000'000'000 / acquires_per_second);
+        uint64_t n = 0;
+        while (std::chrono::steady_clock::now() - start < length) {
+            int t = tenants == 2 ? static_cast<int>(n % 2) : 0;
+            ++n;
+            ++attempts;
+            if (parked[t].load() >= max_parked_per_tenant) {
+                ++refused;
+            } else {
+                auto call_start = std::chrono::steady_clock::now();
+                bool now = shaper.acquire_or_park(static_cast<uint64_t>(t + 1), ids[t], chunk,
+                    [&, t] {
+                        granted[t] += chunk;
+                        parked[t]--;
+                    });
+                call_ns += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - call_start).count());
+                if (now) {
+                    granted[t] += chunk;
+                } else {
+                    parked[t]++;
+                }
+            }
+            next += interval;
+            std::this_thread::sleep_until(next);
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+        return std::array<double, 3>{
+            static_cast<double>(granted[0].load() - before[0]) / elapsed.count(),
+            static_cast<double>(granted[1].load() - before[1]) / elapsed.count(),
+            static_cast<double>(n) / elapsed.count()};
+    };
+
+    auto report = [&](const std::string& phase, const std::array<double, 3>& r) {
+        double total = r[0] + r[1];
+        std::cout << phase << std::endl;
+        std::cout << "  Acquire rate: " << std::fixed << std::setprecision(0) << r[2] << "/s"
+                  << std::endl;
+        std::cout << "  Tenant 1: " << format_rate(r[0]) << std::endl;
+        std::cout << "  Tenant 2: " << format_rate(r[1]) << std::endl;
+        std::cout << "  Total: " << format_rate(total) << " (" << std::setprecision(1)
+                  << total / static_cast<double>(limit) * 100.0 << "% of limit)" << std::endl;
+        std::cout << std::endl;
+    };
+
+    std::cout << "Chunk per acquire: " << format_bytes(chunk) << " (offered load 120%)"
+              << std::endl;
+    std::cout << std::endl;
+    auto shared = run_phase(std::chrono::duration<double>(seconds / 2), 2);
+    report("Phase 1: both tenants backlogged (expect 50% / 50%)", shared);
+    auto borrowing = run_phase(std::chrono::duration<double>(seconds / 2), 1);
+    report("Phase 2: tenant 2 idle, tenant 1 borrows (expect 100% / 0%)", borrowing);
+
+    shaper.drop_parked();
+    auto stats = shaper.stats();
+    auto issued = attempts - refused;
+    std::cout << "Shaper Statistics" << std::endl;
+    std::cout << std::string(60, '-') << std::endl;
+    std::cout << "  Acquires issued: " << issued << " (" << refused
+              << " skipped at the parking window)" << std::endl;
+    std::cout << "  Granted on first try: " << stats.granted << " (" << stats.borrowed
+              << " borrowed)" << std::endl;
+    std::cout << "  Parked: " << stats.parked << ", released: " << stats.released << std::endl;
+    std::cout << "  Mean acquire_or_park call: " << std::setprecision(1)
+              << (issued > 0 ? call_ns / static_cast<double>(issued) : 0.0) << " ns"
+              << std::endl;
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     // Default configuration
     std::string host = "localhost";
@@ -297,6 +452,8 @@ int main(int argc, char* argv[]) {
     std::string file_path = "throttle_test.bin";
     std::size_t file_size = 5 * 1024 * 1024;  // 5MB
     bool compare_mode = false;
+    bool shaper_bench = false;
+    double duration = 4.0;
 
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -352,6 +509,14 @@ int main(int argc, char* argv[]) {
             file_size = parse_size(argv[i]);
         } else if (arg == "--compare") {
             compare_mode = true;
+        } else if (arg == "--shaper-bench") {
+            shaper_bench = true;
+        } else if (arg == "--duration") {
+            if (++i >= argc) {
+                std::cerr << "Error: --duration requires an argument" << std::endl;
+                return 1;
+            }
+            duration = std::stod(argv[i]);
         }
     }
 
@@ -373,6 +538,10 @@ int main(int argc, char* argv[]) {
     std::cout << "========================================" << std::endl;
     std::cout << std::endl;
 
+    if (shaper_bench) {
+        return run_shaper_benchmark(upload_limit > 0 ? upload_limit : 10 * 1024 * 1024, duration);
+    }
+
     // Create test file if it doesn't exist
     if (!std::filesystem::exists(file_path)) {
         std::cout << "Creating test file..." << std::endl;
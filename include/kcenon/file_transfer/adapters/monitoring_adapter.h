@@ -23,6 +23,12 @@
  * - file_transfer.quota_used_bytes (gauge) - Storage bytes used
  * - file_transfer.quota_available_bytes (gauge) - Storage bytes available
  * - file_transfer.uptime_ms (counter) - Server uptime in milliseconds
+ * - file_transfer.cache_hits (counter) - Cloud reads served from the read cache
+ * - file_transfer.cache_misses (counter) - Cloud reads fetched from the backend
+ * - file_transfer.cache_evictions (counter) - Read cache entries evicted
+ * - file_transfer.cache_bytes (gauge) - Bytes held in the read cache
+ * - file_transfer.replication_pending (gauge) - Changes waiting for cloud replication
+ * - file_transfer.replication_lag_ms (gauge) - Age of the oldest unreplicated change
  *
  * @since 0.3.0
  */
@@ -14,7 +14,7 @@
  * - Stage-based task tracking for pipeline monitoring
  * - Delayed task scheduling for retry operations
  * - Seamless integration with thread_system when available
- * - Fallback to std::async when thread_system is unavailable
+ * - Fallback to the shared io_executor when thread_system is unavailable
  *
  * @since 0.3.0
  */
@@ -47,7 +47,7 @@ namespace kcenon::file_transfer::adapters {
  *
  * This abstraction allows:
  * - Use of thread_system's thread_pool when available
- * - Fallback to basic_thread_pool from network_system or std::async
+ * - Fallback to basic_thread_pool from network_system or the shared io_executor
  * - Delayed task scheduling for retry operations
  * - Stage-based task tracking for pipeline monitoring
  */
@@ -257,15 +257,16 @@ private:
 #endif  // KCENON_WITH_NETWORK_SYSTEM
 
 /**
- * @brief Fallback implementation using std::async
+ * @brief Fallback implementation on the shared io_executor
  *
  * This implementation is used when neither thread_system nor network_system
- * thread pools are available. It uses std::async for task execution.
+ * thread pools are available. Tasks run on io_executor::shared() in the
+ * "transfer_pool" lane, so submissions are bounded instead of spawning a
+ * thread each.
  *
  * @note This fallback has limited functionality:
- *       - No delayed execution (returns immediately completed future with delay)
- *       - worker_count() returns hardware_concurrency
- *       - pending_tasks() is always 0 (no queue)
+ *       - worker_count() reports the shared executor's worker count
+ *       - pending_tasks() counts tasks that are queued, delayed or running
  */
 class async_transfer_pool : public transfer_thread_pool_interface {
 public:
@@ -10,7 +10,9 @@
 #ifndef KCENON_FILE_TRANSFER_CLOUD_AZURE_BLOB_STORAGE_H
 #define KCENON_FILE_TRANSFER_CLOUD_AZURE_BLOB_STORAGE_H
 
+#include <algorithm>
 #include <atomic>
+#include <cctype>
 #include <future>
 #include <map>
 #include <memory>
@@ -18,6 +20,7 @@
 #include <vector>
 
 #include "cloud_config.h"
+#include "cloud_connection_pool.h"
 #include "cloud_credentials.h"
 #include "cloud_error.h"
 #include "cloud_storage_interface.h"
@@ -45,6 +48,19 @@ struct azure_http_response {
         if (it != headers.end()) {
             return it->second;
         }
+
+        // HTTP header names are case-insensitive
+        auto same = [&name](const std::string& key) {
+            return std::equal(key.begin(), key.end(), name.begin(), name.end(),
+                              [](unsigned char a, unsigned char b) {
+                                  return std::tolower(a) == std::tolower(b);
+                              });
+        };
+        for (const auto& [key, value] : headers) {
+            if (same(key)) {
+                return value;
+            }
+        }
         return std::nullopt;
     }
 };
@@ -101,6 +117,14 @@ public:
         const std::string& url,
         const std::map<std::string, std::string>& headers)
         -> result<azure_http_response> = 0;
+
+    /**
+     * @brief Get connection pool counters
+     * @return Pool counters; clients without a pool report zeros
+     */
+    [[nodiscard]] virtual auto pool_statistics() const -> connection_pool_statistics {
+        return {};
+    }
 };
 
 /**
@@ -174,7 +198,8 @@ private:
     azure_blob_download_stream(
         const std::string& blob_name,
         const azure_blob_config& config,
-        std::shared_ptr<credential_provider> credentials);
+        std::shared_ptr<credential_provider> credentials,
+        std::shared_ptr<azure_http_client_interface> http_client = nullptr);
 
     struct impl;
     std::unique_ptr<impl> impl_;
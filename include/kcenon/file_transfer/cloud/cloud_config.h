@@ -71,6 +71,27 @@ struct multipart_config {
     std::size_t max_part_retries = 3;
 };
 
+/**
+ * @brief Parallel ranged download configuration
+ *
+ * Objects at or above the threshold are split into byte ranges that are
+ * fetched concurrently (up to connection_pool_size at a time) and written
+ * straight into the destination file.
+ */
+struct parallel_download_config {
+    /// Enable parallel ranged downloads
+    bool enabled = true;
+
+    /// Minimum object size to split into ranges (default: 64MB)
+    uint64_t threshold = 64 * 1024 * 1024;
+
+    /// Size of each ranged GET (default: 8MB)
+    uint64_t range_size = 8 * 1024 * 1024;
+
+    /// Maximum retries for a failed range before the download fails
+    std::size_t max_range_retries = 3;
+};
+
 /**
  * @brief Transfer options for upload/download operations
  */
@@ -151,12 +172,18 @@ struct cloud_storage_config {
     /// Enable connection keep-alive
     bool keep_alive = true;
 
+    /// Idle keep-alive connections are closed after this long
+    std::chrono::milliseconds idle_connection_timeout{60000};
+
     /// Retry policy
     cloud_retry_policy retry;
 
     /// Multipart upload configuration
     multipart_config multipart;
 
+    /// Parallel ranged download configuration
+    parallel_download_config parallel_download;
+
     /// Default transfer options
     cloud_transfer_options default_transfer_options;
 
@@ -406,6 +433,17 @@ public:
         return *this;
     }
 
+    auto with_parallel_download(const parallel_download_config& config) -> cloud_config_builder& {
+        if (s3_config_.has_value()) {
+            s3_config_->parallel_download = config;
+        } else if (azure_config_.has_value()) {
+            azure_config_->parallel_download = config;
+        } else if (gcs_config_.has_value()) {
+            gcs_config_->parallel_download = config;
+        }
+        return *this;
+    }
+
     // S3-specific options
     auto with_transfer_acceleration(bool enable) -> cloud_config_builder& {
         if (s3_config_.has_value()) {
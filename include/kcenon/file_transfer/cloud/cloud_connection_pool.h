@@ -0,0 +1,343 @@
+/**
+ * @file cloud_connection_pool.h
+ * @brief Per-endpoint pool of keep-alive HTTP connections for cloud storage
+ *
+ * Parallel part uploads and ranged downloads each need a connection. Without
+ * a pool they either serialize on a single client or open a fresh connection
+ * (and TLS session) per request. The pool keeps warm connections per endpoint,
+ * bounds how many exist at once, and closes connections that sit idle too long
+ * or fail.
+ */
+
+#ifndef KCENON_FILE_TRANSFER_CLOUD_CLOUD_CONNECTION_POOL_H
+#define KCENON_FILE_TRANSFER_CLOUD_CLOUD_CONNECTION_POOL_H
+
+#include "cloud_config.h"
+#include "kcenon/file_transfer/core/types.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace kcenon::file_transfer {
+
+/**
+ * @brief Connection pool configuration
+ */
+struct connection_pool_config {
+    /// Maximum connections (idle + leased) per endpoint
+    std::size_t max_connections_per_endpoint = 25;
+
+    /// Idle connections older than this are closed
+    std::chrono::milliseconds idle_timeout{60000};
+
+    /// How long acquire() waits for a free connection when the endpoint is at its limit
+    std::chrono::milliseconds acquire_timeout{30000};
+
+    /// Return connections to the pool after use (false = one connection per request)
+    bool keep_alive = true;
+};
+
+/**
+ * @brief Connection pool counters
+ */
+struct connection_pool_statistics {
+    uint64_t hits = 0;        ///< Requests served by a warm idle connection
+    uint64_t misses = 0;      ///< Requests that had to open a new connection
+    uint64_t reaped = 0;      ///< Idle connections closed after idle_timeout
+    uint64_t discarded = 0;   ///< Connections dropped after a failure or failed health check
+    uint64_t waits = 0;       ///< Acquires that waited for a connection to be released
+    uint64_t timeouts = 0;    ///< Acquires that gave up after acquire_timeout
+    std::size_t idle = 0;     ///< Connections currently idle in the pool
+    std::size_t leased = 0;   ///< Connections currently in use
+};
+
+/**
+ * @brief Build pool settings from a cloud storage configuration
+ * @param config Storage configuration (connection_pool_size, keep_alive, timeouts)
+ * @return Pool configuration
+ */
+[[nodiscard]] inline auto make_connection_pool_config(const cloud_storage_config& config)
+    -> connection_pool_config {
+    connection_pool_config pool;
+    pool.max_connections_per_endpoint = config.connection_pool_size;
+    pool.idle_timeout = config.idle_connection_timeout;
+    pool.acquire_timeout = config.connect_timeout;
+    pool.keep_alive = config.keep_alive;
+    return pool;
+}
+
+/**
+ * @brief Thread-safe per-endpoint pool of reusable connections
+ *
+ * Connections are handed out as RAII leases. A lease returns its connection
+ * to the endpoint's idle list on destruction unless it was marked broken;
+ * the most recently used idle connection is reused first. Idle connections
+ * are reaped after idle_timeout and, when a health check is installed,
+ * re-validated before reuse.
+ *
+ * The pool must outlive every lease it hands out.
+ *
+ * @tparam Connection Connection type (e.g. an HTTP client bound to one host)
+ */
+template <typename Connection>
+class connection_pool {
+public:
+    using clock = std::chrono::steady_clock;
+
+    /// Opens a new connection to an endpoint; nullptr on failure
+    using factory_type = std::function<std::shared_ptr<Connection>(const std::string& endpoint)>;
+
+    /// Returns false if an idle connection must not be reused
+    using health_check_type = std::function<bool(const Connection&)>;
+
+    /**
+     * @brief Connection leased from the pool
+     */
+    class lease {
+    public:
+        lease() = default;
+
+        ~lease() { release(); }
+
+        lease(const lease&) = delete;
+        auto operator=(const lease&) -> lease& = delete;
+
+        lease(lease&& other) noexcept
+            : pool_(std::exchange(other.pool_, nullptr))
+            , endpoint_(std::move(other.endpoint_))
+            , connection_(std::move(other.connection_))
+            , broken_(other.broken_) {}
+
+        auto operator=(lease&& other) noexcept -> lease& {
+            if (this != &other) {
+                release();
+                pool_ = std::exchange(other.pool_, nullptr);
+                endpoint_ = std::move(other.endpoint_);
+                connection_ = std::move(other.connection_);
+                broken_ = other.broken_;
+            }
+            return *this;
+        }
+
+        auto operator->() const -> Connection* { return connection_.get(); }
+        auto operator*() const -> Connection& { return *connection_; }
+
+        /**
+         * @brief Close the connection instead of returning it to the pool
+         *
+         * Call after a transport error; the connection state is unknown.
+         */
+        auto mark_broken() -> void { broken_ = true; }
+
+    private:
+        friend class connection_pool;
+
+        lease(connection_pool* pool, std::string endpoint, std::shared_ptr<Connection> connection)
+            : pool_(pool), endpoint_(std::move(endpoint)), connection_(std::move(connection)) {}
+
+        auto release() -> void {
+            if (pool_) {
+                std::exchange(pool_, nullptr)->give_back(endpoint_, std::move(connection_), broken_);
+            }
+        }
+
+        connection_pool* pool_ = nullptr;
+        std::string endpoint_;
+        std::shared_ptr<Connection> connection_;
+        bool broken_ = false;
+    };
+
+    /**
+     * @brief Create a pool
+     * @param config Pool configuration
+     * @param factory Opens new connections
+     * @param health_check Optional check run before an idle connection is reused
+     */
+    connection_pool(connection_pool_config config,
+                    factory_type factory,
+                    health_check_type health_check = {})
+        : config_(config), factory_(std::move(factory)), health_check_(std::move(health_check)) {
+        if (config_.max_connections_per_endpoint == 0) {
+            config_.max_connections_per_endpoint = 1;
+        }
+    }
+
+    connection_pool(const connection_pool&) = delete;
+    auto operator=(const connection_pool&) -> connection_pool& = delete;
+
+    /**
+     * @brief Lease a connection to an endpoint
+     *
+     * Reuses the warmest idle connection, opens a new one while the endpoint
+     * is below its limit, and otherwise waits up to acquire_timeout for a
+     * lease to be returned.
+     *
+     * @param endpoint Endpoint key (scheme://host:port)
+     * @return Lease, or connection_timeout / connection_failed
+     */
+    [[nodiscard]] auto acquire(const std::string& endpoint) -> result<lease> {
+        auto deadline = clock::now() + config_.acquire_timeout;
+        std::unique_lock lock(mutex_);
+        bool waited = false;
+
+        while (true) {
+            auto& state = endpoints_[endpoint];
+            reap_locked(state, clock::now());
+
+            if (!state.idle.empty()) {
+                auto connection = std::move(state.idle.back().connection);
+                state.idle.pop_back();
+                ++state.leased;
+
+                if (health_check_) {
+                    lock.unlock();
+                    bool healthy = health_check_(*connection);
+                    lock.lock();
+                    if (!healthy) {
+                        --state.leased;
+                        ++stats_.discarded;
+                        lock.unlock();
+                        connection.reset();
+                        lock.lock();
+                        continue;
+                    }
+                }
+
+                ++stats_.hits;
+                return lease(this, endpoint, std::move(connection));
+            }
+
+            if (state.leased < config_.max_connections_per_endpoint) {
+                ++state.leased;
+                ++stats_.misses;
+                lock.unlock();
+
+                auto connection = factory_ ? factory_(endpoint) : nullptr;
+                if (!connection) {
+                    lock.lock();
+                    --state.leased;
+                    available_.notify_one();
+                    return unexpected{error{error_code::connection_failed,
+                        "Failed to open connection to " + endpoint}};
+                }
+                return lease(this, endpoint, std::move(connection));
+            }
+
+            if (!waited) {
+                waited = true;
+                ++stats_.waits;
+            }
+            if (available_.wait_until(lock, deadline) == std::cv_status::timeout &&
+                endpoints_[endpoint].idle.empty() &&
+                endpoints_[endpoint].leased >= config_.max_connections_per_endpoint) {
+                ++stats_.timeouts;
+                return unexpected{error{error_code::connection_timeout,
+                    "Connection pool exhausted for " + endpoint}};
+            }
+        }
+    }
+
+    /**
+     * @brief Close idle connections older than idle_timeout
+     * @return Number of connections closed
+     */
+    auto reap_idle() -> std::size_t {
+        std::lock_guard lock(mutex_);
+        auto before = stats_.reaped;
+        auto now = clock::now();
+        for (auto& [endpoint, state] : endpoints_) {
+            reap_locked(state, now);
+        }
+        return static_cast<std::size_t>(stats_.reaped - before);
+    }
+
+    /**
+     * @brief Close all idle connections
+     */
+    auto clear() -> void {
+        std::lock_guard lock(mutex_);
+        for (auto& [endpoint, state] : endpoints_) {
+            state.idle.clear();
+        }
+    }
+
+    /**
+     * @brief Get pool counters
+     */
+    [[nodiscard]] auto statistics() const -> connection_pool_statistics {
+        std::lock_guard lock(mutex_);
+        auto stats = stats_;
+        for (const auto& [endpoint, state] : endpoints_) {
+            stats.idle += state.idle.size();
+            stats.leased += state.leased;
+        }
+        return stats;
+    }
+
+    [[nodiscard]] auto config() const -> const connection_pool_config& { return config_; }
+
+private:
+    struct idle_connection {
+        std::shared_ptr<Connection> connection;
+        clock::time_point idle_since;
+    };
+
+    struct endpoint_state {
+        std::vector<idle_connection> idle;  // Oldest first
+        std::size_t leased = 0;
+    };
+
+    // Caller must hold mutex_
+    auto reap_locked(endpoint_state& state, clock::time_point now) -> void {
+        std::size_t expired = 0;
+        while (expired < state.idle.size() &&
+               now - state.idle[expired].idle_since >= config_.idle_timeout) {
+            ++expired;
+        }
+        if (expired > 0) {
+            state.idle.erase(state.idle.begin(),
+                             state.idle.begin() + static_cast<std::ptrdiff_t>(expired));
+            stats_.reaped += expired;
+        }
+    }
+
+    auto give_back(const std::string& endpoint,
+                   std::shared_ptr<Connection> connection,
+                   bool broken) -> void {
+        {
+            std::lock_guard lock(mutex_);
+            auto& state = endpoints_[endpoint];
+            --state.leased;
+            if (broken) {
+                ++stats_.discarded;
+            } else if (config_.keep_alive && connection) {
+                auto now = clock::now();
+                reap_locked(state, now);
+                state.idle.push_back({std::move(connection), now});
+            }
+        }
+        available_.notify_one();
+    }
+
+    connection_pool_config config_;
+    factory_type factory_;
+    health_check_type health_check_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::unordered_map<std::string, endpoint_state> endpoints_;
+    connection_pool_statistics stats_;
+};
+
+}  // namespace kcenon::file_transfer
+
+#endif  // KCENON_FILE_TRANSFER_CLOUD_CLOUD_CONNECTION_POOL_H
@@ -13,6 +13,7 @@
 
 #include "cloud_stream_base.h"
 #include "cloud_config.h"
+#include "cloud_connection_pool.h"
 #include "kcenon/file_transfer/core/types.h"
 
 #include <chrono>
@@ -37,6 +38,7 @@ namespace kcenon::file_transfer {
  * - Request/response conversion
  * - Error handling standardization
  * - Timeout management
+ * - Per-endpoint keep-alive connection pooling
  *
  * @note This client is thread-safe for concurrent operations.
  */
@@ -45,9 +47,11 @@ public:
     /**
      * @brief Construct HTTP client with timeout
      * @param timeout Request timeout duration
+     * @param pool Connection pool settings
      */
     explicit cloud_http_client(
-        std::chrono::milliseconds timeout = std::chrono::milliseconds(30000));
+        std::chrono::milliseconds timeout = std::chrono::milliseconds(30000),
+        const connection_pool_config& pool = {});
 
     ~cloud_http_client() override;
 
@@ -163,6 +167,12 @@ public:
      */
     [[nodiscard]] auto is_available() const noexcept -> bool;
 
+    /**
+     * @brief Get connection pool counters
+     * @return Pool hits, misses and current idle/leased connections
+     */
+    [[nodiscard]] auto pool_statistics() const -> connection_pool_statistics;
+
 private:
     struct impl;
     std::unique_ptr<impl> impl_;
@@ -178,10 +188,12 @@ private:
 /**
  * @brief Factory function to create cloud HTTP client
  * @param timeout Request timeout
+ * @param pool Connection pool settings
  * @return Shared pointer to cloud HTTP client
  */
 [[nodiscard]] auto make_cloud_http_client(
-    std::chrono::milliseconds timeout = std::chrono::milliseconds(30000))
+    std::chrono::milliseconds timeout = std::chrono::milliseconds(30000),
+    const connection_pool_config& pool = {})
     -> std::shared_ptr<cloud_http_client>;
 
 }  // namespace kcenon::file_transfer
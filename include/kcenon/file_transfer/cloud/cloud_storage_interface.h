@@ -280,6 +280,8 @@ struct cloud_storage_statistics {
     uint64_t list_count = 0;           ///< Number of list operations
     uint64_t delete_count = 0;         ///< Number of delete operations
     uint64_t errors = 0;               ///< Total errors
+    uint64_t connection_pool_hits = 0;    ///< Requests served by a warm pooled connection
+    uint64_t connection_pool_misses = 0;  ///< Requests that opened a new connection
     std::chrono::steady_clock::time_point connected_at;  ///< Connection time
 };
 
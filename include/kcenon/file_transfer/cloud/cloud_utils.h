@@ -11,9 +11,17 @@
 #define KCENON_FILE_TRANSFER_CLOUD_CLOUD_UTILS_H
 
 #include "cloud_config.h"
+#include "kcenon/file_transfer/core/io_executor.h"
+#include "kcenon/file_transfer/core/types.h"
 
 #include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <span>
 #include <string>
@@ -236,6 +244,231 @@ auto calculate_retry_delay(const cloud_retry_policy& policy,
 auto is_retryable_status(int status_code,
                          const cloud_retry_policy& policy) -> bool;
 
+// ============================================================================
+// Connection Utilities
+// ============================================================================
+
+/**
+ * @brief Get the connection endpoint of a URL
+ *
+ * Requests with the same endpoint can share a keep-alive connection.
+ *
+ * @param url Request URL
+ * @return Lower-case "scheme://host:port" with the scheme's default port filled in
+ */
+auto connection_endpoint(const std::string& url) -> std::string;
+
+// ============================================================================
+// Streaming Upload Utilities
+// ============================================================================
+
+/**
+ * @brief Positional reader for uploading a file part by part
+ *
+ * Reads with pread(), so parts can be read at arbitrary offsets without a
+ * shared file position and without loading the whole file.
+ */
+class file_part_reader {
+public:
+    /**
+     * @brief Open a file for reading
+     * @param path File to read
+     * @return Reader or error (file_not_found, file_access_denied)
+     */
+    [[nodiscard]] static auto open(const std::filesystem::path& path)
+        -> result<file_part_reader>;
+
+    ~file_part_reader();
+
+    file_part_reader(const file_part_reader&) = delete;
+    auto operator=(const file_part_reader&) -> file_part_reader& = delete;
+    file_part_reader(file_part_reader&& other) noexcept;
+    auto operator=(file_part_reader&& other) noexcept -> file_part_reader&;
+
+    /**
+     * @brief Get the file size at open time
+     */
+    [[nodiscard]] auto size() const noexcept -> uint64_t { return size_; }
+
+    /**
+     * @brief Read up to buffer.size() bytes starting at offset
+     * @param offset File offset
+     * @param buffer Destination
+     * @return Bytes read (less than buffer.size() only at end of file)
+     */
+    [[nodiscard]] auto read_at(uint64_t offset, std::span<std::byte> buffer) const
+        -> result<std::size_t>;
+
+private:
+    file_part_reader(int fd, uint64_t size, std::filesystem::path path);
+
+    int fd_ = -1;
+    uint64_t size_ = 0;
+    std::filesystem::path path_;
+};
+
+/// Part buffer handed out by part_buffer_pool; returns to the pool when released
+using pooled_buffer = std::shared_ptr<std::vector<std::byte>>;
+
+/**
+ * @brief Fixed set of reusable part buffers
+ *
+ * acquire() blocks while every buffer is in use, which bounds the memory of
+ * a multipart upload to max_buffers x buffer_size regardless of object size.
+ * Buffers may outlive the pool; they are then freed instead of returned.
+ */
+class part_buffer_pool {
+public:
+    /**
+     * @brief Create a pool
+     * @param buffer_size Capacity of each buffer (the part size)
+     * @param max_buffers Maximum buffers in use at once
+     */
+    part_buffer_pool(std::size_t buffer_size, std::size_t max_buffers);
+
+    /**
+     * @brief Get an empty buffer with buffer_size() capacity, waiting if none is free
+     */
+    [[nodiscard]] auto acquire() -> pooled_buffer;
+
+    [[nodiscard]] auto buffer_size() const noexcept -> std::size_t { return buffer_size_; }
+    [[nodiscard]] auto max_buffers() const noexcept -> std::size_t { return max_buffers_; }
+
+    /**
+     * @brief Number of buffers currently handed out
+     */
+    [[nodiscard]] auto in_use() const -> std::size_t;
+
+    /**
+     * @brief Highest number of buffers handed out at once
+     */
+    [[nodiscard]] auto peak_in_use() const -> std::size_t;
+
+private:
+    struct state {
+        std::mutex mutex;
+        std::condition_variable available;
+        std::vector<std::vector<std::byte>> free;
+        std::size_t in_use = 0;
+        std::size_t peak_in_use = 0;
+    };
+
+    std::size_t buffer_size_;
+    std::size_t max_buffers_;
+    std::shared_ptr<state> state_;
+};
+
+// ============================================================================
+// Parallel Download Utilities
+// ============================================================================
+
+/**
+ * @brief Byte range [offset, offset + length) of an object
+ */
+struct byte_range {
+    uint64_t offset = 0;
+    uint64_t length = 0;
+};
+
+/**
+ * @brief Split an object into consecutive ranges
+ * @param total_size Object size in bytes
+ * @param range_size Maximum size of each range (0 = a single range)
+ * @return Ranges covering [0, total_size)
+ */
+auto split_byte_ranges(uint64_t total_size, uint64_t range_size) -> std::vector<byte_range>;
+
+/**
+ * @brief Format an HTTP Range header value
+ * @param range Byte range (length must be > 0)
+ * @return Header value, e.g. "bytes=0-1023"
+ */
+auto format_range_header(const byte_range& range) -> std::string;
+
+/**
+ * @brief Fetches one byte range of a remote object
+ *
+ * Must return exactly range.length bytes on success.
+ */
+using range_reader = std::function<result<std::vector<std::byte>>(const byte_range& range)>;
+
+/**
+ * @brief Positional writer for assembling a downloaded file range by range
+ *
+ * The file is created at its final size up front and ranges are written
+ * with pwrite(), so they can complete in any order.
+ */
+class file_range_writer {
+public:
+    /**
+     * @brief Create (or truncate) a file and size it
+     * @param path Destination file; parent directories are created
+     * @param size Final file size in bytes
+     * @return Writer or error (file_access_denied, file_write_error)
+     */
+    [[nodiscard]] static auto create(const std::filesystem::path& path, uint64_t size)
+        -> result<file_range_writer>;
+
+    ~file_range_writer();
+
+    file_range_writer(const file_range_writer&) = delete;
+    auto operator=(const file_range_writer&) -> file_range_writer& = delete;
+    file_range_writer(file_range_writer&& other) noexcept;
+    auto operator=(file_range_writer&& other) noexcept -> file_range_writer&;
+
+    /**
+     * @brief Write data at an offset
+     * @param offset Byte offset in the file
+     * @param data Bytes to write
+     * @return Success or file_write_error
+     */
+    [[nodiscard]] auto write_at(uint64_t offset, std::span<const std::byte> data) const
+        -> result<void>;
+
+private:
+    file_range_writer(int fd, std::filesystem::path path);
+
+    int fd_ = -1;
+    std::filesystem::path path_;
+};
+
+/**
+ * @brief Outcome of a parallel ranged download
+ */
+struct parallel_download_result {
+    uint64_t bytes_written = 0;
+    std::size_t range_count = 0;
+    std::size_t retried_ranges = 0;  ///< Range attempts that were retried
+};
+
+/**
+ * @brief Download an object into a file as concurrent ranged reads
+ *
+ * At most max_concurrency ranges are in flight on the io_scope's lane; each
+ * range is written with pwrite() as soon as it arrives. A failed range is
+ * retried on its own with the policy's backoff, up to
+ * config.max_range_retries times, without restarting the other ranges.
+ * Not-found and access errors fail immediately. On failure the partially
+ * written file is removed.
+ *
+ * @param io Scope whose lane runs the range reads
+ * @param reader Fetches one range
+ * @param object_size Object size in bytes
+ * @param local_path Destination file
+ * @param config Range size and retry limit
+ * @param max_concurrency Maximum ranges in flight (typically connection_pool_size)
+ * @param retry Backoff policy between attempts of a range
+ * @return Download statistics or the first non-retryable error
+ */
+auto download_ranges_to_file(io_scope& io,
+                             const range_reader& reader,
+                             uint64_t object_size,
+                             const std::filesystem::path& local_path,
+                             const parallel_download_config& config,
+                             std::size_t max_concurrency,
+                             const cloud_retry_policy& retry)
+    -> result<parallel_download_result>;
+
 }  // namespace kcenon::file_transfer::cloud_utils
 
 #endif  // KCENON_FILE_TRANSFER_CLOUD_CLOUD_UTILS_H
@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "cloud_config.h"
+#include "cloud_connection_pool.h"
 #include "cloud_credentials.h"
 #include "cloud_error.h"
 #include "cloud_storage_interface.h"
@@ -82,6 +83,14 @@ public:
         const std::string& url,
         const std::map<std::string, std::string>& headers)
         -> result<gcs_http_response> = 0;
+
+    /**
+     * @brief Get connection pool counters
+     * @return Pool counters; clients without a pool report zeros
+     */
+    [[nodiscard]] virtual auto pool_statistics() const -> connection_pool_statistics {
+        return {};
+    }
 };
 
 /**
@@ -126,7 +135,9 @@ private:
 /**
  * @brief GCS download stream implementation
  *
- * Implements streaming download from Google Cloud Storage.
+ * Implements streaming download from Google Cloud Storage with ranged GETs
+ * of at least parallel_download.range_size bytes. Reads go through the
+ * gcs_storage that created the stream, which must outlive it.
  */
 class gcs_download_stream : public cloud_download_stream {
 public:
@@ -23,6 +23,8 @@
 
 namespace kcenon::file_transfer {
 
+class cloud_http_client;
+
 /**
  * @brief S3 upload stream implementation for multipart uploads
  */
@@ -53,7 +55,8 @@ private:
         const std::string& key,
         const s3_config& config,
         std::shared_ptr<credential_provider> credentials,
-        const cloud_transfer_options& options);
+        const cloud_transfer_options& options,
+        std::shared_ptr<cloud_http_client> http_client = nullptr);
 
     struct impl;
     std::unique_ptr<impl> impl_;
@@ -61,6 +64,10 @@ private:
 
 /**
  * @brief S3 download stream implementation
+ *
+ * Reads the object with ranged GETs of at least
+ * parallel_download.range_size bytes through the s3_storage that created
+ * it, which must outlive the stream.
  */
 class s3_download_stream : public cloud_download_stream {
 public:
@@ -14,8 +14,11 @@
 #include <condition_variable>
 #include <cstddef>
 #include <future>
+#include <memory>
 #include <mutex>
 
+#include "kcenon/file_transfer/core/io_executor.h"
+
 namespace kcenon::file_transfer {
 
 /**
@@ -75,6 +78,9 @@ public:
     /**
      * @brief Async version of acquire
      *
+     * Waiting does not occupy a thread: while tokens are short, the attempt
+     * is re-armed as a delayed task on the shared io_executor.
+     *
      * @param bytes Number of bytes to transfer
      * @return Future that completes when tokens are available
      */
@@ -148,6 +154,16 @@ private:
     [[nodiscard]] auto calculate_wait_time(std::size_t bytes) const
         -> std::chrono::microseconds;
 
+    struct async_waiter;
+
+    /**
+     * @brief Take tokens for an async waiter, or re-arm the attempt
+     * @param waiter Pending acquire_async call
+     * @param bytes Required bytes
+     */
+    auto acquire_or_reschedule(std::shared_ptr<async_waiter> waiter, std::size_t bytes)
+        -> void;
+
     mutable std::mutex mutex_;
     std::condition_variable cv_;
 
@@ -158,6 +174,9 @@ private:
     double tokens_;
     double capacity_;
     std::chrono::steady_clock::time_point last_refill_;
+
+    // Pending acquire_async retries; declared last so they end before the state
+    io_scope async_scope_{"bandwidth"};
 };
 
 /**
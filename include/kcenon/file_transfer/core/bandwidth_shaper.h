@@ -0,0 +1,204 @@
+/**
+ * @file bandwidth_shaper.h
+ * @brief Hierarchical, non-blocking bandwidth shaping
+ *
+ * Shapes traffic over a three-level tree: one global bucket, one node per
+ * tenant (a client, or any other grouping the caller picks) and one node
+ * per transfer. Unlike bandwidth_limiter, a throttled acquire never blocks
+ * its caller: it is parked on a timer wheel and completed through a
+ * callback once the tokens are there.
+ */
+
+#ifndef KCENON_FILE_TRANSFER_CORE_BANDWIDTH_SHAPER_H
+#define KCENON_FILE_TRANSFER_CORE_BANDWIDTH_SHAPER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "kcenon/file_transfer/core/types.h"
+
+namespace kcenon::file_transfer {
+
+/**
+ * @brief Rates of one tenant or transfer node
+ *
+ * A node may always send at its guaranteed rate, even when that pushes its
+ * parent past its own limit. Above that it borrows: it may keep sending up
+ * to its ceiling as long as its parent still has room, so capacity a sibling
+ * leaves unused goes to whoever is backlogged.
+ */
+struct shaper_limits {
+    std::size_t rate = 0;  ///< Guaranteed bytes/sec (0 = none, everything is borrowed)
+    std::size_t ceil = 0;  ///< Maximum bytes/sec including borrowing (0 = parent's)
+};
+
+/**
+ * @brief Counters of a bandwidth_shaper
+ */
+struct shaper_stats {
+    uint64_t granted = 0;         ///< Acquires granted on the first try
+    uint64_t borrowed = 0;        ///< Of those, granted above the node's guaranteed rate
+    uint64_t parked = 0;          ///< Acquires that had to wait on the timer wheel
+    uint64_t released = 0;        ///< Parked acquires completed since
+    uint64_t dropped = 0;         ///< Parked acquires discarded by drop_parked()
+    std::size_t waiting = 0;      ///< Acquires parked right now
+    uint64_t granted_bytes = 0;   ///< Bytes granted, first try or after parking
+};
+
+/**
+ * @brief Hierarchical token-bucket shaper
+ *
+ * Each node keeps its buckets as a single atomic "theoretical arrival time"
+ * per rate (GCRA), so an acquire that finds tokens available is a few
+ * compare-and-swap operations and never takes a lock on the accounting.
+ * A bucket admits a request while its debt is within the burst window and
+ * then charges the full size, so chunks larger than the burst still pass
+ * and the long-run rate stays exact.
+ *
+ * Throttled acquires wait on a hashed timer wheel (1ms ticks) advanced by
+ * delayed tasks on the shared io_executor; nothing sleeps on a thread.
+ * Parked acquires are retried when their slot comes up, in arrival order
+ * within a slot. The callback runs on an io_executor worker and should only
+ * hand the work on, e.g. enqueue a job.
+ *
+ * @code
+ * bandwidth_shaper shaper(100 * 1024 * 1024);  // 100 MB/s in total
+ * shaper.set_tenant_limits(7, {20 * 1024 * 1024, 0});  // 20 MB/s guaranteed
+ *
+ * if (!shaper.acquire_or_park(7, id, chunk.size(), [=] { send(chunk); })) {
+ *     return;  // send() runs once the tokens are there
+ * }
+ * send(chunk);
+ * @endcode
+ */
+class bandwidth_shaper {
+public:
+    /// Completes a parked acquire
+    using ready_callback = std::function<void()>;
+
+    /**
+     * @brief Nodes an acquire is charged to, resolved once
+     *
+     * Holding a path skips the node lookup, leaving only the lock-free
+     * bucket updates. A path stays valid after its transfer is removed but
+     * then no longer picks up limit changes of that transfer.
+     */
+    class path {
+    public:
+        path() = default;
+
+    private:
+        friend class bandwidth_shaper;
+        std::shared_ptr<void> leaf_;
+    };
+
+    /**
+     * @brief Create a shaper
+     * @param global_limit Total bytes/sec over all tenants (0 = unlimited)
+     * @param burst How far a bucket may run ahead of its rate
+     */
+    explicit bandwidth_shaper(std::size_t global_limit = 0,
+                              std::chrono::milliseconds burst = std::chrono::milliseconds(50));
+
+    /**
+     * @brief Destructor; parked acquires are dropped without their callback
+     */
+    ~bandwidth_shaper();
+
+    bandwidth_shaper(const bandwidth_shaper&) = delete;
+    auto operator=(const bandwidth_shaper&) -> bandwidth_shaper& = delete;
+    bandwidth_shaper(bandwidth_shaper&&) = delete;
+    auto operator=(bandwidth_shaper&&) -> bandwidth_shaper& = delete;
+
+    /**
+     * @brief Set the total rate
+     * @param bytes_per_second New limit (0 = unlimited)
+     */
+    auto set_global_limit(std::size_t bytes_per_second) -> void;
+
+    /**
+     * @brief Get the total rate
+     * @return Limit in bytes per second (0 = unlimited)
+     */
+    [[nodiscard]] auto global_limit() const -> std::size_t;
+
+    /**
+     * @brief Set a tenant's guaranteed rate and ceiling
+     */
+    auto set_tenant_limits(uint64_t tenant, shaper_limits limits) -> void;
+
+    /**
+     * @brief Set a transfer's guaranteed rate and ceiling
+     *
+     * The transfer is placed under the given tenant; transfers without
+     * limits of their own are charged to their tenant directly.
+     */
+    auto set_transfer_limits(uint64_t tenant, const transfer_id& id, shaper_limits limits) -> void;
+
+    /**
+     * @brief Forget a transfer's limits
+     */
+    auto remove_transfer(const transfer_id& id) -> void;
+
+    /**
+     * @brief Resolve the nodes a transfer is charged to
+     */
+    [[nodiscard]] auto resolve(uint64_t tenant, const transfer_id& id) const -> path;
+
+    /**
+     * @brief Take tokens if available, without waiting
+     * @return true if granted
+     */
+    [[nodiscard]] auto try_acquire(uint64_t tenant, const transfer_id& id, std::size_t bytes)
+        -> bool;
+
+    /**
+     * @brief Take tokens if available, without waiting
+     * @return true if granted
+     */
+    [[nodiscard]] auto try_acquire(const path& p, std::size_t bytes) -> bool;
+
+    /**
+     * @brief Take tokens now or park until they are available
+     * @param on_ready Called once the tokens are taken, only if this returns false
+     * @return true if granted immediately; on_ready is not called
+     */
+    [[nodiscard]] auto acquire_or_park(uint64_t tenant, const transfer_id& id, std::size_t bytes,
+                                       ready_callback on_ready) -> bool;
+
+    /**
+     * @brief Take tokens now or park until they are available
+     * @param on_ready Called once the tokens are taken, only if this returns false
+     * @return true if granted immediately; on_ready is not called
+     */
+    [[nodiscard]] auto acquire_or_park(const path& p, std::size_t bytes, ready_callback on_ready)
+        -> bool;
+
+    /**
+     * @brief Complete every parked acquire now, regardless of tokens
+     *
+     * Used when draining at shutdown. Callbacks run on the calling thread.
+     */
+    auto release_parked() -> void;
+
+    /**
+     * @brief Discard every parked acquire without calling its callback
+     */
+    auto drop_parked() -> void;
+
+    /**
+     * @brief Counters since construction
+     */
+    [[nodiscard]] auto stats() const -> shaper_stats;
+
+private:
+    struct impl;
+    std::unique_ptr<impl> impl_;
+};
+
+}  // namespace kcenon::file_transfer
+
+#endif  // KCENON_FILE_TRANSFER_CORE_BANDWIDTH_SHAPER_H
@@ -6,21 +6,55 @@
 #ifndef KCENON_FILE_TRANSFER_CORE_CHECKSUM_H
 #define KCENON_FILE_TRANSFER_CORE_CHECKSUM_H
 
+#include <kcenon/file_transfer/core/chunk_types.h>
+#include <kcenon/file_transfer/core/protocol_types.h>
 #include <kcenon/file_transfer/core/types.h>
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <span>
 #include <string>
 
 namespace kcenon::file_transfer {
 
+/**
+ * @brief Chunk digest and byte histogram of a buffer, gathered in one pass
+ *
+ * The histogram gives the order-0 entropy of the data, which tells random
+ * or already compressed payloads apart from ones worth compressing without
+ * another walk over the bytes.
+ */
+struct byte_scan {
+    chunk_integrity algorithm = chunk_integrity::crc32;  ///< Algorithm of digest
+    uint64_t digest = 0;                    ///< Same value as checksum::digest()
+    uint64_t size = 0;                      ///< Bytes scanned
+    std::array<uint64_t, 256> histogram{};  ///< Occurrences of each byte value
+
+    /**
+     * @brief Check whether every byte scanned was zero
+     */
+    [[nodiscard]] auto all_zero() const noexcept -> bool { return histogram[0] == size; }
+
+    /**
+     * @brief Order-0 entropy in bits per byte, 0 to 8
+     *
+     * Bias-corrected for the sample size, so random data scores close to 8
+     * even for a few kilobytes.
+     */
+    [[nodiscard]] auto entropy() const -> double;
+};
+
 /**
  * @brief Checksum utilities for CRC32 and SHA-256 calculations
  *
  * Provides static methods for:
- * - CRC32 calculation for chunk integrity verification
+ * - CRC32, CRC32C and XXH3-64 calculation for chunk integrity verification
  * - SHA-256 calculation for file integrity verification
+ *
+ * CRC32C uses the SSE4.2 or ARMv8 CRC instructions when the CPU has them.
+ * XXH3-64 is available when built with FILE_TRANS_ENABLE_XXHASH.
  */
 class checksum {
 public:
@@ -31,6 +65,60 @@ public:
      */
     [[nodiscard]] static auto crc32(std::span<const std::byte> data) -> uint32_t;
 
+    /**
+     * @brief Calculate CRC32C (Castagnoli) checksum of data
+     * @param data Input data span
+     * @return CRC32C checksum value
+     */
+    [[nodiscard]] static auto crc32c(std::span<const std::byte> data) -> uint32_t;
+
+    /**
+     * @brief Calculate the chunk digest of data with a given algorithm
+     * @param algorithm Integrity algorithm
+     * @param data Input data span
+     * @return Digest, zero-extended for 32-bit algorithms; 0 if unsupported
+     */
+    [[nodiscard]] static auto digest(chunk_integrity algorithm,
+                                     std::span<const std::byte> data) -> uint64_t;
+
+    /**
+     * @brief Verify the chunk digest of data
+     * @param algorithm Integrity algorithm
+     * @param data Input data span
+     * @param expected Expected digest
+     * @return true if the algorithm is supported and the digest matches
+     */
+    [[nodiscard]] static auto verify(chunk_integrity algorithm,
+                                     std::span<const std::byte> data,
+                                     uint64_t expected) -> bool;
+
+    /**
+     * @brief Check whether this build can compute an integrity algorithm
+     */
+    [[nodiscard]] static auto is_supported(chunk_integrity algorithm) -> bool;
+
+    /**
+     * @brief Integrity capability bits this build can advertise
+     *
+     * CRC32 is implied and has no bit of its own.
+     */
+    [[nodiscard]] static auto integrity_capabilities() -> client_capabilities;
+
+    /**
+     * @brief Calculate the chunk digest and byte histogram of data in a single pass
+     *
+     * Reads each byte once, while it is in cache, instead of once for the
+     * checksum and again for the compressibility estimate. XXH3-64 has no
+     * per-byte step to share, so it hashes the buffer after the histogram.
+     *
+     * @param data Input data span
+     * @param algorithm Integrity algorithm of the digest
+     * @return Digest and histogram
+     */
+    [[nodiscard]] static auto scan(std::span<const std::byte> data,
+                                   chunk_integrity algorithm = chunk_integrity::crc32)
+        -> byte_scan;
+
     /**
      * @brief Verify CRC32 checksum of data
      * @param data Input data span
@@ -72,6 +160,41 @@ private:
     static auto init_crc32_table() -> const uint32_t*;
 };
 
+/**
+ * @brief Incremental SHA-256
+ *
+ * Gives the same digest as checksum::sha256() over everything passed to
+ * update(), so a file can be hashed from the reads that split it into
+ * chunks instead of in a separate pass over the disk.
+ */
+class sha256_hasher {
+public:
+    sha256_hasher();
+
+    /**
+     * @brief Hash the next bytes of the message
+     * @param data Input data span
+     */
+    void update(std::span<const std::byte> data);
+
+    /**
+     * @brief Finish the digest and start over
+     * @return SHA-256 hash as hex string
+     */
+    [[nodiscard]] auto finalize() -> std::string;
+
+    /**
+     * @brief Bytes passed to update() since construction or finalize()
+     */
+    [[nodiscard]] auto bytes_hashed() const -> uint64_t { return total_bytes_; }
+
+private:
+    std::array<uint32_t, 8> state_;
+    std::array<uint8_t, 64> block_{};
+    std::size_t block_pos_ = 0;
+    uint64_t total_bytes_ = 0;
+};
+
 }  // namespace kcenon::file_transfer
 
 #endif  // KCENON_FILE_TRANSFER_CORE_CHECKSUM_H
@@ -6,15 +6,18 @@
 #ifndef KCENON_FILE_TRANSFER_CORE_CHUNK_ASSEMBLER_H
 #define KCENON_FILE_TRANSFER_CORE_CHUNK_ASSEMBLER_H
 
+#include <kcenon/file_transfer/core/fec_codec.h>
+#include <kcenon/file_transfer/core/integrity_policy.h>
+#include <kcenon/file_transfer/core/transfer_registry.h>
 #include <kcenon/file_transfer/core/types.h>
 
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
-#include <shared_mutex>
-#include <unordered_map>
 #include <vector>
 
 namespace kcenon::file_transfer {
@@ -24,6 +27,12 @@ namespace kcenon::file_transfer {
  *
  * Handles out-of-order chunk reception, tracks missing chunks,
  * and performs integrity verification.
+ *
+ * Parity chunks (chunk_flags::parity, see fec_encoder) are accepted
+ * alongside data: as soon as a group has lost no more chunks than parity
+ * arrived for it, the lost chunks are rebuilt from the parity and the
+ * chunks already written, checked against their original checksums and
+ * stored as if received.
  */
 class chunk_assembler {
 public:
@@ -47,13 +56,44 @@ public:
         uint64_t file_size,
         uint64_t total_chunks) -> result<void>;
 
+    /**
+     * @brief Start an assembly session whose chunks may vary in size
+     * @param id Transfer ID
+     * @param filename Output filename
+     * @param file_size Expected file size
+     * @return Success or error
+     *
+     * Chunks are placed by their chunk_offset and may each have any size
+     * up to chunk_config::max_chunk_size. The chunk count becomes known
+     * when the chunk flagged last_chunk arrives; the session is complete
+     * once every chunk up to it has arrived and together they cover the
+     * whole file exactly.
+     */
+    [[nodiscard]] auto start_variable_session(
+        const transfer_id& id,
+        const std::string& filename,
+        uint64_t file_size) -> result<void>;
+
     /**
      * @brief Process an incoming chunk
-     * @param c Chunk to process
+     * @param c Data or parity chunk to process
      * @return Success or error
      */
     [[nodiscard]] auto process_chunk(const chunk& c) -> result<void>;
 
+    /**
+     * @brief Process a chunk that has already passed some integrity checks
+     *
+     * The checksum is verified only if integrity_policy::outstanding()
+     * still asks for it, so a pipeline stage that checked the chunk, or
+     * decrypted it under an AEAD tag, does not pay for a second pass.
+     *
+     * @param c Chunk to process
+     * @param verified Checks the chunk has passed
+     * @return Success or error
+     */
+    [[nodiscard]] auto process_chunk(const chunk& c, integrity_check verified) -> result<void>;
+
     /**
      * @brief Check if assembly is complete
      * @param id Transfer ID
@@ -65,10 +105,22 @@ public:
      * @brief Get indices of missing chunks
      * @param id Transfer ID
      * @return Vector of missing chunk indices
+     *
+     * For a variable-size session whose last chunk has not arrived yet,
+     * only indices below the highest one received are reported; use
+     * get_missing_ranges() for the rest of the file.
      */
     [[nodiscard]] auto get_missing_chunks(const transfer_id& id) const
         -> std::vector<uint64_t>;
 
+    /**
+     * @brief Get the parts of the file not received yet
+     * @param id Transfer ID
+     * @return Byte ranges not covered by any received chunk, in file order
+     */
+    [[nodiscard]] auto get_missing_ranges(const transfer_id& id) const
+        -> std::vector<file_byte_range>;
+
     /**
      * @brief Finalize assembly and verify integrity
      * @param id Transfer ID
@@ -100,6 +152,18 @@ public:
      */
     [[nodiscard]] auto has_session(const transfer_id& id) const -> bool;
 
+    /**
+     * @brief Set callback invoked for each chunk rebuilt from FEC parity
+     *
+     * Called from process_chunk() after the chunk is stored, so the
+     * receiver can acknowledge it instead of waiting for a retransmission,
+     * and use its data as it would a received chunk's.
+     *
+     * @param callback Function receiving the transfer ID and the rebuilt chunk
+     */
+    void on_chunk_recovered(
+        std::function<void(const transfer_id&, const chunk&)> callback);
+
     // Move-only
     chunk_assembler(chunk_assembler&&) noexcept;
     auto operator=(chunk_assembler&&) noexcept -> chunk_assembler&;
@@ -114,24 +178,55 @@ private:
         std::filesystem::path temp_file_path;
         std::filesystem::path final_path;
         std::string filename;
-        std::unique_ptr<std::ofstream> file;
+        std::unique_ptr<std::fstream> file;  ///< Read back to rebuild chunks from parity
         uint64_t file_size;
         uint64_t total_chunks;
         std::vector<bool> received_chunks;
         uint64_t received_count;
         uint64_t bytes_written;
+        uint64_t recovered_count;
+        bool variable_chunks;
+        bool total_known;
+        bool finalized;    ///< Finalized or cancelled; the entry is leaving the registry
+        std::map<uint64_t, uint64_t> received_ranges;  ///< offset -> end of each received chunk
+        std::map<uint64_t, fec_group> fec_groups;      ///< First index -> parity of an incomplete group
         mutable std::mutex mutex;
 
-        assembly_context() : file_size(0), total_chunks(0), received_count(0), bytes_written(0) {}
+        assembly_context()
+            : file_size(0), total_chunks(0), received_count(0), bytes_written(0),
+              recovered_count(0), variable_chunks(false), total_known(true), finalized(false) {}
+
+        [[nodiscard]] auto has_chunk(uint64_t index) const -> bool {
+            return index < received_chunks.size() && received_chunks[index];
+        }
+
+        [[nodiscard]] auto complete() const -> bool {
+            if (!variable_chunks) {
+                return received_count == total_chunks;
+            }
+            return total_known && received_count == total_chunks && bytes_written == file_size;
+        }
     };
 
     std::filesystem::path output_dir_;
-    std::unordered_map<transfer_id, std::unique_ptr<assembly_context>> contexts_;
-    mutable std::shared_mutex contexts_mutex_;
-
-    [[nodiscard]] auto verify_chunk_crc32(const chunk& c) const -> bool;
-    [[nodiscard]] auto get_context(const transfer_id& id) -> assembly_context*;
-    [[nodiscard]] auto get_context(const transfer_id& id) const -> const assembly_context*;
+    transfer_registry<assembly_context> contexts_;
+    std::function<void(const transfer_id&, const chunk&)> recovered_callback_;
+
+    [[nodiscard]] auto open_session(const transfer_id& id, const std::string& filename,
+                                    uint64_t file_size, uint64_t total_chunks,
+                                    bool variable_chunks) -> result<void>;
+    [[nodiscard]] static auto accept_variable_chunk(assembly_context& ctx, const chunk& c)
+        -> result<void>;
+    [[nodiscard]] auto store_chunk(assembly_context& ctx, const chunk& c,
+                                   integrity_check verified) const -> result<void>;
+    [[nodiscard]] auto accept_parity(assembly_context& ctx, const chunk& c,
+                                     std::vector<chunk>& recovered) const -> result<void>;
+    auto recover_group(assembly_context& ctx, const transfer_id& id,
+                       std::map<uint64_t, fec_group>::iterator group,
+                       std::vector<chunk>& recovered) const -> void;
+    [[nodiscard]] auto verify_chunk_checksum(const chunk& c) const -> bool;
+    [[nodiscard]] auto get_context(const transfer_id& id) const
+        -> std::shared_ptr<assembly_context>;
 };
 
 }  // namespace kcenon::file_transfer
@@ -6,6 +6,7 @@
 #ifndef KCENON_FILE_TRANSFER_CORE_CHUNK_CONFIG_H
 #define KCENON_FILE_TRANSFER_CORE_CHUNK_CONFIG_H
 
+#include <kcenon/file_transfer/core/chunk_types.h>
 #include <kcenon/file_transfer/core/types.h>
 
 #include <cstddef>
@@ -14,6 +15,10 @@ namespace kcenon::file_transfer {
 
 /**
  * @brief Configuration for chunk operations
+ *
+ * chunk_size is the size a transfer starts with. Chunks of one transfer
+ * may later change size anywhere within [min_chunk_size, max_chunk_size]
+ * (see chunk_size_controller); each chunk carries its own offset and size.
  */
 struct chunk_config {
     /// Default chunk size (256KB)
@@ -22,12 +27,22 @@ struct chunk_config {
     /// Minimum allowed chunk size (64KB)
     static constexpr std::size_t min_chunk_size = 64 * 1024;
 
-    /// Maximum allowed chunk size (1MB)
-    static constexpr std::size_t max_chunk_size = 1024 * 1024;
+    /// Maximum allowed chunk size (64MB), for fast LAN links
+    static constexpr std::size_t max_chunk_size = 64 * 1024 * 1024;
 
     /// Chunk size to use for splitting
     std::size_t chunk_size = default_chunk_size;
 
+    /**
+     * Send holes and all-zero chunks as zero_range descriptors without
+     * payload. Holes are found with SEEK_DATA/SEEK_HOLE where the platform
+     * has them and are not read at all; other chunks are read and checked.
+     */
+    bool elide_zero_ranges = false;
+
+    /// Per-chunk checksum algorithm, as negotiated with the peer
+    chunk_integrity integrity = chunk_integrity::crc32;
+
     /**
      * @brief Default constructor
      */
@@ -0,0 +1,181 @@
+/**
+ * @file chunk_size_controller.h
+ * @brief Adaptive chunk sizing from link and CPU measurements
+ *
+ * Picks the chunk size of a transfer from a probe of the link before the
+ * first chunk is sent and keeps adjusting it from what each chunk actually
+ * cost: large chunks on fast, clean links amortise per-chunk overhead,
+ * small chunks on lossy links keep each retransmission cheap.
+ */
+
+#ifndef KCENON_FILE_TRANSFER_CORE_CHUNK_SIZE_CONTROLLER_H
+#define KCENON_FILE_TRANSFER_CORE_CHUNK_SIZE_CONTROLLER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "kcenon/file_transfer/core/chunk_config.h"
+
+namespace kcenon::file_transfer {
+
+/**
+ * @brief Link properties measured before a transfer starts
+ */
+struct link_probe {
+    std::chrono::microseconds rtt{0};  ///< Round-trip time
+    uint64_t bandwidth = 0;            ///< Bytes/sec (0 = unknown)
+    /// Fraction of packets lost and not recovered by the transport, 0..1 (0 over TCP)
+    double loss_rate = 0.0;
+};
+
+/**
+ * @brief Measured cost of one chunk
+ */
+struct chunk_sample {
+    std::size_t bytes = 0;                    ///< Chunk payload size
+    std::chrono::microseconds wire_time{0};   ///< From first byte to last byte sent
+    std::chrono::microseconds cpu_time{0};    ///< Read, checksum, compress and encrypt
+    bool retransmitted = false;               ///< Had to be sent more than once
+};
+
+/**
+ * @brief Configuration for chunk_size_controller
+ */
+struct adaptive_chunk_config {
+    /// Smallest chunk the controller picks
+    std::size_t min_size = chunk_config::min_chunk_size;
+
+    /// Largest chunk the controller picks
+    std::size_t max_size = chunk_config::max_chunk_size;
+
+    /// Fixed cost of a chunk besides CPU work: framing, syscalls, acknowledgement
+    std::chrono::microseconds per_chunk_overhead{100};
+
+    /// Upper bound on the wire time of one chunk, so progress and cancellation stay responsive
+    std::chrono::milliseconds max_chunk_time{250};
+
+    /// Packet payload size the probe's loss rate refers to
+    std::size_t packet_size = 1460;
+
+    /// Chunks in flight; chunks must be large enough for these to cover the link's BDP
+    std::size_t window_chunks = 16;
+
+    /// Samples between two adjustments
+    std::size_t adjust_interval = 8;
+
+    /// Weight of a new sample in the moving averages, 0..1
+    double smoothing = 0.25;
+
+    /**
+     * @brief Validate configuration
+     * @return Success if valid, error otherwise
+     */
+    [[nodiscard]] auto validate() const -> result<void>;
+};
+
+/**
+ * @brief Counters and estimates of a chunk_size_controller
+ */
+struct chunk_size_stats {
+    std::size_t chunk_size = 0;            ///< Size the next chunk should have
+    uint64_t samples = 0;                  ///< Chunks recorded
+    uint64_t retransmits = 0;              ///< Of those, retransmitted
+    uint64_t adjustments = 0;              ///< Times the size changed after start()
+    double bandwidth = 0.0;                ///< Estimated bytes/sec on the wire
+    double retransmit_rate = 0.0;          ///< Smoothed fraction of chunks retransmitted
+    double cpu_ns_per_byte = 0.0;          ///< Estimated CPU time per payload byte
+    std::chrono::microseconds cpu_per_chunk{0};  ///< Estimated fixed CPU time per chunk
+};
+
+/**
+ * @brief Chooses and adapts the chunk size of one transfer
+ *
+ * The size maximises expected goodput s / ((o + s/B) * e^(λs)): the time
+ * to send a chunk of s bytes at B bytes/sec with fixed per-chunk cost o,
+ * times the expected number of attempts when each byte is lost with rate
+ * λ. The optimum is the positive root of λ/B * s² + λo * s - o = 0; with
+ * no loss it grows without bound and is capped by max_chunk_time.
+ * The result is kept at least B * rtt / window_chunks so a full window of
+ * chunks covers the link, rounded to a power of two and clamped to
+ * [min_size, max_size].
+ *
+ * At runtime B comes from the smoothed throughput of chunks that went
+ * through first time, λ from the smoothed fraction of chunks retransmitted,
+ * and o adds the fixed part of the CPU cost, estimated by a moving
+ * least-squares fit of cpu_time against chunk size. The size is
+ * re-evaluated every adjust_interval samples and moves at most by a factor
+ * of four at a time. All members are thread-safe.
+ *
+ * @code
+ * chunk_size_controller controller;
+ * auto size = controller.start({std::chrono::milliseconds(2), 1'250'000'000, 0.0});
+ * while (auto chunk = read(size)) {
+ *     auto sample = send(*chunk);
+ *     size = controller.record(sample);
+ * }
+ * @endcode
+ */
+class chunk_size_controller {
+public:
+    /**
+     * @brief Create a controller; starts at the default chunk size
+     * @param config Bounds and tuning, expected to pass validate()
+     */
+    explicit chunk_size_controller(adaptive_chunk_config config = {});
+
+    ~chunk_size_controller();
+
+    chunk_size_controller(const chunk_size_controller&) = delete;
+    auto operator=(const chunk_size_controller&) -> chunk_size_controller& = delete;
+    chunk_size_controller(chunk_size_controller&&) noexcept;
+    auto operator=(chunk_size_controller&&) noexcept -> chunk_size_controller&;
+
+    /**
+     * @brief Chunk size for a link, before anything has been sent
+     * @param probe Measured link properties
+     * @param config Bounds and tuning
+     * @return Chunk size, or the default size if the bandwidth is unknown
+     */
+    [[nodiscard]] static auto initial_size(const link_probe& probe,
+                                           const adaptive_chunk_config& config = {})
+        -> std::size_t;
+
+    /**
+     * @brief Reset measurements and start from a link probe
+     * @param probe Measured link properties
+     * @return Size of the first chunk
+     */
+    auto start(const link_probe& probe) -> std::size_t;
+
+    /**
+     * @brief Record the cost of a chunk
+     * @param sample Measurements of the chunk
+     * @return Size the next chunk should have
+     */
+    auto record(const chunk_sample& sample) -> std::size_t;
+
+    /**
+     * @brief Get the size the next chunk should have
+     */
+    [[nodiscard]] auto chunk_size() const -> std::size_t;
+
+    /**
+     * @brief Get counters and current estimates
+     */
+    [[nodiscard]] auto stats() const -> chunk_size_stats;
+
+    /**
+     * @brief Get the configuration
+     */
+    [[nodiscard]] auto config() const -> const adaptive_chunk_config&;
+
+private:
+    struct impl;
+    std::unique_ptr<impl> impl_;
+};
+
+}  // namespace kcenon::file_transfer
+
+#endif  // KCENON_FILE_TRANSFER_CORE_CHUNK_SIZE_CONTROLLER_H
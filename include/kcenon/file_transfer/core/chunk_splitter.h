@@ -6,7 +6,9 @@
 #ifndef KCENON_FILE_TRANSFER_CORE_CHUNK_SPLITTER_H
 #define KCENON_FILE_TRANSFER_CORE_CHUNK_SPLITTER_H
 
+#include <kcenon/file_transfer/core/checksum.h>
 #include <kcenon/file_transfer/core/chunk_config.h>
+#include <kcenon/file_transfer/core/digest_cache.h>
 #include <kcenon/file_transfer/core/types.h>
 
 #include <filesystem>
@@ -21,6 +23,11 @@ namespace kcenon::file_transfer {
  *
  * Provides memory-efficient file splitting using an iterator pattern.
  * Files are read in chunks without loading the entire file into memory.
+ *
+ * With chunk_config::elide_zero_ranges, chunks lying in a hole of a sparse
+ * file or holding only zeros come out as zero_range descriptors: no data,
+ * original_size set to the chunk's length. Indices, offsets and flags are
+ * the same as without elision.
  */
 class chunk_splitter {
 public:
@@ -51,7 +58,7 @@ public:
 
         /**
          * @brief Get total number of chunks
-         * @return Total chunk count
+         * @return Total chunk count at the current chunk size
          */
         [[nodiscard]] auto total_chunks() const -> uint64_t;
 
@@ -61,6 +68,45 @@ public:
          */
         [[nodiscard]] auto file_size() const -> uint64_t;
 
+        /**
+         * @brief Get the size of the chunks next() returns from now on
+         * @return Chunk size in bytes (the last chunk may be shorter)
+         */
+        [[nodiscard]] auto chunk_size() const -> std::size_t;
+
+        /**
+         * @brief Change the size of the remaining chunks
+         * @param size New chunk size, within chunk_config's bounds
+         * @return Success, or error if the size is out of bounds
+         *
+         * Chunks already returned keep their size; each chunk carries its
+         * own offset and size, so the receiver needs a variable-size
+         * session (chunk_assembler::start_variable_session) to take them.
+         * Typically fed from chunk_size_controller::record().
+         */
+        [[nodiscard]] auto set_chunk_size(std::size_t size) -> result<void>;
+
+        /**
+         * @brief Get the bytes sent as zero_range descriptors so far
+         * @return Bytes of holes and all-zero chunks not sent as payload
+         */
+        [[nodiscard]] auto zero_bytes() const -> uint64_t;
+
+        /**
+         * @brief Get the order-0 entropy of the chunk last returned by next()
+         * @return Bits per byte, 0 to 8; compression is rarely worth it near 8
+         *
+         * Comes from the same pass that computes the chunk's CRC32.
+         */
+        [[nodiscard]] auto last_entropy() const -> double;
+
+        /**
+         * @brief Get the SHA-256 of the file, hashed from the chunk reads
+         * @return Hash as hex string once the last chunk has been read, or
+         *         error if digesting was not requested or chunks remain
+         */
+        [[nodiscard]] auto digest() const -> result<std::string>;
+
         // Move-only
         chunk_iterator(chunk_iterator&&) noexcept;
         auto operator=(chunk_iterator&&) noexcept -> chunk_iterator&;
@@ -78,7 +124,12 @@ public:
             chunk_config config,
             transfer_id id,
             uint64_t file_size,
-            uint64_t total_chunks);
+            uint64_t total_chunks,
+            bool with_digest,
+            std::vector<file_byte_range> data_extents);
+
+        [[nodiscard]] auto in_hole(uint64_t offset, std::size_t size) -> bool;
+        [[nodiscard]] auto make_zero_range(chunk c, std::size_t size) -> chunk;
 
         std::ifstream file_;
         chunk_config config_;
@@ -86,7 +137,15 @@ public:
         uint64_t file_size_;
         uint64_t total_chunks_;
         uint64_t current_index_;
+        uint64_t next_offset_;
         std::vector<std::byte> buffer_;
+        bool with_digest_;
+        sha256_hasher hasher_;
+        std::string digest_;
+        std::vector<file_byte_range> data_extents_;  ///< Empty: no hole information
+        std::size_t extent_pos_;
+        uint64_t zero_bytes_;
+        double last_entropy_;
     };
 
     /**
@@ -104,18 +163,29 @@ public:
      * @brief Create chunk iterator for a file
      * @param file_path Path to the file to split
      * @param id Transfer ID for the chunks
+     * @param with_digest Hash the file from the chunk reads; the result is
+     *        available from chunk_iterator::digest() after the last chunk
      * @return Chunk iterator or error
+     *
+     * With with_digest a single-pass upload can send its first chunk right
+     * away and deliver the whole-file hash in UPLOAD_COMPLETE, instead of
+     * reading the file twice through calculate_metadata() first.
      */
     [[nodiscard]] auto split(
         const std::filesystem::path& file_path,
-        const transfer_id& id) -> result<chunk_iterator>;
+        const transfer_id& id,
+        bool with_digest = false) -> result<chunk_iterator>;
 
     /**
      * @brief Calculate file metadata without splitting
      * @param file_path Path to the file
+     * @param with_digest Compute sha256_hash, which reads the whole file
+     *        unless the digest cache has it; pass false for single-pass
+     *        uploads and leave it empty
      * @return File metadata or error
      */
-    [[nodiscard]] auto calculate_metadata(const std::filesystem::path& file_path)
+    [[nodiscard]] auto calculate_metadata(const std::filesystem::path& file_path,
+                                          bool with_digest = true)
         -> result<file_metadata>;
 
     /**
@@ -124,8 +194,15 @@ public:
      */
     [[nodiscard]] auto config() const -> const chunk_config&;
 
+    /**
+     * @brief Answer calculate_metadata() from a digest cache
+     * @param cache Cache to consult and fill, or nullptr to always hash
+     */
+    auto set_digest_cache(std::shared_ptr<digest_cache> cache) -> void;
+
 private:
     chunk_config config_;
+    std::shared_ptr<digest_cache> digest_cache_;
 };
 
 }  // namespace kcenon::file_transfer
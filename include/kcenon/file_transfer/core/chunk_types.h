@@ -13,6 +13,7 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -74,7 +75,10 @@ struct transfer_id {
  * - Bit 1 (0x02): last_chunk - Last chunk of file
  * - Bit 2 (0x04): compressed - Data is LZ4 compressed
  * - Bit 3 (0x08): encrypted - Reserved for encryption
- * - Bit 4-7: Reserved (must be 0)
+ * - Bit 4 (0x10): zero_range - No payload; original_size bytes of zeros
+ * - Bit 5 (0x20): parity - FEC parity of a group of chunks (see fec_encoder)
+ * - Bit 6 (0x40): linked - Compressed against the chunks before it (see stream_compressor)
+ * - Bit 7: Reserved (must be 0)
  */
 enum class chunk_flags : uint8_t {
     none = 0x00,
@@ -82,6 +86,9 @@ enum class chunk_flags : uint8_t {
     last_chunk = 0x02,
     compressed = 0x04,
     encrypted = 0x08,
+    zero_range = 0x10,
+    parity = 0x20,
+    linked = 0x40,
 };
 
 [[nodiscard]] constexpr auto operator|(chunk_flags a, chunk_flags b) noexcept
@@ -134,11 +141,62 @@ constexpr auto operator&=(chunk_flags& a, chunk_flags b) noexcept
     return has_flag(flags, chunk_flags::encrypted);
 }
 
+[[nodiscard]] constexpr auto is_zero_range(chunk_flags flags) noexcept -> bool {
+    return has_flag(flags, chunk_flags::zero_range);
+}
+
+[[nodiscard]] constexpr auto is_parity(chunk_flags flags) noexcept -> bool {
+    return has_flag(flags, chunk_flags::parity);
+}
+
+[[nodiscard]] constexpr auto is_linked(chunk_flags flags) noexcept -> bool {
+    return has_flag(flags, chunk_flags::linked);
+}
+
 [[nodiscard]] constexpr auto is_single_chunk(chunk_flags flags) noexcept
     -> bool {
     return is_first_chunk(flags) && is_last_chunk(flags);
 }
 
+/**
+ * @brief Algorithm of a chunk's integrity checksum
+ *
+ * Recorded in each chunk header, so a receiver verifies whatever was sent;
+ * which algorithm a sender uses is negotiated (see negotiate_integrity()).
+ * Peers that never negotiate send zero in that byte, i.e. crc32.
+ */
+enum class chunk_integrity : uint8_t {
+    crc32 = 0,    ///< IEEE 802.3 CRC32 (default)
+    crc32c = 1,   ///< Castagnoli CRC32, in hardware on SSE4.2 and ARMv8 CPUs
+    xxh3_64 = 2,  ///< 64-bit XXH3; stronger for very large transfers
+};
+
+/**
+ * @brief Convert chunk_integrity to string
+ */
+[[nodiscard]] constexpr auto to_string(chunk_integrity algorithm) -> const char* {
+    switch (algorithm) {
+        case chunk_integrity::crc32: return "crc32";
+        case chunk_integrity::crc32c: return "crc32c";
+        case chunk_integrity::xxh3_64: return "xxh3_64";
+        default: return "unknown";
+    }
+}
+
+/**
+ * @brief Size in bytes of a checksum of the given algorithm (4 or 8)
+ */
+[[nodiscard]] constexpr auto checksum_size(chunk_integrity algorithm) noexcept -> std::size_t {
+    return algorithm == chunk_integrity::xxh3_64 ? 8 : 4;
+}
+
+/**
+ * @brief Check whether a wire value names a known algorithm
+ */
+[[nodiscard]] constexpr auto is_known_integrity(uint8_t value) noexcept -> bool {
+    return value <= static_cast<uint8_t>(chunk_integrity::xxh3_64);
+}
+
 /**
  * @brief Chunk header structure for wire protocol (48 bytes + data)
  *
@@ -148,11 +206,13 @@ constexpr auto operator&=(chunk_flags& a, chunk_flags b) noexcept
  * - chunk_offset: 8 bytes
  * - original_size: 4 bytes
  * - compressed_size: 4 bytes
- * - checksum: 4 bytes (CRC32)
+ * - checksum: 4 bytes (low 32 bits of the integrity checksum)
  * - flags: 1 byte
- * - reserved: 3 bytes (padding)
+ * - integrity: 1 byte (chunk_integrity)
+ * - reserved: 2 bytes (padding)
  *
- * Total: 48 bytes
+ * Total: 48 bytes. A 64-bit checksum's high 32 bits follow the payload on
+ * the wire and are kept in chunk::checksum_high.
  */
 #pragma pack(push, 1)
 struct chunk_header {
@@ -161,9 +221,10 @@ struct chunk_header {
     uint64_t chunk_offset;       // 8 bytes: Byte offset in file
     uint32_t original_size;      // 4 bytes: Original (uncompressed) size
     uint32_t compressed_size;    // 4 bytes: Compressed size (or same as original)
-    uint32_t checksum;           // 4 bytes: CRC32 of original data
+    uint32_t checksum;           // 4 bytes: Checksum of original data (low 32 bits)
     chunk_flags flags;           // 1 byte: Chunk flags
-    uint8_t reserved[3];         // 3 bytes: Padding for alignment
+    chunk_integrity integrity;   // 1 byte: Algorithm of checksum
+    uint8_t reserved[2];         // 2 bytes: Padding for alignment
 
     static constexpr std::size_t size = 48;
 
@@ -175,7 +236,8 @@ struct chunk_header {
         , compressed_size(0)
         , checksum(0)
         , flags(chunk_flags::none)
-        , reserved{0, 0, 0} {}
+        , integrity(chunk_integrity::crc32)
+        , reserved{0, 0} {}
 };
 #pragma pack(pop)
 
@@ -188,6 +250,7 @@ static_assert(sizeof(chunk_header) == chunk_header::size,
 struct chunk {
     chunk_header header;
     std::vector<std::byte> data;
+    uint32_t checksum_high = 0;  ///< High 32 bits of a 64-bit checksum, else 0
 
     chunk() = default;
 
@@ -222,11 +285,49 @@ struct chunk {
         return has_flag(header.flags, chunk_flags::last_chunk);
     }
 
+    /**
+     * @brief Check if this chunk stands for a run of zeros without payload
+     *
+     * The run is header.original_size bytes long at header.chunk_offset;
+     * data is empty and the checksum is that of the empty payload.
+     */
+    [[nodiscard]] auto is_zero_range() const noexcept -> bool {
+        return has_flag(header.flags, chunk_flags::zero_range);
+    }
+
+    /**
+     * @brief Check if this chunk holds FEC parity instead of file data
+     *
+     * Its payload describes and protects a group of data chunks; it has
+     * no place in the file (see fec_group).
+     */
+    [[nodiscard]] auto is_parity() const noexcept -> bool {
+        return has_flag(header.flags, chunk_flags::parity);
+    }
+
+    /**
+     * @brief Get the full checksum of the original data
+     *
+     * 32-bit algorithms leave the high half zero.
+     */
+    [[nodiscard]] auto digest() const noexcept -> uint64_t {
+        return (static_cast<uint64_t>(checksum_high) << 32) | header.checksum;
+    }
+
+    /**
+     * @brief Store a checksum and the algorithm that produced it
+     */
+    auto set_digest(chunk_integrity algorithm, uint64_t value) noexcept -> void {
+        header.integrity = algorithm;
+        header.checksum = static_cast<uint32_t>(value);
+        checksum_high = static_cast<uint32_t>(value >> 32);
+    }
+
     /**
      * @brief Total serialized size of this chunk
      */
     [[nodiscard]] auto total_size() const noexcept -> std::size_t {
-        return chunk_header::size + data.size();
+        return chunk_header::size + data.size() + checksum_size(header.integrity) - 4;
     }
 };
 
@@ -248,6 +349,21 @@ struct chunk_metadata {
           received(false) {}
 };
 
+/**
+ * @brief Half-open byte range [offset, offset + length) of a file
+ *
+ * Tracks progress of transfers whose chunks vary in size, where a chunk
+ * index alone no longer locates the data.
+ */
+struct file_byte_range {
+    uint64_t offset = 0;
+    uint64_t length = 0;
+
+    [[nodiscard]] constexpr auto end() const noexcept -> uint64_t { return offset + length; }
+
+    constexpr auto operator==(const file_byte_range&) const noexcept -> bool = default;
+};
+
 /**
  * @brief Statistics for chunk operations
  */
@@ -275,22 +391,18 @@ struct chunk_statistics {
 
 }  // namespace kcenon::file_transfer
 
-// Hash support for transfer_id
+// Hash support for transfer_id: two word loads and a multiply. The bytes
+// are mostly random already; the multiply keeps chosen IDs from colliding
+// by differing only in the second word
 template <>
 struct std::hash<kcenon::file_transfer::transfer_id> {
     auto operator()(const kcenon::file_transfer::transfer_id& id) const noexcept
         -> std::size_t {
-        std::size_t result = 0;
-        for (std::size_t i = 0; i < 16; i += sizeof(std::size_t)) {
-            std::size_t block = 0;
-            for (std::size_t j = 0;
-                 j < sizeof(std::size_t) && (i + j) < 16; ++j) {
-                block |= static_cast<std::size_t>(id.bytes[i + j])
-                         << (j * 8);
-            }
-            result ^= block + 0x9e3779b9 + (result << 6) + (result >> 2);
-        }
-        return result;
+        uint64_t lo = 0;
+        uint64_t hi = 0;
+        std::memcpy(&lo, id.bytes.data(), sizeof(lo));
+        std::memcpy(&hi, id.bytes.data() + sizeof(lo), sizeof(hi));
+        return static_cast<std::size_t>(lo ^ (hi * 0x9E3779B97F4A7C15ULL));
     }
 };
 
@@ -161,6 +161,23 @@ public:
      */
     [[nodiscard]] auto is_compressible(std::span<const std::byte> data) const -> bool;
 
+    /**
+     * @brief Check if data is worth compressing, given its byte entropy
+     *
+     * Uses an entropy measured while the data was read (byte_scan::entropy())
+     * to skip the trial compression of is_compressible(data): data at 7.9
+     * bits per byte or more (random, encrypted or compressed) is rejected
+     * and data below 1 bit per byte is accepted outright. Entropies in
+     * between fall back to the trial, since LZ4 gains from repeats rather
+     * than from skewed byte frequencies.
+     *
+     * @param data Data to analyze
+     * @param entropy Order-0 entropy of data in bits per byte
+     * @return true if data should be compressed, false otherwise
+     */
+    [[nodiscard]] auto is_compressible(std::span<const std::byte> data,
+                                       double entropy) const -> bool;
+
     /**
      * @brief Get compression statistics
      * @return Current compression statistics
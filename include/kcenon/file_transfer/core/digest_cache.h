@@ -0,0 +1,168 @@
+/**
+ * @file digest_cache.h
+ * @brief Persistent cache of file digests keyed by file identity
+ *
+ * Remembers the SHA-256 and per-chunk CRC32 values of local files so that
+ * uploading or verifying an unchanged file does not read it again.
+ */
+
+#ifndef KCENON_FILE_TRANSFER_CORE_DIGEST_CACHE_H
+#define KCENON_FILE_TRANSFER_CORE_DIGEST_CACHE_H
+
+#include <kcenon/file_transfer/core/types.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace kcenon::file_transfer {
+
+/**
+ * @brief Digests of one file at one chunk size
+ */
+struct file_digest {
+    uint64_t file_size = 0;
+    std::size_t chunk_size = 0;
+    std::string sha256;                 ///< Whole-file SHA-256 as hex string
+    std::vector<uint32_t> chunk_crc32;  ///< CRC32 of each chunk, in order
+};
+
+/**
+ * @brief Configuration for digest_cache
+ */
+struct digest_cache_config {
+    /// Fallback table for files whose extended attributes cannot be written
+    std::filesystem::path table_path;
+
+    /// Store digests in a user.* extended attribute of the file when possible
+    bool use_xattr = true;
+
+    /// Entries kept in the table; the least recently used are dropped first
+    std::size_t max_entries = 4096;
+
+    /**
+     * Files modified less than this long before they were hashed are not
+     * cached: a write within the same timestamp tick would go unnoticed.
+     * Covers filesystems with coarse (up to 2s) modification times.
+     */
+    std::chrono::milliseconds racy_window{2000};
+
+    digest_cache_config() = default;
+
+    explicit digest_cache_config(std::filesystem::path table)
+        : table_path(std::move(table)) {}
+};
+
+/**
+ * @brief Counters of a digest_cache
+ */
+struct digest_cache_stats {
+    uint64_t hits = 0;           ///< Lookups answered from the cache
+    uint64_t misses = 0;         ///< Lookups with no usable entry
+    uint64_t stale = 0;          ///< Of those, entries dropped because the file changed
+    uint64_t stores = 0;         ///< Digests stored after hashing
+    uint64_t xattr_stores = 0;   ///< Of those, stored in an extended attribute
+    uint64_t skipped = 0;        ///< Digests not stored (file too new or changed while read)
+    std::size_t entries = 0;     ///< Entries in the table right now
+};
+
+/**
+ * @brief Persistent file digest cache
+ *
+ * An entry is keyed by (device, inode, size, mtime in nanoseconds, chunk
+ * size) and only returned while all of them still match the file, so a
+ * file that is rewritten, truncated, replaced by rename or copied elsewhere
+ * is hashed again. A same-size rewrite whose writer then restores the old
+ * mtime (e.g. with utimensat) is the one change that is not detected.
+ *
+ * Digests are kept in an extended attribute of the file itself where the
+ * filesystem and permissions allow it, and otherwise in a compact table at
+ * config.table_path: an append-only log of checksummed records that is
+ * replayed at startup (a torn last record is ignored) and rewritten once
+ * superseded records outweigh live ones. A table belongs to one
+ * digest_cache at a time; entries in extended attributes are shared by
+ * every process that opens the file.
+ *
+ * On platforms without inode numbers every lookup misses and compute()
+ * falls back to hashing the file.
+ *
+ * @code
+ * auto cache = std::make_shared<digest_cache>(
+ *     digest_cache_config(state_dir / "digests.tbl"));
+ * auto digest = cache->compute(path, 256 * 1024);   // Hashes on first use
+ * auto again = cache->compute(path, 256 * 1024);    // Answered from the cache
+ * @endcode
+ */
+class digest_cache {
+public:
+    /**
+     * @brief Create a cache, loading the table if it exists
+     */
+    explicit digest_cache(digest_cache_config config = {});
+
+    /**
+     * @brief Destructor; compacts the table if it is mostly superseded records
+     */
+    ~digest_cache();
+
+    digest_cache(const digest_cache&) = delete;
+    auto operator=(const digest_cache&) -> digest_cache& = delete;
+    digest_cache(digest_cache&&) noexcept;
+    auto operator=(digest_cache&&) noexcept -> digest_cache&;
+
+    /**
+     * @brief Look up the digests of a file without reading it
+     * @param path File to look up
+     * @param chunk_size Chunk size the CRC32 list must be for
+     * @return Cached digests, or nullopt if none are valid for the file as it is now
+     */
+    [[nodiscard]] auto lookup(const std::filesystem::path& path, std::size_t chunk_size)
+        -> std::optional<file_digest>;
+
+    /**
+     * @brief Get the digests of a file, hashing it only on a cache miss
+     * @param path File to hash
+     * @param chunk_size Chunk size for the CRC32 list
+     * @return Digests, or error if the file cannot be read
+     *
+     * SHA-256 and CRC32 values come from the same read of the file. The
+     * result is stored unless the file changed while it was read or was
+     * modified within config.racy_window.
+     */
+    [[nodiscard]] auto compute(const std::filesystem::path& path, std::size_t chunk_size)
+        -> result<file_digest>;
+
+    /**
+     * @brief Forget every entry for a file
+     */
+    auto invalidate(const std::filesystem::path& path) -> void;
+
+    /**
+     * @brief Rewrite the table without superseded records
+     * @return Success or error if the table cannot be written
+     */
+    [[nodiscard]] auto compact() -> result<void>;
+
+    /**
+     * @brief Get cache counters
+     */
+    [[nodiscard]] auto stats() const -> digest_cache_stats;
+
+    /**
+     * @brief Get the configuration
+     */
+    [[nodiscard]] auto config() const -> const digest_cache_config&;
+
+private:
+    struct impl;
+    std::unique_ptr<impl> impl_;
+};
+
+}  // namespace kcenon::file_transfer
+
+#endif  // KCENON_FILE_TRANSFER_CORE_DIGEST_CACHE_H
@@ -0,0 +1,303 @@
+/**
+ * @file fec_codec.h
+ * @brief Reed-Solomon forward error correction over groups of chunks
+ *
+ * On links with a long round trip, every lost chunk costs a NACK and a
+ * retransmission, i.e. at least one more RTT before the transfer can
+ * complete. With FEC the sender adds M parity chunks to every group of K
+ * data chunks, and the receiver rebuilds up to M lost chunks of a group
+ * from whatever K of the K + M chunks arrived, without asking for them.
+ */
+
+#ifndef KCENON_FILE_TRANSFER_CORE_FEC_CODEC_H
+#define KCENON_FILE_TRANSFER_CORE_FEC_CODEC_H
+
+#include <kcenon/file_transfer/core/chunk_types.h>
+#include <kcenon/file_transfer/core/types.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <span>
+#include <vector>
+
+namespace kcenon::file_transfer {
+
+/**
+ * @brief Group layout of forward error correction
+ *
+ * Parity costs parity_chunks / data_chunks of extra bandwidth and repairs
+ * up to parity_chunks losses per group. Larger groups spread the same
+ * overhead over more chunks and tolerate bursts better, but a receiver
+ * can only rebuild a chunk once enough of its group has arrived.
+ */
+struct fec_config {
+    /// Default number of data chunks per group
+    static constexpr std::size_t default_data_chunks = 16;
+
+    /// Largest group, data and parity chunks together
+    static constexpr std::size_t max_group_chunks = 256;
+
+    /// Data chunks per group (K)
+    std::size_t data_chunks = default_data_chunks;
+
+    /// Parity chunks per group (M); 0 disables FEC
+    std::size_t parity_chunks = 0;
+
+    /**
+     * @brief Check whether parity is sent at all
+     */
+    [[nodiscard]] auto enabled() const noexcept -> bool {
+        return data_chunks > 0 && parity_chunks > 0;
+    }
+
+    /**
+     * @brief Extra bandwidth spent on parity, as a fraction of the data
+     */
+    [[nodiscard]] auto overhead() const noexcept -> double {
+        return data_chunks == 0 ? 0.0
+                                : static_cast<double>(parity_chunks) /
+                                      static_cast<double>(data_chunks);
+    }
+
+    /**
+     * @brief Validate configuration
+     * @return Success if valid, error otherwise
+     */
+    [[nodiscard]] auto validate() const -> result<void>;
+
+    /**
+     * @brief Pick the parity for a measured chunk loss rate
+     *
+     * Chooses the fewest parity chunks for which a group is lost (more
+     * than M of its K + M chunks dropped, losses independent) with
+     * probability at most target_failure, and at most K of them.
+     *
+     * @param chunk_loss_rate Fraction of chunks lost, e.g.
+     *        chunk_size_stats::retransmit_rate
+     * @param data_chunks Data chunks per group
+     * @param target_failure Acceptable probability that a group needs a NACK
+     * @return Configuration; FEC disabled when nothing is lost
+     */
+    [[nodiscard]] static auto for_loss_rate(double chunk_loss_rate,
+                                            std::size_t data_chunks = default_data_chunks,
+                                            double target_failure = 1e-3) -> fec_config;
+
+    /**
+     * @brief Pick the parity that minimises the expected time per group
+     *
+     * Weighs the wire time of M parity chunks against the chance that the
+     * group still loses more than M chunks and costs a NACK round trip:
+     * (K + M) * chunk_size / bandwidth + P(loss > M) * rtt. Parity pays off
+     * when round trips are long compared with sending a chunk.
+     *
+     * @param chunk_loss_rate Fraction of chunks lost
+     * @param rtt Round-trip time
+     * @param bytes_per_second Link bandwidth
+     * @param chunk_size Bytes per chunk
+     * @param data_chunks Data chunks per group
+     * @return Configuration; FEC disabled when it does not pay off
+     */
+    [[nodiscard]] static auto for_link(double chunk_loss_rate, std::chrono::microseconds rtt,
+                                       double bytes_per_second, std::size_t chunk_size,
+                                       std::size_t data_chunks = default_data_chunks)
+        -> fec_config;
+};
+
+/**
+ * @brief A data chunk as described by the parity chunks of its group
+ *
+ * Carries what the receiver needs to rebuild the chunk without having
+ * seen it: where it goes, how big it is, and its checksum.
+ */
+struct fec_entry {
+    uint64_t offset = 0;           ///< chunk_offset
+    uint32_t original_size = 0;    ///< header.original_size
+    uint32_t payload_size = 0;     ///< Bytes of payload (0 for a zero_range chunk)
+    uint64_t digest = 0;           ///< Checksum of the payload
+    chunk_flags flags = chunk_flags::none;
+    chunk_integrity integrity = chunk_integrity::crc32;
+};
+
+/**
+ * @brief Produces the parity chunks of a stream of data chunks
+ *
+ * Data chunks are fed in index order, after splitting and before
+ * compression or encryption; parity chunks are ordinary chunks flagged
+ * chunk_flags::parity that go through the same path as data. Every K
+ * consecutive data chunks form a group. Parity is accumulated as the
+ * chunks come, so no data is held back; the chunks of a group may differ
+ * in size.
+ *
+ * Parity chunk payload (little-endian):
+ * - first_index: 8 bytes, index of the group's first data chunk
+ * - data_count: 1 byte, data chunks in the group
+ * - parity_row: 1 byte, which parity chunk of the group this is
+ * - parity_count: 1 byte, parity chunks sent for the group
+ * - reserved: 1 byte
+ * - symbol_size: 4 bytes, size of the largest payload in the group
+ * - data_count entries of 32 bytes: offset (8), original_size (4),
+ *   payload_size (4), digest (8), flags (1), integrity (1), reserved (6)
+ * - symbol_size bytes of parity
+ *
+ * @code
+ * fec_encoder encoder(fec_config::for_loss_rate(0.02));
+ * for (auto& c : splitter.split(path, id)) {
+ *     send(c);
+ *     for (auto& parity : encoder.add(c).value()) {
+ *         send(parity);
+ *     }
+ * }
+ * for (auto& parity : encoder.flush()) {
+ *     send(parity);
+ * }
+ * @endcode
+ */
+class fec_encoder {
+public:
+    /**
+     * @brief Create an encoder
+     * @param config Group layout, expected to pass validate()
+     */
+    explicit fec_encoder(fec_config config = {});
+
+    /**
+     * @brief Add the next data chunk
+     *
+     * A chunk whose index does not follow the previous one closes the
+     * current group first.
+     *
+     * @param c Data chunk, not compressed or encrypted
+     * @return Parity chunks of the groups this completed, possibly none
+     */
+    [[nodiscard]] auto add(const chunk& c) -> result<std::vector<chunk>>;
+
+    /**
+     * @brief Close a partly filled group
+     * @return Its parity chunks, or none if the group is empty
+     */
+    [[nodiscard]] auto flush() -> std::vector<chunk>;
+
+    /**
+     * @brief Change the group layout, from the next group on
+     * @param config Group layout, expected to pass validate()
+     */
+    auto set_config(const fec_config& config) -> void;
+
+    /**
+     * @brief Get the configuration of the next group
+     */
+    [[nodiscard]] auto config() const noexcept -> const fec_config& { return next_config_; }
+
+private:
+    fec_config config_;
+    fec_config next_config_;
+    transfer_id id_;
+    uint64_t first_index_ = 0;
+    std::vector<fec_entry> entries_;
+    std::vector<std::vector<std::byte>> parity_;
+};
+
+/**
+ * @brief Parity received for one group, and the rebuild of its data
+ *
+ * Any K of a group's K + M chunks determine the rest: parity row j holds
+ * sum_i d_i / (x_j + y_i) over GF(2^8), a systematic Cauchy Reed-Solomon
+ * code, so every square submatrix of the coefficients is invertible.
+ */
+class fec_group {
+public:
+    /**
+     * @brief Parse a parity chunk
+     * @param parity Chunk flagged chunk_flags::parity
+     * @return Group holding this parity row, or error if malformed
+     */
+    [[nodiscard]] static auto from_parity(const chunk& parity) -> result<fec_group>;
+
+    /**
+     * @brief Add another parity chunk of the same group
+     * @param parity Chunk flagged chunk_flags::parity
+     * @return Success, or error if it belongs to another group or is malformed
+     */
+    [[nodiscard]] auto add_parity(const chunk& parity) -> result<void>;
+
+    /**
+     * @brief Index of the group's first data chunk
+     */
+    [[nodiscard]] auto first_index() const noexcept -> uint64_t { return first_index_; }
+
+    /**
+     * @brief Number of data chunks in the group
+     */
+    [[nodiscard]] auto data_count() const noexcept -> std::size_t { return entries_.size(); }
+
+    /**
+     * @brief Number of distinct parity rows received
+     */
+    [[nodiscard]] auto parity_count() const noexcept -> std::size_t { return rows_.size(); }
+
+    /**
+     * @brief Size of the group's largest payload
+     */
+    [[nodiscard]] auto symbol_size() const noexcept -> std::size_t { return symbol_size_; }
+
+    /**
+     * @brief Description of the group's i-th data chunk
+     */
+    [[nodiscard]] auto entry(std::size_t i) const -> const fec_entry& { return entries_[i]; }
+
+    /**
+     * @brief Check whether a chunk index belongs to the group
+     */
+    [[nodiscard]] auto contains(uint64_t index) const noexcept -> bool {
+        return index >= first_index_ && index - first_index_ < entries_.size();
+    }
+
+    /**
+     * @brief Rebuild lost data chunks
+     *
+     * @param id Transfer the rebuilt chunks belong to
+     * @param missing Indices of the group's data chunks not received;
+     *        at most parity_count()
+     * @param read Returns the payload of a received data chunk by index
+     * @return Rebuilt chunks, with header and checksum as originally sent,
+     *         or error if too few rows are held or a read failed
+     */
+    [[nodiscard]] auto recover(
+        const transfer_id& id,
+        std::span<const uint64_t> missing,
+        const std::function<result<std::vector<std::byte>>(uint64_t)>& read) const
+        -> result<std::vector<chunk>>;
+
+private:
+    fec_group() = default;
+
+    uint64_t first_index_ = 0;
+    std::size_t symbol_size_ = 0;
+    std::vector<fec_entry> entries_;
+    std::map<uint8_t, std::vector<std::byte>> rows_;  ///< parity_row -> parity
+};
+
+namespace fec {
+
+/**
+ * @brief dst ^= coefficient * src over GF(2^8), byte by byte
+ *
+ * Uses SSSE3 byte shuffles when the CPU has them (checked at runtime).
+ * src must not be longer than dst.
+ */
+auto multiply_add(uint8_t coefficient, std::span<const std::byte> src, std::span<std::byte> dst)
+    -> void;
+
+/**
+ * @brief Coefficient of data chunk i in parity row j
+ */
+[[nodiscard]] auto coefficient(std::size_t row, std::size_t data_index) -> uint8_t;
+
+}  // namespace fec
+
+}  // namespace kcenon::file_transfer
+
+#endif  // KCENON_FILE_TRANSFER_CORE_FEC_CODEC_H
@@ -0,0 +1,199 @@
+/**
+ * @file frame_codec.h
+ * @brief Wire frame encoding and incremental stream decoding
+ *
+ * Frame layout (see docs/reference/protocol-spec.md):
+ * @code
+ * magic (4B) | type (1B) | payload_length (4B) | payload | checksum (2B) | length_echo (2B)
+ * @endcode
+ * All multi-byte fields are big-endian.
+ */
+
+#ifndef KCENON_FILE_TRANSFER_CORE_FRAME_CODEC_H
+#define KCENON_FILE_TRANSFER_CORE_FRAME_CODEC_H
+
+#include <kcenon/file_transfer/core/chunk_types.h>
+#include <kcenon/file_transfer/core/protocol_types.h>
+#include <kcenon/file_transfer/core/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace kcenon::file_transfer {
+
+/**
+ * @brief Largest payload accepted by default (1MB chunk + 48B chunk header)
+ */
+inline constexpr std::size_t max_frame_payload = 1024 * 1024 + chunk_header::size;
+
+/**
+ * @brief A decoded frame
+ */
+struct frame {
+    message_type type = message_type::error;
+    std::vector<uint8_t> payload;
+};
+
+/**
+ * @brief Encode a frame
+ * @param type Message type
+ * @param payload Message payload
+ * @return Frame bytes ready to send
+ */
+[[nodiscard]] auto encode_frame(message_type type, std::span<const uint8_t> payload)
+    -> std::vector<uint8_t>;
+
+/**
+ * @brief Incremental decoder for a byte stream of frames
+ *
+ * Bytes are fed as they arrive from the socket, in pieces of any size;
+ * next() returns each complete frame once. A frame failing validation
+ * (prefix, length sanity, checksum, length echo) is discarded and the
+ * decoder rescans for the next prefix, as the protocol requires.
+ *
+ * Not thread-safe; use one decoder per connection.
+ */
+class frame_decoder {
+public:
+    /**
+     * @brief Create a decoder
+     * @param max_payload Largest payload_length accepted
+     */
+    explicit frame_decoder(std::size_t max_payload = max_frame_payload);
+
+    /**
+     * @brief Append received bytes
+     * @param data Bytes read from the connection
+     */
+    void feed(std::span<const uint8_t> data);
+
+    /**
+     * @brief Take the next complete frame
+     * @return The frame, or nullopt until more bytes are fed
+     */
+    [[nodiscard]] auto next() -> std::optional<frame>;
+
+    /**
+     * @brief Bytes buffered but not yet returned as frames
+     */
+    [[nodiscard]] auto buffered() const -> std::size_t;
+
+    /**
+     * @brief Frames discarded after failing validation
+     */
+    [[nodiscard]] auto discarded_frames() const -> uint64_t { return discarded_; }
+
+    /**
+     * @brief Drop buffered bytes
+     */
+    void reset();
+
+private:
+    void compact();
+
+    std::size_t max_payload_;
+    std::vector<uint8_t> buffer_;
+    std::size_t read_pos_ = 0;
+    uint64_t discarded_ = 0;
+};
+
+// Message payloads. decode_* functions return invalid_message for payloads
+// that are truncated or internally inconsistent.
+
+/**
+ * @brief Encode a CHUNK_DATA payload (48-byte chunk header followed by data)
+ */
+[[nodiscard]] auto encode_chunk_data(const chunk& c) -> std::vector<uint8_t>;
+
+/**
+ * @brief Decode a CHUNK_DATA payload
+ */
+[[nodiscard]] auto decode_chunk_data(std::span<const uint8_t> payload) -> result<chunk>;
+
+/**
+ * @brief Encode an UPLOAD_REQUEST payload
+ */
+[[nodiscard]] auto encode_upload_request(const msg_upload_request& msg)
+    -> std::vector<uint8_t>;
+
+/**
+ * @brief Decode an UPLOAD_REQUEST payload
+ */
+[[nodiscard]] auto decode_upload_request(std::span<const uint8_t> payload)
+    -> result<msg_upload_request>;
+
+/**
+ * @brief Encode an UPLOAD_ACCEPT payload
+ */
+[[nodiscard]] auto encode_upload_accept(const msg_upload_accept& msg)
+    -> std::vector<uint8_t>;
+
+/**
+ * @brief Decode an UPLOAD_ACCEPT payload
+ */
+[[nodiscard]] auto decode_upload_accept(std::span<const uint8_t> payload)
+    -> result<msg_upload_accept>;
+
+/**
+ * @brief Encode an UPLOAD_REJECT payload
+ */
+[[nodiscard]] auto encode_upload_reject(const msg_upload_reject& msg)
+    -> std::vector<uint8_t>;
+
+/**
+ * @brief Decode an UPLOAD_REJECT payload
+ */
+[[nodiscard]] auto decode_upload_reject(std::span<const uint8_t> payload)
+    -> result<msg_upload_reject>;
+
+/**
+ * @brief Encode an UPLOAD_COMPLETE payload
+ */
+[[nodiscard]] auto encode_upload_complete(const msg_upload_complete& msg)
+    -> std::vector<uint8_t>;
+
+/**
+ * @brief Decode an UPLOAD_COMPLETE payload
+ */
+[[nodiscard]] auto decode_upload_complete(std::span<const uint8_t> payload)
+    -> result<msg_upload_complete>;
+
+/**
+ * @brief Encode an UPLOAD_ACK payload
+ */
+[[nodiscard]] auto encode_upload_ack(const msg_upload_ack& msg) -> std::vector<uint8_t>;
+
+/**
+ * @brief Decode an UPLOAD_ACK payload
+ */
+[[nodiscard]] auto decode_upload_ack(std::span<const uint8_t> payload)
+    -> result<msg_upload_ack>;
+
+/**
+ * @brief Encode a CHUNK_ACK payload
+ */
+[[nodiscard]] auto encode_chunk_ack(const msg_chunk_ack& msg) -> std::vector<uint8_t>;
+
+/**
+ * @brief Decode a CHUNK_ACK payload
+ */
+[[nodiscard]] auto decode_chunk_ack(std::span<const uint8_t> payload)
+    -> result<msg_chunk_ack>;
+
+/**
+ * @brief Encode a CHUNK_NACK payload
+ */
+[[nodiscard]] auto encode_chunk_nack(const msg_chunk_nack& msg) -> std::vector<uint8_t>;
+
+/**
+ * @brief Decode a CHUNK_NACK payload
+ */
+[[nodiscard]] auto decode_chunk_nack(std::span<const uint8_t> payload)
+    -> result<msg_chunk_nack>;
+
+}  // namespace kcenon::file_transfer
+
+#endif  // KCENON_FILE_TRANSFER_CORE_FRAME_CODEC_H
@@ -0,0 +1,169 @@
+/**
+ * @file integrity_policy.h
+ * @brief Decides which integrity checks a transfer needs, so each runs once
+ *
+ * A chunk sealed with AES-GCM is authenticated by its tag when it is
+ * decrypted; recomputing its CRC afterwards only burns CPU. The policy
+ * names the checks a transfer needs, tracks which ones a chunk has passed,
+ * and estimates the CPU time of the checks it lets the pipeline skip.
+ */
+
+#ifndef KCENON_FILE_TRANSFER_CORE_INTEGRITY_POLICY_H
+#define KCENON_FILE_TRANSFER_CORE_INTEGRITY_POLICY_H
+
+#include <kcenon/file_transfer/core/chunk_types.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace kcenon::file_transfer {
+
+/**
+ * @brief Integrity checks a chunk or transfer goes through
+ */
+enum class integrity_check : uint8_t {
+    none = 0x00,
+    aead_tag = 0x01,        ///< AEAD (AES-GCM) tag, checked by decryption
+    chunk_checksum = 0x02,  ///< Per-chunk CRC32 / CRC32C / XXH3-64
+    file_digest = 0x04,     ///< SHA-256 of the assembled file
+};
+
+[[nodiscard]] constexpr auto operator|(integrity_check a, integrity_check b) noexcept
+    -> integrity_check {
+    return static_cast<integrity_check>(static_cast<uint8_t>(a) | static_cast<uint8_t>(b));
+}
+
+[[nodiscard]] constexpr auto operator&(integrity_check a, integrity_check b) noexcept
+    -> integrity_check {
+    return static_cast<integrity_check>(static_cast<uint8_t>(a) & static_cast<uint8_t>(b));
+}
+
+[[nodiscard]] constexpr auto operator~(integrity_check a) noexcept -> integrity_check {
+    return static_cast<integrity_check>(~static_cast<uint8_t>(a));
+}
+
+constexpr auto operator|=(integrity_check& a, integrity_check b) noexcept -> integrity_check& {
+    a = a | b;
+    return a;
+}
+
+[[nodiscard]] constexpr auto has_check(integrity_check checks, integrity_check check) noexcept
+    -> bool {
+    return (static_cast<uint8_t>(checks) & static_cast<uint8_t>(check)) != 0;
+}
+
+/**
+ * @brief How a transfer protects its data
+ */
+struct transfer_protection {
+    bool authenticated = false;  ///< Chunks are sealed with an AEAD cipher
+    bool file_digest = false;    ///< Sender supplied the SHA-256 of the whole file
+};
+
+/**
+ * @brief Integrity policy engine
+ *
+ * The AEAD tag authenticates the exact ciphertext of a chunk under the
+ * transfer key, and decryption of authentic ciphertext is deterministic,
+ * so a chunk whose tag verified needs no CRC. The file digest is still
+ * checked when the sender supplied one: per-chunk tags say nothing about
+ * whether the assembled file is the one the sender hashed.
+ *
+ * Which checks a chunk has passed travels with the chunk; outstanding()
+ * tells each stage what is left, so no check runs twice. The cost model
+ * learns the CPU time per byte of each chunk checksum algorithm from the
+ * checks that do run, and prices the skipped ones with it. All members
+ * are thread-safe.
+ *
+ * @code
+ * // Decrypt stage, after the tag verified
+ * chunk.verified |= integrity_check::aead_tag;
+ *
+ * // Verify stage
+ * if (has_check(integrity_policy::outstanding(chunk.verified),
+ *               integrity_check::chunk_checksum)) {
+ *     // compute and compare the checksum
+ * } else {
+ *     saved += policy.estimate_cost(chunk.integrity, chunk.data.size());
+ * }
+ * @endcode
+ */
+class integrity_policy {
+public:
+    integrity_policy() = default;
+
+    integrity_policy(const integrity_policy&) = delete;
+    auto operator=(const integrity_policy&) -> integrity_policy& = delete;
+
+    /**
+     * @brief Checks a transfer needs, each to be performed once
+     * @param protection How the transfer protects its data
+     * @return aead_tag or chunk_checksum, plus file_digest if one was supplied
+     */
+    [[nodiscard]] static constexpr auto plan(const transfer_protection& protection) noexcept
+        -> integrity_check {
+        auto checks = protection.authenticated ? integrity_check::aead_tag
+                                               : integrity_check::chunk_checksum;
+        if (protection.file_digest) {
+            checks |= integrity_check::file_digest;
+        }
+        return checks;
+    }
+
+    /**
+     * @brief Per-chunk checks still owed by a chunk
+     * @param verified Checks the chunk has passed
+     * @return chunk_checksum, unless the chunk passed it or an AEAD tag
+     */
+    [[nodiscard]] static constexpr auto outstanding(integrity_check verified) noexcept
+        -> integrity_check {
+        if (has_check(verified, integrity_check::aead_tag) ||
+            has_check(verified, integrity_check::chunk_checksum)) {
+            return integrity_check::none;
+        }
+        return integrity_check::chunk_checksum;
+    }
+
+    /**
+     * @brief Record the measured cost of a chunk checksum
+     * @param algorithm Algorithm that ran
+     * @param bytes Bytes checked
+     * @param elapsed CPU time it took
+     */
+    auto record_check(chunk_integrity algorithm, std::size_t bytes,
+                      std::chrono::nanoseconds elapsed) -> void;
+
+    /**
+     * @brief Estimated CPU time of a chunk checksum
+     *
+     * Uses the smoothed cost of the checks recorded so far; before the
+     * first one, the algorithm is timed once on a scratch buffer.
+     *
+     * @param algorithm Algorithm
+     * @param bytes Bytes to check
+     * @return Estimated time
+     */
+    [[nodiscard]] auto estimate_cost(chunk_integrity algorithm, std::size_t bytes)
+        -> std::chrono::nanoseconds;
+
+    /**
+     * @brief Smoothed cost in nanoseconds per byte; negative until known
+     */
+    [[nodiscard]] auto ns_per_byte(chunk_integrity algorithm) const -> double;
+
+private:
+    static constexpr std::size_t algorithm_count =
+        static_cast<std::size_t>(chunk_integrity::xxh3_64) + 1;
+
+    /// Weight of a new measurement in the smoothed cost
+    static constexpr double smoothing = 0.125;
+
+    std::array<std::atomic<double>, algorithm_count> ns_per_byte_{-1.0, -1.0, -1.0};
+};
+
+}  // namespace kcenon::file_transfer
+
+#endif  // KCENON_FILE_TRANSFER_CORE_INTEGRITY_POLICY_H
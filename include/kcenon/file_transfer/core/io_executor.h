@@ -0,0 +1,424 @@
+/**
+ * @file io_executor.h
+ * @brief Shared bounded executor for blocking storage and network I/O
+ *
+ * Replaces one-thread-per-call std::async for the *_async storage APIs.
+ * Work is grouped into named lanes (typically one per backend instance),
+ * each with its own concurrency limit, on top of a fixed set of workers and
+ * a bounded queue.
+ */
+
+#ifndef KCENON_FILE_TRANSFER_CORE_IO_EXECUTOR_H
+#define KCENON_FILE_TRANSFER_CORE_IO_EXECUTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "kcenon/file_transfer/core/types.h"
+
+namespace kcenon::file_transfer {
+
+/**
+ * @brief Cooperative cancellation flag shared between a caller and its tasks
+ *
+ * Copies share the same state. Tasks that have not started when the token is
+ * cancelled are dropped; running tasks may poll is_cancelled().
+ */
+class io_cancellation_token {
+public:
+    io_cancellation_token() : state_(std::make_shared<std::atomic<bool>>(false)) {}
+
+    auto cancel() -> void { state_->store(true, std::memory_order_release); }
+
+    [[nodiscard]] auto is_cancelled() const -> bool {
+        return state_->load(std::memory_order_acquire);
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> state_;
+};
+
+/**
+ * @brief io_executor configuration
+ */
+struct io_executor_config {
+    /// Worker threads (0 = 2x hardware concurrency, clamped to [4, 64])
+    std::size_t worker_count = 0;
+
+    /// Maximum queued tasks across all lanes (0 = unbounded)
+    std::size_t max_queue_depth = 10000;
+
+    /// Concurrency limit for lanes without an explicit limit (0 = worker_count)
+    std::size_t default_lane_limit = 0;
+
+    /// Workers that blocking lanes may occupy at once (0 = half the workers)
+    std::size_t max_blocking_workers = 0;
+};
+
+/**
+ * @brief Per-lane executor metrics
+ */
+struct io_lane_metrics {
+    std::string name;
+    std::size_t concurrency_limit = 0;
+    bool blocking = false;
+    std::size_t active = 0;
+    std::size_t queued = 0;
+    uint64_t completed = 0;
+    uint64_t cancelled = 0;
+};
+
+/**
+ * @brief Executor-wide metrics
+ */
+struct io_executor_metrics {
+    std::size_t worker_count = 0;
+    std::size_t queue_depth = 0;       ///< Tasks waiting for a worker or lane slot
+    std::size_t peak_queue_depth = 0;
+    std::size_t active_tasks = 0;
+    std::size_t active_blocking = 0;   ///< Running tasks of blocking lanes
+    std::size_t delayed_tasks = 0;     ///< Scheduled tasks that are not due yet
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    uint64_t cancelled = 0;
+    uint64_t rejected = 0;             ///< Refused because the queue was full
+    std::vector<io_lane_metrics> lanes;
+};
+
+namespace detail {
+
+template <typename T>
+struct is_result : std::false_type {};
+
+template <typename T>
+struct is_result<result<T>> : std::true_type {};
+
+/**
+ * @brief Complete a promise for a task that will never run
+ *
+ * result<T> futures receive the error; other futures get an exception.
+ */
+template <typename R>
+auto fail_promise(std::promise<R>& promise, error_code reason) -> void {
+    if constexpr (is_result<R>::value) {
+        promise.set_value(R(unexpected{error{reason}}));
+    } else {
+        promise.set_exception(std::make_exception_ptr(std::runtime_error(to_string(reason))));
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Bounded executor for blocking I/O
+ *
+ * - A fixed pool of workers serves all lanes; a lane never runs more than its
+ *   concurrency limit at once, so one slow backend cannot occupy every worker.
+ * - The queue is bounded; submissions beyond max_queue_depth are rejected
+ *   with error_code::queue_full instead of spawning more threads.
+ * - Tasks whose cancellation token fires before they start, and tasks still
+ *   queued at shutdown, complete with error_code::operation_cancelled.
+ * - A task that waits on other tasks of the executor (e.g. an *_async call
+ *   fanning out to part uploads) must run on a blocking lane. Blocking lanes
+ *   together occupy at most max_blocking_workers workers, so the work they
+ *   wait on always finds a worker. Nested submissions are queued to their
+ *   lane like any other, except that a blocking task submitting to a
+ *   blocking lane runs that task inline.
+ *
+ * @code
+ * auto& executor = io_executor::shared();
+ * executor.set_lane_limit("s3/my-bucket", 16);
+ *
+ * auto future = executor.submit("s3/my-bucket", [&] {
+ *     return storage.upload(key, data);
+ * });
+ * @endcode
+ */
+class io_executor {
+public:
+    /**
+     * @brief Create an executor
+     * @param config Executor configuration
+     */
+    explicit io_executor(io_executor_config config = {});
+
+    /**
+     * @brief Cancel queued tasks and join the workers
+     */
+    ~io_executor();
+
+    // Non-copyable, non-movable (workers reference the executor)
+    io_executor(const io_executor&) = delete;
+    auto operator=(const io_executor&) -> io_executor& = delete;
+    io_executor(io_executor&&) = delete;
+    auto operator=(io_executor&&) -> io_executor& = delete;
+
+    /**
+     * @brief Process-wide executor used by the storage and cloud backends
+     */
+    [[nodiscard]] static auto shared() -> io_executor&;
+
+    /**
+     * @brief Check whether the calling thread is a worker of any io_executor
+     */
+    [[nodiscard]] static auto on_worker_thread() -> bool;
+
+    /**
+     * @brief Check whether the calling thread runs a task of a blocking lane
+     */
+    [[nodiscard]] static auto on_blocking_task() -> bool;
+
+    /**
+     * @brief Submit a task to a lane
+     * @param lane Lane name (e.g. one per backend instance)
+     * @param fn Callable to run
+     * @param token Cancellation token checked before the task starts
+     * @return Future for the callable's return value
+     */
+    template <typename F>
+    [[nodiscard]] auto submit(std::string_view lane, F&& fn, io_cancellation_token token = {})
+        -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+        return schedule(lane, std::chrono::steady_clock::duration::zero(),
+                        std::forward<F>(fn), std::move(token));
+    }
+
+    /**
+     * @brief Submit a task that becomes runnable after a delay
+     *
+     * The delay does not occupy a worker.
+     *
+     * @param delay Time to wait before the task becomes runnable
+     * @param lane Lane name
+     * @param fn Callable to run
+     * @param token Cancellation token checked before the task starts
+     * @return Future for the callable's return value
+     */
+    template <typename F>
+    [[nodiscard]] auto submit_after(std::chrono::steady_clock::duration delay,
+                                    std::string_view lane,
+                                    F&& fn,
+                                    io_cancellation_token token = {})
+        -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+        return schedule(lane, delay, std::forward<F>(fn), std::move(token));
+    }
+
+    /**
+     * @brief Set the concurrency limit of a lane
+     * @param lane Lane name
+     * @param max_concurrent Maximum tasks of the lane running at once (0 = default)
+     */
+    auto set_lane_limit(std::string_view lane, std::size_t max_concurrent) -> void;
+
+    /**
+     * @brief Mark a lane as one whose tasks wait on other tasks of the executor
+     * @param lane Lane name
+     * @param blocking Whether the lane's tasks may block on nested work
+     */
+    auto set_lane_blocking(std::string_view lane, bool blocking = true) -> void;
+
+    /**
+     * @brief Get executor metrics
+     * @return Snapshot of queue depth, counters and per-lane state
+     */
+    [[nodiscard]] auto metrics() const -> io_executor_metrics;
+
+    /**
+     * @brief Get the number of worker threads
+     */
+    [[nodiscard]] auto worker_count() const -> std::size_t;
+
+    /**
+     * @brief Stop accepting work, cancel queued tasks and join the workers
+     */
+    auto shutdown() -> void;
+
+private:
+    // run() calls the function and returns the step that completes the
+    // future, so a worker can release its counters before the caller wakes
+    struct job {
+        std::function<std::function<void()>()> run;
+        std::function<void(error_code)> drop;
+        io_cancellation_token token;
+    };
+
+    template <typename F>
+    auto schedule(std::string_view lane,
+                  std::chrono::steady_clock::duration delay,
+                  F&& fn,
+                  io_cancellation_token token)
+        -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+        using R = std::invoke_result_t<std::decay_t<F>&>;
+
+        auto promise = std::make_shared<std::promise<R>>();
+        auto future = promise->get_future();
+
+        job task;
+        task.run = [promise, fn = std::decay_t<F>(std::forward<F>(fn))]() mutable
+            -> std::function<void()> {
+            try {
+                if constexpr (std::is_void_v<R>) {
+                    fn();
+                    return [promise] { promise->set_value(); };
+                } else {
+                    auto value = std::make_shared<R>(fn());
+                    return [promise, value] { promise->set_value(std::move(*value)); };
+                }
+            } catch (...) {
+                return [promise, failure = std::current_exception()] {
+                    promise->set_exception(failure);
+                };
+            }
+        };
+        task.drop = [promise](error_code reason) {
+            detail::fail_promise(*promise, reason);
+        };
+        task.token = std::move(token);
+
+        enqueue(lane, delay, std::move(task));
+        return future;
+    }
+
+    auto enqueue(std::string_view lane,
+                 std::chrono::steady_clock::duration delay,
+                 job task) -> void;
+
+    struct impl;
+    std::unique_ptr<impl> impl_;
+};
+
+/**
+ * @brief Owner-scoped submissions to an io_executor lane
+ *
+ * Objects that hand out futures referencing themselves keep an io_scope as
+ * their last member. On destruction the scope cancels its queued tasks and
+ * waits for running ones, so no task outlives its owner.
+ */
+class io_scope {
+public:
+    /**
+     * @brief Create a scope on a lane
+     * @param lane Lane name
+     * @param executor Executor to submit to
+     */
+    explicit io_scope(std::string lane, io_executor& executor = io_executor::shared())
+        : executor_(&executor)
+        , lane_(std::move(lane))
+        , state_(std::make_shared<tracker>()) {}
+
+    ~io_scope() {
+        cancel();
+        wait();
+    }
+
+    io_scope(const io_scope&) = delete;
+    auto operator=(const io_scope&) -> io_scope& = delete;
+    io_scope(io_scope&&) = delete;
+    auto operator=(io_scope&&) -> io_scope& = delete;
+
+    /**
+     * @brief Submit a task on this scope's lane
+     */
+    template <typename F>
+    [[nodiscard]] auto submit(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+        return submit_after(std::chrono::steady_clock::duration::zero(), std::forward<F>(fn));
+    }
+
+    /**
+     * @brief Submit a delayed task on this scope's lane
+     */
+    template <typename F>
+    [[nodiscard]] auto submit_after(std::chrono::steady_clock::duration delay, F&& fn)
+        -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+        state_->begin();
+        auto guard = std::shared_ptr<void>(nullptr, [state = state_](void*) { state->end(); });
+        return executor_->submit_after(
+            delay, lane_,
+            [guard, fn = std::decay_t<F>(std::forward<F>(fn))]() mutable { return fn(); },
+            token_);
+    }
+
+    /**
+     * @brief Set the concurrency limit of this scope's lane
+     */
+    auto set_concurrency_limit(std::size_t max_concurrent) -> void {
+        executor_->set_lane_limit(lane_, max_concurrent);
+    }
+
+    /**
+     * @brief Mark this scope's lane as blocking (see io_executor)
+     */
+    auto set_blocking(bool blocking = true) -> void {
+        executor_->set_lane_blocking(lane_, blocking);
+    }
+
+    /**
+     * @brief Cancel all tasks of this scope that have not started yet
+     */
+    auto cancel() -> void { token_.cancel(); }
+
+    /**
+     * @brief Wait until no task of this scope is queued or running
+     */
+    auto wait() -> void { state_->wait_idle(); }
+
+    /**
+     * @brief Number of tasks of this scope that are queued or running
+     */
+    [[nodiscard]] auto in_flight() const -> std::size_t { return state_->count(); }
+
+    [[nodiscard]] auto lane() const -> const std::string& { return lane_; }
+
+private:
+    class tracker {
+    public:
+        auto begin() -> void {
+            std::lock_guard lock(mutex_);
+            ++in_flight_;
+        }
+
+        auto end() -> void {
+            std::lock_guard lock(mutex_);
+            if (--in_flight_ == 0) {
+                idle_.notify_all();
+            }
+        }
+
+        auto wait_idle() -> void {
+            std::unique_lock lock(mutex_);
+            idle_.wait(lock, [this] { return in_flight_ == 0; });
+        }
+
+        [[nodiscard]] auto count() const -> std::size_t {
+            std::lock_guard lock(mutex_);
+            return in_flight_;
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        std::condition_variable idle_;
+        std::size_t in_flight_ = 0;
+    };
+
+    io_executor* executor_;
+    std::string lane_;
+    io_cancellation_token token_;
+    std::shared_ptr<tracker> state_;
+};
+
+}  // namespace kcenon::file_transfer
+
+#endif  // KCENON_FILE_TRANSFER_CORE_IO_EXECUTOR_H
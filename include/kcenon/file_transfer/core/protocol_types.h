@@ -10,6 +10,8 @@
 #ifndef KCENON_FILE_TRANSFER_CORE_PROTOCOL_TYPES_H
 #define KCENON_FILE_TRANSFER_CORE_PROTOCOL_TYPES_H
 
+#include "chunk_types.h"
+
 #include <array>
 #include <cstdint>
 #include <string>
@@ -206,6 +208,10 @@ enum class client_capabilities : uint32_t {
     quic_support = 1 << 3,
     auto_reconnect = 1 << 4,
     encryption = 1 << 5,        ///< Application-level encryption support
+    integrity_crc32c = 1 << 6,  ///< Verifies CRC32C chunk checksums
+    integrity_xxh3 = 1 << 7,    ///< Verifies XXH3-64 chunk checksums
+    forward_error_correction = 1 << 8,  ///< Rebuilds lost chunks from parity chunks
+    stream_compression = 1 << 9,        ///< Decompresses chunks linked to earlier ones
 };
 
 [[nodiscard]] constexpr auto operator|(client_capabilities a,
@@ -227,6 +233,29 @@ enum class client_capabilities : uint32_t {
     return (static_cast<uint32_t>(caps) & static_cast<uint32_t>(cap)) != 0;
 }
 
+/**
+ * @brief Pick the chunk integrity algorithm for a connection
+ *
+ * The strongest algorithm both sides advertise wins: XXH3-64, then CRC32C.
+ * CRC32 needs no capability bit and is what remains otherwise.
+ *
+ * @param local Capabilities of this side
+ * @param peer Capabilities the other side sent
+ * @return Algorithm to put in chunk headers
+ */
+[[nodiscard]] constexpr auto negotiate_integrity(client_capabilities local,
+                                                 client_capabilities peer)
+    -> chunk_integrity {
+    auto common = local & peer;
+    if (has_capability(common, client_capabilities::integrity_xxh3)) {
+        return chunk_integrity::xxh3_64;
+    }
+    if (has_capability(common, client_capabilities::integrity_crc32c)) {
+        return chunk_integrity::crc32c;
+    }
+    return chunk_integrity::crc32;
+}
+
 /**
  * @brief Transfer options flags
  */
@@ -236,6 +265,8 @@ enum class transfer_options : uint32_t {
     verify_checksum = 1 << 1,
     preserve_timestamp = 1 << 2,
     encrypted = 1 << 3,              ///< Enable encryption for this transfer
+    deferred_digest = 1 << 4,        ///< SHA-256 follows in UPLOAD_COMPLETE
+    variable_chunks = 1 << 5,        ///< Chunk sizes vary; each is placed by its offset
 };
 
 [[nodiscard]] constexpr auto operator|(transfer_options a, transfer_options b)
@@ -262,6 +293,7 @@ enum class wire_compression_mode : uint8_t {
     none = 0x00,
     lz4 = 0x01,
     adaptive = 0x02,
+    lz4_stream = 0x03,  ///< Adaptive, with each chunk compressed against the ones before it
 };
 
 /**
@@ -380,15 +412,30 @@ struct msg_upload_reject {
 };
 
 /**
- * @brief UPLOAD_COMPLETE message payload (40 bytes)
+ * @brief UPLOAD_COMPLETE message payload (40 or 72 bytes)
+ *
+ * The SHA-256 is sent only for uploads requested with
+ * transfer_options::deferred_digest, whose client hashes the file while
+ * streaming it instead of before the UPLOAD_REQUEST.
  */
 struct msg_upload_complete {
     std::array<uint8_t, 16> transfer_id;   // 16 bytes (UUID)
     uint64_t total_chunks;                  // 8 bytes
     uint64_t bytes_sent;                    // 8 bytes (raw)
     uint64_t bytes_on_wire;                 // 8 bytes (compressed)
+    std::array<uint8_t, 32> sha256_hash{};  // 32 bytes (optional, all zero = absent)
 
     static constexpr std::size_t serialized_size = 40;
+    static constexpr std::size_t serialized_size_with_digest = 72;
+
+    [[nodiscard]] auto has_digest() const -> bool {
+        for (auto b : sha256_hash) {
+            if (b != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
 };
 
 /**
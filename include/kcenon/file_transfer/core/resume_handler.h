@@ -36,6 +36,8 @@ struct transfer_state {
     uint64_t transferred_bytes = 0;    ///< Bytes successfully transferred
     uint32_t total_chunks = 0;         ///< Total number of chunks
     std::vector<bool> chunk_bitmap;    ///< Bitmap of received chunks
+    bool variable_chunks = false;      ///< Chunks vary in size; progress is tracked in bytes
+    std::vector<file_byte_range> received_ranges;  ///< Received bytes, sorted and merged
     std::string sha256;                ///< SHA-256 hash of the file
     std::chrono::system_clock::time_point started_at;    ///< Transfer start time
     std::chrono::system_clock::time_point last_activity; ///< Last activity time
@@ -74,9 +76,27 @@ struct transfer_state {
 
     /**
      * @brief Check if transfer is complete
-     * @return true if all chunks received
+     * @return true if all chunks received, or for variable-size chunks
+     *         if the received ranges cover the whole file
      */
     [[nodiscard]] auto is_complete() const -> bool;
+
+    /**
+     * @brief Record a received byte range, merging it with its neighbours
+     * @param range Range of the file that was received
+     */
+    void add_received_range(file_byte_range range);
+
+    /**
+     * @brief Get the byte ranges not received yet
+     * @return Gaps between the received ranges, in file order
+     */
+    [[nodiscard]] auto missing_ranges() const -> std::vector<file_byte_range>;
+
+    /**
+     * @brief Get the number of bytes covered by received ranges
+     */
+    [[nodiscard]] auto received_range_bytes() const -> uint64_t;
 };
 
 /**
@@ -127,6 +147,13 @@ struct resume_handler_config {
  *
  * // Get missing chunks for resume
  * auto missing = handler.get_missing_chunks(id);
+ *
+ * // Chunks of varying size are tracked by byte range instead
+ * transfer_state variable(id, "big.iso", file_size, 0, hash);
+ * variable.variable_chunks = true;
+ * handler.save_state(variable);
+ * handler.mark_range_received(id, 0, 16 * 1024 * 1024);
+ * auto gaps = handler.get_missing_ranges(id);
  * @endcode
  */
 class resume_handler {
@@ -196,6 +223,17 @@ public:
         const transfer_id& id,
         uint32_t chunk_index) -> result<void>;
 
+    /**
+     * @brief Mark the chunk described by a header as received
+     * @param header Header of the received chunk
+     * @return Success or error
+     *
+     * Marks the chunk index, or for a transfer with variable_chunks the
+     * byte range [chunk_offset, chunk_offset + original_size). A zero_range
+     * chunk counts as received like any other: its zeros need no payload.
+     */
+    [[nodiscard]] auto mark_chunk_received(const chunk_header& header) -> result<void>;
+
     /**
      * @brief Mark multiple chunks as received
      * @param id Transfer identifier
@@ -214,6 +252,29 @@ public:
     [[nodiscard]] auto get_missing_chunks(const transfer_id& id)
         -> result<std::vector<uint32_t>>;
 
+    /**
+     * @brief Mark a byte range as received
+     * @param id Transfer identifier
+     * @param offset Offset of the range in the file
+     * @param length Length of the range
+     * @return Success or error if the range lies outside the file
+     *
+     * For transfers whose chunks vary in size, where an index does not
+     * locate a chunk. Checkpoints like mark_chunk_received().
+     */
+    [[nodiscard]] auto mark_range_received(
+        const transfer_id& id,
+        uint64_t offset,
+        uint64_t length) -> result<void>;
+
+    /**
+     * @brief Get the byte ranges not received yet
+     * @param id Transfer identifier
+     * @return Missing ranges in file order, or error
+     */
+    [[nodiscard]] auto get_missing_ranges(const transfer_id& id)
+        -> result<std::vector<file_byte_range>>;
+
     /**
      * @brief Check if a specific chunk was received
      * @param id Transfer identifier
@@ -0,0 +1,207 @@
+/**
+ * @file stream_compression.h
+ * @brief LZ4 compression of a transfer's chunks as one stream
+ *
+ * compression_engine compresses every chunk on its own, so a repeat that
+ * spans a chunk boundary is never found and small chunks compress poorly.
+ * Here each chunk may refer back to the data of the chunks before it, up
+ * to a window of 64KB. Every resync_interval chunks the history starts
+ * over, which bounds what a chunk depends on when others are lost,
+ * reordered or resent.
+ */
+
+#ifndef KCENON_FILE_TRANSFER_CORE_STREAM_COMPRESSION_H
+#define KCENON_FILE_TRANSFER_CORE_STREAM_COMPRESSION_H
+
+#include <kcenon/file_transfer/core/chunk_types.h>
+#include <kcenon/file_transfer/core/compression_engine.h>
+#include <kcenon/file_transfer/core/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace kcenon::file_transfer {
+
+/**
+ * @brief Layout of a compressed chunk stream
+ *
+ * Chunks are grouped into segments of resync_interval consecutive indices.
+ * A chunk may be compressed against the last window_size bytes of the
+ * segment's data before it; the first chunk of a segment never is. Both
+ * ends must use the same values.
+ */
+struct stream_compression_config {
+    /// Default number of chunks per segment
+    static constexpr std::size_t default_resync_interval = 16;
+
+    /// Largest window LZ4 can refer back to
+    static constexpr std::size_t max_window_size = 64 * 1024;
+
+    /// Chunks per segment; the history starts over at every segment
+    std::size_t resync_interval = default_resync_interval;
+
+    /// Bytes of preceding data a chunk may refer to
+    std::size_t window_size = max_window_size;
+
+    /// Compression level of the sender
+    compression_level level = compression_level::fast;
+
+    /**
+     * @brief Index of the first chunk of the segment holding a chunk
+     */
+    [[nodiscard]] auto segment_start(uint64_t chunk_index) const noexcept -> uint64_t {
+        return resync_interval == 0 ? chunk_index : chunk_index - chunk_index % resync_interval;
+    }
+
+    /**
+     * @brief Validate configuration
+     * @return Success if valid, error otherwise
+     */
+    [[nodiscard]] auto validate() const -> result<void>;
+};
+
+/**
+ * @brief Sender side of stream compression, one per transfer
+ *
+ * Chunks are fed in index order, zero_range chunks included, after
+ * splitting and before encryption. A chunk compressed against the data
+ * before it is flagged chunk_flags::linked; the first chunk of a segment,
+ * and any chunk sent uncompressed, is not. A chunk whose index does not
+ * follow the previous one (a retransmission, or after a gap) is
+ * compressed on its own, and the stream does not link again until the
+ * next segment. Parity chunks pass through untouched.
+ *
+ * @code
+ * stream_compressor compressor;
+ * for (auto& c : chunks) {
+ *     if (auto r = compressor.compress(c); r) {
+ *         send(c);
+ *     }
+ * }
+ * @endcode
+ */
+class stream_compressor {
+public:
+    /**
+     * @brief Create a compressor
+     * @param config Stream layout, expected to pass validate()
+     */
+    explicit stream_compressor(stream_compression_config config = {});
+
+    /**
+     * @brief Destructor
+     */
+    ~stream_compressor();
+
+    // Non-copyable but movable
+    stream_compressor(const stream_compressor&) = delete;
+    auto operator=(const stream_compressor&) -> stream_compressor& = delete;
+    stream_compressor(stream_compressor&&) noexcept;
+    auto operator=(stream_compressor&&) noexcept -> stream_compressor&;
+
+    /**
+     * @brief Compress the next chunk in place
+     *
+     * Replaces the payload when compression pays off, and sets
+     * header.compressed_size and the compressed and linked flags.
+     *
+     * @param c Chunk holding uncompressed, unencrypted data
+     * @param mode disabled sends the data as is but still feeds the history;
+     *        adaptive skips data that does not look compressible
+     * @return Success, or error if compression failed
+     */
+    [[nodiscard]] auto compress(chunk& c, compression_mode mode = compression_mode::adaptive)
+        -> result<void>;
+
+    /**
+     * @brief Get the stream layout
+     */
+    [[nodiscard]] auto config() const -> const stream_compression_config&;
+
+    /**
+     * @brief Get compression statistics
+     */
+    [[nodiscard]] auto stats() const -> compression_stats;
+
+private:
+    class impl;
+    std::unique_ptr<impl> impl_;
+};
+
+/**
+ * @brief Receiver side of stream compression, one per transfer
+ *
+ * Keeps the tail of every chunk it has seen for the current and the
+ * previous segment. A linked chunk can be decompressed once the chunks
+ * before it in its segment, as far back as the window reaches, have been
+ * passed to decompress() or record(); until then ready() says to hold it.
+ * Not thread-safe; callers serialize access.
+ */
+class stream_decompressor {
+public:
+    /**
+     * @brief Create a decompressor
+     * @param config Stream layout of the sender
+     */
+    explicit stream_decompressor(stream_compression_config config = {});
+
+    /**
+     * @brief Check whether a chunk can be passed on now
+     *
+     * True when the history the chunk refers to is here, or will never be
+     * because its segment has been dropped; decompress() then fails and
+     * the chunk has to be resent.
+     *
+     * @param chunk_index Index of the chunk
+     * @param flags Wire flags of the chunk
+     */
+    [[nodiscard]] auto ready(uint64_t chunk_index, chunk_flags flags) const -> bool;
+
+    /**
+     * @brief Decompress a chunk and keep its data as history
+     *
+     * @param chunk_index Index of the chunk
+     * @param flags Wire flags; must include chunk_flags::compressed
+     * @param payload Compressed payload
+     * @param original_size Size of the uncompressed data
+     * @return Uncompressed data, or error if the history is missing or the
+     *         payload is corrupt
+     */
+    [[nodiscard]] auto decompress(uint64_t chunk_index, chunk_flags flags,
+                                  std::span<const std::byte> payload,
+                                  std::size_t original_size) -> result<std::vector<std::byte>>;
+
+    /**
+     * @brief Keep the data of a chunk that arrived uncompressed as history
+     *
+     * @param chunk_index Index of the chunk
+     * @param flags Wire flags; a zero_range chunk stands for original_size zeros
+     * @param data Uncompressed payload
+     * @param original_size Size of the data
+     */
+    auto record(uint64_t chunk_index, chunk_flags flags, std::span<const std::byte> data,
+                std::size_t original_size) -> void;
+
+    /**
+     * @brief Get the stream layout
+     */
+    [[nodiscard]] auto config() const noexcept -> const stream_compression_config& {
+        return config_;
+    }
+
+private:
+    auto history(uint64_t chunk_index) const -> result<std::vector<std::byte>>;
+    auto keep(uint64_t chunk_index, std::span<const std::byte> data, std::size_t zeros) -> void;
+
+    stream_compression_config config_;
+    std::map<uint64_t, std::vector<std::byte>> tails_;  ///< Last window_size bytes per chunk
+    uint64_t horizon_ = 0;  ///< First index whose tail is still kept
+};
+
+}  // namespace kcenon::file_transfer
+
+#endif  // KCENON_FILE_TRANSFER_CORE_STREAM_COMPRESSION_H
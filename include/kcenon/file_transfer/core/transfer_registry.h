@@ -0,0 +1,317 @@
+/**
+ * @file transfer_registry.h
+ * @brief Sharded concurrent map for per-transfer state
+ *
+ * Registries of live transfers are looked up for every chunk. With one lock
+ * around one map, every transfer waits on every other; this map splits the
+ * keys across independently locked shards of small open-addressed tables.
+ */
+
+#ifndef KCENON_FILE_TRANSFER_CORE_TRANSFER_REGISTRY_H
+#define KCENON_FILE_TRANSFER_CORE_TRANSFER_REGISTRY_H
+
+#include <kcenon/file_transfer/core/chunk_types.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+namespace kcenon::file_transfer {
+
+namespace detail {
+
+/**
+ * @brief Spread a hash over all 64 bits (splitmix64 finaliser)
+ *
+ * std::hash of an integer is the identity on common standard libraries, so
+ * sequential handles would otherwise all land in the same shard.
+ */
+[[nodiscard]] constexpr auto mix_hash(uint64_t h) noexcept -> uint64_t {
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Sharded concurrent map from a transfer key to shared state
+ *
+ * The high bits of the mixed hash pick one of a power-of-two number of
+ * shards, each guarded by its own reader/writer lock and holding a
+ * linear-probing table whose slots keep the full hash, so a probe compares
+ * keys only on a hash match. Tables grow at 3/4 occupancy and drop
+ * tombstones when they do.
+ *
+ * Values are held by std::shared_ptr and find() hands out a reference: a
+ * value erased while another thread still uses it is destroyed when that
+ * thread lets go, never under it. Callers guard the value's own fields.
+ *
+ * @tparam T Value type
+ * @tparam Key Key type; transfer_id by default
+ * @tparam Hash Hash of Key
+ *
+ * @code
+ * transfer_registry<session> sessions;
+ * sessions.insert(id, std::make_shared<session>());
+ * if (auto s = sessions.find(id)) {
+ *     std::lock_guard lock(s->mutex);
+ *     s->received++;
+ * }
+ * @endcode
+ */
+template <typename T, typename Key = transfer_id, typename Hash = std::hash<Key>>
+class transfer_registry {
+public:
+    using key_type = Key;
+    using value_ptr = std::shared_ptr<T>;
+
+    /// Default number of shards
+    static constexpr std::size_t default_shard_count = 64;
+
+    /**
+     * @brief Create an empty registry
+     * @param shard_count Number of shards, rounded up to a power of two
+     */
+    explicit transfer_registry(std::size_t shard_count = default_shard_count)
+        : shard_bits_(static_cast<unsigned>(
+              std::countr_zero(std::bit_ceil(std::max<std::size_t>(shard_count, 1))))),
+          shards_(std::make_unique<shard[]>(std::size_t{1} << shard_bits_)) {}
+
+    transfer_registry(const transfer_registry&) = delete;
+    auto operator=(const transfer_registry&) -> transfer_registry& = delete;
+    transfer_registry(transfer_registry&&) noexcept = default;
+    auto operator=(transfer_registry&&) noexcept -> transfer_registry& = default;
+
+    /**
+     * @brief Insert a value unless the key is present
+     * @param key Key
+     * @param value Value to insert
+     * @return The value now stored under key, and whether it is the one given
+     */
+    auto insert(const Key& key, value_ptr value) -> std::pair<value_ptr, bool> {
+        auto h = hash_of(key);
+        auto& s = shard_for(h);
+        std::unique_lock lock(s.mutex);
+
+        if (auto* found = s.find(key, h)) {
+            return {found->value, false};
+        }
+        if ((s.used + s.deleted + 1) * 4 > s.slots.size() * 3) {
+            s.rehash();
+        }
+        s.place(key, h, value);
+        return {std::move(value), true};
+    }
+
+    /**
+     * @brief Look up a value
+     * @param key Key
+     * @return Shared reference to the value, or nullptr if absent
+     */
+    [[nodiscard]] auto find(const Key& key) const -> value_ptr {
+        auto h = hash_of(key);
+        const auto& s = shard_for(h);
+        std::shared_lock lock(s.mutex);
+        const auto* found = s.find(key, h);
+        return found ? found->value : nullptr;
+    }
+
+    /**
+     * @brief Check whether a key is present
+     */
+    [[nodiscard]] auto contains(const Key& key) const -> bool {
+        auto h = hash_of(key);
+        const auto& s = shard_for(h);
+        std::shared_lock lock(s.mutex);
+        return s.find(key, h) != nullptr;
+    }
+
+    /**
+     * @brief Remove a key
+     * @param key Key
+     * @return The removed value, or nullptr if absent
+     */
+    auto erase(const Key& key) -> value_ptr {
+        auto h = hash_of(key);
+        auto& s = shard_for(h);
+        std::unique_lock lock(s.mutex);
+
+        auto* found = s.find(key, h);
+        if (!found) {
+            return nullptr;
+        }
+        auto value = std::move(found->value);
+        found->key = Key{};
+        found->state = slot_state::deleted;
+        --s.used;
+        ++s.deleted;
+        return value;
+    }
+
+    /**
+     * @brief Remove every key
+     * @return The removed values
+     */
+    auto clear() -> std::vector<value_ptr> {
+        std::vector<value_ptr> removed;
+        for (std::size_t i = 0; shards_ && i < shard_count(); ++i) {
+            auto& s = shards_[i];
+            std::unique_lock lock(s.mutex);
+            for (auto& entry : s.slots) {
+                if (entry.state == slot_state::full) {
+                    removed.push_back(std::move(entry.value));
+                }
+            }
+            s.slots.clear();
+            s.used = 0;
+            s.deleted = 0;
+        }
+        return removed;
+    }
+
+    /**
+     * @brief Call fn(key, value) for every entry
+     *
+     * Each shard is copied out under its lock and visited after the lock is
+     * released, so fn may use the registry. Entries inserted or erased
+     * meanwhile may or may not be visited.
+     */
+    template <typename F>
+    auto for_each(F&& fn) const -> void {
+        std::vector<std::pair<Key, value_ptr>> entries;
+        for (std::size_t i = 0; shards_ && i < shard_count(); ++i) {
+            entries.clear();
+            {
+                std::shared_lock lock(shards_[i].mutex);
+                for (const auto& entry : shards_[i].slots) {
+                    if (entry.state == slot_state::full) {
+                        entries.emplace_back(entry.key, entry.value);
+                    }
+                }
+            }
+            for (const auto& [key, value] : entries) {
+                fn(key, value);
+            }
+        }
+    }
+
+    /**
+     * @brief Get the number of entries
+     *
+     * Shards are counted one after another, so concurrent changes may be
+     * partly reflected.
+     */
+    [[nodiscard]] auto size() const -> std::size_t {
+        std::size_t total = 0;
+        for (std::size_t i = 0; shards_ && i < shard_count(); ++i) {
+            std::shared_lock lock(shards_[i].mutex);
+            total += shards_[i].used;
+        }
+        return total;
+    }
+
+    /**
+     * @brief Check whether the registry has no entries
+     */
+    [[nodiscard]] auto empty() const -> bool { return size() == 0; }
+
+    /**
+     * @brief Get the number of shards
+     */
+    [[nodiscard]] auto shard_count() const noexcept -> std::size_t {
+        return std::size_t{1} << shard_bits_;
+    }
+
+private:
+    enum class slot_state : uint8_t { empty, full, deleted };
+
+    struct slot {
+        Key key{};
+        value_ptr value;
+        uint64_t hash = 0;
+        slot_state state = slot_state::empty;
+    };
+
+    static constexpr std::size_t min_slots = 8;
+
+    // Own cache line, so neighbouring shard locks do not false-share
+    struct alignas(64) shard {
+        mutable std::shared_mutex mutex;
+        std::vector<slot> slots;    ///< Power-of-two size, or empty
+        std::size_t used = 0;       ///< Full slots
+        std::size_t deleted = 0;    ///< Tombstones
+
+        auto find(const Key& key, uint64_t h) -> slot* {
+            return const_cast<slot*>(std::as_const(*this).find(key, h));
+        }
+
+        auto find(const Key& key, uint64_t h) const -> const slot* {
+            if (slots.empty()) {
+                return nullptr;
+            }
+            auto mask = slots.size() - 1;
+            for (auto i = h & mask, n = std::size_t{0}; n < slots.size(); i = (i + 1) & mask, ++n) {
+                const auto& entry = slots[i];
+                if (entry.state == slot_state::empty) {
+                    return nullptr;
+                }
+                if (entry.state == slot_state::full && entry.hash == h && entry.key == key) {
+                    return &entry;
+                }
+            }
+            return nullptr;
+        }
+
+        // Key known to be absent and a free slot known to exist
+        auto place(const Key& key, uint64_t h, value_ptr value) -> void {
+            auto mask = slots.size() - 1;
+            auto i = h & mask;
+            while (slots[i].state == slot_state::full) {
+                i = (i + 1) & mask;
+            }
+            if (slots[i].state == slot_state::deleted) {
+                --deleted;
+            }
+            slots[i] = slot{key, std::move(value), h, slot_state::full};
+            ++used;
+        }
+
+        auto rehash() -> void {
+            auto capacity = std::max(min_slots, std::bit_ceil((used + 1) * 2));
+            auto old = std::exchange(slots, std::vector<slot>(capacity));
+            used = 0;
+            deleted = 0;
+            for (auto& entry : old) {
+                if (entry.state == slot_state::full) {
+                    place(entry.key, entry.hash, std::move(entry.value));
+                }
+            }
+        }
+    };
+
+    [[nodiscard]] static auto hash_of(const Key& key) -> uint64_t {
+        return detail::mix_hash(static_cast<uint64_t>(Hash{}(key)));
+    }
+
+    [[nodiscard]] auto shard_for(uint64_t h) const -> shard& {
+        return shards_[shard_bits_ == 0 ? 0 : h >> (64 - shard_bits_)];
+    }
+
+    unsigned shard_bits_;
+    std::unique_ptr<shard[]> shards_;
+};
+
+}  // namespace kcenon::file_transfer
+
+#endif  // KCENON_FILE_TRANSFER_CORE_TRANSFER_REGISTRY_H
@@ -61,6 +61,7 @@ enum class error_code {
     connection_refused = -162,
     connection_lost = -163,
     server_not_running = -164,
+    invalid_message = -165,
 
     // Quota errors (-180 to -199)
     quota_exceeded = -180,
@@ -70,6 +71,8 @@ enum class error_code {
     internal_error = -200,
     not_initialized = -201,
     already_initialized = -202,
+    operation_cancelled = -203,
+    queue_full = -204,
 
     // Transfer control errors (-220 to -239)
     invalid_state_transition = -220,
@@ -125,6 +128,8 @@ enum class error_code {
             return "connection lost";
         case error_code::server_not_running:
             return "server not running";
+        case error_code::invalid_message:
+            return "invalid message";
         case error_code::quota_exceeded:
             return "quota exceeded";
         case error_code::storage_full:
@@ -135,6 +140,10 @@ enum class error_code {
             return "not initialized";
         case error_code::already_initialized:
             return "already initialized";
+        case error_code::operation_cancelled:
+            return "operation cancelled";
+        case error_code::queue_full:
+            return "queue full";
         case error_code::invalid_state_transition:
             return "invalid state transition";
         case error_code::transfer_not_found:
@@ -256,6 +265,7 @@ struct assembly_progress {
     uint64_t total_chunks;
     uint64_t received_chunks;
     uint64_t bytes_written;
+    uint64_t recovered_chunks = 0;  ///< Of received_chunks, rebuilt from FEC parity
 
     [[nodiscard]] auto completion_percentage() const -> double {
         if (total_chunks == 0) return 0.0;
@@ -12,6 +12,7 @@
 
 #ifdef FILE_TRANS_ENABLE_ENCRYPTION
 
+#include <array>
 #include <atomic>
 #include <memory>
 #include <mutex>
@@ -65,6 +66,24 @@ private:
     std::unique_ptr<impl> impl_;
 };
 
+/**
+ * @brief One chunk of a batch encrypt or decrypt
+ *
+ * The data is transformed in place, so the caller can keep reusing the
+ * same buffers (e.g. the chunk buffers of a pipeline) for every batch.
+ */
+struct aes_gcm_chunk {
+    /// Chunk index; the IV is derived from it
+    uint64_t index = 0;
+
+    /// Plaintext replaced by ciphertext on encrypt, and the reverse on decrypt
+    std::span<std::byte> data;
+
+    /// Authentication tag, written by encrypt and checked by decrypt
+    /// (only the first tag_size() bytes are used)
+    std::array<std::byte, AES_GCM_TAG_SIZE> tag{};
+};
+
 /**
  * @brief AES-256-GCM encryption engine
  *
@@ -75,6 +94,11 @@ private:
  * - Counter-based IV generation to prevent reuse
  * - Hardware AES acceleration support (AES-NI)
  *
+ * Cipher contexts are kept in a pool with the key schedule already expanded;
+ * each operation checks one out and only resets the IV, so concurrent
+ * threads each work on a context of their own and small chunks do not pay
+ * for context setup. Setting or clearing the key drops the pool.
+ *
  * @code
  * // Create AES-GCM engine
  * auto engine = aes_gcm_engine::create(aes_gcm_config{});
@@ -175,6 +199,81 @@ public:
         const encryption_metadata& metadata,
         uint64_t chunk_index) -> result<decryption_result> override;
 
+    // ========================================================================
+    // In-place and Batch Chunk Encryption
+    // ========================================================================
+    //
+    // These use a deterministic IV: the IV salt followed by the chunk index
+    // as a 64-bit big-endian counter. Nothing but the tag has to travel with
+    // a chunk, but an index must never be encrypted twice under the same
+    // key and salt. Use a fresh key or salt per transfer, and resend the
+    // stored ciphertext rather than re-encrypting a retransmitted chunk.
+
+    /**
+     * @brief Get the salt in front of the chunk counter in derived IVs
+     *
+     * Drawn at random by set_key(); the decrypting side adopts it with
+     * set_iv_salt(). Empty when iv_size() is too small for a 64-bit counter.
+     */
+    [[nodiscard]] auto iv_salt() const -> std::vector<std::byte>;
+
+    /**
+     * @brief Replace the IV salt, e.g. with the one the sender used
+     * @param salt iv_size() - 8 bytes
+     * @return Result indicating success or error
+     *
+     * Not synchronized with chunk operations; set it before starting them.
+     */
+    [[nodiscard]] auto set_iv_salt(std::span<const std::byte> salt) -> result<void>;
+
+    /**
+     * @brief Get the IV derived for a chunk index
+     * @param chunk_index Chunk index
+     * @return IV, or empty if iv_size() is too small for a 64-bit counter
+     */
+    [[nodiscard]] auto chunk_iv(uint64_t chunk_index) const -> std::vector<std::byte>;
+
+    /**
+     * @brief Encrypt a chunk in place
+     * @param data Plaintext, overwritten with the ciphertext of the same size
+     * @param chunk_index Chunk index the IV is derived from
+     * @param tag Receives the authentication tag (at least tag_size() bytes)
+     * @return Result indicating success or error
+     */
+    [[nodiscard]] auto encrypt_chunk_in_place(
+        std::span<std::byte> data,
+        uint64_t chunk_index,
+        std::span<std::byte> tag) -> result<void>;
+
+    /**
+     * @brief Decrypt a chunk in place
+     * @param data Ciphertext, overwritten with the plaintext
+     * @param chunk_index Chunk index the IV is derived from
+     * @param tag Authentication tag produced by the encrypting side
+     * @return Result indicating success, or chunk_checksum_error if the
+     *         chunk fails authentication (data then holds garbage)
+     */
+    [[nodiscard]] auto decrypt_chunk_in_place(
+        std::span<std::byte> data,
+        uint64_t chunk_index,
+        std::span<const std::byte> tag) -> result<void>;
+
+    /**
+     * @brief Encrypt a batch of chunks in place on one cipher context
+     * @param chunks Chunks to encrypt; each gets its tag filled in
+     * @return Result indicating success, or the error of the first chunk
+     *         that failed (chunks after it are left untouched)
+     */
+    [[nodiscard]] auto encrypt_chunks(std::span<aes_gcm_chunk> chunks) -> result<void>;
+
+    /**
+     * @brief Decrypt a batch of chunks in place on one cipher context
+     * @param chunks Chunks to decrypt, with the tags from encrypt_chunks()
+     * @return Result indicating success, or the error of the first chunk
+     *         that failed authentication (chunks after it are left untouched)
+     */
+    [[nodiscard]] auto decrypt_chunks(std::span<aes_gcm_chunk> chunks) -> result<void>;
+
     // ========================================================================
     // State and Statistics
     // ========================================================================
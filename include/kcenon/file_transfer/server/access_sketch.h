@@ -0,0 +1,99 @@
+/**
+ * @file access_sketch.h
+ * @brief Windowed count-min sketch of object access frequencies
+ */
+
+#ifndef KCENON_FILE_TRANSFER_SERVER_ACCESS_SKETCH_H
+#define KCENON_FILE_TRANSFER_SERVER_ACCESS_SKETCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+
+namespace kcenon::file_transfer {
+
+/**
+ * @brief Fixed-size approximate access counter
+ *
+ * A count-min sketch: each key increments one counter in each of `depth`
+ * rows and its estimate is the smallest of those counters. Memory is
+ * width * depth counters regardless of how many keys are seen. Estimates
+ * never undercount; they exceed the true count by more than e*N/width
+ * with probability at most e^-depth, where N is the number of accesses
+ * in the window.
+ *
+ * Counts are kept in two generations. rotate() drops the older one, so an
+ * estimate covers accesses since the previous rotation; rotating every
+ * half window approximates a sliding window.
+ *
+ * record() and estimate() are safe to call concurrently with each other
+ * and with rotate().
+ */
+class access_sketch {
+public:
+    /**
+     * @brief Create a sketch
+     * @param width Counters per row (rounded up to a power of two)
+     * @param depth Number of rows (independent hashes)
+     */
+    explicit access_sketch(std::size_t width = 16384, std::size_t depth = 4);
+
+    access_sketch(const access_sketch&) = delete;
+    auto operator=(const access_sketch&) -> access_sketch& = delete;
+
+    /**
+     * @brief Count accesses to a key
+     * @param key Object key
+     * @param count Number of accesses
+     */
+    void record(std::string_view key, uint32_t count = 1);
+
+    /**
+     * @brief Estimate accesses to a key in the current window
+     * @param key Object key
+     * @return Upper bound on the access count
+     */
+    [[nodiscard]] auto estimate(std::string_view key) const -> uint64_t;
+
+    /**
+     * @brief Start a new generation, forgetting the oldest one
+     */
+    void rotate();
+
+    /**
+     * @brief Drop all counts
+     */
+    void clear();
+
+    /**
+     * @brief Counters per row
+     */
+    [[nodiscard]] auto width() const -> std::size_t { return width_; }
+
+    /**
+     * @brief Number of rows
+     */
+    [[nodiscard]] auto depth() const -> std::size_t { return depth_; }
+
+    /**
+     * @brief Bytes used by the counters
+     */
+    [[nodiscard]] auto memory_usage() const -> std::size_t;
+
+private:
+    [[nodiscard]] auto slot(uint64_t hash, std::size_t row) const -> std::size_t;
+
+    std::size_t width_;
+    std::size_t depth_;
+
+    mutable std::shared_mutex mutex_;  // Exclusive only while rotating
+    std::unique_ptr<std::atomic<uint32_t>[]> generations_[2];
+    std::size_t current_ = 0;
+};
+
+}  // namespace kcenon::file_transfer
+
+#endif  // KCENON_FILE_TRANSFER_SERVER_ACCESS_SKETCH_H
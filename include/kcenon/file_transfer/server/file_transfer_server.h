@@ -14,8 +14,10 @@
 #include <unordered_map>
 
 #include "kcenon/file_transfer/core/types.h"
+#include "kcenon/file_transfer/server/flow_scheduler.h"
 #include "kcenon/file_transfer/server/quota_manager.h"
 #include "kcenon/file_transfer/server/server_types.h"
+#include "kcenon/file_transfer/server/storage_manager.h"
 
 namespace kcenon::file_transfer {
 
@@ -81,6 +83,16 @@ public:
          */
         auto with_chunk_size(std::size_t size) -> builder&;
 
+        /**
+         * @brief Set the largest chunk of a variable-size upload
+         * @param size Chunk size in bytes, up to 64MB (default: 16MB)
+         * @return Reference to builder for chaining
+         *
+         * Bounds the frame buffer of every connection, so it is the memory
+         * one client can make the server hold for a single frame.
+         */
+        auto with_max_chunk_size(std::size_t size) -> builder&;
+
         /**
          * @brief Set storage mode
          * @param mode Storage mode (local_only, cloud_only, hybrid)
@@ -118,6 +130,13 @@ public:
          */
         auto with_cloud_replication(bool enable) -> builder&;
 
+        /**
+         * @brief Replicate to cloud in the background (hybrid mode)
+         * @param enable Enable write-behind replication (default: true)
+         * @return Reference to builder for chaining
+         */
+        auto with_async_replication(bool enable) -> builder&;
+
         /**
          * @brief Enable cloud read fallback
          * @param enable Enable fallback (default: true)
@@ -226,6 +245,31 @@ public:
      */
     void on_progress(std::function<void(const transfer_progress&)> callback);
 
+    // Upload scheduling
+    /**
+     * @brief Set a client's share of upload processing
+     *
+     * Chunks from all connections are processed in weighted round-robin
+     * order across clients, so one large upload cannot starve others.
+     *
+     * @param client Client
+     * @param weight Relative weight within its priority class (default 1)
+     */
+    void set_client_weight(client_id client, uint32_t weight);
+
+    /**
+     * @brief Set the scheduling class of an upload
+     * @param id Transfer ID
+     * @param priority Priority class (default normal)
+     */
+    void set_transfer_priority(const transfer_id& id, flow_priority priority);
+
+    /**
+     * @brief Get queue depth and wait-time histograms of active uploads
+     * @return One entry per upload in progress
+     */
+    [[nodiscard]] auto get_flow_statistics() const -> std::vector<flow_stats>;
+
     // Statistics
     /**
      * @brief Get server statistics
@@ -239,6 +283,18 @@ public:
      */
     [[nodiscard]] auto get_storage_stats() const -> storage_stats;
 
+    /**
+     * @brief Get the object storage used in cloud_only and hybrid modes
+     *
+     * Reads from the cloud backend go through the local read cache when
+     * cloud_storage_server_config::enable_cache is set; its hit, miss and
+     * eviction counters are part of the manager's statistics.
+     *
+     * @return Storage manager, or nullptr in local_only mode
+     */
+    [[nodiscard]] auto get_storage_manager() -> storage_manager*;
+    [[nodiscard]] auto get_storage_manager() const -> const storage_manager*;
+
     /**
      * @brief Get server configuration
      * @return Server configuration
@@ -272,6 +328,40 @@ public:
      */
     [[nodiscard]] auto check_upload_allowed(uint64_t file_size) -> result<void>;
 
+    /**
+     * @brief Reserve quota for an accepted upload request
+     *
+     * Validates the file size and atomically reserves file_size bytes, so
+     * concurrent uploads cannot overshoot the quota together. The reservation
+     * is held until commit_upload() or release_upload() is called.
+     *
+     * @param id Transfer ID of the upload
+     * @param file_size Announced size of the file
+     * @param client Client issuing the upload (used as reservation tenant)
+     * @return Result<void> on success, error if quota exceeded or file too large
+     */
+    [[nodiscard]] auto reserve_upload(
+        const transfer_id& id,
+        uint64_t file_size,
+        client_id client = client_id{}) -> result<void>;
+
+    /**
+     * @brief Commit the reservation of a finalized upload
+     * @param id Transfer ID of the upload
+     * @param stored_path Path of the stored file
+     * @param actual_size Actual size of the stored file
+     */
+    void commit_upload(
+        const transfer_id& id,
+        const std::filesystem::path& stored_path,
+        uint64_t actual_size);
+
+    /**
+     * @brief Release the reservation of a cancelled or failed upload
+     * @param id Transfer ID of the upload
+     */
+    void release_upload(const transfer_id& id);
+
     /**
      * @brief Set callback for quota warning events
      * @param callback Function called when quota warning threshold is reached
@@ -0,0 +1,201 @@
+/**
+ * @file flow_scheduler.h
+ * @brief Weighted deficit round-robin scheduling of upload chunks by flow
+ */
+
+#ifndef KCENON_FILE_TRANSFER_SERVER_FLOW_SCHEDULER_H
+#define KCENON_FILE_TRANSFER_SERVER_FLOW_SCHEDULER_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "kcenon/file_transfer/core/chunk_types.h"
+#include "kcenon/file_transfer/server/server_types.h"
+
+namespace kcenon::file_transfer {
+
+struct pipeline_chunk;
+
+/**
+ * @brief Scheduling class of a transfer
+ *
+ * Classes are served in strict order: a backlogged high flow always goes
+ * before normal ones, and bulk flows only get the capacity left over.
+ */
+enum class flow_priority : uint8_t {
+    high = 0,    ///< Interactive transfers
+    normal = 1,  ///< Default
+    bulk = 2     ///< Background transfers
+};
+
+/**
+ * @brief Convert flow_priority to string
+ */
+[[nodiscard]] constexpr auto to_string(flow_priority priority) -> const char* {
+    switch (priority) {
+        case flow_priority::high: return "high";
+        case flow_priority::normal: return "normal";
+        case flow_priority::bulk: return "bulk";
+        default: return "unknown";
+    }
+}
+
+/**
+ * @brief A flow is one transfer of one client
+ */
+struct flow_key {
+    client_id client;
+    transfer_id transfer;
+
+    [[nodiscard]] auto operator==(const flow_key& other) const -> bool = default;
+};
+
+/**
+ * @brief Histogram of queueing delays
+ *
+ * Bucket i counts waits up to 64us * 2^i; the last bucket also holds
+ * everything longer (about 2.1s and up).
+ */
+struct wait_histogram {
+    static constexpr std::size_t bucket_count = 16;
+
+    std::array<uint64_t, bucket_count> buckets{};
+    uint64_t count = 0;
+    std::chrono::microseconds total{0};
+    std::chrono::microseconds max{0};
+
+    /**
+     * @brief Upper bound of a bucket
+     */
+    [[nodiscard]] static constexpr auto upper_bound(std::size_t bucket)
+        -> std::chrono::microseconds {
+        return std::chrono::microseconds(int64_t{64} << bucket);
+    }
+
+    /**
+     * @brief Record one wait
+     */
+    void record(std::chrono::microseconds wait);
+
+    /**
+     * @brief Upper bound of the bucket holding the given percentile
+     * @param p Percentile in [0, 100]
+     * @return Bucket bound, or zero when empty
+     */
+    [[nodiscard]] auto percentile(double p) const -> std::chrono::microseconds;
+};
+
+/**
+ * @brief Scheduling statistics of one flow
+ */
+struct flow_stats {
+    flow_key key;
+    flow_priority priority = flow_priority::normal;
+    uint32_t weight = 1;               ///< Weight of the owning client
+    std::size_t queued_chunks = 0;     ///< Chunks waiting to enter the stages
+    uint64_t queued_bytes = 0;
+    uint64_t dispatched_chunks = 0;    ///< Chunks handed to the stages so far
+    uint64_t dispatched_bytes = 0;
+    wait_histogram wait;               ///< Time from push() to dispatch
+};
+
+/**
+ * @brief Fair queue of upload chunks in front of the pipeline stages
+ *
+ * Chunks are queued per flow. pop() serves the highest priority class that
+ * has queued chunks; within a class, clients share capacity by deficit
+ * round-robin weighted by their client weight (a client of weight 2 gets
+ * twice the bytes of a client of weight 1 while both are backlogged), and
+ * a client's transfers take turns chunk by chunk. One client with a large
+ * upload therefore cannot hold back another client's small one.
+ *
+ * Not thread-safe; server_pipeline serializes access.
+ */
+class flow_scheduler {
+public:
+    /**
+     * @brief Create a scheduler
+     * @param quantum Bytes credited per round to a client of weight 1
+     */
+    explicit flow_scheduler(std::size_t quantum = 64 * 1024);
+
+    flow_scheduler(const flow_scheduler&) = delete;
+    auto operator=(const flow_scheduler&) -> flow_scheduler& = delete;
+    flow_scheduler(flow_scheduler&&) noexcept;
+    auto operator=(flow_scheduler&&) noexcept -> flow_scheduler&;
+    ~flow_scheduler();
+
+    /**
+     * @brief Queue a chunk under its (client, transfer) flow
+     */
+    void push(pipeline_chunk chunk);
+
+    /**
+     * @brief Take the next chunk to dispatch
+     * @return The chunk, or nullopt when nothing is queued
+     */
+    [[nodiscard]] auto pop() -> std::optional<pipeline_chunk>;
+
+    /**
+     * @brief Set a client's share within its priority class
+     * @param client Client
+     * @param weight Relative weight (0 is treated as 1)
+     */
+    void set_client_weight(client_id client, uint32_t weight);
+
+    /**
+     * @brief Set the scheduling class of a transfer
+     *
+     * Applies to chunks already queued as well as later ones.
+     */
+    void set_transfer_priority(const transfer_id& id, flow_priority priority);
+
+    /**
+     * @brief Forget a transfer: its queued chunks, statistics and priority
+     * @return Queued chunks that were dropped
+     */
+    auto remove_transfer(const transfer_id& id) -> std::vector<pipeline_chunk>;
+
+    /**
+     * @brief Drop all queued chunks, keeping weights and priorities
+     * @return The dropped chunks
+     */
+    auto clear() -> std::vector<pipeline_chunk>;
+
+    /**
+     * @brief Number of queued chunks over all flows
+     */
+    [[nodiscard]] auto size() const -> std::size_t;
+
+    /**
+     * @brief Whether no chunks are queued
+     */
+    [[nodiscard]] auto empty() const -> bool { return size() == 0; }
+
+    /**
+     * @brief Statistics of every known flow
+     */
+    [[nodiscard]] auto stats() const -> std::vector<flow_stats>;
+
+private:
+    struct impl;
+    std::unique_ptr<impl> impl_;
+};
+
+}  // namespace kcenon::file_transfer
+
+// Hash support for flow_key
+template <>
+struct std::hash<kcenon::file_transfer::flow_key> {
+    auto operator()(const kcenon::file_transfer::flow_key& key) const noexcept -> std::size_t {
+        return std::hash<kcenon::file_transfer::transfer_id>{}(key.transfer) ^
+               (std::hash<uint64_t>{}(key.client.value) * 0x9E3779B97F4A7C15ULL);
+    }
+};
+
+#endif  // KCENON_FILE_TRANSFER_SERVER_FLOW_SCHEDULER_H
@@ -0,0 +1,148 @@
+/**
+ * @file metadata_index.h
+ * @brief Persistent sharded metadata index for local storage
+ */
+
+#ifndef KCENON_FILE_TRANSFER_SERVER_METADATA_INDEX_H
+#define KCENON_FILE_TRANSFER_SERVER_METADATA_INDEX_H
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "kcenon/file_transfer/core/types.h"
+#include "kcenon/file_transfer/server/storage_manager.h"
+
+namespace kcenon::file_transfer {
+
+/**
+ * @brief Persistent, sharded metadata index for stored objects
+ *
+ * Keys are sharded by their first path component, so a prefix query that
+ * names a top-level directory (e.g. "tenant-a/") touches a single shard.
+ * Each shard keeps an ordered in-memory table backed by an append-only log
+ * on disk; the log is compacted into a snapshot of live entries once it
+ * accumulates enough dead records.
+ *
+ * The index is marked dirty while open. If it was not closed cleanly, or the
+ * on-disk layout does not match, needs_rebuild() reports true and the owner
+ * is expected to call rebuild() to recover from the files on disk.
+ *
+ * @code
+ * auto index_result = metadata_index::open(base_path / ".file_trans_index");
+ * if (index_result.has_value()) {
+ *     auto& index = index_result.value();
+ *     if (index.needs_rebuild()) {
+ *         index.rebuild(base_path);
+ *     }
+ *     list_storage_options options;
+ *     options.prefix = "reports/";
+ *     options.sort_by = storage_sort_field::size;
+ *     auto page = index.query(options);
+ * }
+ * @endcode
+ */
+class metadata_index {
+public:
+    /// Default number of shards
+    static constexpr std::size_t default_shard_count = 16;
+
+    /**
+     * @brief Open (or create) an index in the given directory
+     * @param index_dir Directory holding the index files
+     * @param shard_count Number of shards
+     * @return Result containing the index or an error
+     */
+    [[nodiscard]] static auto open(
+        const std::filesystem::path& index_dir,
+        std::size_t shard_count = default_shard_count) -> result<metadata_index>;
+
+    // Non-copyable, movable
+    metadata_index(const metadata_index&) = delete;
+    auto operator=(const metadata_index&) -> metadata_index& = delete;
+    metadata_index(metadata_index&&) noexcept;
+    auto operator=(metadata_index&&) noexcept -> metadata_index&;
+    ~metadata_index();
+
+    /**
+     * @brief Insert or replace the entry for metadata.key
+     * @param metadata Object metadata
+     * @return Result<void> on success, error if the log cannot be written
+     */
+    auto put(const stored_object_metadata& metadata) -> result<void>;
+
+    /**
+     * @brief Remove the entry for a key
+     * @param key Object key
+     * @return Result<void> on success (also when the key is not indexed)
+     */
+    auto erase(const std::string& key) -> result<void>;
+
+    /**
+     * @brief Look up a single key
+     * @param key Object key
+     * @return Metadata if indexed, std::nullopt otherwise
+     */
+    [[nodiscard]] auto find(const std::string& key) const
+        -> std::optional<stored_object_metadata>;
+
+    /**
+     * @brief Query the index
+     *
+     * Honors prefix, tier_filter, max_results, sort_by, descending and
+     * continuation_token. When the result is truncated, its
+     * continuation_token resumes the listing after the last returned object.
+     *
+     * @param options List options
+     * @return Matching objects in the requested order
+     */
+    [[nodiscard]] auto query(const list_storage_options& options) const
+        -> list_storage_result;
+
+    /**
+     * @brief Rebuild the index from the files under a directory
+     *
+     * Entries are replaced with a fresh scan; files in internal directories
+     * (names starting with ".file_trans_") are skipped.
+     *
+     * @param root Directory to scan
+     * @return Number of indexed files, or an error
+     */
+    auto rebuild(const std::filesystem::path& root) -> result<std::size_t>;
+
+    /**
+     * @brief Rewrite every shard log as a snapshot of live entries
+     * @return Result<void> on success, error if a shard cannot be written
+     */
+    auto compact() -> result<void>;
+
+    /**
+     * @brief Check whether the index must be rebuilt from disk
+     * @return true after an unclean shutdown or a layout mismatch
+     */
+    [[nodiscard]] auto needs_rebuild() const -> bool;
+
+    /**
+     * @brief Get the number of indexed entries
+     * @return Entry count across all shards
+     */
+    [[nodiscard]] auto size() const -> std::size_t;
+
+    /**
+     * @brief Get the number of shards
+     * @return Shard count
+     */
+    [[nodiscard]] auto shard_count() const -> std::size_t;
+
+private:
+    metadata_index(const std::filesystem::path& index_dir, std::size_t shard_count);
+
+    struct impl;
+    std::unique_ptr<impl> impl_;
+};
+
+}  // namespace kcenon::file_transfer
+
+#endif  // KCENON_FILE_TRANSFER_SERVER_METADATA_INDEX_H
@@ -0,0 +1,197 @@
+/**
+ * @file object_cache.h
+ * @brief Disk-backed LRU read cache for remote storage objects
+ */
+
+#ifndef KCENON_FILE_TRANSFER_SERVER_OBJECT_CACHE_H
+#define KCENON_FILE_TRANSFER_SERVER_OBJECT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "kcenon/file_transfer/core/types.h"
+
+namespace kcenon::file_transfer {
+
+/**
+ * @brief Object cache configuration
+ */
+struct object_cache_config {
+    /// Directory holding cached objects
+    std::filesystem::path directory;
+
+    /// Maximum bytes of cached object data
+    uint64_t max_bytes = 1ULL * 1024 * 1024 * 1024;  // 1GB
+};
+
+/**
+ * @brief Object cache counters
+ */
+struct object_cache_statistics {
+    uint64_t hits = 0;            ///< Lookups served from the cache
+    uint64_t misses = 0;          ///< Lookups that fetched from the backend
+    uint64_t stale = 0;           ///< Entries dropped because their version changed
+    uint64_t coalesced = 0;       ///< Misses that waited on another caller's fetch
+    uint64_t fill_errors = 0;     ///< Fetches that failed
+    uint64_t evictions = 0;       ///< Entries evicted to stay within max_bytes
+    uint64_t bytes_evicted = 0;   ///< Bytes released by eviction
+    std::size_t entry_count = 0;  ///< Entries currently cached
+    uint64_t current_bytes = 0;   ///< Bytes currently cached
+};
+
+/**
+ * @brief Disk-backed, size-bounded LRU cache of remote objects
+ *
+ * Each entry is a data file plus a small sidecar record (key, version,
+ * size) in the cache directory; open() rebuilds the in-memory index from
+ * the sidecars, so the cache survives restarts. Entries are tagged with a
+ * version string (the object's ETag): a lookup with a different version
+ * drops the entry and fetches again.
+ *
+ * Concurrent misses on the same key and version share one fetch. Entries
+ * are pinned while a handle refers to them and are never evicted or
+ * deleted underneath a reader. Objects larger than max_bytes are fetched
+ * into a transient file that is removed when its handle is released.
+ *
+ * The cache must outlive every handle it hands out.
+ *
+ * @code
+ * auto cache = object_cache::open({"/var/cache/file_trans", 512ULL << 20});
+ * if (cache.has_value()) {
+ *     auto handle = cache.value().acquire(key, etag, [&](const auto& target) {
+ *         return download_to(key, target);
+ *     });
+ *     if (handle.has_value()) {
+ *         read_file(handle.value().path());
+ *     }
+ * }
+ * @endcode
+ */
+class object_cache {
+    struct impl;
+    struct entry;
+
+public:
+    /// Writes the object to the given path; called on a miss
+    using fetch_function = std::function<result<void>(const std::filesystem::path& target)>;
+
+    /**
+     * @brief Pinned reference to a cached object
+     */
+    class handle {
+    public:
+        handle() = default;
+        ~handle();
+
+        handle(const handle&) = delete;
+        auto operator=(const handle&) -> handle& = delete;
+        handle(handle&& other) noexcept;
+        auto operator=(handle&& other) noexcept -> handle&;
+
+        /**
+         * @brief Path of the cached data file (valid while the handle is held)
+         */
+        [[nodiscard]] auto path() const -> const std::filesystem::path&;
+
+        /**
+         * @brief Object size in bytes
+         */
+        [[nodiscard]] auto size() const -> uint64_t;
+
+        /**
+         * @brief Whether the lookup was served without fetching
+         */
+        [[nodiscard]] auto hit() const -> bool { return hit_; }
+
+    private:
+        friend class object_cache;
+
+        handle(impl* owner, std::shared_ptr<entry> pinned, bool hit);
+        auto release() -> void;
+
+        impl* owner_ = nullptr;
+        std::shared_ptr<entry> entry_;
+        bool hit_ = false;
+    };
+
+    /**
+     * @brief Open (or create) a cache in the configured directory
+     *
+     * Restores entries left by a previous run and removes partial fills.
+     *
+     * @param config Cache configuration
+     * @return Result containing the cache or an error
+     */
+    [[nodiscard]] static auto open(const object_cache_config& config) -> result<object_cache>;
+
+    // Non-copyable, movable
+    object_cache(const object_cache&) = delete;
+    auto operator=(const object_cache&) -> object_cache& = delete;
+    object_cache(object_cache&&) noexcept;
+    auto operator=(object_cache&&) noexcept -> object_cache&;
+    ~object_cache();
+
+    /**
+     * @brief Look up an object, fetching it on a miss
+     *
+     * @param key Object key
+     * @param version Current object version (ETag); a cached entry with a
+     *        different version is discarded
+     * @param fetch Writes the object to a path inside the cache directory
+     * @return Pinned handle, or the fetch error
+     */
+    [[nodiscard]] auto acquire(
+        const std::string& key,
+        std::string_view version,
+        const fetch_function& fetch) -> result<handle>;
+
+    /**
+     * @brief Drop the entry for a key (e.g. after the object was overwritten)
+     * @param key Object key
+     */
+    auto invalidate(const std::string& key) -> void;
+
+    /**
+     * @brief Drop every entry
+     */
+    auto clear() -> void;
+
+    /**
+     * @brief Check whether a key is cached at a version
+     */
+    [[nodiscard]] auto contains(const std::string& key, std::string_view version) const -> bool;
+
+    /**
+     * @brief Get cache counters
+     */
+    [[nodiscard]] auto statistics() const -> object_cache_statistics;
+
+    /**
+     * @brief Reset hit/miss/eviction counters (entry and byte gauges are kept)
+     */
+    auto reset_statistics() -> void;
+
+    /**
+     * @brief Get the configured capacity in bytes
+     */
+    [[nodiscard]] auto capacity() const -> uint64_t;
+
+    /**
+     * @brief Get the cache directory
+     */
+    [[nodiscard]] auto directory() const -> const std::filesystem::path&;
+
+private:
+    explicit object_cache(const object_cache_config& config);
+
+    std::unique_ptr<impl> impl_;
+};
+
+}  // namespace kcenon::file_transfer
+
+#endif  // KCENON_FILE_TRANSFER_SERVER_OBJECT_CACHE_H
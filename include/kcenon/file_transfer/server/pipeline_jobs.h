@@ -7,7 +7,7 @@
  *
  * Job types:
  * - decompress_job: Handles LZ4 decompression of chunks
- * - verify_job: Handles CRC32 checksum verification
+ * - verify_job: Handles chunk checksum verification
  * - write_job: Handles file write operations
  * - read_job: Handles file read operations
  * - compress_job: Handles LZ4 compression of chunks
@@ -17,6 +17,8 @@
 #ifndef KCENON_FILE_TRANSFER_SERVER_PIPELINE_JOBS_H
 #define KCENON_FILE_TRANSFER_SERVER_PIPELINE_JOBS_H
 
+#include "kcenon/file_transfer/core/stream_compression.h"
+#include "kcenon/file_transfer/core/transfer_registry.h"
 #include "kcenon/file_transfer/core/types.h"
 #include "kcenon/file_transfer/server/server_pipeline.h"
 
@@ -28,16 +30,40 @@
 #include <atomic>
 #include <filesystem>
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace kcenon::file_transfer {
 
 // Forward declarations
 class compression_engine;
-class bandwidth_limiter;
+class bandwidth_shaper;
+class chunk_assembler;
 class encryption_interface;
 
+/**
+ * @brief Decompression state of an upload compressed as one stream
+ *
+ * Linked chunks that reach the decompress stage before the chunks they
+ * were compressed against wait here, at most two segments' worth.
+ */
+struct upload_stream {
+    std::mutex mutex;
+    stream_decompressor decoder;
+    std::map<uint64_t, pipeline_chunk> waiting;  ///< chunk_index -> chunk
+
+    explicit upload_stream(const stream_compression_config& config) : decoder(config) {}
+
+    /**
+     * @brief Most chunks allowed to wait at once
+     */
+    [[nodiscard]] auto max_waiting() const noexcept -> std::size_t {
+        return 2 * decoder.config().resync_interval;
+    }
+};
+
 /**
  * @brief Shared context for pipeline jobs
  *
@@ -78,6 +104,9 @@ struct pipeline_context {
     /// Error callback
     error_callback on_error_cb;
 
+    /// Per-chunk error callback (upload stages)
+    chunk_error_callback on_chunk_error_cb;
+
     /// Upload completion callback
     completion_callback on_upload_complete_cb;
 
@@ -90,9 +119,17 @@ struct pipeline_context {
     /// Running flag
     std::atomic<bool>* running = nullptr;
 
-    /// Bandwidth limiters
-    bandwidth_limiter* send_limiter = nullptr;
-    bandwidth_limiter* recv_limiter = nullptr;
+    /// Send-side bandwidth shaper; throttled send jobs park on it
+    bandwidth_shaper* send_shaper = nullptr;
+
+    /// Assembler the write stage stores chunks into (optional)
+    std::shared_ptr<chunk_assembler> assembler;
+
+    /// Uploads decompressed as streams (optional)
+    std::shared_ptr<transfer_registry<upload_stream>> streams;
+
+    /// Decides which integrity checks a chunk still needs and prices skipped ones
+    std::shared_ptr<integrity_policy> integrity;
 
     /**
      * @brief Report an error through the error callback
@@ -105,6 +142,20 @@ struct pipeline_context {
         }
     }
 
+    /**
+     * @brief Report an upload chunk dropped by a failing stage
+     * @param stage The pipeline stage where error occurred
+     * @param chunk The chunk that was dropped
+     * @param message Error message
+     */
+    auto report_chunk_error(pipeline_stage stage, const pipeline_chunk& chunk,
+                            const std::string& message) const -> void {
+        report_error(stage, message);
+        if (on_chunk_error_cb) {
+            on_chunk_error_cb(stage, chunk, message);
+        }
+    }
+
     /**
      * @brief Report stage completion through the callback
      * @param stage The completed pipeline stage
@@ -165,6 +216,9 @@ protected:
  *
  * Decompresses compressed chunks using the compression engine selected
  * by worker_id. On success, passes the decompressed chunk to the verify stage.
+ * Chunks of an upload opened as a stream go through its upload_stream
+ * instead; one job may then hold its chunk back, or pass on others that
+ * were waiting for it.
  */
 class decompress_job : public pipeline_job_base {
 public:
@@ -191,14 +245,21 @@ public:
     [[nodiscard]] auto get_chunk() const -> const pipeline_chunk&;
 
 private:
+    auto decompress_stream(upload_stream& stream) -> kcenon::common::VoidResult;
+    auto restore(upload_stream& stream, pipeline_chunk& chunk) -> result<void>;
+    auto forward(pipeline_chunk& chunk) -> kcenon::common::VoidResult;
+
     pipeline_chunk chunk_;
     std::size_t worker_id_;
 };
 
 /**
- * @brief Job for CRC32 checksum verification
+ * @brief Job for chunk checksum verification
  *
- * Verifies the CRC32 checksum of a chunk's data against the expected value.
+ * Verifies the checksum of a chunk's data against the expected value, with
+ * the algorithm recorded in the chunk. Algorithms this build cannot compute
+ * fail verification. Chunks whose AEAD tag was verified on decryption skip
+ * the checksum; the skipped work is counted in pipeline_stats.
  * On success, passes the verified chunk to the next stage (write).
  */
 class verify_job : public pipeline_job_base {
@@ -229,7 +290,8 @@ private:
 /**
  * @brief Job for file write operations
  *
- * Writes chunk data to disk. This is the final stage of the upload pipeline.
+ * Writes chunk data to disk through the context's chunk_assembler, when
+ * one is attached. This is the final stage of the upload pipeline.
  */
 class write_job : public pipeline_job_base {
 public:
@@ -272,13 +334,17 @@ public:
      * @param file_path Path to source file
      * @param offset Byte offset in file
      * @param size Number of bytes to read
+     * @param client Client the chunk is sent to
+     * @param integrity Checksum algorithm of the chunk
      */
     read_job(std::shared_ptr<pipeline_context> context,
              const transfer_id& id,
              uint64_t chunk_index,
              std::filesystem::path file_path,
              uint64_t offset,
-             std::size_t size);
+             std::size_t size,
+             client_id client = client_id{},
+             chunk_integrity integrity = chunk_integrity::crc32);
 
     /**
      * @brief Execute the read work
@@ -298,6 +364,8 @@ private:
     std::filesystem::path file_path_;
     uint64_t offset_;
     std::size_t size_;
+    client_id client_;
+    chunk_integrity integrity_;
     pipeline_chunk chunk_;
 };
 
@@ -341,7 +409,9 @@ private:
  * @brief Job for network send preparation
  *
  * Prepares chunks for network transmission. This is the final stage
- * of the download pipeline. Applies bandwidth limiting if configured.
+ * of the download pipeline. Applies send shaping if configured: a chunk
+ * that has to wait for tokens is parked and comes back as a new send job,
+ * so the worker is not held while it waits.
  */
 class send_job : public pipeline_job_base {
 public:
@@ -349,8 +419,10 @@ public:
      * @brief Construct a send job
      * @param chunk Chunk to send
      * @param context Shared pipeline context
+     * @param shaped Whether the chunk's send tokens are already taken
      */
-    send_job(pipeline_chunk chunk, std::shared_ptr<pipeline_context> context);
+    send_job(pipeline_chunk chunk, std::shared_ptr<pipeline_context> context,
+             bool shaped = false);
 
     /**
      * @brief Execute the send preparation work
@@ -366,6 +438,7 @@ public:
 
 private:
     pipeline_chunk chunk_;
+    bool shaped_;
 };
 
 /**
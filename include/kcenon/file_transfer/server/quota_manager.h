@@ -28,6 +28,7 @@ struct quota_usage {
     uint64_t total_quota = 0;
     uint64_t used_bytes = 0;
     uint64_t available_bytes = 0;
+    uint64_t reserved_bytes = 0;  // Bytes reserved by in-flight uploads
     double usage_percent = 0.0;
     std::size_t file_count = 0;
 
@@ -49,6 +50,17 @@ struct quota_usage {
     }
 };
 
+/**
+ * @brief Bytes reserved against the quota for an in-flight upload
+ *
+ * Obtained from quota_manager::reserve() and handed back exactly once to
+ * either commit_reservation() or release_reservation().
+ */
+struct quota_reservation {
+    uint64_t tenant = 0;  // Tenant (e.g. client id) owning the reservation
+    uint64_t bytes = 0;   // Reserved bytes
+};
+
 /**
  * @brief Warning threshold configuration
  */
@@ -133,11 +145,70 @@ public:
 
     /**
      * @brief Check if storage can accommodate required bytes
+     *
+     * Accounts for outstanding reservations. This is advisory only; use
+     * reserve() to actually claim the space.
+     *
      * @param required_bytes Number of bytes to store
      * @return Result<void> on success, error if quota would be exceeded
      */
     [[nodiscard]] auto check_quota(uint64_t required_bytes) -> result<void>;
 
+    /**
+     * @brief Reserve quota for an upload
+     *
+     * Admission is decided by a lock-free compare-and-swap on the reserved
+     * byte counter against used + reserved, so concurrent uploads can never
+     * overshoot the quota together. The reservation must be committed when the
+     * upload completes or released when it is cancelled.
+     *
+     * @param bytes Number of bytes to reserve
+     * @param tenant Tenant owning the reservation (e.g. client id)
+     * @return Reservation handle, or quota_exceeded error
+     */
+    [[nodiscard]] auto reserve(uint64_t bytes, uint64_t tenant = 0)
+        -> result<quota_reservation>;
+
+    /**
+     * @brief Commit a reservation for a stored file
+     *
+     * Records the stored file in the usage index and then drops the
+     * reservation, so used + reserved never transiently under-counts.
+     *
+     * @param reservation Reservation returned by reserve()
+     * @param stored_path Path of the stored file
+     * @param actual_bytes Actual size of the stored file
+     */
+    auto commit_reservation(
+        const quota_reservation& reservation,
+        const std::filesystem::path& stored_path,
+        uint64_t actual_bytes) -> void;
+
+    /**
+     * @brief Release a reservation without storing anything
+     * @param reservation Reservation returned by reserve()
+     */
+    auto release_reservation(const quota_reservation& reservation) -> void;
+
+    /**
+     * @brief Get total bytes currently reserved
+     * @return Reserved bytes across all tenants
+     */
+    [[nodiscard]] auto get_reserved_bytes() const -> uint64_t;
+
+    /**
+     * @brief Get bytes currently reserved by a tenant
+     * @param tenant Tenant identifier
+     * @return Reserved bytes for the tenant
+     */
+    [[nodiscard]] auto get_reserved_bytes(uint64_t tenant) const -> uint64_t;
+
+    /**
+     * @brief Limit the bytes a single tenant may have reserved at once
+     * @param bytes Maximum reserved bytes per tenant (0 = unlimited)
+     */
+    auto set_tenant_reservation_limit(uint64_t bytes) -> void;
+
     /**
      * @brief Check if a file size is within limits
      * @param file_size Size of the file in bytes
@@ -158,13 +229,38 @@ public:
     [[nodiscard]] auto get_usage() const -> quota_usage;
 
     /**
-     * @brief Refresh usage statistics from filesystem
+     * @brief Refresh usage statistics
      *
-     * Scans the storage directory and updates usage statistics.
-     * This is called automatically but can be triggered manually.
+     * Usage is maintained incrementally by an in-memory file index. The
+     * storage directory is only rescanned when drift is detected, i.e.
+     * when the directory was modified by something other than this manager.
+     * Drift is judged by the directory's modification time alone, so a file
+     * created or removed behind its back is noticed but one rewritten in
+     * place is not.
      */
     auto refresh_usage() -> void;
 
+    /**
+     * @brief Rebuild the usage index with a full directory scan
+     *
+     * Normally not needed; refresh_usage() rescans automatically on drift.
+     * Call it after files were modified in place by another process. The
+     * assembler's temporary files are skipped, as their bytes are already
+     * held by reservations.
+     */
+    auto rebuild_index() -> void;
+
+    /**
+     * @brief Persist the usage index snapshot
+     *
+     * The snapshot is stored under the storage directory and reloaded by
+     * create() so that startup does not require a full scan. It is also
+     * written when the manager is destroyed.
+     *
+     * @return Result<void> on success, error if the snapshot cannot be written
+     */
+    auto save_index_snapshot() -> result<void>;
+
     /**
      * @brief Record bytes being added to storage
      * @param bytes Number of bytes added
@@ -187,6 +283,24 @@ public:
      */
     auto record_file_removed() -> void;
 
+    /**
+     * @brief Record a file stored in the storage directory
+     *
+     * Adds the file to the usage index (replacing any previous entry with the
+     * same name) and updates byte and file counts. The server calls this,
+     * or commit_reservation(), when it commits an upload.
+     *
+     * @param path Path of the stored file
+     * @param size File size in bytes
+     */
+    auto record_file_stored(const std::filesystem::path& path, uint64_t size) -> void;
+
+    /**
+     * @brief Record a file deleted from the storage directory
+     * @param path Path of the deleted file
+     */
+    auto record_file_deleted(const std::filesystem::path& path) -> void;
+
     // Warning thresholds
 
     /**
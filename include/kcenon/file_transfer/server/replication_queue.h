@@ -0,0 +1,181 @@
+/**
+ * @file replication_queue.h
+ * @brief Durable write-behind replication queue for hybrid storage
+ */
+
+#ifndef KCENON_FILE_TRANSFER_SERVER_REPLICATION_QUEUE_H
+#define KCENON_FILE_TRANSFER_SERVER_REPLICATION_QUEUE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "kcenon/file_transfer/core/types.h"
+
+namespace kcenon::file_transfer {
+
+/**
+ * @brief Replication operation
+ */
+enum class replication_op : uint8_t {
+    put = 1,     ///< Copy the object to the replica
+    remove = 2   ///< Delete the object from the replica
+};
+
+/**
+ * @brief A pending change to replicate
+ */
+struct replication_request {
+    /// Object key
+    std::string key;
+
+    /// Operation
+    replication_op op = replication_op::put;
+
+    /// Cloud storage class for puts (empty = backend default)
+    std::string storage_class;
+
+    /// Content type for puts (empty = unspecified)
+    std::string content_type;
+};
+
+/**
+ * @brief Replication queue configuration
+ */
+struct replication_queue_config {
+    /// Directory holding the journal
+    std::filesystem::path journal_directory;
+
+    /// Batches replicated concurrently
+    std::size_t max_concurrency = 4;
+
+    /// Maximum requests handled by one batch
+    std::size_t batch_size = 16;
+
+    /// Attempts per request before it is dropped and reported as failed
+    std::size_t max_attempts = 8;
+
+    /// Delay before the first retry (doubles per attempt)
+    std::chrono::milliseconds initial_retry_delay{500};
+
+    /// Upper bound of the retry delay
+    std::chrono::milliseconds max_retry_delay{60000};
+};
+
+/**
+ * @brief Replication queue counters
+ */
+struct replication_statistics {
+    std::size_t pending = 0;          ///< Keys waiting for (or in) replication
+    std::size_t in_flight = 0;        ///< Keys currently being replicated
+    uint64_t enqueued = 0;            ///< Requests accepted
+    uint64_t coalesced = 0;           ///< Requests merged into a pending one for the same key
+    uint64_t replicated = 0;          ///< Requests applied to the replica
+    uint64_t retries = 0;             ///< Failed attempts scheduled for retry
+    uint64_t failed = 0;              ///< Requests dropped after max_attempts
+    std::chrono::milliseconds lag{0}; ///< Age of the oldest pending change
+};
+
+/**
+ * @brief Durable, batching write-behind replication queue
+ *
+ * Requests are appended to a journal on local disk before enqueue()
+ * returns, so pending replicas survive a restart: open() replays the
+ * journal and resumes them. Requests for the same key are coalesced; the
+ * latest one wins, and a key re-enqueued while it is being replicated is
+ * replicated again afterwards.
+ *
+ * Pending keys are replicated in batches by up to max_concurrency workers.
+ * A failed request is retried with exponential backoff; after max_attempts
+ * it is dropped from the journal and passed to the failure callback.
+ *
+ * @code
+ * auto queue = replication_queue::open(config, [&](const replication_request& req) {
+ *     return req.op == replication_op::put ? copy_to_cloud(req.key)
+ *                                          : delete_from_cloud(req.key);
+ * });
+ * if (queue.has_value()) {
+ *     queue.value().enqueue({"reports/q3.pdf", replication_op::put});
+ * }
+ * @endcode
+ */
+class replication_queue {
+public:
+    /// Applies one request to the replica
+    using replicate_function = std::function<result<void>(const replication_request&)>;
+
+    /// Called with requests dropped after max_attempts
+    using failure_callback = std::function<void(const replication_request&, const error&)>;
+
+    /**
+     * @brief Open (or create) a queue and resume journaled requests
+     * @param config Queue configuration
+     * @param replicate Applies a request to the replica (called on worker threads)
+     * @param on_failure Optional callback for requests that exhausted their attempts
+     * @return Result containing the queue or an error
+     */
+    [[nodiscard]] static auto open(
+        const replication_queue_config& config,
+        replicate_function replicate,
+        failure_callback on_failure = {}) -> result<replication_queue>;
+
+    // Non-copyable, movable
+    replication_queue(const replication_queue&) = delete;
+    auto operator=(const replication_queue&) -> replication_queue& = delete;
+    replication_queue(replication_queue&&) noexcept;
+    auto operator=(replication_queue&&) noexcept -> replication_queue&;
+    ~replication_queue();
+
+    /**
+     * @brief Journal a request and schedule it
+     * @param request Change to replicate
+     * @return Result<void> once the request is durable, error if the journal
+     *         cannot be written (the caller should replicate inline)
+     */
+    auto enqueue(const replication_request& request) -> result<void>;
+
+    /**
+     * @brief Get the pending operation for a key
+     *
+     * While a key is pending the replica may be stale or still hold a
+     * deleted object, so it must not serve reads for that key.
+     *
+     * @param key Object key
+     * @return Pending operation, or std::nullopt if the replica is current
+     */
+    [[nodiscard]] auto pending(const std::string& key) const -> std::optional<replication_op>;
+
+    /**
+     * @brief Wait until no request is pending
+     * @param timeout Maximum time to wait
+     * @return true if the queue drained, false on timeout
+     */
+    auto drain(std::chrono::milliseconds timeout) -> bool;
+
+    /**
+     * @brief Stop replicating; journaled requests resume on the next open()
+     *
+     * Waits for batches that are already running.
+     */
+    auto close() -> void;
+
+    /**
+     * @brief Get queue counters
+     */
+    [[nodiscard]] auto statistics() const -> replication_statistics;
+
+private:
+    explicit replication_queue(const replication_queue_config& config);
+
+    struct impl;
+    std::unique_ptr<impl> impl_;
+};
+
+}  // namespace kcenon::file_transfer
+
+#endif  // KCENON_FILE_TRANSFER_SERVER_REPLICATION_QUEUE_H
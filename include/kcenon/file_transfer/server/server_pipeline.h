@@ -19,13 +19,21 @@
 #include <functional>
 #include <memory>
 #include <thread>
+#include <vector>
 
+#include "kcenon/file_transfer/core/bandwidth_shaper.h"
 #include "kcenon/file_transfer/core/chunk_types.h"
+#include "kcenon/file_transfer/core/integrity_policy.h"
+#include "kcenon/file_transfer/core/stream_compression.h"
 #include "kcenon/file_transfer/core/types.h"
 #include "kcenon/file_transfer/encryption/encryption_config.h"
+#include "kcenon/file_transfer/server/flow_scheduler.h"
+#include "kcenon/file_transfer/server/server_types.h"
 
 namespace kcenon::file_transfer {
 
+class chunk_assembler;
+
 /**
  * @brief Pipeline processing stages
  */
@@ -68,9 +76,12 @@ struct pipeline_config {
     std::size_t network_workers = 2;       ///< Number of network worker threads
     std::size_t encryption_workers = 2;    ///< Number of encryption worker threads
     std::size_t queue_size = 64;           ///< Maximum queue size per stage
-    std::size_t max_memory_per_transfer = 32 * 1024 * 1024;  ///< ~32MB per transfer
+    std::size_t dispatch_limit = 0;        ///< Upload chunks inside the stages at once (0 = 2 per worker)
+    std::size_t scheduler_quantum = 64 * 1024;   ///< Bytes per round for a client of weight 1
+    std::size_t max_memory_per_transfer = 32 * 1024 * 1024;  ///< Upload chunk bytes in flight per flow
 
-    // Bandwidth limiting (0 = unlimited)
+    // Bandwidth limiting (0 = unlimited); per-client and per-transfer
+    // limits nest under these through set_client_*_limits()
     std::size_t send_bandwidth_limit = 0;  ///< Max bytes/sec for network send (0 = unlimited)
     std::size_t recv_bandwidth_limit = 0;  ///< Max bytes/sec for network recv (0 = unlimited)
 
@@ -105,6 +116,12 @@ struct pipeline_stats {
     std::atomic<uint64_t> chunks_decrypted{0};
     std::atomic<uint64_t> encryption_bytes{0};
 
+    // Integrity statistics
+    std::atomic<uint64_t> checksums_verified{0};       ///< Chunk checksums computed
+    std::atomic<uint64_t> checksums_skipped{0};        ///< Covered by an AEAD tag instead
+    std::atomic<uint64_t> checksum_bytes_skipped{0};   ///< Bytes those would have read
+    std::atomic<uint64_t> integrity_cpu_saved_ns{0};   ///< Estimated CPU time not spent
+
     /**
      * @brief Reset all statistics
      */
@@ -116,16 +133,29 @@ struct pipeline_stats {
  */
 struct pipeline_chunk {
     transfer_id id;
+    client_id client;   ///< Owner of the transfer, for fair scheduling
     uint64_t chunk_index;
+    uint64_t chunk_offset = 0;
     std::vector<std::byte> data;
-    uint32_t checksum;
+    uint64_t checksum;  ///< Digest of the uncompressed data, zero-extended for 32-bit algorithms
+    chunk_integrity integrity = chunk_integrity::crc32;  ///< Algorithm of checksum
     bool is_compressed;
     std::size_t original_size;
+    chunk_flags flags = chunk_flags::none;  ///< Wire flags; zero_range chunks have no data
+    /// Order-0 entropy of data in bits per byte, measured by the read stage; negative if unknown
+    double entropy = -1.0;
 
     // Encryption state
     bool is_encrypted = false;
     std::unique_ptr<encryption_metadata> enc_metadata;
 
+    /// Integrity checks the chunk has passed, so later stages skip them
+    integrity_check verified = integrity_check::none;
+
+    /// Upload window slot, released when the chunk leaves the pipeline.
+    /// Set by the pipeline on submission; copies do not share it.
+    std::shared_ptr<void> upload_slot;
+
     pipeline_chunk() = default;
     explicit pipeline_chunk(const chunk& c);
 
@@ -156,6 +186,8 @@ struct stage_result {
 using stage_callback = std::function<void(pipeline_stage, const pipeline_chunk&)>;
 using error_callback = std::function<void(pipeline_stage, const std::string&)>;
 using completion_callback = std::function<void(const transfer_id&, uint64_t bytes)>;
+using chunk_error_callback =
+    std::function<void(pipeline_stage, const pipeline_chunk&, const std::string&)>;
 
 /**
  * @brief Server-side upload/download pipeline
@@ -164,6 +196,24 @@ using completion_callback = std::function<void(const transfer_id&, uint64_t byte
  * multiple worker threads for each stage. Supports backpressure control
  * through bounded queues.
  *
+ * Each upload flow (one transfer of one client) may have at most
+ * queue_size chunks, holding at most max_memory_per_transfer bytes, in
+ * flight between submission and the write stage. A compressed chunk counts
+ * at its original size. A flow with nothing in flight always takes one
+ * chunk, however large.
+ * The non-blocking submit calls fail once a flow's window is full; the
+ * timed overload waits for a slot, which lets a network receive handler
+ * stop reading from its socket until the pipeline drains.
+ *
+ * Admitted chunks wait in a flow_scheduler and enter the stages at most
+ * dispatch_limit at a time, in weighted deficit round-robin order across
+ * clients and strict order across priority classes. A bulk upload keeps
+ * only its fair share of the stages busy, so small transfers from other
+ * clients are not queued behind it.
+ *
+ * With a chunk_assembler attached, the write stage stores each verified
+ * chunk at its offset in the assembler's session for the transfer.
+ *
  * @example
  * @code
  * auto config = pipeline_config::auto_detect();
@@ -231,11 +281,125 @@ public:
 
     /**
      * @brief Try to submit a chunk without blocking
+     *
+     * A chunk held back by recv shaping is accepted and parked until its
+     * bytes are granted.
+     *
      * @param data Chunk data to process
      * @return true if submitted, false if queue is full
      */
     [[nodiscard]] auto try_submit_upload_chunk(pipeline_chunk data) -> bool;
 
+    /**
+     * @brief Submit a chunk if its flow has room, keeping it otherwise
+     *
+     * Unlike try_submit_upload_chunk(), a chunk that is not accepted stays
+     * with the caller, which can hold it until on_upload_capacity() fires.
+     *
+     * @param data Chunk data; moved from only when submitted
+     * @return true if submitted, false if the flow's window is full
+     */
+    [[nodiscard]] auto offer_upload_chunk(pipeline_chunk& data) -> bool;
+
+    /**
+     * @brief Set callback for upload window slots freeing up
+     *
+     * Invoked on the thread that finished the chunk, usually a pipeline
+     * worker, and never once the pipeline is stopping. It must not block.
+     *
+     * @param callback Function to call after a chunk leaves the window
+     */
+    auto on_upload_capacity(std::function<void()> callback) -> void;
+
+    /**
+     * @brief Submit a chunk, waiting for room in the upload window
+     * @param data Chunk data to process
+     * @param timeout Longest time to wait for a slot
+     * @return Success, or queue_full if no slot freed up within timeout
+     */
+    [[nodiscard]] auto submit_upload_chunk(pipeline_chunk data,
+                                           std::chrono::milliseconds timeout) -> result<void>;
+
+    /**
+     * @brief Number of upload chunks submitted but not yet written or failed
+     */
+    [[nodiscard]] auto upload_in_flight() const -> std::size_t;
+
+    /**
+     * @brief Set a client's share of the upload stages
+     * @param client Client
+     * @param weight Relative weight within its priority class (default 1)
+     */
+    auto set_client_weight(client_id client, uint32_t weight) -> void;
+
+    /**
+     * @brief Set the scheduling class of an upload transfer
+     * @param id Transfer ID
+     * @param priority Priority class (default normal)
+     */
+    auto set_transfer_priority(const transfer_id& id, flow_priority priority) -> void;
+
+    /**
+     * @brief Forget a finished or cancelled transfer's scheduling state
+     *
+     * Chunks of the transfer still waiting for the stages are dropped.
+     *
+     * @param id Transfer ID
+     */
+    auto close_transfer(const transfer_id& id) -> void;
+
+    /**
+     * @brief Decompress an upload's chunks as one stream
+     *
+     * For uploads agreed with wire_compression_mode::lz4_stream; call
+     * before submitting the first chunk. A linked chunk is held in the
+     * decompress stage until the chunks it was compressed against have
+     * been decompressed.
+     *
+     * @param id Transfer ID
+     * @param config Stream layout of the sender
+     */
+    auto open_stream(const transfer_id& id, const stream_compression_config& config = {})
+        -> void;
+
+    /**
+     * @brief Stop decompressing an upload as a stream
+     *
+     * Chunks still held for their history are failed through the chunk
+     * error callback. close_transfer() does this as well.
+     *
+     * @param id Transfer ID
+     */
+    auto close_stream(const transfer_id& id) -> void;
+
+    /**
+     * @brief Give an upload stream a chunk rebuilt outside the stages
+     *
+     * A chunk rebuilt from FEC parity never passes the decompress stage, so
+     * its data becomes history here. Chunks that were waiting for it are
+     * queued for decompression again. No-op if the upload is not a stream.
+     *
+     * @param id Transfer ID
+     * @param rebuilt Rebuilt chunk with its uncompressed data
+     */
+    auto record_rebuilt_chunk(const transfer_id& id, const chunk& rebuilt) -> void;
+
+    /**
+     * @brief Per-flow queue depth, dispatch counts and wait histograms
+     * @return Statistics of flows not yet closed
+     */
+    [[nodiscard]] auto flow_statistics() const -> std::vector<flow_stats>;
+
+    /**
+     * @brief Write verified upload chunks through an assembler
+     *
+     * Call before start(). Sessions must be started on the assembler before
+     * their chunks reach the write stage; chunks of unknown transfers fail.
+     *
+     * @param assembler Assembler receiving chunks (nullptr to detach)
+     */
+    auto set_chunk_assembler(std::shared_ptr<chunk_assembler> assembler) -> void;
+
     // Download pipeline operations
 
     /**
@@ -248,6 +412,8 @@ public:
      * @param file_path Path to source file
      * @param offset Byte offset in file
      * @param size Chunk size
+     * @param client Client receiving the chunk, for per-client send shaping
+     * @param integrity Chunk checksum algorithm negotiated with the client
      * @return Result indicating success or backpressure
      */
     [[nodiscard]] auto submit_download_request(
@@ -255,7 +421,9 @@ public:
         uint64_t chunk_index,
         const std::filesystem::path& file_path,
         uint64_t offset,
-        std::size_t size) -> result<void>;
+        std::size_t size,
+        client_id client = client_id{},
+        chunk_integrity integrity = chunk_integrity::crc32) -> result<void>;
 
     // Callbacks
 
@@ -269,6 +437,14 @@ public:
      */
     auto on_error(error_callback callback) -> void;
 
+    /**
+     * @brief Set callback for upload chunks dropped by a failing stage
+     *
+     * Invoked in addition to on_error, with the chunk that failed, so the
+     * owner of the transfer can request a retransmission.
+     */
+    auto on_chunk_error(chunk_error_callback callback) -> void;
+
     /**
      * @brief Set callback for upload completion (chunk written to disk)
      */
@@ -331,6 +507,52 @@ public:
      */
     [[nodiscard]] auto get_recv_bandwidth_limit() const -> std::size_t;
 
+    /**
+     * @brief Set a client's guaranteed and maximum send rate
+     *
+     * Limits nest under the global send limit: a client may exceed its
+     * guaranteed rate up to its ceiling while other clients leave room.
+     *
+     * @param client Client
+     * @param limits Rates in bytes/sec
+     */
+    auto set_client_send_limits(client_id client, shaper_limits limits) -> void;
+
+    /**
+     * @brief Set a client's guaranteed and maximum recv rate
+     * @param client Client
+     * @param limits Rates in bytes/sec
+     */
+    auto set_client_recv_limits(client_id client, shaper_limits limits) -> void;
+
+    /**
+     * @brief Set a transfer's send rates, nested under its client's
+     * @param client Client owning the transfer
+     * @param id Transfer ID
+     * @param limits Rates in bytes/sec
+     */
+    auto set_transfer_send_limits(client_id client, const transfer_id& id,
+                                  shaper_limits limits) -> void;
+
+    /**
+     * @brief Set a transfer's recv rates, nested under its client's
+     * @param client Client owning the transfer
+     * @param id Transfer ID
+     * @param limits Rates in bytes/sec
+     */
+    auto set_transfer_recv_limits(client_id client, const transfer_id& id,
+                                  shaper_limits limits) -> void;
+
+    /**
+     * @brief Grant, borrow and parking counters of send shaping
+     */
+    [[nodiscard]] auto send_shaping_stats() const -> shaper_stats;
+
+    /**
+     * @brief Grant, borrow and parking counters of recv shaping
+     */
+    [[nodiscard]] auto recv_shaping_stats() const -> shaper_stats;
+
 private:
     explicit server_pipeline(pipeline_config config);
 
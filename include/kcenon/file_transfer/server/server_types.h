@@ -118,6 +118,11 @@ struct cloud_storage_server_config {
     /// Enable write replication to cloud
     bool replicate_writes = true;
 
+    /// Replicate to cloud in the background (hybrid mode). Uploads complete
+    /// once stored locally; pending replicas are journaled under the
+    /// storage directory and resume after a restart.
+    bool async_replication = true;
+
     /// Enable read fallback from cloud
     bool fallback_reads = true;
 
@@ -140,6 +145,7 @@ struct server_config {
     uint64_t max_file_size = 10ULL * 1024 * 1024 * 1024;      // 10GB
     uint64_t storage_quota = 100ULL * 1024 * 1024 * 1024;     // 100GB
     std::size_t chunk_size = 256 * 1024;                       // 256KB
+    std::size_t max_chunk_size = 16 * 1024 * 1024;             // 16MB, variable-size uploads
 
     // Encryption settings
     bool enable_encryption = false;        ///< Allow encrypted transfers
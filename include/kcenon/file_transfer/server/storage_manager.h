@@ -19,6 +19,8 @@
 
 #include "kcenon/file_transfer/cloud/cloud_storage_interface.h"
 #include "kcenon/file_transfer/core/types.h"
+#include "kcenon/file_transfer/server/replication_queue.h"
+#include "kcenon/file_transfer/server/stream_copy.h"
 
 namespace kcenon::file_transfer {
 
@@ -154,6 +156,15 @@ struct retrieve_options {
     std::optional<std::string> expected_hash;
 };
 
+/**
+ * @brief Sort field for list operations
+ */
+enum class storage_sort_field {
+    key,            ///< Lexicographic key order
+    size,           ///< Object size
+    last_modified   ///< Last modified timestamp
+};
+
 /**
  * @brief List operation options
  */
@@ -172,6 +183,12 @@ struct list_storage_options {
 
     /// Continuation token for pagination
     std::optional<std::string> continuation_token;
+
+    /// Field to sort results by (ties are broken by key)
+    storage_sort_field sort_by = storage_sort_field::key;
+
+    /// Sort in descending order
+    bool descending = false;
 };
 
 /**
@@ -296,6 +313,30 @@ struct storage_manager_statistics {
 
     /// Tier operations count
     uint64_t tier_change_count = 0;
+
+    /// Cloud reads served from the local read cache
+    uint64_t cache_hits = 0;
+
+    /// Cloud reads that had to fetch from the backend
+    uint64_t cache_misses = 0;
+
+    /// Cache entries evicted to stay within max_cache_size
+    uint64_t cache_evictions = 0;
+
+    /// Bytes currently held in the read cache
+    uint64_t cache_bytes = 0;
+
+    /// Keys waiting for write-behind replication to the secondary backend
+    uint64_t replication_pending = 0;
+
+    /// Age of the oldest change not yet replicated
+    std::chrono::milliseconds replication_lag{0};
+
+    /// Changes replicated by the write-behind queue
+    uint64_t replicated_count = 0;
+
+    /// Changes dropped by the write-behind queue after exhausting retries
+    uint64_t replication_failures = 0;
 };
 
 /**
@@ -470,6 +511,10 @@ protected:
 
 /**
  * @brief Local filesystem storage backend
+ *
+ * Object metadata is kept in a persistent metadata_index under
+ * base_path/.file_trans_index once connected, so list() and get_metadata()
+ * do not walk or stat the directory tree.
  */
 class local_storage_backend : public storage_backend {
 public:
@@ -549,6 +594,17 @@ public:
      */
     [[nodiscard]] auto full_path(const std::string& key) const -> std::filesystem::path;
 
+    /**
+     * @brief Rebuild the metadata index from the files under base path
+     *
+     * The index is kept up to date by store/remove and rebuilt automatically
+     * on connect() after an unclean shutdown. Call this after files were
+     * changed behind the backend's back.
+     *
+     * @return Number of indexed files, or an error if not connected
+     */
+    auto rebuild_index() -> result<std::size_t>;
+
 private:
     explicit local_storage_backend(const std::filesystem::path& base_path);
 
@@ -574,6 +630,17 @@ public:
         storage_backend_type backend_type = storage_backend_type::cloud_s3)
         -> std::unique_ptr<cloud_storage_backend>;
 
+    /**
+     * @brief Create cloud storage backend over a shared storage instance
+     * @param storage Cloud storage interface instance
+     * @param backend_type Backend type
+     * @return Backend instance or nullptr
+     */
+    [[nodiscard]] static auto create(
+        std::shared_ptr<cloud_storage_interface> storage,
+        storage_backend_type backend_type = storage_backend_type::cloud_s3)
+        -> std::unique_ptr<cloud_storage_backend>;
+
     ~cloud_storage_backend();
     cloud_storage_backend(cloud_storage_backend&&) noexcept;
     auto operator=(cloud_storage_backend&&) noexcept -> cloud_storage_backend&;
@@ -640,7 +707,7 @@ public:
 
 private:
     cloud_storage_backend(
-        std::unique_ptr<cloud_storage_interface> storage,
+        std::shared_ptr<cloud_storage_interface> storage,
         storage_backend_type backend_type);
 
     struct impl;
@@ -666,10 +733,21 @@ struct storage_manager_config {
     /// Replicate writes to secondary
     bool replicate_writes = false;
 
-    /// Local cache for cloud objects
+    /// Replicate writes in the background instead of before store() returns.
+    /// Writes are acknowledged once the primary has them; pending changes
+    /// are journaled and survive a restart. While a key is pending the
+    /// secondary does not serve fallback reads for it.
+    bool async_replication = false;
+
+    /// Write-behind queue settings. An empty journal_directory defaults to
+    /// <primary base path>/.file_trans_replication for a local primary.
+    replication_queue_config write_behind;
+
+    /// Local read cache for cloud objects (disabled when unset).
+    /// Cached copies are revalidated against the object's ETag on every read.
     std::optional<std::filesystem::path> cache_directory;
 
-    /// Maximum cache size in bytes
+    /// Maximum cache size in bytes; larger objects bypass the cache
     uint64_t max_cache_size = 1ULL * 1024 * 1024 * 1024;  // 1GB
 
     /// Enable access tracking for auto-tiering
@@ -849,25 +927,39 @@ public:
 
     /**
      * @brief Change object storage tier
+     *
+     * The object is rewritten with the tier's storage class by streaming it
+     * through a bounded buffer ring (see stream_copy()), so memory use does
+     * not grow with the object size. On a local backend only the recorded
+     * tier changes.
+     *
      * @param key Object key
      * @param target_tier Target storage tier
+     * @param copy_options Buffer ring and bandwidth budget for the rewrite
      * @return Success or error
      */
     [[nodiscard]] auto change_tier(
         const std::string& key,
-        storage_tier target_tier) -> result<void>;
+        storage_tier target_tier,
+        const stream_copy_options& copy_options = {}) -> result<void>;
 
     /**
      * @brief Copy object between backends
+     *
+     * Streams the object through a bounded buffer ring; cloud destinations
+     * receive it as a multipart upload with parallel parts.
+     *
      * @param key Object key
      * @param source Source backend
      * @param destination Destination backend
+     * @param copy_options Buffer ring and bandwidth budget for the copy
      * @return Success or error
      */
     [[nodiscard]] auto copy_between_backends(
         const std::string& key,
         storage_backend_type source,
-        storage_backend_type destination) -> result<void>;
+        storage_backend_type destination,
+        const stream_copy_options& copy_options = {}) -> result<void>;
 
     // ========================================================================
     // Statistics and Configuration
@@ -914,6 +1006,17 @@ public:
      */
     void on_error(std::function<void(const std::string& key, const error&)> callback);
 
+    /**
+     * @brief Set object event callback
+     *
+     * Called after each successful store, store_file, change_tier (reported
+     * as storage_operation::store) and remove, and after each successful
+     * retrieve and retrieve_file when track_access is set. storage_policy
+     * uses it to re-evaluate only the objects that changed.
+     */
+    void on_object_event(
+        std::function<void(storage_operation operation, const std::string& key)> callback);
+
 private:
     explicit storage_manager(const storage_manager_config& config);
 
@@ -79,6 +79,10 @@ struct access_pattern_config {
 
     /// Minimum time in tier before eligible for demotion
     std::chrono::hours min_time_in_tier{24};  // 24 hours
+
+    /// Counters per row of the access-count sketch (see access_sketch).
+    /// Counts are approximate and never low; a wider sketch overcounts less.
+    std::size_t sketch_width = 16384;
 };
 
 /**
@@ -315,6 +319,26 @@ public:
          */
         auto with_dry_run(bool enable) -> builder&;
 
+        /**
+         * @brief Run up to max_actions pending actions at once
+         * @param max_actions Concurrent actions in execute_pending() (default: 1)
+         */
+        auto with_max_concurrent_actions(std::size_t max_actions) -> builder&;
+
+        /**
+         * @brief Cap the bandwidth of all tier moves together
+         * @param bytes_per_second Budget shared by concurrent moves (0 = unlimited)
+         */
+        auto with_bandwidth_limit(std::size_t bytes_per_second) -> builder&;
+
+        /**
+         * @brief Split the incremental evaluation index into shards
+         * @param shards Shards evaluated in parallel by evaluate_incremental()
+         *               (default: 16). Keys are assigned by their first path
+         *               component.
+         */
+        auto with_evaluation_shards(std::size_t shards) -> builder&;
+
         /**
          * @brief Build the storage policy
          */
@@ -334,6 +358,11 @@ public:
 
     /**
      * @brief Attach to a storage manager
+     *
+     * Registers the policy's object event callback on the manager (see
+     * storage_manager::on_object_event()), replacing any other, and resets
+     * the incremental evaluation index.
+     *
      * @param manager Storage manager to manage
      */
     void attach(storage_manager& manager);
@@ -374,6 +403,26 @@ public:
     [[nodiscard]] auto evaluate_prefix(
         const std::string& prefix) -> result<std::vector<policy_evaluation_result>>;
 
+    /**
+     * @brief Evaluate only objects whose result could have changed
+     *
+     * The first call lists every object into an in-memory index. Later
+     * calls evaluate:
+     * - objects stored, re-tiered or (for access-pattern rules) read since
+     *   the previous call, as reported by the storage manager;
+     * - objects whose age has just crossed a rule or built-in age threshold,
+     *   taken from a schedule ordered by that time;
+     * - objects whose windowed access count dropped at a window boundary.
+     *
+     * Removed objects leave the index. Changing rules or the retention
+     * policy makes the next call re-evaluate every indexed object once,
+     * without listing. Index shards are evaluated in parallel; callbacks
+     * run on the calling thread.
+     *
+     * @return Results for the objects evaluated by this call
+     */
+    [[nodiscard]] auto evaluate_incremental() -> result<std::vector<policy_evaluation_result>>;
+
     // ========================================================================
     // Execution Operations
     // ========================================================================
@@ -387,6 +436,10 @@ public:
 
     /**
      * @brief Execute all pending tiering actions
+     *
+     * Up to the configured number of actions run concurrently; their data
+     * movement shares the configured bandwidth budget.
+     *
      * @return Number of actions executed
      */
     [[nodiscard]] auto execute_pending() -> result<std::size_t>;
@@ -0,0 +1,79 @@
+/**
+ * @file stream_copy.h
+ * @brief Bounded-memory streaming copy between storage backends
+ */
+
+#ifndef KCENON_FILE_TRANSFER_SERVER_STREAM_COPY_H
+#define KCENON_FILE_TRANSFER_SERVER_STREAM_COPY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+
+#include "kcenon/file_transfer/core/types.h"
+
+namespace kcenon::file_transfer {
+
+class bandwidth_limiter;
+
+/**
+ * @brief Streaming copy options
+ */
+struct stream_copy_options {
+    /// Size of each ring buffer. Cloud sinks cut multipart parts from
+    /// these writes, so a multiple of the part size avoids re-buffering.
+    std::size_t buffer_size = 8 * 1024 * 1024;  // 8MB
+
+    /// Buffers in the ring; memory per copy is buffer_size * buffer_count
+    std::size_t buffer_count = 4;
+
+    /// Bandwidth budget shared by every copy that uses it (nullptr = unlimited)
+    std::shared_ptr<bandwidth_limiter> limiter;
+};
+
+/// Reads up to buffer.size() bytes; returns 0 at end of stream
+using stream_source = std::function<result<std::size_t>(std::span<std::byte> buffer)>;
+
+/// Consumes one filled buffer
+using stream_sink = std::function<result<void>(std::span<const std::byte> data)>;
+
+/**
+ * @brief Copy a byte stream through a bounded ring of buffers
+ *
+ * The source is drained on a dedicated reader thread while the sink
+ * consumes filled buffers on the calling thread, so a download and an
+ * upload overlap instead of alternating. At most buffer_count buffers
+ * exist at a time; the reader waits for the sink when all are full.
+ *
+ * Every buffer handed to the sink is full except the last one. When a
+ * limiter is set, tokens for each buffer are taken before it is written.
+ *
+ * @code
+ * std::ifstream in(path, std::ios::binary);
+ * auto copied = stream_copy(
+ *     [&](std::span<std::byte> buf) -> result<std::size_t> {
+ *         in.read(reinterpret_cast<char*>(buf.data()), buf.size());
+ *         return static_cast<std::size_t>(in.gcount());
+ *     },
+ *     [&](std::span<const std::byte> data) -> result<void> {
+ *         auto written = upload->write(data);
+ *         if (!written.has_value()) return unexpected{written.error()};
+ *         return result<void>();
+ *     });
+ * @endcode
+ *
+ * @param source Reader called on the reader thread
+ * @param sink Writer called on the calling thread
+ * @param options Ring geometry and bandwidth budget
+ * @return Bytes copied, or the first source or sink error
+ */
+[[nodiscard]] auto stream_copy(
+    const stream_source& source,
+    const stream_sink& sink,
+    const stream_copy_options& options = {}) -> result<uint64_t>;
+
+}  // namespace kcenon::file_transfer
+
+#endif  // KCENON_FILE_TRANSFER_SERVER_STREAM_COPY_H
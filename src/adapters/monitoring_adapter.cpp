@@ -202,6 +202,41 @@ common::interfaces::metrics_snapshot file_transfer_monitor_adapter::collect_serv
         static_cast<double>(quota_usage.file_count),
         common::interfaces::metric_type::gauge);
 
+    // Cloud read cache and replication metrics (cloud_only / hybrid modes)
+    if (const auto* storage = server->get_storage_manager()) {
+        auto storage_stats = storage->get_statistics();
+
+        snapshot.metrics.emplace_back(
+            "file_transfer.cache_hits",
+            static_cast<double>(storage_stats.cache_hits),
+            common::interfaces::metric_type::counter);
+
+        snapshot.metrics.emplace_back(
+            "file_transfer.cache_misses",
+            static_cast<double>(storage_stats.cache_misses),
+            common::interfaces::metric_type::counter);
+
+        snapshot.metrics.emplace_back(
+            "file_transfer.cache_evictions",
+            static_cast<double>(storage_stats.cache_evictions),
+            common::interfaces::metric_type::counter);
+
+        snapshot.metrics.emplace_back(
+            "file_transfer.cache_bytes",
+            static_cast<double>(storage_stats.cache_bytes),
+            common::interfaces::metric_type::gauge);
+
+        snapshot.metrics.emplace_back(
+            "file_transfer.replication_pending",
+            static_cast<double>(storage_stats.replication_pending),
+            common::interfaces::metric_type::gauge);
+
+        snapshot.metrics.emplace_back(
+            "file_transfer.replication_lag_ms",
+            static_cast<double>(storage_stats.replication_lag.count()),
+            common::interfaces::metric_type::gauge);
+    }
+
     // Add custom metrics
     {
         std::lock_guard<std::mutex> lock(metrics_mutex_);
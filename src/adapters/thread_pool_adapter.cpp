@@ -9,6 +9,7 @@
  */
 
 #include "kcenon/file_transfer/adapters/thread_pool_adapter.h"
+#include "kcenon/file_transfer/core/io_executor.h"
 
 #include <thread>
 
@@ -340,6 +341,24 @@ size_t network_pool_transfer_adapter::pending_tasks(
 struct async_transfer_pool::impl {
     std::atomic<size_t> active_tasks{0};
     stage_tracker tracker;
+
+    // Declared last so queued tasks never outlive the counters above
+    io_scope io{"transfer_pool"};
+
+    // Counts a task until it has run or been dropped by the executor
+    auto track(const std::string* stage) -> std::shared_ptr<void> {
+        active_tasks.fetch_add(1, std::memory_order_relaxed);
+        if (stage) {
+            tracker.increment(*stage);
+        }
+        return std::shared_ptr<void>(
+            nullptr, [this, stage_name = stage ? *stage : std::string()](void*) {
+                active_tasks.fetch_sub(1, std::memory_order_relaxed);
+                if (!stage_name.empty()) {
+                    tracker.decrement(stage_name);
+                }
+            });
+    }
 };
 
 async_transfer_pool::async_transfer_pool()
@@ -348,62 +367,25 @@ async_transfer_pool::async_transfer_pool()
 async_transfer_pool::~async_transfer_pool() = default;
 
 std::future<void> async_transfer_pool::submit(std::function<void()> task) {
-    pimpl_->active_tasks.fetch_add(1, std::memory_order_relaxed);
-
-    auto* pimpl = pimpl_.get();
-    return std::async(std::launch::async,
-                      [pimpl, task = std::move(task)]() {
-                          try {
-                              task();
-                          } catch (...) {
-                              pimpl->active_tasks.fetch_sub(1, std::memory_order_relaxed);
-                              throw;
-                          }
-                          pimpl->active_tasks.fetch_sub(1, std::memory_order_relaxed);
-                      });
+    return pimpl_->io.submit(
+        [guard = pimpl_->track(nullptr), task = std::move(task)]() { task(); });
 }
 
 std::future<void> async_transfer_pool::submit_delayed(
     std::function<void()> task, std::chrono::milliseconds delay) {
-    pimpl_->active_tasks.fetch_add(1, std::memory_order_relaxed);
-
-    auto* pimpl = pimpl_.get();
-    return std::async(std::launch::async,
-                      [pimpl, task = std::move(task), delay]() {
-                          std::this_thread::sleep_for(delay);
-                          try {
-                              task();
-                          } catch (...) {
-                              pimpl->active_tasks.fetch_sub(1, std::memory_order_relaxed);
-                              throw;
-                          }
-                          pimpl->active_tasks.fetch_sub(1, std::memory_order_relaxed);
-                      });
+    // The delay is a timer on the executor; no thread sleeps through it
+    return pimpl_->io.submit_after(
+        delay, [guard = pimpl_->track(nullptr), task = std::move(task)]() { task(); });
 }
 
 std::future<void> async_transfer_pool::submit_to_stage(
     std::function<void()> task, const std::string& stage_name) {
-    pimpl_->tracker.increment(stage_name);
-    pimpl_->active_tasks.fetch_add(1, std::memory_order_relaxed);
-
-    auto* pimpl = pimpl_.get();
-    return std::async(std::launch::async,
-                      [pimpl, task = std::move(task), stage = stage_name]() {
-                          try {
-                              task();
-                          } catch (...) {
-                              pimpl->active_tasks.fetch_sub(1, std::memory_order_relaxed);
-                              pimpl->tracker.decrement(stage);
-                              throw;
-                          }
-                          pimpl->active_tasks.fetch_sub(1, std::memory_order_relaxed);
-                          pimpl->tracker.decrement(stage);
-                      });
+    return pimpl_->io.submit(
+        [guard = pimpl_->track(&stage_name), task = std::move(task)]() { task(); });
 }
 
 size_t async_transfer_pool::worker_count() const {
-    auto count = std::thread::hardware_concurrency();
-    return count > 0 ? count : 4;
+    return io_executor::shared().worker_count();
 }
 
 bool async_transfer_pool::is_running() const { return true; }
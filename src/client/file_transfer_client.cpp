@@ -8,8 +8,10 @@
 #include <kcenon/file_transfer/core/bandwidth_limiter.h>
 #include <kcenon/file_transfer/core/checksum.h>
 #include <kcenon/file_transfer/core/chunk_assembler.h>
+#include <kcenon/file_transfer/core/chunk_config.h>
 #include <kcenon/file_transfer/core/protocol_types.h>
 #include <kcenon/file_transfer/core/logging.h>
+#include <kcenon/file_transfer/core/transfer_registry.h>
 
 #include <chrono>
 #include <condition_variable>
@@ -345,13 +347,9 @@ struct file_transfer_client::impl {
     mutable std::mutex transfers_mutex;
     std::atomic<uint64_t> next_transfer_id{1};
 
-    // Upload contexts
-    mutable std::mutex upload_mutex;
-    std::unordered_map<uint64_t, std::unique_ptr<upload_context>> upload_contexts;
-
-    // Download contexts
-    mutable std::mutex download_mutex;
-    std::unordered_map<uint64_t, std::unique_ptr<download_context>> download_contexts;
+    // Upload and download contexts by handle, looked up for every chunk
+    transfer_registry<upload_context, uint64_t> upload_contexts;
+    transfer_registry<download_context, uint64_t> download_contexts;
 
     // Batch contexts
     mutable std::mutex batch_mutex;
@@ -470,9 +468,8 @@ auto file_transfer_client::builder::with_encryption_key(
 }
 
 auto file_transfer_client::builder::build() -> result<file_transfer_client> {
-    if (config_.chunk_size < 64 * 1024 || config_.chunk_size > 1024 * 1024) {
-        return unexpected{error{error_code::invalid_chunk_size,
-                               "Chunk size must be between 64KB and 1MB"}};
+    if (auto valid = chunk_config(config_.chunk_size).validate(); !valid) {
+        return unexpected{valid.error()};
     }
 
     return file_transfer_client{std::move(config_)};
@@ -588,7 +585,7 @@ auto file_transfer_client::upload_file(
     transfer_handle handle{handle_id, this};
 
     // Create upload context
-    auto ctx = std::make_unique<upload_context>();
+    auto ctx = std::make_shared<upload_context>();
     ctx->tid = transfer_id::generate();
     ctx->local_path = local_path;
     ctx->remote_name = remote_name;
@@ -608,10 +605,7 @@ auto file_transfer_client::upload_file(
     FT_LOG_INFO_CTX(log_category::client, "Starting file upload", log_ctx);
 
     // Store upload context
-    {
-        std::lock_guard lock(impl_->upload_mutex);
-        impl_->upload_contexts[handle_id] = std::move(ctx);
-    }
+    impl_->upload_contexts.insert(handle_id, std::move(ctx));
 
     // Update statistics
     {
@@ -621,13 +615,9 @@ auto file_transfer_client::upload_file(
 
     // TODO: Implement actual file upload logic with network layer
     // For now, mark as transferring
-    {
-        std::lock_guard lock(impl_->upload_mutex);
-        auto it = impl_->upload_contexts.find(handle_id);
-        if (it != impl_->upload_contexts.end()) {
-            std::lock_guard ctx_lock(it->second->mutex);
-            it->second->state = internal_transfer_state::transferring;
-        }
+    if (auto ctx = impl_->upload_contexts.find(handle_id)) {
+        std::lock_guard ctx_lock(ctx->mutex);
+        ctx->state = internal_transfer_state::transferring;
     }
 
     return handle;
@@ -685,7 +675,7 @@ auto file_transfer_client::download_file(
     transfer_handle handle{handle_id, this};
 
     // Create download context
-    auto ctx = std::make_unique<download_context>();
+    auto ctx = std::make_shared<download_context>();
     ctx->tid = transfer_id::generate();
     ctx->remote_name = remote_name;
     ctx->local_path = local_path;
@@ -703,18 +693,9 @@ auto file_transfer_client::download_file(
     log_ctx.filename = remote_name;
     FT_LOG_INFO_CTX(log_category::client, "Starting file download", log_ctx);
 
-    // Store download context
-    {
-        std::lock_guard lock(impl_->download_mutex);
-        impl_->download_contexts[handle_id] = std::move(ctx);
-    }
-
-    // Get context pointer for operations
-    download_context* dl_ctx = nullptr;
-    {
-        std::lock_guard lock(impl_->download_mutex);
-        dl_ctx = impl_->download_contexts[handle_id].get();
-    }
+    // Store download context, keeping a reference for operations
+    auto dl_ctx = ctx;
+    impl_->download_contexts.insert(handle_id, std::move(ctx));
 
     // Build and send DOWNLOAD_REQUEST message
     msg_download_request request;
@@ -751,15 +732,10 @@ auto file_transfer_client::process_download_chunk(
         impl_->download_limiter->acquire(received_chunk.data.size());
     }
 
-    download_context* ctx = nullptr;
-    {
-        std::lock_guard lock(impl_->download_mutex);
-        auto it = impl_->download_contexts.find(handle_id);
-        if (it == impl_->download_contexts.end()) {
-            return unexpected{error{error_code::not_initialized,
-                                   "Download context not found"}};
-        }
-        ctx = it->second.get();
+    auto ctx = impl_->download_contexts.find(handle_id);
+    if (!ctx) {
+        return unexpected{error{error_code::not_initialized,
+                               "Download context not found"}};
     }
 
     std::lock_guard ctx_lock(ctx->mutex);
@@ -770,14 +746,6 @@ auto file_transfer_client::process_download_chunk(
                                "Download was cancelled"}};
     }
 
-    // Verify chunk checksum (CRC32)
-    if (!checksum::verify_crc32(
-            std::span<const std::byte>(received_chunk.data),
-            received_chunk.header.checksum)) {
-        return unexpected{error{error_code::chunk_checksum_error,
-                               "Chunk CRC32 verification failed"}};
-    }
-
     // Decompress if needed
     std::vector<std::byte> write_data;
     if (received_chunk.is_compressed()) {
@@ -793,6 +761,17 @@ auto file_transfer_client::process_download_chunk(
         write_data = received_chunk.data;
     }
 
+    // The sender's checksum covers the uncompressed data, with the
+    // algorithm recorded in the chunk header
+    if (!checksum::verify(received_chunk.header.integrity,
+                          std::span<const std::byte>(write_data),
+                          received_chunk.digest())) {
+        return unexpected{error{error_code::chunk_checksum_error,
+                               std::string("Chunk ") +
+                                   to_string(received_chunk.header.integrity) +
+                                   " verification failed"}};
+    }
+
     // Write to temp file
     std::ofstream file(ctx->temp_path,
                        std::ios::binary | std::ios::in | std::ios::out);
@@ -847,16 +826,11 @@ auto file_transfer_client::process_download_chunk(
 }
 
 auto file_transfer_client::finalize_download(uint64_t handle_id) -> result<void> {
-    download_context* ctx = nullptr;
-    {
-        std::lock_guard lock(impl_->download_mutex);
-        auto it = impl_->download_contexts.find(handle_id);
-        if (it == impl_->download_contexts.end()) {
-            FT_LOG_ERROR(log_category::client, "Download finalization failed: context not found");
-            return unexpected{error{error_code::not_initialized,
-                                   "Download context not found"}};
-        }
-        ctx = it->second.get();
+    auto ctx = impl_->download_contexts.find(handle_id);
+    if (!ctx) {
+        FT_LOG_ERROR(log_category::client, "Download finalization failed: context not found");
+        return unexpected{error{error_code::not_initialized,
+                               "Download context not found"}};
     }
 
     std::lock_guard ctx_lock(ctx->mutex);
@@ -974,16 +948,11 @@ auto file_transfer_client::finalize_download(uint64_t handle_id) -> result<void>
 }
 
 auto file_transfer_client::cancel_download(uint64_t handle_id) -> result<void> {
-    download_context* ctx = nullptr;
-    {
-        std::lock_guard lock(impl_->download_mutex);
-        auto it = impl_->download_contexts.find(handle_id);
-        if (it == impl_->download_contexts.end()) {
-            FT_LOG_WARN(log_category::client, "Cancel download failed: context not found");
-            return unexpected{error{error_code::not_initialized,
-                                   "Download context not found"}};
-        }
-        ctx = it->second.get();
+    auto ctx = impl_->download_contexts.find(handle_id);
+    if (!ctx) {
+        FT_LOG_WARN(log_category::client, "Cancel download failed: context not found");
+        return unexpected{error{error_code::not_initialized,
+                               "Download context not found"}};
     }
 
     {
@@ -1014,15 +983,10 @@ auto file_transfer_client::set_download_metadata(
     uint32_t chunk_size,
     const std::string& sha256_hash) -> result<void> {
 
-    download_context* ctx = nullptr;
-    {
-        std::lock_guard lock(impl_->download_mutex);
-        auto it = impl_->download_contexts.find(handle_id);
-        if (it == impl_->download_contexts.end()) {
-            return unexpected{error{error_code::not_initialized,
-                                   "Download context not found"}};
-        }
-        ctx = it->second.get();
+    auto ctx = impl_->download_contexts.find(handle_id);
+    if (!ctx) {
+        return unexpected{error{error_code::not_initialized,
+                               "Download context not found"}};
     }
 
     std::lock_guard ctx_lock(ctx->mutex);
@@ -1077,22 +1041,13 @@ auto file_transfer_client::get_statistics() const -> client_statistics {
 
     // Count active transfers from upload and download contexts
     std::size_t active_count = 0;
-    {
-        std::lock_guard upload_lock(impl_->upload_mutex);
-        for (const auto& [id, ctx] : impl_->upload_contexts) {
-            if (ctx && !is_terminal_status(to_transfer_status(ctx->state))) {
-                ++active_count;
-            }
-        }
-    }
-    {
-        std::lock_guard download_lock(impl_->download_mutex);
-        for (const auto& [id, ctx] : impl_->download_contexts) {
-            if (ctx && !is_terminal_status(to_transfer_status(ctx->state))) {
-                ++active_count;
-            }
+    auto count_active = [&active_count](uint64_t, const auto& ctx) {
+        if (!is_terminal_status(to_transfer_status(ctx->state))) {
+            ++active_count;
         }
-    }
+    };
+    impl_->upload_contexts.for_each(count_active);
+    impl_->download_contexts.for_each(count_active);
     stats.active_transfers = active_count;
 
     return stats;
@@ -1114,23 +1069,15 @@ auto file_transfer_client::config() const -> const client_config& {
 auto file_transfer_client::get_transfer_status(uint64_t handle_id) const
     -> transfer_status {
     // Check upload contexts
-    {
-        std::lock_guard lock(impl_->upload_mutex);
-        auto it = impl_->upload_contexts.find(handle_id);
-        if (it != impl_->upload_contexts.end() && it->second) {
-            std::lock_guard ctx_lock(it->second->mutex);
-            return to_transfer_status(it->second->state);
-        }
+    if (auto ctx = impl_->upload_contexts.find(handle_id)) {
+        std::lock_guard ctx_lock(ctx->mutex);
+        return to_transfer_status(ctx->state);
     }
 
     // Check download contexts
-    {
-        std::lock_guard lock(impl_->download_mutex);
-        auto it = impl_->download_contexts.find(handle_id);
-        if (it != impl_->download_contexts.end() && it->second) {
-            std::lock_guard ctx_lock(it->second->mutex);
-            return to_transfer_status(it->second->state);
-        }
+    if (auto ctx = impl_->download_contexts.find(handle_id)) {
+        std::lock_guard ctx_lock(ctx->mutex);
+        return to_transfer_status(ctx->state);
     }
 
     return transfer_status::failed;
@@ -1139,23 +1086,15 @@ auto file_transfer_client::get_transfer_status(uint64_t handle_id) const
 auto file_transfer_client::get_transfer_progress(uint64_t handle_id) const
     -> transfer_progress_info {
     // Check upload contexts
-    {
-        std::lock_guard lock(impl_->upload_mutex);
-        auto it = impl_->upload_contexts.find(handle_id);
-        if (it != impl_->upload_contexts.end() && it->second) {
-            std::lock_guard ctx_lock(it->second->mutex);
-            return it->second->get_progress_info();
-        }
+    if (auto ctx = impl_->upload_contexts.find(handle_id)) {
+        std::lock_guard ctx_lock(ctx->mutex);
+        return ctx->get_progress_info();
     }
 
     // Check download contexts
-    {
-        std::lock_guard lock(impl_->download_mutex);
-        auto it = impl_->download_contexts.find(handle_id);
-        if (it != impl_->download_contexts.end() && it->second) {
-            std::lock_guard ctx_lock(it->second->mutex);
-            return it->second->get_progress_info();
-        }
+    if (auto ctx = impl_->download_contexts.find(handle_id)) {
+        std::lock_guard ctx_lock(ctx->mutex);
+        return ctx->get_progress_info();
     }
 
     return transfer_progress_info{};
@@ -1163,45 +1102,35 @@ auto file_transfer_client::get_transfer_progress(uint64_t handle_id) const
 
 auto file_transfer_client::pause_transfer(uint64_t handle_id) -> result<void> {
     // Try upload context first
-    {
-        std::lock_guard lock(impl_->upload_mutex);
-        auto it = impl_->upload_contexts.find(handle_id);
-        if (it != impl_->upload_contexts.end() && it->second) {
-            std::lock_guard ctx_lock(it->second->mutex);
-            auto& ctx = it->second;
-
-            // Validate state transition
-            if (!is_valid_transition(ctx->state,
-                                     internal_transfer_state::paused)) {
-                return unexpected{error{error_code::invalid_state_transition,
-                    "Cannot pause transfer in current state: " +
-                    std::string(to_string(to_transfer_status(ctx->state)))}};
-            }
+    if (auto ctx = impl_->upload_contexts.find(handle_id)) {
+        std::lock_guard ctx_lock(ctx->mutex);
 
-            ctx->state = internal_transfer_state::paused;
-            return {};
+        // Validate state transition
+        if (!is_valid_transition(ctx->state,
+                                 internal_transfer_state::paused)) {
+            return unexpected{error{error_code::invalid_state_transition,
+                "Cannot pause transfer in current state: " +
+                std::string(to_string(to_transfer_status(ctx->state)))}};
         }
+
+        ctx->state = internal_transfer_state::paused;
+        return {};
     }
 
     // Try download context
-    {
-        std::lock_guard lock(impl_->download_mutex);
-        auto it = impl_->download_contexts.find(handle_id);
-        if (it != impl_->download_contexts.end() && it->second) {
-            std::lock_guard ctx_lock(it->second->mutex);
-            auto& ctx = it->second;
-
-            // Validate state transition
-            if (!is_valid_transition(ctx->state,
-                                     internal_transfer_state::paused)) {
-                return unexpected{error{error_code::invalid_state_transition,
-                    "Cannot pause transfer in current state: " +
-                    std::string(to_string(to_transfer_status(ctx->state)))}};
-            }
+    if (auto ctx = impl_->download_contexts.find(handle_id)) {
+        std::lock_guard ctx_lock(ctx->mutex);
 
-            ctx->state = internal_transfer_state::paused;
-            return {};
+        // Validate state transition
+        if (!is_valid_transition(ctx->state,
+                                 internal_transfer_state::paused)) {
+            return unexpected{error{error_code::invalid_state_transition,
+                "Cannot pause transfer in current state: " +
+                std::string(to_string(to_transfer_status(ctx->state)))}};
         }
+
+        ctx->state = internal_transfer_state::paused;
+        return {};
     }
 
     return unexpected{error{error_code::transfer_not_found,
@@ -1210,47 +1139,37 @@ auto file_transfer_client::pause_transfer(uint64_t handle_id) -> result<void> {
 
 auto file_transfer_client::resume_transfer(uint64_t handle_id) -> result<void> {
     // Try upload context first
-    {
-        std::lock_guard lock(impl_->upload_mutex);
-        auto it = impl_->upload_contexts.find(handle_id);
-        if (it != impl_->upload_contexts.end() && it->second) {
-            std::lock_guard ctx_lock(it->second->mutex);
-            auto& ctx = it->second;
-
-            // Validate state transition
-            if (!is_valid_transition(ctx->state,
-                                     internal_transfer_state::transferring)) {
-                return unexpected{error{error_code::invalid_state_transition,
-                    "Cannot resume transfer in current state: " +
-                    std::string(to_string(to_transfer_status(ctx->state)))}};
-            }
+    if (auto ctx = impl_->upload_contexts.find(handle_id)) {
+        std::lock_guard ctx_lock(ctx->mutex);
 
-            ctx->state = internal_transfer_state::transferring;
-            ctx->cv.notify_all();  // Wake up any paused workers
-            return {};
+        // Validate state transition
+        if (!is_valid_transition(ctx->state,
+                                 internal_transfer_state::transferring)) {
+            return unexpected{error{error_code::invalid_state_transition,
+                "Cannot resume transfer in current state: " +
+                std::string(to_string(to_transfer_status(ctx->state)))}};
         }
+
+        ctx->state = internal_transfer_state::transferring;
+        ctx->cv.notify_all();  // Wake up any paused workers
+        return {};
     }
 
     // Try download context
-    {
-        std::lock_guard lock(impl_->download_mutex);
-        auto it = impl_->download_contexts.find(handle_id);
-        if (it != impl_->download_contexts.end() && it->second) {
-            std::lock_guard ctx_lock(it->second->mutex);
-            auto& ctx = it->second;
-
-            // Validate state transition
-            if (!is_valid_transition(ctx->state,
-                                     internal_transfer_state::transferring)) {
-                return unexpected{error{error_code::invalid_state_transition,
-                    "Cannot resume transfer in current state: " +
-                    std::string(to_string(to_transfer_status(ctx->state)))}};
-            }
+    if (auto ctx = impl_->download_contexts.find(handle_id)) {
+        std::lock_guard ctx_lock(ctx->mutex);
 
-            ctx->state = internal_transfer_state::transferring;
-            ctx->cv.notify_all();  // Wake up any paused workers
-            return {};
+        // Validate state transition
+        if (!is_valid_transition(ctx->state,
+                                 internal_transfer_state::transferring)) {
+            return unexpected{error{error_code::invalid_state_transition,
+                "Cannot resume transfer in current state: " +
+                std::string(to_string(to_transfer_status(ctx->state)))}};
         }
+
+        ctx->state = internal_transfer_state::transferring;
+        ctx->cv.notify_all();  // Wake up any paused workers
+        return {};
     }
 
     return unexpected{error{error_code::transfer_not_found,
@@ -1259,36 +1178,25 @@ auto file_transfer_client::resume_transfer(uint64_t handle_id) -> result<void> {
 
 auto file_transfer_client::cancel_transfer(uint64_t handle_id) -> result<void> {
     // Try upload context first
-    {
-        std::lock_guard lock(impl_->upload_mutex);
-        auto it = impl_->upload_contexts.find(handle_id);
-        if (it != impl_->upload_contexts.end() && it->second) {
-            std::lock_guard ctx_lock(it->second->mutex);
-            auto& ctx = it->second;
-
-            // Validate state transition
-            if (!is_valid_transition(ctx->state,
-                                     internal_transfer_state::cancelled)) {
-                return unexpected{error{error_code::transfer_already_completed,
-                    "Cannot cancel transfer in current state: " +
-                    std::string(to_string(to_transfer_status(ctx->state)))}};
-            }
+    if (auto ctx = impl_->upload_contexts.find(handle_id)) {
+        std::lock_guard ctx_lock(ctx->mutex);
 
-            ctx->state = internal_transfer_state::cancelled;
-            ctx->cv.notify_all();
-            return {};
+        // Validate state transition
+        if (!is_valid_transition(ctx->state,
+                                 internal_transfer_state::cancelled)) {
+            return unexpected{error{error_code::transfer_already_completed,
+                "Cannot cancel transfer in current state: " +
+                std::string(to_string(to_transfer_status(ctx->state)))}};
         }
+
+        ctx->state = internal_transfer_state::cancelled;
+        ctx->cv.notify_all();
+        return {};
     }
 
     // Try download context - delegate to existing cancel_download
-    {
-        std::lock_guard lock(impl_->download_mutex);
-        auto it = impl_->download_contexts.find(handle_id);
-        if (it != impl_->download_contexts.end()) {
-            // Release lock before calling cancel_download
-            lock.~lock_guard();
-            return cancel_download(handle_id);
-        }
+    if (impl_->download_contexts.contains(handle_id)) {
+        return cancel_download(handle_id);
     }
 
     return unexpected{error{error_code::transfer_not_found,
@@ -1309,63 +1217,49 @@ auto file_transfer_client::wait_for_transfer(
     auto deadline = std::chrono::steady_clock::now() + timeout;
 
     // Try upload context first
-    {
-        std::unique_lock lock(impl_->upload_mutex);
-        auto it = impl_->upload_contexts.find(handle_id);
-        if (it != impl_->upload_contexts.end() && it->second) {
-            auto& ctx = it->second;
-            lock.unlock();  // Don't hold upload_mutex while waiting
-
-            std::unique_lock ctx_lock(ctx->mutex);
-            auto status = to_transfer_status(ctx->state);
-
-            // Wait until terminal state or timeout
-            while (!is_terminal_status(status)) {
-                if (timeout == std::chrono::milliseconds::max()) {
-                    ctx->cv.wait(ctx_lock);
-                } else {
-                    auto remaining = deadline - std::chrono::steady_clock::now();
-                    if (remaining <= std::chrono::milliseconds::zero()) {
-                        return unexpected{error{error_code::transfer_timeout,
-                                               "Wait timed out"}};
-                    }
-                    ctx->cv.wait_for(ctx_lock, remaining);
+    if (auto ctx = impl_->upload_contexts.find(handle_id)) {
+        std::unique_lock ctx_lock(ctx->mutex);
+        auto status = to_transfer_status(ctx->state);
+
+        // Wait until terminal state or timeout
+        while (!is_terminal_status(status)) {
+            if (timeout == std::chrono::milliseconds::max()) {
+                ctx->cv.wait(ctx_lock);
+            } else {
+                auto remaining = deadline - std::chrono::steady_clock::now();
+                if (remaining <= std::chrono::milliseconds::zero()) {
+                    return unexpected{error{error_code::transfer_timeout,
+                                           "Wait timed out"}};
                 }
-                status = to_transfer_status(ctx->state);
+                ctx->cv.wait_for(ctx_lock, remaining);
             }
-
-            return ctx->get_result_info();
+            status = to_transfer_status(ctx->state);
         }
+
+        return ctx->get_result_info();
     }
 
     // Try download context
-    {
-        std::unique_lock lock(impl_->download_mutex);
-        auto it = impl_->download_contexts.find(handle_id);
-        if (it != impl_->download_contexts.end() && it->second) {
-            auto& ctx = it->second;
-            lock.unlock();  // Don't hold download_mutex while waiting
-
-            std::unique_lock ctx_lock(ctx->mutex);
-            auto status = to_transfer_status(ctx->state);
-
-            // Wait until terminal state or timeout
-            while (!is_terminal_status(status)) {
-                if (timeout == std::chrono::milliseconds::max()) {
-                    ctx->cv.wait(ctx_lock);
-                } else {
-                    auto remaining = deadline - std::chrono::steady_clock::now();
-                    if (remaining <= std::chrono::milliseconds::zero()) {
-                        return unexpected{error{error_code::transfer_timeout,
-                                               "Wait timed out"}};
-                    }
-                    ctx->cv.wait_for(ctx_lock, remaining);
+    if (auto ctx = impl_->download_contexts.find(handle_id)) {
+        std::unique_lock ctx_lock(ctx->mutex);
+        auto status = to_transfer_status(ctx->state);
+
+        // Wait until terminal state or timeout
+        while (!is_terminal_status(status)) {
+            if (timeout == std::chrono::milliseconds::max()) {
+                ctx->cv.wait(ctx_lock);
+            } else {
+                auto remaining = deadline - std::chrono::steady_clock::now();
+                if (remaining <= std::chrono::milliseconds::zero()) {
+                    return unexpected{error{error_code::transfer_timeout,
+                                           "Wait timed out"}};
                 }
-                status = to_transfer_status(ctx->state);
+                ctx->cv.wait_for(ctx_lock, remaining);
             }
-
-            return ctx->get_result_info();
+            status = to_transfer_status(ctx->state);
         }
+
+        return ctx->get_result_info();
     }
 
     return unexpected{error{error_code::transfer_not_found,
@@ -8,6 +8,7 @@
 #include "kcenon/file_transfer/cloud/cloud_http_client.h"
 #include "kcenon/file_transfer/cloud/cloud_utils.h"
 #include "kcenon/file_transfer/config/feature_flags.h"
+#include "kcenon/file_transfer/core/io_executor.h"
 
 #include <algorithm>
 #include <array>
@@ -39,6 +40,12 @@ using cloud_utils::generate_random_bytes;
 using cloud_utils::extract_xml_element;
 using cloud_utils::detect_content_type;
 using cloud_utils::calculate_retry_delay;
+using cloud_utils::file_part_reader;
+using cloud_utils::part_buffer_pool;
+using cloud_utils::pooled_buffer;
+using cloud_utils::byte_range;
+using cloud_utils::format_range_header;
+using cloud_utils::download_ranges_to_file;
 
 // ============================================================================
 // Real HTTP Client Implementation (uses unified cloud_http_client)
@@ -53,8 +60,9 @@ using cloud_utils::calculate_retry_delay;
  */
 class real_azure_http_client : public azure_http_client_interface {
 public:
-    explicit real_azure_http_client(std::chrono::milliseconds timeout = std::chrono::milliseconds(30000))
-        : client_(make_cloud_http_client(timeout)) {}
+    explicit real_azure_http_client(std::chrono::milliseconds timeout = std::chrono::milliseconds(30000),
+                                    const connection_pool_config& pool = {})
+        : client_(make_cloud_http_client(timeout, pool)) {}
 
     auto get(
         const std::string& url,
@@ -111,6 +119,10 @@ public:
         return convert_response(response.value());
     }
 
+    auto pool_statistics() const -> connection_pool_statistics override {
+        return client_->pool_statistics();
+    }
+
 private:
     static auto convert_response(const http_response_base& resp) -> azure_http_response {
         azure_http_response result;
@@ -207,9 +219,12 @@ struct azure_blob_upload_stream::impl {
     cloud_transfer_options options;
     std::shared_ptr<azure_http_client_interface> http_client_;
 
+    // At most max_concurrent_parts block buffers exist, in flight or being filled
+    part_buffer_pool buffers;
+
     std::vector<std::string> block_ids;
     int current_block_number = 0;
-    std::vector<std::byte> block_buffer;
+    pooled_buffer block_buffer;  // Block being filled by write()
     uint64_t bytes_written_ = 0;
     bool finalized = false;
     bool aborted = false;
@@ -227,42 +242,18 @@ struct azure_blob_upload_stream::impl {
          const cloud_transfer_options& opts,
          std::shared_ptr<azure_http_client_interface> http_client = nullptr)
         : blob_name(name), config(cfg), credentials(std::move(creds)), options(opts),
-          http_client_(std::move(http_client)) {
-        block_buffer.reserve(config.multipart.part_size);
+          http_client_(std::move(http_client)),
+          buffers(static_cast<std::size_t>(config.multipart.part_size),
+                  config.multipart.max_concurrent_parts) {
 #if KCENON_WITH_NETWORK_SYSTEM
         if (!http_client_) {
             http_client_ = std::make_shared<real_azure_http_client>(
-                std::chrono::milliseconds(30000));  // 30 second timeout
+                std::chrono::milliseconds(30000),  // 30 second timeout
+                make_connection_pool_config(config));
         }
 #endif
     }
 
-    auto get_active_upload_count() -> std::size_t {
-        std::lock_guard<std::mutex> lock(pending_mutex);
-        std::size_t count = 0;
-        for (auto& pending : pending_uploads) {
-            if (pending.future.valid()) {
-                auto status = pending.future.wait_for(std::chrono::milliseconds(0));
-                if (status != std::future_status::ready) {
-                    ++count;
-                }
-            }
-        }
-        return count;
-    }
-
-    auto wait_for_slot() -> result<void> {
-        while (get_active_upload_count() >= config.multipart.max_concurrent_parts) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-
-            auto collect_result = collect_completed_uploads();
-            if (!collect_result.has_value()) {
-                return unexpected{collect_result.error()};
-            }
-        }
-        return result<void>{};
-    }
-
     auto collect_completed_uploads() -> result<void> {
         std::lock_guard<std::mutex> lock(pending_mutex);
 
@@ -301,15 +292,56 @@ struct azure_blob_upload_stream::impl {
         return result<void>{};
     }
 
-    auto upload_block_async(const std::string& block_id, std::vector<std::byte> data) -> void {
-        auto future = std::async(std::launch::async, [this, block_id, data = std::move(data)]() {
-            return this->upload_block(block_id, std::span<const std::byte>(data));
+    auto upload_block_async(const std::string& block_id, pooled_buffer data) -> void {
+        auto future = io.submit([this, block_id, data = std::move(data)]() {
+            return this->upload_block(block_id, std::span<const std::byte>(*data));
         });
 
         std::lock_guard<std::mutex> lock(pending_mutex);
         pending_uploads.push_back({block_id, std::move(future)});
     }
 
+    // Assigns the next block id and queues the block for upload
+    auto stage_block(pooled_buffer data) -> void {
+        std::string block_id = generate_block_id(current_block_number++);
+        block_ids.push_back(block_id);
+        upload_block_async(block_id, std::move(data));
+    }
+
+    /**
+     * @brief Upload a whole file as blocks read directly into pooled buffers
+     *
+     * Acquiring a buffer waits while max_concurrent_parts blocks are in
+     * flight, so memory stays bounded independent of the file size.
+     */
+    auto upload_from_file(const file_part_reader& reader) -> result<void> {
+        const auto block_size = static_cast<uint64_t>(buffers.buffer_size());
+
+        for (uint64_t offset = 0; offset < reader.size(); offset += block_size) {
+            auto collect_result = collect_completed_uploads();
+            if (!collect_result.has_value()) {
+                return collect_result;
+            }
+
+            auto length = static_cast<std::size_t>(std::min(block_size, reader.size() - offset));
+            auto block = buffers.acquire();
+            block->resize(length);
+
+            auto read_result = reader.read_at(offset, *block);
+            if (!read_result.has_value()) {
+                return unexpected{read_result.error()};
+            }
+            if (read_result.value() != length) {
+                return unexpected{error{error_code::file_read_error,
+                    "File was truncated during upload"}};
+            }
+
+            stage_block(std::move(block));
+            bytes_written_ += length;
+        }
+        return result<void>{};
+    }
+
     auto upload_block(const std::string& block_id, std::span<const std::byte> data) -> result<void> {
 #if KCENON_WITH_NETWORK_SYSTEM
         if (!http_client_) {
@@ -336,11 +368,8 @@ struct azure_blob_upload_stream::impl {
             headers["Authorization"] = auth;
         }
 
-        // Convert data to vector for HTTP client
-        std::vector<uint8_t> body(data.size());
-        std::memcpy(body.data(), data.data(), data.size());
-
-        auto response = http_client_->put(url, std::string(reinterpret_cast<const char*>(body.data()), body.size()), headers);
+        auto response = http_client_->put(
+            url, std::string(reinterpret_cast<const char*>(data.data()), data.size()), headers);
         if (!response.has_value()) {
             return unexpected{error{error_code::internal_error, "Failed to upload block: " + response.error().message}};
         }
@@ -504,6 +533,10 @@ struct azure_blob_upload_stream::impl {
 
         return result;
     }
+
+    // Part uploads share the storage lane; declared last so pending parts are
+    // cancelled or finished before the rest of the stream state goes away
+    io_scope io{"azure/" + config.container};
 };
 
 azure_blob_upload_stream::azure_blob_upload_stream(
@@ -533,33 +566,27 @@ auto azure_blob_upload_stream::write(std::span<const std::byte> data) -> result<
     std::size_t remaining = data.size();
 
     while (remaining > 0) {
-        std::size_t space_in_buffer = impl_->config.multipart.part_size - impl_->block_buffer.size();
+        // Waits for an in-flight block to finish when all buffers are in use
+        if (!impl_->block_buffer) {
+            impl_->block_buffer = impl_->buffers.acquire();
+        }
+        auto& block = *impl_->block_buffer;
+
+        std::size_t space_in_buffer = impl_->config.multipart.part_size - block.size();
         std::size_t to_copy = std::min(remaining, space_in_buffer);
 
-        impl_->block_buffer.insert(impl_->block_buffer.end(), ptr, ptr + to_copy);
+        block.insert(block.end(), ptr, ptr + to_copy);
         ptr += to_copy;
         remaining -= to_copy;
         bytes_processed += to_copy;
 
-        if (impl_->block_buffer.size() >= impl_->config.multipart.part_size) {
-            auto wait_result = impl_->wait_for_slot();
-            if (!wait_result.has_value()) {
-                return unexpected{wait_result.error()};
-            }
-
+        if (block.size() >= impl_->config.multipart.part_size) {
             auto collect_result = impl_->collect_completed_uploads();
             if (!collect_result.has_value()) {
                 return unexpected{collect_result.error()};
             }
 
-            std::string block_id = generate_block_id(impl_->current_block_number);
-            impl_->block_ids.push_back(block_id);
-
-            std::vector<std::byte> block_data(impl_->block_buffer.begin(), impl_->block_buffer.end());
-            impl_->upload_block_async(block_id, std::move(block_data));
-
-            impl_->current_block_number++;
-            impl_->block_buffer.clear();
+            impl_->stage_block(std::move(impl_->block_buffer));
         }
     }
 
@@ -581,13 +608,13 @@ auto azure_blob_upload_stream::finalize() -> result<upload_result> {
     }
 
     // Upload remaining data as final block
-    if (!impl_->block_buffer.empty()) {
-        std::string block_id = generate_block_id(impl_->current_block_number);
+    if (impl_->block_buffer && !impl_->block_buffer->empty()) {
+        std::string block_id = generate_block_id(impl_->current_block_number++);
         impl_->block_ids.push_back(block_id);
 
         auto result = impl_->upload_block(
             block_id,
-            std::span<const std::byte>(impl_->block_buffer));
+            std::span<const std::byte>(*impl_->block_buffer));
 
         if (!result.has_value()) {
             return unexpected{result.error()};
@@ -637,13 +664,21 @@ struct azure_blob_download_stream::impl {
     std::size_t buffer_pos = 0;
     bool initialized = false;
 
-    std::shared_ptr<cloud_http_client> http_client_;
+    std::shared_ptr<azure_http_client_interface> http_client_;
 
     impl(const std::string& name,
          const azure_blob_config& cfg,
-         std::shared_ptr<credential_provider> creds)
+         std::shared_ptr<credential_provider> creds,
+         std::shared_ptr<azure_http_client_interface> http_client = nullptr)
         : blob_name(name), config(cfg), credentials(std::move(creds)),
-          http_client_(make_cloud_http_client(std::chrono::milliseconds(30000))) {
+          http_client_(std::move(http_client)) {
+#if KCENON_WITH_NETWORK_SYSTEM
+        if (!http_client_) {
+            http_client_ = std::make_shared<real_azure_http_client>(
+                std::chrono::milliseconds(30000),  // 30 second timeout
+                make_connection_pool_config(config));
+        }
+#endif
     }
 
     auto get_blob_endpoint() const -> std::string {
@@ -843,8 +878,10 @@ struct azure_blob_download_stream::impl {
 azure_blob_download_stream::azure_blob_download_stream(
     const std::string& blob_name,
     const azure_blob_config& config,
-    std::shared_ptr<credential_provider> credentials)
-    : impl_(std::make_unique<impl>(blob_name, config, std::move(credentials))) {
+    std::shared_ptr<credential_provider> credentials,
+    std::shared_ptr<azure_http_client_interface> http_client)
+    : impl_(std::make_unique<impl>(blob_name, config, std::move(credentials),
+                                   std::move(http_client))) {
     impl_->initialize();
 }
 
@@ -926,9 +963,12 @@ struct azure_blob_storage::impl {
 #if KCENON_WITH_NETWORK_SYSTEM
         if (!http_client_) {
             http_client_ = std::make_shared<real_azure_http_client>(
-                std::chrono::milliseconds(30000));  // 30 second timeout
+                std::chrono::milliseconds(30000),  // 30 second timeout
+                make_connection_pool_config(config_));
         }
 #endif
+        io.set_concurrency_limit(config_.connection_pool_size);
+        async_io.set_blocking();
     }
 
     void set_state(cloud_storage_state new_state) {
@@ -1048,6 +1088,78 @@ struct azure_blob_storage::impl {
         std::lock_guard<std::mutex> lock(mutex_);
         stats_.errors++;
     }
+
+    /**
+     * @brief Fetch one byte range of a blob with a ranged GET
+     * @param key Blob name
+     * @param range Byte range to fetch
+     * @param etag Blob ETag; when set the GET fails if the blob changed
+     */
+    auto get_blob_range(const std::string& key,
+                        const byte_range& range,
+                        const std::string& etag) -> result<std::vector<std::byte>> {
+#if KCENON_WITH_NETWORK_SYSTEM
+        if (!http_client_) {
+            return unexpected{error{error_code::not_initialized, "HTTP client not initialized"}};
+        }
+
+        std::string url = get_blob_endpoint() + "/" + config_.container + "/" +
+                          url_encode(key, false);
+
+        std::map<std::string, std::string> headers;
+        headers["x-ms-version"] = config_.api_version;
+        headers["x-ms-date"] = get_rfc1123_time();
+        headers["x-ms-range"] = format_range_header(range);
+        if (!etag.empty()) {
+            headers["If-Match"] = etag;
+        }
+
+        std::string resource = "/" + config_.container + "/" + key;
+        std::string auth = create_authorization_header("GET", resource, headers, "");
+        if (!auth.empty()) {
+            headers["Authorization"] = auth;
+        }
+
+        auto response = http_client_->get(url, {}, headers);
+        if (!response.has_value()) {
+            return unexpected{error{error_code::connection_failed,
+                "Ranged blob download failed: " + response.error().message}};
+        }
+
+        auto& resp = response.value();
+        if (resp.status_code == 404) {
+            return unexpected{error{error_code::file_not_found, "Blob not found: " + key}};
+        }
+        if (resp.status_code == 412) {
+            return unexpected{error{error_code::file_hash_mismatch,
+                "Blob changed during download: " + key}};
+        }
+
+        const auto* body = reinterpret_cast<const std::byte*>(resp.body.data());
+        if (resp.status_code == 206) {
+            return std::vector<std::byte>(body, body + resp.body.size());
+        }
+        if (resp.status_code == 200 && resp.body.size() >= range.offset + range.length) {
+            return std::vector<std::byte>(body + range.offset, body + range.offset + range.length);
+        }
+        return unexpected{error{error_code::internal_error,
+            "Ranged blob download failed, status: " + std::to_string(resp.status_code)}};
+#else
+        (void)key;
+        (void)range;
+        (void)etag;
+        return unexpected{error{error_code::not_initialized, "HTTP client not initialized"}};
+#endif
+    }
+
+    // Part uploads and ranged reads; declared late so queued work is
+    // cancelled and running work finishes before the rest of the state is
+    // destroyed
+    io_scope io{"azure/" + config_.container};
+
+    // The *_async calls wait on the parts and ranges they start on io, so
+    // they run on a blocking lane and never hold the workers those need
+    io_scope async_io{"azure/" + config_.container + "/async"};
 };
 
 azure_blob_storage::azure_blob_storage(
@@ -1200,25 +1312,46 @@ auto azure_blob_storage::upload_file(
         return unexpected{error{error_code::not_initialized, "Not connected"}};
     }
 
-    if (!std::filesystem::exists(local_path)) {
-        return unexpected{error{error_code::file_not_found, "File not found: " + local_path.string()}};
+    auto reader = file_part_reader::open(local_path);
+    if (!reader.has_value()) {
+        return unexpected{reader.error()};
     }
+    auto file_size = reader.value().size();
 
-    auto file_size = std::filesystem::file_size(local_path);
-
-    std::ifstream file(local_path, std::ios::binary);
-    if (!file) {
-        return unexpected{error{error_code::file_access_denied, "Cannot open file: " + local_path.string()}};
+    // Blobs below the block threshold go out as a single Put Blob
+    if (!impl_->config_.multipart.enabled || file_size < impl_->config_.multipart.threshold) {
+        std::vector<std::byte> data(file_size);
+        auto read_result = reader.value().read_at(0, data);
+        if (!read_result.has_value() || read_result.value() != file_size) {
+            return unexpected{error{error_code::file_read_error, "Failed to read file: " + local_path.string()}};
+        }
+        return upload(key, data, options);
     }
 
-    std::vector<std::byte> data(file_size);
-    file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(file_size));
+    // Larger blobs stream from disk block by block
+    auto start_time = std::chrono::steady_clock::now();
+    azure_blob_upload_stream stream(key, impl_->config_, impl_->credentials_, options,
+                                    impl_->http_client_);
 
-    if (!file) {
-        return unexpected{error{error_code::file_read_error, "Failed to read file: " + local_path.string()}};
+    auto stream_result = stream.impl_->upload_from_file(reader.value());
+    if (!stream_result.has_value()) {
+        (void)stream.abort();
+        impl_->update_error_stats();
+        return unexpected{stream_result.error()};
     }
 
-    return upload(key, data, options);
+    auto finalize_result = stream.finalize();
+    if (!finalize_result.has_value()) {
+        impl_->update_error_stats();
+        return unexpected{finalize_result.error()};
+    }
+
+    auto result = finalize_result.value();
+    result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time);
+
+    impl_->update_upload_stats(file_size);
+    return result;
 }
 
 auto azure_blob_storage::download(const std::string& key) -> result<std::vector<std::byte>> {
@@ -1281,6 +1414,37 @@ auto azure_blob_storage::download_file(
 
     auto start_time = std::chrono::steady_clock::now();
 
+    // Large blobs are fetched as concurrent ranged GETs written in place
+    const auto& parallel = impl_->config_.parallel_download;
+    if (parallel.enabled) {
+        auto metadata = get_metadata(key);
+        if (metadata.has_value() && metadata.value().size > 0 &&
+            metadata.value().size >= parallel.threshold) {
+            const auto& blob = metadata.value();
+            auto downloaded = download_ranges_to_file(
+                impl_->io,
+                [this, &key, &blob](const byte_range& range) {
+                    return impl_->get_blob_range(key, range, blob.etag);
+                },
+                blob.size, local_path, parallel,
+                impl_->config_.connection_pool_size, impl_->config_.retry);
+            if (!downloaded.has_value()) {
+                impl_->update_error_stats();
+                return unexpected{downloaded.error()};
+            }
+
+            impl_->update_download_stats(blob.size);
+
+            download_result result;
+            result.key = key;
+            result.bytes_downloaded = downloaded.value().bytes_written;
+            result.metadata = blob;
+            result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start_time);
+            return result;
+        }
+    }
+
     auto data_result = download(key);
     if (!data_result.has_value()) {
         return unexpected{data_result.error()};
@@ -1683,7 +1847,7 @@ auto azure_blob_storage::upload_async(
     const std::string& key,
     std::span<const std::byte> data,
     const cloud_transfer_options& options) -> std::future<result<upload_result>> {
-    return std::async(std::launch::async, [this, key, data = std::vector<std::byte>(data.begin(), data.end()), options]() {
+    return impl_->async_io.submit([this, key, data = std::vector<std::byte>(data.begin(), data.end()), options]() {
         return this->upload(key, data, options);
     });
 }
@@ -1692,14 +1856,14 @@ auto azure_blob_storage::upload_file_async(
     const std::filesystem::path& local_path,
     const std::string& key,
     const cloud_transfer_options& options) -> std::future<result<upload_result>> {
-    return std::async(std::launch::async, [this, local_path, key, options]() {
+    return impl_->async_io.submit([this, local_path, key, options]() {
         return this->upload_file(local_path, key, options);
     });
 }
 
 auto azure_blob_storage::download_async(
     const std::string& key) -> std::future<result<std::vector<std::byte>>> {
-    return std::async(std::launch::async, [this, key]() {
+    return impl_->async_io.submit([this, key]() {
         return this->download(key);
     });
 }
@@ -1707,7 +1871,7 @@ auto azure_blob_storage::download_async(
 auto azure_blob_storage::download_file_async(
     const std::string& key,
     const std::filesystem::path& local_path) -> std::future<result<download_result>> {
-    return std::async(std::launch::async, [this, key, local_path]() {
+    return impl_->async_io.submit([this, key, local_path]() {
         return this->download_file(key, local_path);
     });
 }
@@ -1730,7 +1894,8 @@ auto azure_blob_storage::create_download_stream(
     }
 
     return std::unique_ptr<cloud_download_stream>(
-        new azure_blob_download_stream(key, impl_->config_, impl_->credentials_));
+        new azure_blob_download_stream(key, impl_->config_, impl_->credentials_,
+                                       impl_->http_client_));
 }
 
 auto azure_blob_storage::generate_presigned_url(
@@ -1765,8 +1930,18 @@ auto azure_blob_storage::get_statistics() const -> cloud_storage_statistics {
         return {};
     }
 
-    std::lock_guard<std::mutex> lock(impl_->mutex_);
-    return impl_->stats_;
+    cloud_storage_statistics stats;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex_);
+        stats = impl_->stats_;
+    }
+
+    if (impl_->http_client_) {
+        auto pool = impl_->http_client_->pool_statistics();
+        stats.connection_pool_hits = pool.hits;
+        stats.connection_pool_misses = pool.misses;
+    }
+    return stats;
 }
 
 void azure_blob_storage::reset_statistics() {
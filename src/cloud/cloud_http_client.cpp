@@ -24,21 +24,57 @@ namespace kcenon::file_transfer {
 
 struct cloud_http_client::impl {
 #if KCENON_WITH_NETWORK_SYSTEM
-    std::shared_ptr<kcenon::network::core::http_client> client;
+    using network_client = kcenon::network::core::http_client;
+
+    // One network client per pooled connection, keyed by endpoint
+    std::unique_ptr<connection_pool<network_client>> pool;
 #endif
     bool available = false;
 
-    explicit impl(std::chrono::milliseconds timeout) {
+    impl(std::chrono::milliseconds timeout, const connection_pool_config& pool_config) {
 #if KCENON_WITH_NETWORK_SYSTEM
-        client = std::make_shared<kcenon::network::core::http_client>(timeout);
+        pool = std::make_unique<connection_pool<network_client>>(
+            pool_config,
+            [timeout](const std::string& /*endpoint*/) {
+                return std::make_shared<network_client>(timeout);
+            });
         available = true;
 #else
         (void)timeout;
+        (void)pool_config;
         available = false;
 #endif
     }
 
 #if KCENON_WITH_NETWORK_SYSTEM
+    /**
+     * @brief Run a request on a pooled connection to the URL's endpoint
+     *
+     * Connections that fail at the transport level are closed rather than
+     * returned to the pool.
+     */
+    template <typename Request>
+    auto execute(const std::string& url, const char* method, Request&& request)
+        -> result<http_response_base> {
+        if (!pool) {
+            return unexpected{error{error_code::internal_error,
+                "HTTP client not initialized"}};
+        }
+
+        auto lease = pool->acquire(cloud_utils::connection_endpoint(url));
+        if (!lease.has_value()) {
+            return unexpected{lease.error()};
+        }
+
+        auto response = request(*lease.value());
+        if (response.is_err()) {
+            lease.value().mark_broken();
+            return unexpected{error{error_code::internal_error,
+                std::string("HTTP ") + method + " request failed"}};
+        }
+        return convert_response(response.value());
+    }
+
     static auto convert_response(
         const kcenon::network::internal::http_response& resp) -> http_response_base {
         http_response_base result;
@@ -54,8 +90,9 @@ struct cloud_http_client::impl {
 // Constructor / Destructor
 // ============================================================================
 
-cloud_http_client::cloud_http_client(std::chrono::milliseconds timeout)
-    : impl_(std::make_unique<impl>(timeout)) {}
+cloud_http_client::cloud_http_client(std::chrono::milliseconds timeout,
+                                     const connection_pool_config& pool)
+    : impl_(std::make_unique<impl>(timeout, pool)) {}
 
 cloud_http_client::~cloud_http_client() = default;
 
@@ -73,17 +110,9 @@ auto cloud_http_client::get(
     const std::map<std::string, std::string>& headers)
     -> result<http_response_base> {
 #if KCENON_WITH_NETWORK_SYSTEM
-    if (!impl_->client) {
-        return unexpected{error{error_code::internal_error,
-            "HTTP client not initialized"}};
-    }
-
-    auto response = impl_->client->get(url, query, headers);
-    if (response.is_err()) {
-        return unexpected{error{error_code::internal_error,
-            "HTTP GET request failed"}};
-    }
-    return impl_->convert_response(response.value());
+    return impl_->execute(url, "GET", [&](impl::network_client& client) {
+        return client.get(url, query, headers);
+    });
 #else
     (void)url;
     (void)query;
@@ -99,17 +128,9 @@ auto cloud_http_client::post(
     const std::map<std::string, std::string>& headers)
     -> result<http_response_base> {
 #if KCENON_WITH_NETWORK_SYSTEM
-    if (!impl_->client) {
-        return unexpected{error{error_code::internal_error,
-            "HTTP client not initialized"}};
-    }
-
-    auto response = impl_->client->post(url, body, headers);
-    if (response.is_err()) {
-        return unexpected{error{error_code::internal_error,
-            "HTTP POST request failed"}};
-    }
-    return impl_->convert_response(response.value());
+    return impl_->execute(url, "POST", [&](impl::network_client& client) {
+        return client.post(url, body, headers);
+    });
 #else
     (void)url;
     (void)body;
@@ -125,17 +146,9 @@ auto cloud_http_client::post(
     const std::map<std::string, std::string>& headers)
     -> result<http_response_base> {
 #if KCENON_WITH_NETWORK_SYSTEM
-    if (!impl_->client) {
-        return unexpected{error{error_code::internal_error,
-            "HTTP client not initialized"}};
-    }
-
-    auto response = impl_->client->post(url, body, headers);
-    if (response.is_err()) {
-        return unexpected{error{error_code::internal_error,
-            "HTTP POST request failed"}};
-    }
-    return impl_->convert_response(response.value());
+    return impl_->execute(url, "POST", [&](impl::network_client& client) {
+        return client.post(url, body, headers);
+    });
 #else
     (void)url;
     (void)body;
@@ -151,17 +164,9 @@ auto cloud_http_client::put(
     const std::map<std::string, std::string>& headers)
     -> result<http_response_base> {
 #if KCENON_WITH_NETWORK_SYSTEM
-    if (!impl_->client) {
-        return unexpected{error{error_code::internal_error,
-            "HTTP client not initialized"}};
-    }
-
-    auto response = impl_->client->put(url, body, headers);
-    if (response.is_err()) {
-        return unexpected{error{error_code::internal_error,
-            "HTTP PUT request failed"}};
-    }
-    return impl_->convert_response(response.value());
+    return impl_->execute(url, "PUT", [&](impl::network_client& client) {
+        return client.put(url, body, headers);
+    });
 #else
     (void)url;
     (void)body;
@@ -185,17 +190,9 @@ auto cloud_http_client::del(
     const std::map<std::string, std::string>& headers)
     -> result<http_response_base> {
 #if KCENON_WITH_NETWORK_SYSTEM
-    if (!impl_->client) {
-        return unexpected{error{error_code::internal_error,
-            "HTTP client not initialized"}};
-    }
-
-    auto response = impl_->client->del(url, headers);
-    if (response.is_err()) {
-        return unexpected{error{error_code::internal_error,
-            "HTTP DELETE request failed"}};
-    }
-    return impl_->convert_response(response.value());
+    return impl_->execute(url, "DELETE", [&](impl::network_client& client) {
+        return client.del(url, headers);
+    });
 #else
     (void)url;
     (void)headers;
@@ -209,17 +206,9 @@ auto cloud_http_client::head(
     const std::map<std::string, std::string>& headers)
     -> result<http_response_base> {
 #if KCENON_WITH_NETWORK_SYSTEM
-    if (!impl_->client) {
-        return unexpected{error{error_code::internal_error,
-            "HTTP client not initialized"}};
-    }
-
-    auto response = impl_->client->head(url, headers);
-    if (response.is_err()) {
-        return unexpected{error{error_code::internal_error,
-            "HTTP HEAD request failed"}};
-    }
-    return impl_->convert_response(response.value());
+    return impl_->execute(url, "HEAD", [&](impl::network_client& client) {
+        return client.head(url, headers);
+    });
 #else
     (void)url;
     (void)headers;
@@ -236,6 +225,15 @@ auto cloud_http_client::is_available() const noexcept -> bool {
     return impl_->available;
 }
 
+auto cloud_http_client::pool_statistics() const -> connection_pool_statistics {
+#if KCENON_WITH_NETWORK_SYSTEM
+    if (impl_->pool) {
+        return impl_->pool->statistics();
+    }
+#endif
+    return {};
+}
+
 auto cloud_http_client::calculate_retry_delay(
     const cloud_retry_policy& policy,
     std::size_t attempt) -> std::chrono::milliseconds {
@@ -246,9 +244,10 @@ auto cloud_http_client::calculate_retry_delay(
 // Factory Function
 // ============================================================================
 
-auto make_cloud_http_client(std::chrono::milliseconds timeout)
+auto make_cloud_http_client(std::chrono::milliseconds timeout,
+                            const connection_pool_config& pool)
     -> std::shared_ptr<cloud_http_client> {
-    return std::make_shared<cloud_http_client>(timeout);
+    return std::make_shared<cloud_http_client>(timeout, pool);
 }
 
 }  // namespace kcenon::file_transfer
@@ -7,11 +7,26 @@
 #include "kcenon/file_transfer/cloud/cloud_utils.h"
 
 #include <algorithm>
+#include <cctype>
+#include <cerrno>
 #include <chrono>
+#include <deque>
 #include <iomanip>
 #include <random>
 #include <sstream>
 #include <unordered_map>
+#include <utility>
+
+#include <fcntl.h>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
 
 #ifdef FILE_TRANS_ENABLE_ENCRYPTION
 #include <openssl/evp.h>
@@ -458,4 +473,474 @@ auto is_retryable_status(int status_code,
     return false;
 }
 
+// ============================================================================
+// Connection Utilities
+// ============================================================================
+
+auto connection_endpoint(const std::string& url) -> std::string {
+    std::string scheme = "https";
+    std::string rest = url;
+
+    auto scheme_end = url.find("://");
+    if (scheme_end != std::string::npos) {
+        scheme = url.substr(0, scheme_end);
+        rest = url.substr(scheme_end + 3);
+    }
+
+    auto authority = rest.substr(0, rest.find_first_of("/?#"));
+    auto at = authority.rfind('@');
+    if (at != std::string::npos) {
+        authority = authority.substr(at + 1);
+    }
+
+    std::transform(scheme.begin(), scheme.end(), scheme.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    std::transform(authority.begin(), authority.end(), authority.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    // A colon after the closing bracket of an IPv6 literal starts the port
+    auto bracket = authority.rfind(']');
+    auto colon = authority.rfind(':');
+    bool has_port = colon != std::string::npos &&
+                    (bracket == std::string::npos || colon > bracket);
+    if (!has_port) {
+        authority += scheme == "http" ? ":80" : ":443";
+    }
+
+    return scheme + "://" + authority;
+}
+
+// ============================================================================
+// Streaming Upload Utilities
+// ============================================================================
+
+file_part_reader::file_part_reader(int fd, uint64_t size, std::filesystem::path path)
+    : fd_(fd), size_(size), path_(std::move(path)) {}
+
+auto file_part_reader::open(const std::filesystem::path& path) -> result<file_part_reader> {
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec)) {
+        return unexpected{error{error_code::file_not_found, "File not found: " + path.string()}};
+    }
+
+    auto size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return unexpected{error{error_code::file_access_denied,
+                                "Cannot stat file: " + path.string()}};
+    }
+
+#ifdef _WIN32
+    int fd = ::_wopen(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+    if (fd < 0) {
+        return unexpected{error{error_code::file_access_denied,
+                                "Cannot open file: " + path.string()}};
+    }
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+    (void)::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    return file_part_reader(fd, size, path);
+}
+
+file_part_reader::~file_part_reader() {
+    if (fd_ >= 0) {
+#ifdef _WIN32
+        ::_close(fd_);
+#else
+        ::close(fd_);
+#endif
+    }
+}
+
+file_part_reader::file_part_reader(file_part_reader&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1))
+    , size_(other.size_)
+    , path_(std::move(other.path_)) {}
+
+auto file_part_reader::operator=(file_part_reader&& other) noexcept -> file_part_reader& {
+    if (this != &other) {
+        file_part_reader discarded(std::move(*this));
+        fd_ = std::exchange(other.fd_, -1);
+        size_ = other.size_;
+        path_ = std::move(other.path_);
+    }
+    return *this;
+}
+
+auto file_part_reader::read_at(uint64_t offset, std::span<std::byte> buffer) const
+    -> result<std::size_t> {
+    std::size_t total = 0;
+    while (total < buffer.size()) {
+        auto* dest = buffer.data() + total;
+        auto remaining = buffer.size() - total;
+        auto position = offset + total;
+
+#ifdef _WIN32
+        auto handle = reinterpret_cast<HANDLE>(::_get_osfhandle(fd_));
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(position & 0xFFFFFFFFu);
+        overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+        DWORD read_bytes = 0;
+        auto request = static_cast<DWORD>(std::min<std::size_t>(remaining, 1u << 30));
+        if (!::ReadFile(handle, dest, request, &read_bytes, &overlapped)) {
+            if (::GetLastError() == ERROR_HANDLE_EOF) {
+                break;
+            }
+            return unexpected{error{error_code::file_read_error,
+                                    "Failed to read file: " + path_.string()}};
+        }
+        auto n = static_cast<std::size_t>(read_bytes);
+#else
+        auto n = ::pread(fd_, dest, remaining, static_cast<off_t>(position));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return unexpected{error{error_code::file_read_error,
+                                    "Failed to read file: " + path_.string()}};
+        }
+#endif
+        if (n == 0) {
+            break;  // End of file
+        }
+        total += static_cast<std::size_t>(n);
+    }
+    return total;
+}
+
+part_buffer_pool::part_buffer_pool(std::size_t buffer_size, std::size_t max_buffers)
+    : buffer_size_(buffer_size)
+    , max_buffers_(std::max<std::size_t>(max_buffers, 1))
+    , state_(std::make_shared<state>()) {}
+
+auto part_buffer_pool::acquire() -> pooled_buffer {
+    std::vector<std::byte> buffer;
+    {
+        std::unique_lock lock(state_->mutex);
+        state_->available.wait(lock, [this] { return state_->in_use < max_buffers_; });
+        ++state_->in_use;
+        state_->peak_in_use = std::max(state_->peak_in_use, state_->in_use);
+        if (!state_->free.empty()) {
+            buffer = std::move(state_->free.back());
+            state_->free.pop_back();
+        }
+    }
+
+    buffer.clear();
+    buffer.reserve(buffer_size_);
+
+    return pooled_buffer(
+        new std::vector<std::byte>(std::move(buffer)),
+        [weak = std::weak_ptr<state>(state_)](std::vector<std::byte>* released) {
+            std::unique_ptr<std::vector<std::byte>> owned(released);
+            if (auto pool = weak.lock()) {
+                {
+                    std::lock_guard lock(pool->mutex);
+                    pool->free.push_back(std::move(*owned));
+                    --pool->in_use;
+                }
+                pool->available.notify_one();
+            }
+        });
+}
+
+auto part_buffer_pool::in_use() const -> std::size_t {
+    std::lock_guard lock(state_->mutex);
+    return state_->in_use;
+}
+
+auto part_buffer_pool::peak_in_use() const -> std::size_t {
+    std::lock_guard lock(state_->mutex);
+    return state_->peak_in_use;
+}
+
+// ============================================================================
+// Parallel Download Utilities
+// ============================================================================
+
+namespace {
+
+// Transient failures worth another attempt of the same range
+auto is_retryable_range_error(error_code code) -> bool {
+    switch (code) {
+        case error_code::connection_failed:
+        case error_code::connection_timeout:
+        case error_code::connection_refused:
+        case error_code::connection_lost:
+        case error_code::internal_error:
+        case error_code::chunk_size_error:
+        case error_code::queue_full:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Completed range attempts, in completion order
+class range_completions {
+public:
+    auto push(std::size_t index, result<uint64_t> outcome) -> void {
+        {
+            std::lock_guard lock(mutex_);
+            done_.emplace_back(index, std::move(outcome));
+        }
+        ready_.notify_one();
+    }
+
+    auto pop() -> std::pair<std::size_t, result<uint64_t>> {
+        std::unique_lock lock(mutex_);
+        ready_.wait(lock, [this] { return !done_.empty(); });
+        auto entry = std::move(done_.front());
+        done_.pop_front();
+        return entry;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::pair<std::size_t, result<uint64_t>>> done_;
+};
+
+// Reports one range attempt exactly once; an attempt the executor drops
+// without running reports operation_cancelled on destruction
+class range_attempt {
+public:
+    range_attempt(std::shared_ptr<range_completions> sink, std::size_t index)
+        : sink_(std::move(sink)), index_(index) {}
+
+    ~range_attempt() {
+        if (sink_) {
+            sink_->push(index_, unexpected{error{error_code::operation_cancelled,
+                                                 "Range read was not started"}});
+        }
+    }
+
+    range_attempt(const range_attempt&) = delete;
+    auto operator=(const range_attempt&) -> range_attempt& = delete;
+
+    auto complete(result<uint64_t> outcome) -> void {
+        std::exchange(sink_, nullptr)->push(index_, std::move(outcome));
+    }
+
+private:
+    std::shared_ptr<range_completions> sink_;
+    std::size_t index_;
+};
+
+auto fetch_range_into(const range_reader& reader,
+                      const file_range_writer& writer,
+                      const byte_range& range) -> result<uint64_t> {
+    auto data = reader(range);
+    if (!data.has_value()) {
+        return unexpected{data.error()};
+    }
+    if (data.value().size() != range.length) {
+        return unexpected{error{error_code::chunk_size_error,
+            "Range at offset " + std::to_string(range.offset) + " returned " +
+            std::to_string(data.value().size()) + " of " +
+            std::to_string(range.length) + " bytes"}};
+    }
+
+    auto written = writer.write_at(range.offset, data.value());
+    if (!written.has_value()) {
+        return unexpected{written.error()};
+    }
+    return range.length;
+}
+
+}  // namespace
+
+auto split_byte_ranges(uint64_t total_size, uint64_t range_size) -> std::vector<byte_range> {
+    std::vector<byte_range> ranges;
+    if (total_size == 0) {
+        return ranges;
+    }
+    if (range_size == 0) {
+        range_size = total_size;
+    }
+
+    ranges.reserve(static_cast<std::size_t>((total_size + range_size - 1) / range_size));
+    for (uint64_t offset = 0; offset < total_size; offset += range_size) {
+        ranges.push_back({offset, std::min(range_size, total_size - offset)});
+    }
+    return ranges;
+}
+
+auto format_range_header(const byte_range& range) -> std::string {
+    return "bytes=" + std::to_string(range.offset) + "-" +
+           std::to_string(range.offset + range.length - 1);
+}
+
+file_range_writer::file_range_writer(int fd, std::filesystem::path path)
+    : fd_(fd), path_(std::move(path)) {}
+
+auto file_range_writer::create(const std::filesystem::path& path, uint64_t size)
+    -> result<file_range_writer> {
+    std::error_code ec;
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), ec);
+    }
+
+#ifdef _WIN32
+    int fd = ::_wopen(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+                      _S_IREAD | _S_IWRITE);
+#else
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+    if (fd < 0) {
+        return unexpected{error{error_code::file_access_denied,
+                                "Cannot create file: " + path.string()}};
+    }
+
+    file_range_writer writer(fd, path);
+
+    // Size the file up front so ranges can land in any order
+#ifdef _WIN32
+    bool sized = ::_chsize_s(fd, static_cast<long long>(size)) == 0;
+#else
+    bool sized = ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+#endif
+    if (!sized) {
+        return unexpected{error{error_code::file_write_error,
+                                "Cannot size file: " + path.string()}};
+    }
+    return writer;
+}
+
+file_range_writer::~file_range_writer() {
+    if (fd_ >= 0) {
+#ifdef _WIN32
+        ::_close(fd_);
+#else
+        ::close(fd_);
+#endif
+    }
+}
+
+file_range_writer::file_range_writer(file_range_writer&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1))
+    , path_(std::move(other.path_)) {}
+
+auto file_range_writer::operator=(file_range_writer&& other) noexcept -> file_range_writer& {
+    if (this != &other) {
+        file_range_writer discarded(std::move(*this));
+        fd_ = std::exchange(other.fd_, -1);
+        path_ = std::move(other.path_);
+    }
+    return *this;
+}
+
+auto file_range_writer::write_at(uint64_t offset, std::span<const std::byte> data) const
+    -> result<void> {
+    std::size_t total = 0;
+    while (total < data.size()) {
+        const auto* src = data.data() + total;
+        auto remaining = data.size() - total;
+        auto position = offset + total;
+
+#ifdef _WIN32
+        auto handle = reinterpret_cast<HANDLE>(::_get_osfhandle(fd_));
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(position & 0xFFFFFFFFu);
+        overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+        DWORD written = 0;
+        auto request = static_cast<DWORD>(std::min<std::size_t>(remaining, 1u << 30));
+        if (!::WriteFile(handle, src, request, &written, &overlapped)) {
+            return unexpected{error{error_code::file_write_error,
+                                    "Failed to write file: " + path_.string()}};
+        }
+        auto n = static_cast<std::size_t>(written);
+#else
+        auto n = ::pwrite(fd_, src, remaining, static_cast<off_t>(position));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return unexpected{error{error_code::file_write_error,
+                                    "Failed to write file: " + path_.string()}};
+        }
+#endif
+        total += static_cast<std::size_t>(n);
+    }
+    return result<void>{};
+}
+
+auto download_ranges_to_file(io_scope& io,
+                             const range_reader& reader,
+                             uint64_t object_size,
+                             const std::filesystem::path& local_path,
+                             const parallel_download_config& config,
+                             std::size_t max_concurrency,
+                             const cloud_retry_policy& retry)
+    -> result<parallel_download_result> {
+    auto ranges = split_byte_ranges(object_size, config.range_size);
+
+    std::optional<error> failure;
+    parallel_download_result stats;
+    stats.range_count = ranges.size();
+    {
+        auto writer = file_range_writer::create(local_path, object_size);
+        if (!writer.has_value()) {
+            return unexpected{writer.error()};
+        }
+
+        auto completions = std::make_shared<range_completions>();
+        std::deque<std::size_t> pending;
+        for (std::size_t i = 0; i < ranges.size(); ++i) {
+            pending.push_back(i);
+        }
+        std::vector<std::size_t> attempts(ranges.size(), 0);
+        std::size_t in_flight = 0;
+        const auto limit = std::max<std::size_t>(max_concurrency, 1);
+
+        auto launch = [&](std::size_t index, std::chrono::milliseconds delay) {
+            auto attempt = std::make_shared<range_attempt>(completions, index);
+            (void)io.submit_after(delay, [attempt, &reader, &writer, range = ranges[index]] {
+                attempt->complete(fetch_range_into(reader, writer.value(), range));
+            });
+            ++in_flight;
+        };
+
+        // Every launched attempt reports exactly once, so this drains all
+        // work before the writer and reader go out of scope
+        while (in_flight > 0 || (!failure && !pending.empty())) {
+            while (!failure && in_flight < limit && !pending.empty()) {
+                launch(pending.front(), std::chrono::milliseconds(0));
+                pending.pop_front();
+            }
+
+            auto [index, outcome] = completions->pop();
+            --in_flight;
+
+            if (outcome.has_value()) {
+                stats.bytes_written += outcome.value();
+                continue;
+            }
+            if (failure) {
+                continue;
+            }
+
+            if (is_retryable_range_error(outcome.error().code) &&
+                attempts[index] < config.max_range_retries) {
+                ++attempts[index];
+                ++stats.retried_ranges;
+                launch(index, calculate_retry_delay(retry, attempts[index]));
+                continue;
+            }
+            failure = outcome.error();
+        }
+    }
+
+    if (failure) {
+        std::error_code ec;
+        std::filesystem::remove(local_path, ec);
+        return unexpected{*failure};
+    }
+    return stats;
+}
+
 }  // namespace kcenon::file_transfer::cloud_utils
@@ -8,6 +8,7 @@
 #include "kcenon/file_transfer/cloud/cloud_http_client.h"
 #include "kcenon/file_transfer/cloud/cloud_utils.h"
 #include "kcenon/file_transfer/config/feature_flags.h"
+#include "kcenon/file_transfer/core/io_executor.h"
 
 #include <algorithm>
 #include <array>
@@ -44,6 +45,13 @@ using cloud_utils::generate_random_bytes;
 using cloud_utils::extract_json_value;
 using cloud_utils::detect_content_type;
 using cloud_utils::calculate_retry_delay;
+using cloud_utils::file_part_reader;
+using cloud_utils::part_buffer_pool;
+using cloud_utils::pooled_buffer;
+using cloud_utils::byte_range;
+using cloud_utils::range_reader;
+using cloud_utils::format_range_header;
+using cloud_utils::download_ranges_to_file;
 
 // ============================================================================
 // Real HTTP Client Adapter (uses unified cloud_http_client)
@@ -58,8 +66,9 @@ using cloud_utils::calculate_retry_delay;
  */
 class real_gcs_http_client : public gcs_http_client_interface {
 public:
-    explicit real_gcs_http_client(std::chrono::milliseconds timeout = std::chrono::milliseconds(30000))
-        : client_(make_cloud_http_client(timeout)) {}
+    explicit real_gcs_http_client(std::chrono::milliseconds timeout = std::chrono::milliseconds(30000),
+                                  const connection_pool_config& pool = {})
+        : client_(make_cloud_http_client(timeout, pool)) {}
 
     auto get(
         const std::string& url,
@@ -108,6 +117,10 @@ public:
         return convert_response(response.value());
     }
 
+    auto pool_statistics() const -> connection_pool_statistics override {
+        return client_->pool_statistics();
+    }
+
 private:
     static auto convert_response(const http_response_base& resp) -> gcs_http_response {
         gcs_http_response result;
@@ -229,6 +242,12 @@ auto parse_object_metadata(const std::string& json) -> cloud_object_metadata {
         metadata.etag = *etag;
     }
 
+    // The object generation identifies this version of the object
+    auto generation = extract_json_value(json, "generation");
+    if (generation) {
+        metadata.version_id = *generation;
+    }
+
     auto updated = extract_json_value(json, "updated");
     if (updated) {
         // Parse RFC 3339 timestamp
@@ -496,8 +515,11 @@ struct gcs_upload_stream::impl {
     std::shared_ptr<credential_provider> credentials;
     cloud_transfer_options options;
 
+    // At most max_concurrent_parts chunk buffers exist, in flight or being filled
+    part_buffer_pool buffers;
+
     std::string upload_id_;
-    std::vector<std::byte> buffer;
+    pooled_buffer buffer;  // Chunk being filled by write()
     uint64_t bytes_written_ = 0;
     uint64_t bytes_committed = 0;
     bool finalized = false;
@@ -514,37 +536,12 @@ struct gcs_upload_stream::impl {
          const gcs_config& cfg,
          std::shared_ptr<credential_provider> creds,
          const cloud_transfer_options& opts)
-        : object_name(name), config(cfg), credentials(std::move(creds)), options(opts) {
-        buffer.reserve(config.multipart.part_size);
+        : object_name(name), config(cfg), credentials(std::move(creds)), options(opts),
+          buffers(static_cast<std::size_t>(config.multipart.part_size),
+                  config.multipart.max_concurrent_parts) {
         upload_id_ = generate_upload_id();
     }
 
-    auto get_active_upload_count() -> std::size_t {
-        std::lock_guard<std::mutex> lock(pending_mutex);
-        std::size_t count = 0;
-        for (auto& pending : pending_uploads) {
-            if (pending.future.valid()) {
-                auto status = pending.future.wait_for(std::chrono::milliseconds(0));
-                if (status != std::future_status::ready) {
-                    ++count;
-                }
-            }
-        }
-        return count;
-    }
-
-    auto wait_for_slot() -> result<void> {
-        while (get_active_upload_count() >= config.multipart.max_concurrent_parts) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-
-            auto collect_result = collect_completed_uploads();
-            if (!collect_result.has_value()) {
-                return unexpected{collect_result.error()};
-            }
-        }
-        return result<void>{};
-    }
-
     auto collect_completed_uploads() -> result<void> {
         std::lock_guard<std::mutex> lock(pending_mutex);
 
@@ -584,13 +581,48 @@ struct gcs_upload_stream::impl {
         return result<void>{};
     }
 
-    auto upload_chunk_async(uint64_t offset, std::vector<std::byte> data) -> void {
-        auto future = std::async(std::launch::async, [this, offset, data = std::move(data)]() {
-            return this->upload_chunk(offset, std::span<const std::byte>(data));
+    auto upload_chunk_async(uint64_t offset, pooled_buffer data) -> void {
+        auto end_offset = offset + data->size();
+        auto future = io.submit([this, offset, data = std::move(data)]() {
+            return this->upload_chunk(offset, std::span<const std::byte>(*data));
         });
 
         std::lock_guard<std::mutex> lock(pending_mutex);
-        pending_uploads.push_back({offset + data.size(), std::move(future)});
+        pending_uploads.push_back({end_offset, std::move(future)});
+    }
+
+    /**
+     * @brief Upload a whole file as chunks read directly into pooled buffers
+     *
+     * Acquiring a buffer waits while max_concurrent_parts chunks are in
+     * flight, so memory stays bounded independent of the file size.
+     */
+    auto upload_from_file(const file_part_reader& reader) -> result<void> {
+        const auto chunk_size = static_cast<uint64_t>(buffers.buffer_size());
+
+        for (uint64_t offset = 0; offset < reader.size(); offset += chunk_size) {
+            auto collect_result = collect_completed_uploads();
+            if (!collect_result.has_value()) {
+                return collect_result;
+            }
+
+            auto length = static_cast<std::size_t>(std::min(chunk_size, reader.size() - offset));
+            auto chunk = buffers.acquire();
+            chunk->resize(length);
+
+            auto read_result = reader.read_at(offset, *chunk);
+            if (!read_result.has_value()) {
+                return unexpected{read_result.error()};
+            }
+            if (read_result.value() != length) {
+                return unexpected{error{error_code::file_read_error,
+                    "File was truncated during upload"}};
+            }
+
+            upload_chunk_async(offset, std::move(chunk));
+            bytes_written_ += length;
+        }
+        return result<void>{};
     }
 
     auto upload_chunk(uint64_t offset, std::span<const std::byte> data) -> result<void> {
@@ -614,6 +646,10 @@ struct gcs_upload_stream::impl {
 
         return result;
     }
+
+    // Part uploads share the storage lane; declared last so pending parts are
+    // cancelled or finished before the rest of the stream state goes away
+    io_scope io{"gcs/" + config.bucket};
 };
 
 gcs_upload_stream::gcs_upload_stream(
@@ -642,29 +678,28 @@ auto gcs_upload_stream::write(std::span<const std::byte> data) -> result<std::si
     std::size_t remaining = data.size();
 
     while (remaining > 0) {
-        std::size_t space_in_buffer = impl_->config.multipart.part_size - impl_->buffer.size();
+        // Waits for an in-flight chunk to finish when all buffers are in use
+        if (!impl_->buffer) {
+            impl_->buffer = impl_->buffers.acquire();
+        }
+        auto& chunk = *impl_->buffer;
+
+        std::size_t space_in_buffer = impl_->config.multipart.part_size - chunk.size();
         std::size_t to_copy = std::min(remaining, space_in_buffer);
 
-        impl_->buffer.insert(impl_->buffer.end(), ptr, ptr + to_copy);
+        chunk.insert(chunk.end(), ptr, ptr + to_copy);
         ptr += to_copy;
         remaining -= to_copy;
         bytes_processed += to_copy;
 
-        if (impl_->buffer.size() >= impl_->config.multipart.part_size) {
-            auto wait_result = impl_->wait_for_slot();
-            if (!wait_result.has_value()) {
-                return unexpected{wait_result.error()};
-            }
-
+        if (chunk.size() >= impl_->config.multipart.part_size) {
             auto collect_result = impl_->collect_completed_uploads();
             if (!collect_result.has_value()) {
                 return unexpected{collect_result.error()};
             }
 
-            std::vector<std::byte> chunk_data(impl_->buffer.begin(), impl_->buffer.end());
-            impl_->upload_chunk_async(impl_->bytes_written_, std::move(chunk_data));
-
-            impl_->buffer.clear();
+            auto chunk_offset = impl_->bytes_written_ + bytes_processed - chunk.size();
+            impl_->upload_chunk_async(chunk_offset, std::move(impl_->buffer));
         }
     }
 
@@ -686,10 +721,10 @@ auto gcs_upload_stream::finalize() -> result<upload_result> {
     }
 
     // Upload remaining data as final chunk
-    if (!impl_->buffer.empty()) {
+    if (impl_->buffer && !impl_->buffer->empty()) {
         auto result = impl_->upload_chunk(
-            impl_->bytes_written_ - impl_->buffer.size(),
-            std::span<const std::byte>(impl_->buffer));
+            impl_->bytes_written_ - impl_->buffer->size(),
+            std::span<const std::byte>(*impl_->buffer));
 
         if (!result.has_value()) {
             return unexpected{result.error()};
@@ -738,6 +773,9 @@ struct gcs_download_stream::impl {
     std::size_t buffer_pos = 0;
     bool initialized = false;
 
+    // Ranged GET through the owning gcs_storage, set by create_download_stream()
+    range_reader reader;
+
     impl(const std::string& name,
          const gcs_config& cfg,
          std::shared_ptr<credential_provider> creds)
@@ -747,14 +785,24 @@ struct gcs_download_stream::impl {
         metadata_.key = object_name;
         metadata_.size = 0;
         metadata_.content_type = detect_content_type(object_name);
-        initialized = true;
         return result<void>{};
     }
 
+    /**
+     * @brief Attach the object's metadata and a ranged reader
+     */
+    auto attach(const cloud_object_metadata& metadata, range_reader object_reader) -> void {
+        metadata_ = metadata;
+        total_size_ = metadata.size;
+        reader = std::move(object_reader);
+        initialized = true;
+    }
+
     auto fetch_range(uint64_t start, uint64_t end) -> result<std::vector<std::byte>> {
-        (void)start;
-        (void)end;
-        return std::vector<std::byte>{};
+        if (!reader) {
+            return unexpected{error{error_code::not_initialized, "Stream not initialized"}};
+        }
+        return reader(byte_range{start, end - start + 1});
     }
 };
 
@@ -776,7 +824,34 @@ auto gcs_download_stream::read(std::span<std::byte> buffer) -> result<std::size_
         return unexpected{error{error_code::not_initialized, "Stream not initialized"}};
     }
 
-    return 0;
+    if (impl_->bytes_read_ >= impl_->total_size_ || buffer.empty()) {
+        return 0;  // EOF
+    }
+
+    // Refill with one ranged GET of at least range_size bytes
+    if (impl_->buffer_pos >= impl_->buffer.size()) {
+        auto remaining = impl_->total_size_ - impl_->bytes_read_;
+        auto length = std::min<uint64_t>(
+            std::max<uint64_t>(impl_->config.parallel_download.range_size, buffer.size()),
+            remaining);
+
+        auto data = impl_->fetch_range(impl_->bytes_read_, impl_->bytes_read_ + length - 1);
+        if (!data.has_value()) {
+            return unexpected{data.error()};
+        }
+        if (data.value().empty()) {
+            return unexpected{error{error_code::chunk_size_error, "Empty range response"}};
+        }
+        impl_->buffer = std::move(data.value());
+        impl_->buffer_pos = 0;
+    }
+
+    auto available = impl_->buffer.size() - impl_->buffer_pos;
+    auto to_copy = std::min(available, buffer.size());
+    std::memcpy(buffer.data(), impl_->buffer.data() + impl_->buffer_pos, to_copy);
+    impl_->buffer_pos += to_copy;
+    impl_->bytes_read_ += to_copy;
+    return to_copy;
 }
 
 auto gcs_download_stream::has_more() const -> bool {
@@ -827,9 +902,12 @@ struct gcs_storage::impl {
 #if KCENON_WITH_NETWORK_SYSTEM
         if (!http_client_) {
             http_client_ = std::make_shared<real_gcs_http_client>(
-                std::chrono::milliseconds(30000));  // 30 second timeout
+                std::chrono::milliseconds(30000),  // 30 second timeout
+                make_connection_pool_config(config_));
         }
 #endif
+        io.set_concurrency_limit(config_.connection_pool_size);
+        async_io.set_blocking();
     }
 
     /**
@@ -978,6 +1056,71 @@ struct gcs_storage::impl {
         std::lock_guard<std::mutex> lock(mutex_);
         stats_.errors++;
     }
+
+    /**
+     * @brief Fetch one byte range of an object with a ranged media GET
+     * @param key Object name
+     * @param range Byte range to fetch
+     * @param generation Object generation; when set the GET fails if the object changed
+     */
+    auto get_object_range(const std::string& key,
+                          const byte_range& range,
+                          const std::optional<std::string>& generation)
+        -> result<std::vector<std::byte>> {
+#if KCENON_WITH_NETWORK_SYSTEM
+        auto auth_headers = get_auth_headers();
+        if (!auth_headers.has_value()) {
+            return unexpected{auth_headers.error()};
+        }
+
+        auto headers = auth_headers.value();
+        headers["Range"] = format_range_header(range);
+
+        std::string url = get_storage_endpoint() + "/storage/v1/b/" + config_.bucket +
+                          "/o/" + url_encode(key) + "?alt=media";
+        if (generation.has_value()) {
+            url += "&ifGenerationMatch=" + generation.value();
+        }
+
+        auto response = http_client_->get(url, {}, headers);
+        if (!response) {
+            return unexpected{error{error_code::connection_failed, "Ranged download request failed"}};
+        }
+
+        auto& resp = response.value();
+        if (resp.status_code == 404) {
+            return unexpected{error{error_code::file_not_found, "Object not found: " + key}};
+        }
+        if (resp.status_code == 412) {
+            return unexpected{error{error_code::file_hash_mismatch,
+                "Object changed during download: " + key}};
+        }
+
+        const auto* body = reinterpret_cast<const std::byte*>(resp.body.data());
+        if (resp.status_code == 206) {
+            return std::vector<std::byte>(body, body + resp.body.size());
+        }
+        if (resp.status_code == 200 && resp.body.size() >= range.offset + range.length) {
+            return std::vector<std::byte>(body + range.offset, body + range.offset + range.length);
+        }
+        return unexpected{error{error_code::internal_error,
+            "Ranged download failed with status " + std::to_string(resp.status_code)}};
+#else
+        (void)key;
+        (void)range;
+        (void)generation;
+        return unexpected{error{error_code::not_initialized, "HTTP client not initialized"}};
+#endif
+    }
+
+    // Part uploads and ranged reads; declared late so queued work is
+    // cancelled and running work finishes before the rest of the state is
+    // destroyed
+    io_scope io{"gcs/" + config_.bucket};
+
+    // The *_async calls wait on the parts and ranges they start on io, so
+    // they run on a blocking lane and never hold the workers those need
+    io_scope async_io{"gcs/" + config_.bucket + "/async"};
 };
 
 gcs_storage::gcs_storage(
@@ -1198,25 +1341,45 @@ auto gcs_storage::upload_file(
         return unexpected{error{error_code::not_initialized, "Not connected"}};
     }
 
-    if (!std::filesystem::exists(local_path)) {
-        return unexpected{error{error_code::file_not_found, "File not found: " + local_path.string()}};
+    auto reader = file_part_reader::open(local_path);
+    if (!reader.has_value()) {
+        return unexpected{reader.error()};
     }
+    auto file_size = reader.value().size();
 
-    auto file_size = std::filesystem::file_size(local_path);
-
-    std::ifstream file(local_path, std::ios::binary);
-    if (!file) {
-        return unexpected{error{error_code::file_access_denied, "Cannot open file: " + local_path.string()}};
+    // Objects below the resumable threshold go out as a single media upload
+    if (!impl_->config_.multipart.enabled || file_size < impl_->config_.multipart.threshold) {
+        std::vector<std::byte> data(file_size);
+        auto read_result = reader.value().read_at(0, data);
+        if (!read_result.has_value() || read_result.value() != file_size) {
+            return unexpected{error{error_code::file_read_error, "Failed to read file: " + local_path.string()}};
+        }
+        return upload(key, data, options);
     }
 
-    std::vector<std::byte> data(file_size);
-    file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(file_size));
+    // Larger objects stream from disk chunk by chunk
+    auto start_time = std::chrono::steady_clock::now();
+    gcs_upload_stream stream(key, impl_->config_, impl_->credentials_, options);
 
-    if (!file) {
-        return unexpected{error{error_code::file_read_error, "Failed to read file: " + local_path.string()}};
+    auto stream_result = stream.impl_->upload_from_file(reader.value());
+    if (!stream_result.has_value()) {
+        (void)stream.abort();
+        impl_->update_error_stats();
+        return unexpected{stream_result.error()};
+    }
+
+    auto finalize_result = stream.finalize();
+    if (!finalize_result.has_value()) {
+        impl_->update_error_stats();
+        return unexpected{finalize_result.error()};
     }
 
-    return upload(key, data, options);
+    auto result = finalize_result.value();
+    result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time);
+
+    impl_->update_upload_stats(file_size);
+    return result;
 }
 
 auto gcs_storage::download(const std::string& key) -> result<std::vector<std::byte>> {
@@ -1284,6 +1447,37 @@ auto gcs_storage::download_file(
 
     auto start_time = std::chrono::steady_clock::now();
 
+    // Large objects are fetched as concurrent ranged GETs written in place
+    const auto& parallel = impl_->config_.parallel_download;
+    if (parallel.enabled) {
+        auto metadata = get_metadata(key);
+        if (metadata.has_value() && metadata.value().size > 0 &&
+            metadata.value().size >= parallel.threshold) {
+            const auto& object = metadata.value();
+            auto downloaded = download_ranges_to_file(
+                impl_->io,
+                [this, &key, &object](const byte_range& range) {
+                    return impl_->get_object_range(key, range, object.version_id);
+                },
+                object.size, local_path, parallel,
+                impl_->config_.connection_pool_size, impl_->config_.retry);
+            if (!downloaded.has_value()) {
+                impl_->update_error_stats();
+                return unexpected{downloaded.error()};
+            }
+
+            impl_->update_download_stats(object.size);
+
+            download_result result;
+            result.key = key;
+            result.bytes_downloaded = downloaded.value().bytes_written;
+            result.metadata = object;
+            result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start_time);
+            return result;
+        }
+    }
+
     auto data_result = download(key);
     if (!data_result.has_value()) {
         return unexpected{data_result.error()};
@@ -1668,7 +1862,7 @@ auto gcs_storage::upload_async(
     const std::string& key,
     std::span<const std::byte> data,
     const cloud_transfer_options& options) -> std::future<result<upload_result>> {
-    return std::async(std::launch::async, [this, key, data = std::vector<std::byte>(data.begin(), data.end()), options]() {
+    return impl_->async_io.submit([this, key, data = std::vector<std::byte>(data.begin(), data.end()), options]() {
         return this->upload(key, data, options);
     });
 }
@@ -1677,14 +1871,14 @@ auto gcs_storage::upload_file_async(
     const std::filesystem::path& local_path,
     const std::string& key,
     const cloud_transfer_options& options) -> std::future<result<upload_result>> {
-    return std::async(std::launch::async, [this, local_path, key, options]() {
+    return impl_->async_io.submit([this, local_path, key, options]() {
         return this->upload_file(local_path, key, options);
     });
 }
 
 auto gcs_storage::download_async(
     const std::string& key) -> std::future<result<std::vector<std::byte>>> {
-    return std::async(std::launch::async, [this, key]() {
+    return impl_->async_io.submit([this, key]() {
         return this->download(key);
     });
 }
@@ -1692,7 +1886,7 @@ auto gcs_storage::download_async(
 auto gcs_storage::download_file_async(
     const std::string& key,
     const std::filesystem::path& local_path) -> std::future<result<download_result>> {
-    return std::async(std::launch::async, [this, key, local_path]() {
+    return impl_->async_io.submit([this, key, local_path]() {
         return this->download_file(key, local_path);
     });
 }
@@ -1714,8 +1908,19 @@ auto gcs_storage::create_download_stream(
         return nullptr;
     }
 
-    return std::unique_ptr<cloud_download_stream>(
+    auto stream = std::unique_ptr<gcs_download_stream>(
         new gcs_download_stream(key, impl_->config_, impl_->credentials_));
+
+    auto metadata = get_metadata(key);
+    if (!metadata.has_value()) {
+        return nullptr;
+    }
+
+    auto generation = metadata.value().version_id;
+    stream->impl_->attach(metadata.value(), [this, key, generation](const byte_range& range) {
+        return impl_->get_object_range(key, range, generation);
+    });
+    return stream;
 }
 
 auto gcs_storage::generate_presigned_url(
@@ -1750,8 +1955,18 @@ auto gcs_storage::get_statistics() const -> cloud_storage_statistics {
         return {};
     }
 
-    std::lock_guard<std::mutex> lock(impl_->mutex_);
-    return impl_->stats_;
+    cloud_storage_statistics stats;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex_);
+        stats = impl_->stats_;
+    }
+
+    if (impl_->http_client_) {
+        auto pool = impl_->http_client_->pool_statistics();
+        stats.connection_pool_hits = pool.hits;
+        stats.connection_pool_misses = pool.misses;
+    }
+    return stats;
 }
 
 void gcs_storage::reset_statistics() {
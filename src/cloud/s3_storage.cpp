@@ -5,8 +5,10 @@
  */
 
 #include "kcenon/file_transfer/cloud/s3_storage.h"
+#include "kcenon/file_transfer/cloud/cloud_http_client.h"
 #include "kcenon/file_transfer/cloud/cloud_utils.h"
 #include "kcenon/file_transfer/config/feature_flags.h"
+#include "kcenon/file_transfer/core/io_executor.h"
 
 #include <algorithm>
 #include <array>
@@ -21,11 +23,6 @@
 #include <sstream>
 #include <thread>
 
-// HTTP client integration enabled (see #147, #148)
-#if KCENON_WITH_NETWORK_SYSTEM
-#include <kcenon/network/core/http_client.h>
-#endif
-
 namespace kcenon::file_transfer {
 
 // Import cloud utilities
@@ -41,6 +38,13 @@ using cloud_utils::extract_xml_element;
 using cloud_utils::calculate_retry_delay;
 using cloud_utils::is_retryable_status;
 using cloud_utils::detect_content_type;
+using cloud_utils::file_part_reader;
+using cloud_utils::part_buffer_pool;
+using cloud_utils::pooled_buffer;
+using cloud_utils::byte_range;
+using cloud_utils::range_reader;
+using cloud_utils::format_range_header;
+using cloud_utils::download_ranges_to_file;
 
 namespace {
 
@@ -133,17 +137,21 @@ struct s3_upload_stream::impl {
     std::shared_ptr<credential_provider> credentials;
     cloud_transfer_options options;
 
+    // At most max_concurrent_parts part buffers exist, in flight or being filled
+    part_buffer_pool buffers;
+
     std::string upload_id_;
     std::vector<std::pair<int, std::string>> completed_parts;  // part_number, etag
     int current_part_number = 1;
-    std::vector<std::byte> part_buffer;
+    pooled_buffer part_buffer;  // Part being filled by write()
     uint64_t bytes_written_ = 0;
     bool finalized = false;
     bool aborted = false;
     bool initialized = false;
 
 #if KCENON_WITH_NETWORK_SYSTEM
-    std::shared_ptr<kcenon::network::core::http_client> http_client_;
+    // Pooled transfer client shared with the storage and its other streams
+    std::shared_ptr<cloud_http_client> http_client_;
 #endif
 
     // Concurrent uploads support
@@ -157,15 +165,21 @@ struct s3_upload_stream::impl {
     impl(const std::string& k,
          const s3_config& cfg,
          std::shared_ptr<credential_provider> creds,
-         const cloud_transfer_options& opts)
-        : key(k), config(cfg), credentials(std::move(creds)), options(opts) {
-        part_buffer.reserve(config.multipart.part_size);
+         const cloud_transfer_options& opts,
+         std::shared_ptr<cloud_http_client> http_client)
+        : key(k), config(cfg), credentials(std::move(creds)), options(opts),
+          buffers(static_cast<std::size_t>(config.multipart.part_size),
+                  config.multipart.max_concurrent_parts) {
 #if KCENON_WITH_NETWORK_SYSTEM
+        http_client_ = std::move(http_client);
         // Only initialize HTTP client when a custom endpoint is configured
-        if (config.endpoint.has_value()) {
-            http_client_ = std::make_shared<kcenon::network::core::http_client>(
-                std::chrono::milliseconds(300000));  // 5 minute timeout for uploads
+        if (!http_client_ && config.endpoint.has_value()) {
+            http_client_ = make_cloud_http_client(
+                std::chrono::milliseconds(300000),  // 5 minute timeout for uploads
+                make_connection_pool_config(config));
         }
+#else
+        (void)http_client;
 #endif
     }
 
@@ -274,34 +288,6 @@ struct s3_upload_stream::impl {
 #endif
     }
 
-    auto get_active_upload_count() -> std::size_t {
-        std::lock_guard<std::mutex> lock(pending_mutex);
-        std::size_t count = 0;
-        for (auto& pending : pending_uploads) {
-            if (pending.future.valid()) {
-                auto status = pending.future.wait_for(std::chrono::milliseconds(0));
-                if (status != std::future_status::ready) {
-                    ++count;
-                }
-            }
-        }
-        return count;
-    }
-
-    auto wait_for_slot() -> result<void> {
-        while (get_active_upload_count() >= config.multipart.max_concurrent_parts) {
-            // Wait for any pending upload to complete
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-
-            // Check for completed uploads and collect results
-            auto collect_result = collect_completed_uploads();
-            if (!collect_result.has_value()) {
-                return unexpected{collect_result.error()};
-            }
-        }
-        return result<void>{};
-    }
-
     auto collect_completed_uploads() -> result<void> {
         std::lock_guard<std::mutex> lock(pending_mutex);
 
@@ -342,15 +328,49 @@ struct s3_upload_stream::impl {
         return result<void>{};
     }
 
-    auto upload_part_async(int part_number, std::vector<std::byte> data) -> void {
-        auto future = std::async(std::launch::async, [this, part_number, data = std::move(data)]() {
-            return this->upload_part(part_number, std::span<const std::byte>(data));
+    auto upload_part_async(int part_number, pooled_buffer data) -> void {
+        auto future = io.submit([this, part_number, data = std::move(data)]() {
+            return this->upload_part(part_number, std::span<const std::byte>(*data));
         });
 
         std::lock_guard<std::mutex> lock(pending_mutex);
         pending_uploads.push_back({part_number, std::move(future)});
     }
 
+    /**
+     * @brief Upload a whole file as parts read directly into pooled buffers
+     *
+     * Acquiring a buffer waits while max_concurrent_parts parts are in
+     * flight, so memory stays bounded independent of the file size.
+     */
+    auto upload_from_file(const file_part_reader& reader) -> result<void> {
+        const auto part_size = static_cast<uint64_t>(buffers.buffer_size());
+
+        for (uint64_t offset = 0; offset < reader.size(); offset += part_size) {
+            auto collect_result = collect_completed_uploads();
+            if (!collect_result.has_value()) {
+                return collect_result;
+            }
+
+            auto length = static_cast<std::size_t>(std::min(part_size, reader.size() - offset));
+            auto part = buffers.acquire();
+            part->resize(length);
+
+            auto read_result = reader.read_at(offset, *part);
+            if (!read_result.has_value()) {
+                return unexpected{read_result.error()};
+            }
+            if (read_result.value() != length) {
+                return unexpected{error{error_code::file_read_error,
+                    "File was truncated during upload"}};
+            }
+
+            upload_part_async(current_part_number++, std::move(part));
+            bytes_written_ += length;
+        }
+        return result<void>{};
+    }
+
     auto initiate_multipart_upload() -> result<std::string> {
 #if KCENON_WITH_NETWORK_SYSTEM
         if (http_client_) {
@@ -378,7 +398,7 @@ struct s3_upload_stream::impl {
 
             // Send POST request
             auto response = http_client_->post(url, std::string{}, headers);
-            if (response.is_ok()) {
+            if (response.has_value()) {
                 auto& resp = response.value();
                 if (resp.status_code == 200) {
                     // Parse UploadId from XML response
@@ -436,7 +456,7 @@ struct s3_upload_stream::impl {
 
             // Send PUT request
             auto response = http_client_->put(url, body_str, headers);
-            if (response.is_ok()) {
+            if (response.has_value()) {
                 auto& resp = response.value();
                 if (resp.status_code == 200) {
                     // Get ETag from response headers
@@ -493,7 +513,7 @@ struct s3_upload_stream::impl {
 
             // Send POST request
             auto response = http_client_->post(url, xml_body, headers);
-            if (response.is_ok()) {
+            if (response.has_value()) {
                 auto& resp = response.value();
                 if (resp.status_code == 200) {
                     // Parse response
@@ -571,7 +591,7 @@ struct s3_upload_stream::impl {
         std::string url = build_s3_url(host, config.use_ssl, path, query);
 
         // Send DELETE request
-        auto response = http_client_->del(url, headers);
+        (void)http_client_->del(url, headers);
         // Ignore response - abort is best effort
 
         aborted = true;
@@ -581,14 +601,20 @@ struct s3_upload_stream::impl {
         return result<void>{};
 #endif
     }
+
+    // Part uploads share the storage lane; declared last so pending parts are
+    // cancelled or finished before the rest of the stream state goes away
+    io_scope io{"s3/" + config.bucket};
 };
 
 s3_upload_stream::s3_upload_stream(
     const std::string& key,
     const s3_config& config,
     std::shared_ptr<credential_provider> credentials,
-    const cloud_transfer_options& options)
-    : impl_(std::make_unique<impl>(key, config, std::move(credentials), options)) {
+    const cloud_transfer_options& options,
+    std::shared_ptr<cloud_http_client> http_client)
+    : impl_(std::make_unique<impl>(key, config, std::move(credentials), options,
+                                   std::move(http_client))) {
     // Initiate multipart upload
     impl_->initiate_multipart_upload();
 }
@@ -617,35 +643,31 @@ auto s3_upload_stream::write(std::span<const std::byte> data) -> result<std::siz
     std::size_t remaining = data.size();
 
     while (remaining > 0) {
-        std::size_t space_in_buffer = impl_->config.multipart.part_size - impl_->part_buffer.size();
+        // Waits for an in-flight part to finish when all buffers are in use
+        if (!impl_->part_buffer) {
+            impl_->part_buffer = impl_->buffers.acquire();
+        }
+        auto& part = *impl_->part_buffer;
+
+        std::size_t space_in_buffer = impl_->config.multipart.part_size - part.size();
         std::size_t to_copy = std::min(remaining, space_in_buffer);
 
-        impl_->part_buffer.insert(impl_->part_buffer.end(), ptr, ptr + to_copy);
+        part.insert(part.end(), ptr, ptr + to_copy);
         ptr += to_copy;
         remaining -= to_copy;
         bytes_processed += to_copy;
 
         // Upload part if buffer is full
-        if (impl_->part_buffer.size() >= impl_->config.multipart.part_size) {
-            // Wait for a slot if max concurrent uploads reached
-            auto wait_result = impl_->wait_for_slot();
-            if (!wait_result.has_value()) {
-                return unexpected{wait_result.error()};
-            }
-
+        if (part.size() >= impl_->config.multipart.part_size) {
             // Collect any completed uploads
             auto collect_result = impl_->collect_completed_uploads();
             if (!collect_result.has_value()) {
                 return unexpected{collect_result.error()};
             }
 
-            // Start async upload
-            int part_num = impl_->current_part_number;
-            std::vector<std::byte> part_data(impl_->part_buffer.begin(), impl_->part_buffer.end());
-            impl_->upload_part_async(part_num, std::move(part_data));
-
+            // Hand the buffer to the async upload; it returns to the pool afterwards
+            impl_->upload_part_async(impl_->current_part_number, std::move(impl_->part_buffer));
             impl_->current_part_number++;
-            impl_->part_buffer.clear();
         }
     }
 
@@ -667,10 +689,10 @@ auto s3_upload_stream::finalize() -> result<upload_result> {
     }
 
     // Upload remaining data as final part
-    if (!impl_->part_buffer.empty()) {
+    if (impl_->part_buffer && !impl_->part_buffer->empty()) {
         auto result = impl_->upload_part(
             impl_->current_part_number,
-            std::span<const std::byte>(impl_->part_buffer));
+            std::span<const std::byte>(*impl_->part_buffer));
 
         if (!result.has_value()) {
             // Try to abort on failure
@@ -732,25 +754,36 @@ struct s3_download_stream::impl {
     std::size_t buffer_pos = 0;
     bool initialized = false;
 
+    // Ranged GET through the owning s3_storage, set by create_download_stream()
+    range_reader reader;
+
     impl(const std::string& k,
          const s3_config& cfg,
          std::shared_ptr<credential_provider> creds)
         : key(k), config(cfg), credentials(std::move(creds)) {}
 
     auto initialize() -> result<void> {
-        // TODO: Implement HEAD request to get object metadata
-        // HEAD /{bucket}/{key}
         metadata_.key = key;
-        metadata_.size = 0;  // Will be set from response
+        metadata_.size = 0;
         metadata_.content_type = detect_content_type(key);
-        initialized = true;
         return result<void>{};
     }
 
+    /**
+     * @brief Attach the object's metadata (from HEAD) and a ranged reader
+     */
+    auto attach(const cloud_object_metadata& metadata, range_reader object_reader) -> void {
+        metadata_ = metadata;
+        total_size_ = metadata.size;
+        reader = std::move(object_reader);
+        initialized = true;
+    }
+
     auto fetch_range(uint64_t start, uint64_t end) -> result<std::vector<std::byte>> {
-        // TODO: Implement GET request with Range header
-        // GET /{bucket}/{key} with Range: bytes={start}-{end}
-        return std::vector<std::byte>{};
+        if (!reader) {
+            return unexpected{error{error_code::not_initialized, "Stream not initialized"}};
+        }
+        return reader(byte_range{start, end - start + 1});
     }
 };
 
@@ -772,8 +805,35 @@ auto s3_download_stream::read(std::span<std::byte> buffer) -> result<std::size_t
         return unexpected{error{error_code::not_initialized, "Stream not initialized"}};
     }
 
-    // TODO: Implement actual streaming download
-    return 0;
+    if (impl_->bytes_read_ >= impl_->total_size_ || buffer.empty()) {
+        return 0;  // EOF
+    }
+
+    // Refill with one ranged GET of at least range_size bytes, so small reads
+    // do not turn into one request each
+    if (impl_->buffer_pos >= impl_->buffer.size()) {
+        auto remaining = impl_->total_size_ - impl_->bytes_read_;
+        auto length = std::min<uint64_t>(
+            std::max<uint64_t>(impl_->config.parallel_download.range_size, buffer.size()),
+            remaining);
+
+        auto data = impl_->fetch_range(impl_->bytes_read_, impl_->bytes_read_ + length - 1);
+        if (!data.has_value()) {
+            return unexpected{data.error()};
+        }
+        if (data.value().empty()) {
+            return unexpected{error{error_code::chunk_size_error, "Empty range response"}};
+        }
+        impl_->buffer = std::move(data.value());
+        impl_->buffer_pos = 0;
+    }
+
+    auto available = impl_->buffer.size() - impl_->buffer_pos;
+    auto to_copy = std::min(available, buffer.size());
+    std::memcpy(buffer.data(), impl_->buffer.data() + impl_->buffer_pos, to_copy);
+    impl_->buffer_pos += to_copy;
+    impl_->bytes_read_ += to_copy;
+    return to_copy;
 }
 
 auto s3_download_stream::has_more() const -> bool {
@@ -804,7 +864,11 @@ struct s3_storage::impl {
     cloud_storage_statistics stats_;
 
 #if KCENON_WITH_NETWORK_SYSTEM
-    std::shared_ptr<kcenon::network::core::http_client> http_client_;
+    std::shared_ptr<cloud_http_client> http_client_;
+
+    // Long-timeout client for multipart parts, shared by every upload stream
+    // so parallel parts reuse warm pooled connections
+    std::shared_ptr<cloud_http_client> transfer_client_;
 #endif
 
     std::function<void(const upload_progress&)> upload_progress_callback_;
@@ -822,9 +886,42 @@ struct s3_storage::impl {
         // For standard AWS S3 without custom endpoint, use simulation mode
         // to avoid network dependencies in unit tests.
         if (config_.endpoint.has_value()) {
-            http_client_ = std::make_shared<kcenon::network::core::http_client>(
-                std::chrono::milliseconds(30000));  // 30 second timeout
+            auto pool = make_connection_pool_config(config_);
+            http_client_ = make_cloud_http_client(
+                std::chrono::milliseconds(30000), pool);  // 30 second timeout
+            transfer_client_ = make_cloud_http_client(
+                std::chrono::milliseconds(300000), pool);  // 5 minute timeout for uploads
         }
+#endif
+        io.set_concurrency_limit(config_.connection_pool_size);
+        async_io.set_blocking();
+    }
+
+    /**
+     * @brief Client for multipart part uploads (nullptr in simulation builds)
+     */
+    auto upload_client() const -> std::shared_ptr<cloud_http_client> {
+#if KCENON_WITH_NETWORK_SYSTEM
+        return transfer_client_;
+#else
+        return nullptr;
+#endif
+    }
+
+    /**
+     * @brief Add the connection pool counters of both clients to stats
+     */
+    void add_pool_statistics(cloud_storage_statistics& stats) const {
+#if KCENON_WITH_NETWORK_SYSTEM
+        for (const auto* client : {http_client_.get(), transfer_client_.get()}) {
+            if (client) {
+                auto pool = client->pool_statistics();
+                stats.connection_pool_hits += pool.hits;
+                stats.connection_pool_misses += pool.misses;
+            }
+        }
+#else
+        (void)stats;
 #endif
     }
 
@@ -975,9 +1072,9 @@ struct s3_storage::impl {
         const std::string& method,
         const std::string& path,
         const std::string& query_string,
-        const std::vector<std::byte>& body,
+        std::span<const std::byte> body,
         const std::map<std::string, std::string>& extra_headers = {})
-        -> result<kcenon::network::internal::http_response> {
+        -> result<http_response_base> {
 
         if (!http_client_) {
             return unexpected{error{error_code::not_initialized, "HTTP client not initialized"}};
@@ -987,7 +1084,7 @@ struct s3_storage::impl {
         std::string amz_date = get_iso8601_time();
         std::string payload_hash = body.empty() ?
             bytes_to_hex(sha256("")) :
-            bytes_to_hex(sha256_bytes(std::span<const std::byte>(body)));
+            bytes_to_hex(sha256_bytes(body));
 
         // Build headers
         std::map<std::string, std::string> headers;
@@ -1014,27 +1111,30 @@ struct s3_storage::impl {
         // Build full URL
         std::string url = build_s3_url(host, config_.use_ssl, path, query_string);
 
-        // Convert body to uint8_t vector for http_client
-        std::vector<uint8_t> body_uint8(body.size());
-        std::memcpy(body_uint8.data(), body.data(), body.size());
-
         // Helper lambda to handle response
-        auto handle_response = [](kcenon::network::Result<kcenon::network::internal::http_response>&& response)
-            -> result<kcenon::network::internal::http_response> {
-            if (response.is_err()) {
-                return unexpected{error{error_code::connection_failed, "HTTP request failed"}};
+        auto handle_response = [](result<http_response_base>&& response)
+            -> result<http_response_base> {
+            if (!response.has_value()) {
+                // An exhausted connection pool keeps its timeout code
+                auto code = response.error().code == error_code::connection_timeout
+                    ? error_code::connection_timeout
+                    : error_code::connection_failed;
+                return unexpected{error{code, "HTTP request failed: " + response.error().message}};
             }
-            return response.value();
+            return std::move(response.value());
         };
 
         // Send request based on method
         if (method == "GET") {
             return handle_response(http_client_->get(url, {}, headers));
         } else if (method == "PUT") {
-            std::string body_str(reinterpret_cast<const char*>(body_uint8.data()), body_uint8.size());
+            // Single copy into the representation the HTTP client takes
+            std::string body_str(reinterpret_cast<const char*>(body.data()), body.size());
             return handle_response(http_client_->put(url, body_str, headers));
         } else if (method == "POST") {
-            return handle_response(http_client_->post(url, body_uint8, headers));
+            auto* first = reinterpret_cast<const uint8_t*>(body.data());
+            return handle_response(http_client_->post(
+                url, std::vector<uint8_t>(first, first + body.size()), headers));
         } else if (method == "DELETE") {
             return handle_response(http_client_->del(url, headers));
         } else if (method == "HEAD") {
@@ -1044,6 +1144,63 @@ struct s3_storage::impl {
         }
     }
 #endif
+
+    /**
+     * @brief Fetch one byte range of an object with a ranged GET
+     * @param key Object key
+     * @param range Byte range to fetch
+     * @param etag ETag from HEAD; when set the GET fails if the object changed
+     */
+    auto get_object_range(const std::string& key,
+                          const byte_range& range,
+                          const std::string& etag) -> result<std::vector<std::byte>> {
+#if KCENON_WITH_NETWORK_SYSTEM
+        std::map<std::string, std::string> headers;
+        headers["Range"] = format_range_header(range);
+        if (!etag.empty()) {
+            headers["If-Match"] = etag;
+        }
+
+        auto response = send_request("GET", get_path(key), "", {}, headers);
+        if (!response.has_value()) {
+            return unexpected{response.error()};
+        }
+
+        auto& resp = response.value();
+        if (resp.status_code == 404) {
+            return unexpected{error{error_code::file_not_found, "Object not found: " + key}};
+        }
+        if (resp.status_code == 412) {
+            return unexpected{error{error_code::file_hash_mismatch,
+                "Object changed during download: " + key}};
+        }
+
+        const auto* body = reinterpret_cast<const std::byte*>(resp.body.data());
+        if (resp.status_code == 206) {
+            return std::vector<std::byte>(body, body + resp.body.size());
+        }
+        // A server that ignores Range answers 200 with the whole object
+        if (resp.status_code == 200 && resp.body.size() >= range.offset + range.length) {
+            return std::vector<std::byte>(body + range.offset, body + range.offset + range.length);
+        }
+        return unexpected{error{error_code::internal_error,
+            "S3 ranged GetObject failed with status " + std::to_string(resp.status_code)}};
+#else
+        (void)key;
+        (void)range;
+        (void)etag;
+        return unexpected{error{error_code::not_initialized, "HTTP client not initialized"}};
+#endif
+    }
+
+    // Part uploads and ranged reads; declared late so queued work is
+    // cancelled and running work finishes before the rest of the state is
+    // destroyed
+    io_scope io{"s3/" + config_.bucket};
+
+    // The *_async calls wait on the parts and ranges they start on io, so
+    // they run on a blocking lane and never hold the workers those need
+    io_scope async_io{"s3/" + config_.bucket + "/async"};
 };
 
 s3_storage::s3_storage(
@@ -1201,8 +1358,7 @@ auto s3_storage::upload(
     std::map<std::string, std::string> extra_headers;
     extra_headers["Content-Type"] = detect_content_type(key);
 
-    std::vector<std::byte> body_vec(data.begin(), data.end());
-    auto response = impl_->send_request("PUT", path, "", body_vec, extra_headers);
+    auto response = impl_->send_request("PUT", path, "", data, extra_headers);
     if (response.has_value()) {
         auto& resp = response.value();
         if (resp.status_code != 200 && resp.status_code != 201) {
@@ -1249,26 +1405,45 @@ auto s3_storage::upload_file(
         return unexpected{error{error_code::not_initialized, "Not connected"}};
     }
 
-    if (!std::filesystem::exists(local_path)) {
-        return unexpected{error{error_code::file_not_found, "File not found: " + local_path.string()}};
+    auto reader = file_part_reader::open(local_path);
+    if (!reader.has_value()) {
+        return unexpected{reader.error()};
     }
+    auto file_size = reader.value().size();
 
-    auto file_size = std::filesystem::file_size(local_path);
-
-    // Read file content
-    std::ifstream file(local_path, std::ios::binary);
-    if (!file) {
-        return unexpected{error{error_code::file_access_denied, "Cannot open file: " + local_path.string()}};
+    // Objects below the multipart threshold go out as a single PUT
+    if (!impl_->config_.multipart.enabled || file_size < impl_->config_.multipart.threshold) {
+        std::vector<std::byte> data(file_size);
+        auto read_result = reader.value().read_at(0, data);
+        if (!read_result.has_value() || read_result.value() != file_size) {
+            return unexpected{error{error_code::file_read_error, "Failed to read file: " + local_path.string()}};
+        }
+        return upload(key, data, options);
     }
 
-    std::vector<std::byte> data(file_size);
-    file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(file_size));
+    // Larger objects stream from disk part by part
+    auto start_time = std::chrono::steady_clock::now();
+    s3_upload_stream stream(key, impl_->config_, impl_->credentials_, options);
+
+    auto stream_result = stream.impl_->upload_from_file(reader.value());
+    if (!stream_result.has_value()) {
+        (void)stream.abort();
+        impl_->update_error_stats();
+        return unexpected{stream_result.error()};
+    }
 
-    if (!file) {
-        return unexpected{error{error_code::file_read_error, "Failed to read file: " + local_path.string()}};
+    auto finalize_result = stream.finalize();
+    if (!finalize_result.has_value()) {
+        impl_->update_error_stats();
+        return unexpected{finalize_result.error()};
     }
 
-    return upload(key, data, options);
+    auto result = finalize_result.value();
+    result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time);
+
+    impl_->update_upload_stats(file_size);
+    return result;
 }
 
 auto s3_storage::download(const std::string& key) -> result<std::vector<std::byte>> {
@@ -1318,6 +1493,37 @@ auto s3_storage::download_file(
 
     auto start_time = std::chrono::steady_clock::now();
 
+    // Large objects are fetched as concurrent ranged GETs written in place
+    const auto& parallel = impl_->config_.parallel_download;
+    if (parallel.enabled) {
+        auto metadata = get_metadata(key);
+        if (metadata.has_value() && metadata.value().size > 0 &&
+            metadata.value().size >= parallel.threshold) {
+            const auto& object = metadata.value();
+            auto downloaded = download_ranges_to_file(
+                impl_->io,
+                [this, &key, &object](const byte_range& range) {
+                    return impl_->get_object_range(key, range, object.etag);
+                },
+                object.size, local_path, parallel,
+                impl_->config_.connection_pool_size, impl_->config_.retry);
+            if (!downloaded.has_value()) {
+                impl_->update_error_stats();
+                return unexpected{downloaded.error()};
+            }
+
+            impl_->update_download_stats(object.size);
+
+            download_result result;
+            result.key = key;
+            result.bytes_downloaded = downloaded.value().bytes_written;
+            result.metadata = object;
+            result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start_time);
+            return result;
+        }
+    }
+
     auto data_result = download(key);
     if (!data_result.has_value()) {
         return unexpected{data_result.error()};
@@ -1723,7 +1929,7 @@ auto s3_storage::upload_async(
     const std::string& key,
     std::span<const std::byte> data,
     const cloud_transfer_options& options) -> std::future<result<upload_result>> {
-    return std::async(std::launch::async, [this, key, data = std::vector<std::byte>(data.begin(), data.end()), options]() {
+    return impl_->async_io.submit([this, key, data = std::vector<std::byte>(data.begin(), data.end()), options]() {
         return this->upload(key, data, options);
     });
 }
@@ -1732,14 +1938,14 @@ auto s3_storage::upload_file_async(
     const std::filesystem::path& local_path,
     const std::string& key,
     const cloud_transfer_options& options) -> std::future<result<upload_result>> {
-    return std::async(std::launch::async, [this, local_path, key, options]() {
+    return impl_->async_io.submit([this, local_path, key, options]() {
         return this->upload_file(local_path, key, options);
     });
 }
 
 auto s3_storage::download_async(
     const std::string& key) -> std::future<result<std::vector<std::byte>>> {
-    return std::async(std::launch::async, [this, key]() {
+    return impl_->async_io.submit([this, key]() {
         return this->download(key);
     });
 }
@@ -1747,7 +1953,7 @@ auto s3_storage::download_async(
 auto s3_storage::download_file_async(
     const std::string& key,
     const std::filesystem::path& local_path) -> std::future<result<download_result>> {
-    return std::async(std::launch::async, [this, key, local_path]() {
+    return impl_->async_io.submit([this, key, local_path]() {
         return this->download_file(key, local_path);
     });
 }
@@ -1760,7 +1966,8 @@ auto s3_storage::create_upload_stream(
     }
 
     return std::unique_ptr<cloud_upload_stream>(
-        new s3_upload_stream(key, impl_->config_, impl_->credentials_, options));
+        new s3_upload_stream(key, impl_->config_, impl_->credentials_, options,
+                             impl_->upload_client()));
 }
 
 auto s3_storage::create_download_stream(
@@ -1769,8 +1976,19 @@ auto s3_storage::create_download_stream(
         return nullptr;
     }
 
-    return std::unique_ptr<cloud_download_stream>(
+    auto stream = std::unique_ptr<s3_download_stream>(
         new s3_download_stream(key, impl_->config_, impl_->credentials_));
+
+    auto metadata = get_metadata(key);
+    if (!metadata.has_value()) {
+        return nullptr;
+    }
+
+    auto etag = metadata.value().etag;
+    stream->impl_->attach(metadata.value(), [this, key, etag](const byte_range& range) {
+        return impl_->get_object_range(key, range, etag);
+    });
+    return stream;
 }
 
 auto s3_storage::generate_presigned_url(
@@ -1946,8 +2164,14 @@ auto s3_storage::get_statistics() const -> cloud_storage_statistics {
         return {};
     }
 
-    std::lock_guard<std::mutex> lock(impl_->mutex_);
-    return impl_->stats_;
+    cloud_storage_statistics stats;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex_);
+        stats = impl_->stats_;
+    }
+
+    impl_->add_pool_statistics(stats);
+    return stats;
 }
 
 void s3_storage::reset_statistics() {
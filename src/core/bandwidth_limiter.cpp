@@ -11,6 +11,33 @@
 
 namespace kcenon::file_transfer {
 
+namespace {
+
+// Upper bound between async retries, so disable()/destruction is noticed quickly
+constexpr auto max_async_retry_interval = std::chrono::milliseconds(50);
+
+}  // namespace
+
+/**
+ * @brief Promise of an acquire_async call
+ *
+ * Completes on destruction, so a retry dropped at shutdown (or rejected by a
+ * full executor queue) releases the caller instead of breaking the promise.
+ */
+struct bandwidth_limiter::async_waiter {
+    std::promise<void> promise;
+    bool completed = false;
+
+    auto complete() -> void {
+        if (!completed) {
+            completed = true;
+            promise.set_value();
+        }
+    }
+
+    ~async_waiter() { complete(); }
+};
+
 bandwidth_limiter::bandwidth_limiter(std::size_t bytes_per_second)
     : bytes_per_second_(bytes_per_second)
     , enabled_(bytes_per_second > 0)
@@ -116,7 +143,34 @@ auto bandwidth_limiter::try_acquire(std::size_t bytes) -> bool {
 }
 
 auto bandwidth_limiter::acquire_async(std::size_t bytes) -> std::future<void> {
-    return std::async(std::launch::async, [this, bytes] { acquire(bytes); });
+    auto waiter = std::make_shared<async_waiter>();
+    auto future = waiter->promise.get_future();
+    acquire_or_reschedule(std::move(waiter), bytes);
+    return future;
+}
+
+auto bandwidth_limiter::acquire_or_reschedule(std::shared_ptr<async_waiter> waiter,
+                                              std::size_t bytes) -> void {
+    auto wait_time = std::chrono::microseconds::zero();
+    if (bytes > 0 && enabled_.load(std::memory_order_relaxed)) {
+        std::lock_guard lock(mutex_);
+        refill_tokens();
+        wait_time = calculate_wait_time(bytes);
+        if (wait_time <= std::chrono::microseconds::zero()) {
+            tokens_ -= static_cast<double>(bytes);
+        }
+    }
+
+    if (wait_time <= std::chrono::microseconds::zero()) {
+        waiter->complete();
+        return;
+    }
+
+    auto delay = std::clamp<std::chrono::steady_clock::duration>(
+        wait_time, std::chrono::milliseconds(1), max_async_retry_interval);
+    (void)async_scope_.submit_after(delay, [this, waiter = std::move(waiter), bytes]() mutable {
+        acquire_or_reschedule(std::move(waiter), bytes);
+    });
 }
 
 auto bandwidth_limiter::set_limit(std::size_t bytes_per_second) -> void {
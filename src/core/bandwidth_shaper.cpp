@@ -0,0 +1,394 @@
+/**
+ * @file bandwidth_shaper.cpp
+ * @brief Hierarchical, non-blocking bandwidth shaping
+ */
+
+#include "kcenon/file_transfer/core/bandwidth_shaper.h"
+
+#include "kcenon/file_transfer/core/io_executor.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace kcenon::file_transfer {
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr int64_t tick_ns = 1'000'000;  // 1ms wheel resolution
+constexpr std::size_t wheel_slots = 256;
+
+// GCRA bucket: tat is the time (ns since the shaper's epoch) at which the
+// bucket would be empty again. It admits while tat is at most burst ahead
+// of now, then pushes tat forward by the cost of the request.
+struct bucket {
+    std::atomic<int64_t> tat{0};
+    std::atomic<uint64_t> rate{0};  // bytes/sec; 0 = no limit
+
+    static auto cost(std::size_t bytes, uint64_t r) -> int64_t {
+        return static_cast<int64_t>(static_cast<double>(bytes) * 1e9 / static_cast<double>(r));
+    }
+
+    // Returns 0 if taken, otherwise the ns until the bucket would admit
+    auto try_take(int64_t now, int64_t burst, std::size_t bytes) -> int64_t {
+        auto r = rate.load(std::memory_order_relaxed);
+        if (r == 0) {
+            return 0;
+        }
+        auto c = cost(bytes, r);
+        auto t = tat.load(std::memory_order_relaxed);
+        for (;;) {
+            if (t - now > burst) {
+                return t - now - burst;
+            }
+            if (tat.compare_exchange_weak(t, std::max(t, now) + c, std::memory_order_acq_rel,
+                                          std::memory_order_relaxed)) {
+                return 0;
+            }
+        }
+    }
+
+    // Charge unconditionally; the bucket may go into debt
+    void charge(int64_t now, std::size_t bytes) {
+        auto r = rate.load(std::memory_order_relaxed);
+        if (r == 0) {
+            return;
+        }
+        auto c = cost(bytes, r);
+        auto t = tat.load(std::memory_order_relaxed);
+        while (!tat.compare_exchange_weak(t, std::max(t, now) + c, std::memory_order_acq_rel,
+                                          std::memory_order_relaxed)) {
+        }
+    }
+
+    void refund(std::size_t bytes) {
+        auto r = rate.load(std::memory_order_relaxed);
+        if (r != 0) {
+            tat.fetch_sub(cost(bytes, r), std::memory_order_acq_rel);
+        }
+    }
+};
+
+struct shaper_node {
+    bucket assured;  // Guaranteed rate
+    bucket ceiling;  // Hard cap
+    std::shared_ptr<shaper_node> parent;
+
+    explicit shaper_node(std::shared_ptr<shaper_node> p = nullptr) : parent(std::move(p)) {}
+
+    void apply(const shaper_limits& limits) {
+        assured.rate.store(limits.rate, std::memory_order_relaxed);
+        ceiling.rate.store(limits.ceil, std::memory_order_relaxed);
+    }
+};
+
+struct parked_acquire {
+    std::shared_ptr<shaper_node> leaf;
+    std::size_t bytes = 0;
+    bandwidth_shaper::ready_callback ready;
+    int64_t due_tick = 0;
+};
+
+}  // namespace
+
+struct bandwidth_shaper::impl {
+    clock_type::time_point epoch = clock_type::now();
+    int64_t burst_ns;
+    std::shared_ptr<shaper_node> root = std::make_shared<shaper_node>();
+
+    mutable std::shared_mutex nodes_mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<shaper_node>> tenants;
+    std::unordered_map<transfer_id, std::shared_ptr<shaper_node>> transfers;
+
+    std::atomic<uint64_t> granted{0};
+    std::atomic<uint64_t> borrowed{0};
+    std::atomic<uint64_t> parked{0};
+    std::atomic<uint64_t> released{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> granted_bytes{0};
+
+    std::mutex wheel_mutex;
+    std::array<std::vector<parked_acquire>, wheel_slots> wheel;
+    int64_t wheel_tick = 0;   // Last tick processed
+    std::size_t waiting = 0;
+    bool armed = false;       // An advance() is scheduled
+
+    // Wheel ticks; declared last so they end before the wheel
+    io_scope timer_scope{"bandwidth"};
+
+    explicit impl(std::chrono::milliseconds burst)
+        : burst_ns(std::chrono::duration_cast<std::chrono::nanoseconds>(burst).count()) {
+        wheel_tick = now_ns() / tick_ns;
+    }
+
+    auto now_ns() const -> int64_t {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - epoch)
+            .count();
+    }
+
+    // Walk from the leaf towards the root. A node within its guaranteed
+    // rate ends the walk: the send is charged to all ancestors even if that
+    // puts them in debt. Otherwise the node must be under its ceiling and
+    // the request goes on to borrow from the parent. Returns 0 if granted,
+    // otherwise the ns until a retry may succeed.
+    auto take(shaper_node* leaf, std::size_t bytes, int64_t now, bool& over_rate) -> int64_t {
+        std::array<shaper_node*, 3> capped{};
+        std::size_t count = 0;
+        auto assured_wait = std::numeric_limits<int64_t>::max();
+
+        for (auto* n = leaf; n != nullptr; n = n->parent.get()) {
+            if (n->assured.rate.load(std::memory_order_relaxed) > 0) {
+                auto wait = n->assured.try_take(now, burst_ns, bytes);
+                if (wait == 0) {
+                    n->ceiling.charge(now, bytes);
+                    for (auto* a = n->parent.get(); a != nullptr; a = a->parent.get()) {
+                        a->assured.charge(now, bytes);
+                        a->ceiling.charge(now, bytes);
+                    }
+                    return 0;
+                }
+                assured_wait = std::min(assured_wait, wait);
+                over_rate = true;
+            }
+
+            auto wait = n->ceiling.try_take(now, burst_ns, bytes);
+            if (wait > 0) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    capped[i]->ceiling.refund(bytes);
+                }
+                return std::min(wait, assured_wait);
+            }
+            if (count < capped.size()) {
+                capped[count++] = n;
+            }
+        }
+        return 0;
+    }
+
+    auto leaf_of(const path& p) const -> std::shared_ptr<shaper_node> {
+        if (p.leaf_) {
+            return std::static_pointer_cast<shaper_node>(p.leaf_);
+        }
+        return root;
+    }
+
+    auto lookup(uint64_t tenant, const transfer_id& id) const -> std::shared_ptr<shaper_node> {
+        std::shared_lock lock(nodes_mutex);
+        if (auto it = transfers.find(id); it != transfers.end()) {
+            return it->second;
+        }
+        if (auto it = tenants.find(tenant); it != tenants.end()) {
+            return it->second;
+        }
+        return root;
+    }
+
+    // Caller must hold nodes_mutex exclusively
+    auto tenant_node(uint64_t tenant) -> std::shared_ptr<shaper_node> {
+        auto& node = tenants[tenant];
+        if (!node) {
+            node = std::make_shared<shaper_node>(root);
+        }
+        return node;
+    }
+
+    auto acquire(const std::shared_ptr<shaper_node>& leaf, std::size_t bytes,
+                 ready_callback* on_ready) -> bool {
+        if (bytes == 0) {
+            return true;
+        }
+        auto now = now_ns();
+        bool over_rate = false;
+        auto wait = take(leaf.get(), bytes, now, over_rate);
+        if (wait == 0) {
+            granted.fetch_add(1, std::memory_order_relaxed);
+            granted_bytes.fetch_add(bytes, std::memory_order_relaxed);
+            if (over_rate) {
+                borrowed.fetch_add(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+        if (on_ready) {
+            parked.fetch_add(1, std::memory_order_relaxed);
+            park(parked_acquire{leaf, bytes, std::move(*on_ready), 0}, now + wait);
+        }
+        return false;
+    }
+
+    void park(parked_acquire entry, int64_t due_ns) {
+        std::lock_guard lock(wheel_mutex);
+        entry.due_tick = std::max((due_ns + tick_ns - 1) / tick_ns, wheel_tick + 1);
+        auto slot = static_cast<std::size_t>(entry.due_tick) % wheel_slots;
+        wheel[slot].push_back(std::move(entry));
+        ++waiting;
+        if (!armed) {
+            arm_locked();
+        }
+    }
+
+    // Caller must hold wheel_mutex
+    void arm_locked() {
+        armed = true;
+        auto next = timer_scope.submit_after(std::chrono::nanoseconds(tick_ns),
+                                             [this] { advance(); });
+        // advance() needs the lock we hold, so a future that is already
+        // ready means the executor rejected the tick
+        if (next.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            armed = false;
+        }
+    }
+
+    // Retry every acquire whose tick has come, then re-arm while any wait
+    void advance() {
+        std::vector<parked_acquire> due;
+        {
+            std::lock_guard lock(wheel_mutex);
+            auto now_tick = now_ns() / tick_ns;
+            auto steps = std::min<int64_t>(now_tick - wheel_tick, wheel_slots);
+            for (int64_t i = 1; i <= steps; ++i) {
+                auto& slot = wheel[static_cast<std::size_t>(wheel_tick + i) % wheel_slots];
+                auto split = std::stable_partition(
+                    slot.begin(), slot.end(),
+                    [now_tick](const parked_acquire& e) { return e.due_tick > now_tick; });
+                std::move(split, slot.end(), std::back_inserter(due));
+                slot.erase(split, slot.end());
+            }
+            wheel_tick = std::max(wheel_tick, now_tick);
+            waiting -= due.size();
+        }
+
+        for (auto& entry : due) {
+            auto now = now_ns();
+            bool over_rate = false;
+            auto wait = take(entry.leaf.get(), entry.bytes, now, over_rate);
+            if (wait > 0) {
+                park(std::move(entry), now + wait);
+                continue;
+            }
+            released.fetch_add(1, std::memory_order_relaxed);
+            granted_bytes.fetch_add(entry.bytes, std::memory_order_relaxed);
+            entry.ready();
+        }
+
+        std::lock_guard lock(wheel_mutex);
+        armed = false;
+        if (waiting > 0) {
+            arm_locked();
+        }
+    }
+
+    auto take_all() -> std::vector<parked_acquire> {
+        std::vector<parked_acquire> all;
+        std::lock_guard lock(wheel_mutex);
+        all.reserve(waiting);
+        for (auto& slot : wheel) {
+            std::move(slot.begin(), slot.end(), std::back_inserter(all));
+            slot.clear();
+        }
+        waiting = 0;
+        return all;
+    }
+};
+
+bandwidth_shaper::bandwidth_shaper(std::size_t global_limit, std::chrono::milliseconds burst)
+    : impl_(std::make_unique<impl>(burst)) {
+    impl_->root->ceiling.rate.store(global_limit, std::memory_order_relaxed);
+}
+
+bandwidth_shaper::~bandwidth_shaper() {
+    // Stop the ticks first so no callback runs while the wheel goes away
+    impl_->timer_scope.cancel();
+    impl_->timer_scope.wait();
+}
+
+auto bandwidth_shaper::set_global_limit(std::size_t bytes_per_second) -> void {
+    impl_->root->ceiling.rate.store(bytes_per_second, std::memory_order_relaxed);
+}
+
+auto bandwidth_shaper::global_limit() const -> std::size_t {
+    return impl_->root->ceiling.rate.load(std::memory_order_relaxed);
+}
+
+auto bandwidth_shaper::set_tenant_limits(uint64_t tenant, shaper_limits limits) -> void {
+    std::unique_lock lock(impl_->nodes_mutex);
+    impl_->tenant_node(tenant)->apply(limits);
+}
+
+auto bandwidth_shaper::set_transfer_limits(uint64_t tenant, const transfer_id& id,
+                                           shaper_limits limits) -> void {
+    std::unique_lock lock(impl_->nodes_mutex);
+    auto parent = impl_->tenant_node(tenant);
+    auto& node = impl_->transfers[id];
+    if (!node || node->parent != parent) {
+        node = std::make_shared<shaper_node>(parent);
+    }
+    node->apply(limits);
+}
+
+auto bandwidth_shaper::remove_transfer(const transfer_id& id) -> void {
+    std::unique_lock lock(impl_->nodes_mutex);
+    impl_->transfers.erase(id);
+}
+
+auto bandwidth_shaper::resolve(uint64_t tenant, const transfer_id& id) const -> path {
+    path p;
+    p.leaf_ = impl_->lookup(tenant, id);
+    return p;
+}
+
+auto bandwidth_shaper::try_acquire(uint64_t tenant, const transfer_id& id, std::size_t bytes)
+    -> bool {
+    return impl_->acquire(impl_->lookup(tenant, id), bytes, nullptr);
+}
+
+auto bandwidth_shaper::try_acquire(const path& p, std::size_t bytes) -> bool {
+    return impl_->acquire(impl_->leaf_of(p), bytes, nullptr);
+}
+
+auto bandwidth_shaper::acquire_or_park(uint64_t tenant, const transfer_id& id,
+                                       std::size_t bytes, ready_callback on_ready) -> bool {
+    return impl_->acquire(impl_->lookup(tenant, id), bytes, &on_ready);
+}
+
+auto bandwidth_shaper::acquire_or_park(const path& p, std::size_t bytes,
+                                       ready_callback on_ready) -> bool {
+    return impl_->acquire(impl_->leaf_of(p), bytes, &on_ready);
+}
+
+auto bandwidth_shaper::release_parked() -> void {
+    for (auto& entry : impl_->take_all()) {
+        impl_->released.fetch_add(1, std::memory_order_relaxed);
+        impl_->granted_bytes.fetch_add(entry.bytes, std::memory_order_relaxed);
+        entry.ready();
+    }
+}
+
+auto bandwidth_shaper::drop_parked() -> void {
+    auto dropped = impl_->take_all();
+    impl_->dropped.fetch_add(dropped.size(), std::memory_order_relaxed);
+}
+
+auto bandwidth_shaper::stats() const -> shaper_stats {
+    shaper_stats s;
+    s.granted = impl_->granted.load(std::memory_order_relaxed);
+    s.borrowed = impl_->borrowed.load(std::memory_order_relaxed);
+    s.parked = impl_->parked.load(std::memory_order_relaxed);
+    s.released = impl_->released.load(std::memory_order_relaxed);
+    s.dropped = impl_->dropped.load(std::memory_order_relaxed);
+    s.granted_bytes = impl_->granted_bytes.load(std::memory_order_relaxed);
+    {
+        std::lock_guard lock(impl_->wheel_mutex);
+        s.waiting = impl_->waiting;
+    }
+    return s;
+}
+
+}  // namespace kcenon::file_transfer
@@ -5,11 +5,27 @@
 
 #include <kcenon/file_transfer/core/checksum.h>
 
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstring>
 #include <fstream>
 #include <iomanip>
+#include <numbers>
 #include <sstream>
+#include <vector>
+
+#ifdef FILE_TRANS_ENABLE_XXHASH
+#include <xxhash.h>
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define FILE_TRANS_CRC32C_SSE42 1
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define FILE_TRANS_CRC32C_ARM 1
+#endif
 
 namespace kcenon::file_transfer {
 
@@ -18,15 +34,21 @@ namespace {
 // CRC32 polynomial (IEEE 802.3)
 constexpr uint32_t CRC32_POLYNOMIAL = 0xEDB88320;
 
+// CRC32C polynomial (Castagnoli)
+constexpr uint32_t CRC32C_POLYNOMIAL = 0x82F63B78;
+
+using crc_table = std::array<uint32_t, 256>;
+using crc_slices = std::array<crc_table, 8>;
+
 // Generate CRC32 lookup table at compile time
-constexpr auto generate_crc32_table() -> std::array<uint32_t, 256> {
-    std::array<uint32_t, 256> table{};
+constexpr auto generate_crc32_table(uint32_t polynomial) -> crc_table {
+    crc_table table{};
 
     for (uint32_t i = 0; i < 256; ++i) {
         uint32_t crc = i;
         for (int j = 0; j < 8; ++j) {
             if (crc & 1) {
-                crc = (crc >> 1) ^ CRC32_POLYNOMIAL;
+                crc = (crc >> 1) ^ polynomial;
             } else {
                 crc >>= 1;
             }
@@ -37,8 +59,157 @@ constexpr auto generate_crc32_table() -> std::array<uint32_t, 256> {
     return table;
 }
 
-// CRC32 lookup table (generated at compile time)
-constexpr auto CRC32_TABLE = generate_crc32_table();
+// Slicing-by-8 tables: entry k of table t is the CRC of byte k followed by t zero bytes
+constexpr auto generate_crc32_slices(uint32_t polynomial) -> crc_slices {
+    crc_slices tables{};
+    tables[0] = generate_crc32_table(polynomial);
+    for (std::size_t t = 1; t < tables.size(); ++t) {
+        for (std::size_t i = 0; i < 256; ++i) {
+            auto prev = tables[t - 1][i];
+            tables[t][i] = tables[0][prev & 0xFF] ^ (prev >> 8);
+        }
+    }
+    return tables;
+}
+
+// CRC lookup tables (generated at compile time)
+constexpr auto CRC32_SLICES = generate_crc32_slices(CRC32_POLYNOMIAL);
+constexpr auto CRC32C_SLICES = generate_crc32_slices(CRC32C_POLYNOMIAL);
+
+// Fold eight message bytes into the running CRC at once
+inline auto crc32_step8(const crc_slices& t, uint32_t crc, const uint8_t* p) -> uint32_t {
+    crc ^= static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    return t[7][crc & 0xFF] ^ t[6][(crc >> 8) & 0xFF] ^ t[5][(crc >> 16) & 0xFF] ^
+           t[4][crc >> 24] ^ t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+}
+
+inline auto crc32_step1(const crc_slices& t, uint32_t crc, uint8_t b) -> uint32_t {
+    return t[0][(crc ^ b) & 0xFF] ^ (crc >> 8);
+}
+
+// Four sub-histograms, so a run of equal bytes does not serialise on one
+// counter's load-increment-store
+using byte_counts = std::array<std::array<uint32_t, 256>, 4>;
+
+inline void count8(byte_counts& counts, const uint8_t* p) {
+    ++counts[0][p[0]];
+    ++counts[1][p[1]];
+    ++counts[2][p[2]];
+    ++counts[3][p[3]];
+    ++counts[0][p[4]];
+    ++counts[1][p[5]];
+    ++counts[2][p[6]];
+    ++counts[3][p[7]];
+}
+
+// Table-driven CRC over n bytes, counting them too when counts is given
+template <bool Count>
+auto crc32_sweep(const crc_slices& t, uint32_t crc, const uint8_t* p, std::size_t n,
+                 byte_counts* counts) -> uint32_t {
+    for (; n >= 8; p += 8, n -= 8) {
+        crc = crc32_step8(t, crc, p);
+        if constexpr (Count) {
+            count8(*counts, p);
+        }
+    }
+    for (; n > 0; ++p, --n) {
+        crc = crc32_step1(t, crc, *p);
+        if constexpr (Count) {
+            ++(*counts)[0][*p];
+        }
+    }
+    return crc;
+}
+
+// CRC32C instructions: SSE4.2 is checked at runtime, ARMv8 CRC at compile time
+#if defined(FILE_TRANS_CRC32C_SSE42)
+__attribute__((target("sse4.2")))
+inline auto crc32c_hw_step8(uint32_t crc, const uint8_t* p) -> uint32_t {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return static_cast<uint32_t>(_mm_crc32_u64(crc, word));
+}
+
+__attribute__((target("sse4.2")))
+inline auto crc32c_hw_step1(uint32_t crc, uint8_t b) -> uint32_t {
+    return _mm_crc32_u8(crc, b);
+}
+
+auto has_crc32c_instructions() -> bool {
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+}
+#elif defined(FILE_TRANS_CRC32C_ARM)
+inline auto crc32c_hw_step8(uint32_t crc, const uint8_t* p) -> uint32_t {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return __crc32cd(crc, word);
+}
+
+inline auto crc32c_hw_step1(uint32_t crc, uint8_t b) -> uint32_t {
+    return __crc32cb(crc, b);
+}
+
+constexpr auto has_crc32c_instructions() -> bool {
+    return true;
+}
+#endif
+
+#if defined(FILE_TRANS_CRC32C_SSE42) || defined(FILE_TRANS_CRC32C_ARM)
+template <bool Count>
+#if defined(FILE_TRANS_CRC32C_SSE42)
+__attribute__((target("sse4.2")))
+#endif
+auto crc32c_hw_sweep(uint32_t crc, const uint8_t* p, std::size_t n, byte_counts* counts)
+    -> uint32_t {
+    for (; n >= 8; p += 8, n -= 8) {
+        crc = crc32c_hw_step8(crc, p);
+        if constexpr (Count) {
+            count8(*counts, p);
+        }
+    }
+    for (; n > 0; ++p, --n) {
+        crc = crc32c_hw_step1(crc, *p);
+        if constexpr (Count) {
+            ++(*counts)[0][*p];
+        }
+    }
+    return crc;
+}
+#endif
+
+template <bool Count>
+auto crc32c_sweep(uint32_t crc, const uint8_t* p, std::size_t n, byte_counts* counts)
+    -> uint32_t {
+#if defined(FILE_TRANS_CRC32C_SSE42) || defined(FILE_TRANS_CRC32C_ARM)
+    if (has_crc32c_instructions()) {
+        return crc32c_hw_sweep<Count>(crc, p, n, counts);
+    }
+#endif
+    return crc32_sweep<Count>(CRC32C_SLICES, crc, p, n, counts);
+}
+
+inline void count_sweep(const uint8_t* p, std::size_t n, byte_counts& counts) {
+    for (; n >= 8; p += 8, n -= 8) {
+        count8(counts, p);
+    }
+    for (; n > 0; ++p, --n) {
+        ++counts[0][*p];
+    }
+}
+
+auto xxh3_64_digest(std::span<const std::byte> data) -> uint64_t {
+#ifdef FILE_TRANS_ENABLE_XXHASH
+    return XXH3_64bits(data.data(), data.size());
+#else
+    (void)data;
+    return 0;
+#endif
+}
+
+// Bytes scanned between two folds of the 32-bit sub-histograms into the result
+constexpr std::size_t scan_block = std::size_t{1} << 30;
 
 // SHA-256 constants
 constexpr std::array<uint32_t, 64> SHA256_K = {
@@ -122,77 +293,131 @@ void sha256_transform(std::array<uint32_t, 8>& state, const uint8_t* block) {
     state[7] += h;
 }
 
-// SHA-256 hash computation
-auto compute_sha256(const uint8_t* data, std::size_t length) -> std::array<uint8_t, 32> {
-    std::array<uint32_t, 8> state = SHA256_H0;
-    std::array<uint8_t, 64> block{};
-    std::size_t block_pos = 0;
-
-    // Process complete blocks
-    for (std::size_t i = 0; i < length; ++i) {
-        block[block_pos++] = data[i];
-        if (block_pos == 64) {
-            sha256_transform(state, block.data());
-            block_pos = 0;
-        }
+// Convert hash to hex string
+auto hash_to_hex(const std::array<uint8_t, 32>& hash) -> std::string {
+    std::ostringstream oss;
+    oss << std::hex << std::setfill('0');
+    for (uint8_t byte : hash) {
+        oss << std::setw(2) << static_cast<int>(byte);
     }
+    return oss.str();
+}
 
-    // Padding
-    uint64_t bit_length = length * 8;
-    block[block_pos++] = 0x80;
+}  // namespace
 
-    if (block_pos > 56) {
-        while (block_pos < 64) {
-            block[block_pos++] = 0;
-        }
-        sha256_transform(state, block.data());
-        block_pos = 0;
-    }
+auto checksum::crc32(std::span<const std::byte> data) -> uint32_t {
+    const auto* p = reinterpret_cast<const uint8_t*>(data.data());
+    return crc32_sweep<false>(CRC32_SLICES, 0xFFFFFFFF, p, data.size(), nullptr) ^ 0xFFFFFFFF;
+}
 
-    while (block_pos < 56) {
-        block[block_pos++] = 0;
-    }
+auto checksum::crc32c(std::span<const std::byte> data) -> uint32_t {
+    const auto* p = reinterpret_cast<const uint8_t*>(data.data());
+    return crc32c_sweep<false>(0xFFFFFFFF, p, data.size(), nullptr) ^ 0xFFFFFFFF;
+}
 
-    // Append length (big-endian)
-    for (int i = 7; i >= 0; --i) {
-        block[block_pos++] = static_cast<uint8_t>(bit_length >> (i * 8));
+auto checksum::digest(chunk_integrity algorithm, std::span<const std::byte> data) -> uint64_t {
+    switch (algorithm) {
+        case chunk_integrity::crc32c:
+            return crc32c(data);
+        case chunk_integrity::xxh3_64:
+            return xxh3_64_digest(data);
+        case chunk_integrity::crc32:
+        default:
+            return crc32(data);
     }
+}
 
-    sha256_transform(state, block.data());
+auto checksum::verify(chunk_integrity algorithm, std::span<const std::byte> data,
+                      uint64_t expected) -> bool {
+    return is_supported(algorithm) && digest(algorithm, data) == expected;
+}
 
-    // Produce final hash value (big-endian)
-    std::array<uint8_t, 32> hash{};
-    for (int i = 0; i < 8; ++i) {
-        hash[i * 4] = static_cast<uint8_t>(state[i] >> 24);
-        hash[i * 4 + 1] = static_cast<uint8_t>(state[i] >> 16);
-        hash[i * 4 + 2] = static_cast<uint8_t>(state[i] >> 8);
-        hash[i * 4 + 3] = static_cast<uint8_t>(state[i]);
+auto checksum::is_supported(chunk_integrity algorithm) -> bool {
+    switch (algorithm) {
+        case chunk_integrity::crc32:
+        case chunk_integrity::crc32c:
+            return true;
+        case chunk_integrity::xxh3_64:
+#ifdef FILE_TRANS_ENABLE_XXHASH
+            return true;
+#else
+            return false;
+#endif
+        default:
+            return false;
     }
-
-    return hash;
 }
 
-// Convert hash to hex string
-auto hash_to_hex(const std::array<uint8_t, 32>& hash) -> std::string {
-    std::ostringstream oss;
-    oss << std::hex << std::setfill('0');
-    for (uint8_t byte : hash) {
-        oss << std::setw(2) << static_cast<int>(byte);
+auto checksum::integrity_capabilities() -> client_capabilities {
+    auto caps = client_capabilities::integrity_crc32c;
+    if (is_supported(chunk_integrity::xxh3_64)) {
+        caps = caps | client_capabilities::integrity_xxh3;
     }
-    return oss.str();
+    return caps;
 }
 
-}  // namespace
+auto checksum::scan(std::span<const std::byte> data, chunk_integrity algorithm) -> byte_scan {
+    byte_scan out;
+    out.algorithm = algorithm;
+    out.size = data.size();
 
-auto checksum::crc32(std::span<const std::byte> data) -> uint32_t {
     uint32_t crc = 0xFFFFFFFF;
+    const auto* p = reinterpret_cast<const uint8_t*>(data.data());
+    std::size_t n = data.size();
 
-    for (std::byte b : data) {
-        uint8_t index = static_cast<uint8_t>(crc ^ static_cast<uint8_t>(b));
-        crc = CRC32_TABLE[index] ^ (crc >> 8);
+    byte_counts counts;
+    while (n > 0) {
+        for (auto& c : counts) {
+            c.fill(0);
+        }
+        auto block = std::min(n, scan_block);
+
+        switch (algorithm) {
+            case chunk_integrity::crc32c:
+                crc = crc32c_sweep<true>(crc, p, block, &counts);
+                break;
+            case chunk_integrity::xxh3_64:
+                // The hash has no per-byte step to share; the data is hashed
+                // below, still in cache for chunk-sized buffers
+                count_sweep(p, block, counts);
+                break;
+            case chunk_integrity::crc32:
+            default:
+                crc = crc32_sweep<true>(CRC32_SLICES, crc, p, block, &counts);
+                break;
+        }
+        p += block;
+        n -= block;
+
+        for (std::size_t i = 0; i < 256; ++i) {
+            out.histogram[i] += static_cast<uint64_t>(counts[0][i]) + counts[1][i] +
+                                counts[2][i] + counts[3][i];
+        }
     }
 
-    return crc ^ 0xFFFFFFFF;
+    out.digest = algorithm == chunk_integrity::xxh3_64 ? xxh3_64_digest(data)
+                                                       : crc ^ 0xFFFFFFFF;
+    return out;
+}
+
+auto byte_scan::entropy() const -> double {
+    if (size == 0) {
+        return 0.0;
+    }
+    const auto total = static_cast<double>(size);
+    double bits = 0.0;
+    std::size_t symbols = 0;
+    for (auto count : histogram) {
+        if (count != 0) {
+            auto p = static_cast<double>(count) / total;
+            bits -= p * std::log2(p);
+            ++symbols;
+        }
+    }
+    // Miller-Madow correction: a short sample of random bytes misses some
+    // values and would otherwise look well below 8 bits per byte
+    bits += static_cast<double>(symbols - 1) / (2.0 * total * std::numbers::ln2);
+    return std::min(bits, 8.0);
 }
 
 auto checksum::verify_crc32(std::span<const std::byte> data, uint32_t expected) -> bool {
@@ -206,57 +431,20 @@ auto checksum::sha256_file(const std::filesystem::path& path) -> result<std::str
             error{error_code::file_not_found, "cannot open file: " + path.string()});
     }
 
-    std::array<uint32_t, 8> state = SHA256_H0;
-    std::array<uint8_t, 64> block{};
-    uint64_t total_bytes = 0;
-
+    sha256_hasher hasher;
+    std::vector<std::byte> buffer(64 * 1024);
     while (file) {
-        file.read(reinterpret_cast<char*>(block.data()), 64);
-        auto bytes_read = file.gcount();
-        total_bytes += bytes_read;
-
-        if (bytes_read == 64) {
-            sha256_transform(state, block.data());
-        } else {
-            // Final block with padding
-            std::size_t block_pos = static_cast<std::size_t>(bytes_read);
-            uint64_t bit_length = total_bytes * 8;
-
-            block[block_pos++] = 0x80;
-
-            if (block_pos > 56) {
-                while (block_pos < 64) {
-                    block[block_pos++] = 0;
-                }
-                sha256_transform(state, block.data());
-                block_pos = 0;
-                block.fill(0);
-            }
-
-            while (block_pos < 56) {
-                block[block_pos++] = 0;
-            }
-
-            // Append length (big-endian)
-            for (int i = 7; i >= 0; --i) {
-                block[block_pos++] = static_cast<uint8_t>(bit_length >> (i * 8));
-            }
-
-            sha256_transform(state, block.data());
-            break;
-        }
+        file.read(reinterpret_cast<char*>(buffer.data()),
+                  static_cast<std::streamsize>(buffer.size()));
+        hasher.update(std::span<const std::byte>(
+            buffer.data(), static_cast<std::size_t>(file.gcount())));
     }
-
-    // Produce final hash
-    std::array<uint8_t, 32> hash{};
-    for (int i = 0; i < 8; ++i) {
-        hash[i * 4] = static_cast<uint8_t>(state[i] >> 24);
-        hash[i * 4 + 1] = static_cast<uint8_t>(state[i] >> 16);
-        hash[i * 4 + 2] = static_cast<uint8_t>(state[i] >> 8);
-        hash[i * 4 + 3] = static_cast<uint8_t>(state[i]);
+    if (file.bad()) {
+        return unexpected(
+            error{error_code::file_read_error, "cannot read file: " + path.string()});
     }
 
-    return hash_to_hex(hash);
+    return hasher.finalize();
 }
 
 auto checksum::verify_sha256(const std::filesystem::path& path, const std::string& expected)
@@ -269,7 +457,74 @@ auto checksum::verify_sha256(const std::filesystem::path& path, const std::strin
 }
 
 auto checksum::sha256(std::span<const std::byte> data) -> std::string {
-    auto hash = compute_sha256(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    sha256_hasher hasher;
+    hasher.update(data);
+    return hasher.finalize();
+}
+
+// sha256_hasher implementation
+
+sha256_hasher::sha256_hasher() : state_(SHA256_H0) {}
+
+void sha256_hasher::update(std::span<const std::byte> data) {
+    auto* bytes = reinterpret_cast<const uint8_t*>(data.data());
+    auto length = data.size();
+    total_bytes_ += length;
+
+    // Top up a partly filled block first
+    if (block_pos_ > 0) {
+        auto take = std::min(length, block_.size() - block_pos_);
+        std::memcpy(block_.data() + block_pos_, bytes, take);
+        block_pos_ += take;
+        bytes += take;
+        length -= take;
+        if (block_pos_ < block_.size()) {
+            return;
+        }
+        sha256_transform(state_, block_.data());
+        block_pos_ = 0;
+    }
+
+    // Whole blocks straight from the input
+    for (; length >= 64; bytes += 64, length -= 64) {
+        sha256_transform(state_, bytes);
+    }
+
+    if (length > 0) {
+        std::memcpy(block_.data(), bytes, length);
+        block_pos_ = length;
+    }
+}
+
+auto sha256_hasher::finalize() -> std::string {
+    uint64_t bit_length = total_bytes_ * 8;
+    block_[block_pos_++] = 0x80;
+
+    if (block_pos_ > 56) {
+        std::fill(block_.begin() + static_cast<std::ptrdiff_t>(block_pos_), block_.end(), 0);
+        sha256_transform(state_, block_.data());
+        block_pos_ = 0;
+    }
+    std::fill(block_.begin() + static_cast<std::ptrdiff_t>(block_pos_), block_.begin() + 56, 0);
+
+    // Append length (big-endian)
+    for (int i = 0; i < 8; ++i) {
+        block_[56 + i] = static_cast<uint8_t>(bit_length >> ((7 - i) * 8));
+    }
+    sha256_transform(state_, block_.data());
+
+    // Produce final hash value (big-endian)
+    std::array<uint8_t, 32> hash{};
+    for (int i = 0; i < 8; ++i) {
+        hash[i * 4] = static_cast<uint8_t>(state_[i] >> 24);
+        hash[i * 4 + 1] = static_cast<uint8_t>(state_[i] >> 16);
+        hash[i * 4 + 2] = static_cast<uint8_t>(state_[i] >> 8);
+        hash[i * 4 + 3] = static_cast<uint8_t>(state_[i]);
+    }
+
+    state_ = SHA256_H0;
+    block_pos_ = 0;
+    total_bytes_ = 0;
     return hash_to_hex(hash);
 }
 
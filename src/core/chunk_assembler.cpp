@@ -6,14 +6,21 @@
 #include <kcenon/file_transfer/core/chunk_assembler.h>
 
 #include <kcenon/file_transfer/core/checksum.h>
+#include <kcenon/file_transfer/core/chunk_config.h>
 
 #include <algorithm>
+#include <iterator>
 #include <random>
 
 namespace kcenon::file_transfer {
 
 namespace {
 
+// Bytes of the file a chunk covers; a zero_range chunk carries none of them
+auto covered_bytes(const chunk& c) -> uint64_t {
+    return c.is_zero_range() ? c.header.original_size : c.data.size();
+}
+
 auto generate_temp_filename() -> std::string {
     static std::random_device rd;
     static std::mt19937 gen(rd());
@@ -39,21 +46,24 @@ chunk_assembler::chunk_assembler(const std::filesystem::path& output_dir)
 }
 
 chunk_assembler::chunk_assembler(chunk_assembler&& other) noexcept
-    : output_dir_(std::move(other.output_dir_)), contexts_(std::move(other.contexts_)) {}
+    : output_dir_(std::move(other.output_dir_)),
+      contexts_(std::move(other.contexts_)),
+      recovered_callback_(std::move(other.recovered_callback_)) {}
 
 auto chunk_assembler::operator=(chunk_assembler&& other) noexcept -> chunk_assembler& {
     if (this != &other) {
         output_dir_ = std::move(other.output_dir_);
         contexts_ = std::move(other.contexts_);
+        recovered_callback_ = std::move(other.recovered_callback_);
     }
     return *this;
 }
 
 chunk_assembler::~chunk_assembler() {
     // Clean up any incomplete transfers
-    std::unique_lock lock(contexts_mutex_);
-    for (auto& [id, ctx] : contexts_) {
-        if (ctx && ctx->file) {
+    for (auto& ctx : contexts_.clear()) {
+        std::lock_guard lock(ctx->mutex);
+        if (ctx->file) {
             ctx->file->close();
         }
         // Remove temp files
@@ -67,28 +77,47 @@ auto chunk_assembler::start_session(
     const std::string& filename,
     uint64_t file_size,
     uint64_t total_chunks) -> result<void> {
-    std::unique_lock lock(contexts_mutex_);
+    return open_session(id, filename, file_size, total_chunks, false);
+}
 
+auto chunk_assembler::start_variable_session(
+    const transfer_id& id,
+    const std::string& filename,
+    uint64_t file_size) -> result<void> {
+    return open_session(id, filename, file_size, 0, true);
+}
+
+auto chunk_assembler::open_session(
+    const transfer_id& id,
+    const std::string& filename,
+    uint64_t file_size,
+    uint64_t total_chunks,
+    bool variable_chunks) -> result<void> {
     // Check if session already exists
-    if (contexts_.find(id) != contexts_.end()) {
+    if (contexts_.contains(id)) {
         return unexpected(error{error_code::already_initialized, "session already exists"});
     }
 
     // Create new context
-    auto ctx = std::make_unique<assembly_context>();
+    auto ctx = std::make_shared<assembly_context>();
     ctx->filename = filename;
     ctx->file_size = file_size;
     ctx->total_chunks = total_chunks;
     ctx->received_chunks.resize(total_chunks, false);
     ctx->received_count = 0;
     ctx->bytes_written = 0;
+    ctx->recovered_count = 0;
+    ctx->variable_chunks = variable_chunks;
+    ctx->total_known = !variable_chunks;
 
     // Create temp file path
     ctx->temp_file_path = output_dir_ / generate_temp_filename();
     ctx->final_path = output_dir_ / filename;
 
-    // Open temp file for writing
-    ctx->file = std::make_unique<std::ofstream>(ctx->temp_file_path, std::ios::binary);
+    // Open temp file for writing; chunks are read back to rebuild lost ones
+    ctx->file = std::make_unique<std::fstream>(
+        ctx->temp_file_path,
+        std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
     if (!ctx->file->is_open()) {
         return unexpected(
             error{error_code::file_access_denied,
@@ -102,68 +131,277 @@ auto chunk_assembler::start_session(
         ctx->file->seekp(0);
     }
 
-    contexts_[id] = std::move(ctx);
+    // Lost a race with another start for the same id
+    if (!contexts_.insert(id, ctx).second) {
+        ctx->file->close();
+        std::error_code ec;
+        std::filesystem::remove(ctx->temp_file_path, ec);
+        return unexpected(error{error_code::already_initialized, "session already exists"});
+    }
     return {};
 }
 
 auto chunk_assembler::process_chunk(const chunk& c) -> result<void> {
-    auto* ctx = get_context(c.header.id);
+    return process_chunk(c, integrity_check::none);
+}
+
+auto chunk_assembler::process_chunk(const chunk& c, integrity_check verified) -> result<void> {
+    auto ctx = get_context(c.header.id);
     if (!ctx) {
         return unexpected(error{error_code::not_initialized, "session not found"});
     }
 
-    std::lock_guard lock(ctx->mutex);
+    std::vector<chunk> recovered;
+    {
+        std::lock_guard lock(ctx->mutex);
+        if (ctx->finalized) {
+            return unexpected(error{error_code::not_initialized, "session not found"});
+        }
 
-    // Validate chunk index
-    if (c.header.chunk_index >= ctx->total_chunks) {
-        return unexpected(
-            error{error_code::invalid_chunk_index,
-                  "chunk index " + std::to_string(c.header.chunk_index) + " out of range"});
+        if (c.is_parity()) {
+            if (has_check(integrity_policy::outstanding(verified),
+                          integrity_check::chunk_checksum) &&
+                !verify_chunk_checksum(c)) {
+                return unexpected(error{error_code::chunk_checksum_error,
+                                        std::string(to_string(c.header.integrity)) +
+                                            " verification failed"});
+            }
+            if (auto accepted = accept_parity(*ctx, c, recovered); !accepted) {
+                return accepted;
+            }
+        } else {
+            if (auto stored = store_chunk(*ctx, c, verified); !stored) {
+                return stored;
+            }
+            // The chunk may complete what a group's parity needs
+            auto group = ctx->fec_groups.upper_bound(c.header.chunk_index);
+            if (group != ctx->fec_groups.begin() &&
+                std::prev(group)->second.contains(c.header.chunk_index)) {
+                recover_group(*ctx, c.header.id, std::prev(group), recovered);
+            }
+        }
     }
 
+    if (recovered_callback_) {
+        for (const auto& rebuilt : recovered) {
+            recovered_callback_(c.header.id, rebuilt);
+        }
+    }
+    return {};
+}
+
+auto chunk_assembler::store_chunk(assembly_context& ctx, const chunk& c,
+                                  integrity_check verified) const -> result<void> {
     // Check if already received
-    if (ctx->received_chunks[c.header.chunk_index]) {
+    auto index = c.header.chunk_index;
+    if (ctx.has_chunk(index)) {
         // Duplicate chunk - ignore silently
         return {};
     }
 
-    // Verify CRC32
-    if (!verify_chunk_crc32(c)) {
-        return unexpected(error{error_code::chunk_checksum_error, "CRC32 verification failed"});
+    // Verify the checksum with the algorithm recorded in the header,
+    // unless an earlier stage already did or an AEAD tag covered it
+    if (has_check(integrity_policy::outstanding(verified), integrity_check::chunk_checksum) &&
+        !verify_chunk_checksum(c)) {
+        return unexpected(error{error_code::chunk_checksum_error,
+                                std::string(to_string(c.header.integrity)) +
+                                    " verification failed"});
     }
 
-    // Write chunk to file at correct offset
-    ctx->file->seekp(static_cast<std::streamoff>(c.header.chunk_offset));
-    if (!ctx->file->good()) {
-        return unexpected(error{error_code::file_write_error, "seek failed"});
+    if (c.is_zero_range() && !c.data.empty()) {
+        return unexpected(
+            error{error_code::invalid_chunk_index, "zero range chunk carries a payload"});
     }
+    uint64_t length = covered_bytes(c);
 
-    ctx->file->write(reinterpret_cast<const char*>(c.data.data()),
-                     static_cast<std::streamsize>(c.data.size()));
-    if (!ctx->file->good()) {
-        return unexpected(error{error_code::file_write_error, "write failed"});
+    // Validate chunk index, and for variable sizes its byte range
+    if (ctx.variable_chunks) {
+        if (auto accepted = accept_variable_chunk(ctx, c); !accepted) {
+            return accepted;
+        }
+    } else if (index >= ctx.total_chunks) {
+        return unexpected(
+            error{error_code::invalid_chunk_index,
+                  "chunk index " + std::to_string(index) + " out of range"});
+    } else if (c.header.chunk_offset + length > ctx.file_size) {
+        return unexpected(
+            error{error_code::invalid_chunk_index,
+                  "chunk " + std::to_string(index) + " lies outside the file"});
+    }
+
+    // A zero range is left unwritten: the temp file is created sparse with
+    // only its last byte written, so the range already reads back as zeros
+    // and stays a hole on filesystems that support them
+    if (!c.is_zero_range()) {
+        ctx.file->seekp(static_cast<std::streamoff>(c.header.chunk_offset));
+        if (!ctx.file->good()) {
+            return unexpected(error{error_code::file_write_error, "seek failed"});
+        }
+
+        ctx.file->write(reinterpret_cast<const char*>(c.data.data()),
+                        static_cast<std::streamsize>(c.data.size()));
+        if (!ctx.file->good()) {
+            return unexpected(error{error_code::file_write_error, "write failed"});
+        }
     }
 
     // Update tracking
-    ctx->received_chunks[c.header.chunk_index] = true;
-    ctx->received_count++;
-    ctx->bytes_written += c.data.size();
+    ctx.received_chunks[index] = true;
+    ctx.received_count++;
+    ctx.bytes_written += length;
+    if (length > 0) {
+        ctx.received_ranges.emplace(c.header.chunk_offset, c.header.chunk_offset + length);
+    }
 
     return {};
 }
 
+auto chunk_assembler::accept_parity(assembly_context& ctx, const chunk& c,
+                                    std::vector<chunk>& recovered) const
+    -> result<void> {
+    auto parsed = fec_group::from_parity(c);
+    if (!parsed) {
+        return unexpected(parsed.error());
+    }
+    auto first = parsed.value().first_index();
+    auto end = first + parsed.value().data_count();
+
+    // Same bound as for data chunks: a group may not reach past the file
+    uint64_t max_chunks = ctx.variable_chunks && !ctx.total_known
+        ? ctx.file_size / chunk_config::min_chunk_size + 1
+        : ctx.total_chunks;
+    if (end > max_chunks) {
+        return unexpected(
+            error{error_code::invalid_chunk_index,
+                  "parity for chunks " + std::to_string(first) + " to " +
+                      std::to_string(end - 1) + " out of range"});
+    }
+
+    auto group = ctx.fec_groups.find(first);
+    if (group == ctx.fec_groups.end()) {
+        // Every chunk of the group arrived; the parity is not needed
+        bool complete = true;
+        for (auto index = first; index < end && complete; ++index) {
+            complete = ctx.has_chunk(index);
+        }
+        if (complete) {
+            return {};
+        }
+        group = ctx.fec_groups.emplace(first, std::move(parsed.value())).first;
+    } else if (auto added = group->second.add_parity(c); !added) {
+        return added;
+    }
+
+    recover_group(ctx, c.header.id, group, recovered);
+    return {};
+}
+
+auto chunk_assembler::recover_group(assembly_context& ctx, const transfer_id& id,
+                                    std::map<uint64_t, fec_group>::iterator group,
+                                    std::vector<chunk>& recovered) const -> void {
+    const auto& g = group->second;
+    std::vector<uint64_t> missing;
+    for (auto index = g.first_index(); index < g.first_index() + g.data_count(); ++index) {
+        if (!ctx.has_chunk(index)) {
+            missing.push_back(index);
+        }
+    }
+    if (missing.size() > g.parity_count()) {
+        return;  // Wait for more data or parity
+    }
+
+    auto read = [&](uint64_t index) -> result<std::vector<std::byte>> {
+        const auto& e = g.entry(static_cast<std::size_t>(index - g.first_index()));
+        std::vector<std::byte> payload(e.payload_size);
+        ctx.file->seekg(static_cast<std::streamoff>(e.offset));
+        ctx.file->read(reinterpret_cast<char*>(payload.data()),
+                       static_cast<std::streamsize>(payload.size()));
+        if (!ctx.file->good()) {
+            ctx.file->clear();
+            return unexpected(error{error_code::file_read_error,
+                                    "cannot read back chunk " + std::to_string(index)});
+        }
+        return payload;
+    };
+    auto rebuilt = g.recover(id, missing, read);
+
+    // Done with the group either way; what could not be rebuilt stays
+    // missing and is asked for again like any lost chunk
+    ctx.fec_groups.erase(group);
+    if (!rebuilt) {
+        return;
+    }
+    for (auto& c : rebuilt.value()) {
+        if (store_chunk(ctx, c, integrity_check::none)) {
+            ctx.recovered_count++;
+            recovered.push_back(std::move(c));
+        }
+    }
+}
+
+auto chunk_assembler::accept_variable_chunk(assembly_context& ctx, const chunk& c)
+    -> result<void> {
+    auto index = c.header.chunk_index;
+    uint64_t begin = c.header.chunk_offset;
+    uint64_t length = covered_bytes(c);
+    uint64_t end = begin + length;
+
+    // Every chunk but the last is at least min_chunk_size, which bounds the
+    // count and keeps a bogus index from growing the bitmap without limit
+    uint64_t max_chunks = ctx.file_size / chunk_config::min_chunk_size + 1;
+    if (index >= max_chunks || (ctx.total_known && index >= ctx.total_chunks)) {
+        return unexpected(
+            error{error_code::invalid_chunk_index,
+                  "chunk index " + std::to_string(index) + " out of range"});
+    }
+    if (length > chunk_config::max_chunk_size || end > ctx.file_size ||
+        end < begin) {
+        return unexpected(
+            error{error_code::invalid_chunk_index,
+                  "chunk " + std::to_string(index) + " lies outside the file"});
+    }
+
+    // Received ranges never overlap, so the bytes written add up to the file
+    if (begin < end) {
+        auto next = ctx.received_ranges.upper_bound(begin);
+        bool overlaps_next = next != ctx.received_ranges.end() && next->first < end;
+        bool overlaps_prev =
+            next != ctx.received_ranges.begin() && std::prev(next)->second > begin;
+        if (overlaps_next || overlaps_prev) {
+            return unexpected(
+                error{error_code::invalid_chunk_index,
+                      "chunk " + std::to_string(index) + " overlaps a received chunk"});
+        }
+    }
+
+    if (has_flag(c.header.flags, chunk_flags::last_chunk)) {
+        if (end != ctx.file_size || index + 1 < ctx.received_chunks.size()) {
+            return unexpected(
+                error{error_code::invalid_chunk_index,
+                      "last chunk " + std::to_string(index) + " does not end the file"});
+        }
+        ctx.total_chunks = index + 1;
+        ctx.total_known = true;
+    }
+
+    if (index >= ctx.received_chunks.size()) {
+        ctx.received_chunks.resize(index + 1, false);
+    }
+    return {};
+}
+
 auto chunk_assembler::is_complete(const transfer_id& id) const -> bool {
-    const auto* ctx = get_context(id);
+    auto ctx = get_context(id);
     if (!ctx) {
         return false;
     }
 
     std::lock_guard lock(ctx->mutex);
-    return ctx->received_count == ctx->total_chunks;
+    return ctx->complete();
 }
 
 auto chunk_assembler::get_missing_chunks(const transfer_id& id) const -> std::vector<uint64_t> {
-    const auto* ctx = get_context(id);
+    auto ctx = get_context(id);
     if (!ctx) {
         return {};
     }
@@ -171,7 +409,8 @@ auto chunk_assembler::get_missing_chunks(const transfer_id& id) const -> std::ve
     std::lock_guard lock(ctx->mutex);
 
     std::vector<uint64_t> missing;
-    for (uint64_t i = 0; i < ctx->total_chunks; ++i) {
+    uint64_t known = ctx->total_known ? ctx->total_chunks : ctx->received_chunks.size();
+    for (uint64_t i = 0; i < known; ++i) {
         if (!ctx->received_chunks[i]) {
             missing.push_back(i);
         }
@@ -179,39 +418,67 @@ auto chunk_assembler::get_missing_chunks(const transfer_id& id) const -> std::ve
     return missing;
 }
 
+auto chunk_assembler::get_missing_ranges(const transfer_id& id) const
+    -> std::vector<file_byte_range> {
+    auto ctx = get_context(id);
+    if (!ctx) {
+        return {};
+    }
+
+    std::lock_guard lock(ctx->mutex);
+
+    std::vector<file_byte_range> missing;
+    uint64_t cursor = 0;
+    for (const auto& [begin, end] : ctx->received_ranges) {
+        if (begin > cursor) {
+            missing.push_back({cursor, begin - cursor});
+        }
+        cursor = std::max(cursor, end);
+    }
+    if (cursor < ctx->file_size) {
+        missing.push_back({cursor, ctx->file_size - cursor});
+    }
+    return missing;
+}
+
 auto chunk_assembler::finalize(const transfer_id& id, const std::string& expected_hash)
     -> result<std::filesystem::path> {
-    std::unique_lock ctx_lock(contexts_mutex_);
-
-    auto it = contexts_.find(id);
-    if (it == contexts_.end()) {
+    auto ctx = get_context(id);
+    if (!ctx) {
         return unexpected(error{error_code::not_initialized, "session not found"});
     }
 
-    auto& ctx = it->second;
-
-    {
-        std::lock_guard lock(ctx->mutex);
-
-        // Check if complete
-        if (ctx->received_count != ctx->total_chunks) {
-            return unexpected(
-                error{error_code::missing_chunks,
-                      "missing " + std::to_string(ctx->total_chunks - ctx->received_count) +
-                          " chunks"});
-        }
+    // Held to the end: chunks of this session wait, other sessions do not
+    std::unique_lock lock(ctx->mutex);
+    if (ctx->finalized) {
+        return unexpected(error{error_code::not_initialized, "session not found"});
+    }
 
-        // Close file
-        ctx->file->close();
+    // Check if complete
+    if (ctx->variable_chunks && !ctx->complete()) {
+        return unexpected(
+            error{error_code::missing_chunks,
+                  "missing " + std::to_string(ctx->file_size - ctx->bytes_written) +
+                      " bytes"});
+    }
+    if (ctx->received_count != ctx->total_chunks) {
+        return unexpected(
+            error{error_code::missing_chunks,
+                  "missing " + std::to_string(ctx->total_chunks - ctx->received_count) +
+                      " chunks"});
     }
 
+    // Close file
+    ctx->file->close();
+
     // Verify SHA-256 if provided
     if (!expected_hash.empty()) {
         if (!checksum::verify_sha256(ctx->temp_file_path, expected_hash)) {
             // Remove temp file on hash mismatch
             std::error_code ec;
             std::filesystem::remove(ctx->temp_file_path, ec);
-            contexts_.erase(it);
+            ctx->finalized = true;
+            contexts_.erase(id);
             return unexpected(error{error_code::file_hash_mismatch, "SHA-256 hash mismatch"});
         }
     }
@@ -232,13 +499,14 @@ auto chunk_assembler::finalize(const transfer_id& id, const std::string& expecte
     }
 
     auto final_path = ctx->final_path;
-    contexts_.erase(it);
+    ctx->finalized = true;
+    contexts_.erase(id);
 
     return final_path;
 }
 
 auto chunk_assembler::get_progress(const transfer_id& id) const -> std::optional<assembly_progress> {
-    const auto* ctx = get_context(id);
+    auto ctx = get_context(id);
     if (!ctx) {
         return std::nullopt;
     }
@@ -250,22 +518,20 @@ auto chunk_assembler::get_progress(const transfer_id& id) const -> std::optional
     progress.total_chunks = ctx->total_chunks;
     progress.received_chunks = ctx->received_count;
     progress.bytes_written = ctx->bytes_written;
+    progress.recovered_chunks = ctx->recovered_count;
 
     return progress;
 }
 
 void chunk_assembler::cancel_session(const transfer_id& id) {
-    std::unique_lock lock(contexts_mutex_);
-
-    auto it = contexts_.find(id);
-    if (it == contexts_.end()) {
+    auto ctx = contexts_.erase(id);
+    if (!ctx) {
         return;
     }
 
-    auto& ctx = it->second;
-
     {
         std::lock_guard ctx_lock(ctx->mutex);
+        ctx->finalized = true;
         if (ctx->file) {
             ctx->file->close();
         }
@@ -274,29 +540,24 @@ void chunk_assembler::cancel_session(const transfer_id& id) {
     // Remove temp file
     std::error_code ec;
     std::filesystem::remove(ctx->temp_file_path, ec);
-
-    contexts_.erase(it);
 }
 
 auto chunk_assembler::has_session(const transfer_id& id) const -> bool {
-    std::shared_lock lock(contexts_mutex_);
-    return contexts_.find(id) != contexts_.end();
+    return contexts_.contains(id);
 }
 
-auto chunk_assembler::verify_chunk_crc32(const chunk& c) const -> bool {
-    return checksum::verify_crc32(std::span<const std::byte>(c.data), c.header.checksum);
+void chunk_assembler::on_chunk_recovered(
+    std::function<void(const transfer_id&, const chunk&)> callback) {
+    recovered_callback_ = std::move(callback);
 }
 
-auto chunk_assembler::get_context(const transfer_id& id) -> assembly_context* {
-    std::shared_lock lock(contexts_mutex_);
-    auto it = contexts_.find(id);
-    return it != contexts_.end() ? it->second.get() : nullptr;
+auto chunk_assembler::verify_chunk_checksum(const chunk& c) const -> bool {
+    return checksum::verify(c.header.integrity, std::span<const std::byte>(c.data), c.digest());
 }
 
-auto chunk_assembler::get_context(const transfer_id& id) const -> const assembly_context* {
-    std::shared_lock lock(contexts_mutex_);
-    auto it = contexts_.find(id);
-    return it != contexts_.end() ? it->second.get() : nullptr;
+auto chunk_assembler::get_context(const transfer_id& id) const
+    -> std::shared_ptr<assembly_context> {
+    return contexts_.find(id);
 }
 
 }  // namespace kcenon::file_transfer
@@ -0,0 +1,290 @@
+/**
+ * @file chunk_size_controller.cpp
+ * @brief Adaptive chunk sizing from link and CPU measurements
+ */
+
+#include "kcenon/file_transfer/core/chunk_size_controller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace kcenon::file_transfer {
+
+namespace {
+
+// Largest loss fraction fed into -ln(1 - p); beyond it every chunk is lost
+constexpr double max_loss_fraction = 0.99;
+
+auto seconds(std::chrono::microseconds us) -> double {
+    return static_cast<double>(us.count()) / 1e6;
+}
+
+// Per-byte loss rate λ such that a run of n bytes arrives intact with
+// probability e^(-λn), given a fraction p of runs of n bytes that did not
+auto loss_per_byte(double p, double n) -> double {
+    if (p <= 0.0 || n <= 0.0) {
+        return 0.0;
+    }
+    return -std::log1p(-std::min(p, max_loss_fraction)) / n;
+}
+
+auto round_pow2(double size) -> double {
+    return std::exp2(std::round(std::log2(std::max(size, 1.0))));
+}
+
+auto clamp_size(double size, const adaptive_chunk_config& config) -> std::size_t {
+    auto lo = static_cast<double>(config.min_size);
+    auto hi = static_cast<double>(config.max_size);
+    return static_cast<std::size_t>(std::clamp(round_pow2(size), lo, hi));
+}
+
+/**
+ * Size maximising s / ((o + a*s) * e^(λs)), a = seconds per byte.
+ * Setting the derivative of its log to zero gives λa*s² + λo*s - o = 0.
+ */
+auto optimal_size(double per_byte, double overhead, double lambda, double rtt,
+                  const adaptive_chunk_config& config) -> std::size_t {
+    auto bandwidth = 1.0 / per_byte;
+    auto cap = bandwidth * std::chrono::duration<double>(config.max_chunk_time).count();
+
+    double size = cap;
+    if (lambda > 0.0) {
+        auto b = lambda * overhead;
+        auto root = (-b + std::sqrt(b * b + 4.0 * lambda * per_byte * overhead)) /
+                    (2.0 * lambda * per_byte);
+        size = std::min(size, root);
+    }
+
+    auto window = static_cast<double>(std::max<std::size_t>(config.window_chunks, 1));
+    size = std::max(size, bandwidth * rtt / window);
+    return clamp_size(size, config);
+}
+
+}  // namespace
+
+auto adaptive_chunk_config::validate() const -> result<void> {
+    if (min_size < chunk_config::min_chunk_size || max_size > chunk_config::max_chunk_size ||
+        min_size > max_size) {
+        return unexpected(error{error_code::invalid_chunk_size,
+                                "adaptive chunk sizes must satisfy " +
+                                    std::to_string(chunk_config::min_chunk_size) +
+                                    " <= min_size <= max_size <= " +
+                                    std::to_string(chunk_config::max_chunk_size)});
+    }
+    if (packet_size == 0 || window_chunks == 0 || adjust_interval == 0) {
+        return unexpected(error{error_code::invalid_configuration,
+                                "packet_size, window_chunks and adjust_interval must be non-zero"});
+    }
+    if (!(smoothing > 0.0 && smoothing <= 1.0)) {
+        return unexpected(
+            error{error_code::invalid_configuration, "smoothing must be in (0, 1]"});
+    }
+    if (max_chunk_time.count() <= 0) {
+        return unexpected(
+            error{error_code::invalid_configuration, "max_chunk_time must be positive"});
+    }
+    return {};
+}
+
+struct chunk_size_controller::impl {
+    adaptive_chunk_config config;
+
+    mutable std::mutex mutex;
+    link_probe probe;
+    std::size_t size;
+
+    uint64_t samples = 0;
+    uint64_t retransmits = 0;
+    uint64_t adjustments = 0;
+
+    // Per-interval sums, folded into the averages at each adjustment
+    std::size_t interval_samples = 0;
+    std::size_t interval_retransmits = 0;
+    double interval_bytes = 0.0;      // Of first-time chunks
+    double interval_wire = 0.0;       // Seconds, of first-time chunks
+
+    // Smoothed estimates; negative until measured
+    double bandwidth = -1.0;
+    double retransmit_rate = -1.0;
+
+    // Moving moments of (bytes, cpu seconds) for the least-squares fit
+    double mean_x = 0.0;
+    double mean_y = 0.0;
+    double mean_xx = 0.0;
+    double mean_xy = 0.0;
+
+    explicit impl(adaptive_chunk_config cfg)
+        : config(cfg), size(clamp_size(chunk_config::default_chunk_size, config)) {}
+
+    auto reset(const link_probe& p) -> void {
+        probe = p;
+        size = initial_size(p, config);
+        samples = retransmits = adjustments = 0;
+        interval_samples = interval_retransmits = 0;
+        interval_bytes = interval_wire = 0.0;
+        bandwidth = retransmit_rate = -1.0;
+        mean_x = mean_y = mean_xx = mean_xy = 0.0;
+    }
+
+    // cpu_time ≈ intercept + slope * bytes
+    auto cpu_fit() const -> std::pair<double, double> {
+        if (samples == 0 || mean_x <= 0.0) {
+            return {0.0, 0.0};
+        }
+        auto variance = mean_xx - mean_x * mean_x;
+        if (variance <= 1e-4 * mean_x * mean_x) {
+            // All chunks about the same size: the fixed part cannot be told
+            // apart, so charge everything per byte, which never favours growth
+            return {0.0, mean_y / mean_x};
+        }
+        auto slope = std::max(0.0, (mean_xy - mean_x * mean_y) / variance);
+        auto intercept = std::max(0.0, mean_y - slope * mean_x);
+        return {intercept, slope};
+    }
+
+    auto current_bandwidth() const -> double {
+        return bandwidth > 0.0 ? bandwidth : static_cast<double>(probe.bandwidth);
+    }
+
+    auto current_loss() const -> double {
+        if (retransmit_rate >= 0.0) {
+            return loss_per_byte(retransmit_rate, mean_x);
+        }
+        return loss_per_byte(probe.loss_rate, static_cast<double>(config.packet_size));
+    }
+
+    auto fold_interval() -> void {
+        auto alpha = config.smoothing;
+        auto rate = static_cast<double>(interval_retransmits) /
+                    static_cast<double>(interval_samples);
+        retransmit_rate =
+            retransmit_rate < 0.0 ? rate : retransmit_rate + alpha * (rate - retransmit_rate);
+
+        if (interval_wire > 0.0 && interval_bytes > 0.0) {
+            auto measured = interval_bytes / interval_wire;
+            bandwidth = bandwidth < 0.0 ? measured : bandwidth + alpha * (measured - bandwidth);
+        }
+
+        interval_samples = 0;
+        interval_retransmits = 0;
+        interval_bytes = 0.0;
+        interval_wire = 0.0;
+    }
+
+    auto adjust() -> void {
+        auto b = current_bandwidth();
+        if (b <= 0.0) {
+            return;
+        }
+        auto [cpu_fixed, cpu_per_byte] = cpu_fit();
+
+        // Wire and CPU stages overlap in the pipeline; the slower one sets the pace
+        auto per_byte = std::max(1.0 / b, cpu_per_byte);
+        auto overhead = seconds(config.per_chunk_overhead) + cpu_fixed;
+        auto target = optimal_size(per_byte, overhead, current_loss(), seconds(probe.rtt), config);
+
+        target = std::clamp(target, size / 4, size * 4);
+        target = std::clamp(target, config.min_size, config.max_size);
+        if (target != size) {
+            size = target;
+            ++adjustments;
+        }
+    }
+};
+
+chunk_size_controller::chunk_size_controller(adaptive_chunk_config config)
+    : impl_(std::make_unique<impl>(config)) {}
+
+chunk_size_controller::~chunk_size_controller() = default;
+
+chunk_size_controller::chunk_size_controller(chunk_size_controller&&) noexcept = default;
+
+auto chunk_size_controller::operator=(chunk_size_controller&&) noexcept
+    -> chunk_size_controller& = default;
+
+auto chunk_size_controller::initial_size(const link_probe& probe,
+                                         const adaptive_chunk_config& config) -> std::size_t {
+    if (probe.bandwidth == 0) {
+        return clamp_size(chunk_config::default_chunk_size, config);
+    }
+    return optimal_size(1.0 / static_cast<double>(probe.bandwidth),
+                        seconds(config.per_chunk_overhead),
+                        loss_per_byte(probe.loss_rate, static_cast<double>(config.packet_size)),
+                        seconds(probe.rtt), config);
+}
+
+auto chunk_size_controller::start(const link_probe& probe) -> std::size_t {
+    std::lock_guard lock(impl_->mutex);
+    impl_->reset(probe);
+    return impl_->size;
+}
+
+auto chunk_size_controller::record(const chunk_sample& sample) -> std::size_t {
+    std::lock_guard lock(impl_->mutex);
+    auto& s = *impl_;
+    if (sample.bytes == 0) {
+        return s.size;
+    }
+
+    auto x = static_cast<double>(sample.bytes);
+    auto y = seconds(sample.cpu_time);
+    if (s.samples == 0) {
+        s.mean_x = x;
+        s.mean_y = y;
+        s.mean_xx = x * x;
+        s.mean_xy = x * y;
+    } else {
+        auto alpha = s.config.smoothing;
+        s.mean_x += alpha * (x - s.mean_x);
+        s.mean_y += alpha * (y - s.mean_y);
+        s.mean_xx += alpha * (x * x - s.mean_xx);
+        s.mean_xy += alpha * (x * y - s.mean_xy);
+    }
+
+    ++s.samples;
+    ++s.interval_samples;
+    if (sample.retransmitted) {
+        ++s.retransmits;
+        ++s.interval_retransmits;
+    } else {
+        s.interval_bytes += x;
+        s.interval_wire += seconds(sample.wire_time);
+    }
+
+    if (s.interval_samples >= s.config.adjust_interval) {
+        s.fold_interval();
+        s.adjust();
+    }
+    return s.size;
+}
+
+auto chunk_size_controller::chunk_size() const -> std::size_t {
+    std::lock_guard lock(impl_->mutex);
+    return impl_->size;
+}
+
+auto chunk_size_controller::stats() const -> chunk_size_stats {
+    std::lock_guard lock(impl_->mutex);
+    const auto& s = *impl_;
+    auto [cpu_fixed, cpu_per_byte] = s.cpu_fit();
+
+    chunk_size_stats stats;
+    stats.chunk_size = s.size;
+    stats.samples = s.samples;
+    stats.retransmits = s.retransmits;
+    stats.adjustments = s.adjustments;
+    stats.bandwidth = std::max(0.0, s.current_bandwidth());
+    stats.retransmit_rate = std::max(0.0, s.retransmit_rate);
+    stats.cpu_ns_per_byte = cpu_per_byte * 1e9;
+    stats.cpu_per_chunk = std::chrono::microseconds(static_cast<int64_t>(cpu_fixed * 1e6));
+    return stats;
+}
+
+auto chunk_size_controller::config() const -> const adaptive_chunk_config& {
+    return impl_->config;
+}
+
+}  // namespace kcenon::file_transfer
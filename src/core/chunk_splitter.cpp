@@ -7,8 +7,67 @@
 
 #include <kcenon/file_transfer/core/checksum.h>
 
+#include <algorithm>
+#include <cerrno>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace kcenon::file_transfer {
 
+namespace {
+
+/**
+ * Data extents of a file from SEEK_DATA/SEEK_HOLE, in file order. Empty if
+ * the platform or filesystem cannot tell holes apart, or the file has none.
+ */
+auto find_data_extents(const std::filesystem::path& path, uint64_t file_size)
+    -> std::vector<file_byte_range> {
+    std::vector<file_byte_range> extents;
+#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return {};
+    }
+    off_t pos = 0;
+    auto end = static_cast<off_t>(file_size);
+    while (pos < end) {
+        off_t data = ::lseek(fd, pos, SEEK_DATA);
+        if (data < 0) {
+            // ENXIO: no data past pos; anything else: no hole support
+            if (errno != ENXIO) {
+                extents.clear();
+                extents.push_back({0, file_size});
+            }
+            break;
+        }
+        off_t hole = ::lseek(fd, data, SEEK_HOLE);
+        if (hole < 0) {
+            hole = end;
+        }
+        hole = std::min(hole, end);
+        extents.push_back({static_cast<uint64_t>(data), static_cast<uint64_t>(hole - data)});
+        pos = hole;
+    }
+    ::close(fd);
+
+    // A single extent over the whole file means there are no holes
+    if (extents.size() == 1 && extents[0].offset == 0 && extents[0].length == file_size) {
+        extents.clear();
+    } else if (extents.empty() && file_size > 0) {
+        extents.push_back({file_size, 0});  // All hole
+    }
+#else
+    (void)path;
+    (void)file_size;
+#endif
+    return extents;
+}
+
+}  // namespace
+
 // chunk_iterator implementation
 
 chunk_splitter::chunk_iterator::chunk_iterator(
@@ -16,13 +75,21 @@ chunk_splitter::chunk_iterator::chunk_iterator(
     chunk_config config,
     transfer_id id,
     uint64_t file_size,
-    uint64_t total_chunks)
+    uint64_t total_chunks,
+    bool with_digest,
+    std::vector<file_byte_range> data_extents)
     : file_(std::move(file)),
       config_(config),
       transfer_id_(id),
       file_size_(file_size),
       total_chunks_(total_chunks),
-      current_index_(0) {
+      current_index_(0),
+      next_offset_(0),
+      with_digest_(with_digest),
+      data_extents_(std::move(data_extents)),
+      extent_pos_(0),
+      zero_bytes_(0),
+      last_entropy_(0.0) {
     buffer_.resize(config_.chunk_size);
 }
 
@@ -33,7 +100,15 @@ chunk_splitter::chunk_iterator::chunk_iterator(chunk_iterator&& other) noexcept
       file_size_(other.file_size_),
       total_chunks_(other.total_chunks_),
       current_index_(other.current_index_),
-      buffer_(std::move(other.buffer_)) {
+      next_offset_(other.next_offset_),
+      buffer_(std::move(other.buffer_)),
+      with_digest_(other.with_digest_),
+      hasher_(other.hasher_),
+      digest_(std::move(other.digest_)),
+      data_extents_(std::move(other.data_extents_)),
+      extent_pos_(other.extent_pos_),
+      zero_bytes_(other.zero_bytes_),
+      last_entropy_(other.last_entropy_) {
     other.total_chunks_ = 0;
     other.current_index_ = 0;
 }
@@ -47,7 +122,15 @@ auto chunk_splitter::chunk_iterator::operator=(chunk_iterator&& other) noexcept
         file_size_ = other.file_size_;
         total_chunks_ = other.total_chunks_;
         current_index_ = other.current_index_;
+        next_offset_ = other.next_offset_;
         buffer_ = std::move(other.buffer_);
+        with_digest_ = other.with_digest_;
+        hasher_ = other.hasher_;
+        digest_ = std::move(other.digest_);
+        data_extents_ = std::move(other.data_extents_);
+        extent_pos_ = other.extent_pos_;
+        zero_bytes_ = other.zero_bytes_;
+        last_entropy_ = other.last_entropy_;
 
         other.total_chunks_ = 0;
         other.current_index_ = 0;
@@ -70,8 +153,9 @@ auto chunk_splitter::chunk_iterator::next() -> result<chunk> {
         return unexpected(error{error_code::file_read_error, "file stream error"});
     }
 
-    // Calculate offset and size for this chunk
-    uint64_t offset = current_index_ * config_.chunk_size;
+    // Calculate offset and size for this chunk; the size may have changed
+    // since the previous one, so the offset is tracked rather than derived
+    uint64_t offset = next_offset_;
     std::size_t bytes_to_read = config_.chunk_size;
 
     // For the last chunk, adjust the size
@@ -80,19 +164,8 @@ auto chunk_splitter::chunk_iterator::next() -> result<chunk> {
         bytes_to_read = static_cast<std::size_t>(remaining);
     }
 
-    // Seek to the correct position
-    file_.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
-    if (!file_.good()) {
-        return unexpected(error{error_code::file_read_error, "seek failed"});
-    }
-
-    // Read data
-    file_.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(bytes_to_read));
-    auto bytes_read = static_cast<std::size_t>(file_.gcount());
-
-    if (bytes_read != bytes_to_read) {
-        return unexpected(
-            error{error_code::file_read_error, "failed to read expected bytes"});
+    if (buffer_.size() < bytes_to_read) {
+        buffer_.resize(bytes_to_read);
     }
 
     // Create chunk
@@ -112,22 +185,106 @@ auto chunk_splitter::chunk_iterator::next() -> result<chunk> {
         c.header.flags = c.header.flags | chunk_flags::last_chunk;
     }
 
+    // A chunk inside a hole is not read at all
+    if (config_.elide_zero_ranges && bytes_to_read > 0 && in_hole(offset, bytes_to_read)) {
+        return make_zero_range(std::move(c), bytes_to_read);
+    }
+
+    // Seek to the correct position
+    file_.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+    if (!file_.good()) {
+        return unexpected(error{error_code::file_read_error, "seek failed"});
+    }
+
+    // Read data
+    file_.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(bytes_to_read));
+    auto bytes_read = static_cast<std::size_t>(file_.gcount());
+
+    if (bytes_read != bytes_to_read) {
+        return unexpected(
+            error{error_code::file_read_error, "failed to read expected bytes"});
+    }
+
+    // Chunk digest and byte histogram in one pass while the bytes are in cache
+    auto scan = checksum::scan(std::span<const std::byte>(buffer_.data(), bytes_read),
+                               config_.integrity);
+    last_entropy_ = scan.entropy();
+
+    // Allocated but zero-filled blocks (e.g. preallocated images) are elided too
+    if (config_.elide_zero_ranges && bytes_read > 0 && scan.all_zero()) {
+        return make_zero_range(std::move(c), bytes_read);
+    }
+
     // Copy data
     c.data.assign(buffer_.begin(), buffer_.begin() + bytes_read);
 
+    // Chunks are read in file order, so the file hash comes for free
+    if (with_digest_) {
+        hasher_.update(std::span<const std::byte>(c.data));
+        if (current_index_ == total_chunks_ - 1) {
+            digest_ = hasher_.finalize();
+        }
+    }
+
     // Set sizes
     c.header.original_size = static_cast<uint32_t>(bytes_read);
     c.header.compressed_size = static_cast<uint32_t>(bytes_read);  // No compression yet
 
-    // Calculate CRC32
-    c.header.checksum = checksum::crc32(std::span<const std::byte>(c.data));
+    c.set_digest(config_.integrity, scan.digest);
 
     // Move to next chunk
     ++current_index_;
+    next_offset_ += bytes_read;
 
     return c;
 }
 
+auto chunk_splitter::chunk_iterator::in_hole(uint64_t offset, std::size_t size) -> bool {
+    if (data_extents_.empty()) {
+        return false;
+    }
+    // Chunks come in file order, so extents ending before this one are done with
+    while (extent_pos_ < data_extents_.size() && data_extents_[extent_pos_].end() <= offset) {
+        ++extent_pos_;
+    }
+    return extent_pos_ == data_extents_.size() ||
+           data_extents_[extent_pos_].offset >= offset + size;
+}
+
+auto chunk_splitter::chunk_iterator::make_zero_range(chunk c, std::size_t size) -> chunk {
+    c.header.flags = c.header.flags | chunk_flags::zero_range;
+    c.header.original_size = static_cast<uint32_t>(size);
+    c.header.compressed_size = 0;
+    c.set_digest(config_.integrity,
+                 checksum::digest(config_.integrity, std::span<const std::byte>{}));
+    last_entropy_ = 0.0;
+
+    if (with_digest_) {
+        static const std::vector<std::byte> zeros(64 * 1024);
+        for (std::size_t fed = 0; fed < size;) {
+            auto n = std::min(zeros.size(), size - fed);
+            hasher_.update(std::span<const std::byte>(zeros.data(), n));
+            fed += n;
+        }
+        if (current_index_ == total_chunks_ - 1) {
+            digest_ = hasher_.finalize();
+        }
+    }
+
+    zero_bytes_ += size;
+    ++current_index_;
+    next_offset_ += size;
+    return c;
+}
+
+auto chunk_splitter::chunk_iterator::zero_bytes() const -> uint64_t {
+    return zero_bytes_;
+}
+
+auto chunk_splitter::chunk_iterator::last_entropy() const -> double {
+    return last_entropy_;
+}
+
 auto chunk_splitter::chunk_iterator::current_index() const -> uint64_t {
     return current_index_;
 }
@@ -140,14 +297,44 @@ auto chunk_splitter::chunk_iterator::file_size() const -> uint64_t {
     return file_size_;
 }
 
+auto chunk_splitter::chunk_iterator::chunk_size() const -> std::size_t {
+    return config_.chunk_size;
+}
+
+auto chunk_splitter::chunk_iterator::set_chunk_size(std::size_t size) -> result<void> {
+    chunk_config config(size);
+    if (auto result = config.validate(); !result) {
+        return unexpected(result.error());
+    }
+    config_ = config;
+
+    // An empty file still has its single (empty) chunk until it is read
+    if (current_index_ < total_chunks_ && file_size_ > next_offset_) {
+        total_chunks_ = current_index_ + config_.calculate_chunk_count(file_size_ - next_offset_);
+    }
+    return {};
+}
+
+auto chunk_splitter::chunk_iterator::digest() const -> result<std::string> {
+    if (!with_digest_) {
+        return unexpected(
+            error{error_code::invalid_configuration, "split without digest"});
+    }
+    if (digest_.empty()) {
+        return unexpected(
+            error{error_code::missing_chunks, "digest available after the last chunk"});
+    }
+    return digest_;
+}
+
 // chunk_splitter implementation
 
 chunk_splitter::chunk_splitter() : config_() {}
 
 chunk_splitter::chunk_splitter(const chunk_config& config) : config_(config) {}
 
-auto chunk_splitter::split(const std::filesystem::path& file_path, const transfer_id& id)
-    -> result<chunk_iterator> {
+auto chunk_splitter::split(const std::filesystem::path& file_path, const transfer_id& id,
+                           bool with_digest) -> result<chunk_iterator> {
     // Validate configuration
     if (auto result = config_.validate(); !result) {
         return unexpected(result.error());
@@ -182,11 +369,17 @@ auto chunk_splitter::split(const std::filesystem::path& file_path, const transfe
         total_chunks = 1;  // At least one (empty) chunk for empty files
     }
 
-    return chunk_iterator(std::move(file), config_, id, file_size, total_chunks);
+    std::vector<file_byte_range> extents;
+    if (config_.elide_zero_ranges) {
+        extents = find_data_extents(file_path, file_size);
+    }
+
+    return chunk_iterator(std::move(file), config_, id, file_size, total_chunks, with_digest,
+                          std::move(extents));
 }
 
-auto chunk_splitter::calculate_metadata(const std::filesystem::path& file_path)
-    -> result<file_metadata> {
+auto chunk_splitter::calculate_metadata(const std::filesystem::path& file_path,
+                                        bool with_digest) -> result<file_metadata> {
     // Check if file exists
     std::error_code ec;
     if (!std::filesystem::exists(file_path, ec)) {
@@ -201,18 +394,27 @@ auto chunk_splitter::calculate_metadata(const std::filesystem::path& file_path)
             error{error_code::file_access_denied, "cannot get file size: " + file_path.string()});
     }
 
+    file_metadata metadata;
+
     // Calculate SHA-256
-    auto hash_result = checksum::sha256_file(file_path);
-    if (!hash_result) {
-        return unexpected(hash_result.error());
+    if (with_digest && digest_cache_) {
+        auto cached = digest_cache_->compute(file_path, config_.chunk_size);
+        if (!cached) {
+            return unexpected(cached.error());
+        }
+        metadata.sha256_hash = std::move(cached.value().sha256);
+    } else if (with_digest) {
+        auto hash_result = checksum::sha256_file(file_path);
+        if (!hash_result) {
+            return unexpected(hash_result.error());
+        }
+        metadata.sha256_hash = hash_result.value();
     }
 
-    file_metadata metadata;
     metadata.filename = file_path.filename().string();
     metadata.file_size = file_size;
     metadata.chunk_size = config_.chunk_size;
     metadata.total_chunks = config_.calculate_chunk_count(file_size);
-    metadata.sha256_hash = hash_result.value();
 
     // Handle empty file
     if (metadata.total_chunks == 0) {
@@ -226,4 +428,8 @@ auto chunk_splitter::config() const -> const chunk_config& {
     return config_;
 }
 
+auto chunk_splitter::set_digest_cache(std::shared_ptr<digest_cache> cache) -> void {
+    digest_cache_ = std::move(cache);
+}
+
 }  // namespace kcenon::file_transfer
@@ -105,6 +105,11 @@ constexpr std::size_t sample_size = 4096;
 // Minimum compression ratio threshold
 constexpr double min_compression_ratio = 1.1;
 
+// Order-0 entropy (bits/byte) at or above which data is taken as random,
+// encrypted or already compressed, and below which it always compresses
+constexpr double incompressible_entropy = 7.9;
+constexpr double trivially_compressible_entropy = 1.0;
+
 }  // namespace
 
 class compression_engine::impl {
@@ -287,6 +292,29 @@ public:
 #endif
     }
 
+    auto is_compressible(std::span<const std::byte> data, double entropy) const -> bool {
+#ifndef FILE_TRANS_ENABLE_LZ4
+        (void)data;
+        (void)entropy;
+        return false;
+#else
+        if (data.empty() || is_precompressed_format(data)) {
+            return false;
+        }
+        if (entropy >= incompressible_entropy) {
+            FT_LOG_TRACE(log_category::compression,
+                "Compressibility check: entropy=" + std::to_string(entropy).substr(0, 4) +
+                ", compressible=false");
+            return false;
+        }
+        if (entropy < trivially_compressible_entropy) {
+            return true;
+        }
+        // In between, only a trial tells whether LZ4 finds repeats
+        return is_compressible(data);
+#endif
+    }
+
     auto stats() const -> compression_stats {
         std::lock_guard lock(stats_mutex_);
         return stats_;
@@ -390,6 +418,11 @@ auto compression_engine::is_compressible(std::span<const std::byte> data) const
     return impl_->is_compressible(data);
 }
 
+auto compression_engine::is_compressible(std::span<const std::byte> data,
+                                         double entropy) const -> bool {
+    return impl_->is_compressible(data, entropy);
+}
+
 auto compression_engine::stats() const -> compression_stats {
     return impl_->stats();
 }
@@ -0,0 +1,653 @@
+/**
+ * @file digest_cache.cpp
+ * @brief Implementation of the persistent file digest cache
+ */
+
+#include <kcenon/file_transfer/core/digest_cache.h>
+
+#include <kcenon/file_transfer/core/checksum.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/xattr.h>
+#define FILE_TRANS_HAS_XATTR 1
+#endif
+
+namespace kcenon::file_transfer {
+
+namespace {
+
+constexpr std::array<char, 4> table_magic{'F', 'T', 'D', 'C'};
+constexpr uint8_t format_version = 1;
+constexpr const char* xattr_name = "user.kcenon.file_transfer.digest";
+
+// Record kinds in the table log
+constexpr uint8_t record_entry = 0;
+constexpr uint8_t record_tombstone = 1;
+
+// Identity of a file's current contents
+struct file_key {
+    uint64_t device = 0;
+    uint64_t inode = 0;
+    uint64_t size = 0;
+    int64_t mtime_ns = 0;
+
+    auto operator==(const file_key&) const -> bool = default;
+};
+
+auto stat_file(const std::filesystem::path& path) -> std::optional<file_key> {
+#ifdef _WIN32
+    (void)path;
+    return std::nullopt;
+#else
+    struct stat st {};
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return std::nullopt;
+    }
+#ifdef __APPLE__
+    const auto& mtime = st.st_mtimespec;
+#else
+    const auto& mtime = st.st_mtim;
+#endif
+    file_key key;
+    key.device = static_cast<uint64_t>(st.st_dev);
+    key.inode = static_cast<uint64_t>(st.st_ino);
+    key.size = static_cast<uint64_t>(st.st_size);
+    key.mtime_ns = static_cast<int64_t>(mtime.tv_sec) * 1'000'000'000 +
+                   static_cast<int64_t>(mtime.tv_nsec);
+    return key;
+#endif
+}
+
+auto now_ns() -> int64_t {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+// Little-endian encoding, independent of the host
+class record_writer {
+public:
+    template <typename T>
+    auto put(T value) -> void {
+        auto v = static_cast<uint64_t>(value);
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            data_.push_back(static_cast<std::byte>((v >> (8 * i)) & 0xFF));
+        }
+    }
+
+    auto bytes(std::span<const std::byte> b) -> void {
+        data_.insert(data_.end(), b.begin(), b.end());
+    }
+
+    auto take() -> std::vector<std::byte> { return std::move(data_); }
+
+private:
+    std::vector<std::byte> data_;
+};
+
+class record_reader {
+public:
+    explicit record_reader(std::span<const std::byte> data) : data_(data) {}
+
+    template <typename T>
+    auto get() -> T {
+        if (!ok_ || data_.size() - pos_ < sizeof(T)) {
+            ok_ = false;
+            return T{};
+        }
+        uint64_t v = 0;
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            v |= static_cast<uint64_t>(data_[pos_ + i]) << (8 * i);
+        }
+        pos_ += sizeof(T);
+        return static_cast<T>(v);
+    }
+
+    auto bytes(std::size_t n) -> std::span<const std::byte> {
+        if (!ok_ || data_.size() - pos_ < n) {
+            ok_ = false;
+            return {};
+        }
+        pos_ += n;
+        return data_.subspan(pos_ - n, n);
+    }
+
+    [[nodiscard]] auto remaining() const -> std::size_t { return data_.size() - pos_; }
+    [[nodiscard]] auto ok() const -> bool { return ok_; }
+    [[nodiscard]] auto at_end() const -> bool { return ok_ && pos_ == data_.size(); }
+
+private:
+    std::span<const std::byte> data_;
+    std::size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+auto hex_to_digest(const std::string& hex) -> std::array<std::byte, 32> {
+    std::array<std::byte, 32> out{};
+    auto nibble = [](char c) -> unsigned {
+        if (c >= '0' && c <= '9') return static_cast<unsigned>(c - '0');
+        if (c >= 'a' && c <= 'f') return static_cast<unsigned>(c - 'a' + 10);
+        if (c >= 'A' && c <= 'F') return static_cast<unsigned>(c - 'A' + 10);
+        return 0;
+    };
+    for (std::size_t i = 0; i < out.size() && 2 * i + 1 < hex.size(); ++i) {
+        out[i] = static_cast<std::byte>((nibble(hex[2 * i]) << 4) | nibble(hex[2 * i + 1]));
+    }
+    return out;
+}
+
+auto digest_to_hex(std::span<const std::byte> digest) -> std::string {
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(digest.size() * 2);
+    for (auto b : digest) {
+        out.push_back(digits[static_cast<uint8_t>(b) >> 4]);
+        out.push_back(digits[static_cast<uint8_t>(b) & 0x0F]);
+    }
+    return out;
+}
+
+// Record body shared by the table and the extended attribute
+auto encode_body(uint8_t kind, const file_key& key, std::size_t chunk_size,
+                 const file_digest* digest) -> std::vector<std::byte> {
+    record_writer w;
+    w.put<uint8_t>(kind);
+    w.put<uint64_t>(key.device);
+    w.put<uint64_t>(key.inode);
+    w.put<uint64_t>(key.size);
+    w.put<int64_t>(key.mtime_ns);
+    w.put<uint32_t>(static_cast<uint32_t>(chunk_size));
+    if (digest) {
+        auto raw = hex_to_digest(digest->sha256);
+        w.bytes(raw);
+        w.put<uint32_t>(static_cast<uint32_t>(digest->chunk_crc32.size()));
+        for (auto crc : digest->chunk_crc32) {
+            w.put<uint32_t>(crc);
+        }
+    }
+    return w.take();
+}
+
+struct decoded_body {
+    uint8_t kind = record_entry;
+    file_key key;
+    file_digest digest;
+};
+
+auto decode_body(std::span<const std::byte> body) -> std::optional<decoded_body> {
+    record_reader r(body);
+    decoded_body out;
+    out.kind = r.get<uint8_t>();
+    out.key.device = r.get<uint64_t>();
+    out.key.inode = r.get<uint64_t>();
+    out.key.size = r.get<uint64_t>();
+    out.key.mtime_ns = r.get<int64_t>();
+    out.digest.chunk_size = r.get<uint32_t>();
+    out.digest.file_size = out.key.size;
+    if (out.kind == record_entry) {
+        out.digest.sha256 = digest_to_hex(r.bytes(32));
+        auto count = r.get<uint32_t>();
+        if (!r.ok() || r.remaining() != static_cast<std::size_t>(count) * 4) {
+            return std::nullopt;
+        }
+        out.digest.chunk_crc32.resize(count);
+        for (auto& crc : out.digest.chunk_crc32) {
+            crc = r.get<uint32_t>();
+        }
+    } else if (out.kind != record_tombstone) {
+        return std::nullopt;
+    }
+    if (!r.at_end()) {
+        return std::nullopt;
+    }
+    return out;
+}
+
+#ifdef FILE_TRANS_HAS_XATTR
+auto read_xattr(const std::filesystem::path& path) -> std::optional<std::vector<std::byte>> {
+    std::vector<std::byte> value(4096);
+    for (int attempt = 0; attempt < 2; ++attempt) {
+#ifdef __APPLE__
+        auto n = ::getxattr(path.c_str(), xattr_name, value.data(), value.size(), 0, 0);
+#else
+        auto n = ::getxattr(path.c_str(), xattr_name, value.data(), value.size());
+#endif
+        if (n >= 0) {
+            value.resize(static_cast<std::size_t>(n));
+            return value;
+        }
+        if (errno != ERANGE) {
+            return std::nullopt;
+        }
+        // Larger than the first guess: ask for the size and retry once
+#ifdef __APPLE__
+        n = ::getxattr(path.c_str(), xattr_name, nullptr, 0, 0, 0);
+#else
+        n = ::getxattr(path.c_str(), xattr_name, nullptr, 0);
+#endif
+        if (n < 0) {
+            return std::nullopt;
+        }
+        value.resize(static_cast<std::size_t>(n));
+    }
+    return std::nullopt;
+}
+
+auto write_xattr(const std::filesystem::path& path, std::span<const std::byte> value) -> bool {
+    // Fails with ENOTSUP, E2BIG/ENOSPC (too many chunks for the filesystem's
+    // attribute size limit) or EACCES/EPERM, and the table takes the entry
+#ifdef __APPLE__
+    return ::setxattr(path.c_str(), xattr_name, value.data(), value.size(), 0, 0) == 0;
+#else
+    return ::setxattr(path.c_str(), xattr_name, value.data(), value.size(), 0) == 0;
+#endif
+}
+
+auto read_xattr_record(const std::filesystem::path& path) -> std::optional<decoded_body> {
+    auto value = read_xattr(path);
+    if (!value || value->empty() || static_cast<uint8_t>((*value)[0]) != format_version) {
+        return std::nullopt;
+    }
+    auto record = decode_body(std::span<const std::byte>(*value).subspan(1));
+    if (!record || record->kind != record_entry) {
+        return std::nullopt;
+    }
+    return record;
+}
+
+auto remove_xattr(const std::filesystem::path& path) -> void {
+#ifdef __APPLE__
+    (void)::removexattr(path.c_str(), xattr_name, 0);
+#else
+    (void)::removexattr(path.c_str(), xattr_name);
+#endif
+}
+#endif
+
+// Table slots are per (device, inode, chunk size); size and mtime validate them
+struct slot_key {
+    uint64_t device;
+    uint64_t inode;
+    std::size_t chunk_size;
+
+    auto operator==(const slot_key&) const -> bool = default;
+};
+
+struct slot_key_hash {
+    auto operator()(const slot_key& k) const noexcept -> std::size_t {
+        auto h = std::hash<uint64_t>{}(k.inode);
+        h ^= std::hash<uint64_t>{}(k.device) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        h ^= std::hash<std::size_t>{}(k.chunk_size) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+struct slot {
+    file_key key;
+    file_digest digest;
+    uint64_t last_use = 0;
+};
+
+}  // namespace
+
+struct digest_cache::impl {
+    digest_cache_config config;
+
+    mutable std::mutex mutex;
+    std::unordered_map<slot_key, slot, slot_key_hash> slots;
+    uint64_t use_clock = 0;
+    std::size_t table_records = 0;  // Records in the table file, live or superseded
+    digest_cache_stats stats;
+
+    explicit impl(digest_cache_config cfg) : config(std::move(cfg)) { load_table(); }
+
+    // Replay the table log; later records replace earlier ones
+    auto load_table() -> void {
+        if (config.table_path.empty()) {
+            return;
+        }
+        std::ifstream in(config.table_path, std::ios::binary);
+        if (!in) {
+            return;
+        }
+        std::array<char, 5> header{};
+        in.read(header.data(), header.size());
+        if (in.gcount() != static_cast<std::streamsize>(header.size()) ||
+            !std::equal(table_magic.begin(), table_magic.end(), header.begin()) ||
+            static_cast<uint8_t>(header[4]) != format_version) {
+            return;
+        }
+
+        std::vector<std::byte> body;
+        while (true) {
+            std::array<std::byte, 4> len_bytes{};
+            in.read(reinterpret_cast<char*>(len_bytes.data()), 4);
+            if (in.gcount() != 4) {
+                break;
+            }
+            auto len = record_reader(len_bytes).get<uint32_t>();
+            if (len > 64 * 1024 * 1024) {
+                break;
+            }
+            body.resize(len + 4);
+            in.read(reinterpret_cast<char*>(body.data()),
+                    static_cast<std::streamsize>(body.size()));
+            if (in.gcount() != static_cast<std::streamsize>(body.size())) {
+                break;  // Torn last record
+            }
+            auto payload = std::span<const std::byte>(body.data(), len);
+            auto stored_crc =
+                record_reader(std::span<const std::byte>(body).subspan(len)).get<uint32_t>();
+            if (checksum::crc32(payload) != stored_crc) {
+                break;
+            }
+            auto record = decode_body(payload);
+            if (!record) {
+                break;
+            }
+            ++table_records;
+            slot_key sk{record->key.device, record->key.inode, record->digest.chunk_size};
+            if (record->kind == record_tombstone) {
+                if (record->digest.chunk_size == 0) {
+                    std::erase_if(slots, [&](const auto& s) {
+                        return s.first.device == sk.device && s.first.inode == sk.inode;
+                    });
+                } else {
+                    slots.erase(sk);
+                }
+                continue;
+            }
+            slots[sk] = slot{record->key, std::move(record->digest), ++use_clock};
+        }
+        evict_locked();
+    }
+
+    auto append_record_locked(std::span<const std::byte> body) -> bool {
+        if (config.table_path.empty()) {
+            return false;
+        }
+        std::error_code ec;
+        auto parent = config.table_path.parent_path();
+        if (!parent.empty()) {
+            std::filesystem::create_directories(parent, ec);
+        }
+        bool fresh = !std::filesystem::exists(config.table_path, ec) ||
+                     std::filesystem::file_size(config.table_path, ec) == 0;
+
+        std::ofstream out(config.table_path, std::ios::binary | std::ios::app);
+        if (!out) {
+            return false;
+        }
+        if (fresh) {
+            write_header(out);
+            table_records = 0;
+        }
+        write_record(out, body);
+        out.flush();
+        if (!out) {
+            return false;
+        }
+        ++table_records;
+        return true;
+    }
+
+    static auto write_header(std::ofstream& out) -> void {
+        out.write(table_magic.data(), static_cast<std::streamsize>(table_magic.size()));
+        out.put(static_cast<char>(format_version));
+    }
+
+    static auto write_record(std::ofstream& out, std::span<const std::byte> body) -> void {
+        record_writer w;
+        w.put<uint32_t>(static_cast<uint32_t>(body.size()));
+        w.bytes(body);
+        w.put<uint32_t>(checksum::crc32(body));
+        auto framed = w.take();
+        out.write(reinterpret_cast<const char*>(framed.data()),
+                  static_cast<std::streamsize>(framed.size()));
+    }
+
+    auto evict_locked() -> void {
+        while (slots.size() > config.max_entries && !slots.empty()) {
+            auto oldest = std::min_element(
+                slots.begin(), slots.end(),
+                [](const auto& a, const auto& b) { return a.second.last_use < b.second.last_use; });
+            slots.erase(oldest);
+        }
+        stats.entries = slots.size();
+    }
+
+    auto compact_locked() -> result<void> {
+        if (config.table_path.empty()) {
+            return {};
+        }
+        auto temp = config.table_path;
+        temp += ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                return unexpected(error{error_code::file_write_error,
+                                        "cannot write digest table: " + temp.string()});
+            }
+            write_header(out);
+            for (const auto& [sk, s] : slots) {
+                write_record(out, encode_body(record_entry, s.key, sk.chunk_size, &s.digest));
+            }
+            out.flush();
+            if (!out) {
+                return unexpected(error{error_code::file_write_error,
+                                        "cannot write digest table: " + temp.string()});
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp, config.table_path, ec);
+        if (ec) {
+            std::filesystem::remove(temp, ec);
+            return unexpected(error{error_code::file_write_error,
+                                    "cannot replace digest table: " + config.table_path.string()});
+        }
+        table_records = slots.size();
+        return {};
+    }
+
+    [[nodiscard]] auto needs_compaction_locked() const -> bool {
+        return table_records > 2 * slots.size() + 64;
+    }
+
+    auto lookup(const std::filesystem::path& path, std::size_t chunk_size)
+        -> std::optional<file_digest> {
+        auto key = stat_file(path);
+        if (!key) {
+            std::lock_guard lock(mutex);
+            ++stats.misses;
+            return std::nullopt;
+        }
+
+        bool stale = false;
+#ifdef FILE_TRANS_HAS_XATTR
+        if (config.use_xattr) {
+            if (auto record = read_xattr_record(path);
+                record && record->digest.chunk_size == chunk_size) {
+                if (record->key == *key) {
+                    std::lock_guard lock(mutex);
+                    ++stats.hits;
+                    return std::move(record->digest);
+                }
+                stale = true;
+            }
+        }
+#endif
+
+        std::lock_guard lock(mutex);
+        auto it = slots.find(slot_key{key->device, key->inode, chunk_size});
+        if (it != slots.end()) {
+            if (it->second.key == *key) {
+                it->second.last_use = ++use_clock;
+                ++stats.hits;
+                return it->second.digest;
+            }
+            // The file changed; the record goes at the next compaction
+            slots.erase(it);
+            stats.entries = slots.size();
+            stale = true;
+        }
+
+        ++stats.misses;
+        if (stale) {
+            ++stats.stale;
+        }
+        return std::nullopt;
+    }
+
+    auto store(const std::filesystem::path& path, const file_key& key, const file_digest& digest)
+        -> void {
+        auto body = encode_body(record_entry, key, digest.chunk_size, &digest);
+        std::lock_guard lock(mutex);
+        ++stats.stores;
+
+#ifdef FILE_TRANS_HAS_XATTR
+        if (config.use_xattr) {
+            std::vector<std::byte> value;
+            value.reserve(body.size() + 1);
+            value.push_back(static_cast<std::byte>(format_version));
+            value.insert(value.end(), body.begin(), body.end());
+            if (write_xattr(path, value)) {
+                ++stats.xattr_stores;
+                return;
+            }
+        }
+#else
+        (void)path;
+#endif
+
+        // Kept in memory even if the table cannot be written
+        slots[slot_key{key.device, key.inode, digest.chunk_size}] =
+            slot{key, digest, ++use_clock};
+        evict_locked();
+        (void)append_record_locked(body);
+        if (needs_compaction_locked()) {
+            (void)compact_locked();
+        }
+    }
+};
+
+digest_cache::digest_cache(digest_cache_config config)
+    : impl_(std::make_unique<impl>(std::move(config))) {}
+
+digest_cache::~digest_cache() {
+    if (impl_) {
+        std::lock_guard lock(impl_->mutex);
+        if (impl_->needs_compaction_locked()) {
+            (void)impl_->compact_locked();
+        }
+    }
+}
+
+digest_cache::digest_cache(digest_cache&&) noexcept = default;
+
+auto digest_cache::operator=(digest_cache&&) noexcept -> digest_cache& = default;
+
+auto digest_cache::lookup(const std::filesystem::path& path, std::size_t chunk_size)
+    -> std::optional<file_digest> {
+    return impl_->lookup(path, chunk_size);
+}
+
+auto digest_cache::compute(const std::filesystem::path& path, std::size_t chunk_size)
+    -> result<file_digest> {
+    if (chunk_size == 0) {
+        return unexpected(error{error_code::invalid_chunk_size, "chunk size must not be zero"});
+    }
+    if (auto cached = impl_->lookup(path, chunk_size)) {
+        return std::move(*cached);
+    }
+
+    auto started = now_ns();
+    auto before = stat_file(path);
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return unexpected(
+            error{error_code::file_not_found, "cannot open file: " + path.string()});
+    }
+
+    // One read feeds both the file hash and the chunk CRCs
+    file_digest digest;
+    digest.chunk_size = chunk_size;
+    sha256_hasher hasher;
+    std::vector<std::byte> buffer(chunk_size);
+    while (file) {
+        file.read(reinterpret_cast<char*>(buffer.data()),
+                  static_cast<std::streamsize>(buffer.size()));
+        auto n = static_cast<std::size_t>(file.gcount());
+        if (n == 0 && !digest.chunk_crc32.empty()) {
+            break;
+        }
+        auto data = std::span<const std::byte>(buffer.data(), n);
+        hasher.update(data);
+        digest.chunk_crc32.push_back(checksum::crc32(data));
+        digest.file_size += n;
+    }
+    if (file.bad()) {
+        return unexpected(
+            error{error_code::file_read_error, "cannot read file: " + path.string()});
+    }
+    digest.sha256 = hasher.finalize();
+
+    auto after = stat_file(path);
+    auto racy_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       impl_->config.racy_window).count();
+    if (before && after && *before == *after && before->size == digest.file_size &&
+        started - before->mtime_ns >= racy_ns) {
+        impl_->store(path, *before, digest);
+    } else {
+        std::lock_guard lock(impl_->mutex);
+        ++impl_->stats.skipped;
+    }
+    return digest;
+}
+
+auto digest_cache::invalidate(const std::filesystem::path& path) -> void {
+    auto key = stat_file(path);
+    if (!key) {
+        return;
+    }
+#ifdef FILE_TRANS_HAS_XATTR
+    if (impl_->config.use_xattr) {
+        remove_xattr(path);
+    }
+#endif
+    std::lock_guard lock(impl_->mutex);
+    std::erase_if(impl_->slots, [&](const auto& s) {
+        return s.first.device == key->device && s.first.inode == key->inode;
+    });
+    impl_->stats.entries = impl_->slots.size();
+    // A tombstone with chunk size 0 covers every chunk size of the file
+    (void)impl_->append_record_locked(encode_body(record_tombstone, *key, 0, nullptr));
+}
+
+auto digest_cache::compact() -> result<void> {
+    std::lock_guard lock(impl_->mutex);
+    return impl_->compact_locked();
+}
+
+auto digest_cache::stats() const -> digest_cache_stats {
+    std::lock_guard lock(impl_->mutex);
+    return impl_->stats;
+}
+
+auto digest_cache::config() const -> const digest_cache_config& {
+    return impl_->config;
+}
+
+}  // namespace kcenon::file_transfer
@@ -0,0 +1,570 @@
+/**
+ * @file fec_codec.cpp
+ * @brief Reed-Solomon forward error correction over groups of chunks
+ */
+
+#include <kcenon/file_transfer/core/fec_codec.h>
+
+#include <kcenon/file_transfer/core/checksum.h>
+#include <kcenon/file_transfer/core/chunk_config.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define FILE_TRANS_FEC_X86 1
+#endif
+
+namespace kcenon::file_transfer {
+
+namespace {
+
+// GF(2^8) with the polynomial x^8 + x^4 + x^3 + x^2 + 1 and generator 2
+constexpr unsigned GF_POLYNOMIAL = 0x11D;
+
+struct gf_tables {
+    std::array<uint8_t, 512> exp{};
+    std::array<uint8_t, 256> log{};
+};
+
+constexpr auto make_gf_tables() -> gf_tables {
+    gf_tables t;
+    unsigned x = 1;
+    for (unsigned i = 0; i < 255; ++i) {
+        t.exp[i] = static_cast<uint8_t>(x);
+        t.log[x] = static_cast<uint8_t>(i);
+        x <<= 1;
+        if (x & 0x100) {
+            x ^= GF_POLYNOMIAL;
+        }
+    }
+    // Doubled, so exp[log a + log b] needs no reduction
+    for (unsigned i = 255; i < t.exp.size(); ++i) {
+        t.exp[i] = t.exp[i - 255];
+    }
+    return t;
+}
+
+constexpr gf_tables GF = make_gf_tables();
+
+constexpr auto gf_mul(uint8_t a, uint8_t b) -> uint8_t {
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+    return GF.exp[GF.log[a] + GF.log[b]];
+}
+
+constexpr auto gf_inv(uint8_t a) -> uint8_t {
+    return GF.exp[255 - GF.log[a]];
+}
+
+// Products of a coefficient with each low and each high nibble; c * x is
+// lo[x & 15] ^ hi[x >> 4], which is what the shuffle kernels look up
+struct nibble_tables {
+    alignas(16) std::array<uint8_t, 16> lo;
+    alignas(16) std::array<uint8_t, 16> hi;
+
+    explicit nibble_tables(uint8_t c) {
+        for (uint8_t x = 0; x < 16; ++x) {
+            lo[x] = gf_mul(c, x);
+            hi[x] = gf_mul(c, static_cast<uint8_t>(x << 4));
+        }
+    }
+};
+
+// Processes whole vectors and returns how many bytes it did
+#if defined(FILE_TRANS_FEC_X86)
+__attribute__((target("avx2")))
+auto multiply_add_avx2(const nibble_tables& t, const uint8_t* src, uint8_t* dst, std::size_t n)
+    -> std::size_t {
+    auto lo = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(t.lo.data())));
+    auto hi = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(t.hi.data())));
+    auto mask = _mm256_set1_epi8(0x0F);
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        auto s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        auto l = _mm256_shuffle_epi8(lo, _mm256_and_si256(s, mask));
+        auto h = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(s, 4), mask));
+        auto d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                            _mm256_xor_si256(d, _mm256_xor_si256(l, h)));
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+auto multiply_add_ssse3(const nibble_tables& t, const uint8_t* src, uint8_t* dst, std::size_t n)
+    -> std::size_t {
+    auto lo = _mm_load_si128(reinterpret_cast<const __m128i*>(t.lo.data()));
+    auto hi = _mm_load_si128(reinterpret_cast<const __m128i*>(t.hi.data()));
+    auto mask = _mm_set1_epi8(0x0F);
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        auto s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        auto l = _mm_shuffle_epi8(lo, _mm_and_si128(s, mask));
+        auto h = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(s, 4), mask));
+        auto d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(d, _mm_xor_si128(l, h)));
+    }
+    return i;
+}
+
+auto has_avx2() -> bool {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+auto has_ssse3() -> bool {
+    static const bool supported = __builtin_cpu_supports("ssse3");
+    return supported;
+}
+#endif
+
+constexpr std::size_t PARITY_HEADER_SIZE = 16;
+constexpr std::size_t PARITY_ENTRY_SIZE = 32;
+
+auto put_le(std::vector<std::byte>& out, uint64_t value, std::size_t bytes) -> void {
+    for (std::size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<std::byte>(value >> (8 * i)));
+    }
+}
+
+auto get_le(const std::byte* p, std::size_t bytes) -> uint64_t {
+    uint64_t value = 0;
+    for (std::size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(p[i]) << (8 * i);
+    }
+    return value;
+}
+
+struct parity_view {
+    uint64_t first_index = 0;
+    uint8_t row = 0;
+    std::vector<fec_entry> entries;
+    std::span<const std::byte> symbol;
+};
+
+auto malformed(const std::string& what) -> unexpected {
+    return unexpected(error{error_code::invalid_message, "malformed parity chunk: " + what});
+}
+
+auto parse_parity(const chunk& parity) -> result<parity_view> {
+    if (!parity.is_parity()) {
+        return malformed("not flagged as parity");
+    }
+    const auto& data = parity.data;
+    if (data.size() < PARITY_HEADER_SIZE) {
+        return malformed("truncated");
+    }
+
+    parity_view view;
+    view.first_index = get_le(data.data(), 8);
+    auto data_count = static_cast<std::size_t>(data[8]);
+    view.row = static_cast<uint8_t>(data[9]);
+    auto parity_count = static_cast<std::size_t>(data[10]);
+    auto symbol_size = static_cast<std::size_t>(get_le(data.data() + 12, 4));
+
+    if (data_count == 0 || view.row >= parity_count ||
+        data_count + parity_count > fec_config::max_group_chunks) {
+        return malformed("bad group layout");
+    }
+    if (view.first_index > UINT64_MAX - data_count) {
+        return malformed("index out of range");
+    }
+    if (symbol_size > chunk_config::max_chunk_size ||
+        data.size() != PARITY_HEADER_SIZE + data_count * PARITY_ENTRY_SIZE + symbol_size) {
+        return malformed("bad size");
+    }
+
+    const auto* p = data.data() + PARITY_HEADER_SIZE;
+    view.entries.reserve(data_count);
+    for (std::size_t i = 0; i < data_count; ++i, p += PARITY_ENTRY_SIZE) {
+        fec_entry e;
+        e.offset = get_le(p, 8);
+        e.original_size = static_cast<uint32_t>(get_le(p + 8, 4));
+        e.payload_size = static_cast<uint32_t>(get_le(p + 12, 4));
+        e.digest = get_le(p + 16, 8);
+        e.flags = static_cast<chunk_flags>(p[24]);
+        auto integrity = static_cast<uint8_t>(p[25]);
+        if (e.payload_size > symbol_size || !is_known_integrity(integrity) ||
+            is_parity(e.flags) || (is_zero_range(e.flags) && e.payload_size != 0)) {
+            return malformed("bad entry " + std::to_string(i));
+        }
+        e.integrity = static_cast<chunk_integrity>(integrity);
+        view.entries.push_back(e);
+    }
+    view.symbol = std::span<const std::byte>(p, symbol_size);
+    return view;
+}
+
+auto same_entry(const fec_entry& a, const fec_entry& b) -> bool {
+    return a.offset == b.offset && a.original_size == b.original_size &&
+           a.payload_size == b.payload_size && a.digest == b.digest && a.flags == b.flags &&
+           a.integrity == b.integrity;
+}
+
+// Inverts a square matrix over GF(2^8) in place; false if it is singular
+auto invert(std::vector<std::vector<uint8_t>>& m) -> bool {
+    auto n = m.size();
+    std::vector<std::vector<uint8_t>> inv(n, std::vector<uint8_t>(n, 0));
+    for (std::size_t i = 0; i < n; ++i) {
+        inv[i][i] = 1;
+    }
+
+    for (std::size_t col = 0; col < n; ++col) {
+        auto pivot = col;
+        while (pivot < n && m[pivot][col] == 0) {
+            ++pivot;
+        }
+        if (pivot == n) {
+            return false;
+        }
+        std::swap(m[pivot], m[col]);
+        std::swap(inv[pivot], inv[col]);
+
+        auto scale = gf_inv(m[col][col]);
+        for (std::size_t k = 0; k < n; ++k) {
+            m[col][k] = gf_mul(m[col][k], scale);
+            inv[col][k] = gf_mul(inv[col][k], scale);
+        }
+        for (std::size_t r = 0; r < n; ++r) {
+            auto factor = m[r][col];
+            if (r == col || factor == 0) {
+                continue;
+            }
+            for (std::size_t k = 0; k < n; ++k) {
+                m[r][k] ^= gf_mul(factor, m[col][k]);
+                inv[r][k] ^= gf_mul(factor, inv[col][k]);
+            }
+        }
+    }
+    m = std::move(inv);
+    return true;
+}
+
+// P(more than m of the k + m chunks of a group lost), losses independent
+auto group_failure(double p, std::size_t k, std::size_t m) -> double {
+    if (p >= 1.0) {
+        return 1.0;
+    }
+    auto n = static_cast<double>(k + m);
+    auto pmf = std::pow(1.0 - p, n);
+    auto recovered = 0.0;
+    for (std::size_t x = 0; x <= m; ++x) {
+        recovered += pmf;
+        pmf *= (n - static_cast<double>(x)) / static_cast<double>(x + 1) * p / (1.0 - p);
+    }
+    return std::max(0.0, 1.0 - recovered);
+}
+
+}  // namespace
+
+namespace fec {
+
+auto multiply_add(uint8_t coefficient, std::span<const std::byte> src, std::span<std::byte> dst)
+    -> void {
+    auto n = std::min(src.size(), dst.size());
+    const auto* s = reinterpret_cast<const uint8_t*>(src.data());
+    auto* d = reinterpret_cast<uint8_t*>(dst.data());
+    if (coefficient == 0) {
+        return;
+    }
+    if (coefficient == 1) {
+        for (std::size_t i = 0; i < n; ++i) {
+            d[i] ^= s[i];
+        }
+        return;
+    }
+
+    nibble_tables t(coefficient);
+    std::size_t done = 0;
+#if defined(FILE_TRANS_FEC_X86)
+    if (has_avx2()) {
+        done = multiply_add_avx2(t, s, d, n);
+    } else if (has_ssse3()) {
+        done = multiply_add_ssse3(t, s, d, n);
+    }
+#endif
+    for (auto i = done; i < n; ++i) {
+        d[i] ^= static_cast<uint8_t>(t.lo[s[i] & 0x0F] ^ t.hi[s[i] >> 4]);
+    }
+}
+
+auto coefficient(std::size_t row, std::size_t data_index) -> uint8_t {
+    // Cauchy matrix 1 / (x_j + y_i) with x_j = 255 - j and y_i = i; the two
+    // sets are disjoint while data chunks and parity rows number at most 256
+    return gf_inv(static_cast<uint8_t>((255 - row) ^ data_index));
+}
+
+}  // namespace fec
+
+auto fec_config::validate() const -> result<void> {
+    if (data_chunks == 0 || data_chunks >= max_group_chunks) {
+        return unexpected(error{error_code::invalid_configuration,
+                                "FEC group needs 1 to " + std::to_string(max_group_chunks - 1) +
+                                    " data chunks"});
+    }
+    if (data_chunks + parity_chunks > max_group_chunks) {
+        return unexpected(error{error_code::invalid_configuration,
+                                "FEC group larger than " + std::to_string(max_group_chunks) +
+                                    " chunks"});
+    }
+    return {};
+}
+
+auto fec_config::for_loss_rate(double chunk_loss_rate, std::size_t data_chunks,
+                               double target_failure) -> fec_config {
+    fec_config config;
+    config.data_chunks = std::clamp<std::size_t>(data_chunks, 1, max_group_chunks / 2);
+    auto k = config.data_chunks;
+    if (!(chunk_loss_rate > 0.0)) {
+        return config;
+    }
+    for (std::size_t m = 1; m < k; ++m) {
+        if (group_failure(chunk_loss_rate, k, m) <= target_failure) {
+            config.parity_chunks = m;
+            return config;
+        }
+    }
+    config.parity_chunks = k;
+    return config;
+}
+
+auto fec_config::for_link(double chunk_loss_rate, std::chrono::microseconds rtt,
+                          double bytes_per_second, std::size_t chunk_size,
+                          std::size_t data_chunks) -> fec_config {
+    fec_config config;
+    config.data_chunks = std::clamp<std::size_t>(data_chunks, 1, max_group_chunks / 2);
+    auto k = config.data_chunks;
+    if (!(chunk_loss_rate > 0.0) || !(bytes_per_second > 0.0)) {
+        return config;
+    }
+
+    auto chunk_seconds = static_cast<double>(chunk_size) / bytes_per_second;
+    auto rtt_seconds = std::chrono::duration<double>(rtt).count();
+    auto best = group_failure(chunk_loss_rate, k, 0) * rtt_seconds;
+    for (std::size_t m = 1; m <= k; ++m) {
+        auto cost = static_cast<double>(m) * chunk_seconds +
+                    group_failure(chunk_loss_rate, k, m) * rtt_seconds;
+        if (cost < best) {
+            best = cost;
+            config.parity_chunks = m;
+        }
+    }
+    return config;
+}
+
+fec_encoder::fec_encoder(fec_config config) : config_(config), next_config_(config) {}
+
+auto fec_encoder::add(const chunk& c) -> result<std::vector<chunk>> {
+    if (c.is_compressed() || is_encrypted(c.header.flags) || c.is_parity()) {
+        return unexpected(error{error_code::invalid_configuration,
+                                "FEC parity covers data chunks before compression and encryption"});
+    }
+
+    std::vector<chunk> out;
+    if (!entries_.empty() &&
+        (c.header.id != id_ || c.header.chunk_index != first_index_ + entries_.size())) {
+        out = flush();
+    }
+    if (entries_.empty()) {
+        config_ = next_config_;
+        if (!config_.enabled()) {
+            return out;
+        }
+        id_ = c.header.id;
+        first_index_ = c.header.chunk_index;
+        parity_.assign(config_.parity_chunks, {});
+    }
+
+    auto payload = std::span<const std::byte>(c.data);
+    auto position = entries_.size();
+    entries_.push_back(fec_entry{c.header.chunk_offset, c.header.original_size,
+                                 static_cast<uint32_t>(payload.size()), c.digest(),
+                                 c.header.flags, c.header.integrity});
+    for (std::size_t row = 0; row < parity_.size(); ++row) {
+        if (parity_[row].size() < payload.size()) {
+            parity_[row].resize(payload.size(), std::byte{0});
+        }
+        fec::multiply_add(fec::coefficient(row, position), payload, parity_[row]);
+    }
+
+    if (entries_.size() == config_.data_chunks) {
+        auto parity = flush();
+        std::move(parity.begin(), parity.end(), std::back_inserter(out));
+    }
+    return out;
+}
+
+auto fec_encoder::flush() -> std::vector<chunk> {
+    std::vector<chunk> out;
+    if (entries_.empty()) {
+        return out;
+    }
+
+    auto symbol_size = parity_.empty() ? std::size_t{0} : parity_.front().size();
+    std::vector<std::byte> descriptor;
+    descriptor.reserve(PARITY_HEADER_SIZE + entries_.size() * PARITY_ENTRY_SIZE);
+    put_le(descriptor, first_index_, 8);
+    put_le(descriptor, entries_.size(), 1);
+    put_le(descriptor, 0, 1);  // parity_row, filled in per chunk
+    put_le(descriptor, parity_.size(), 1);
+    put_le(descriptor, 0, 1);
+    put_le(descriptor, symbol_size, 4);
+    for (const auto& e : entries_) {
+        put_le(descriptor, e.offset, 8);
+        put_le(descriptor, e.original_size, 4);
+        put_le(descriptor, e.payload_size, 4);
+        put_le(descriptor, e.digest, 8);
+        put_le(descriptor, static_cast<uint8_t>(e.flags), 1);
+        put_le(descriptor, static_cast<uint8_t>(e.integrity), 1);
+        put_le(descriptor, 0, 6);
+    }
+
+    auto integrity = entries_.front().integrity;
+    out.reserve(parity_.size());
+    for (std::size_t row = 0; row < parity_.size(); ++row) {
+        chunk c;
+        c.data.reserve(descriptor.size() + symbol_size);
+        c.data = descriptor;
+        c.data[9] = static_cast<std::byte>(row);
+        c.data.insert(c.data.end(), parity_[row].begin(), parity_[row].end());
+
+        c.header.id = id_;
+        c.header.chunk_index = first_index_;
+        c.header.original_size = static_cast<uint32_t>(c.data.size());
+        c.header.compressed_size = c.header.original_size;
+        c.header.flags = chunk_flags::parity;
+        c.set_digest(integrity, checksum::digest(integrity, c.data));
+        out.push_back(std::move(c));
+    }
+
+    entries_.clear();
+    parity_.clear();
+    return out;
+}
+
+auto fec_encoder::set_config(const fec_config& config) -> void {
+    next_config_ = config;
+}
+
+auto fec_group::from_parity(const chunk& parity) -> result<fec_group> {
+    auto view = parse_parity(parity);
+    if (!view.has_value()) {
+        return unexpected(view.error());
+    }
+    fec_group group;
+    group.first_index_ = view.value().first_index;
+    group.symbol_size_ = view.value().symbol.size();
+    group.entries_ = std::move(view.value().entries);
+    group.rows_.emplace(view.value().row,
+                        std::vector<std::byte>(view.value().symbol.begin(),
+                                               view.value().symbol.end()));
+    return group;
+}
+
+auto fec_group::add_parity(const chunk& parity) -> result<void> {
+    auto view = parse_parity(parity);
+    if (!view.has_value()) {
+        return unexpected(view.error());
+    }
+    const auto& v = view.value();
+    if (v.first_index != first_index_ || v.symbol.size() != symbol_size_ ||
+        !std::equal(v.entries.begin(), v.entries.end(), entries_.begin(), entries_.end(),
+                    same_entry)) {
+        return malformed("does not match its group");
+    }
+    if (!rows_.contains(v.row)) {
+        rows_.emplace(v.row, std::vector<std::byte>(v.symbol.begin(), v.symbol.end()));
+    }
+    return {};
+}
+
+auto fec_group::recover(
+    const transfer_id& id,
+    std::span<const uint64_t> missing,
+    const std::function<result<std::vector<std::byte>>(uint64_t)>& read) const
+    -> result<std::vector<chunk>> {
+    if (missing.empty()) {
+        return std::vector<chunk>{};
+    }
+    if (missing.size() > rows_.size()) {
+        return unexpected(error{error_code::missing_chunks,
+                                std::to_string(missing.size()) + " chunks lost, " +
+                                    std::to_string(rows_.size()) + " parity chunks held"});
+    }
+
+    std::vector<std::size_t> lost;
+    std::vector<bool> is_lost(entries_.size(), false);
+    for (auto index : missing) {
+        if (!contains(index) || is_lost[index - first_index_]) {
+            return unexpected(error{error_code::invalid_chunk_index,
+                                    "chunk " + std::to_string(index) + " not in FEC group"});
+        }
+        lost.push_back(static_cast<std::size_t>(index - first_index_));
+        is_lost[lost.back()] = true;
+    }
+
+    // One parity row per lost chunk; subtract the chunks that did arrive
+    std::vector<uint8_t> rows;
+    std::vector<std::vector<std::byte>> syndromes;
+    for (auto it = rows_.begin(); rows.size() < lost.size(); ++it) {
+        rows.push_back(it->first);
+        syndromes.push_back(it->second);
+    }
+    for (std::size_t i = 0; i < entries_.size(); ++i) {
+        if (is_lost[i] || entries_[i].payload_size == 0) {
+            continue;
+        }
+        auto payload = read(first_index_ + i);
+        if (!payload.has_value()) {
+            return unexpected(payload.error());
+        }
+        if (payload.value().size() != entries_[i].payload_size) {
+            return unexpected(error{error_code::chunk_size_error,
+                                    "chunk " + std::to_string(first_index_ + i) +
+                                        " differs from its FEC description"});
+        }
+        for (std::size_t r = 0; r < rows.size(); ++r) {
+            fec::multiply_add(fec::coefficient(rows[r], i), payload.value(), syndromes[r]);
+        }
+    }
+
+    // Solve coefficients(rows, lost) * lost data = syndromes
+    std::vector<std::vector<uint8_t>> matrix(lost.size(), std::vector<uint8_t>(lost.size()));
+    for (std::size_t r = 0; r < rows.size(); ++r) {
+        for (std::size_t k = 0; k < lost.size(); ++k) {
+            matrix[r][k] = fec::coefficient(rows[r], lost[k]);
+        }
+    }
+    if (!invert(matrix)) {
+        return unexpected(error{error_code::internal_error, "singular FEC matrix"});
+    }
+
+    std::vector<chunk> rebuilt;
+    rebuilt.reserve(lost.size());
+    for (std::size_t k = 0; k < lost.size(); ++k) {
+        const auto& e = entries_[lost[k]];
+        chunk c;
+        c.data.assign(symbol_size_, std::byte{0});
+        for (std::size_t r = 0; r < rows.size(); ++r) {
+            fec::multiply_add(matrix[k][r], syndromes[r], c.data);
+        }
+        c.data.resize(e.payload_size);
+
+        c.header.id = id;
+        c.header.chunk_index = first_index_ + lost[k];
+        c.header.chunk_offset = e.offset;
+        c.header.original_size = e.original_size;
+        c.header.compressed_size = e.payload_size;
+        c.header.flags = e.flags;
+        c.set_digest(e.integrity, e.digest);
+        rebuilt.push_back(std::move(c));
+    }
+    return rebuilt;
+}
+
+}  // namespace kcenon::file_transfer
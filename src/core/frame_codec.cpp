@@ -0,0 +1,447 @@
+/**
+ * @file frame_codec.cpp
+ * @brief Wire frame encoding and incremental stream decoding
+ */
+
+#include "kcenon/file_transfer/core/frame_codec.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <string>
+
+namespace kcenon::file_transfer {
+
+namespace {
+
+constexpr std::array<uint8_t, 4> magic_bytes{
+    static_cast<uint8_t>(protocol_magic >> 24), static_cast<uint8_t>(protocol_magic >> 16),
+    static_cast<uint8_t>(protocol_magic >> 8), static_cast<uint8_t>(protocol_magic)};
+
+auto frame_checksum(const uint8_t* data, std::size_t size) -> uint16_t {
+    uint32_t sum = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        sum += data[i];
+    }
+    return static_cast<uint16_t>(sum);
+}
+
+auto load_u16(const uint8_t* p) -> uint16_t {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+auto load_u32(const uint8_t* p) -> uint32_t {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+auto load_u64(const uint8_t* p) -> uint64_t {
+    return (static_cast<uint64_t>(load_u32(p)) << 32) | load_u32(p + 4);
+}
+
+// Appends big-endian fields to a payload
+class payload_writer {
+public:
+    explicit payload_writer(std::size_t reserve) { out_.reserve(reserve); }
+
+    void u8(uint8_t v) { out_.push_back(v); }
+
+    void u16(uint16_t v) {
+        out_.push_back(static_cast<uint8_t>(v >> 8));
+        out_.push_back(static_cast<uint8_t>(v));
+    }
+
+    void u32(uint32_t v) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out_.push_back(static_cast<uint8_t>(v >> shift));
+        }
+    }
+
+    void u64(uint64_t v) {
+        u32(static_cast<uint32_t>(v >> 32));
+        u32(static_cast<uint32_t>(v));
+    }
+
+    void bytes(std::span<const uint8_t> data) { out_.insert(out_.end(), data.begin(), data.end()); }
+
+    void bytes(std::span<const std::byte> data) {
+        auto* p = reinterpret_cast<const uint8_t*>(data.data());
+        out_.insert(out_.end(), p, p + data.size());
+    }
+
+    // 2-byte length prefix; longer strings are truncated
+    void str(const std::string& s) {
+        auto size = std::min<std::size_t>(s.size(), std::numeric_limits<uint16_t>::max());
+        u16(static_cast<uint16_t>(size));
+        out_.insert(out_.end(), s.begin(), s.begin() + static_cast<std::ptrdiff_t>(size));
+    }
+
+    auto take() -> std::vector<uint8_t> { return std::move(out_); }
+
+private:
+    std::vector<uint8_t> out_;
+};
+
+// Reads big-endian fields; any read past the end marks the reader failed
+class payload_reader {
+public:
+    explicit payload_reader(std::span<const uint8_t> data) : data_(data) {}
+
+    auto u8() -> uint8_t { return take(1) ? data_[pos_ - 1] : 0; }
+    auto u16() -> uint16_t { return take(2) ? load_u16(&data_[pos_ - 2]) : 0; }
+    auto u32() -> uint32_t { return take(4) ? load_u32(&data_[pos_ - 4]) : 0; }
+    auto u64() -> uint64_t { return take(8) ? load_u64(&data_[pos_ - 8]) : 0; }
+
+    auto id() -> std::array<uint8_t, 16> {
+        std::array<uint8_t, 16> out{};
+        if (take(out.size())) {
+            std::copy_n(&data_[pos_ - out.size()], out.size(), out.begin());
+        }
+        return out;
+    }
+
+    auto str() -> std::string {
+        auto size = u16();
+        if (!take(size)) {
+            return {};
+        }
+        return std::string(reinterpret_cast<const char*>(&data_[pos_ - size]), size);
+    }
+
+    auto rest() -> std::span<const uint8_t> {
+        auto tail = data_.subspan(std::min(pos_, data_.size()));
+        pos_ = data_.size();
+        return tail;
+    }
+
+    [[nodiscard]] auto ok() const -> bool { return ok_; }
+    [[nodiscard]] auto at_end() const -> bool { return pos_ == data_.size(); }
+
+private:
+    auto take(std::size_t n) -> bool {
+        if (!ok_ || data_.size() - pos_ < n) {
+            ok_ = false;
+            return false;
+        }
+        pos_ += n;
+        return true;
+    }
+
+    std::span<const uint8_t> data_;
+    std::size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+// Fixed-size messages must consume the payload exactly
+template <typename T>
+auto finish(const payload_reader& reader, T msg, const char* name) -> result<T> {
+    if (!reader.ok() || !reader.at_end()) {
+        return unexpected{error{error_code::invalid_message,
+                               std::string("malformed ") + name + " payload"}};
+    }
+    return msg;
+}
+
+}  // namespace
+
+auto encode_frame(message_type type, std::span<const uint8_t> payload)
+    -> std::vector<uint8_t> {
+    payload_writer writer(frame_header::total_overhead + payload.size());
+    writer.u32(protocol_magic);
+    writer.u8(static_cast<uint8_t>(type));
+    writer.u32(static_cast<uint32_t>(payload.size()));
+    writer.bytes(payload);
+    auto out = writer.take();
+
+    auto sum = frame_checksum(out.data(), out.size());
+    auto echo = static_cast<uint16_t>(payload.size());
+    out.push_back(static_cast<uint8_t>(sum >> 8));
+    out.push_back(static_cast<uint8_t>(sum));
+    out.push_back(static_cast<uint8_t>(echo >> 8));
+    out.push_back(static_cast<uint8_t>(echo));
+    return out;
+}
+
+// ----------------------------------------------------------------------------
+// frame_decoder
+// ----------------------------------------------------------------------------
+
+frame_decoder::frame_decoder(std::size_t max_payload) : max_payload_(max_payload) {}
+
+void frame_decoder::feed(std::span<const uint8_t> data) {
+    buffer_.insert(buffer_.end(), data.begin(), data.end());
+}
+
+auto frame_decoder::next() -> std::optional<frame> {
+    while (true) {
+        auto available = buffer_.size() - read_pos_;
+        if (available < frame_header::size) {
+            compact();
+            return std::nullopt;
+        }
+
+        const auto* p = buffer_.data() + read_pos_;
+        auto payload_length = load_u32(p + 5);
+        bool valid = load_u32(p) == protocol_magic && payload_length <= max_payload_;
+
+        if (valid) {
+            auto total = frame_header::total_overhead + payload_length;
+            if (available < total) {
+                compact();
+                return std::nullopt;
+            }
+            auto body = frame_header::size + payload_length;
+            valid = frame_checksum(p, body) == load_u16(p + body) &&
+                    static_cast<uint16_t>(payload_length) == load_u16(p + body + 2);
+            if (valid) {
+                frame f;
+                f.type = static_cast<message_type>(p[4]);
+                f.payload.assign(p + frame_header::size, p + body);
+                read_pos_ += total;
+                return f;
+            }
+        }
+
+        // Discard and rescan from the byte after the bad prefix
+        ++discarded_;
+        auto begin = buffer_.begin() + static_cast<std::ptrdiff_t>(read_pos_ + 1);
+        auto found = std::search(begin, buffer_.end(), magic_bytes.begin(), magic_bytes.end());
+        if (found == buffer_.end()) {
+            // Keep a possible partial prefix at the tail
+            auto keep = std::min<std::size_t>(magic_bytes.size() - 1, buffer_.size() - read_pos_ - 1);
+            read_pos_ = buffer_.size() - keep;
+        } else {
+            read_pos_ = static_cast<std::size_t>(found - buffer_.begin());
+        }
+    }
+}
+
+auto frame_decoder::buffered() const -> std::size_t {
+    return buffer_.size() - read_pos_;
+}
+
+void frame_decoder::reset() {
+    buffer_.clear();
+    read_pos_ = 0;
+}
+
+void frame_decoder::compact() {
+    if (read_pos_ == buffer_.size()) {
+        buffer_.clear();
+        read_pos_ = 0;
+    } else if (read_pos_ > buffer_.size() / 2) {
+        buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(read_pos_));
+        read_pos_ = 0;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Message payloads
+// ----------------------------------------------------------------------------
+
+auto encode_chunk_data(const chunk& c) -> std::vector<uint8_t> {
+    payload_writer writer(c.total_size());
+    writer.bytes(std::span<const uint8_t>(c.header.id.bytes));
+    writer.u64(c.header.chunk_index);
+    writer.u64(c.header.chunk_offset);
+    writer.u32(c.header.original_size);
+    writer.u32(static_cast<uint32_t>(c.data.size()));
+    writer.u32(c.header.checksum);
+    writer.u8(static_cast<uint8_t>(c.header.flags));
+    writer.u8(static_cast<uint8_t>(c.header.integrity));
+    writer.u16(0);
+    writer.bytes(std::span<const std::byte>(c.data));
+    // 64-bit digests carry their high half after the data
+    if (checksum_size(c.header.integrity) == 8) {
+        writer.u32(c.checksum_high);
+    }
+    return writer.take();
+}
+
+auto decode_chunk_data(std::span<const uint8_t> payload) -> result<chunk> {
+    payload_reader reader(payload);
+    chunk c;
+    c.header.id = transfer_id(reader.id());
+    c.header.chunk_index = reader.u64();
+    c.header.chunk_offset = reader.u64();
+    c.header.original_size = reader.u32();
+    c.header.compressed_size = reader.u32();
+    c.header.checksum = reader.u32();
+    c.header.flags = static_cast<chunk_flags>(reader.u8());
+    auto integrity = reader.u8();
+    (void)reader.u16();
+    if (!reader.ok()) {
+        return unexpected{error{error_code::invalid_message, "truncated chunk header"}};
+    }
+    if (!is_known_integrity(integrity)) {
+        return unexpected{error{error_code::invalid_message,
+                               "unknown chunk integrity algorithm " + std::to_string(integrity)}};
+    }
+    c.header.integrity = static_cast<chunk_integrity>(integrity);
+
+    auto data = reader.rest();
+    if (checksum_size(c.header.integrity) == 8) {
+        if (data.size() < 4) {
+            return unexpected{error{error_code::invalid_message, "truncated chunk checksum"}};
+        }
+        c.checksum_high = load_u32(data.data() + data.size() - 4);
+        data = data.first(data.size() - 4);
+    }
+    if (data.size() != c.header.compressed_size) {
+        return unexpected{error{error_code::chunk_size_error,
+                               "chunk data size does not match header"}};
+    }
+    auto* first = reinterpret_cast<const std::byte*>(data.data());
+    c.data.assign(first, first + data.size());
+    return c;
+}
+
+auto encode_upload_request(const msg_upload_request& msg) -> std::vector<uint8_t> {
+    payload_writer writer(msg_upload_request::min_serialized_size + msg.filename.size());
+    writer.bytes(std::span<const uint8_t>(msg.transfer_id));
+    writer.str(msg.filename);
+    writer.u64(msg.file_size);
+    writer.bytes(std::span<const uint8_t>(msg.sha256_hash));
+    writer.u8(static_cast<uint8_t>(msg.compression));
+    writer.u8(static_cast<uint8_t>(msg.encryption));
+    writer.u32(static_cast<uint32_t>(msg.options));
+    writer.u64(msg.resume_from);
+    return writer.take();
+}
+
+auto decode_upload_request(std::span<const uint8_t> payload) -> result<msg_upload_request> {
+    payload_reader reader(payload);
+    msg_upload_request msg;
+    msg.transfer_id = reader.id();
+    msg.filename = reader.str();
+    msg.file_size = reader.u64();
+    for (auto& b : msg.sha256_hash) {
+        b = reader.u8();
+    }
+    msg.compression = static_cast<wire_compression_mode>(reader.u8());
+    msg.encryption = static_cast<wire_encryption_algorithm>(reader.u8());
+    msg.options = static_cast<transfer_options>(reader.u32());
+    msg.resume_from = reader.u64();
+    return finish(reader, std::move(msg), "UPLOAD_REQUEST");
+}
+
+auto encode_upload_accept(const msg_upload_accept& msg) -> std::vector<uint8_t> {
+    payload_writer writer(msg_upload_accept::serialized_size);
+    writer.bytes(std::span<const uint8_t>(msg.transfer_id));
+    writer.u8(static_cast<uint8_t>(msg.compression));
+    writer.u8(static_cast<uint8_t>(msg.encryption));
+    writer.u32(msg.chunk_size);
+    writer.u64(msg.resume_offset);
+    return writer.take();
+}
+
+auto decode_upload_accept(std::span<const uint8_t> payload) -> result<msg_upload_accept> {
+    payload_reader reader(payload);
+    msg_upload_accept msg;
+    msg.transfer_id = reader.id();
+    msg.compression = static_cast<wire_compression_mode>(reader.u8());
+    msg.encryption = static_cast<wire_encryption_algorithm>(reader.u8());
+    msg.chunk_size = reader.u32();
+    msg.resume_offset = reader.u64();
+    return finish(reader, msg, "UPLOAD_ACCEPT");
+}
+
+auto encode_upload_reject(const msg_upload_reject& msg) -> std::vector<uint8_t> {
+    payload_writer writer(msg_upload_reject::min_serialized_size + msg.message.size());
+    writer.bytes(std::span<const uint8_t>(msg.transfer_id));
+    writer.u32(static_cast<uint32_t>(msg.reason_code));
+    writer.str(msg.message);
+    return writer.take();
+}
+
+auto decode_upload_reject(std::span<const uint8_t> payload) -> result<msg_upload_reject> {
+    payload_reader reader(payload);
+    msg_upload_reject msg;
+    msg.transfer_id = reader.id();
+    msg.reason_code = static_cast<int32_t>(reader.u32());
+    msg.message = reader.str();
+    return finish(reader, std::move(msg), "UPLOAD_REJECT");
+}
+
+auto encode_upload_complete(const msg_upload_complete& msg) -> std::vector<uint8_t> {
+    const bool digest = msg.has_digest();
+    payload_writer writer(digest ? msg_upload_complete::serialized_size_with_digest
+                                 : msg_upload_complete::serialized_size);
+    writer.bytes(std::span<const uint8_t>(msg.transfer_id));
+    writer.u64(msg.total_chunks);
+    writer.u64(msg.bytes_sent);
+    writer.u64(msg.bytes_on_wire);
+    if (digest) {
+        writer.bytes(std::span<const uint8_t>(msg.sha256_hash));
+    }
+    return writer.take();
+}
+
+auto decode_upload_complete(std::span<const uint8_t> payload) -> result<msg_upload_complete> {
+    payload_reader reader(payload);
+    msg_upload_complete msg;
+    msg.transfer_id = reader.id();
+    msg.total_chunks = reader.u64();
+    msg.bytes_sent = reader.u64();
+    msg.bytes_on_wire = reader.u64();
+    // The trailing digest is optional (deferred_digest uploads)
+    if (reader.ok() && !reader.at_end()) {
+        for (auto& b : msg.sha256_hash) {
+            b = reader.u8();
+        }
+    }
+    return finish(reader, msg, "UPLOAD_COMPLETE");
+}
+
+auto encode_upload_ack(const msg_upload_ack& msg) -> std::vector<uint8_t> {
+    payload_writer writer(msg_upload_ack::min_serialized_size + msg.stored_path.size());
+    writer.bytes(std::span<const uint8_t>(msg.transfer_id));
+    writer.u8(msg.verified);
+    writer.str(msg.stored_path);
+    return writer.take();
+}
+
+auto decode_upload_ack(std::span<const uint8_t> payload) -> result<msg_upload_ack> {
+    payload_reader reader(payload);
+    msg_upload_ack msg;
+    msg.transfer_id = reader.id();
+    msg.verified = reader.u8();
+    msg.stored_path = reader.str();
+    return finish(reader, std::move(msg), "UPLOAD_ACK");
+}
+
+auto encode_chunk_ack(const msg_chunk_ack& msg) -> std::vector<uint8_t> {
+    payload_writer writer(msg_chunk_ack::serialized_size);
+    writer.bytes(std::span<const uint8_t>(msg.transfer_id));
+    writer.u64(msg.chunk_index);
+    return writer.take();
+}
+
+auto decode_chunk_ack(std::span<const uint8_t> payload) -> result<msg_chunk_ack> {
+    payload_reader reader(payload);
+    msg_chunk_ack msg;
+    msg.transfer_id = reader.id();
+    msg.chunk_index = reader.u64();
+    return finish(reader, msg, "CHUNK_ACK");
+}
+
+auto encode_chunk_nack(const msg_chunk_nack& msg) -> std::vector<uint8_t> {
+    payload_writer writer(msg_chunk_nack::serialized_size);
+    writer.bytes(std::span<const uint8_t>(msg.transfer_id));
+    writer.u64(msg.chunk_index);
+    writer.u32(static_cast<uint32_t>(msg.reason_code));
+    writer.u32(0);
+    return writer.take();
+}
+
+auto decode_chunk_nack(std::span<const uint8_t> payload) -> result<msg_chunk_nack> {
+    payload_reader reader(payload);
+    msg_chunk_nack msg;
+    msg.transfer_id = reader.id();
+    msg.chunk_index = reader.u64();
+    msg.reason_code = static_cast<int32_t>(reader.u32());
+    msg.reserved = reader.u32();
+    return finish(reader, msg, "CHUNK_NACK");
+}
+
+}  // namespace kcenon::file_transfer
@@ -0,0 +1,68 @@
+/**
+ * @file integrity_policy.cpp
+ * @brief Integrity policy engine and checksum cost model
+ */
+
+#include "kcenon/file_transfer/core/integrity_policy.h"
+
+#include "kcenon/file_transfer/core/checksum.h"
+
+#include <vector>
+
+namespace kcenon::file_transfer {
+
+namespace {
+
+// Scratch buffer size used to price an algorithm no check has measured yet
+constexpr std::size_t calibration_bytes = 256 * 1024;
+
+auto slot(chunk_integrity algorithm) -> std::size_t {
+    return static_cast<std::size_t>(algorithm);
+}
+
+}  // namespace
+
+auto integrity_policy::record_check(chunk_integrity algorithm, std::size_t bytes,
+                                    std::chrono::nanoseconds elapsed) -> void {
+    if (bytes == 0 || slot(algorithm) >= algorithm_count) {
+        return;
+    }
+    auto sample = static_cast<double>(elapsed.count()) / static_cast<double>(bytes);
+    auto& cost = ns_per_byte_[slot(algorithm)];
+
+    // Lost updates between racing workers only drop a sample
+    auto current = cost.load(std::memory_order_relaxed);
+    auto next = current < 0.0 ? sample : current + smoothing * (sample - current);
+    cost.compare_exchange_strong(current, next, std::memory_order_relaxed);
+}
+
+auto integrity_policy::estimate_cost(chunk_integrity algorithm, std::size_t bytes)
+    -> std::chrono::nanoseconds {
+    if (slot(algorithm) >= algorithm_count || !checksum::is_supported(algorithm)) {
+        return std::chrono::nanoseconds{0};
+    }
+
+    auto cost = ns_per_byte(algorithm);
+    if (cost < 0.0) {
+        std::vector<std::byte> scratch(calibration_bytes, std::byte{0x5A});
+        auto start = std::chrono::steady_clock::now();
+        auto digest = checksum::digest(algorithm, scratch);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        // Keep the digest observable so the call is not optimised away
+        scratch[0] = static_cast<std::byte>(digest);
+
+        record_check(algorithm, scratch.size(),
+                     std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+        cost = ns_per_byte(algorithm);
+    }
+    return std::chrono::nanoseconds(static_cast<int64_t>(cost * static_cast<double>(bytes)));
+}
+
+auto integrity_policy::ns_per_byte(chunk_integrity algorithm) const -> double {
+    if (slot(algorithm) >= algorithm_count) {
+        return -1.0;
+    }
+    return ns_per_byte_[slot(algorithm)].load(std::memory_order_relaxed);
+}
+
+}  // namespace kcenon::file_transfer
@@ -0,0 +1,379 @@
+/**
+ * @file io_executor.cpp
+ * @brief Shared bounded executor implementation
+ */
+
+#include "kcenon/file_transfer/core/io_executor.h"
+
+#include <algorithm>
+#include <deque>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+
+namespace kcenon::file_transfer {
+
+namespace {
+
+thread_local const void* current_executor = nullptr;
+thread_local bool current_task_blocking = false;
+
+auto default_worker_count() -> std::size_t {
+    auto hardware = static_cast<std::size_t>(std::thread::hardware_concurrency());
+    return std::clamp<std::size_t>(hardware * 2, 4, 64);
+}
+
+}  // namespace
+
+struct io_executor::impl {
+    using clock = std::chrono::steady_clock;
+
+    struct lane_state {
+        std::string name;
+        std::size_t limit = 0;  // 0 = default
+        bool blocking = false;
+        std::size_t active = 0;
+        std::deque<job> queue;
+        uint64_t completed = 0;
+        uint64_t cancelled = 0;
+    };
+
+    struct delayed_job {
+        clock::time_point due;
+        uint64_t sequence = 0;
+        lane_state* lane = nullptr;
+        mutable job task;
+
+        auto operator>(const delayed_job& other) const -> bool {
+            return due != other.due ? due > other.due : sequence > other.sequence;
+        }
+    };
+
+    io_executor_config config;
+
+    mutable std::mutex mutex;
+    std::condition_variable work_available;
+
+    std::unordered_map<std::string, std::unique_ptr<lane_state>> lanes;
+    std::vector<lane_state*> lane_order;  // Round-robin order of lanes
+    std::size_t next_lane = 0;
+
+    std::priority_queue<delayed_job, std::vector<delayed_job>, std::greater<>> delayed;
+    uint64_t delayed_sequence = 0;
+
+    std::size_t queued = 0;
+    std::size_t peak_queued = 0;
+    std::size_t active = 0;
+    std::size_t active_blocking = 0;
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    uint64_t cancelled = 0;
+    uint64_t rejected = 0;
+    bool stopping = false;
+
+    std::vector<std::thread> workers;
+
+    explicit impl(io_executor_config cfg) : config(cfg) {
+        if (config.worker_count == 0) {
+            config.worker_count = default_worker_count();
+        }
+        if (config.default_lane_limit == 0) {
+            config.default_lane_limit = config.worker_count;
+        }
+        if (config.max_blocking_workers == 0) {
+            config.max_blocking_workers = std::max<std::size_t>(config.worker_count / 2, 1);
+        }
+    }
+
+    // True when blocking tasks may hold every worker; nested work they wait
+    // on then has to run inline
+    [[nodiscard]] auto no_spare_workers() const -> bool {
+        return config.max_blocking_workers >= config.worker_count;
+    }
+
+    // Caller must hold mutex
+    auto lane_for(std::string_view name) -> lane_state& {
+        auto it = lanes.find(std::string(name));
+        if (it == lanes.end()) {
+            auto state = std::make_unique<lane_state>();
+            state->name = std::string(name);
+            lane_order.push_back(state.get());
+            it = lanes.emplace(state->name, std::move(state)).first;
+        }
+        return *it->second;
+    }
+
+    [[nodiscard]] auto limit_of(const lane_state& lane) const -> std::size_t {
+        return lane.limit > 0 ? lane.limit : config.default_lane_limit;
+    }
+
+    // Caller must hold mutex
+    auto push_ready(lane_state& lane, job task) -> void {
+        lane.queue.push_back(std::move(task));
+        ++queued;
+        peak_queued = std::max(peak_queued, queued);
+    }
+
+    // Caller must hold mutex; moves due delayed jobs into their lanes
+    auto promote_due(clock::time_point now) -> void {
+        while (!delayed.empty() && delayed.top().due <= now) {
+            auto& top = delayed.top();
+            auto* lane = top.lane;
+            auto task = std::move(top.task);
+            delayed.pop();
+            push_ready(*lane, std::move(task));
+        }
+    }
+
+    // Caller must hold mutex; picks the next lane with queued work and a free slot
+    auto pick_lane() -> lane_state* {
+        for (std::size_t i = 0; i < lane_order.size(); ++i) {
+            auto* lane = lane_order[(next_lane + i) % lane_order.size()];
+            if (!lane->queue.empty() && lane->active < limit_of(*lane) &&
+                (!lane->blocking || active_blocking < config.max_blocking_workers)) {
+                next_lane = (next_lane + i + 1) % lane_order.size();
+                return lane;
+            }
+        }
+        return nullptr;
+    }
+
+    auto worker_loop(const io_executor* owner) -> void {
+        current_executor = owner;
+        std::unique_lock lock(mutex);
+
+        while (true) {
+            promote_due(clock::now());
+
+            if (auto* lane = pick_lane()) {
+                auto task = std::move(lane->queue.front());
+                lane->queue.pop_front();
+                --queued;
+                ++lane->active;
+                ++active;
+                bool blocking = lane->blocking;
+                if (blocking) {
+                    ++active_blocking;
+                }
+                lock.unlock();
+
+                bool was_cancelled = task.token.is_cancelled();
+                std::function<void()> publish;
+                if (was_cancelled) {
+                    publish = [drop = std::move(task.drop)] {
+                        drop(error_code::operation_cancelled);
+                    };
+                } else {
+                    current_task_blocking = blocking;
+                    publish = task.run();
+                    current_task_blocking = false;
+                }
+                // Release captured state before reporting completion
+                task = job{};
+
+                lock.lock();
+                --lane->active;
+                --active;
+                if (blocking) {
+                    --active_blocking;
+                }
+                if (was_cancelled) {
+                    ++lane->cancelled;
+                    ++cancelled;
+                } else {
+                    ++lane->completed;
+                    ++completed;
+                }
+                // A slot of this lane was freed; another worker may be parked on it
+                if (!lane->queue.empty()) {
+                    work_available.notify_one();
+                }
+
+                // Counters first, so a caller woken by its future sees them settled
+                lock.unlock();
+                publish();
+                publish = nullptr;
+                lock.lock();
+                continue;
+            }
+
+            if (stopping) {
+                break;
+            }
+
+            if (!delayed.empty()) {
+                work_available.wait_until(lock, delayed.top().due);
+            } else {
+                work_available.wait(lock);
+            }
+        }
+
+        current_executor = nullptr;
+    }
+};
+
+io_executor::io_executor(io_executor_config config)
+    : impl_(std::make_unique<impl>(config)) {
+    impl_->workers.reserve(impl_->config.worker_count);
+    for (std::size_t i = 0; i < impl_->config.worker_count; ++i) {
+        impl_->workers.emplace_back([this] { impl_->worker_loop(this); });
+    }
+}
+
+io_executor::~io_executor() {
+    shutdown();
+}
+
+auto io_executor::shared() -> io_executor& {
+    static io_executor instance;
+    return instance;
+}
+
+auto io_executor::on_worker_thread() -> bool {
+    return current_executor != nullptr;
+}
+
+auto io_executor::on_blocking_task() -> bool {
+    return current_task_blocking;
+}
+
+auto io_executor::enqueue(std::string_view lane,
+                          std::chrono::steady_clock::duration delay,
+                          job task) -> void {
+    error_code failure = error_code::success;
+    bool run_inline = false;
+    {
+        std::lock_guard lock(impl_->mutex);
+        // A blocking task that waits on another blocking task would take a
+        // second blocking slot, and may wait for it forever; run it inline.
+        // With no spare workers, nothing else could run the nested task.
+        if (delay <= std::chrono::steady_clock::duration::zero() &&
+            current_executor == this && current_task_blocking &&
+            (impl_->lane_for(lane).blocking || impl_->no_spare_workers())) {
+            run_inline = true;
+        } else if (impl_->stopping) {
+            failure = error_code::operation_cancelled;
+            ++impl_->cancelled;
+        } else if (impl_->config.max_queue_depth > 0 &&
+                   impl_->queued + impl_->delayed.size() >= impl_->config.max_queue_depth) {
+            failure = error_code::queue_full;
+            ++impl_->rejected;
+        } else {
+            ++impl_->submitted;
+            auto& state = impl_->lane_for(lane);
+            if (delay > std::chrono::steady_clock::duration::zero()) {
+                impl_->delayed.push(impl::delayed_job{
+                    impl::clock::now() + delay, impl_->delayed_sequence++, &state,
+                    std::move(task)});
+                // Re-arm the earliest deadline
+                impl_->work_available.notify_all();
+                return;
+            }
+            impl_->push_ready(state, std::move(task));
+        }
+    }
+
+    if (run_inline) {
+        if (task.token.is_cancelled()) {
+            task.drop(error_code::operation_cancelled);
+        } else {
+            task.run()();
+        }
+        return;
+    }
+    if (failure != error_code::success) {
+        task.drop(failure);
+        return;
+    }
+    impl_->work_available.notify_one();
+}
+
+auto io_executor::set_lane_limit(std::string_view lane, std::size_t max_concurrent) -> void {
+    {
+        std::lock_guard lock(impl_->mutex);
+        impl_->lane_for(lane).limit = max_concurrent;
+    }
+    impl_->work_available.notify_all();
+}
+
+auto io_executor::set_lane_blocking(std::string_view lane, bool blocking) -> void {
+    {
+        std::lock_guard lock(impl_->mutex);
+        impl_->lane_for(lane).blocking = blocking;
+    }
+    impl_->work_available.notify_all();
+}
+
+auto io_executor::metrics() const -> io_executor_metrics {
+    std::lock_guard lock(impl_->mutex);
+
+    io_executor_metrics m;
+    m.worker_count = impl_->workers.size();
+    m.queue_depth = impl_->queued;
+    m.peak_queue_depth = impl_->peak_queued;
+    m.active_tasks = impl_->active;
+    m.active_blocking = impl_->active_blocking;
+    m.delayed_tasks = impl_->delayed.size();
+    m.submitted = impl_->submitted;
+    m.completed = impl_->completed;
+    m.cancelled = impl_->cancelled;
+    m.rejected = impl_->rejected;
+
+    m.lanes.reserve(impl_->lane_order.size());
+    for (const auto* lane : impl_->lane_order) {
+        io_lane_metrics lm;
+        lm.name = lane->name;
+        lm.concurrency_limit = impl_->limit_of(*lane);
+        lm.blocking = lane->blocking;
+        lm.active = lane->active;
+        lm.queued = lane->queue.size();
+        lm.completed = lane->completed;
+        lm.cancelled = lane->cancelled;
+        m.lanes.push_back(std::move(lm));
+    }
+    return m;
+}
+
+auto io_executor::worker_count() const -> std::size_t {
+    return impl_->config.worker_count;
+}
+
+auto io_executor::shutdown() -> void {
+    std::vector<job> abandoned;
+    {
+        std::lock_guard lock(impl_->mutex);
+        if (impl_->stopping) {
+            return;
+        }
+        impl_->stopping = true;
+
+        for (auto* lane : impl_->lane_order) {
+            lane->cancelled += lane->queue.size();
+            for (auto& task : lane->queue) {
+                abandoned.push_back(std::move(task));
+            }
+            lane->queue.clear();
+        }
+        while (!impl_->delayed.empty()) {
+            impl_->delayed.top().lane->cancelled++;
+            abandoned.push_back(std::move(impl_->delayed.top().task));
+            impl_->delayed.pop();
+        }
+        impl_->cancelled += abandoned.size();
+        impl_->queued = 0;
+    }
+    impl_->work_available.notify_all();
+
+    for (auto& task : abandoned) {
+        task.drop(error_code::operation_cancelled);
+    }
+    abandoned.clear();
+
+    for (auto& worker : impl_->workers) {
+        if (worker.joinable() && worker.get_id() != std::this_thread::get_id()) {
+            worker.join();
+        }
+    }
+}
+
+}  // namespace kcenon::file_transfer
@@ -5,15 +5,14 @@
 
 #include <kcenon/file_transfer/core/resume_handler.h>
 #include <kcenon/file_transfer/core/logging.h>
+#include <kcenon/file_transfer/core/transfer_registry.h>
 
 #include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <mutex>
-#include <shared_mutex>
 #include <sstream>
-#include <unordered_map>
 
 namespace kcenon::file_transfer {
 
@@ -44,6 +43,13 @@ auto transfer_state::received_chunk_count() const -> uint32_t {
 }
 
 auto transfer_state::completion_percentage() const -> double {
+    if (variable_chunks) {
+        if (total_size == 0) {
+            return 0.0;
+        }
+        return static_cast<double>(received_range_bytes()) /
+               static_cast<double>(total_size) * 100.0;
+    }
     if (total_chunks == 0) {
         return 0.0;
     }
@@ -52,9 +58,58 @@ auto transfer_state::completion_percentage() const -> double {
 }
 
 auto transfer_state::is_complete() const -> bool {
+    if (variable_chunks) {
+        return received_range_bytes() == total_size;
+    }
     return received_chunk_count() == total_chunks;
 }
 
+void transfer_state::add_received_range(file_byte_range range) {
+    if (range.length == 0) {
+        return;
+    }
+
+    // First range that ends at or after the new one starts
+    auto it = std::lower_bound(
+        received_ranges.begin(), received_ranges.end(), range.offset,
+        [](const file_byte_range& r, uint64_t offset) { return r.end() < offset; });
+
+    // Absorb every range that touches or overlaps the new one
+    auto last = it;
+    uint64_t begin = range.offset;
+    uint64_t end = range.end();
+    while (last != received_ranges.end() && last->offset <= end) {
+        begin = std::min(begin, last->offset);
+        end = std::max(end, last->end());
+        ++last;
+    }
+    it = received_ranges.erase(it, last);
+    received_ranges.insert(it, file_byte_range{begin, end - begin});
+}
+
+auto transfer_state::missing_ranges() const -> std::vector<file_byte_range> {
+    std::vector<file_byte_range> missing;
+    uint64_t cursor = 0;
+    for (const auto& range : received_ranges) {
+        if (range.offset > cursor) {
+            missing.push_back({cursor, range.offset - cursor});
+        }
+        cursor = std::max(cursor, range.end());
+    }
+    if (cursor < total_size) {
+        missing.push_back({cursor, total_size - cursor});
+    }
+    return missing;
+}
+
+auto transfer_state::received_range_bytes() const -> uint64_t {
+    uint64_t bytes = 0;
+    for (const auto& range : received_ranges) {
+        bytes += range.length;
+    }
+    return bytes;
+}
+
 // ============================================================================
 // resume_handler_config implementation
 // ============================================================================
@@ -190,6 +245,33 @@ auto hex_string_to_bitmap(const std::string& hex, uint32_t total_bits)
     return bitmap;
 }
 
+// "offset:length,offset:length,..."
+auto ranges_to_string(const std::vector<file_byte_range>& ranges) -> std::string {
+    std::ostringstream oss;
+    for (std::size_t i = 0; i < ranges.size(); ++i) {
+        if (i > 0) {
+            oss << ',';
+        }
+        oss << ranges[i].offset << ':' << ranges[i].length;
+    }
+    return oss.str();
+}
+
+auto string_to_ranges(const std::string& s) -> std::vector<file_byte_range> {
+    std::vector<file_byte_range> ranges;
+    std::istringstream iss(s);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        auto colon = item.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        ranges.push_back({std::stoull(item.substr(0, colon)),
+                          std::stoull(item.substr(colon + 1))});
+    }
+    return ranges;
+}
+
 auto serialize_state_to_json(const transfer_state& state) -> std::string {
     std::ostringstream oss;
     oss << "{\n";
@@ -199,6 +281,8 @@ auto serialize_state_to_json(const transfer_state& state) -> std::string {
     oss << "  \"transferred_bytes\": " << state.transferred_bytes << ",\n";
     oss << "  \"total_chunks\": " << state.total_chunks << ",\n";
     oss << "  \"chunk_bitmap\": \"" << bitmap_to_hex_string(state.chunk_bitmap) << "\",\n";
+    oss << "  \"variable_chunks\": " << (state.variable_chunks ? "true" : "false") << ",\n";
+    oss << "  \"received_ranges\": \"" << ranges_to_string(state.received_ranges) << "\",\n";
     oss << "  \"sha256\": \"" << state.sha256 << "\",\n";
     oss << "  \"started_at\": " << time_point_to_int64(state.started_at) << ",\n";
     oss << "  \"last_activity\": " << time_point_to_int64(state.last_activity) << "\n";
@@ -300,6 +384,16 @@ auto deserialize_state_from_json(const std::string& json)
     auto bitmap_hex = extract_json_value(json, "chunk_bitmap");
     state.chunk_bitmap = hex_string_to_bitmap(bitmap_hex, state.total_chunks);
 
+    // Byte ranges; absent in states written before variable-size chunks
+    state.variable_chunks = extract_json_value(json, "variable_chunks") == "true";
+    try {
+        for (const auto& range : string_to_ranges(extract_json_value(json, "received_ranges"))) {
+            state.add_received_range(range);
+        }
+    } catch (const std::exception&) {
+        return unexpected(error(error_code::internal_error, "invalid received_ranges field"));
+    }
+
     return state;
 }
 
@@ -324,104 +418,43 @@ public:
     }
 
     auto save_state(const transfer_state& state) -> result<void> {
-        std::unique_lock lock(mutex_);
-
         FT_LOG_DEBUG(log_category::resume,
             "Saving transfer state: " + state.id.to_string() +
             " (" + std::to_string(state.received_chunk_count()) + "/" +
             std::to_string(state.total_chunks) + " chunks)");
 
         // Update cache
-        cache_[state.id] = state;
-
-        // Write to file
-        auto path = get_state_file_path(config_.state_directory, state.id);
-        std::ofstream file(path);
-        if (!file) {
-            FT_LOG_ERROR(log_category::resume,
-                "Failed to open state file for writing: " + path.string());
-            return unexpected(error(error_code::file_write_error,
-                "failed to open state file for writing"));
-        }
-
-        file << serialize_state_to_json(state);
-        if (!file) {
-            FT_LOG_ERROR(log_category::resume,
-                "Failed to write state file: " + path.string());
-            return unexpected(error(error_code::file_write_error,
-                "failed to write state file"));
+        auto [entry, inserted] = cache_.insert(state.id, std::make_shared<cached_state>(state));
+        std::lock_guard lock(entry->mutex);
+        if (!inserted) {
+            entry->state = state;
         }
-
-        FT_LOG_TRACE(log_category::resume,
-            "State persisted to: " + path.string());
-        return {};
+        return persist(*entry);
     }
 
     auto load_state(const transfer_id& id) -> result<transfer_state> {
         FT_LOG_TRACE(log_category::resume,
             "Loading transfer state: " + id.to_string());
 
-        // Check cache first
-        {
-            std::shared_lock lock(mutex_);
-            auto it = cache_.find(id);
-            if (it != cache_.end()) {
-                FT_LOG_TRACE(log_category::resume,
-                    "State found in cache: " + id.to_string());
-                return it->second;
-            }
-        }
-
-        // Load from file
-        auto path = get_state_file_path(config_.state_directory, id);
-        if (!std::filesystem::exists(path)) {
-            FT_LOG_DEBUG(log_category::resume,
-                "State file not found: " + path.string());
-            return unexpected(error(error_code::file_not_found,
-                "state file not found"));
+        auto entry = acquire(id);
+        if (!entry) {
+            return unexpected(entry.error());
         }
-
-        std::ifstream file(path);
-        if (!file) {
-            FT_LOG_ERROR(log_category::resume,
-                "Failed to open state file: " + path.string());
-            return unexpected(error(error_code::file_read_error,
-                "failed to open state file"));
-        }
-
-        std::ostringstream oss;
-        oss << file.rdbuf();
-
-        auto result = deserialize_state_from_json(oss.str());
-        if (!result) {
-            FT_LOG_ERROR(log_category::resume,
-                "Failed to deserialize state: " + id.to_string());
-            return result;
-        }
-
-        FT_LOG_DEBUG(log_category::resume,
-            "State recovered: " + id.to_string() +
-            " (" + std::to_string(result.value().received_chunk_count()) + "/" +
-            std::to_string(result.value().total_chunks) + " chunks, " +
-            std::to_string(result.value().completion_percentage()) + "% complete)");
-
-        // Update cache
-        {
-            std::unique_lock lock(mutex_);
-            cache_[id] = result.value();
-        }
-
-        return result;
+        std::lock_guard lock(entry.value()->mutex);
+        return entry.value()->state;
     }
 
     auto delete_state(const transfer_id& id) -> result<void> {
-        std::unique_lock lock(mutex_);
-
         FT_LOG_DEBUG(log_category::resume,
             "Deleting transfer state: " + id.to_string());
 
-        // Remove from cache
-        cache_.erase(id);
+        // Remove from cache; a writer still holding the entry sees it deleted
+        // and does not bring the file back
+        std::unique_lock<std::mutex> entry_lock;
+        if (auto entry = cache_.erase(id)) {
+            entry_lock = std::unique_lock(entry->mutex);
+            entry->deleted = true;
+        }
 
         // Remove file
         auto path = get_state_file_path(config_.state_directory, id);
@@ -443,11 +476,8 @@ public:
     }
 
     auto has_state(const transfer_id& id) const -> bool {
-        {
-            std::shared_lock lock(mutex_);
-            if (cache_.find(id) != cache_.end()) {
-                return true;
-            }
+        if (cache_.contains(id)) {
+            return true;
         }
 
         auto path = get_state_file_path(config_.state_directory, id);
@@ -456,81 +486,72 @@ public:
 
     auto mark_chunk_received(const transfer_id& id, uint32_t chunk_index)
         -> result<void> {
-        std::unique_lock lock(mutex_);
-
-        auto it = cache_.find(id);
-        if (it == cache_.end()) {
-            // Try to load from file
-            lock.unlock();
-            auto load_result = load_state(id);
-            if (!load_result) {
-                return unexpected(load_result.error());
-            }
-            lock.lock();
-            it = cache_.find(id);
-            if (it == cache_.end()) {
-                return unexpected(error(error_code::internal_error,
-                    "failed to load state into cache"));
+        return modify(id, [&](cached_state& entry) -> result<void> {
+            if (chunk_index >= entry.state.total_chunks) {
+                return unexpected(error(error_code::invalid_chunk_index,
+                    "chunk index out of range"));
             }
-        }
-
-        auto& state = it->second;
-
-        if (chunk_index >= state.total_chunks) {
-            return unexpected(error(error_code::invalid_chunk_index,
-                "chunk index out of range"));
-        }
-
-        state.chunk_bitmap[chunk_index] = true;
-        state.last_activity = std::chrono::system_clock::now();
-        ++chunks_since_checkpoint_;
-
-        // Auto-checkpoint
-        if (chunks_since_checkpoint_ >= config_.checkpoint_interval) {
-            chunks_since_checkpoint_ = 0;
-            lock.unlock();
-            return save_state(state);
-        }
-
-        return {};
+            entry.state.chunk_bitmap[chunk_index] = true;
+            ++entry.since_checkpoint;
+            return {};
+        });
     }
 
     auto mark_chunks_received(
         const transfer_id& id,
         const std::vector<uint32_t>& chunk_indices) -> result<void> {
-        std::unique_lock lock(mutex_);
-
-        auto it = cache_.find(id);
-        if (it == cache_.end()) {
-            lock.unlock();
-            auto load_result = load_state(id);
-            if (!load_result) {
-                return unexpected(load_result.error());
+        return modify(id, [&](cached_state& entry) -> result<void> {
+            for (auto index : chunk_indices) {
+                if (index >= entry.state.total_chunks) {
+                    return unexpected(error(error_code::invalid_chunk_index,
+                        "chunk index out of range"));
+                }
+                entry.state.chunk_bitmap[index] = true;
             }
-            lock.lock();
-            it = cache_.find(id);
-        }
-
-        if (it == cache_.end()) {
-            return unexpected(error(error_code::internal_error,
-                "failed to load state into cache"));
-        }
-
-        auto& state = it->second;
+            // Save after batch update
+            entry.since_checkpoint = std::max(entry.since_checkpoint, config_.checkpoint_interval);
+            return {};
+        });
+    }
 
-        for (auto index : chunk_indices) {
-            if (index >= state.total_chunks) {
+    auto mark_range_received(const transfer_id& id, uint64_t offset, uint64_t length)
+        -> result<void> {
+        return modify(id, [&](cached_state& entry) -> result<void> {
+            auto& state = entry.state;
+            if (offset > state.total_size || length > state.total_size - offset) {
                 return unexpected(error(error_code::invalid_chunk_index,
-                    "chunk index out of range"));
+                    "range outside the file"));
             }
-            state.chunk_bitmap[index] = true;
-        }
+            state.add_received_range({offset, length});
+            ++entry.since_checkpoint;
+            return {};
+        });
+    }
 
-        state.last_activity = std::chrono::system_clock::now();
+    auto mark_chunk_received(const chunk_header& header) -> result<void> {
+        auto entry = acquire(header.id);
+        if (!entry) {
+            return unexpected(entry.error());
+        }
+        bool variable = false;
+        {
+            std::lock_guard lock(entry.value()->mutex);
+            variable = entry.value()->state.variable_chunks;
+        }
+        if (variable) {
+            // original_size is the length covered, zero ranges included
+            return mark_range_received(header.id, header.chunk_offset, header.original_size);
+        }
+        return mark_chunk_received(header.id, static_cast<uint32_t>(header.chunk_index));
+    }
 
-        // Save after batch update
-        lock.unlock();
-        return save_state(state);
+    auto get_missing_ranges(const transfer_id& id)
+        -> result<std::vector<file_byte_range>> {
+        auto load_result = load_state(id);
+        if (!load_result) {
+            return unexpected(load_result.error());
+        }
+        return load_result.value().missing_ranges();
     }
 
     auto get_missing_chunks(const transfer_id& id)
@@ -554,18 +575,17 @@ public:
 
     auto is_chunk_received(const transfer_id& id, uint32_t chunk_index) const
         -> bool {
-        std::shared_lock lock(mutex_);
-
-        auto it = cache_.find(id);
-        if (it == cache_.end()) {
+        auto entry = cache_.find(id);
+        if (!entry) {
             return false;
         }
 
-        if (chunk_index >= it->second.total_chunks) {
+        std::lock_guard lock(entry->mutex);
+        if (chunk_index >= entry->state.total_chunks) {
             return false;
         }
 
-        return it->second.chunk_bitmap[chunk_index];
+        return entry->state.chunk_bitmap[chunk_index];
     }
 
     auto list_resumable_transfers() -> std::vector<transfer_state> {
@@ -660,35 +680,134 @@ public:
 
     auto update_transferred_bytes(const transfer_id& id, uint64_t bytes)
         -> result<void> {
-        std::unique_lock lock(mutex_);
+        return modify(id, [&](cached_state& entry) -> result<void> {
+            entry.state.transferred_bytes += bytes;
+            return {};
+        });
+    }
 
-        auto it = cache_.find(id);
-        if (it == cache_.end()) {
-            lock.unlock();
-            auto load_result = load_state(id);
-            if (!load_result) {
-                return unexpected(load_result.error());
-            }
-            lock.lock();
-            it = cache_.find(id);
+private:
+    /**
+     * Cached state of one transfer. Each has its own lock, so transfers
+     * checkpoint and mark chunks without waiting on each other.
+     */
+    struct cached_state {
+        std::mutex mutex;
+        transfer_state state;
+        uint32_t since_checkpoint = 0;   ///< Changes not yet in the state file
+        bool deleted = false;            ///< Removed by delete_state()
+
+        explicit cached_state(transfer_state s) : state(std::move(s)) {}
+    };
+
+    // Cached entry for id, loaded from its state file on a miss
+    auto acquire(const transfer_id& id) -> result<std::shared_ptr<cached_state>> {
+        if (auto entry = cache_.find(id)) {
+            FT_LOG_TRACE(log_category::resume,
+                "State found in cache: " + id.to_string());
+            return entry;
+        }
+
+        auto loaded = read_state_file(id);
+        if (!loaded) {
+            return unexpected(loaded.error());
+        }
+
+        // Another thread may have loaded or saved it meanwhile; theirs wins
+        return cache_.insert(id, std::make_shared<cached_state>(std::move(loaded.value())))
+            .first;
+    }
+
+    auto read_state_file(const transfer_id& id) -> result<transfer_state> {
+        auto path = get_state_file_path(config_.state_directory, id);
+        if (!std::filesystem::exists(path)) {
+            FT_LOG_DEBUG(log_category::resume,
+                "State file not found: " + path.string());
+            return unexpected(error(error_code::file_not_found,
+                "state file not found"));
         }
 
-        if (it == cache_.end()) {
-            return unexpected(error(error_code::internal_error,
-                "failed to load state into cache"));
+        std::ifstream file(path);
+        if (!file) {
+            FT_LOG_ERROR(log_category::resume,
+                "Failed to open state file: " + path.string());
+            return unexpected(error(error_code::file_read_error,
+                "failed to open state file"));
         }
 
-        it->second.transferred_bytes += bytes;
-        it->second.last_activity = std::chrono::system_clock::now();
+        std::ostringstream oss;
+        oss << file.rdbuf();
 
+        auto result = deserialize_state_from_json(oss.str());
+        if (!result) {
+            FT_LOG_ERROR(log_category::resume,
+                "Failed to deserialize state: " + id.to_string());
+            return result;
+        }
+
+        FT_LOG_DEBUG(log_category::resume,
+            "State recovered: " + id.to_string() +
+            " (" + std::to_string(result.value().received_chunk_count()) + "/" +
+            std::to_string(result.value().total_chunks) + " chunks, " +
+            std::to_string(result.value().completion_percentage()) + "% complete)");
+
+        return result;
+    }
+
+    // Apply fn to the cached state, then checkpoint if enough has changed
+    template <typename F>
+    auto modify(const transfer_id& id, F&& fn) -> result<void> {
+        auto entry = acquire(id);
+        if (!entry) {
+            return unexpected(entry.error());
+        }
+
+        auto& cached = *entry.value();
+        std::lock_guard lock(cached.mutex);
+        if (auto applied = fn(cached); !applied) {
+            return applied;
+        }
+        cached.state.last_activity = std::chrono::system_clock::now();
+
+        // Auto-checkpoint
+        if (cached.since_checkpoint >= config_.checkpoint_interval) {
+            return persist(cached);
+        }
+        return {};
+    }
+
+    // Write the state file; the entry's lock is held
+    auto persist(cached_state& cached) -> result<void> {
+        if (cached.deleted) {
+            return {};
+        }
+        cached.since_checkpoint = 0;
+
+        const auto& state = cached.state;
+        auto path = get_state_file_path(config_.state_directory, state.id);
+        std::ofstream file(path);
+        if (!file) {
+            FT_LOG_ERROR(log_category::resume,
+                "Failed to open state file for writing: " + path.string());
+            return unexpected(error(error_code::file_write_error,
+                "failed to open state file for writing"));
+        }
+
+        file << serialize_state_to_json(state);
+        if (!file) {
+            FT_LOG_ERROR(log_category::resume,
+                "Failed to write state file: " + path.string());
+            return unexpected(error(error_code::file_write_error,
+                "failed to write state file"));
+        }
+
+        FT_LOG_TRACE(log_category::resume,
+            "State persisted to: " + path.string());
         return {};
     }
 
-private:
     resume_handler_config config_;
-    mutable std::shared_mutex mutex_;
-    std::unordered_map<transfer_id, transfer_state> cache_;
-    uint32_t chunks_since_checkpoint_ = 0;
+    transfer_registry<cached_state> cache_;
 };
 
 // ============================================================================
@@ -729,6 +848,10 @@ auto resume_handler::mark_chunk_received(
     return impl_->mark_chunk_received(id, chunk_index);
 }
 
+auto resume_handler::mark_chunk_received(const chunk_header& header) -> result<void> {
+    return impl_->mark_chunk_received(header);
+}
+
 auto resume_handler::mark_chunks_received(
     const transfer_id& id,
     const std::vector<uint32_t>& chunk_indices) -> result<void> {
@@ -740,6 +863,18 @@ auto resume_handler::get_missing_chunks(const transfer_id& id)
     return impl_->get_missing_chunks(id);
 }
 
+auto resume_handler::mark_range_received(
+    const transfer_id& id,
+    uint64_t offset,
+    uint64_t length) -> result<void> {
+    return impl_->mark_range_received(id, offset, length);
+}
+
+auto resume_handler::get_missing_ranges(const transfer_id& id)
+    -> result<std::vector<file_byte_range>> {
+    return impl_->get_missing_ranges(id);
+}
+
 auto resume_handler::is_chunk_received(
     const transfer_id& id,
     uint32_t chunk_index) const -> bool {
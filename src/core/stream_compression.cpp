@@ -0,0 +1,448 @@
+/**
+ * @file stream_compression.cpp
+ * @brief LZ4 stream compression implementation
+ */
+
+#include <kcenon/file_transfer/core/stream_compression.h>
+#include <kcenon/file_transfer/core/logging.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#ifdef FILE_TRANS_ENABLE_LZ4
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+
+namespace kcenon::file_transfer {
+
+auto stream_compression_config::validate() const -> result<void> {
+    if (resync_interval == 0) {
+        return unexpected(error{error_code::invalid_configuration,
+                                "Stream compression needs at least one chunk per segment"});
+    }
+    if (window_size == 0 || window_size > max_window_size) {
+        return unexpected(error{error_code::invalid_configuration,
+                                "Stream compression window must be 1 to " +
+                                    std::to_string(max_window_size) + " bytes"});
+    }
+    return {};
+}
+
+class stream_compressor::impl {
+public:
+    explicit impl(stream_compression_config config)
+        : config_(config), engine_(config.level), history_(4 * config.window_size) {
+#ifdef FILE_TRANS_ENABLE_LZ4
+        if (config_.level == compression_level::high) {
+            stream_hc_ = LZ4_createStreamHC();
+        } else {
+            stream_ = LZ4_createStream();
+        }
+#endif
+    }
+
+    ~impl() {
+#ifdef FILE_TRANS_ENABLE_LZ4
+        if (stream_hc_ != nullptr) {
+            LZ4_freeStreamHC(stream_hc_);
+        }
+        if (stream_ != nullptr) {
+            LZ4_freeStream(stream_);
+        }
+#endif
+    }
+
+    impl(const impl&) = delete;
+    auto operator=(const impl&) -> impl& = delete;
+
+    auto compress(chunk& c, compression_mode mode) -> result<void> {
+        if (c.is_parity()) {
+            return {};
+        }
+        if (c.is_compressed() || is_encrypted(c.header.flags)) {
+            return unexpected(error{error_code::invalid_configuration,
+                                    "Stream compression takes chunks before encryption"});
+        }
+
+        auto index = c.header.chunk_index;
+        if (started_ && index < next_index_) {
+            // A retransmission; the receiver may have dropped its history
+            return compress_alone(c, mode);
+        }
+        if (index == config_.segment_start(index)) {
+            reset();
+        } else if (!started_ || index != next_index_) {
+            linkable_ = false;
+        }
+        started_ = true;
+        next_index_ = index + 1;
+
+        if (!linkable_) {
+            return compress_alone(c, mode);
+        }
+        if (c.is_zero_range()) {
+            append(std::span<const std::byte>{}, c.header.original_size);
+            record_skipped(c.header.original_size);
+            return {};
+        }
+
+        bool should_compress = false;
+        switch (mode) {
+            case compression_mode::disabled:
+                should_compress = false;
+                break;
+            case compression_mode::enabled:
+                should_compress = true;
+                break;
+            case compression_mode::adaptive:
+            default:
+                should_compress = engine_.is_compressible(c.data);
+                break;
+        }
+        if (!should_compress || c.data.empty()) {
+            append(c.data, 0);
+            record_skipped(c.data.size());
+            c.header.compressed_size = static_cast<uint32_t>(c.data.size());
+            return {};
+        }
+        return compress_linked(c);
+    }
+
+    auto config() const -> const stream_compression_config& { return config_; }
+
+    auto stats() const -> compression_stats { return stats_; }
+
+private:
+    // Starts the history over, at the first chunk of a segment
+    auto reset() -> void {
+        begin_ = 0;
+        dict_size_ = 0;
+        linkable_ = true;
+        dirty_ = false;
+#ifdef FILE_TRANS_ENABLE_LZ4
+        if (stream_hc_ != nullptr) {
+            LZ4_resetStreamHC_fast(stream_hc_, LZ4HC_CLEVEL_DEFAULT);
+        } else {
+            LZ4_resetStream_fast(stream_);
+        }
+#endif
+    }
+
+    // Makes room for size bytes after the history, moving the history to
+    // the front of the buffer once the end is reached
+    auto make_room(std::size_t size) -> void {
+        if (begin_ + dict_size_ + size <= history_.size()) {
+            return;
+        }
+        std::memmove(history_.data(), history_.data() + begin_, dict_size_);
+        begin_ = 0;
+        if (history_.size() < dict_size_ + size) {
+            history_.resize(dict_size_ + size);
+        }
+        dirty_ = true;
+    }
+
+    // Extends the history by size bytes just written after it
+    auto grow(std::size_t size) -> void {
+        dict_size_ += size;
+        if (dict_size_ > config_.window_size) {
+            begin_ += dict_size_ - config_.window_size;
+            dict_size_ = config_.window_size;
+        }
+    }
+
+    // Adds data LZ4 has not seen to the history; the stream reloads it later
+    auto append(std::span<const std::byte> data, std::size_t zeros) -> void {
+        auto added = data.empty() ? zeros : data.size();
+        auto fill = std::min(added, config_.window_size);
+        make_room(fill);
+        auto* end = history_.data() + begin_ + dict_size_;
+        if (data.empty()) {
+            std::memset(end, 0, fill);
+        } else {
+            std::memcpy(end, data.data() + data.size() - fill, fill);
+        }
+        if (fill < added) {
+            // Everything before is out of the window
+            begin_ += dict_size_;
+            dict_size_ = 0;
+        }
+        grow(fill);
+        dirty_ = true;
+    }
+
+    auto compress_linked(chunk& c) -> result<void> {
+#ifndef FILE_TRANS_ENABLE_LZ4
+        (void)c;
+        return unexpected(error{error_code::internal_error, "LZ4 compression not enabled"});
+#else
+        // The chunk is copied right behind the history, so LZ4 sees one
+        // contiguous prefix and finds matches across the boundary; the
+        // history only moves when the buffer is full
+        auto size = c.data.size();
+        make_room(size);
+        auto* base = reinterpret_cast<char*>(history_.data()) + begin_;
+        if (dirty_) {
+            if (stream_hc_ != nullptr) {
+                LZ4_loadDictHC(stream_hc_, base, static_cast<int>(dict_size_));
+            } else {
+                LZ4_loadDict(stream_, base, static_cast<int>(dict_size_));
+            }
+            dirty_ = false;
+        }
+        std::memcpy(base + dict_size_, c.data.data(), size);
+
+        auto bound = LZ4_compressBound(static_cast<int>(size));
+        std::vector<std::byte> output(static_cast<std::size_t>(bound));
+        auto* dst = reinterpret_cast<char*>(output.data());
+        int written = 0;
+        bool linked = dict_size_ > 0;
+        if (stream_hc_ != nullptr) {
+            written = LZ4_compress_HC_continue(stream_hc_, base + dict_size_, dst,
+                                               static_cast<int>(size), bound);
+        } else {
+            written = LZ4_compress_fast_continue(stream_, base + dict_size_, dst,
+                                                 static_cast<int>(size), bound, 1);
+        }
+        if (config_.window_size < stream_compression_config::max_window_size) {
+            // LZ4 reaches back 64KB; cut its history to what the receiver keeps
+            int window = static_cast<int>(config_.window_size);
+            dict_size_ = static_cast<std::size_t>(
+                stream_hc_ != nullptr ? LZ4_saveDictHC(stream_hc_, base, window)
+                                      : LZ4_saveDict(stream_, base, window));
+        } else {
+            grow(size);
+        }
+        if (written <= 0) {
+            FT_LOG_ERROR(log_category::compression,
+                "LZ4 stream compression failed for chunk " +
+                std::to_string(c.header.chunk_index));
+            // The stream state is unknown; do not refer to it again
+            linkable_ = false;
+            return unexpected(error{error_code::internal_error, "LZ4 compression failed"});
+        }
+
+        // Data that did not shrink goes as is; it is in the history either way
+        stats_.compression_calls++;
+        stats_.total_chunks++;
+        stats_.total_input_bytes += size;
+        if (static_cast<std::size_t>(written) >= size) {
+            stats_.total_output_bytes += size;
+            c.header.compressed_size = static_cast<uint32_t>(size);
+            return {};
+        }
+        output.resize(static_cast<std::size_t>(written));
+        stats_.total_output_bytes += output.size();
+        stats_.compressed_chunks++;
+        c.data = std::move(output);
+        c.header.compressed_size = static_cast<uint32_t>(written);
+        c.header.flags |= chunk_flags::compressed;
+        if (linked) {
+            c.header.flags |= chunk_flags::linked;
+        }
+        return {};
+#endif
+    }
+
+    // Compresses a chunk without history, leaving the stream as it was
+    auto compress_alone(chunk& c, compression_mode mode) -> result<void> {
+        if (c.is_zero_range()) {
+            record_skipped(c.header.original_size);
+            return {};
+        }
+        auto compressed = engine_.compress_adaptive(c.data, mode);
+        if (!compressed.has_value()) {
+            return unexpected(compressed.error());
+        }
+        auto& [data, was_compressed] = compressed.value();
+        stats_.total_chunks++;
+        stats_.total_input_bytes += c.data.size();
+        if (was_compressed && data.size() < c.data.size()) {
+            stats_.compression_calls++;
+            stats_.compressed_chunks++;
+            stats_.total_output_bytes += data.size();
+            c.data = std::move(data);
+            c.header.flags |= chunk_flags::compressed;
+        } else {
+            stats_.skipped_compressions++;
+            stats_.total_output_bytes += c.data.size();
+        }
+        c.header.compressed_size = static_cast<uint32_t>(c.data.size());
+        return {};
+    }
+
+    auto record_skipped(std::size_t size) -> void {
+        stats_.skipped_compressions++;
+        stats_.total_chunks++;
+        stats_.total_input_bytes += size;
+        stats_.total_output_bytes += size;
+    }
+
+    stream_compression_config config_;
+    compression_engine engine_;
+    compression_stats stats_;
+
+    /// The segment's last window_size bytes at begin_, then room for more chunks
+    std::vector<std::byte> history_;
+    std::size_t begin_ = 0;
+    std::size_t dict_size_ = 0;
+    uint64_t next_index_ = 0;
+    bool started_ = false;
+    bool linkable_ = false;  ///< History covers the whole segment so far
+    bool dirty_ = false;     ///< History changed behind LZ4's back
+
+#ifdef FILE_TRANS_ENABLE_LZ4
+    LZ4_stream_t* stream_ = nullptr;
+    LZ4_streamHC_t* stream_hc_ = nullptr;
+#endif
+};
+
+stream_compressor::stream_compressor(stream_compression_config config)
+    : impl_(std::make_unique<impl>(config)) {}
+
+stream_compressor::~stream_compressor() = default;
+
+stream_compressor::stream_compressor(stream_compressor&&) noexcept = default;
+
+auto stream_compressor::operator=(stream_compressor&&) noexcept -> stream_compressor& = default;
+
+auto stream_compressor::compress(chunk& c, compression_mode mode) -> result<void> {
+    return impl_->compress(c, mode);
+}
+
+auto stream_compressor::config() const -> const stream_compression_config& {
+    return impl_->config();
+}
+
+auto stream_compressor::stats() const -> compression_stats {
+    return impl_->stats();
+}
+
+stream_decompressor::stream_decompressor(stream_compression_config config) : config_(config) {}
+
+auto stream_decompressor::ready(uint64_t chunk_index, chunk_flags flags) const -> bool {
+    if (!is_compressed(flags) || !is_linked(flags)) {
+        return true;
+    }
+    auto start = config_.segment_start(chunk_index);
+    std::size_t have = 0;
+    for (auto index = chunk_index; index > start && have < config_.window_size; --index) {
+        if (index - 1 < horizon_) {
+            return true;
+        }
+        auto it = tails_.find(index - 1);
+        if (it == tails_.end()) {
+            return false;
+        }
+        have += it->second.size();
+    }
+    return true;
+}
+
+auto stream_decompressor::decompress(uint64_t chunk_index, chunk_flags flags,
+                                     std::span<const std::byte> payload,
+                                     std::size_t original_size)
+    -> result<std::vector<std::byte>> {
+#ifndef FILE_TRANS_ENABLE_LZ4
+    (void)chunk_index;
+    (void)flags;
+    (void)payload;
+    (void)original_size;
+    return unexpected(error{error_code::internal_error, "LZ4 compression not enabled"});
+#else
+    if (!is_compressed(flags)) {
+        return unexpected(error{error_code::invalid_message, "Chunk is not compressed"});
+    }
+    std::vector<std::byte> dictionary;
+    if (is_linked(flags)) {
+        auto found = history(chunk_index);
+        if (!found.has_value()) {
+            return unexpected(found.error());
+        }
+        dictionary = std::move(found.value());
+    }
+
+    std::vector<std::byte> output(original_size);
+    auto n = LZ4_decompress_safe_usingDict(
+        reinterpret_cast<const char*>(payload.data()), reinterpret_cast<char*>(output.data()),
+        static_cast<int>(payload.size()), static_cast<int>(original_size),
+        reinterpret_cast<const char*>(dictionary.data()), static_cast<int>(dictionary.size()));
+    if (n < 0 || static_cast<std::size_t>(n) != original_size) {
+        FT_LOG_ERROR(log_category::compression,
+            "LZ4 stream decompression failed for chunk " + std::to_string(chunk_index));
+        return unexpected(
+            error{error_code::internal_error, "LZ4 decompression failed: corrupted data"});
+    }
+    keep(chunk_index, output, 0);
+    return output;
+#endif
+}
+
+auto stream_decompressor::record(uint64_t chunk_index, chunk_flags flags,
+                                 std::span<const std::byte> data, std::size_t original_size)
+    -> void {
+    if (is_parity(flags)) {
+        return;
+    }
+    if (is_zero_range(flags)) {
+        keep(chunk_index, {}, original_size);
+    } else {
+        keep(chunk_index, data, 0);
+    }
+}
+
+auto stream_decompressor::history(uint64_t chunk_index) const
+    -> result<std::vector<std::byte>> {
+    // Walk back through the segment until the window is covered
+    auto start = config_.segment_start(chunk_index);
+    std::vector<const std::vector<std::byte>*> parts;
+    std::size_t have = 0;
+    for (auto index = chunk_index; index > start && have < config_.window_size; --index) {
+        auto it = tails_.find(index - 1);
+        if (index - 1 < horizon_ || it == tails_.end()) {
+            return unexpected(error{error_code::chunk_sequence_error,
+                                    "History of chunk " + std::to_string(chunk_index) +
+                                        " is not available"});
+        }
+        parts.push_back(&it->second);
+        have += it->second.size();
+    }
+
+    std::vector<std::byte> dictionary;
+    dictionary.reserve(have);
+    for (auto it = parts.rbegin(); it != parts.rend(); ++it) {
+        dictionary.insert(dictionary.end(), (*it)->begin(), (*it)->end());
+    }
+    if (dictionary.size() > config_.window_size) {
+        dictionary.erase(dictionary.begin(),
+                         dictionary.end() - static_cast<std::ptrdiff_t>(config_.window_size));
+    }
+    return dictionary;
+}
+
+auto stream_decompressor::keep(uint64_t chunk_index, std::span<const std::byte> data,
+                               std::size_t zeros) -> void {
+    if (chunk_index < horizon_) {
+        return;
+    }
+    auto window = config_.window_size;
+    std::vector<std::byte> tail;
+    if (data.empty()) {
+        tail.assign(std::min(zeros, window), std::byte{0});
+    } else {
+        auto size = std::min(data.size(), window);
+        tail.assign(data.end() - static_cast<std::ptrdiff_t>(size), data.end());
+    }
+    tails_[chunk_index] = std::move(tail);
+
+    // Keep the current and the previous segment only
+    auto start = config_.segment_start(chunk_index);
+    if (start >= config_.resync_interval && start - config_.resync_interval > horizon_) {
+        horizon_ = start - config_.resync_interval;
+        tails_.erase(tails_.begin(), tails_.lower_bound(horizon_));
+    }
+}
+
+}  // namespace kcenon::file_transfer
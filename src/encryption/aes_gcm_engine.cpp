@@ -47,6 +47,7 @@ void secure_zero_memory(void* ptr, std::size_t size) {
 class evp_cipher_ctx_wrapper {
 public:
     evp_cipher_ctx_wrapper() : ctx_(EVP_CIPHER_CTX_new()) {}
+    explicit evp_cipher_ctx_wrapper(std::nullptr_t) : ctx_(nullptr) {}
 
     ~evp_cipher_ctx_wrapper() {
         if (ctx_) {
@@ -80,6 +81,112 @@ private:
     EVP_CIPHER_CTX* ctx_;
 };
 
+/// Size of the chunk counter at the end of a derived chunk IV
+constexpr std::size_t chunk_counter_size = 8;
+
+/// Largest IV a derived chunk IV is built for
+constexpr std::size_t max_chunk_iv_size = 32;
+
+auto as_uchar(const std::byte* ptr) -> const unsigned char* {
+    return reinterpret_cast<const unsigned char*>(ptr);
+}
+
+auto as_uchar(std::byte* ptr) -> unsigned char* {
+    return reinterpret_cast<unsigned char*>(ptr);
+}
+
+/**
+ * @brief Run one GCM encryption on a keyed context
+ *
+ * Only the IV is set, so the key schedule expanded when the context was
+ * keyed is reused. out may alias in.
+ */
+auto seal(EVP_CIPHER_CTX* ctx,
+          std::span<const std::byte> iv,
+          std::span<const std::byte> aad,
+          std::span<const std::byte> in,
+          std::byte* out,
+          std::span<std::byte> tag) -> result<void> {
+    if (EVP_CipherInit_ex(ctx, nullptr, nullptr, nullptr, as_uchar(iv.data()), 1) != 1) {
+        return unexpected(error(error_code::internal_error, get_openssl_error()));
+    }
+
+    int len = 0;
+    if (!aad.empty() &&
+        EVP_EncryptUpdate(ctx, nullptr, &len, as_uchar(aad.data()),
+                          static_cast<int>(aad.size())) != 1) {
+        return unexpected(error(error_code::internal_error, "Failed to process AAD"));
+    }
+
+    if (EVP_EncryptUpdate(ctx, as_uchar(out), &len, as_uchar(in.data()),
+                          static_cast<int>(in.size())) != 1) {
+        return unexpected(error(error_code::internal_error, get_openssl_error()));
+    }
+
+    int final_len = 0;
+    if (EVP_EncryptFinal_ex(ctx, as_uchar(out) + len, &final_len) != 1) {
+        return unexpected(error(error_code::internal_error, get_openssl_error()));
+    }
+
+    if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, static_cast<int>(tag.size()),
+                            tag.data()) != 1) {
+        return unexpected(error(error_code::internal_error, "Failed to get auth tag"));
+    }
+    return {};
+}
+
+/**
+ * @brief Run one GCM decryption on a keyed context and verify its tag
+ *
+ * out may alias in. On an authentication failure out holds unverified
+ * plaintext and must be discarded.
+ */
+auto open(EVP_CIPHER_CTX* ctx,
+          std::span<const std::byte> iv,
+          std::span<const std::byte> aad,
+          std::span<const std::byte> in,
+          std::byte* out,
+          std::span<const std::byte> tag) -> result<void> {
+    if (EVP_CipherInit_ex(ctx, nullptr, nullptr, nullptr, as_uchar(iv.data()), 0) != 1) {
+        return unexpected(error(error_code::internal_error, get_openssl_error()));
+    }
+
+    int len = 0;
+    if (!aad.empty() &&
+        EVP_DecryptUpdate(ctx, nullptr, &len, as_uchar(aad.data()),
+                          static_cast<int>(aad.size())) != 1) {
+        return unexpected(error(error_code::internal_error, "Failed to process AAD"));
+    }
+
+    if (EVP_DecryptUpdate(ctx, as_uchar(out), &len, as_uchar(in.data()),
+                          static_cast<int>(in.size())) != 1) {
+        return unexpected(error(error_code::internal_error, get_openssl_error()));
+    }
+
+    if (!tag.empty() &&
+        EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, static_cast<int>(tag.size()),
+                            const_cast<std::byte*>(tag.data())) != 1) {
+        return unexpected(error(error_code::internal_error, "Failed to set auth tag"));
+    }
+
+    int final_len = 0;
+    if (EVP_DecryptFinal_ex(ctx, as_uchar(out) + len, &final_len) != 1) {
+        return unexpected(error(error_code::chunk_checksum_error,
+                               "Authentication failed - data may have been tampered"));
+    }
+    return {};
+}
+
+/**
+ * @brief Elapsed time since start, rounded up
+ *
+ * With pooled contexts a small operation can finish in well under a
+ * microsecond; rounding up keeps it from being recorded as taking no time.
+ */
+auto elapsed_since(std::chrono::steady_clock::time_point start) -> std::chrono::microseconds {
+    return std::chrono::ceil<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+}
+
 }  // namespace
 
 // ============================================================================
@@ -324,14 +431,55 @@ auto aes_gcm_stream_context::is_encryption() const -> bool {
 // ============================================================================
 
 struct aes_gcm_engine::impl {
+    /**
+     * @brief A keyed cipher context checked out of the pool
+     *
+     * Goes back to the pool when destroyed, unless the key changed in the
+     * meantime or it was made for a non-default IV length.
+     */
+    class pooled_ctx {
+    public:
+        pooled_ctx(impl& owner, evp_cipher_ctx_wrapper ctx, uint64_t generation, bool reusable)
+            : owner_(owner)
+            , ctx_(std::move(ctx))
+            , generation_(generation)
+            , reusable_(reusable) {}
+
+        ~pooled_ctx() {
+            if (reusable_ && ctx_) {
+                owner_.return_ctx(std::move(ctx_), generation_);
+            }
+        }
+
+        pooled_ctx(const pooled_ctx&) = delete;
+        auto operator=(const pooled_ctx&) -> pooled_ctx& = delete;
+
+        [[nodiscard]] auto get() const -> EVP_CIPHER_CTX* { return ctx_.get(); }
+        [[nodiscard]] explicit operator bool() const { return static_cast<bool>(ctx_); }
+
+    private:
+        impl& owner_;
+        evp_cipher_ctx_wrapper ctx_;
+        uint64_t generation_;
+        bool reusable_;
+    };
+
     aes_gcm_config config;
     std::vector<std::byte> key;
+    std::vector<std::byte> iv_salt;
     std::atomic<encryption_state> current_state{encryption_state::uninitialized};
     mutable std::mutex stats_mutex;
     encryption_statistics stats;
     std::function<void(const encryption_progress&)> progress_callback;
     std::atomic<uint64_t> iv_counter{0};
 
+    // Keyed contexts not in use; grows to the peak number of concurrent
+    // operations. Guards key as well, so a context is never keyed halfway
+    // through set_key().
+    std::mutex ctx_mutex;
+    std::vector<evp_cipher_ctx_wrapper> idle_ctxs;
+    uint64_t key_generation = 0;
+
     explicit impl(const aes_gcm_config& cfg) : config(cfg) {}
 
     ~impl() {
@@ -340,6 +488,62 @@ struct aes_gcm_engine::impl {
         }
     }
 
+    /**
+     * @brief Replace the key and drop every context keyed with the old one
+     */
+    void replace_key(std::span<const std::byte> new_key) {
+        std::lock_guard<std::mutex> lock(ctx_mutex);
+        if (config.secure_memory && !key.empty()) {
+            secure_zero_memory(key.data(), key.size());
+        }
+        key.assign(new_key.begin(), new_key.end());
+        ++key_generation;
+        // Freeing a context cleanses its key schedule
+        idle_ctxs.clear();
+    }
+
+    /**
+     * @brief Create a context with the key schedule expanded
+     *
+     * Caller holds ctx_mutex.
+     */
+    auto make_keyed_ctx(std::size_t iv_len) -> evp_cipher_ctx_wrapper {
+        evp_cipher_ctx_wrapper ctx;
+        if (!ctx || key.empty()) {
+            return evp_cipher_ctx_wrapper(nullptr);
+        }
+        if (EVP_CipherInit_ex(ctx.get(), EVP_aes_256_gcm(), nullptr, nullptr, nullptr, 1) != 1 ||
+            EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_IVLEN,
+                                static_cast<int>(iv_len), nullptr) != 1 ||
+            EVP_CipherInit_ex(ctx.get(), nullptr, nullptr, as_uchar(key.data()), nullptr, 1) != 1) {
+            return evp_cipher_ctx_wrapper(nullptr);
+        }
+        return ctx;
+    }
+
+    /**
+     * @brief Check out a keyed context for IVs of the given length
+     */
+    auto checkout_ctx(std::size_t iv_len) -> pooled_ctx {
+        std::lock_guard<std::mutex> lock(ctx_mutex);
+        if (iv_len != config.iv_size) {
+            return pooled_ctx(*this, make_keyed_ctx(iv_len), key_generation, false);
+        }
+        if (!idle_ctxs.empty()) {
+            auto ctx = std::move(idle_ctxs.back());
+            idle_ctxs.pop_back();
+            return pooled_ctx(*this, std::move(ctx), key_generation, true);
+        }
+        return pooled_ctx(*this, make_keyed_ctx(iv_len), key_generation, true);
+    }
+
+    void return_ctx(evp_cipher_ctx_wrapper ctx, uint64_t generation) {
+        std::lock_guard<std::mutex> lock(ctx_mutex);
+        if (generation == key_generation) {
+            idle_ctxs.push_back(std::move(ctx));
+        }
+    }
+
     auto generate_counter_iv() -> std::vector<std::byte> {
         std::vector<std::byte> iv(config.iv_size);
 
@@ -376,17 +580,73 @@ struct aes_gcm_engine::impl {
         return iv;
     }
 
-    void update_stats_encrypt(uint64_t bytes, std::chrono::microseconds duration) {
+    /**
+     * @brief Whether derived chunk IVs (salt + 64-bit counter) fit iv_size
+     */
+    [[nodiscard]] auto supports_chunk_iv() const -> bool {
+        return config.iv_size >= chunk_counter_size + 4 && config.iv_size <= max_chunk_iv_size;
+    }
+
+    /**
+     * @brief Draw a new random IV salt
+     */
+    auto regenerate_iv_salt() -> bool {
+        if (!supports_chunk_iv()) {
+            iv_salt.clear();
+            return true;
+        }
+        iv_salt.resize(config.iv_size - chunk_counter_size);
+        return RAND_bytes(as_uchar(iv_salt.data()), static_cast<int>(iv_salt.size())) == 1;
+    }
+
+    /**
+     * @brief Write the derived IV of a chunk: salt, then big-endian index
+     * @param out At least config.iv_size bytes
+     */
+    void write_chunk_iv(uint64_t chunk_index, std::byte* out) const {
+        std::memcpy(out, iv_salt.data(), iv_salt.size());
+        for (std::size_t i = 0; i < chunk_counter_size; ++i) {
+            out[iv_salt.size() + i] =
+                static_cast<std::byte>(chunk_index >> (8 * (chunk_counter_size - 1 - i)));
+        }
+    }
+
+    /**
+     * @brief Check that chunk operations can run
+     */
+    auto check_chunk_ready() const -> result<void> {
+        if (key.empty()) {
+            return unexpected(error(error_code::not_initialized, "Key not set"));
+        }
+        if (iv_salt.empty()) {
+            return unexpected(error(error_code::invalid_configuration,
+                                   "IV size does not fit a salt and 64-bit chunk counter"));
+        }
+        return {};
+    }
+
+    /**
+     * @brief Record a failed operation
+     */
+    auto fail(error err) -> unexpected {
+        increment_errors();
+        current_state = encryption_state::error;
+        return unexpected(std::move(err));
+    }
+
+    void update_stats_encrypt(uint64_t bytes, std::chrono::microseconds duration,
+                              uint64_t ops = 1) {
         std::lock_guard<std::mutex> lock(stats_mutex);
         stats.bytes_encrypted += bytes;
-        stats.encryption_ops++;
+        stats.encryption_ops += ops;
         stats.total_encrypt_time += duration;
     }
 
-    void update_stats_decrypt(uint64_t bytes, std::chrono::microseconds duration) {
+    void update_stats_decrypt(uint64_t bytes, std::chrono::microseconds duration,
+                              uint64_t ops = 1) {
         std::lock_guard<std::mutex> lock(stats_mutex);
         stats.bytes_decrypted += bytes;
-        stats.decryption_ops++;
+        stats.decryption_ops += ops;
         stats.total_decrypt_time += duration;
     }
 
@@ -426,7 +686,10 @@ auto aes_gcm_engine::set_key(std::span<const std::byte> key) -> result<void> {
                                "Invalid key size: expected 32 bytes"));
     }
 
-    impl_->key.assign(key.begin(), key.end());
+    if (!impl_->regenerate_iv_salt()) {
+        return unexpected(error(error_code::internal_error, "Failed to generate IV salt"));
+    }
+    impl_->replace_key(key);
     impl_->current_state = encryption_state::ready;
     return {};
 }
@@ -440,10 +703,7 @@ auto aes_gcm_engine::has_key() const -> bool {
 }
 
 void aes_gcm_engine::clear_key() {
-    if (impl_->config.secure_memory && !impl_->key.empty()) {
-        secure_zero_memory(impl_->key.data(), impl_->key.size());
-    }
-    impl_->key.clear();
+    impl_->replace_key({});
     impl_->current_state = encryption_state::uninitialized;
 }
 
@@ -461,11 +721,9 @@ auto aes_gcm_engine::encrypt(
     auto start_time = std::chrono::steady_clock::now();
     impl_->current_state = encryption_state::processing;
 
-    evp_cipher_ctx_wrapper ctx;
+    auto ctx = impl_->checkout_ctx(impl_->config.iv_size);
     if (!ctx) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, "Failed to create cipher context"));
+        return impl_->fail(error(error_code::internal_error, "Failed to create cipher context"));
     }
 
     encryption_result result;
@@ -475,9 +733,7 @@ auto aes_gcm_engine::encrypt(
     // Generate IV
     result.metadata.iv = impl_->generate_counter_iv();
     if (result.metadata.iv.empty()) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, "Failed to generate IV"));
+        return impl_->fail(error(error_code::internal_error, "Failed to generate IV"));
     }
 
     // Store AAD
@@ -485,83 +741,16 @@ auto aes_gcm_engine::encrypt(
         result.metadata.aad.assign(aad.begin(), aad.end());
     }
 
-    const EVP_CIPHER* cipher = EVP_aes_256_gcm();
-
-    // Initialize encryption
-    if (EVP_EncryptInit_ex(ctx.get(), cipher, nullptr, nullptr, nullptr) != 1) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, get_openssl_error()));
-    }
-
-    if (EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_IVLEN,
-                            static_cast<int>(impl_->config.iv_size), nullptr) != 1) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, "Failed to set IV length"));
-    }
-
-    if (EVP_EncryptInit_ex(ctx.get(), nullptr, nullptr,
-                           reinterpret_cast<const unsigned char*>(impl_->key.data()),
-                           reinterpret_cast<const unsigned char*>(result.metadata.iv.data())) != 1) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, get_openssl_error()));
-    }
-
-    // Process AAD
-    if (!aad.empty()) {
-        int len = 0;
-        if (EVP_EncryptUpdate(ctx.get(), nullptr, &len,
-                              reinterpret_cast<const unsigned char*>(aad.data()),
-                              static_cast<int>(aad.size())) != 1) {
-            impl_->increment_errors();
-            impl_->current_state = encryption_state::error;
-            return unexpected(error(error_code::internal_error, "Failed to process AAD"));
-        }
-    }
-
-    // Encrypt plaintext
-    result.ciphertext.resize(plaintext.size() + AES_BLOCK_SIZE);
-    int out_len = 0;
-
-    if (EVP_EncryptUpdate(ctx.get(),
-                          reinterpret_cast<unsigned char*>(result.ciphertext.data()),
-                          &out_len,
-                          reinterpret_cast<const unsigned char*>(plaintext.data()),
-                          static_cast<int>(plaintext.size())) != 1) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, get_openssl_error()));
-    }
-
-    int total_len = out_len;
-
-    // Finalize encryption
-    if (EVP_EncryptFinal_ex(ctx.get(),
-                            reinterpret_cast<unsigned char*>(result.ciphertext.data()) + out_len,
-                            &out_len) != 1) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, get_openssl_error()));
-    }
-
-    total_len += out_len;
-    result.ciphertext.resize(static_cast<std::size_t>(total_len));
-
-    // Get authentication tag
+    // AES-GCM ciphertext is the same size as the plaintext
+    result.ciphertext.resize(plaintext.size());
     result.metadata.auth_tag.resize(impl_->config.tag_size);
-    if (EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_GET_TAG,
-                            static_cast<int>(impl_->config.tag_size),
-                            result.metadata.auth_tag.data()) != 1) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, "Failed to get auth tag"));
+    auto sealed = seal(ctx.get(), result.metadata.iv, aad, plaintext,
+                       result.ciphertext.data(), result.metadata.auth_tag);
+    if (!sealed) {
+        return impl_->fail(sealed.error());
     }
 
-    auto end_time = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-    impl_->update_stats_encrypt(plaintext.size(), duration);
+    impl_->update_stats_encrypt(plaintext.size(), elapsed_since(start_time));
     impl_->current_state = encryption_state::ready;
 
     return result;
@@ -577,94 +766,21 @@ auto aes_gcm_engine::decrypt(
     auto start_time = std::chrono::steady_clock::now();
     impl_->current_state = encryption_state::processing;
 
-    evp_cipher_ctx_wrapper ctx;
+    auto ctx = impl_->checkout_ctx(metadata.iv.size());
     if (!ctx) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, "Failed to create cipher context"));
-    }
-
-    const EVP_CIPHER* cipher = EVP_aes_256_gcm();
-
-    // Initialize decryption
-    if (EVP_DecryptInit_ex(ctx.get(), cipher, nullptr, nullptr, nullptr) != 1) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, get_openssl_error()));
-    }
-
-    if (EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_IVLEN,
-                            static_cast<int>(metadata.iv.size()), nullptr) != 1) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, "Failed to set IV length"));
-    }
-
-    if (EVP_DecryptInit_ex(ctx.get(), nullptr, nullptr,
-                           reinterpret_cast<const unsigned char*>(impl_->key.data()),
-                           reinterpret_cast<const unsigned char*>(metadata.iv.data())) != 1) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, get_openssl_error()));
+        return impl_->fail(error(error_code::internal_error, "Failed to create cipher context"));
     }
 
-    // Process AAD
-    if (!metadata.aad.empty()) {
-        int len = 0;
-        if (EVP_DecryptUpdate(ctx.get(), nullptr, &len,
-                              reinterpret_cast<const unsigned char*>(metadata.aad.data()),
-                              static_cast<int>(metadata.aad.size())) != 1) {
-            impl_->increment_errors();
-            impl_->current_state = encryption_state::error;
-            return unexpected(error(error_code::internal_error, "Failed to process AAD"));
-        }
-    }
-
-    // Decrypt ciphertext
     decryption_result result;
-    result.plaintext.resize(ciphertext.size() + AES_BLOCK_SIZE);
-    int out_len = 0;
-
-    if (EVP_DecryptUpdate(ctx.get(),
-                          reinterpret_cast<unsigned char*>(result.plaintext.data()),
-                          &out_len,
-                          reinterpret_cast<const unsigned char*>(ciphertext.data()),
-                          static_cast<int>(ciphertext.size())) != 1) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, get_openssl_error()));
+    result.plaintext.resize(ciphertext.size());
+    auto opened = open(ctx.get(), metadata.iv, metadata.aad, ciphertext,
+                       result.plaintext.data(), metadata.auth_tag);
+    if (!opened) {
+        return impl_->fail(opened.error());
     }
-
-    int total_len = out_len;
-
-    // Set expected tag
-    if (!metadata.auth_tag.empty()) {
-        if (EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_TAG,
-                                static_cast<int>(metadata.auth_tag.size()),
-                                const_cast<std::byte*>(metadata.auth_tag.data())) != 1) {
-            impl_->increment_errors();
-            impl_->current_state = encryption_state::error;
-            return unexpected(error(error_code::internal_error, "Failed to set auth tag"));
-        }
-    }
-
-    // Finalize and verify tag
-    if (EVP_DecryptFinal_ex(ctx.get(),
-                            reinterpret_cast<unsigned char*>(result.plaintext.data()) + out_len,
-                            &out_len) != 1) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::chunk_checksum_error,
-                               "Authentication failed - data may have been tampered"));
-    }
-
-    total_len += out_len;
-    result.plaintext.resize(static_cast<std::size_t>(total_len));
     result.original_size = metadata.original_size;
 
-    auto end_time = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-    impl_->update_stats_decrypt(ciphertext.size(), duration);
+    impl_->update_stats_decrypt(ciphertext.size(), elapsed_since(start_time));
     impl_->current_state = encryption_state::ready;
 
     return result;
@@ -735,11 +851,9 @@ auto aes_gcm_engine::encrypt_chunk(
     auto start_time = std::chrono::steady_clock::now();
     impl_->current_state = encryption_state::processing;
 
-    evp_cipher_ctx_wrapper ctx;
+    auto ctx = impl_->checkout_ctx(impl_->config.iv_size);
     if (!ctx) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, "Failed to create cipher context"));
+        return impl_->fail(error(error_code::internal_error, "Failed to create cipher context"));
     }
 
     encryption_result result;
@@ -749,70 +863,151 @@ auto aes_gcm_engine::encrypt_chunk(
     // Generate chunk-specific IV with embedded chunk index
     result.metadata.iv = impl_->derive_chunk_iv(chunk_index);
     if (result.metadata.iv.empty()) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, "Failed to generate chunk IV"));
+        return impl_->fail(error(error_code::internal_error, "Failed to generate chunk IV"));
     }
 
-    const EVP_CIPHER* cipher = EVP_aes_256_gcm();
+    result.ciphertext.resize(chunk_data.size());
+    result.metadata.auth_tag.resize(impl_->config.tag_size);
+    auto sealed = seal(ctx.get(), result.metadata.iv, {}, chunk_data,
+                       result.ciphertext.data(), result.metadata.auth_tag);
+    if (!sealed) {
+        return impl_->fail(sealed.error());
+    }
 
-    if (EVP_EncryptInit_ex(ctx.get(), cipher, nullptr,
-                           reinterpret_cast<const unsigned char*>(impl_->key.data()),
-                           reinterpret_cast<const unsigned char*>(result.metadata.iv.data())) != 1) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, get_openssl_error()));
+    impl_->update_stats_encrypt(chunk_data.size(), elapsed_since(start_time));
+    impl_->current_state = encryption_state::ready;
+
+    return result;
+}
+
+auto aes_gcm_engine::decrypt_chunk(
+    std::span<const std::byte> encrypted_chunk,
+    const encryption_metadata& metadata,
+    [[maybe_unused]] uint64_t chunk_index) -> result<decryption_result> {
+    // chunk_index is unused here as IV is stored in metadata
+    return decrypt(encrypted_chunk, metadata);
+}
+
+auto aes_gcm_engine::iv_salt() const -> std::vector<std::byte> {
+    return impl_->iv_salt;
+}
+
+auto aes_gcm_engine::set_iv_salt(std::span<const std::byte> salt) -> result<void> {
+    if (!impl_->supports_chunk_iv() || salt.size() != impl_->config.iv_size - chunk_counter_size) {
+        return unexpected(error(error_code::invalid_configuration, "Invalid IV salt size"));
     }
+    impl_->iv_salt.assign(salt.begin(), salt.end());
+    return {};
+}
 
-    result.ciphertext.resize(chunk_data.size() + AES_BLOCK_SIZE);
-    int out_len = 0;
+auto aes_gcm_engine::chunk_iv(uint64_t chunk_index) const -> std::vector<std::byte> {
+    if (impl_->iv_salt.empty()) {
+        return {};
+    }
+    std::vector<std::byte> iv(impl_->config.iv_size);
+    impl_->write_chunk_iv(chunk_index, iv.data());
+    return iv;
+}
 
-    if (EVP_EncryptUpdate(ctx.get(),
-                          reinterpret_cast<unsigned char*>(result.ciphertext.data()),
-                          &out_len,
-                          reinterpret_cast<const unsigned char*>(chunk_data.data()),
-                          static_cast<int>(chunk_data.size())) != 1) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, get_openssl_error()));
+auto aes_gcm_engine::encrypt_chunk_in_place(
+    std::span<std::byte> data,
+    uint64_t chunk_index,
+    std::span<std::byte> tag) -> result<void> {
+    if (tag.size() < impl_->config.tag_size) {
+        return unexpected(error(error_code::invalid_configuration, "Tag buffer too small"));
     }
 
-    int total_len = out_len;
+    aes_gcm_chunk chunk{chunk_index, data, {}};
+    auto result = encrypt_chunks(std::span<aes_gcm_chunk>(&chunk, 1));
+    if (result) {
+        std::copy_n(chunk.tag.begin(), impl_->config.tag_size, tag.begin());
+    }
+    return result;
+}
 
-    if (EVP_EncryptFinal_ex(ctx.get(),
-                            reinterpret_cast<unsigned char*>(result.ciphertext.data()) + out_len,
-                            &out_len) != 1) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, get_openssl_error()));
+auto aes_gcm_engine::decrypt_chunk_in_place(
+    std::span<std::byte> data,
+    uint64_t chunk_index,
+    std::span<const std::byte> tag) -> result<void> {
+    if (tag.size() != impl_->config.tag_size) {
+        return unexpected(error(error_code::invalid_configuration, "Invalid tag size"));
     }
 
-    total_len += out_len;
-    result.ciphertext.resize(static_cast<std::size_t>(total_len));
+    aes_gcm_chunk chunk{chunk_index, data, {}};
+    std::copy(tag.begin(), tag.end(), chunk.tag.begin());
+    return decrypt_chunks(std::span<aes_gcm_chunk>(&chunk, 1));
+}
 
-    result.metadata.auth_tag.resize(impl_->config.tag_size);
-    if (EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_GET_TAG,
-                            static_cast<int>(impl_->config.tag_size),
-                            result.metadata.auth_tag.data()) != 1) {
-        impl_->increment_errors();
-        impl_->current_state = encryption_state::error;
-        return unexpected(error(error_code::internal_error, "Failed to get auth tag"));
+auto aes_gcm_engine::encrypt_chunks(std::span<aes_gcm_chunk> chunks) -> result<void> {
+    if (auto ready = impl_->check_chunk_ready(); !ready) {
+        return ready;
+    }
+    if (impl_->config.tag_size > AES_GCM_TAG_SIZE) {
+        return unexpected(error(error_code::invalid_configuration, "Tag size too large"));
     }
 
-    auto end_time = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-    impl_->update_stats_encrypt(chunk_data.size(), duration);
-    impl_->current_state = encryption_state::ready;
+    auto start_time = std::chrono::steady_clock::now();
+    impl_->current_state = encryption_state::processing;
 
-    return result;
+    auto ctx = impl_->checkout_ctx(impl_->config.iv_size);
+    if (!ctx) {
+        return impl_->fail(error(error_code::internal_error, "Failed to create cipher context"));
+    }
+
+    std::array<std::byte, max_chunk_iv_size> iv{};
+    auto iv_span = std::span<const std::byte>(iv.data(), impl_->config.iv_size);
+    uint64_t bytes = 0;
+    for (auto& chunk : chunks) {
+        impl_->write_chunk_iv(chunk.index, iv.data());
+        auto sealed = seal(ctx.get(), iv_span, {}, chunk.data, chunk.data.data(),
+                           std::span<std::byte>(chunk.tag.data(), impl_->config.tag_size));
+        if (!sealed) {
+            return impl_->fail(error(sealed.error().code,
+                                     "Chunk " + std::to_string(chunk.index) + ": " +
+                                         sealed.error().message));
+        }
+        bytes += chunk.data.size();
+    }
+
+    impl_->update_stats_encrypt(bytes, elapsed_since(start_time), chunks.size());
+    impl_->current_state = encryption_state::ready;
+    return {};
 }
 
-auto aes_gcm_engine::decrypt_chunk(
-    std::span<const std::byte> encrypted_chunk,
-    const encryption_metadata& metadata,
-    [[maybe_unused]] uint64_t chunk_index) -> result<decryption_result> {
-    // chunk_index is unused here as IV is stored in metadata
-    return decrypt(encrypted_chunk, metadata);
+auto aes_gcm_engine::decrypt_chunks(std::span<aes_gcm_chunk> chunks) -> result<void> {
+    if (auto ready = impl_->check_chunk_ready(); !ready) {
+        return ready;
+    }
+    if (impl_->config.tag_size > AES_GCM_TAG_SIZE) {
+        return unexpected(error(error_code::invalid_configuration, "Tag size too large"));
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    impl_->current_state = encryption_state::processing;
+
+    auto ctx = impl_->checkout_ctx(impl_->config.iv_size);
+    if (!ctx) {
+        return impl_->fail(error(error_code::internal_error, "Failed to create cipher context"));
+    }
+
+    std::array<std::byte, max_chunk_iv_size> iv{};
+    auto iv_span = std::span<const std::byte>(iv.data(), impl_->config.iv_size);
+    uint64_t bytes = 0;
+    for (auto& chunk : chunks) {
+        impl_->write_chunk_iv(chunk.index, iv.data());
+        auto opened = open(ctx.get(), iv_span, {}, chunk.data, chunk.data.data(),
+                           std::span<const std::byte>(chunk.tag.data(), impl_->config.tag_size));
+        if (!opened) {
+            return impl_->fail(error(opened.error().code,
+                                     "Chunk " + std::to_string(chunk.index) + ": " +
+                                         opened.error().message));
+        }
+        bytes += chunk.data.size();
+    }
+
+    impl_->update_stats_decrypt(bytes, elapsed_since(start_time), chunks.size());
+    impl_->current_state = encryption_state::ready;
+    return {};
 }
 
 auto aes_gcm_engine::state() const -> encryption_state {
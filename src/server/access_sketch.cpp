@@ -0,0 +1,102 @@
+/**
+ * @file access_sketch.cpp
+ * @brief Windowed count-min sketch implementation
+ */
+
+#include "kcenon/file_transfer/server/access_sketch.h"
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <limits>
+#include <mutex>
+
+namespace kcenon::file_transfer {
+
+namespace {
+
+// Finalizer from splitmix64; decorrelates the second hash from the first
+auto mix(uint64_t x) -> uint64_t {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+auto make_counters(std::size_t count) -> std::unique_ptr<std::atomic<uint32_t>[]> {
+    auto counters = std::make_unique<std::atomic<uint32_t>[]>(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        counters[i].store(0, std::memory_order_relaxed);
+    }
+    return counters;
+}
+
+}  // namespace
+
+access_sketch::access_sketch(std::size_t width, std::size_t depth)
+    : width_(std::bit_ceil(std::max<std::size_t>(width, 1)))
+    , depth_(std::max<std::size_t>(depth, 1)) {
+    generations_[0] = make_counters(width_ * depth_);
+    generations_[1] = make_counters(width_ * depth_);
+}
+
+auto access_sketch::slot(uint64_t hash, std::size_t row) const -> std::size_t {
+    // Double hashing: row i uses h1 + i * h2
+    auto h2 = mix(hash) | 1;
+    return row * width_ + ((hash + row * h2) & (width_ - 1));
+}
+
+void access_sketch::record(std::string_view key, uint32_t count) {
+    auto hash = std::hash<std::string_view>{}(key);
+    std::shared_lock lock(mutex_);
+    auto& counters = generations_[current_];
+    for (std::size_t row = 0; row < depth_; ++row) {
+        auto& counter = counters[slot(hash, row)];
+        auto value = counter.load(std::memory_order_relaxed);
+        uint32_t next;
+        do {
+            // Saturate instead of wrapping back to a small count
+            next = value > std::numeric_limits<uint32_t>::max() - count
+                ? std::numeric_limits<uint32_t>::max() : value + count;
+        } while (!counter.compare_exchange_weak(value, next, std::memory_order_relaxed));
+    }
+}
+
+auto access_sketch::estimate(std::string_view key) const -> uint64_t {
+    auto hash = std::hash<std::string_view>{}(key);
+    std::shared_lock lock(mutex_);
+    uint64_t best = std::numeric_limits<uint64_t>::max();
+    for (std::size_t row = 0; row < depth_; ++row) {
+        auto index = slot(hash, row);
+        uint64_t total = generations_[0][index].load(std::memory_order_relaxed)
+                       + generations_[1][index].load(std::memory_order_relaxed);
+        best = std::min(best, total);
+    }
+    return best;
+}
+
+void access_sketch::rotate() {
+    std::unique_lock lock(mutex_);
+    current_ ^= 1;
+    auto& counters = generations_[current_];
+    for (std::size_t i = 0; i < width_ * depth_; ++i) {
+        counters[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void access_sketch::clear() {
+    std::unique_lock lock(mutex_);
+    for (auto& counters : generations_) {
+        for (std::size_t i = 0; i < width_ * depth_; ++i) {
+            counters[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+auto access_sketch::memory_usage() const -> std::size_t {
+    return 2 * width_ * depth_ * sizeof(std::atomic<uint32_t>);
+}
+
+}  // namespace kcenon::file_transfer
@@ -4,11 +4,18 @@
  */
 
 #include "kcenon/file_transfer/server/file_transfer_server.h"
+#include "kcenon/file_transfer/core/chunk_assembler.h"
+#include "kcenon/file_transfer/core/chunk_config.h"
+#include "kcenon/file_transfer/core/frame_codec.h"
 #include "kcenon/file_transfer/core/logging.h"
+#include "kcenon/file_transfer/server/server_pipeline.h"
 
+#include <algorithm>
 #include <chrono>
+#include <deque>
 #include <filesystem>
 #include <thread>
+#include <utility>
 
 #include <kcenon/network/core/messaging_server.h>
 #include <kcenon/network/session/messaging_session.h>
@@ -38,6 +45,13 @@ struct file_transfer_server::impl {
     // Quota management
     std::unique_ptr<quota_manager> quota_mgr;
 
+    // Cloud object storage (cloud_only / hybrid modes)
+    std::unique_ptr<storage_manager> storage;
+
+    // Quota reservations held by in-flight uploads
+    std::mutex reservations_mutex;
+    std::unordered_map<transfer_id, quota_reservation> upload_reservations;
+
     // Client tracking
     std::shared_mutex clients_mutex;
     std::unordered_map<uint64_t, client_info> clients;
@@ -57,7 +71,746 @@ struct file_transfer_server::impl {
         FT_LOG_INFO_CTX(log_category::server, "Client disconnected", ctx);
     }
 
+    static auto backend_type_for(cloud_provider provider) -> storage_backend_type {
+        switch (provider) {
+            case cloud_provider::azure_blob:
+                return storage_backend_type::cloud_azure;
+            case cloud_provider::google_cloud:
+                return storage_backend_type::cloud_gcs;
+            default:
+                return storage_backend_type::cloud_s3;
+        }
+    }
+
+    // Cloud reads in hybrid mode fall back from the local directory; with
+    // caching enabled they are served from cache_directory while the ETag
+    // still matches
+    void create_storage_manager() {
+        if (config.storage == storage_mode::local_only || !config.cloud_config ||
+            !config.cloud_config->cloud_storage) {
+            return;
+        }
+        const auto& cloud = *config.cloud_config;
+
+        std::shared_ptr<storage_backend> cloud_backend = cloud_storage_backend::create(
+            cloud.cloud_storage, backend_type_for(cloud.cloud_storage->provider()));
+
+        storage_manager_config manager_config;
+        if (config.storage == storage_mode::hybrid) {
+            manager_config.primary_backend = local_storage_backend::create(config.storage_directory);
+            manager_config.secondary_backend = std::move(cloud_backend);
+            manager_config.hybrid_storage = true;
+            manager_config.fallback_reads = cloud.fallback_reads;
+            manager_config.replicate_writes = cloud.replicate_writes;
+            manager_config.async_replication = cloud.async_replication;
+        } else {
+            manager_config.primary_backend = std::move(cloud_backend);
+        }
+        if (cloud.enable_cache && !cloud.cache_directory.empty()) {
+            manager_config.cache_directory = cloud.cache_directory;
+            manager_config.max_cache_size = cloud.max_cache_size;
+        }
+
+        storage = storage_manager::create(manager_config);
+    }
+
+    // ------------------------------------------------------------------------
+    // Upload data path
+    //
+    // Each connection has a frame decoder fed from the network receive
+    // callback. CHUNK_DATA frames go into the staged pipeline, whose write
+    // stage stores them through the assembler. Chunks of one transfer may be
+    // processed in any order since the assembler writes by offset; only
+    // UPLOAD_COMPLETE is ordered after them, by waiting until the transfer
+    // has no chunks in flight.
+    //
+    // network_system has no per-session read pause, and the receive
+    // callback runs on its I/O threads, so it must not wait for the
+    // pipeline. A chunk whose flow window is full is parked on its session
+    // and submitted when the pipeline reports a free slot. Parking is
+    // bounded per session; beyond that, chunks are NACKed and resent by
+    // the client.
+    // ------------------------------------------------------------------------
+
+    // A chunk parked longer than this gives up and is NACKed
+    static constexpr auto receive_stall_limit = std::chrono::seconds(30);
+
+    // Bytes a session may park; one chunk is always accepted
+    static constexpr std::size_t receive_park_limit = 64 * 1024 * 1024;
+
+    using session_ptr = std::shared_ptr<kcenon::network::session::messaging_session>;
+
+    struct parked_chunk {
+        pipeline_chunk chunk;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    struct session_state {
+        std::mutex mutex;  // Serializes decoding for the connection
+        frame_decoder decoder;
+        client_info info;
+        std::string session_id;
+
+        // Chunks waiting for room in their flow, oldest first. One thread
+        // drains at a time; others set drain_requested and leave.
+        std::mutex park_mutex;
+        std::deque<parked_chunk> parked;
+        std::size_t parked_bytes = 0;
+        bool draining = false;
+        bool drain_requested = false;
+
+        explicit session_state(std::size_t max_payload) : decoder(max_payload) {}
+    };
+
+    struct upload_state {
+        std::string session_id;
+        std::weak_ptr<kcenon::network::session::messaging_session> session;
+        client_id client;
+        std::string filename;
+        uint64_t file_size = 0;
+        std::string sha256_hash;    // Hex; empty when not verified
+        bool digest_deferred = false;  // sha256_hash arrives with UPLOAD_COMPLETE
+        uint64_t in_flight = 0;     // Chunks submitted but not yet written or failed
+        uint64_t bytes_written = 0;
+        bool complete_requested = false;
+        bool abandoned = false;     // Connection closed; cancel once drained
+    };
+
+    std::shared_mutex sessions_mutex;
+    std::unordered_map<std::string, std::shared_ptr<session_state>> sessions;
+
+    // Chunks parked across all sessions; lets free slots skip the scan
+    std::atomic<std::size_t> parked_chunks{0};
+
+    std::mutex uploads_mutex;
+    std::unordered_map<transfer_id, upload_state> uploads;
+
+    // Declared after the maps so pipeline callbacks never outlive them
+    std::shared_ptr<chunk_assembler> assembler;
+    std::unique_ptr<server_pipeline> pipeline;
+
+    static auto upload_directory(const server_config& cfg) -> std::filesystem::path {
+        if (!cfg.storage_directory.empty()) {
+            return cfg.storage_directory;
+        }
+        return std::filesystem::temp_directory_path() / "file_trans_uploads";
+    }
+
+    static auto to_hex(const std::array<uint8_t, 32>& digest) -> std::string {
+        static constexpr char digits[] = "0123456789abcdef";
+        std::string hex;
+        bool any = false;
+        for (auto b : digest) {
+            hex.push_back(digits[b >> 4]);
+            hex.push_back(digits[b & 0x0F]);
+            any = any || b != 0;
+        }
+        return any ? hex : std::string{};
+    }
+
+    static auto is_valid_filename(const std::string& name) -> bool {
+        return !name.empty() && name.size() <= 255 && name != "." && name != ".." &&
+               name.find_first_of("/\\") == std::string::npos &&
+               name.find('\0') == std::string::npos;
+    }
+
+    static void send(const session_ptr& session, message_type type,
+                     const std::vector<uint8_t>& payload) {
+        if (session) {
+            session->send_packet(encode_frame(type, payload));
+        }
+    }
+
+    static void send_nack(const session_ptr& session, const transfer_id& id,
+                          uint64_t chunk_index, error_code reason) {
+        send(session, message_type::chunk_nack,
+             encode_chunk_nack(msg_chunk_nack{id.bytes, chunk_index,
+                                              static_cast<int32_t>(reason), 0}));
+    }
+
+    void create_data_path() {
+        auto pipeline_result = server_pipeline::create(pipeline_config::auto_detect());
+        if (!pipeline_result.has_value()) {
+            FT_LOG_ERROR(log_category::server,
+                "Failed to create upload pipeline: " + pipeline_result.error().message);
+            return;
+        }
+        pipeline = std::make_unique<server_pipeline>(std::move(pipeline_result.value()));
+
+        auto dir = upload_directory(config);
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        assembler = std::make_shared<chunk_assembler>(dir);
+        assembler->on_chunk_recovered([this](const transfer_id& id, const chunk& rebuilt) {
+            on_chunk_recovered(id, rebuilt);
+        });
+        pipeline->set_chunk_assembler(assembler);
+
+        pipeline->on_stage_complete([this](pipeline_stage stage, const pipeline_chunk& chunk) {
+            if (stage == pipeline_stage::file_write) {
+                on_chunk_written(chunk);
+            }
+        });
+        pipeline->on_chunk_error(
+            [this](pipeline_stage stage, const pipeline_chunk& chunk, const std::string&) {
+                on_chunk_failed(chunk, reason_for(stage));
+            });
+        pipeline->on_upload_capacity([this] { drain_parked_sessions(); });
+    }
+
+    // NACK reason for a chunk that failed in a pipeline stage; one the
+    // stages never took is worth resending as is
+    static auto reason_for(pipeline_stage stage) -> error_code {
+        switch (stage) {
+            case pipeline_stage::network_recv:
+                return error_code::queue_full;
+            case pipeline_stage::file_write:
+                return error_code::file_write_error;
+            default:
+                return error_code::chunk_checksum_error;
+        }
+    }
+
+    void register_network_callbacks() {
+        network_server->set_connection_callback([this](session_ptr session) {
+            on_connect(session);
+        });
+        network_server->set_disconnection_callback([this](const std::string& session_id) {
+            on_disconnect(session_id);
+        });
+        network_server->set_receive_callback(
+            [this](session_ptr session, const std::vector<uint8_t>& data) {
+                on_receive(session, data);
+            });
+    }
+
+    void on_connect(const session_ptr& session) {
+        // Frames must fit the largest chunk this server accepts
+        auto state = std::make_shared<session_state>(
+            std::max(config.chunk_size, config.max_chunk_size) + chunk_header::size);
+        state->session_id = std::string(session->id());
+        state->info.id = client_id{next_client_id.fetch_add(1)};
+        {
+            std::unique_lock lock(sessions_mutex);
+            sessions[state->session_id] = state;
+        }
+        {
+            std::unique_lock lock(clients_mutex);
+            clients[state->info.id.value] = state->info;
+        }
+        log_client_connected(state->info);
+        if (connect_callback) {
+            connect_callback(state->info);
+        }
+    }
+
+    void on_disconnect(const std::string& session_id) {
+        std::shared_ptr<session_state> state;
+        {
+            std::unique_lock lock(sessions_mutex);
+            auto it = sessions.find(session_id);
+            if (it == sessions.end()) {
+                return;
+            }
+            state = std::move(it->second);
+            sessions.erase(it);
+        }
+
+        auto parked = take_parked(*state);
+
+        std::vector<transfer_id> owned;
+        {
+            std::lock_guard lock(uploads_mutex);
+            for (auto& [id, upload] : uploads) {
+                if (upload.session_id == session_id) {
+                    upload.abandoned = true;
+                    owned.push_back(id);
+                }
+            }
+        }
+        for (const auto& entry : parked) {
+            on_chunk_failed_for(entry.chunk.id, entry.chunk.chunk_index,
+                                error_code::operation_cancelled);
+        }
+        for (const auto& id : owned) {
+            // Chunks held for history that will not come any more
+            pipeline->close_stream(id);
+            finish_if_drained(id);
+        }
+
+        {
+            std::unique_lock lock(clients_mutex);
+            clients.erase(state->info.id.value);
+        }
+        log_client_disconnected(state->info);
+        if (disconnect_callback) {
+            disconnect_callback(state->info);
+        }
+    }
+
+    void on_receive(const session_ptr& session, const std::vector<uint8_t>& data) {
+        std::shared_ptr<session_state> state;
+        {
+            std::shared_lock lock(sessions_mutex);
+            auto it = sessions.find(std::string(session->id()));
+            if (it == sessions.end()) {
+                return;
+            }
+            state = it->second;
+        }
+        {
+            std::lock_guard lock(stats_mutex);
+            statistics.total_bytes_received += data.size();
+        }
+
+        std::lock_guard lock(state->mutex);
+        state->decoder.feed(data);
+        while (auto f = state->decoder.next()) {
+            dispatch(*state, session, std::move(*f));
+        }
+    }
+
+    void dispatch(session_state& state, const session_ptr& session, frame f) {
+        switch (f.type) {
+            case message_type::upload_request:
+                handle_upload_request(state, session, f.payload);
+                break;
+            case message_type::chunk_data:
+                handle_chunk_data(state, session, f.payload);
+                break;
+            case message_type::upload_complete:
+                handle_upload_complete(state, f.payload);
+                break;
+            case message_type::heartbeat:
+                send(session, message_type::heartbeat_ack, {});
+                break;
+            default:
+                FT_LOG_DEBUG(log_category::server,
+                    "Ignoring unsupported message " + std::string(to_string(f.type)));
+                break;
+        }
+    }
+
+    void handle_upload_request(session_state& state, const session_ptr& session,
+                               const std::vector<uint8_t>& payload) {
+        auto request = decode_upload_request(payload);
+        if (!request.has_value()) {
+            FT_LOG_WARN(log_category::server, request.error().message);
+            return;
+        }
+        const auto& msg = request.value();
+        transfer_id id(msg.transfer_id);
+
+        auto reject = [&](error_code code, const std::string& message) {
+            send(session, message_type::upload_reject,
+                 encode_upload_reject(msg_upload_reject{
+                     msg.transfer_id, static_cast<int32_t>(code), message}));
+        };
+
+        if (!pipeline || !pipeline->is_running()) {
+            reject(error_code::server_not_running, "Upload path unavailable");
+            return;
+        }
+        if (!is_valid_filename(msg.filename)) {
+            reject(error_code::invalid_file_path, "Invalid filename");
+            return;
+        }
+        {
+            std::lock_guard lock(uploads_mutex);
+            if (uploads.contains(id)) {
+                reject(error_code::file_already_exists, "Transfer already in progress");
+                return;
+            }
+        }
+
+        // A deferred digest is hashed by the client while streaming; the
+        // request carries no hash then
+        const bool deferred = has_option(msg.options, transfer_options::deferred_digest);
+        auto chunk_size = static_cast<uint64_t>(config.chunk_size);
+        upload_request request_info{msg.filename, msg.file_size,
+                                    (msg.file_size + chunk_size - 1) / chunk_size,
+                                    deferred ? std::string{} : to_hex(msg.sha256_hash),
+                                    state.info.id};
+        if (upload_callback && !upload_callback(request_info)) {
+            reject(error_code::file_access_denied, "Upload rejected by server");
+            return;
+        }
+
+        auto reserved = reserve_upload(id, msg.file_size, state.info.id);
+        if (!reserved.has_value()) {
+            reject(reserved.error().code, reserved.error().message);
+            return;
+        }
+        // Variable-size chunks are placed by offset; the count is an estimate
+        const bool variable = has_option(msg.options, transfer_options::variable_chunks);
+        auto started = variable
+            ? assembler->start_variable_session(id, msg.filename, msg.file_size)
+            : assembler->start_session(id, msg.filename, msg.file_size,
+                                       request_info.total_chunks);
+        if (!started.has_value()) {
+            release_upload(id);
+            reject(started.error().code, started.error().message);
+            return;
+        }
+
+        {
+            std::lock_guard lock(uploads_mutex);
+            upload_state upload;
+            upload.session_id = state.session_id;
+            upload.session = session;
+            upload.client = state.info.id;
+            upload.filename = msg.filename;
+            upload.file_size = msg.file_size;
+            // Payload encryption is not negotiated here, so chunks carry checksums
+            auto checks = integrity_policy::plan(
+                {false, has_option(msg.options, transfer_options::verify_checksum)});
+            if (has_check(checks, integrity_check::file_digest)) {
+                upload.sha256_hash = request_info.sha256_hash;
+                upload.digest_deferred = deferred;
+            }
+            uploads.emplace(id, std::move(upload));
+        }
+        if (msg.compression == wire_compression_mode::lz4_stream) {
+            pipeline->open_stream(id);
+        }
+        {
+            std::lock_guard lock(stats_mutex);
+            statistics.active_uploads++;
+            statistics.active_transfers++;
+        }
+
+        // Chunks are decompressed by the pipeline; payload encryption is not
+        // negotiated on this path. A variable-size upload is told the
+        // largest chunk it may send instead of the size to use
+        auto accepted_chunk_size = variable ? config.max_chunk_size : config.chunk_size;
+        send(session, message_type::upload_accept,
+             encode_upload_accept(msg_upload_accept{
+                 msg.transfer_id, msg.compression, wire_encryption_algorithm::none,
+                 static_cast<uint32_t>(accepted_chunk_size), 0}));
+    }
+
+    void handle_chunk_data(session_state& state, const session_ptr& session,
+                           const std::vector<uint8_t>& payload) {
+        auto decoded = decode_chunk_data(payload);
+        if (!decoded.has_value()) {
+            FT_LOG_WARN(log_category::server, decoded.error().message);
+            return;
+        }
+        auto& c = decoded.value();
+        auto id = c.header.id;
+        auto index = c.header.chunk_index;
+
+        {
+            std::lock_guard lock(uploads_mutex);
+            auto it = uploads.find(id);
+            if (it == uploads.end() || it->second.session_id != state.session_id ||
+                it->second.abandoned) {
+                send_nack(session, id, index, error_code::transfer_not_found);
+                return;
+            }
+            it->second.in_flight++;
+        }
+
+        pipeline_chunk pc;
+        pc.id = id;
+        pc.client = state.info.id;
+        pc.chunk_index = index;
+        pc.chunk_offset = c.header.chunk_offset;
+        pc.checksum = c.digest();
+        pc.integrity = c.header.integrity;
+        pc.is_compressed = c.is_compressed();
+        pc.original_size = c.header.original_size;
+        pc.flags = c.header.flags;
+        pc.data = std::move(c.data);
+
+        // Queued behind chunks already parked so the session stays in order
+        bool parked = false;
+        {
+            std::lock_guard lock(state.park_mutex);
+            if (state.parked.empty() ||
+                state.parked_bytes + pc.data.size() <= receive_park_limit) {
+                state.parked_bytes += pc.data.size();
+                state.parked.push_back({std::move(pc), std::chrono::steady_clock::now()});
+                parked_chunks.fetch_add(1);
+                parked = true;
+            }
+        }
+        if (parked) {
+            drain_parked(state);
+            return;
+        }
+        FT_LOG_WARN(log_category::server,
+            "Chunk " + std::to_string(index) + " not accepted: too much data waiting");
+        on_chunk_failed_for(id, index, error_code::queue_full);
+    }
+
+    // Submits a session's parked chunks until a flow window is full; chunks
+    // parked past receive_stall_limit are NACKed instead
+    void drain_parked(session_state& state) {
+        std::unique_lock lock(state.park_mutex);
+        state.drain_requested = true;
+        if (state.draining) {
+            return;
+        }
+        state.draining = true;
+        while (std::exchange(state.drain_requested, false)) {
+            while (!state.parked.empty()) {
+                auto entry = std::move(state.parked.front());
+                state.parked.pop_front();
+                auto size = entry.chunk.data.size();
+                lock.unlock();
+
+                bool expired = std::chrono::steady_clock::now() - entry.since >
+                               receive_stall_limit;
+                bool submitted = !expired && pipeline->offer_upload_chunk(entry.chunk);
+                if (expired) {
+                    FT_LOG_WARN(log_category::server,
+                        "Chunk " + std::to_string(entry.chunk.chunk_index) +
+                        " not accepted: timed out waiting for pipeline capacity");
+                    on_chunk_failed_for(entry.chunk.id, entry.chunk.chunk_index,
+                                        error_code::queue_full);
+                }
+
+                lock.lock();
+                if (!submitted && !expired) {
+                    // Retried on the next free slot, or now if one freed up
+                    state.parked.push_front(std::move(entry));
+                    break;
+                }
+                state.parked_bytes -= size;
+                parked_chunks.fetch_sub(1);
+            }
+        }
+        state.draining = false;
+    }
+
+    void drain_parked_sessions() {
+        if (parked_chunks.load() == 0) {
+            return;
+        }
+        std::vector<std::shared_ptr<session_state>> waiting;
+        {
+            std::shared_lock lock(sessions_mutex);
+            waiting.reserve(sessions.size());
+            for (const auto& [id, state] : sessions) {
+                waiting.push_back(state);
+            }
+        }
+        for (const auto& state : waiting) {
+            drain_parked(*state);
+        }
+    }
+
+    // Removes a session's parked chunks; the caller fails or drops them
+    auto take_parked(session_state& state) -> std::deque<parked_chunk> {
+        std::lock_guard lock(state.park_mutex);
+        parked_chunks.fetch_sub(state.parked.size());
+        state.parked_bytes = 0;
+        return std::exchange(state.parked, {});
+    }
+
+    void handle_upload_complete(session_state& state, const std::vector<uint8_t>& payload) {
+        auto decoded = decode_upload_complete(payload);
+        if (!decoded.has_value()) {
+            FT_LOG_WARN(log_category::server, decoded.error().message);
+            return;
+        }
+        const auto& msg = decoded.value();
+        transfer_id id(msg.transfer_id);
+        {
+            std::lock_guard lock(uploads_mutex);
+            auto it = uploads.find(id);
+            if (it == uploads.end() || it->second.session_id != state.session_id) {
+                return;
+            }
+            // Without a digest the upload is stored unverified, as if
+            // verification had not been requested
+            if (it->second.digest_deferred && msg.has_digest()) {
+                it->second.sha256_hash = to_hex(msg.sha256_hash);
+            }
+            it->second.complete_requested = true;
+        }
+        finish_if_drained(id);
+    }
+
+    void on_chunk_written(const pipeline_chunk& chunk) {
+        // Parity is not part of the file and is never acknowledged; the
+        // chunks it rebuilt are, through on_chunk_recovered()
+        if (is_parity(chunk.flags)) {
+            {
+                std::lock_guard lock(uploads_mutex);
+                auto it = uploads.find(chunk.id);
+                if (it == uploads.end()) {
+                    return;
+                }
+                it->second.in_flight--;
+            }
+            finish_if_drained(chunk.id);
+            return;
+        }
+        record_written(chunk.id, chunk.chunk_index,
+                       has_flag(chunk.flags, chunk_flags::zero_range) ? chunk.original_size
+                                                                      : chunk.data.size(),
+                       true);
+    }
+
+    // A chunk rebuilt from FEC parity while a parity chunk was written; a
+    // stream-compressed upload may have chunks waiting for its data
+    void on_chunk_recovered(const transfer_id& id, const chunk& rebuilt) {
+        const auto& header = rebuilt.header;
+        FT_LOG_DEBUG(log_category::server,
+            "Chunk " + std::to_string(header.chunk_index) + " rebuilt from parity");
+        pipeline->record_rebuilt_chunk(id, rebuilt);
+        record_written(id, header.chunk_index, header.original_size, false);
+    }
+
+    void record_written(const transfer_id& id, uint64_t chunk_index, uint64_t bytes,
+                        bool was_in_flight) {
+        session_ptr session;
+        transfer_progress progress;
+        {
+            std::lock_guard lock(uploads_mutex);
+            auto it = uploads.find(id);
+            if (it == uploads.end()) {
+                return;
+            }
+            auto& upload = it->second;
+            if (was_in_flight) {
+                upload.in_flight--;
+            }
+            upload.bytes_written += bytes;
+            session = upload.session.lock();
+            progress.filename = upload.filename;
+            progress.bytes_transferred = upload.bytes_written;
+            progress.total_bytes = upload.file_size;
+            progress.percentage = upload.file_size > 0
+                ? static_cast<double>(upload.bytes_written) * 100.0 /
+                      static_cast<double>(upload.file_size)
+                : 100.0;
+        }
+
+        send(session, message_type::chunk_ack,
+             encode_chunk_ack(msg_chunk_ack{id.bytes, chunk_index}));
+        if (progress_callback) {
+            progress_callback(progress);
+        }
+        if (was_in_flight) {
+            finish_if_drained(id);
+        }
+    }
+
+    void on_chunk_failed(const pipeline_chunk& chunk, error_code reason) {
+        on_chunk_failed_for(chunk.id, chunk.chunk_index, reason);
+    }
+
+    void on_chunk_failed_for(const transfer_id& id, uint64_t index, error_code reason) {
+        session_ptr session;
+        {
+            std::lock_guard lock(uploads_mutex);
+            auto it = uploads.find(id);
+            if (it == uploads.end()) {
+                return;
+            }
+            it->second.in_flight--;
+            session = it->second.session.lock();
+        }
+        send_nack(session, id, index, reason);
+        finish_if_drained(id);
+    }
+
+    // Completes or cancels an upload once none of its chunks are in flight
+    void finish_if_drained(const transfer_id& id) {
+        upload_state upload;
+        {
+            std::lock_guard lock(uploads_mutex);
+            auto it = uploads.find(id);
+            if (it == uploads.end() || it->second.in_flight > 0 ||
+                (!it->second.complete_requested && !it->second.abandoned)) {
+                return;
+            }
+            if (!it->second.abandoned && !assembler->is_complete(id)) {
+                // Ask for the gaps; the client resends UPLOAD_COMPLETE after them
+                it->second.complete_requested = false;
+                auto session = it->second.session.lock();
+                for (auto index : assembler->get_missing_chunks(id)) {
+                    send_nack(session, id, index, error_code::missing_chunks);
+                }
+                return;
+            }
+            upload = std::move(it->second);
+            uploads.erase(it);
+        }
+        pipeline->close_transfer(id);
+        {
+            std::lock_guard lock(stats_mutex);
+            statistics.active_uploads--;
+            statistics.active_transfers--;
+        }
+
+        if (upload.abandoned) {
+            assembler->cancel_session(id);
+            release_upload(id);
+            return;
+        }
+
+        auto session = upload.session.lock();
+        auto finalized = assembler->finalize(id, upload.sha256_hash);
+        if (!finalized.has_value()) {
+            release_upload(id);
+            FT_LOG_WARN(log_category::server,
+                "Upload of " + upload.filename + " failed: " + finalized.error().message);
+            send(session, message_type::upload_ack,
+                 encode_upload_ack(msg_upload_ack{id.bytes, 0, {}}));
+            if (complete_callback) {
+                complete_callback(transfer_result{false, upload.filename, upload.bytes_written,
+                                                  finalized.error().message});
+            }
+            return;
+        }
+
+        commit_upload(id, finalized.value(), upload.file_size);
+        {
+            std::lock_guard lock(stats_mutex);
+            statistics.total_files_uploaded++;
+        }
+        send(session, message_type::upload_ack,
+             encode_upload_ack(msg_upload_ack{
+                 id.bytes, static_cast<uint8_t>(!upload.sha256_hash.empty()), upload.filename}));
+        if (complete_callback) {
+            complete_callback(transfer_result{true, upload.filename, upload.file_size, {}});
+        }
+    }
+
+    // Drop uploads left open when the server stops
+    void abandon_uploads() {
+        {
+            std::shared_lock lock(sessions_mutex);
+            for (const auto& [id, state] : sessions) {
+                (void)take_parked(*state);
+            }
+        }
+        std::vector<transfer_id> ids;
+        {
+            std::lock_guard lock(uploads_mutex);
+            for (auto& [id, upload] : uploads) {
+                ids.push_back(id);
+            }
+            uploads.clear();
+        }
+        for (const auto& id : ids) {
+            pipeline->close_transfer(id);
+            assembler->cancel_session(id);
+            release_upload(id);
+        }
+        std::lock_guard lock(stats_mutex);
+        statistics.active_uploads = 0;
+        statistics.active_transfers = 0;
+    }
+
     explicit impl(server_config cfg) : config(std::move(cfg)) {
+        create_storage_manager();
+        create_data_path();
+
         // Initialize quota manager
         auto qm_result = quota_manager::create(
             config.storage_directory, config.storage_quota);
@@ -91,6 +844,116 @@ struct file_transfer_server::impl {
             }
         }
     }
+
+    auto check_upload_allowed(uint64_t file_size) -> result<void> {
+        if (quota_mgr) {
+            // Check file size limit
+            auto file_result = quota_mgr->check_file_size(file_size);
+            if (!file_result.has_value()) {
+                FT_LOG_WARN(log_category::server,
+                    "Upload rejected: file too large (" + std::to_string(file_size) + " bytes)");
+                return file_result;
+            }
+
+            // Check quota
+            auto quota_result = quota_mgr->check_quota(file_size);
+            if (!quota_result.has_value()) {
+                FT_LOG_WARN(log_category::server,
+                    "Upload rejected: quota exceeded");
+                return quota_result;
+            }
+        } else {
+            // Fallback check
+            if (config.max_file_size > 0 && file_size > config.max_file_size) {
+                return unexpected{error{error_code::file_too_large,
+                                       "File size exceeds maximum allowed"}};
+            }
+            std::lock_guard lock(stats_mutex);
+            if (storage_statistics.used_size + file_size >
+                storage_statistics.total_capacity) {
+                return unexpected{error{error_code::quota_exceeded,
+                                       "Storage quota would be exceeded"}};
+            }
+        }
+        return {};
+    }
+
+    auto reserve_upload(const transfer_id& id, uint64_t file_size, client_id client)
+        -> result<void> {
+        if (!quota_mgr) {
+            return check_upload_allowed(file_size);
+        }
+
+        auto file_result = quota_mgr->check_file_size(file_size);
+        if (!file_result.has_value()) {
+            FT_LOG_WARN(log_category::server,
+                "Upload rejected: file too large (" + std::to_string(file_size) + " bytes)");
+            return file_result;
+        }
+
+        auto reservation = quota_mgr->reserve(file_size, client.value);
+        if (!reservation.has_value()) {
+            FT_LOG_WARN(log_category::server, "Upload rejected: quota exceeded");
+            return unexpected{reservation.error()};
+        }
+
+        std::optional<quota_reservation> replaced;
+        {
+            std::lock_guard lock(reservations_mutex);
+            auto [it, inserted] = upload_reservations.try_emplace(id, reservation.value());
+            if (!inserted) {
+                replaced = it->second;
+                it->second = reservation.value();
+            }
+        }
+        if (replaced) {
+            quota_mgr->release_reservation(*replaced);
+        }
+        return {};
+    }
+
+    void commit_upload(const transfer_id& id, const std::filesystem::path& stored_path,
+                       uint64_t actual_size) {
+        if (!quota_mgr) {
+            return;
+        }
+
+        std::optional<quota_reservation> reservation;
+        {
+            std::lock_guard lock(reservations_mutex);
+            auto it = upload_reservations.find(id);
+            if (it != upload_reservations.end()) {
+                reservation = it->second;
+                upload_reservations.erase(it);
+            }
+        }
+
+        if (reservation) {
+            quota_mgr->commit_reservation(*reservation, stored_path, actual_size);
+        } else {
+            quota_mgr->record_file_stored(stored_path, actual_size);
+        }
+    }
+
+    void release_upload(const transfer_id& id) {
+        if (!quota_mgr) {
+            return;
+        }
+
+        std::optional<quota_reservation> reservation;
+        {
+            std::lock_guard lock(reservations_mutex);
+            auto it = upload_reservations.find(id);
+            if (it != upload_reservations.end()) {
+                reservation = it->second;
+                upload_reservations.erase(it);
+            }
+        }
+
+        if (reservation) {
+            quota_mgr->release_reservation(*reservation);
+        }
+    }
 };
 
 // Builder implementation
@@ -122,6 +985,11 @@ auto file_transfer_server::builder::with_chunk_size(std::size_t size) -> builder
     return *this;
 }
 
+auto file_transfer_server::builder::with_max_chunk_size(std::size_t size) -> builder& {
+    config_.max_chunk_size = size;
+    return *this;
+}
+
 auto file_transfer_server::builder::with_storage_mode(storage_mode mode) -> builder& {
     config_.storage = mode;
     return *this;
@@ -161,6 +1029,14 @@ auto file_transfer_server::builder::with_cloud_replication(bool enable) -> build
     return *this;
 }
 
+auto file_transfer_server::builder::with_async_replication(bool enable) -> builder& {
+    if (!config_.cloud_config) {
+        config_.cloud_config = cloud_storage_server_config{};
+    }
+    config_.cloud_config->async_replication = enable;
+    return *this;
+}
+
 auto file_transfer_server::builder::with_cloud_fallback(bool enable) -> builder& {
     if (!config_.cloud_config) {
         config_.cloud_config = cloud_storage_server_config{};
@@ -203,6 +1079,10 @@ auto file_transfer_server::builder::build() -> result<file_transfer_server> {
         }
     }
 
+    if (auto valid = chunk_config(config_.max_chunk_size).validate(); !valid) {
+        return unexpected{valid.error()};
+    }
+
     // Create storage directory if needed (for local or hybrid modes)
     if (config_.storage != storage_mode::cloud_only &&
         !config_.storage_directory.empty()) {
@@ -272,8 +1152,22 @@ auto file_transfer_server::start(const endpoint& listen_addr) -> result<void> {
     impl_->current_state = server_state::starting;
     impl_->listen_port = listen_addr.port;
 
+    if (impl_->pipeline) {
+        auto pipeline_started = impl_->pipeline->start();
+        if (!pipeline_started.has_value()) {
+            impl_->current_state = server_state::stopped;
+            FT_LOG_ERROR(log_category::server,
+                "Failed to start upload pipeline: " + pipeline_started.error().message);
+            return pipeline_started;
+        }
+    }
+    impl_->register_network_callbacks();
+
     auto result = impl_->network_server->start_server(listen_addr.port);
     if (result.is_err()) {
+        if (impl_->pipeline) {
+            (void)impl_->pipeline->stop(false);
+        }
         impl_->current_state = server_state::stopped;
         FT_LOG_ERROR(log_category::server,
             "Failed to start network server: " + result.error().message);
@@ -281,6 +1175,14 @@ auto file_transfer_server::start(const endpoint& listen_addr) -> result<void> {
                                "Failed to start network server: " + result.error().message}};
     }
 
+    if (impl_->storage) {
+        auto initialized = impl_->storage->initialize();
+        if (!initialized.has_value()) {
+            FT_LOG_WARN(log_category::server,
+                "Cloud storage unavailable: " + initialized.error().message);
+        }
+    }
+
     impl_->current_state = server_state::running;
     FT_LOG_INFO(log_category::server,
         "Server started successfully on port " + std::to_string(listen_addr.port));
@@ -306,6 +1208,16 @@ auto file_transfer_server::stop() -> result<void> {
                                "Failed to stop network server: " + result.error().message}};
     }
 
+    // Chunks already accepted are written before their uploads are dropped
+    if (impl_->pipeline) {
+        (void)impl_->pipeline->stop(true);
+    }
+    impl_->abandon_uploads();
+
+    if (impl_->storage) {
+        (void)impl_->storage->shutdown();
+    }
+
     impl_->current_state = server_state::stopped;
     impl_->listen_port = 0;
     FT_LOG_INFO(log_category::server, "Server stopped");
@@ -360,6 +1272,26 @@ void file_transfer_server::on_progress(
     impl_->progress_callback = std::move(callback);
 }
 
+void file_transfer_server::set_client_weight(client_id client, uint32_t weight) {
+    if (impl_->pipeline) {
+        impl_->pipeline->set_client_weight(client, weight);
+    }
+}
+
+void file_transfer_server::set_transfer_priority(const transfer_id& id,
+                                                 flow_priority priority) {
+    if (impl_->pipeline) {
+        impl_->pipeline->set_transfer_priority(id, priority);
+    }
+}
+
+auto file_transfer_server::get_flow_statistics() const -> std::vector<flow_stats> {
+    if (!impl_->pipeline) {
+        return {};
+    }
+    return impl_->pipeline->flow_statistics();
+}
+
 auto file_transfer_server::get_statistics() const -> server_statistics {
     std::lock_guard lock(impl_->stats_mutex);
     auto stats = impl_->statistics;
@@ -373,6 +1305,14 @@ auto file_transfer_server::get_storage_stats() const -> storage_stats {
     return impl_->storage_statistics;
 }
 
+auto file_transfer_server::get_storage_manager() -> storage_manager* {
+    return impl_->storage.get();
+}
+
+auto file_transfer_server::get_storage_manager() const -> const storage_manager* {
+    return impl_->storage.get();
+}
+
 auto file_transfer_server::config() const -> const server_config& {
     return impl_->config;
 }
@@ -413,36 +1353,25 @@ auto file_transfer_server::get_quota_usage() const -> quota_usage {
 }
 
 auto file_transfer_server::check_upload_allowed(uint64_t file_size) -> result<void> {
-    if (impl_->quota_mgr) {
-        // Check file size limit
-        auto file_result = impl_->quota_mgr->check_file_size(file_size);
-        if (!file_result.has_value()) {
-            FT_LOG_WARN(log_category::server,
-                "Upload rejected: file too large (" + std::to_string(file_size) + " bytes)");
-            return file_result;
-        }
+    return impl_->check_upload_allowed(file_size);
+}
 
-        // Check quota
-        auto quota_result = impl_->quota_mgr->check_quota(file_size);
-        if (!quota_result.has_value()) {
-            FT_LOG_WARN(log_category::server,
-                "Upload rejected: quota exceeded");
-            return quota_result;
-        }
-    } else {
-        // Fallback check
-        if (impl_->config.max_file_size > 0 && file_size > impl_->config.max_file_size) {
-            return unexpected{error{error_code::file_too_large,
-                                   "File size exceeds maximum allowed"}};
-        }
-        std::lock_guard lock(impl_->stats_mutex);
-        if (impl_->storage_statistics.used_size + file_size >
-            impl_->storage_statistics.total_capacity) {
-            return unexpected{error{error_code::quota_exceeded,
-                                   "Storage quota would be exceeded"}};
-        }
-    }
-    return {};
+auto file_transfer_server::reserve_upload(
+    const transfer_id& id,
+    uint64_t file_size,
+    client_id client) -> result<void> {
+    return impl_->reserve_upload(id, file_size, client);
+}
+
+void file_transfer_server::commit_upload(
+    const transfer_id& id,
+    const std::filesystem::path& stored_path,
+    uint64_t actual_size) {
+    impl_->commit_upload(id, stored_path, actual_size);
+}
+
+void file_transfer_server::release_upload(const transfer_id& id) {
+    impl_->release_upload(id);
 }
 
 void file_transfer_server::on_quota_warning(
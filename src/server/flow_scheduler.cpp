@@ -0,0 +1,304 @@
+/**
+ * @file flow_scheduler.cpp
+ * @brief Weighted deficit round-robin scheduling of upload chunks by flow
+ */
+
+#include "kcenon/file_transfer/server/flow_scheduler.h"
+#include "kcenon/file_transfer/server/server_pipeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <unordered_map>
+
+namespace kcenon::file_transfer {
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::size_t priority_count = 3;
+
+struct queued_chunk {
+    pipeline_chunk chunk;
+    clock_type::time_point enqueued;
+};
+
+auto cost_of(const pipeline_chunk& chunk) -> uint64_t {
+    return std::max<uint64_t>(chunk.data.size(), 1);
+}
+
+}  // namespace
+
+void wait_histogram::record(std::chrono::microseconds wait) {
+    std::size_t bucket = 0;
+    while (bucket + 1 < bucket_count && wait > upper_bound(bucket)) {
+        ++bucket;
+    }
+    ++buckets[bucket];
+    ++count;
+    total += wait;
+    max = std::max(max, wait);
+}
+
+auto wait_histogram::percentile(double p) const -> std::chrono::microseconds {
+    if (count == 0) {
+        return std::chrono::microseconds{0};
+    }
+    // Nearest-rank percentile
+    auto rank = static_cast<uint64_t>(std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 *
+                                                static_cast<double>(count)));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucket_count; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return upper_bound(i);
+        }
+    }
+    return upper_bound(bucket_count - 1);
+}
+
+struct flow_scheduler::impl {
+    struct flow {
+        flow_key key;
+        flow_priority priority = flow_priority::normal;
+        std::deque<queued_chunk> queue;
+        uint64_t queued_bytes = 0;
+        uint64_t dispatched_chunks = 0;
+        uint64_t dispatched_bytes = 0;
+        wait_histogram wait;
+        bool active = false;  // Listed in its client's round
+    };
+
+    // A client's backlog within one priority class
+    struct client_round {
+        std::deque<flow*> flows;
+        uint64_t deficit = 0;
+        bool credited = false;  // Quantum already added for this visit
+    };
+
+    struct priority_class {
+        std::deque<uint64_t> active_clients;
+        std::unordered_map<uint64_t, client_round> rounds;
+    };
+
+    std::size_t quantum;
+    std::size_t queued = 0;
+    std::unordered_map<flow_key, flow> flows;
+    std::unordered_map<uint64_t, uint32_t> weights;
+    std::unordered_map<transfer_id, flow_priority> priorities;
+    std::array<priority_class, priority_count> classes;
+
+    explicit impl(std::size_t q) : quantum(std::max<std::size_t>(q, 1)) {}
+
+    auto weight_of(uint64_t client) const -> uint32_t {
+        auto it = weights.find(client);
+        return it == weights.end() ? 1 : it->second;
+    }
+
+    void activate(flow& f) {
+        auto& cls = classes[static_cast<std::size_t>(f.priority)];
+        auto& round = cls.rounds[f.key.client.value];
+        if (round.flows.empty()) {
+            cls.active_clients.push_back(f.key.client.value);
+        }
+        round.flows.push_back(&f);
+        f.active = true;
+    }
+
+    void deactivate(flow& f) {
+        auto& cls = classes[static_cast<std::size_t>(f.priority)];
+        auto round_it = cls.rounds.find(f.key.client.value);
+        if (round_it == cls.rounds.end()) {
+            return;
+        }
+        auto& round = round_it->second;
+        round.flows.erase(std::remove(round.flows.begin(), round.flows.end(), &f),
+                          round.flows.end());
+        if (round.flows.empty()) {
+            cls.active_clients.erase(
+                std::remove(cls.active_clients.begin(), cls.active_clients.end(),
+                            f.key.client.value),
+                cls.active_clients.end());
+            cls.rounds.erase(round_it);
+        }
+        f.active = false;
+    }
+
+    auto take_front(flow& f) -> pipeline_chunk {
+        auto item = std::move(f.queue.front());
+        f.queue.pop_front();
+        --queued;
+
+        auto bytes = item.chunk.data.size();
+        f.queued_bytes -= bytes;
+        f.dispatched_chunks++;
+        f.dispatched_bytes += bytes;
+        f.wait.record(std::chrono::duration_cast<std::chrono::microseconds>(
+            clock_type::now() - item.enqueued));
+        return std::move(item.chunk);
+    }
+
+    // Deficit round-robin over the clients of one class. The client at the
+    // front is credited once per visit and keeps being served until its
+    // deficit no longer covers its next chunk.
+    auto pop_from(priority_class& cls) -> std::optional<pipeline_chunk> {
+        while (!cls.active_clients.empty()) {
+            auto client = cls.active_clients.front();
+            auto& round = cls.rounds[client];
+            auto* f = round.flows.front();
+
+            if (!round.credited) {
+                round.deficit += static_cast<uint64_t>(quantum) * weight_of(client);
+                round.credited = true;
+            }
+
+            auto cost = cost_of(f->queue.front().chunk);
+            if (round.deficit < cost) {
+                round.credited = false;
+                cls.active_clients.pop_front();
+                cls.active_clients.push_back(client);
+                continue;
+            }
+
+            round.deficit -= cost;
+            auto chunk = take_front(*f);
+
+            // The client's transfers take turns
+            round.flows.pop_front();
+            if (f->queue.empty()) {
+                f->active = false;
+            } else {
+                round.flows.push_back(f);
+            }
+            if (round.flows.empty()) {
+                cls.active_clients.pop_front();
+                cls.rounds.erase(client);
+            }
+            return chunk;
+        }
+        return std::nullopt;
+    }
+};
+
+flow_scheduler::flow_scheduler(std::size_t quantum)
+    : impl_(std::make_unique<impl>(quantum)) {}
+
+flow_scheduler::flow_scheduler(flow_scheduler&&) noexcept = default;
+auto flow_scheduler::operator=(flow_scheduler&&) noexcept -> flow_scheduler& = default;
+flow_scheduler::~flow_scheduler() = default;
+
+void flow_scheduler::push(pipeline_chunk chunk) {
+    flow_key key{chunk.client, chunk.id};
+    auto [it, inserted] = impl_->flows.try_emplace(key);
+    auto& f = it->second;
+    if (inserted) {
+        f.key = key;
+        auto priority = impl_->priorities.find(chunk.id);
+        if (priority != impl_->priorities.end()) {
+            f.priority = priority->second;
+        }
+    }
+
+    f.queued_bytes += chunk.data.size();
+    f.queue.push_back({std::move(chunk), clock_type::now()});
+    ++impl_->queued;
+    if (!f.active) {
+        impl_->activate(f);
+    }
+}
+
+auto flow_scheduler::pop() -> std::optional<pipeline_chunk> {
+    for (auto& cls : impl_->classes) {
+        if (auto chunk = impl_->pop_from(cls)) {
+            return chunk;
+        }
+    }
+    return std::nullopt;
+}
+
+void flow_scheduler::set_client_weight(client_id client, uint32_t weight) {
+    impl_->weights[client.value] = std::max<uint32_t>(weight, 1);
+}
+
+void flow_scheduler::set_transfer_priority(const transfer_id& id, flow_priority priority) {
+    impl_->priorities[id] = priority;
+    for (auto& [key, f] : impl_->flows) {
+        if (key.transfer != id || f.priority == priority) {
+            continue;
+        }
+        bool was_active = f.active;
+        if (was_active) {
+            impl_->deactivate(f);
+        }
+        f.priority = priority;
+        if (was_active) {
+            impl_->activate(f);
+        }
+    }
+}
+
+auto flow_scheduler::remove_transfer(const transfer_id& id) -> std::vector<pipeline_chunk> {
+    std::vector<pipeline_chunk> dropped;
+    impl_->priorities.erase(id);
+    for (auto it = impl_->flows.begin(); it != impl_->flows.end();) {
+        if (it->first.transfer != id) {
+            ++it;
+            continue;
+        }
+        auto& f = it->second;
+        if (f.active) {
+            impl_->deactivate(f);
+        }
+        for (auto& item : f.queue) {
+            dropped.push_back(std::move(item.chunk));
+        }
+        impl_->queued -= f.queue.size();
+        it = impl_->flows.erase(it);
+    }
+    return dropped;
+}
+
+auto flow_scheduler::clear() -> std::vector<pipeline_chunk> {
+    std::vector<pipeline_chunk> dropped;
+    dropped.reserve(impl_->queued);
+    for (auto& [key, f] : impl_->flows) {
+        for (auto& item : f.queue) {
+            dropped.push_back(std::move(item.chunk));
+        }
+        f.queue.clear();
+        f.queued_bytes = 0;
+        f.active = false;
+    }
+    for (auto& cls : impl_->classes) {
+        cls.active_clients.clear();
+        cls.rounds.clear();
+    }
+    impl_->queued = 0;
+    return dropped;
+}
+
+auto flow_scheduler::size() const -> std::size_t {
+    return impl_->queued;
+}
+
+auto flow_scheduler::stats() const -> std::vector<flow_stats> {
+    std::vector<flow_stats> result;
+    result.reserve(impl_->flows.size());
+    for (const auto& [key, f] : impl_->flows) {
+        flow_stats s;
+        s.key = key;
+        s.priority = f.priority;
+        s.weight = impl_->weight_of(key.client.value);
+        s.queued_chunks = f.queue.size();
+        s.queued_bytes = f.queued_bytes;
+        s.dispatched_chunks = f.dispatched_chunks;
+        s.dispatched_bytes = f.dispatched_bytes;
+        s.wait = f.wait;
+        result.push_back(s);
+    }
+    return result;
+}
+
+}  // namespace kcenon::file_transfer
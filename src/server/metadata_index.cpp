@@ -0,0 +1,886 @@
+/**
+ * @file metadata_index.cpp
+ * @brief Persistent sharded metadata index implementation
+ */
+
+#include "kcenon/file_transfer/server/metadata_index.h"
+
+#include "kcenon/file_transfer/core/checksum.h"
+#include "kcenon/file_transfer/core/logging.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <shared_mutex>
+#include <span>
+#include <vector>
+
+namespace kcenon::file_transfer {
+
+namespace {
+
+constexpr const char* manifest_name = "MANIFEST";
+constexpr uint32_t manifest_magic = 0x4D4D5446;  // "FTMM"
+constexpr uint32_t shard_log_magic = 0x584D5446;  // "FTMX"
+constexpr uint32_t index_format_version = 1;
+
+// Directories owned by file_transfer components are never indexed
+constexpr std::string_view internal_prefix = ".file_trans_";
+
+// A shard log is compacted once it holds this many records and more than
+// twice as many records as live entries
+constexpr std::size_t compaction_min_records = 4096;
+
+enum class record_op : uint8_t {
+    put = 1,
+    erase = 2
+};
+
+enum record_flags : uint8_t {
+    has_content_hash = 1 << 0,
+    has_content_type = 1 << 1
+};
+
+auto append_bytes(std::string& out, const void* data, std::size_t size) -> void {
+    out.append(static_cast<const char*>(data), size);
+}
+
+template <typename T>
+auto append_pod(std::string& out, const T& value) -> void {
+    append_bytes(out, &value, sizeof(T));
+}
+
+auto append_string(std::string& out, const std::string& value) -> void {
+    append_pod(out, static_cast<uint32_t>(value.size()));
+    out.append(value);
+}
+
+/**
+ * @brief Bounds-checked reader over a record payload
+ */
+class payload_reader {
+public:
+    explicit payload_reader(std::string_view data) : data_(data) {}
+
+    template <typename T>
+    auto read(T& value) -> bool {
+        if (data_.size() - offset_ < sizeof(T)) return false;
+        std::copy_n(data_.data() + offset_, sizeof(T), reinterpret_cast<char*>(&value));
+        offset_ += sizeof(T);
+        return true;
+    }
+
+    auto read_string(std::string& value) -> bool {
+        uint32_t length = 0;
+        if (!read(length) || data_.size() - offset_ < length) return false;
+        value.assign(data_.data() + offset_, length);
+        offset_ += length;
+        return true;
+    }
+
+private:
+    std::string_view data_;
+    std::size_t offset_ = 0;
+};
+
+template <typename T>
+auto write_pod(std::ofstream& out, const T& value) -> void {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+auto read_pod(std::ifstream& in, T& value) -> bool {
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return in.good();
+}
+
+auto to_system_time(std::filesystem::file_time_type time)
+    -> std::chrono::system_clock::time_point {
+    return std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+        time - std::filesystem::file_time_type::clock::now() +
+        std::chrono::system_clock::now());
+}
+
+auto encode_put(const stored_object_metadata& metadata) -> std::string {
+    std::string payload;
+    payload.reserve(64 + metadata.key.size());
+    append_string(payload, metadata.key);
+    append_pod(payload, metadata.size);
+    append_pod(payload, static_cast<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            metadata.last_modified.time_since_epoch()).count()));
+    append_pod(payload, static_cast<uint8_t>(metadata.tier));
+    append_pod(payload, static_cast<uint8_t>(metadata.backend));
+
+    uint8_t flags = 0;
+    if (metadata.content_hash) flags |= has_content_hash;
+    if (metadata.content_type) flags |= has_content_type;
+    append_pod(payload, flags);
+    if (metadata.content_hash) append_string(payload, *metadata.content_hash);
+    if (metadata.content_type) append_string(payload, *metadata.content_type);
+
+    append_pod(payload, static_cast<uint32_t>(metadata.custom_metadata.size()));
+    for (const auto& [name, value] : metadata.custom_metadata) {
+        append_string(payload, name);
+        append_string(payload, value);
+    }
+    return payload;
+}
+
+auto decode_put(std::string_view payload, stored_object_metadata& metadata) -> bool {
+    payload_reader reader(payload);
+    int64_t modified_ns = 0;
+    uint8_t tier = 0;
+    uint8_t backend = 0;
+    uint8_t flags = 0;
+    if (!reader.read_string(metadata.key) || !reader.read(metadata.size) ||
+        !reader.read(modified_ns) || !reader.read(tier) || !reader.read(backend) ||
+        !reader.read(flags)) {
+        return false;
+    }
+    metadata.last_modified = std::chrono::system_clock::time_point{
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds{modified_ns})};
+    metadata.tier = static_cast<storage_tier>(tier);
+    metadata.backend = static_cast<storage_backend_type>(backend);
+
+    if (flags & has_content_hash) {
+        std::string value;
+        if (!reader.read_string(value)) return false;
+        metadata.content_hash = std::move(value);
+    }
+    if (flags & has_content_type) {
+        std::string value;
+        if (!reader.read_string(value)) return false;
+        metadata.content_type = std::move(value);
+    }
+
+    uint32_t custom_count = 0;
+    if (!reader.read(custom_count)) return false;
+    for (uint32_t i = 0; i < custom_count; ++i) {
+        std::string name;
+        std::string value;
+        if (!reader.read_string(name) || !reader.read_string(value)) return false;
+        metadata.custom_metadata.emplace_back(std::move(name), std::move(value));
+    }
+    return true;
+}
+
+auto encode_erase(const std::string& key) -> std::string {
+    std::string payload;
+    append_string(payload, key);
+    return payload;
+}
+
+auto frame_record(record_op op, const std::string& payload) -> std::string {
+    std::string record;
+    record.reserve(payload.size() + 9);
+    append_pod(record, static_cast<uint8_t>(op));
+    append_pod(record, static_cast<uint32_t>(payload.size()));
+    append_pod(record, checksum::crc32(std::as_bytes(std::span(payload))));
+    record.append(payload);
+    return record;
+}
+
+/// First path component of a key; shards are selected by it
+auto shard_component(std::string_view key) -> std::string_view {
+    return key.substr(0, key.find('/'));
+}
+
+auto is_internal(std::string_view relative_key) -> bool {
+    return shard_component(relative_key).starts_with(internal_prefix);
+}
+
+/// Smallest string greater than every string starting with prefix
+auto prefix_successor(std::string prefix) -> std::optional<std::string> {
+    while (!prefix.empty()) {
+        auto& last = reinterpret_cast<unsigned char&>(prefix.back());
+        if (last != 0xFF) {
+            ++last;
+            return prefix;
+        }
+        prefix.pop_back();
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Position of an object in the requested list order
+ */
+struct sort_position {
+    int64_t value = 0;
+    std::string_view key;
+};
+
+auto sort_value_of(const stored_object_metadata& metadata, storage_sort_field field)
+    -> int64_t {
+    switch (field) {
+        case storage_sort_field::size:
+            return static_cast<int64_t>(metadata.size);
+        case storage_sort_field::last_modified:
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                metadata.last_modified.time_since_epoch()).count();
+        case storage_sort_field::key:
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Strict ordering for list results honoring sort field and direction
+ */
+struct list_order {
+    storage_sort_field field = storage_sort_field::key;
+    bool descending = false;
+
+    [[nodiscard]] auto position(const stored_object_metadata& metadata) const
+        -> sort_position {
+        return {sort_value_of(metadata, field), metadata.key};
+    }
+
+    [[nodiscard]] auto before(const sort_position& a, const sort_position& b) const -> bool {
+        if (a.value != b.value) {
+            return descending ? a.value > b.value : a.value < b.value;
+        }
+        return descending ? a.key > b.key : a.key < b.key;
+    }
+
+    [[nodiscard]] auto operator()(const stored_object_metadata& a,
+                                  const stored_object_metadata& b) const -> bool {
+        return before(position(a), position(b));
+    }
+};
+
+/**
+ * @brief Decoded continuation token
+ *
+ * Key-ordered listings use the last key as token (as cloud listings do);
+ * other orders use "<sort value>:<key>" so pagination stays stable under
+ * ties.
+ */
+struct list_cursor {
+    int64_t value = 0;
+    std::string key;
+};
+
+auto encode_cursor(const stored_object_metadata& metadata, storage_sort_field field)
+    -> std::string {
+    if (field == storage_sort_field::key) {
+        return metadata.key;
+    }
+    return std::to_string(sort_value_of(metadata, field)) + ":" + metadata.key;
+}
+
+auto decode_cursor(const std::string& token, storage_sort_field field)
+    -> std::optional<list_cursor> {
+    if (field == storage_sort_field::key) {
+        return list_cursor{0, token};
+    }
+    auto separator = token.find(':');
+    if (separator == std::string::npos) {
+        return std::nullopt;
+    }
+    list_cursor cursor;
+    auto [ptr, ec] = std::from_chars(token.data(), token.data() + separator, cursor.value);
+    if (ec != std::errc{} || ptr != token.data() + separator) {
+        return std::nullopt;
+    }
+    cursor.key = token.substr(separator + 1);
+    return cursor;
+}
+
+}  // namespace
+
+struct metadata_index::impl {
+    using entry_map = std::map<std::string, stored_object_metadata, std::less<>>;
+
+    struct shard {
+        mutable std::shared_mutex mutex;
+        entry_map entries;
+        std::filesystem::path log_path;
+        std::ofstream log;
+        std::size_t log_records = 0;
+    };
+
+    std::filesystem::path index_dir;
+    std::vector<std::unique_ptr<shard>> shards;
+    std::atomic<bool> rebuild_required{false};
+    bool active = false;  // Set once open() succeeded
+
+    impl(std::filesystem::path dir, std::size_t shard_count)
+        : index_dir(std::move(dir)) {
+        shards.reserve(shard_count);
+        for (std::size_t i = 0; i < shard_count; ++i) {
+            auto s = std::make_unique<shard>();
+            s->log_path = index_dir / ("shard-" + std::to_string(i) + ".log");
+            shards.push_back(std::move(s));
+        }
+    }
+
+    ~impl() {
+        for (auto& s : shards) {
+            std::unique_lock lock(s->mutex);
+            if (s->log.is_open()) {
+                s->log.close();
+            }
+        }
+        if (active) {
+            (void)write_manifest(true);
+        }
+    }
+
+    impl(const impl&) = delete;
+    auto operator=(const impl&) -> impl& = delete;
+
+    [[nodiscard]] auto shard_for(std::string_view key) -> shard& {
+        auto hash = std::hash<std::string_view>{}(shard_component(key));
+        return *shards[hash % shards.size()];
+    }
+
+    [[nodiscard]] auto shard_for(std::string_view key) const -> const shard& {
+        auto hash = std::hash<std::string_view>{}(shard_component(key));
+        return *shards[hash % shards.size()];
+    }
+
+    [[nodiscard]] auto manifest_path() const -> std::filesystem::path {
+        return index_dir / manifest_name;
+    }
+
+    auto write_manifest(bool clean) -> result<void> {
+        auto path = manifest_path();
+        auto temp_path = path;
+        temp_path += ".tmp";
+        {
+            std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                return unexpected{error{error_code::file_write_error,
+                                       "Failed to open metadata index manifest"}};
+            }
+            write_pod(out, manifest_magic);
+            write_pod(out, index_format_version);
+            write_pod(out, static_cast<uint32_t>(shards.size()));
+            write_pod(out, static_cast<uint8_t>(clean ? 1 : 0));
+            if (!out.good()) {
+                return unexpected{error{error_code::file_write_error,
+                                       "Failed to write metadata index manifest"}};
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp_path, path, ec);
+        if (ec) {
+            std::filesystem::remove(temp_path, ec);
+            return unexpected{error{error_code::file_write_error,
+                                   "Failed to replace metadata index manifest"}};
+        }
+        return result<void>();
+    }
+
+    /**
+     * @brief Read the manifest
+     * @return true if the existing shard logs can be trusted
+     */
+    [[nodiscard]] auto read_manifest() -> bool {
+        std::ifstream in(manifest_path(), std::ios::binary);
+        if (!in) {
+            return false;
+        }
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint32_t shard_count = 0;
+        uint8_t clean = 0;
+        if (!read_pod(in, magic) || magic != manifest_magic ||
+            !read_pod(in, version) || version != index_format_version ||
+            !read_pod(in, shard_count) || shard_count != shards.size() ||
+            !read_pod(in, clean)) {
+            return false;
+        }
+        if (clean == 0) {
+            // Logs are still replayed, but writes that happened between a file
+            // change and its log append may be missing
+            FT_LOG_WARN(log_category::server,
+                "Metadata index was not closed cleanly, rebuild required");
+            rebuild_required.store(true);
+        }
+        return true;
+    }
+
+    // Caller must hold the shard lock exclusively (or own the shard exclusively)
+    auto open_log(shard& s) -> result<void> {
+        std::error_code ec;
+        bool is_new = !std::filesystem::exists(s.log_path, ec) ||
+                      std::filesystem::file_size(s.log_path, ec) == 0;
+        s.log.open(s.log_path, std::ios::binary | std::ios::app);
+        if (!s.log) {
+            return unexpected{error{error_code::file_write_error,
+                                   "Failed to open metadata index log: " +
+                                       s.log_path.string()}};
+        }
+        if (is_new) {
+            write_pod(s.log, shard_log_magic);
+            write_pod(s.log, index_format_version);
+            s.log.flush();
+        }
+        return result<void>();
+    }
+
+    // Caller must own the shard exclusively
+    auto replay_log(shard& s) -> void {
+        std::ifstream in(s.log_path, std::ios::binary);
+        if (!in) {
+            return;
+        }
+
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        if (!read_pod(in, magic) || magic != shard_log_magic ||
+            !read_pod(in, version) || version != index_format_version) {
+            in.close();
+            std::error_code ec;
+            std::filesystem::remove(s.log_path, ec);
+            rebuild_required.store(true);
+            return;
+        }
+
+        std::streamoff good_offset = in.tellg();
+        std::string payload;
+        while (true) {
+            uint8_t op = 0;
+            uint32_t length = 0;
+            uint32_t crc = 0;
+            if (!read_pod(in, op) || !read_pod(in, length) || !read_pod(in, crc)) {
+                break;
+            }
+            payload.resize(length);
+            in.read(payload.data(), static_cast<std::streamsize>(length));
+            if (!in.good() ||
+                checksum::crc32(std::as_bytes(std::span(payload))) != crc) {
+                break;
+            }
+
+            if (static_cast<record_op>(op) == record_op::put) {
+                stored_object_metadata metadata;
+                if (!decode_put(payload, metadata)) break;
+                auto key = metadata.key;
+                s.entries.insert_or_assign(std::move(key), std::move(metadata));
+            } else if (static_cast<record_op>(op) == record_op::erase) {
+                std::string key;
+                payload_reader reader(payload);
+                if (!reader.read_string(key)) break;
+                s.entries.erase(key);
+            } else {
+                break;
+            }
+            ++s.log_records;
+            good_offset = in.tellg();
+        }
+
+        // Drop a torn tail left by a crash mid-append
+        in.close();
+        std::error_code ec;
+        auto file_size = std::filesystem::file_size(s.log_path, ec);
+        if (!ec && static_cast<std::uintmax_t>(good_offset) < file_size) {
+            FT_LOG_WARN(log_category::server,
+                "Truncating corrupt tail of metadata index log: " + s.log_path.string());
+            std::filesystem::resize_file(s.log_path,
+                static_cast<std::uintmax_t>(good_offset), ec);
+            rebuild_required.store(true);
+        }
+    }
+
+    // Caller must hold the shard lock exclusively
+    auto append(shard& s, record_op op, const std::string& payload) -> result<void> {
+        if (!s.log.is_open()) {
+            auto opened = open_log(s);
+            if (!opened.has_value()) return opened;
+        }
+        auto record = frame_record(op, payload);
+        s.log.write(record.data(), static_cast<std::streamsize>(record.size()));
+        s.log.flush();
+        if (!s.log.good()) {
+            s.log.clear();
+            rebuild_required.store(true);
+            return unexpected{error{error_code::file_write_error,
+                                   "Failed to append to metadata index log"}};
+        }
+        ++s.log_records;
+
+        if (s.log_records >= compaction_min_records &&
+            s.log_records > 2 * s.entries.size()) {
+            return compact_shard(s);
+        }
+        return result<void>();
+    }
+
+    // Caller must hold the shard lock exclusively
+    auto compact_shard(shard& s) -> result<void> {
+        auto temp_path = s.log_path;
+        temp_path += ".tmp";
+        {
+            std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                return unexpected{error{error_code::file_write_error,
+                                       "Failed to open metadata index log for compaction"}};
+            }
+            write_pod(out, shard_log_magic);
+            write_pod(out, index_format_version);
+            for (const auto& [_, metadata] : s.entries) {
+                auto record = frame_record(record_op::put, encode_put(metadata));
+                out.write(record.data(), static_cast<std::streamsize>(record.size()));
+            }
+            if (!out.good()) {
+                return unexpected{error{error_code::file_write_error,
+                                       "Failed to write compacted metadata index log"}};
+            }
+        }
+
+        if (s.log.is_open()) {
+            s.log.close();
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp_path, s.log_path, ec);
+        if (ec) {
+            std::filesystem::remove(temp_path, ec);
+            (void)open_log(s);
+            return unexpected{error{error_code::file_write_error,
+                                   "Failed to replace metadata index log"}};
+        }
+        s.log_records = s.entries.size();
+        return open_log(s);
+    }
+
+    /**
+     * @brief Collect up to limit entries of one shard that follow the cursor
+     */
+    auto collect(const shard& s,
+                 const list_storage_options& options,
+                 const list_order& order,
+                 const std::optional<list_cursor>& cursor,
+                 std::size_t limit,
+                 std::vector<stored_object_metadata>& out) const -> void {
+        std::string_view prefix = options.prefix ? std::string_view(*options.prefix)
+                                                 : std::string_view{};
+        auto matches = [&](const stored_object_metadata& metadata) {
+            if (options.tier_filter && metadata.tier != *options.tier_filter) {
+                return false;
+            }
+            if (options.backend_filter && metadata.backend != *options.backend_filter) {
+                return false;
+            }
+            return true;
+        };
+
+        std::shared_lock lock(s.mutex);
+        const auto& entries = s.entries;
+        auto range_begin = entries.lower_bound(prefix);
+        auto successor = prefix_successor(std::string(prefix));
+        auto range_end = successor ? entries.lower_bound(*successor) : entries.end();
+
+        if (order.field == storage_sort_field::key) {
+            // Key order follows the map order, so walk only as far as needed
+            auto quota = out.size() + limit;
+            if (!order.descending) {
+                auto it = range_begin;
+                if (cursor) {
+                    auto after = entries.upper_bound(cursor->key);
+                    if (it != entries.end() &&
+                        (after == entries.end() || it->first < after->first)) {
+                        it = after;
+                    }
+                }
+                for (; it != entries.end() && out.size() < quota; ++it) {
+                    if (!it->first.starts_with(prefix)) break;
+                    if (matches(it->second)) out.push_back(it->second);
+                }
+            } else {
+                auto it = range_end;
+                if (cursor) {
+                    auto below = entries.lower_bound(cursor->key);
+                    if (below != entries.end() &&
+                        (it == entries.end() || below->first < it->first)) {
+                        it = below;
+                    }
+                }
+                while (it != range_begin && out.size() < quota) {
+                    --it;
+                    if (!it->first.starts_with(prefix)) break;
+                    if (matches(it->second)) out.push_back(it->second);
+                }
+            }
+            return;
+        }
+
+        // Other orders need the whole prefix range; keep the first `limit`
+        // entries in a bounded heap whose top is the last one in list order
+        auto heap_order = [&order](const stored_object_metadata* a,
+                                   const stored_object_metadata* b) {
+            return order(*a, *b);
+        };
+        std::priority_queue<const stored_object_metadata*,
+                            std::vector<const stored_object_metadata*>,
+                            decltype(heap_order)> best(heap_order);
+        std::optional<sort_position> after;
+        if (cursor) {
+            after = sort_position{cursor->value, cursor->key};
+        }
+
+        for (auto it = range_begin; it != range_end; ++it) {
+            const auto& metadata = it->second;
+            if (!matches(metadata)) continue;
+            if (after && !order.before(*after, order.position(metadata))) continue;
+            if (best.size() < limit) {
+                best.push(&metadata);
+            } else if (limit > 0 && order(metadata, *best.top())) {
+                best.pop();
+                best.push(&metadata);
+            }
+        }
+
+        auto first = out.size();
+        while (!best.empty()) {
+            out.push_back(*best.top());
+            best.pop();
+        }
+        std::reverse(out.begin() + static_cast<std::ptrdiff_t>(first), out.end());
+    }
+};
+
+metadata_index::metadata_index(const std::filesystem::path& index_dir,
+                               std::size_t shard_count)
+    : impl_(std::make_unique<impl>(index_dir, shard_count)) {}
+
+metadata_index::metadata_index(metadata_index&&) noexcept = default;
+auto metadata_index::operator=(metadata_index&&) noexcept -> metadata_index& = default;
+metadata_index::~metadata_index() = default;
+
+auto metadata_index::open(const std::filesystem::path& index_dir,
+                          std::size_t shard_count) -> result<metadata_index> {
+    if (shard_count == 0) {
+        return unexpected{error{error_code::invalid_configuration,
+                               "Metadata index shard count must be positive"}};
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(index_dir, ec);
+    if (ec) {
+        return unexpected{error{error_code::file_write_error,
+                               "Failed to create metadata index directory: " +
+                                   index_dir.string()}};
+    }
+
+    metadata_index index(index_dir, shard_count);
+    auto& state = *index.impl_;
+
+    if (state.read_manifest()) {
+        for (auto& s : state.shards) {
+            state.replay_log(*s);
+        }
+    } else {
+        // Missing or incompatible layout: start empty and let the owner rebuild
+        std::vector<std::filesystem::path> stale;
+        for (const auto& entry : std::filesystem::directory_iterator(index_dir, ec)) {
+            if (entry.path().filename() != manifest_name) {
+                stale.push_back(entry.path());
+            }
+        }
+        for (const auto& path : stale) {
+            std::filesystem::remove_all(path, ec);
+        }
+        state.rebuild_required.store(true);
+    }
+
+    for (auto& s : state.shards) {
+        auto opened = state.open_log(*s);
+        if (!opened.has_value()) {
+            return unexpected{opened.error()};
+        }
+    }
+
+    // Stays dirty until the index is closed
+    auto manifest = state.write_manifest(false);
+    if (!manifest.has_value()) {
+        return unexpected{manifest.error()};
+    }
+    state.active = true;
+
+    return result<metadata_index>(std::move(index));
+}
+
+auto metadata_index::put(const stored_object_metadata& metadata) -> result<void> {
+    auto& s = impl_->shard_for(metadata.key);
+    std::unique_lock lock(s.mutex);
+    s.entries.insert_or_assign(metadata.key, metadata);
+    return impl_->append(s, record_op::put, encode_put(metadata));
+}
+
+auto metadata_index::erase(const std::string& key) -> result<void> {
+    auto& s = impl_->shard_for(key);
+    std::unique_lock lock(s.mutex);
+    if (s.entries.erase(key) == 0) {
+        return result<void>();
+    }
+    return impl_->append(s, record_op::erase, encode_erase(key));
+}
+
+auto metadata_index::find(const std::string& key) const
+    -> std::optional<stored_object_metadata> {
+    const auto& s = impl_->shard_for(key);
+    std::shared_lock lock(s.mutex);
+    auto it = s.entries.find(key);
+    if (it == s.entries.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+auto metadata_index::query(const list_storage_options& options) const
+    -> list_storage_result {
+    list_storage_result res;
+    list_order order{options.sort_by, options.descending};
+
+    std::optional<list_cursor> cursor;
+    if (options.continuation_token && !options.continuation_token->empty()) {
+        cursor = decode_cursor(*options.continuation_token, options.sort_by);
+    }
+
+    // One extra entry tells whether the listing is truncated
+    auto limit = options.max_results + 1;
+    std::vector<stored_object_metadata> candidates;
+
+    if (options.prefix && options.prefix->find('/') != std::string::npos) {
+        impl_->collect(impl_->shard_for(*options.prefix), options, order, cursor,
+                       limit, candidates);
+    } else {
+        for (const auto& s : impl_->shards) {
+            impl_->collect(*s, options, order, cursor, limit, candidates);
+        }
+    }
+
+    if (candidates.size() > limit) {
+        std::partial_sort(candidates.begin(),
+                          candidates.begin() + static_cast<std::ptrdiff_t>(limit),
+                          candidates.end(), order);
+        candidates.resize(limit);
+    } else {
+        std::sort(candidates.begin(), candidates.end(), order);
+    }
+
+    if (candidates.size() > options.max_results) {
+        candidates.resize(options.max_results);
+        res.is_truncated = true;
+        if (!candidates.empty()) {
+            res.continuation_token = encode_cursor(candidates.back(), options.sort_by);
+        }
+    }
+
+    res.objects = std::move(candidates);
+    return res;
+}
+
+auto metadata_index::rebuild(const std::filesystem::path& root) -> result<std::size_t> {
+    std::error_code ec;
+    if (!std::filesystem::is_directory(root, ec)) {
+        return unexpected{error{error_code::invalid_file_path,
+                               "Not a directory: " + root.string()}};
+    }
+
+    std::vector<impl::entry_map> rebuilt(impl_->shards.size());
+    std::size_t indexed = 0;
+
+    auto it = std::filesystem::recursive_directory_iterator(root, ec);
+    for (; !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        const auto& entry = *it;
+        auto relative_path = std::filesystem::relative(entry.path(), root, ec);
+        if (ec) {
+            ec.clear();
+            continue;
+        }
+        auto key = relative_path.generic_string();
+
+        if (is_internal(key)) {
+            if (it.depth() == 0 && entry.is_directory(ec)) {
+                it.disable_recursion_pending();
+            }
+            continue;
+        }
+        if (!entry.is_regular_file(ec) || ec) {
+            ec.clear();
+            continue;
+        }
+
+        stored_object_metadata metadata;
+        // Keep attributes that are not recoverable from the filesystem
+        if (auto previous = find(key)) {
+            metadata = std::move(*previous);
+        }
+        metadata.key = key;
+        metadata.backend = storage_backend_type::local;
+        metadata.size = entry.file_size(ec);
+        if (ec) {
+            ec.clear();
+            continue;
+        }
+        auto last_write = entry.last_write_time(ec);
+        if (!ec) {
+            metadata.last_modified = to_system_time(last_write);
+        }
+        ec.clear();
+
+        auto hash = std::hash<std::string_view>{}(shard_component(key));
+        rebuilt[hash % rebuilt.size()].insert_or_assign(key, std::move(metadata));
+        ++indexed;
+    }
+    if (ec) {
+        return unexpected{error{error_code::file_read_error,
+                               "Failed to scan storage directory: " + ec.message()}};
+    }
+
+    for (std::size_t i = 0; i < impl_->shards.size(); ++i) {
+        auto& s = *impl_->shards[i];
+        std::unique_lock lock(s.mutex);
+        s.entries = std::move(rebuilt[i]);
+        auto compacted = impl_->compact_shard(s);
+        if (!compacted.has_value()) {
+            return unexpected{compacted.error()};
+        }
+    }
+
+    impl_->rebuild_required.store(false);
+    FT_LOG_INFO(log_category::server,
+        "Rebuilt metadata index: " + std::to_string(indexed) + " files");
+    return result<std::size_t>(indexed);
+}
+
+auto metadata_index::compact() -> result<void> {
+    for (auto& s : impl_->shards) {
+        std::unique_lock lock(s->mutex);
+        auto compacted = impl_->compact_shard(*s);
+        if (!compacted.has_value()) {
+            return compacted;
+        }
+    }
+    return result<void>();
+}
+
+auto metadata_index::needs_rebuild() const -> bool {
+    return impl_->rebuild_required.load();
+}
+
+auto metadata_index::size() const -> std::size_t {
+    std::size_t total = 0;
+    for (const auto& s : impl_->shards) {
+        std::shared_lock lock(s->mutex);
+        total += s->entries.size();
+    }
+    return total;
+}
+
+auto metadata_index::shard_count() const -> std::size_t {
+    return impl_->shards.size();
+}
+
+}  // namespace kcenon::file_transfer
@@ -0,0 +1,585 @@
+/**
+ * @file object_cache.cpp
+ * @brief Disk-backed LRU read cache implementation
+ */
+
+#include "kcenon/file_transfer/server/object_cache.h"
+
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace kcenon::file_transfer {
+
+namespace {
+
+constexpr uint32_t entry_magic = 0x434F5446;  // "FTOC"
+constexpr uint32_t entry_format_version = 1;
+
+constexpr std::string_view data_extension = ".dat";
+constexpr std::string_view meta_extension = ".meta";
+constexpr std::string_view part_extension = ".part";
+constexpr std::string_view temp_extension = ".tmp";
+
+template <typename T>
+auto write_pod(std::ofstream& out, const T& value) -> void {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+auto read_pod(std::ifstream& in, T& value) -> bool {
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return in.good();
+}
+
+auto write_string(std::ofstream& out, std::string_view value) -> void {
+    write_pod(out, static_cast<uint32_t>(value.size()));
+    out.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+auto read_string(std::ifstream& in, std::string& value) -> bool {
+    uint32_t length = 0;
+    if (!read_pod(in, length) || length > 64 * 1024) return false;
+    value.resize(length);
+    in.read(value.data(), length);
+    return in.good();
+}
+
+/**
+ * @brief Parse "<generation><extension>"; files not named this way are not ours
+ */
+auto parse_generation(const std::string& filename, std::string_view extension)
+    -> std::optional<uint64_t> {
+    if (filename.size() <= extension.size() ||
+        !std::string_view(filename).ends_with(extension)) {
+        return std::nullopt;
+    }
+    auto digits = std::string_view(filename).substr(0, filename.size() - extension.size());
+    uint64_t generation = 0;
+    auto [ptr, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), generation);
+    if (ec != std::errc{} || ptr != digits.data() + digits.size()) {
+        return std::nullopt;
+    }
+    return generation;
+}
+
+}  // namespace
+
+struct object_cache::entry {
+    std::string key;
+    std::string version;
+    uint64_t size = 0;
+    uint64_t generation = 0;
+    std::filesystem::path data_path;
+    std::filesystem::path meta_path;
+
+    // Guarded by impl::mutex
+    std::size_t pins = 0;
+    bool doomed = false;  // Out of the index; files go with the last pin
+    std::list<std::shared_ptr<entry>>::iterator lru_position;
+};
+
+struct object_cache::impl {
+    struct fill_state {
+        std::string version;
+        bool done = false;
+        std::optional<error> failure;
+    };
+
+    object_cache_config config;
+
+    mutable std::mutex mutex;
+    std::condition_variable fill_done;
+
+    // Most recently used first
+    std::list<std::shared_ptr<entry>> lru;
+    std::unordered_map<std::string, std::shared_ptr<entry>> index;
+    std::unordered_map<std::string, std::shared_ptr<fill_state>> fills;
+
+    object_cache_statistics stats;
+    uint64_t current_bytes = 0;
+    uint64_t next_generation = 1;
+
+    explicit impl(const object_cache_config& cfg) : config(cfg) {}
+
+    [[nodiscard]] auto path_for(uint64_t generation, std::string_view extension) const
+        -> std::filesystem::path {
+        auto name = std::to_string(generation);
+        name += extension;
+        return config.directory / name;
+    }
+
+    static auto remove_files(const entry& e) -> void {
+        std::error_code ec;
+        std::filesystem::remove(e.meta_path, ec);
+        std::filesystem::remove(e.data_path, ec);
+    }
+
+    static auto remove_files(const std::vector<std::shared_ptr<entry>>& entries) -> void {
+        for (const auto& e : entries) {
+            remove_files(*e);
+        }
+    }
+
+    // Caller must hold mutex; unpinned entries are appended to removed.
+    // Takes e by value: the index and LRU references are released here.
+    auto detach_locked(std::shared_ptr<entry> e,
+                       std::vector<std::shared_ptr<entry>>& removed) -> void {
+        index.erase(e->key);
+        lru.erase(e->lru_position);
+        current_bytes -= e->size;
+        if (e->pins == 0) {
+            removed.push_back(std::move(e));
+        } else {
+            e->doomed = true;
+        }
+    }
+
+    // Caller must hold mutex
+    auto insert_locked(const std::shared_ptr<entry>& e) -> void {
+        lru.push_front(e);
+        e->lru_position = lru.begin();
+        index[e->key] = e;
+        current_bytes += e->size;
+    }
+
+    // Caller must hold mutex; evicts least recently used unpinned entries
+    auto evict_locked(std::vector<std::shared_ptr<entry>>& removed) -> void {
+        auto it = lru.end();
+        while (current_bytes > config.max_bytes && it != lru.begin()) {
+            --it;
+            if ((*it)->pins > 0) {
+                continue;
+            }
+            auto victim = *it;
+            it = std::next(it);
+            ++stats.evictions;
+            stats.bytes_evicted += victim->size;
+            detach_locked(victim, removed);
+        }
+    }
+
+    auto write_meta(const entry& e) const -> result<void> {
+        auto temp_path = e.meta_path;
+        temp_path += temp_extension;
+        {
+            std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                return unexpected{error{error_code::file_write_error,
+                                       "Failed to open cache entry record"}};
+            }
+            write_pod(out, entry_magic);
+            write_pod(out, entry_format_version);
+            write_pod(out, e.size);
+            write_string(out, e.key);
+            write_string(out, e.version);
+            if (!out.good()) {
+                return unexpected{error{error_code::file_write_error,
+                                       "Failed to write cache entry record"}};
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp_path, e.meta_path, ec);
+        if (ec) {
+            std::filesystem::remove(temp_path, ec);
+            return unexpected{error{error_code::file_write_error,
+                                   "Failed to commit cache entry record"}};
+        }
+        return result<void>();
+    }
+
+    [[nodiscard]] auto read_meta(const std::filesystem::path& path, entry& e) const -> bool {
+        std::ifstream in(path, std::ios::binary);
+        uint32_t magic = 0;
+        uint32_t format = 0;
+        return in && read_pod(in, magic) && magic == entry_magic &&
+               read_pod(in, format) && format == entry_format_version &&
+               read_pod(in, e.size) && read_string(in, e.key) && read_string(in, e.version);
+    }
+
+    /**
+     * @brief Fetch an object into a new generation's data file
+     *
+     * Runs without the lock. Objects that fit the cache also get their
+     * record written, so a restart finds them.
+     */
+    auto fill(const std::string& key, std::string_view version, uint64_t generation,
+              const fetch_function& fetch) -> result<std::shared_ptr<entry>> {
+        auto part_path = path_for(generation, part_extension);
+        std::error_code ec;
+
+        result<void> fetched = result<void>();
+        try {
+            fetched = fetch(part_path);
+        } catch (const std::exception& e) {
+            fetched = unexpected{error{error_code::internal_error,
+                                      std::string("Cache fill failed: ") + e.what()}};
+        }
+        if (!fetched.has_value()) {
+            std::filesystem::remove(part_path, ec);
+            return unexpected{fetched.error()};
+        }
+
+        auto size = std::filesystem::file_size(part_path, ec);
+        if (ec) {
+            std::filesystem::remove(part_path, ec);
+            return unexpected{error{error_code::file_read_error,
+                                   "Cache fill produced no data for " + key}};
+        }
+
+        auto e = std::make_shared<entry>();
+        e->key = key;
+        e->version = std::string(version);
+        e->size = size;
+        e->generation = generation;
+        e->data_path = path_for(generation, data_extension);
+        e->meta_path = path_for(generation, meta_extension);
+
+        std::filesystem::rename(part_path, e->data_path, ec);
+        if (ec) {
+            std::filesystem::remove(part_path, ec);
+            return unexpected{error{error_code::file_write_error,
+                                   "Failed to commit cache entry for " + key}};
+        }
+
+        if (size <= config.max_bytes) {
+            auto recorded = write_meta(*e);
+            if (!recorded.has_value()) {
+                remove_files(*e);
+                return unexpected{recorded.error()};
+            }
+        }
+        return e;
+    }
+
+    auto unpin(const std::shared_ptr<entry>& e) -> void {
+        std::vector<std::shared_ptr<entry>> removed;
+        {
+            std::lock_guard lock(mutex);
+            if (--e->pins == 0 && e->doomed) {
+                removed.push_back(e);
+            }
+            evict_locked(removed);
+        }
+        remove_files(removed);
+    }
+
+    /**
+     * @brief Rebuild the index from the records in the cache directory
+     */
+    auto restore() -> void {
+        struct found_entry {
+            std::shared_ptr<entry> e;
+            std::filesystem::file_time_type last_used;
+        };
+
+        std::error_code ec;
+        std::vector<std::filesystem::path> garbage;
+        std::vector<uint64_t> data_generations;
+        std::unordered_map<std::string, found_entry> latest;
+
+        for (const auto& dirent : std::filesystem::directory_iterator(config.directory, ec)) {
+            if (!dirent.is_regular_file(ec)) {
+                continue;
+            }
+            auto name = dirent.path().filename().string();
+
+            if (parse_generation(name, part_extension) ||
+                (std::string_view(name).ends_with(temp_extension) &&
+                 parse_generation(name.substr(0, name.size() - temp_extension.size()),
+                                  meta_extension))) {
+                garbage.push_back(dirent.path());
+                continue;
+            }
+            if (auto generation = parse_generation(name, data_extension)) {
+                data_generations.push_back(*generation);
+                next_generation = std::max(next_generation, *generation + 1);
+                continue;
+            }
+            auto generation = parse_generation(name, meta_extension);
+            if (!generation) {
+                continue;
+            }
+            next_generation = std::max(next_generation, *generation + 1);
+
+            auto e = std::make_shared<entry>();
+            e->generation = *generation;
+            e->meta_path = dirent.path();
+            e->data_path = path_for(*generation, data_extension);
+
+            std::error_code size_ec;
+            auto data_size = std::filesystem::file_size(e->data_path, size_ec);
+            if (!read_meta(e->meta_path, *e) || size_ec || data_size != e->size ||
+                e->size > config.max_bytes) {
+                garbage.push_back(e->meta_path);
+                garbage.push_back(e->data_path);
+                continue;
+            }
+
+            auto last_used = std::filesystem::last_write_time(e->data_path, size_ec);
+            auto [it, inserted] = latest.try_emplace(e->key, found_entry{e, last_used});
+            if (!inserted) {
+                // A crash between replacing and removing an entry; keep the newest
+                auto& older = it->second.e->generation < e->generation ? it->second.e : e;
+                garbage.push_back(older->meta_path);
+                garbage.push_back(older->data_path);
+                if (older != e) {
+                    it->second = found_entry{e, last_used};
+                }
+            }
+        }
+
+        std::vector<found_entry> restored;
+        restored.reserve(latest.size());
+        for (auto& [key, found] : latest) {
+            restored.push_back(std::move(found));
+        }
+
+        // Data files without a surviving record
+        std::unordered_set<uint64_t> referenced;
+        referenced.reserve(restored.size());
+        for (const auto& found : restored) {
+            referenced.insert(found.e->generation);
+        }
+        for (auto generation : data_generations) {
+            if (!referenced.contains(generation)) {
+                garbage.push_back(path_for(generation, data_extension));
+            }
+        }
+
+        for (const auto& path : garbage) {
+            std::filesystem::remove(path, ec);
+        }
+
+        // Oldest first so the most recently used entry ends up at the front
+        std::sort(restored.begin(), restored.end(),
+                  [](const found_entry& a, const found_entry& b) {
+                      return a.last_used < b.last_used;
+                  });
+
+        std::vector<std::shared_ptr<entry>> removed;
+        for (auto& found : restored) {
+            insert_locked(found.e);
+        }
+        evict_locked(removed);
+        remove_files(removed);
+    }
+};
+
+// ============================================================================
+// object_cache::handle
+// ============================================================================
+
+object_cache::handle::handle(impl* owner, std::shared_ptr<entry> pinned, bool hit)
+    : owner_(owner), entry_(std::move(pinned)), hit_(hit) {}
+
+object_cache::handle::~handle() {
+    release();
+}
+
+object_cache::handle::handle(handle&& other) noexcept
+    : owner_(std::exchange(other.owner_, nullptr))
+    , entry_(std::move(other.entry_))
+    , hit_(other.hit_) {}
+
+auto object_cache::handle::operator=(handle&& other) noexcept -> handle& {
+    if (this != &other) {
+        release();
+        owner_ = std::exchange(other.owner_, nullptr);
+        entry_ = std::move(other.entry_);
+        hit_ = other.hit_;
+    }
+    return *this;
+}
+
+auto object_cache::handle::path() const -> const std::filesystem::path& {
+    return entry_->data_path;
+}
+
+auto object_cache::handle::size() const -> uint64_t {
+    return entry_ ? entry_->size : 0;
+}
+
+auto object_cache::handle::release() -> void {
+    if (owner_) {
+        std::exchange(owner_, nullptr)->unpin(entry_);
+        entry_.reset();
+    }
+}
+
+// ============================================================================
+// object_cache
+// ============================================================================
+
+object_cache::object_cache(const object_cache_config& config)
+    : impl_(std::make_unique<impl>(config)) {}
+
+object_cache::object_cache(object_cache&&) noexcept = default;
+auto object_cache::operator=(object_cache&&) noexcept -> object_cache& = default;
+object_cache::~object_cache() = default;
+
+auto object_cache::open(const object_cache_config& config) -> result<object_cache> {
+    if (config.directory.empty()) {
+        return unexpected{error{error_code::invalid_configuration,
+                               "Object cache directory is required"}};
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(config.directory, ec);
+    if (ec) {
+        return unexpected{error{error_code::file_write_error,
+                               "Failed to create object cache directory: " +
+                                   config.directory.string()}};
+    }
+
+    object_cache cache(config);
+    cache.impl_->restore();
+    return result<object_cache>(std::move(cache));
+}
+
+auto object_cache::acquire(
+    const std::string& key,
+    std::string_view version,
+    const fetch_function& fetch) -> result<handle> {
+
+    auto& state = *impl_;
+    std::vector<std::shared_ptr<entry>> removed;
+    std::unique_lock lock(state.mutex);
+
+    while (true) {
+        if (auto it = state.index.find(key); it != state.index.end()) {
+            auto e = it->second;
+            if (e->version == version) {
+                ++state.stats.hits;
+                ++e->pins;
+                state.lru.splice(state.lru.begin(), state.lru, e->lru_position);
+                lock.unlock();
+
+                // Persist recency so a restart restores the LRU order
+                std::error_code ec;
+                std::filesystem::last_write_time(
+                    e->data_path, std::filesystem::file_time_type::clock::now(), ec);
+                return handle(&state, std::move(e), true);
+            }
+            ++state.stats.stale;
+            state.detach_locked(e, removed);
+        }
+
+        auto in_flight = state.fills.find(key);
+        if (in_flight == state.fills.end()) {
+            break;
+        }
+
+        // Another caller is fetching this key; wait for it and look again
+        auto pending = in_flight->second;
+        bool same_version = pending->version == version;
+        if (same_version) {
+            ++state.stats.coalesced;
+        }
+        state.fill_done.wait(lock, [&pending] { return pending->done; });
+        if (same_version && pending->failure) {
+            return unexpected{*pending->failure};
+        }
+    }
+
+    ++state.stats.misses;
+    auto pending = std::make_shared<impl::fill_state>();
+    pending->version = std::string(version);
+    state.fills[key] = pending;
+    auto generation = state.next_generation++;
+    lock.unlock();
+
+    impl::remove_files(removed);
+    removed.clear();
+
+    auto filled = state.fill(key, version, generation, fetch);
+
+    lock.lock();
+    state.fills.erase(key);
+    pending->done = true;
+
+    if (!filled.has_value()) {
+        ++state.stats.fill_errors;
+        pending->failure = filled.error();
+        lock.unlock();
+        state.fill_done.notify_all();
+        return unexpected{filled.error()};
+    }
+
+    auto e = std::move(filled.value());
+    e->pins = 1;
+    if (e->size > state.config.max_bytes) {
+        // Too large to keep; served once and removed on release
+        e->doomed = true;
+    } else {
+        if (auto it = state.index.find(key); it != state.index.end()) {
+            state.detach_locked(it->second, removed);
+        }
+        state.insert_locked(e);
+        state.evict_locked(removed);
+    }
+    lock.unlock();
+    state.fill_done.notify_all();
+
+    impl::remove_files(removed);
+    return handle(&state, std::move(e), false);
+}
+
+auto object_cache::invalidate(const std::string& key) -> void {
+    std::vector<std::shared_ptr<entry>> removed;
+    {
+        std::lock_guard lock(impl_->mutex);
+        if (auto it = impl_->index.find(key); it != impl_->index.end()) {
+            impl_->detach_locked(it->second, removed);
+        }
+    }
+    impl::remove_files(removed);
+}
+
+auto object_cache::clear() -> void {
+    std::vector<std::shared_ptr<entry>> removed;
+    {
+        std::lock_guard lock(impl_->mutex);
+        while (!impl_->lru.empty()) {
+            impl_->detach_locked(impl_->lru.front(), removed);
+        }
+    }
+    impl::remove_files(removed);
+}
+
+auto object_cache::contains(const std::string& key, std::string_view version) const -> bool {
+    std::lock_guard lock(impl_->mutex);
+    auto it = impl_->index.find(key);
+    return it != impl_->index.end() && it->second->version == version;
+}
+
+auto object_cache::statistics() const -> object_cache_statistics {
+    std::lock_guard lock(impl_->mutex);
+    auto stats = impl_->stats;
+    stats.entry_count = impl_->index.size();
+    stats.current_bytes = impl_->current_bytes;
+    return stats;
+}
+
+auto object_cache::reset_statistics() -> void {
+    std::lock_guard lock(impl_->mutex);
+    impl_->stats = object_cache_statistics{};
+}
+
+auto object_cache::capacity() const -> uint64_t {
+    return impl_->config.max_bytes;
+}
+
+auto object_cache::directory() const -> const std::filesystem::path& {
+    return impl_->config.directory;
+}
+
+}  // namespace kcenon::file_transfer
@@ -5,9 +5,11 @@
 
 #include "kcenon/file_transfer/server/pipeline_jobs.h"
 
-#include "kcenon/file_transfer/core/bandwidth_limiter.h"
+#include "kcenon/file_transfer/core/bandwidth_shaper.h"
 #include "kcenon/file_transfer/core/checksum.h"
+#include "kcenon/file_transfer/core/chunk_assembler.h"
 #include "kcenon/file_transfer/core/compression_engine.h"
+#include "kcenon/file_transfer/core/integrity_policy.h"
 #include "kcenon/file_transfer/core/logging.h"
 #include "kcenon/file_transfer/encryption/encryption_config.h"
 
@@ -17,11 +19,29 @@
 
 #include <kcenon/thread/core/error_handling.h>
 
+#include <chrono>
 #include <fstream>
 #include <span>
 
 namespace kcenon::file_transfer {
 
+namespace {
+
+// Count a chunk checksum the integrity policy let a stage skip
+auto record_skipped_check(const pipeline_context& context, const pipeline_chunk& chunk) -> void {
+    if (!context.statistics) {
+        return;
+    }
+    context.statistics->checksums_skipped++;
+    context.statistics->checksum_bytes_skipped += chunk.data.size();
+    if (context.integrity) {
+        context.statistics->integrity_cpu_saved_ns += static_cast<uint64_t>(
+            context.integrity->estimate_cost(chunk.integrity, chunk.data.size()).count());
+    }
+}
+
+}  // namespace
+
 // ----------------------------------------------------------------------------
 // pipeline_job_base implementation
 // ----------------------------------------------------------------------------
@@ -64,6 +84,12 @@ auto decompress_job::do_work() -> common::VoidResult {
                  "Processing chunk " + std::to_string(chunk_.chunk_index) +
                      " in decompress stage");
 
+    if (context_->streams) {
+        if (auto stream = context_->streams->find(chunk_.id)) {
+            return decompress_stream(*stream);
+        }
+    }
+
     if (chunk_.is_compressed) {
         auto& engine = context_->compression_engines[
             worker_id_ % context_->compression_engines.size()];
@@ -87,7 +113,8 @@ auto decompress_job::do_work() -> common::VoidResult {
                              std::to_string(chunk_.chunk_index) + ": " +
                              result.error().message;
             FT_LOG_ERROR(log_category::pipeline, error_msg);
-            context_->report_error(pipeline_stage::decompress, result.error().message);
+            context_->report_chunk_error(pipeline_stage::decompress, chunk_,
+                                         result.error().message);
 
             return thread::make_error_result(
                 thread::error_code::job_execution_failed,
@@ -97,25 +124,120 @@ auto decompress_job::do_work() -> common::VoidResult {
 
     context_->report_stage_complete(pipeline_stage::decompress, chunk_);
 
-    // Submit to next stage
+    return forward(chunk_);
+}
+
+auto decompress_job::decompress_stream(upload_stream& stream) -> common::VoidResult {
+    std::vector<pipeline_chunk> done;
+    std::vector<std::pair<pipeline_chunk, std::string>> failed;
+    {
+        std::lock_guard lock(stream.mutex);
+        if (!stream.decoder.ready(chunk_.chunk_index, chunk_.flags)) {
+            if (stream.waiting.size() >= stream.max_waiting()) {
+                failed.emplace_back(std::move(chunk_), "Too many chunks waiting for history");
+            } else if (stream.waiting.contains(chunk_.chunk_index)) {
+                failed.emplace_back(std::move(chunk_), "Chunk already waiting for history");
+            } else {
+                // Waiting chunks hold no upload slot, so the ones they wait
+                // for can still be admitted
+                FT_LOG_TRACE(log_category::pipeline,
+                             "Chunk " + std::to_string(chunk_.chunk_index) +
+                                 " waits for the chunks before it");
+                chunk_.upload_slot.reset();
+                auto index = chunk_.chunk_index;
+                stream.waiting.emplace(index, std::move(chunk_));
+            }
+        } else {
+            auto restored = restore(stream, chunk_);
+            if (restored.has_value()) {
+                done.push_back(std::move(chunk_));
+            } else {
+                failed.emplace_back(std::move(chunk_), restored.error().message);
+            }
+
+            // Later chunks only ever refer back, so one pass in index order
+            // releases every chain this chunk completed
+            for (auto it = stream.waiting.begin(); it != stream.waiting.end();) {
+                if (!stream.decoder.ready(it->first, it->second.flags)) {
+                    ++it;
+                    continue;
+                }
+                auto waiting = std::move(it->second);
+                it = stream.waiting.erase(it);
+                auto result = restore(stream, waiting);
+                if (result.has_value()) {
+                    done.push_back(std::move(waiting));
+                } else {
+                    failed.emplace_back(std::move(waiting), result.error().message);
+                }
+            }
+        }
+    }
+
+    for (auto& [chunk, message] : failed) {
+        auto error_msg = "Decompression failed for chunk " +
+                         std::to_string(chunk.chunk_index) + ": " + message;
+        FT_LOG_ERROR(log_category::pipeline, error_msg);
+        context_->report_chunk_error(pipeline_stage::decompress, chunk, message);
+    }
+    // A chunk that cannot be forwarded is reported by forward(); the rest
+    // still go on
+    common::VoidResult outcome = common::ok();
+    for (auto& chunk : done) {
+        context_->report_stage_complete(pipeline_stage::decompress, chunk);
+        auto forwarded = forward(chunk);
+        if (forwarded.is_err() && outcome.is_ok()) {
+            outcome = std::move(forwarded);
+        }
+    }
+    return outcome;
+}
+
+auto decompress_job::restore(upload_stream& stream, pipeline_chunk& chunk) -> result<void> {
+    if (!chunk.is_compressed) {
+        stream.decoder.record(chunk.chunk_index, chunk.flags, chunk.data, chunk.original_size);
+        return {};
+    }
+    auto result = stream.decoder.decompress(chunk.chunk_index, chunk.flags, chunk.data,
+                                            chunk.original_size);
+    if (!result.has_value()) {
+        return unexpected(result.error());
+    }
+    if (context_->statistics) {
+        context_->statistics->compression_saved_bytes += chunk.original_size - chunk.data.size();
+    }
+    chunk.data = std::move(result.value());
+    chunk.is_compressed = false;
+    return {};
+}
+
+auto decompress_job::forward(pipeline_chunk& chunk) -> common::VoidResult {
+    // The job takes the chunk; keep enough to report it if the pool refuses
+    auto payload = std::move(chunk.data);
+    pipeline_chunk header(chunk);
+    chunk.data = std::move(payload);
+
+    auto refused = [&](const std::string& message) {
+        FT_LOG_ERROR(log_category::pipeline,
+                     message + " for chunk " + std::to_string(header.chunk_index));
+        context_->report_chunk_error(pipeline_stage::decompress, header, message);
+        return thread::make_error_result(thread::error_code::queue_full, message);
+    };
+
     // If encryption is enabled and chunk is encrypted, go to decrypt stage
     // Otherwise, go directly to verify stage
-    if (context_->encryption_enabled && chunk_.is_encrypted && context_->decrypt_queue) {
+    if (context_->encryption_enabled && chunk.is_encrypted && context_->decrypt_queue) {
         auto decrypt = std::make_unique<decrypt_job>(
-            context_, std::move(chunk_), worker_id_);
+            context_, std::move(chunk), worker_id_);
         auto enqueue_result = context_->thread_pool->enqueue(std::move(decrypt));
         if (!enqueue_result.is_ok()) {
-            return thread::make_error_result(
-                thread::error_code::queue_full,
-                "Failed to enqueue decrypt job");
+            return refused("Failed to enqueue decrypt job");
         }
     } else if (context_->verify_queue) {
-        auto verify = std::make_unique<verify_job>(std::move(chunk_), context_);
+        auto verify = std::make_unique<verify_job>(std::move(chunk), context_);
         auto enqueue_result = context_->thread_pool->enqueue(std::move(verify));
         if (!enqueue_result.is_ok()) {
-            return thread::make_error_result(
-                thread::error_code::queue_full,
-                "Failed to enqueue verify job");
+            return refused("Failed to enqueue verify job");
         }
     }
 
@@ -147,19 +269,49 @@ auto verify_job::do_work() -> common::VoidResult {
     FT_LOG_TRACE(log_category::pipeline,
                  "Verifying chunk " + std::to_string(chunk_.chunk_index));
 
-    // Verify CRC32 checksum
-    auto calculated = checksum::crc32(std::span<const std::byte>(chunk_.data));
-    if (calculated != chunk_.checksum) {
-        auto error_msg = "Checksum mismatch for chunk " +
-                         std::to_string(chunk_.chunk_index) + " (expected: " +
-                         std::to_string(chunk_.checksum) +
-                         ", got: " + std::to_string(calculated) + ")";
+    // An AEAD tag verified on decryption already authenticated the data
+    if (!has_check(integrity_policy::outstanding(chunk_.verified),
+                   integrity_check::chunk_checksum)) {
+        record_skipped_check(*context_, chunk_);
+    } else if (!checksum::is_supported(chunk_.integrity)) {
+        auto error_msg = "Unsupported checksum algorithm " +
+                         std::string(to_string(chunk_.integrity)) + " for chunk " +
+                         std::to_string(chunk_.chunk_index);
         FT_LOG_ERROR(log_category::pipeline, error_msg);
-        context_->report_error(pipeline_stage::chunk_verify, error_msg);
+        context_->report_chunk_error(pipeline_stage::chunk_verify, chunk_, error_msg);
 
         return thread::make_error_result(
             thread::error_code::job_execution_failed,
             error_msg);
+    } else {
+        // Verify the checksum with the algorithm the sender chose
+        auto start = std::chrono::steady_clock::now();
+        auto calculated =
+            checksum::digest(chunk_.integrity, std::span<const std::byte>(chunk_.data));
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        if (context_->integrity) {
+            context_->integrity->record_check(
+                chunk_.integrity, chunk_.data.size(),
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+        }
+
+        if (calculated != chunk_.checksum) {
+            auto error_msg = "Checksum mismatch for chunk " +
+                             std::to_string(chunk_.chunk_index) + " (" +
+                             to_string(chunk_.integrity) + " expected: " +
+                             std::to_string(chunk_.checksum) +
+                             ", got: " + std::to_string(calculated) + ")";
+            FT_LOG_ERROR(log_category::pipeline, error_msg);
+            context_->report_chunk_error(pipeline_stage::chunk_verify, chunk_, error_msg);
+
+            return thread::make_error_result(
+                thread::error_code::job_execution_failed,
+                error_msg);
+        }
+        chunk_.verified |= integrity_check::chunk_checksum;
+        if (context_->statistics) {
+            context_->statistics->checksums_verified++;
+        }
     }
 
     if (context_->statistics) {
@@ -212,8 +364,40 @@ auto write_job::do_work() -> common::VoidResult {
                  "Writing chunk " + std::to_string(chunk_.chunk_index) + " (" +
                      std::to_string(chunk_.data.size()) + " bytes)");
 
-    // Note: Actual file writing is handled by the callback
-    // This job prepares the chunk and notifies completion
+    if (context_->assembler) {
+        chunk c;
+        c.header.id = chunk_.id;
+        c.header.chunk_index = chunk_.chunk_index;
+        c.header.chunk_offset = chunk_.chunk_offset;
+        // The payload is decompressed by now; first/last and zero_range still apply
+        c.header.flags = chunk_.flags & ~chunk_flags::compressed;
+        c.header.original_size = static_cast<uint32_t>(chunk_.original_size);
+        c.header.compressed_size = static_cast<uint32_t>(chunk_.data.size());
+        c.set_digest(chunk_.integrity, chunk_.checksum);
+
+        // Checks done upstream are not repeated by the assembler; counted
+        // before the payload moves out so the skipped bytes are right
+        if (!has_check(integrity_policy::outstanding(chunk_.verified),
+                       integrity_check::chunk_checksum)) {
+            record_skipped_check(*context_, chunk_);
+        }
+        c.data = std::move(chunk_.data);
+        auto written = context_->assembler->process_chunk(c, chunk_.verified);
+        chunk_.data = std::move(c.data);
+        if (!written.has_value()) {
+            auto error_msg = "Write failed for chunk " +
+                             std::to_string(chunk_.chunk_index) + ": " +
+                             written.error().message;
+            FT_LOG_ERROR(log_category::pipeline, error_msg);
+            context_->report_chunk_error(pipeline_stage::file_write, chunk_,
+                                         written.error().message);
+
+            return thread::make_error_result(
+                thread::error_code::job_execution_failed,
+                error_msg);
+        }
+    }
+
     context_->report_stage_complete(pipeline_stage::file_write, chunk_);
 
     if (context_->on_upload_complete_cb) {
@@ -236,13 +420,17 @@ read_job::read_job(std::shared_ptr<pipeline_context> context,
                    uint64_t chunk_index,
                    std::filesystem::path file_path,
                    uint64_t offset,
-                   std::size_t size)
+                   std::size_t size,
+                   client_id client,
+                   chunk_integrity integrity)
     : pipeline_job_base("read_job", std::move(context))
     , id_(id)
     , chunk_index_(chunk_index)
     , file_path_(std::move(file_path))
     , offset_(offset)
-    , size_(size) {}
+    , size_(size)
+    , client_(client)
+    , integrity_(integrity) {}
 
 auto read_job::do_work() -> common::VoidResult {
     if (is_cancelled()) {
@@ -282,6 +470,7 @@ auto read_job::do_work() -> common::VoidResult {
     }
 
     chunk_.id = id_;
+    chunk_.client = client_;
     chunk_.chunk_index = chunk_index_;
     chunk_.data.resize(size_);
     chunk_.is_compressed = false;
@@ -296,7 +485,12 @@ auto read_job::do_work() -> common::VoidResult {
         chunk_.original_size = bytes_read;
     }
 
-    chunk_.checksum = checksum::crc32(std::span<const std::byte>(chunk_.data));
+    // One pass for the checksum and the compressibility estimate, while
+    // the bytes just read are still in cache
+    auto scan = checksum::scan(std::span<const std::byte>(chunk_.data), integrity_);
+    chunk_.checksum = scan.digest;
+    chunk_.integrity = integrity_;
+    chunk_.entropy = scan.entropy();
 
     FT_LOG_TRACE(log_category::pipeline,
                  "Chunk " + std::to_string(chunk_index_) + " read (" +
@@ -364,8 +558,12 @@ auto compress_job::do_work() -> common::VoidResult {
     auto& engine = context_->compression_engines[
         worker_id_ % context_->compression_engines.size()];
 
-    // Check if compression would be beneficial
-    if (engine->is_compressible(std::span<const std::byte>(chunk_.data))) {
+    // Check if compression would be beneficial; the read stage's entropy
+    // estimate saves a trial compression when it already decides
+    std::span<const std::byte> data(chunk_.data);
+    auto compressible = chunk_.entropy >= 0.0 ? engine->is_compressible(data, chunk_.entropy)
+                                              : engine->is_compressible(data);
+    if (compressible) {
         auto result = engine->compress(std::span<const std::byte>(chunk_.data));
         if (result.has_value() && result.value().size() < chunk_.data.size()) {
             auto original = chunk_.data.size();
@@ -413,8 +611,11 @@ auto compress_job::get_chunk() const -> const pipeline_chunk& {
 // send_job implementation
 // ----------------------------------------------------------------------------
 
-send_job::send_job(pipeline_chunk chunk, std::shared_ptr<pipeline_context> context)
-    : pipeline_job_base("send_job", std::move(context)), chunk_(std::move(chunk)) {}
+send_job::send_job(pipeline_chunk chunk, std::shared_ptr<pipeline_context> context,
+                   bool shaped)
+    : pipeline_job_base("send_job", std::move(context))
+    , chunk_(std::move(chunk))
+    , shaped_(shaped) {}
 
 auto send_job::do_work() -> common::VoidResult {
     if (is_cancelled()) {
@@ -431,9 +632,27 @@ auto send_job::do_work() -> common::VoidResult {
                  "Sending chunk " + std::to_string(chunk_.chunk_index) + " (" +
                      std::to_string(chunk_.data.size()) + " bytes)");
 
-    // Apply send bandwidth limit if configured
-    if (context_->send_limiter) {
-        context_->send_limiter->acquire(chunk_.data.size());
+    // Take send tokens; when short, park the chunk and end this job so the
+    // worker is free while it waits. The shaper re-enqueues it as a new job.
+    auto* shaper = context_->send_shaper;
+    if (shaper && !shaped_ &&
+        !shaper->try_acquire(chunk_.client.value, chunk_.id, chunk_.data.size())) {
+        auto context = context_;
+        auto parked = std::make_shared<pipeline_chunk>(std::move(chunk_));
+        auto resume = [context, parked] {
+            if (context->thread_pool) {
+                (void)context->thread_pool->enqueue(
+                    std::make_unique<send_job>(std::move(*parked), context, true));
+            }
+        };
+        if (!shaper->acquire_or_park(parked->client.value, parked->id, parked->data.size(),
+                                     resume)) {
+            FT_LOG_TRACE(log_category::pipeline,
+                         "Send of chunk " + std::to_string(parked->chunk_index) +
+                             " parked by bandwidth shaping");
+            return common::ok();
+        }
+        chunk_ = std::move(*parked);
     }
 
     if (context_->statistics) {
@@ -493,6 +712,7 @@ auto encrypt_job::do_work() -> common::VoidResult {
                 auto& enc_result = result.value();
                 chunk_.data = std::move(enc_result.ciphertext);
                 chunk_.is_encrypted = true;
+                chunk_.entropy = 8.0;  // Ciphertext does not compress
                 chunk_.enc_metadata = std::make_unique<encryption_metadata>(
                     std::move(enc_result.metadata));
 
@@ -580,6 +800,10 @@ auto decrypt_job::do_work() -> common::VoidResult {
                 chunk_.data = std::move(result.value().plaintext);
                 chunk_.is_encrypted = false;
                 chunk_.enc_metadata.reset();
+                if (engine->config().use_aead) {
+                    // The tag check inside decryption authenticated the chunk
+                    chunk_.verified |= integrity_check::aead_tag;
+                }
 
                 if (context_->statistics) {
                     context_->statistics->chunks_decrypted++;
@@ -593,7 +817,8 @@ auto decrypt_job::do_work() -> common::VoidResult {
                                  std::to_string(chunk_.chunk_index) + ": " +
                                  result.error().message;
                 FT_LOG_ERROR(log_category::pipeline, error_msg);
-                context_->report_error(pipeline_stage::decrypt, result.error().message);
+                context_->report_chunk_error(pipeline_stage::decrypt, chunk_,
+                                             result.error().message);
 
                 return thread::make_error_result(
                     thread::error_code::job_execution_failed,
@@ -8,19 +8,81 @@
 #include "kcenon/file_transfer/core/logging.h"
 
 #include <algorithm>
+#include <array>
+#include <fstream>
 #include <mutex>
+#include <set>
 #include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
 
 namespace kcenon::file_transfer {
 
+namespace {
+
+// Usage index snapshot lives in a subdirectory so that rewriting it does not
+// touch the storage directory's own modification time (used for drift checks).
+constexpr const char* index_directory_name = ".file_trans_quota";
+constexpr const char* index_snapshot_name = "usage.idx";
+constexpr uint32_t index_snapshot_magic = 0x49515446;  // "FTQI"
+constexpr uint32_t index_snapshot_version = 1;
+
+constexpr std::size_t tenant_shard_count = 16;
+
+// In-progress uploads are written by chunk_assembler to temp files with this
+// prefix; their bytes are accounted as reservations, not as stored files
+constexpr std::string_view assembler_temp_prefix = ".tmp_";
+
+template <typename T>
+auto write_pod(std::ofstream& out, const T& value) -> void {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+auto read_pod(std::ifstream& in, T& value) -> bool {
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return in.good();
+}
+
+}  // namespace
+
 struct quota_manager::impl {
+    using file_time = std::filesystem::file_time_type;
+
+    struct indexed_file {
+        uint64_t size = 0;
+        file_time last_write{};
+    };
+
     std::filesystem::path storage_path;
     std::atomic<uint64_t> total_quota{0};
     std::atomic<uint64_t> max_file_size{0};
 
+    // Guards current_usage and the usage index below
     mutable std::shared_mutex usage_mutex;
     quota_usage current_usage;
 
+    // Usage index: per-file entries plus an age-ordered set so cleanup can
+    // take victims from either end in O(log n) without rescanning.
+    std::unordered_map<std::string, indexed_file> file_index;
+    std::set<std::pair<file_time, std::string>> age_index;
+    file_time observed_directory_time{};
+    std::atomic<bool> snapshot_dirty{true};
+
+    // Lock-free admission state. used_bytes mirrors current_usage.used_bytes
+    // so that reserve() and check_quota() never take usage_mutex.
+    std::atomic<uint64_t> used_bytes{0};
+    std::atomic<uint64_t> reserved_bytes{0};
+    std::atomic<uint64_t> tenant_reservation_limit{0};
+
+    // Per-tenant reservations, sharded by tenant so that unrelated tenants
+    // do not contend on the same lock
+    struct alignas(64) tenant_shard {
+        mutable std::mutex mutex;
+        std::unordered_map<uint64_t, uint64_t> reserved;
+    };
+    std::array<tenant_shard, tenant_shard_count> tenant_shards;
+
     mutable std::mutex thresholds_mutex;
     std::vector<warning_threshold> warning_thresholds;
 
@@ -39,26 +101,36 @@ struct quota_manager::impl {
         warning_thresholds.emplace_back(95.0);
     }
 
-    auto calculate_usage() -> quota_usage {
-        quota_usage usage;
-        usage.total_quota = total_quota.load();
-        usage.used_bytes = 0;
-        usage.file_count = 0;
+    ~impl() {
+        if (snapshot_dirty.load()) {
+            (void)save_snapshot();
+        }
+    }
 
+    [[nodiscard]] auto snapshot_path() const -> std::filesystem::path {
+        return storage_path / index_directory_name / index_snapshot_name;
+    }
+
+    [[nodiscard]] auto directory_time() const -> std::optional<file_time> {
         std::error_code ec;
-        if (std::filesystem::exists(storage_path, ec) && !ec) {
-            for (const auto& entry :
-                 std::filesystem::directory_iterator(storage_path, ec)) {
-                if (ec) break;
-                if (entry.is_regular_file(ec) && !ec) {
-                    auto size = entry.file_size(ec);
-                    if (!ec) {
-                        usage.used_bytes += size;
-                        usage.file_count++;
-                    }
-                }
-            }
-        }
+        auto time = std::filesystem::last_write_time(storage_path, ec);
+        if (ec) return std::nullopt;
+        return time;
+    }
+
+    [[nodiscard]] auto shard_for(uint64_t tenant) -> tenant_shard& {
+        return tenant_shards[std::hash<uint64_t>{}(tenant) % tenant_shard_count];
+    }
+
+    [[nodiscard]] auto shard_for(uint64_t tenant) const -> const tenant_shard& {
+        return tenant_shards[std::hash<uint64_t>{}(tenant) % tenant_shard_count];
+    }
+
+    // Caller must hold usage_mutex exclusively
+    auto update_derived_usage() -> void {
+        auto& usage = current_usage;
+        usage.total_quota = total_quota.load();
+        used_bytes.store(usage.used_bytes, std::memory_order_release);
 
         if (usage.total_quota > 0) {
             usage.available_bytes = (usage.used_bytes < usage.total_quota)
@@ -69,6 +141,7 @@ struct quota_manager::impl {
                 static_cast<double>(usage.total_quota) * 100.0;
         } else {
             // Unlimited quota - try to get filesystem space
+            std::error_code ec;
             auto space_info = std::filesystem::space(storage_path, ec);
             if (!ec) {
                 usage.available_bytes = space_info.available;
@@ -77,43 +150,205 @@ struct quota_manager::impl {
             }
             usage.usage_percent = 0.0;
         }
+    }
+
+    // Caller must hold usage_mutex exclusively
+    auto index_erase(const std::string& name) -> std::optional<indexed_file> {
+        auto it = file_index.find(name);
+        if (it == file_index.end()) {
+            return std::nullopt;
+        }
+        auto entry = it->second;
+        age_index.erase({entry.last_write, name});
+        file_index.erase(it);
+        snapshot_dirty.store(true);
+
+        current_usage.used_bytes -= std::min(current_usage.used_bytes, entry.size);
+        if (current_usage.file_count > 0) {
+            current_usage.file_count--;
+        }
+        return entry;
+    }
+
+    // Caller must hold usage_mutex exclusively
+    auto index_insert(const std::string& name, uint64_t size, file_time last_write) -> void {
+        (void)index_erase(name);
+        file_index.emplace(name, indexed_file{size, last_write});
+        age_index.emplace(last_write, name);
+        snapshot_dirty.store(true);
+        current_usage.used_bytes += size;
+        current_usage.file_count++;
+    }
+
+    // Record the directory time after a change made by this manager so that
+    // it is not mistaken for drift. Caller must hold usage_mutex exclusively.
+    auto acknowledge_directory_change() -> void {
+        if (auto time = directory_time()) {
+            observed_directory_time = *time;
+        }
+    }
 
-        return usage;
+    [[nodiscard]] auto has_drifted() const -> bool {
+        auto time = directory_time();
+        std::shared_lock lock(usage_mutex);
+        return !time || *time != observed_directory_time;
     }
 
-    auto get_files_sorted_by_time() -> std::vector<std::filesystem::path> {
-        std::vector<std::pair<std::filesystem::path, std::filesystem::file_time_type>> files;
+    auto rebuild() -> void {
+        // Observe the directory time before scanning so that concurrent
+        // modifications during the scan are detected as drift next time.
+        auto dir_time = directory_time();
+
+        std::unordered_map<std::string, indexed_file> files;
+        std::set<std::pair<file_time, std::string>> by_age;
+        uint64_t used_bytes = 0;
 
         std::error_code ec;
-        for (const auto& entry :
-             std::filesystem::directory_iterator(storage_path, ec)) {
-            if (ec) break;
-            if (entry.is_regular_file(ec) && !ec) {
-                auto last_write = entry.last_write_time(ec);
-                if (!ec) {
-                    files.emplace_back(entry.path(), last_write);
+        if (std::filesystem::exists(storage_path, ec) && !ec) {
+            for (const auto& entry :
+                 std::filesystem::directory_iterator(storage_path, ec)) {
+                if (ec) break;
+                if (!entry.is_regular_file(ec) || ec) continue;
+                if (entry.path().filename().string().starts_with(assembler_temp_prefix)) {
+                    continue;
                 }
+
+                auto size = entry.file_size(ec);
+                if (ec) continue;
+                auto last_write = entry.last_write_time(ec);
+                if (ec) continue;
+
+                auto name = entry.path().filename().string();
+                by_age.emplace(last_write, name);
+                files.emplace(std::move(name), indexed_file{size, last_write});
+                used_bytes += size;
+            }
+        }
+
+        std::unique_lock lock(usage_mutex);
+        file_index = std::move(files);
+        age_index = std::move(by_age);
+        current_usage.used_bytes = used_bytes;
+        current_usage.file_count = file_index.size();
+        observed_directory_time = dir_time.value_or(file_time{});
+        snapshot_dirty.store(true);
+        update_derived_usage();
+    }
+
+    auto save_snapshot() -> result<void> {
+        auto path = snapshot_path();
+        std::error_code ec;
+        if (!std::filesystem::is_directory(storage_path, ec)) {
+            return unexpected{error{error_code::invalid_file_path,
+                                   "Storage path is not a directory"}};
+        }
+        std::filesystem::create_directories(path.parent_path(), ec);
+        if (ec) {
+            return unexpected{error{error_code::file_write_error,
+                                   "Failed to create index directory: " + ec.message()}};
+        }
+
+        auto temp_path = path;
+        temp_path += ".tmp";
+        {
+            std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                return unexpected{error{error_code::file_write_error,
+                                       "Failed to open index snapshot for writing"}};
+            }
+
+            // Clear the dirty flag while holding the lock so that changes made
+            // after the copy below mark the snapshot dirty again
+            std::shared_lock lock(usage_mutex);
+            snapshot_dirty.store(false);
+            write_pod(out, index_snapshot_magic);
+            write_pod(out, index_snapshot_version);
+            write_pod(out, static_cast<int64_t>(
+                observed_directory_time.time_since_epoch().count()));
+            write_pod(out, static_cast<uint64_t>(file_index.size()));
+            for (const auto& [name, entry] : file_index) {
+                write_pod(out, static_cast<uint32_t>(name.size()));
+                out.write(name.data(), static_cast<std::streamsize>(name.size()));
+                write_pod(out, entry.size);
+                write_pod(out, static_cast<int64_t>(
+                    entry.last_write.time_since_epoch().count()));
+            }
+            if (!out.good()) {
+                snapshot_dirty.store(true);
+                return unexpected{error{error_code::file_write_error,
+                                       "Failed to write index snapshot"}};
             }
         }
 
-        // Sort by last write time (oldest first for deletion)
-        std::sort(files.begin(), files.end(),
-                  [](const auto& a, const auto& b) {
-                      return a.second < b.second;
-                  });
+        std::filesystem::rename(temp_path, path, ec);
+        if (ec) {
+            std::filesystem::remove(temp_path, ec);
+            snapshot_dirty.store(true);
+            return unexpected{error{error_code::file_write_error,
+                                   "Failed to replace index snapshot"}};
+        }
+        return {};
+    }
 
-        std::vector<std::filesystem::path> result;
-        result.reserve(files.size());
-        for (auto& [path, _] : files) {
-            result.push_back(std::move(path));
+    // Loads the snapshot if it is still consistent with the storage directory
+    [[nodiscard]] auto load_snapshot() -> bool {
+        std::ifstream in(snapshot_path(), std::ios::binary);
+        if (!in) {
+            return false;
         }
-        return result;
+
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        int64_t dir_ticks = 0;
+        uint64_t count = 0;
+        if (!read_pod(in, magic) || magic != index_snapshot_magic ||
+            !read_pod(in, version) || version != index_snapshot_version ||
+            !read_pod(in, dir_ticks) || !read_pod(in, count)) {
+            return false;
+        }
+
+        auto snapshot_time = file_time{file_time::duration{dir_ticks}};
+        auto dir_time = directory_time();
+        if (!dir_time || *dir_time != snapshot_time) {
+            FT_LOG_INFO(log_category::server,
+                "Quota index snapshot is stale, rescanning storage directory");
+            return false;
+        }
+
+        std::unordered_map<std::string, indexed_file> files;
+        std::set<std::pair<file_time, std::string>> by_age;
+        uint64_t used_bytes = 0;
+        files.reserve(static_cast<std::size_t>(count));
+
+        for (uint64_t i = 0; i < count; ++i) {
+            uint32_t name_length = 0;
+            if (!read_pod(in, name_length)) return false;
+            std::string name(name_length, '\0');
+            in.read(name.data(), static_cast<std::streamsize>(name_length));
+            uint64_t size = 0;
+            int64_t ticks = 0;
+            if (!in.good() || !read_pod(in, size) || !read_pod(in, ticks)) {
+                return false;
+            }
+            auto last_write = file_time{file_time::duration{ticks}};
+            by_age.emplace(last_write, name);
+            files.emplace(std::move(name), indexed_file{size, last_write});
+            used_bytes += size;
+        }
+
+        std::unique_lock lock(usage_mutex);
+        file_index = std::move(files);
+        age_index = std::move(by_age);
+        current_usage.used_bytes = used_bytes;
+        current_usage.file_count = file_index.size();
+        observed_directory_time = snapshot_time;
+        snapshot_dirty.store(false);
+        update_derived_usage();
+        return true;
     }
 
-    auto is_excluded(const std::filesystem::path& path) const -> bool {
-        std::lock_guard lock(policy_mutex);
-        auto filename = path.filename().string();
-        for (const auto& pattern : current_policy.exclusions) {
+    auto is_excluded(const std::string& filename, const cleanup_policy& policy) const -> bool {
+        for (const auto& pattern : policy.exclusions) {
             // Simple pattern matching - check if filename contains pattern
             if (filename.find(pattern) != std::string::npos) {
                 return true;
@@ -122,19 +357,44 @@ struct quota_manager::impl {
         return false;
     }
 
-    auto is_file_old_enough(const std::filesystem::path& path) const -> bool {
-        std::lock_guard lock(policy_mutex);
-        if (current_policy.min_file_age.count() == 0) {
-            return true;  // No age requirement
+    // Select cleanup victims from the age index until enough bytes would be
+    // freed. Only the entries visited are touched, so this is O(k log n).
+    auto select_victims(const cleanup_policy& policy, uint64_t bytes_to_free) const
+        -> std::vector<std::string> {
+        std::vector<std::string> victims;
+        if (bytes_to_free == 0) {
+            return victims;
         }
-
-        std::error_code ec;
-        auto last_write = std::filesystem::last_write_time(path, ec);
-        if (ec) return false;
-
-        auto now = std::filesystem::file_time_type::clock::now();
-        auto age = std::chrono::duration_cast<std::chrono::hours>(now - last_write);
-        return age >= current_policy.min_file_age;
+        uint64_t selected_bytes = 0;
+        auto now = file_time::clock::now();
+
+        auto visit = [&](const std::pair<file_time, std::string>& item) -> bool {
+            const auto& [last_write, name] = item;
+            if (policy.min_file_age.count() > 0 &&
+                std::chrono::duration_cast<std::chrono::hours>(now - last_write) <
+                    policy.min_file_age) {
+                // Too young; when walking oldest first all later files are too
+                return !policy.delete_oldest_first;
+            }
+            if (is_excluded(name, policy)) {
+                return true;
+            }
+            victims.push_back(name);
+            selected_bytes += file_index.at(name).size;
+            return selected_bytes < bytes_to_free;
+        };
+
+        std::shared_lock lock(usage_mutex);
+        if (policy.delete_oldest_first) {
+            for (auto it = age_index.begin(); it != age_index.end(); ++it) {
+                if (!visit(*it)) break;
+            }
+        } else {
+            for (auto it = age_index.rbegin(); it != age_index.rend(); ++it) {
+                if (!visit(*it)) break;
+            }
+        }
+        return victims;
     }
 };
 
@@ -162,8 +422,16 @@ auto quota_manager::create(
 
 quota_manager::quota_manager(const std::filesystem::path& storage_path, uint64_t total_quota)
     : impl_(std::make_unique<impl>(storage_path, total_quota)) {
-    // Initial usage calculation
-    refresh_usage();
+    // Create the index directory up front so that later snapshot writes
+    // never change the storage directory's modification time
+    std::error_code ec;
+    std::filesystem::create_directories(impl_->snapshot_path().parent_path(), ec);
+
+    // Initial usage calculation: reuse the persisted index when still valid
+    if (!impl_->load_snapshot()) {
+        impl_->rebuild();
+    }
+    check_thresholds();
     FT_LOG_INFO(log_category::server,
         "Quota manager initialized: path=" + storage_path.string() +
         ", quota=" + std::to_string(total_quota) + " bytes");
@@ -196,16 +464,18 @@ auto quota_manager::get_max_file_size() const -> uint64_t {
 }
 
 auto quota_manager::check_quota(uint64_t required_bytes) -> result<void> {
-    auto usage = get_usage();
-
-    if (usage.total_quota == 0) {
+    auto total = impl_->total_quota.load();
+    if (total == 0) {
         return {};  // Unlimited quota
     }
 
-    if (usage.used_bytes + required_bytes > usage.total_quota) {
+    auto used = impl_->used_bytes.load(std::memory_order_acquire);
+    auto reserved = impl_->reserved_bytes.load(std::memory_order_acquire);
+    if (used + reserved + required_bytes > total) {
+        auto committed = used + reserved;
         FT_LOG_WARN(log_category::server,
             "Quota check failed: required=" + std::to_string(required_bytes) +
-            ", available=" + std::to_string(usage.available_bytes));
+            ", available=" + std::to_string(committed < total ? total - committed : 0));
         return unexpected{error{error_code::quota_exceeded,
                                "Storage quota would be exceeded"}};
     }
@@ -213,6 +483,91 @@ auto quota_manager::check_quota(uint64_t required_bytes) -> result<void> {
     return {};
 }
 
+auto quota_manager::reserve(uint64_t bytes, uint64_t tenant) -> result<quota_reservation> {
+    // Global admission: CAS on reserved bytes against used + reserved
+    auto total = impl_->total_quota.load();
+    auto reserved = impl_->reserved_bytes.load(std::memory_order_relaxed);
+    do {
+        auto used = impl_->used_bytes.load(std::memory_order_acquire);
+        if (total > 0 && used + reserved + bytes > total) {
+            FT_LOG_WARN(log_category::server,
+                "Quota reservation failed: requested=" + std::to_string(bytes) +
+                ", used=" + std::to_string(used) +
+                ", reserved=" + std::to_string(reserved));
+            return unexpected{error{error_code::quota_exceeded,
+                                   "Storage quota would be exceeded"}};
+        }
+    } while (!impl_->reserved_bytes.compare_exchange_weak(
+        reserved, reserved + bytes, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+    // Per-tenant accounting and optional in-flight limit
+    auto limit = impl_->tenant_reservation_limit.load();
+    auto& shard = impl_->shard_for(tenant);
+    {
+        std::lock_guard lock(shard.mutex);
+        auto& tenant_reserved = shard.reserved[tenant];
+        if (limit > 0 && tenant_reserved + bytes > limit) {
+            if (tenant_reserved == 0) {
+                shard.reserved.erase(tenant);
+            }
+            impl_->reserved_bytes.fetch_sub(bytes, std::memory_order_acq_rel);
+            FT_LOG_WARN(log_category::server,
+                "Quota reservation failed: tenant " + std::to_string(tenant) +
+                " reservation limit reached");
+            return unexpected{error{error_code::quota_exceeded,
+                                   "Tenant reservation limit would be exceeded"}};
+        }
+        tenant_reserved += bytes;
+    }
+
+    return quota_reservation{tenant, bytes};
+}
+
+auto quota_manager::commit_reservation(
+    const quota_reservation& reservation,
+    const std::filesystem::path& stored_path,
+    uint64_t actual_bytes) -> void {
+    // Account the stored bytes before dropping the reservation so that
+    // concurrent admission never sees a transient under-count
+    record_file_stored(stored_path, actual_bytes);
+    release_reservation(reservation);
+}
+
+auto quota_manager::release_reservation(const quota_reservation& reservation) -> void {
+    auto& shard = impl_->shard_for(reservation.tenant);
+    {
+        std::lock_guard lock(shard.mutex);
+        auto it = shard.reserved.find(reservation.tenant);
+        if (it != shard.reserved.end()) {
+            it->second -= std::min(it->second, reservation.bytes);
+            if (it->second == 0) {
+                shard.reserved.erase(it);
+            }
+        }
+    }
+
+    auto reserved = impl_->reserved_bytes.load(std::memory_order_relaxed);
+    while (!impl_->reserved_bytes.compare_exchange_weak(
+        reserved, reserved - std::min(reserved, reservation.bytes),
+        std::memory_order_acq_rel, std::memory_order_relaxed)) {
+    }
+}
+
+auto quota_manager::get_reserved_bytes() const -> uint64_t {
+    return impl_->reserved_bytes.load(std::memory_order_acquire);
+}
+
+auto quota_manager::get_reserved_bytes(uint64_t tenant) const -> uint64_t {
+    const auto& shard = impl_->shard_for(tenant);
+    std::lock_guard lock(shard.mutex);
+    auto it = shard.reserved.find(tenant);
+    return it != shard.reserved.end() ? it->second : 0;
+}
+
+auto quota_manager::set_tenant_reservation_limit(uint64_t bytes) -> void {
+    impl_->tenant_reservation_limit.store(bytes);
+}
+
 auto quota_manager::check_file_size(uint64_t file_size) -> result<void> {
     auto max_size = impl_->max_file_size.load();
     if (max_size > 0 && file_size > max_size) {
@@ -231,23 +586,41 @@ auto quota_manager::get_available_space() const -> uint64_t {
 }
 
 auto quota_manager::get_usage() const -> quota_usage {
-    std::shared_lock lock(impl_->usage_mutex);
-    return impl_->current_usage;
+    quota_usage usage;
+    {
+        std::shared_lock lock(impl_->usage_mutex);
+        usage = impl_->current_usage;
+    }
+    usage.reserved_bytes = impl_->reserved_bytes.load(std::memory_order_acquire);
+    return usage;
 }
 
 auto quota_manager::refresh_usage() -> void {
-    auto usage = impl_->calculate_usage();
-    {
+    if (impl_->has_drifted()) {
+        FT_LOG_DEBUG(log_category::server,
+            "Storage directory changed externally, rebuilding quota index");
+        impl_->rebuild();
+    } else {
         std::unique_lock lock(impl_->usage_mutex);
-        impl_->current_usage = usage;
+        impl_->update_derived_usage();
     }
     check_thresholds();
 }
 
+auto quota_manager::rebuild_index() -> void {
+    impl_->rebuild();
+    check_thresholds();
+}
+
+auto quota_manager::save_index_snapshot() -> result<void> {
+    return impl_->save_snapshot();
+}
+
 auto quota_manager::record_bytes_added(uint64_t bytes) -> void {
     {
         std::unique_lock lock(impl_->usage_mutex);
         impl_->current_usage.used_bytes += bytes;
+        impl_->used_bytes.store(impl_->current_usage.used_bytes, std::memory_order_release);
         auto total = impl_->total_quota.load();
         if (total > 0) {
             impl_->current_usage.available_bytes =
@@ -269,6 +642,7 @@ auto quota_manager::record_bytes_removed(uint64_t bytes) -> void {
     } else {
         impl_->current_usage.used_bytes -= bytes;
     }
+    impl_->used_bytes.store(impl_->current_usage.used_bytes, std::memory_order_release);
     auto total = impl_->total_quota.load();
     if (total > 0) {
         impl_->current_usage.available_bytes = total - impl_->current_usage.used_bytes;
@@ -290,6 +664,30 @@ auto quota_manager::record_file_removed() -> void {
     }
 }
 
+auto quota_manager::record_file_stored(
+    const std::filesystem::path& path, uint64_t size) -> void {
+    std::error_code ec;
+    auto last_write = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        last_write = std::filesystem::file_time_type::clock::now();
+    }
+
+    {
+        std::unique_lock lock(impl_->usage_mutex);
+        impl_->index_insert(path.filename().string(), size, last_write);
+        impl_->acknowledge_directory_change();
+        impl_->update_derived_usage();
+    }
+    check_thresholds();
+}
+
+auto quota_manager::record_file_deleted(const std::filesystem::path& path) -> void {
+    std::unique_lock lock(impl_->usage_mutex);
+    (void)impl_->index_erase(path.filename().string());
+    impl_->acknowledge_directory_change();
+    impl_->update_derived_usage();
+}
+
 auto quota_manager::set_warning_thresholds(const std::vector<double>& percentages) -> void {
     std::lock_guard lock(impl_->thresholds_mutex);
     impl_->warning_thresholds.clear();
@@ -362,42 +760,32 @@ auto quota_manager::execute_cleanup() -> uint64_t {
         "Starting cleanup: current usage=" + std::to_string(usage.usage_percent) +
         "%, target=" + std::to_string(policy.target_threshold) + "%");
 
-    uint64_t bytes_freed = 0;
-    auto files = impl_->get_files_sorted_by_time();
-
-    if (!policy.delete_oldest_first) {
-        std::reverse(files.begin(), files.end());
+    // Only rescan when the directory was changed behind our back
+    if (impl_->has_drifted()) {
+        impl_->rebuild();
+        usage = get_usage();
     }
 
-    for (const auto& file_path : files) {
-        // Re-check usage
-        auto current = get_usage();
-        if (current.usage_percent <= policy.target_threshold) {
-            break;  // Target reached
-        }
+    auto target_bytes = static_cast<uint64_t>(
+        static_cast<double>(usage.total_quota) * policy.target_threshold / 100.0);
+    auto bytes_to_free = usage.used_bytes > target_bytes ? usage.used_bytes - target_bytes : 0;
 
-        // Check exclusions
-        if (impl_->is_excluded(file_path)) {
-            continue;
-        }
-
-        // Check file age
-        if (!impl_->is_file_old_enough(file_path)) {
-            continue;
-        }
+    uint64_t bytes_freed = 0;
+    for (const auto& name : impl_->select_victims(policy, bytes_to_free)) {
+        auto file_path = impl_->storage_path / name;
 
-        // Delete the file
         std::error_code ec;
-        auto file_size = std::filesystem::file_size(file_path, ec);
-        if (ec) continue;
+        bool removed = std::filesystem::remove(file_path, ec) && !ec;
 
-        if (std::filesystem::remove(file_path, ec) && !ec) {
-            bytes_freed += file_size;
-            record_bytes_removed(file_size);
-            record_file_removed();
+        std::unique_lock lock(impl_->usage_mutex);
+        auto entry = impl_->index_erase(name);
+        impl_->acknowledge_directory_change();
+        impl_->update_derived_usage();
+        if (removed && entry) {
+            bytes_freed += entry->size;
             FT_LOG_DEBUG(log_category::server,
-                "Cleanup deleted: " + file_path.filename().string() +
-                " (" + std::to_string(file_size) + " bytes)");
+                "Cleanup deleted: " + name +
+                " (" + std::to_string(entry->size) + " bytes)");
         }
     }
 
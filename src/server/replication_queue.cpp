@@ -0,0 +1,527 @@
+/**
+ * @file replication_queue.cpp
+ * @brief Durable write-behind replication queue implementation
+ */
+
+#include "kcenon/file_transfer/server/replication_queue.h"
+
+#include "kcenon/file_transfer/core/io_executor.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace kcenon::file_transfer {
+
+namespace {
+
+constexpr const char* journal_name = "replication.journal";
+constexpr uint32_t journal_magic = 0x51525446;  // "FTRQ"
+constexpr uint32_t journal_format_version = 1;
+
+// Journal records; "done" retires the pending request for a key
+constexpr uint8_t record_done = 3;
+
+// The journal is compacted once it holds this many retired records and more
+// retired than live ones
+constexpr std::size_t compaction_min_done = 1024;
+
+template <typename T>
+auto write_pod(std::ofstream& out, const T& value) -> void {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+auto read_pod(std::ifstream& in, T& value) -> bool {
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return in.good();
+}
+
+auto write_string(std::ofstream& out, const std::string& value) -> void {
+    write_pod(out, static_cast<uint32_t>(value.size()));
+    out.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+auto read_string(std::ifstream& in, std::string& value) -> bool {
+    uint32_t length = 0;
+    if (!read_pod(in, length) || length > 64 * 1024) return false;
+    value.resize(length);
+    in.read(value.data(), length);
+    return in.good();
+}
+
+auto to_millis(std::chrono::system_clock::time_point time) -> int64_t {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        time.time_since_epoch()).count();
+}
+
+}  // namespace
+
+struct replication_queue::impl {
+    struct entry {
+        replication_request request;
+        std::chrono::system_clock::time_point enqueued_at;
+        std::size_t attempts = 0;
+        bool queued = false;     // In the ready list
+        bool in_flight = false;  // Part of a running batch
+        bool dirty = false;      // Re-enqueued while in flight
+    };
+
+    replication_queue_config config;
+    replicate_function replicate;
+    failure_callback on_failure;
+
+    mutable std::mutex mutex;
+    std::condition_variable idle;
+    std::unordered_map<std::string, entry> pending;
+    std::deque<std::string> ready;
+    std::size_t active_batches = 0;
+    std::size_t in_flight_keys = 0;
+    std::size_t reporting = 0;  // Workers running the failure callback
+    bool closed = false;
+    replication_statistics stats;
+
+    std::ofstream journal;
+    std::size_t done_records = 0;
+
+    explicit impl(const replication_queue_config& cfg) : config(cfg) {
+        config.max_concurrency = std::max<std::size_t>(config.max_concurrency, 1);
+        config.batch_size = std::max<std::size_t>(config.batch_size, 1);
+        config.max_attempts = std::max<std::size_t>(config.max_attempts, 1);
+        // Batches copy through backends that submit to their own lanes
+        io.set_blocking();
+    }
+
+    [[nodiscard]] auto journal_path() const -> std::filesystem::path {
+        return config.journal_directory / journal_name;
+    }
+
+    static auto write_record(std::ofstream& out, uint8_t op, int64_t time_ms,
+                             const replication_request& request) -> void {
+        write_pod(out, op);
+        write_pod(out, time_ms);
+        write_string(out, request.key);
+        write_string(out, request.storage_class);
+        write_string(out, request.content_type);
+    }
+
+    // Caller must hold mutex
+    auto append_locked(uint8_t op, int64_t time_ms, const replication_request& request)
+        -> result<void> {
+        write_record(journal, op, time_ms, request);
+        journal.flush();
+        if (!journal.good()) {
+            return unexpected{error{error_code::file_write_error,
+                                   "Failed to append to replication journal"}};
+        }
+        return result<void>();
+    }
+
+    /**
+     * @brief Replay the journal into the pending table
+     *
+     * Stops at the first incomplete record (a torn write from a crash).
+     */
+    auto replay() -> void {
+        std::ifstream in(journal_path(), std::ios::binary);
+        uint32_t magic = 0;
+        uint32_t format = 0;
+        if (!in || !read_pod(in, magic) || magic != journal_magic ||
+            !read_pod(in, format) || format != journal_format_version) {
+            return;
+        }
+
+        while (true) {
+            uint8_t op = 0;
+            int64_t time_ms = 0;
+            replication_request request;
+            if (!read_pod(in, op) || !read_pod(in, time_ms) ||
+                !read_string(in, request.key) || !read_string(in, request.storage_class) ||
+                !read_string(in, request.content_type)) {
+                break;
+            }
+
+            if (op == record_done) {
+                pending.erase(request.key);
+                continue;
+            }
+            if (op != static_cast<uint8_t>(replication_op::put) &&
+                op != static_cast<uint8_t>(replication_op::remove)) {
+                break;
+            }
+
+            request.op = static_cast<replication_op>(op);
+            auto [it, inserted] = pending.try_emplace(request.key);
+            if (inserted) {
+                it->second.enqueued_at = std::chrono::system_clock::time_point{
+                    std::chrono::milliseconds{time_ms}};
+            }
+            it->second.request = std::move(request);
+        }
+    }
+
+    // Caller must hold mutex (or have exclusive access during open)
+    auto compact_locked() -> result<void> {
+        auto path = journal_path();
+        auto temp_path = path;
+        temp_path += ".tmp";
+        {
+            std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                return unexpected{error{error_code::file_write_error,
+                                       "Failed to open replication journal"}};
+            }
+            write_pod(out, journal_magic);
+            write_pod(out, journal_format_version);
+            for (const auto& [key, e] : pending) {
+                write_record(out, static_cast<uint8_t>(e.request.op),
+                             to_millis(e.enqueued_at), e.request);
+            }
+            if (!out.good()) {
+                return unexpected{error{error_code::file_write_error,
+                                       "Failed to write replication journal"}};
+            }
+        }
+
+        journal.close();
+        std::error_code ec;
+        std::filesystem::rename(temp_path, path, ec);
+        if (ec) {
+            std::filesystem::remove(temp_path, ec);
+        }
+        journal.open(path, std::ios::binary | std::ios::app);
+        if (ec || !journal) {
+            return unexpected{error{error_code::file_write_error,
+                                   "Failed to replace replication journal"}};
+        }
+        done_records = 0;
+        return result<void>();
+    }
+
+    // Caller must hold mutex
+    auto retire_locked(const std::string& key) -> void {
+        auto it = pending.find(key);
+        if (it == pending.end()) return;
+
+        replication_request done;
+        done.key = key;
+        pending.erase(it);
+        (void)append_locked(record_done, 0, done);
+
+        if (++done_records >= compaction_min_done && done_records > pending.size()) {
+            (void)compact_locked();
+        }
+    }
+
+    // Caller must hold mutex; takes up to batch_size ready requests
+    auto next_batch_locked() -> std::vector<replication_request> {
+        std::vector<replication_request> batch;
+        while (!closed && batch.size() < config.batch_size && !ready.empty()) {
+            auto key = std::move(ready.front());
+            ready.pop_front();
+            auto it = pending.find(key);
+            if (it == pending.end() || !it->second.queued) {
+                continue;
+            }
+            auto& e = it->second;
+            e.queued = false;
+            e.in_flight = true;
+            e.dirty = false;
+            batch.push_back(e.request);
+        }
+        in_flight_keys += batch.size();
+        return batch;
+    }
+
+    // Caller must hold mutex
+    auto schedule_locked(const std::string& key, entry& e) -> void {
+        if (!e.queued && !e.in_flight) {
+            e.queued = true;
+            ready.push_back(key);
+        }
+    }
+
+    // Caller must hold mutex; returns keys of a batch that could not start
+    // to the front of the ready list
+    auto requeue_locked(const std::vector<replication_request>& batch) -> void {
+        for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+            if (auto found = pending.find(it->key); found != pending.end()) {
+                found->second.in_flight = false;
+                if (!found->second.queued) {
+                    found->second.queued = true;
+                    ready.push_front(it->key);
+                }
+            }
+        }
+        in_flight_keys -= batch.size();
+    }
+
+    /**
+     * @brief Start workers for ready requests, up to max_concurrency
+     *
+     * Must be called without the mutex held: submissions made from an
+     * executor worker would otherwise run inline under the lock.
+     */
+    auto start_workers() -> void {
+        while (true) {
+            std::vector<replication_request> batch;
+            {
+                std::lock_guard lock(mutex);
+                if (active_batches >= config.max_concurrency) return;
+                batch = next_batch_locked();
+                if (batch.empty()) return;
+                ++active_batches;
+            }
+
+            auto task = [this, batch]() { run_worker(batch); };
+            // A blocking task (e.g. a storage *_async call) would run the
+            // batch inline; go through the delayed queue so enqueue() returns
+            auto started = io_executor::on_blocking_task()
+                ? io.submit_after(std::chrono::milliseconds(1), std::move(task))
+                : io.submit(std::move(task));
+
+            if (started.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                try {
+                    started.get();
+                } catch (...) {
+                    // Rejected (queue full or closing); leave it for the next pump
+                    std::lock_guard lock(mutex);
+                    requeue_locked(batch);
+                    --active_batches;
+                    return;
+                }
+            }
+        }
+    }
+
+    auto retry_delay(std::size_t attempts) const -> std::chrono::milliseconds {
+        auto delay = config.initial_retry_delay;
+        for (std::size_t i = 1; i < attempts && delay < config.max_retry_delay; ++i) {
+            delay *= 2;
+        }
+        return std::min(delay, config.max_retry_delay);
+    }
+
+    // Replicates batches until no request is ready
+    auto run_worker(std::vector<replication_request> batch) -> void {
+        while (!batch.empty()) {
+            std::vector<result<void>> outcomes;
+            outcomes.reserve(batch.size());
+            for (const auto& request : batch) {
+                try {
+                    outcomes.push_back(replicate ? replicate(request) : result<void>());
+                } catch (const std::exception& e) {
+                    outcomes.push_back(unexpected{error{error_code::internal_error,
+                        std::string("Replication failed: ") + e.what()}});
+                }
+            }
+
+            std::vector<std::pair<replication_request, error>> dropped;
+            std::vector<std::pair<std::string, std::chrono::milliseconds>> retries;
+            {
+                std::lock_guard lock(mutex);
+                for (std::size_t i = 0; i < batch.size(); ++i) {
+                    const auto& key = batch[i].key;
+                    auto it = pending.find(key);
+                    if (it == pending.end()) continue;
+                    auto& e = it->second;
+                    e.in_flight = false;
+
+                    if (e.dirty) {
+                        // Changed again while replicating; replicate the latest request
+                        e.attempts = 0;
+                        schedule_locked(key, e);
+                    } else if (outcomes[i].has_value()) {
+                        ++stats.replicated;
+                        retire_locked(key);
+                    } else if (++e.attempts >= config.max_attempts) {
+                        ++stats.failed;
+                        dropped.emplace_back(e.request, outcomes[i].error());
+                        retire_locked(key);
+                    } else {
+                        ++stats.retries;
+                        retries.emplace_back(key, retry_delay(e.attempts));
+                    }
+                }
+                in_flight_keys -= batch.size();
+
+                if (!dropped.empty()) {
+                    ++reporting;
+                }
+                batch = next_batch_locked();
+                if (batch.empty()) {
+                    --active_batches;
+                }
+            }
+
+            for (auto& [key, delay] : retries) {
+                (void)io.submit_after(delay, [this, key = std::move(key)]() {
+                    {
+                        std::lock_guard lock(mutex);
+                        auto it = pending.find(key);
+                        if (it == pending.end()) return;
+                        schedule_locked(key, it->second);
+                    }
+                    start_workers();
+                });
+            }
+
+            if (!dropped.empty()) {
+                if (on_failure) {
+                    for (const auto& [request, err] : dropped) {
+                        on_failure(request, err);
+                    }
+                }
+                std::lock_guard lock(mutex);
+                --reporting;
+            }
+            idle.notify_all();
+        }
+    }
+
+    // Batches and retries; declared last so no task outlives the queue
+    io_scope io{"replication"};
+};
+
+replication_queue::replication_queue(const replication_queue_config& config)
+    : impl_(std::make_unique<impl>(config)) {}
+
+replication_queue::replication_queue(replication_queue&&) noexcept = default;
+auto replication_queue::operator=(replication_queue&&) noexcept -> replication_queue& = default;
+
+replication_queue::~replication_queue() {
+    if (impl_) {
+        close();
+    }
+}
+
+auto replication_queue::open(
+    const replication_queue_config& config,
+    replicate_function replicate,
+    failure_callback on_failure) -> result<replication_queue> {
+
+    if (config.journal_directory.empty()) {
+        return unexpected{error{error_code::invalid_configuration,
+                               "Replication journal directory is required"}};
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(config.journal_directory, ec);
+    if (ec) {
+        return unexpected{error{error_code::file_write_error,
+                               "Failed to create replication journal directory: " +
+                                   config.journal_directory.string()}};
+    }
+
+    replication_queue queue(config);
+    auto& state = *queue.impl_;
+    state.replicate = std::move(replicate);
+    state.on_failure = std::move(on_failure);
+
+    state.replay();
+    auto compacted = state.compact_locked();
+    if (!compacted.has_value()) {
+        return unexpected{compacted.error()};
+    }
+
+    {
+        std::lock_guard lock(state.mutex);
+        for (auto& [key, e] : state.pending) {
+            state.schedule_locked(key, e);
+        }
+    }
+    state.start_workers();
+
+    return result<replication_queue>(std::move(queue));
+}
+
+auto replication_queue::enqueue(const replication_request& request) -> result<void> {
+    auto& state = *impl_;
+    std::unique_lock lock(state.mutex);
+
+    if (state.closed) {
+        return unexpected{error{error_code::not_initialized,
+                               "Replication queue is closed"}};
+    }
+
+    auto now = std::chrono::system_clock::now();
+    auto appended = state.append_locked(static_cast<uint8_t>(request.op),
+                                        to_millis(now), request);
+    if (!appended.has_value()) {
+        return appended;
+    }
+
+    auto [it, inserted] = state.pending.try_emplace(request.key);
+    auto& e = it->second;
+    if (inserted) {
+        // Lag is measured from the oldest change not yet replicated
+        e.enqueued_at = now;
+    } else {
+        ++state.stats.coalesced;
+    }
+    e.request = request;
+    e.attempts = 0;
+    ++state.stats.enqueued;
+
+    if (e.in_flight) {
+        e.dirty = true;
+        return result<void>();
+    }
+    state.schedule_locked(request.key, e);
+    lock.unlock();
+
+    state.start_workers();
+    return result<void>();
+}
+
+auto replication_queue::pending(const std::string& key) const
+    -> std::optional<replication_op> {
+    std::lock_guard lock(impl_->mutex);
+    auto it = impl_->pending.find(key);
+    if (it == impl_->pending.end()) {
+        return std::nullopt;
+    }
+    return it->second.request.op;
+}
+
+auto replication_queue::drain(std::chrono::milliseconds timeout) -> bool {
+    std::unique_lock lock(impl_->mutex);
+    return impl_->idle.wait_for(lock, timeout, [this] {
+        return impl_->pending.empty() && impl_->reporting == 0;
+    });
+}
+
+auto replication_queue::close() -> void {
+    {
+        std::lock_guard lock(impl_->mutex);
+        if (impl_->closed) return;
+        impl_->closed = true;
+    }
+    impl_->io.cancel();
+    impl_->io.wait();
+
+    std::lock_guard lock(impl_->mutex);
+    impl_->journal.close();
+}
+
+auto replication_queue::statistics() const -> replication_statistics {
+    std::lock_guard lock(impl_->mutex);
+    auto stats = impl_->stats;
+    stats.pending = impl_->pending.size();
+    stats.in_flight = impl_->in_flight_keys;
+
+    auto now = std::chrono::system_clock::now();
+    for (const auto& [key, e] : impl_->pending) {
+        auto age = std::chrono::duration_cast<std::chrono::milliseconds>(now - e.enqueued_at);
+        stats.lag = std::max(stats.lag, age);
+    }
+    return stats;
+}
+
+}  // namespace kcenon::file_transfer
@@ -6,8 +6,8 @@
 #include "kcenon/file_transfer/server/server_pipeline.h"
 #include "kcenon/file_transfer/server/pipeline_jobs.h"
 
-#include "kcenon/file_transfer/core/bandwidth_limiter.h"
 #include "kcenon/file_transfer/core/checksum.h"
+#include "kcenon/file_transfer/core/chunk_assembler.h"
 #include "kcenon/file_transfer/core/compression_engine.h"
 #include "kcenon/file_transfer/core/logging.h"
 #include "kcenon/file_transfer/encryption/encryption_config.h"
@@ -19,13 +19,235 @@
 #include <kcenon/thread/core/thread_pool.h>
 #include <kcenon/thread/core/job_queue.h>
 
+#include <algorithm>
+#include <condition_variable>
 #include <filesystem>
 #include <fstream>
+#include <map>
+#include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace kcenon::file_transfer {
 
+namespace {
+
+// Everything but the payload, for reporting a chunk after handing it to a
+// job the thread pool refused
+auto without_payload(pipeline_chunk& chunk) -> pipeline_chunk {
+    auto payload = std::move(chunk.data);
+    pipeline_chunk header(chunk);
+    chunk.data = std::move(payload);
+    return header;
+}
+
+// Admission and dispatch of upload chunks. A flow may have flow_limit
+// chunks and flow_bytes of chunk memory admitted, queued in the scheduler
+// or inside the stages; a flow with nothing admitted takes one chunk of any
+// size. At most dispatch_limit chunks of all flows are inside the stages at
+// once. Each admitted chunk carries a slot whose destruction (when the last
+// job holding the chunk finishes, whatever the outcome) frees its place
+// and lets the scheduler dispatch the next chunk.
+struct upload_window {
+    struct flow_usage {
+        std::size_t chunks = 0;
+        std::size_t bytes = 0;
+    };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::size_t flow_limit;
+    std::size_t flow_bytes;
+    std::size_t dispatch_limit;
+    std::size_t in_flight = 0;
+    std::size_t dispatched = 0;
+    std::unordered_map<flow_key, flow_usage> per_flow;
+    flow_scheduler scheduler;
+    bool closed = false;
+
+    // Hands a chunk to the first stage; not called once closed
+    std::function<bool(pipeline_chunk)> dispatch;
+
+    // Reports a chunk the first stage would not take
+    std::function<void(const pipeline_chunk&)> refuse;
+
+    // Told each time a slot frees up while open, after the lock is released
+    std::function<void()> on_release;
+
+    upload_window(std::size_t max_per_flow, std::size_t max_flow_bytes,
+                  std::size_t max_dispatched, std::size_t quantum)
+        : flow_limit(max_per_flow), flow_bytes(max_flow_bytes),
+          dispatch_limit(max_dispatched), scheduler(quantum) {}
+
+    void release(const flow_key& key, std::size_t bytes, bool was_dispatched) {
+        {
+            std::lock_guard lock(mutex);
+            --in_flight;
+            if (was_dispatched) {
+                --dispatched;
+            }
+            auto it = per_flow.find(key);
+            if (it != per_flow.end()) {
+                it->second.bytes -= bytes;
+                if (--it->second.chunks == 0) {
+                    per_flow.erase(it);
+                }
+            }
+        }
+        cv.notify_all();
+        pump();
+
+        std::function<void()> notify;
+        {
+            std::lock_guard lock(mutex);
+            if (!closed) {
+                notify = on_release;
+            }
+        }
+        if (notify) {
+            notify();
+        }
+    }
+
+    // Queue an admitted chunk and dispatch whatever the scheduler picks
+    void admit(pipeline_chunk chunk) {
+        {
+            std::lock_guard lock(mutex);
+            scheduler.push(std::move(chunk));
+        }
+        pump();
+    }
+
+    void pump() {
+        std::vector<pipeline_chunk> ready;
+        {
+            std::lock_guard lock(mutex);
+            if (closed) {
+                return;
+            }
+            while (dispatched < dispatch_limit) {
+                auto next = scheduler.pop();
+                if (!next) {
+                    break;
+                }
+                mark_dispatched(*next);
+                ready.push_back(std::move(*next));
+            }
+        }
+        for (auto& chunk : ready) {
+            dispatch_or_refuse(std::move(chunk));
+        }
+    }
+
+    // Hand every queued chunk to the stages, ignoring dispatch_limit
+    void flush() {
+        std::vector<pipeline_chunk> ready;
+        {
+            std::lock_guard lock(mutex);
+            while (auto next = scheduler.pop()) {
+                mark_dispatched(*next);
+                ready.push_back(std::move(*next));
+            }
+        }
+        for (auto& chunk : ready) {
+            dispatch_or_refuse(std::move(chunk));
+        }
+    }
+
+    // Queued chunks hold slots referring back to this window; they must
+    // be destroyed outside the lock
+    auto drop_queued() -> std::vector<pipeline_chunk> {
+        std::lock_guard lock(mutex);
+        return scheduler.clear();
+    }
+
+    void set_closed(bool value) {
+        {
+            std::lock_guard lock(mutex);
+            closed = value;
+        }
+        cv.notify_all();
+    }
+
+    void mark_dispatched(pipeline_chunk& chunk);
+
+    // A refused chunk is reported from a copy without its payload; the
+    // original is destroyed with the job, which frees its slot
+    void dispatch_or_refuse(pipeline_chunk chunk) {
+        auto header = without_payload(chunk);
+        if (!dispatch(std::move(chunk))) {
+            refuse(header);
+        }
+    }
+};
+
+class upload_slot {
+public:
+    upload_slot(std::shared_ptr<upload_window> window, flow_key key, std::size_t bytes)
+        : window_(std::move(window)), key_(key), bytes_(bytes) {}
+    upload_slot(const upload_slot&) = delete;
+    auto operator=(const upload_slot&) -> upload_slot& = delete;
+    ~upload_slot() { window_->release(key_, bytes_, dispatched_); }
+
+    void set_dispatched() { dispatched_ = true; }
+
+private:
+    std::shared_ptr<upload_window> window_;
+    flow_key key_;
+    std::size_t bytes_;
+    bool dispatched_ = false;
+};
+
+void upload_window::mark_dispatched(pipeline_chunk& chunk) {
+    ++dispatched;
+    static_cast<upload_slot*>(chunk.upload_slot.get())->set_dispatched();
+}
+
+// Memory a chunk holds in the stages: a compressed chunk grows to its
+// original size once decompressed
+auto upload_footprint(const pipeline_chunk& chunk) -> std::size_t {
+    if (chunk.is_compressed) {
+        return std::max(chunk.data.size(), chunk.original_size);
+    }
+    return chunk.data.size();
+}
+
+// Takes a slot in the chunk's flow, waiting up to timeout; returns nullptr
+// if none freed up
+auto acquire_upload_slot(const std::shared_ptr<upload_window>& window,
+                         const pipeline_chunk& chunk,
+                         std::chrono::milliseconds timeout) -> std::shared_ptr<void> {
+    flow_key key{chunk.client, chunk.id};
+    auto bytes = upload_footprint(chunk);
+    std::unique_lock lock(window->mutex);
+    auto has_room = [&] {
+        auto it = window->per_flow.find(key);
+        return it == window->per_flow.end() ||
+               (it->second.chunks < window->flow_limit &&
+                it->second.bytes + bytes <= window->flow_bytes);
+    };
+    if (!window->cv.wait_for(lock, timeout, [&] { return window->closed || has_room(); }) ||
+        window->closed) {
+        return nullptr;
+    }
+    ++window->in_flight;
+    auto& usage = window->per_flow[key];
+    ++usage.chunks;
+    usage.bytes += bytes;
+    lock.unlock();
+    return std::make_shared<upload_slot>(window, key, bytes);
+}
+
+auto dispatch_limit_for(const pipeline_config& config) -> std::size_t {
+    if (config.dispatch_limit > 0) {
+        return config.dispatch_limit;
+    }
+    return 2 * (config.io_workers + config.compression_workers + config.network_workers);
+}
+
+}  // namespace
+
 struct server_pipeline::impl {
     pipeline_config config;
     std::atomic<bool> running{false};
@@ -37,14 +259,31 @@ struct server_pipeline::impl {
     // Pipeline context shared with jobs
     std::shared_ptr<pipeline_context> context;
 
-    // Bandwidth limiters
-    std::unique_ptr<bandwidth_limiter> send_limiter;
-    std::unique_ptr<bandwidth_limiter> recv_limiter;
+    // Bandwidth shapers; throttled chunks park on them instead of blocking
+    std::unique_ptr<bandwidth_shaper> send_shaper;
+    std::unique_ptr<bandwidth_shaper> recv_shaper;
 
     // Worker ID counter for round-robin assignment
     std::atomic<std::size_t> next_worker_id{0};
 
-    explicit impl(pipeline_config cfg) : config(std::move(cfg)) {
+    // Upload chunks in flight, bounded per flow by queue_size chunks and
+    // max_memory_per_transfer bytes
+    std::shared_ptr<upload_window> uploads;
+
+    explicit impl(pipeline_config cfg)
+        : config(std::move(cfg))
+        , uploads(std::make_shared<upload_window>(
+              config.queue_size, config.max_memory_per_transfer,
+              dispatch_limit_for(config), config.scheduler_quantum)) {
+        uploads->dispatch = [this](pipeline_chunk data) {
+            return enqueue_upload(std::move(data));
+        };
+        uploads->refuse = [this](const pipeline_chunk& data) {
+            context->report_chunk_error(pipeline_stage::network_recv, data,
+                                        "Failed to enqueue decompress job for chunk " +
+                                            std::to_string(data.chunk_index));
+        };
+
         // Create thread pool
         auto total_threads = config.io_workers + config.compression_workers +
                             config.network_workers;
@@ -69,6 +308,8 @@ struct server_pipeline::impl {
         context->send_queue = std::make_shared<thread::job_queue>(
             config.queue_size);
 
+        context->streams = std::make_shared<transfer_registry<upload_stream>>();
+
         // Create compression engines for workers
         auto total_compression_workers = config.compression_workers;
         context->compression_engines.reserve(total_compression_workers);
@@ -99,18 +340,13 @@ struct server_pipeline::impl {
         // Set statistics pointer in context
         context->statistics = &statistics;
         context->running = &running;
+        context->integrity = std::make_shared<integrity_policy>();
 
-        // Initialize bandwidth limiters if configured
-        if (config.send_bandwidth_limit > 0) {
-            send_limiter = std::make_unique<bandwidth_limiter>(
-                config.send_bandwidth_limit);
-            context->send_limiter = send_limiter.get();
-        }
-        if (config.recv_bandwidth_limit > 0) {
-            recv_limiter = std::make_unique<bandwidth_limiter>(
-                config.recv_bandwidth_limit);
-            context->recv_limiter = recv_limiter.get();
-        }
+        // Shapers always exist so per-client limits can be added later;
+        // with no limits an acquire is a couple of atomic loads
+        send_shaper = std::make_unique<bandwidth_shaper>(config.send_bandwidth_limit);
+        recv_shaper = std::make_unique<bandwidth_shaper>(config.recv_bandwidth_limit);
+        context->send_shaper = send_shaper.get();
 
         // Add workers to thread pool
         for (std::size_t i = 0; i < total_threads; ++i) {
@@ -125,6 +361,8 @@ struct server_pipeline::impl {
         // from circular references (jobs hold shared_ptr<pipeline_context>,
         // which holds shared_ptr<thread_pool>)
         running = false;
+        uploads->set_closed(true);
+        (void)uploads->drop_queued();
         stop_queues();
         clear_queues();  // Break circular references by clearing pending jobs
 
@@ -141,6 +379,13 @@ struct server_pipeline::impl {
             thread_pool->stop(true);
         }
 
+        // Parked chunks hold the context and upload slots. End the timers
+        // once the workers are gone, then drop whatever they admitted.
+        context->send_shaper = nullptr;
+        send_shaper.reset();
+        recv_shaper.reset();
+        (void)uploads->drop_queued();
+
         // Explicitly break circular reference by clearing context's thread_pool pointer
         if (context) {
             context->thread_pool.reset();
@@ -152,6 +397,16 @@ struct server_pipeline::impl {
     }
 
     auto stop(bool wait_for_completion) -> void {
+        uploads->set_closed(true);
+        // Send jobs are skipped once stopped, so parked sends can go
+        send_shaper->drop_parked();
+        if (wait_for_completion) {
+            recv_shaper->release_parked();
+            uploads->flush();
+        } else {
+            recv_shaper->drop_parked();
+            (void)uploads->drop_queued();
+        }
         stop_queues();
 
         if (!wait_for_completion) {
@@ -194,6 +449,34 @@ struct server_pipeline::impl {
     auto get_worker_id() -> std::size_t {
         return next_worker_id.fetch_add(1, std::memory_order_relaxed);
     }
+
+    // Admit an upload chunk once recv shaping grants its bytes. A throttled
+    // chunk is parked with its upload slot, so its flow stays bounded while
+    // the submitting thread moves on.
+    auto admit_upload(pipeline_chunk data) -> void {
+        if (recv_shaper->try_acquire(data.client.value, data.id, data.data.size())) {
+            uploads->admit(std::move(data));
+            return;
+        }
+        auto parked = std::make_shared<pipeline_chunk>(std::move(data));
+        auto resume = [window = uploads, parked] { window->admit(std::move(*parked)); };
+        if (recv_shaper->acquire_or_park(parked->client.value, parked->id,
+                                         parked->data.size(), resume)) {
+            uploads->admit(std::move(*parked));
+        }
+    }
+
+    // Enqueue a chunk picked by the scheduler
+    auto enqueue_upload(pipeline_chunk data) -> bool {
+        auto job = std::make_unique<decompress_job>(
+            context, std::move(data), get_worker_id());
+        auto enqueue_result = thread_pool->enqueue(std::move(job));
+        if (!enqueue_result.is_ok()) {
+            statistics.backpressure_events++;
+            return false;
+        }
+        return true;
+    }
 };
 
 // pipeline_config implementation
@@ -234,43 +517,62 @@ auto pipeline_stats::reset() -> void {
     chunks_encrypted = 0;
     chunks_decrypted = 0;
     encryption_bytes = 0;
+    checksums_verified = 0;
+    checksums_skipped = 0;
+    checksum_bytes_skipped = 0;
+    integrity_cpu_saved_ns = 0;
 }
 
 // pipeline_chunk implementation
 pipeline_chunk::pipeline_chunk(const chunk& c)
     : id(c.header.id)
     , chunk_index(c.header.chunk_index)
+    , chunk_offset(c.header.chunk_offset)
     , data(c.data)
-    , checksum(c.header.checksum)
+    , checksum(c.digest())
+    , integrity(c.header.integrity)
     , is_compressed(c.is_compressed())
     , original_size(c.header.original_size)
+    , flags(c.header.flags)
     , is_encrypted(false)
     , enc_metadata(nullptr) {}
 
 pipeline_chunk::pipeline_chunk(const pipeline_chunk& other)
     : id(other.id)
+    , client(other.client)
     , chunk_index(other.chunk_index)
+    , chunk_offset(other.chunk_offset)
     , data(other.data)
     , checksum(other.checksum)
+    , integrity(other.integrity)
     , is_compressed(other.is_compressed)
     , original_size(other.original_size)
+    , flags(other.flags)
+    , entropy(other.entropy)
     , is_encrypted(other.is_encrypted)
     , enc_metadata(other.enc_metadata
         ? std::make_unique<encryption_metadata>(*other.enc_metadata)
-        : nullptr) {}
+        : nullptr)
+    , verified(other.verified) {}
 
 auto pipeline_chunk::operator=(const pipeline_chunk& other) -> pipeline_chunk& {
     if (this != &other) {
         id = other.id;
+        client = other.client;
         chunk_index = other.chunk_index;
+        chunk_offset = other.chunk_offset;
         data = other.data;
         checksum = other.checksum;
+        integrity = other.integrity;
         is_compressed = other.is_compressed;
         original_size = other.original_size;
+        flags = other.flags;
+        entropy = other.entropy;
         is_encrypted = other.is_encrypted;
         enc_metadata = other.enc_metadata
             ? std::make_unique<encryption_metadata>(*other.enc_metadata)
             : nullptr;
+        verified = other.verified;
     }
     return *this;
 }
@@ -322,6 +624,7 @@ auto server_pipeline::start() -> result<void> {
         " network workers");
 
     impl_->running = true;
+    impl_->uploads->set_closed(false);
     auto result = impl_->start();
     if (!result.is_ok()) {
         impl_->running = false;
@@ -365,54 +668,171 @@ auto server_pipeline::submit_upload_chunk(pipeline_chunk data) -> result<void> {
                                "Pipeline is not running"}};
     }
 
-    // Apply recv bandwidth limit if configured
-    if (impl_->recv_limiter) {
-        impl_->recv_limiter->acquire(data.data.size());
+    data.upload_slot = acquire_upload_slot(impl_->uploads, data, std::chrono::milliseconds(0));
+    if (!data.upload_slot) {
+        impl_->statistics.backpressure_events++;
+        return unexpected{error{error_code::queue_full,
+                               "Queue full - backpressure applied"}};
     }
 
-    // Create decompress job and submit to thread pool
-    auto worker_id = impl_->get_worker_id();
-    auto job = std::make_unique<decompress_job>(
-        impl_->context, std::move(data), worker_id);
+    impl_->admit_upload(std::move(data));
+    return {};
+}
 
-    auto enqueue_result = impl_->thread_pool->enqueue(std::move(job));
-    if (!enqueue_result.is_ok()) {
-        impl_->statistics.backpressure_events++;
-        return unexpected{error{error_code::internal_error,
-                               "Queue full - backpressure applied"}};
+auto server_pipeline::submit_upload_chunk(pipeline_chunk data,
+                                          std::chrono::milliseconds timeout) -> result<void> {
+    if (!impl_->running) {
+        return unexpected{error{error_code::not_initialized,
+                               "Pipeline is not running"}};
+    }
+
+    data.upload_slot = acquire_upload_slot(impl_->uploads, data, timeout);
+    if (!data.upload_slot) {
+        if (!impl_->running) {
+            return unexpected{error{error_code::not_initialized,
+                                   "Pipeline is not running"}};
+        }
+        impl_->statistics.stalls_detected++;
+        return unexpected{error{error_code::queue_full,
+                               "Timed out waiting for pipeline capacity"}};
     }
 
+    impl_->admit_upload(std::move(data));
     return {};
 }
 
+auto server_pipeline::upload_in_flight() const -> std::size_t {
+    std::lock_guard lock(impl_->uploads->mutex);
+    return impl_->uploads->in_flight;
+}
+
+auto server_pipeline::set_client_weight(client_id client, uint32_t weight) -> void {
+    std::lock_guard lock(impl_->uploads->mutex);
+    impl_->uploads->scheduler.set_client_weight(client, weight);
+}
+
+auto server_pipeline::set_transfer_priority(const transfer_id& id,
+                                            flow_priority priority) -> void {
+    std::lock_guard lock(impl_->uploads->mutex);
+    impl_->uploads->scheduler.set_transfer_priority(id, priority);
+}
+
+auto server_pipeline::close_transfer(const transfer_id& id) -> void {
+    std::vector<pipeline_chunk> dropped;
+    {
+        std::lock_guard lock(impl_->uploads->mutex);
+        dropped = impl_->uploads->scheduler.remove_transfer(id);
+    }
+    impl_->send_shaper->remove_transfer(id);
+    impl_->recv_shaper->remove_transfer(id);
+    close_stream(id);
+}
+
+auto server_pipeline::open_stream(const transfer_id& id, const stream_compression_config& config)
+    -> void {
+    impl_->context->streams->insert(id, std::make_shared<upload_stream>(config));
+}
+
+auto server_pipeline::close_stream(const transfer_id& id) -> void {
+    auto stream = impl_->context->streams->erase(id);
+    if (!stream) {
+        return;
+    }
+    std::map<uint64_t, pipeline_chunk> waiting;
+    {
+        std::lock_guard lock(stream->mutex);
+        waiting.swap(stream->waiting);
+    }
+    for (const auto& [index, chunk] : waiting) {
+        impl_->context->report_chunk_error(pipeline_stage::decompress, chunk,
+                                           "Stream closed before chunk " +
+                                               std::to_string(index) + " could be decompressed");
+    }
+}
+
+auto server_pipeline::record_rebuilt_chunk(const transfer_id& id, const chunk& rebuilt)
+    -> void {
+    auto stream = impl_->context->streams->find(id);
+    if (!stream) {
+        return;
+    }
+    std::vector<pipeline_chunk> released;
+    {
+        std::lock_guard lock(stream->mutex);
+        stream->decoder.record(rebuilt.header.chunk_index,
+                               rebuilt.header.flags & ~chunk_flags::compressed, rebuilt.data,
+                               rebuilt.header.original_size);
+        for (auto it = stream->waiting.begin(); it != stream->waiting.end();) {
+            if (stream->decoder.ready(it->first, it->second.flags)) {
+                released.push_back(std::move(it->second));
+                it = stream->waiting.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    // Decompressed by the stage like any chunk; each releases its own chain
+    for (auto& chunk : released) {
+        FT_LOG_TRACE(log_category::pipeline,
+                     "Chunk " + std::to_string(chunk.chunk_index) +
+                         " released by rebuilt chunk " +
+                         std::to_string(rebuilt.header.chunk_index));
+        auto header = without_payload(chunk);
+        if (!impl_->enqueue_upload(std::move(chunk))) {
+            impl_->context->report_chunk_error(pipeline_stage::decompress, header,
+                                               "Failed to enqueue decompress job");
+        }
+    }
+}
+
+auto server_pipeline::flow_statistics() const -> std::vector<flow_stats> {
+    std::lock_guard lock(impl_->uploads->mutex);
+    return impl_->uploads->scheduler.stats();
+}
+
+auto server_pipeline::set_chunk_assembler(std::shared_ptr<chunk_assembler> assembler) -> void {
+    impl_->context->assembler = std::move(assembler);
+}
+
 auto server_pipeline::try_submit_upload_chunk(pipeline_chunk data) -> bool {
     if (!impl_->running) return false;
 
-    // Try to apply recv bandwidth limit without blocking
-    if (impl_->recv_limiter && !impl_->recv_limiter->try_acquire(data.data.size())) {
+    data.upload_slot = acquire_upload_slot(impl_->uploads, data, std::chrono::milliseconds(0));
+    if (!data.upload_slot) {
+        impl_->statistics.backpressure_events++;
         return false;
     }
 
-    // Create decompress job and submit to thread pool
-    auto worker_id = impl_->get_worker_id();
-    auto job = std::make_unique<decompress_job>(
-        impl_->context, std::move(data), worker_id);
+    impl_->admit_upload(std::move(data));
+    return true;
+}
 
-    auto enqueue_result = impl_->thread_pool->enqueue(std::move(job));
-    if (!enqueue_result.is_ok()) {
-        impl_->statistics.backpressure_events++;
+auto server_pipeline::offer_upload_chunk(pipeline_chunk& data) -> bool {
+    if (!impl_->running) return false;
+
+    auto slot = acquire_upload_slot(impl_->uploads, data, std::chrono::milliseconds(0));
+    if (!slot) {
         return false;
     }
 
+    data.upload_slot = std::move(slot);
+    impl_->admit_upload(std::move(data));
     return true;
 }
 
+auto server_pipeline::on_upload_capacity(std::function<void()> callback) -> void {
+    std::lock_guard lock(impl_->uploads->mutex);
+    impl_->uploads->on_release = std::move(callback);
+}
+
 auto server_pipeline::submit_download_request(
     const transfer_id& id,
     uint64_t chunk_index,
     const std::filesystem::path& file_path,
     uint64_t offset,
-    std::size_t size) -> result<void> {
+    std::size_t size,
+    client_id client,
+    chunk_integrity integrity) -> result<void> {
     if (!impl_->running) {
         return unexpected{error{error_code::not_initialized,
                                "Pipeline is not running"}};
@@ -420,7 +840,7 @@ auto server_pipeline::submit_download_request(
 
     // Create read job and submit to thread pool
     auto job = std::make_unique<read_job>(
-        impl_->context, id, chunk_index, file_path, offset, size);
+        impl_->context, id, chunk_index, file_path, offset, size, client, integrity);
 
     auto enqueue_result = impl_->thread_pool->enqueue(std::move(job));
     if (!enqueue_result.is_ok()) {
@@ -440,6 +860,10 @@ auto server_pipeline::on_error(error_callback callback) -> void {
     impl_->context->on_error_cb = std::move(callback);
 }
 
+auto server_pipeline::on_chunk_error(chunk_error_callback callback) -> void {
+    impl_->context->on_chunk_error_cb = std::move(callback);
+}
+
 auto server_pipeline::on_upload_complete(completion_callback callback) -> void {
     impl_->context->on_upload_complete_cb = std::move(callback);
 }
@@ -484,34 +908,12 @@ auto server_pipeline::config() const -> const pipeline_config& {
 }
 
 auto server_pipeline::set_send_bandwidth_limit(std::size_t bytes_per_second) -> void {
-    if (bytes_per_second > 0) {
-        if (impl_->send_limiter) {
-            impl_->send_limiter->set_limit(bytes_per_second);
-        } else {
-            impl_->send_limiter = std::make_unique<bandwidth_limiter>(bytes_per_second);
-            impl_->context->send_limiter = impl_->send_limiter.get();
-        }
-    } else {
-        if (impl_->send_limiter) {
-            impl_->send_limiter->disable();
-        }
-    }
+    impl_->send_shaper->set_global_limit(bytes_per_second);
     impl_->config.send_bandwidth_limit = bytes_per_second;
 }
 
 auto server_pipeline::set_recv_bandwidth_limit(std::size_t bytes_per_second) -> void {
-    if (bytes_per_second > 0) {
-        if (impl_->recv_limiter) {
-            impl_->recv_limiter->set_limit(bytes_per_second);
-        } else {
-            impl_->recv_limiter = std::make_unique<bandwidth_limiter>(bytes_per_second);
-            impl_->context->recv_limiter = impl_->recv_limiter.get();
-        }
-    } else {
-        if (impl_->recv_limiter) {
-            impl_->recv_limiter->disable();
-        }
-    }
+    impl_->recv_shaper->set_global_limit(bytes_per_second);
     impl_->config.recv_bandwidth_limit = bytes_per_second;
 }
 
@@ -523,4 +925,30 @@ auto server_pipeline::get_recv_bandwidth_limit() const -> std::size_t {
     return impl_->config.recv_bandwidth_limit;
 }
 
+auto server_pipeline::set_client_send_limits(client_id client, shaper_limits limits) -> void {
+    impl_->send_shaper->set_tenant_limits(client.value, limits);
+}
+
+auto server_pipeline::set_client_recv_limits(client_id client, shaper_limits limits) -> void {
+    impl_->recv_shaper->set_tenant_limits(client.value, limits);
+}
+
+auto server_pipeline::set_transfer_send_limits(client_id client, const transfer_id& id,
+                                               shaper_limits limits) -> void {
+    impl_->send_shaper->set_transfer_limits(client.value, id, limits);
+}
+
+auto server_pipeline::set_transfer_recv_limits(client_id client, const transfer_id& id,
+                                               shaper_limits limits) -> void {
+    impl_->recv_shaper->set_transfer_limits(client.value, id, limits);
+}
+
+auto server_pipeline::send_shaping_stats() const -> shaper_stats {
+    return impl_->send_shaper->stats();
+}
+
+auto server_pipeline::recv_shaping_stats() const -> shaper_stats {
+    return impl_->recv_shaper->stats();
+}
+
 }  // namespace kcenon::file_transfer
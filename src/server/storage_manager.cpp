@@ -5,14 +5,62 @@
 
 #include "kcenon/file_transfer/server/storage_manager.h"
 
+#include "kcenon/file_transfer/core/io_executor.h"
+#include "kcenon/file_transfer/core/logging.h"
+#include "kcenon/file_transfer/server/metadata_index.h"
+#include "kcenon/file_transfer/server/object_cache.h"
+
 #include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <mutex>
 #include <shared_mutex>
+#include <unordered_set>
 
 namespace kcenon::file_transfer {
 
+namespace {
+
+constexpr const char* metadata_index_directory = ".file_trans_index";
+constexpr const char* replication_journal_directory = ".file_trans_replication";
+constexpr const char* copy_staging_directory = ".file_trans_staging";
+constexpr std::string_view internal_directory_prefix = ".file_trans_";
+
+auto to_system_time(std::filesystem::file_time_type time)
+    -> std::chrono::system_clock::time_point {
+    return std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+        time - std::filesystem::file_time_type::clock::now() +
+        std::chrono::system_clock::now());
+}
+
+// Version tag a cached copy is validated against; size and mtime stand in
+// for backends that report no ETag
+auto cache_version(const stored_object_metadata& metadata) -> std::string {
+    if (metadata.etag && !metadata.etag->empty()) {
+        return *metadata.etag;
+    }
+    return std::to_string(metadata.size) + ":" +
+           std::to_string(metadata.last_modified.time_since_epoch().count());
+}
+
+auto read_whole_file(const std::filesystem::path& path, uint64_t size)
+    -> result<std::vector<std::byte>> {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return unexpected{error{error_code::file_read_error,
+                               "Failed to open cached object: " + path.string()}};
+    }
+    std::vector<std::byte> data(size);
+    file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    if (static_cast<uint64_t>(file.gcount()) != size) {
+        return unexpected{error{error_code::file_read_error,
+                               "Cached object is truncated: " + path.string()}};
+    }
+    return data;
+}
+
+}  // namespace
+
 // ============================================================================
 // local_storage_backend implementation
 // ============================================================================
@@ -24,18 +72,80 @@ struct local_storage_backend::impl {
     mutable std::shared_mutex mutex;
     std::function<void(const storage_progress&)> progress_callback;
 
+    // Guards the index handle itself; the index is internally synchronized
+    mutable std::shared_mutex index_mutex;
+    std::optional<metadata_index> index;
+
     explicit impl(std::filesystem::path path) : base_path(std::move(path)) {}
 
     auto full_path_for(const std::string& key) const -> std::filesystem::path {
         return base_path / key;
     }
 
+    auto open_index() -> void {
+        std::unique_lock lock(index_mutex);
+        if (index) return;
+
+        auto opened = metadata_index::open(base_path / metadata_index_directory);
+        if (!opened.has_value()) {
+            FT_LOG_WARN(log_category::server,
+                "Metadata index unavailable, listing falls back to directory scan: " +
+                opened.error().message);
+            return;
+        }
+        if (opened.value().needs_rebuild()) {
+            auto rebuilt = opened.value().rebuild(base_path);
+            if (!rebuilt.has_value()) {
+                FT_LOG_WARN(log_category::server,
+                    "Metadata index rebuild failed: " + rebuilt.error().message);
+                return;
+            }
+        }
+        index.emplace(std::move(opened.value()));
+    }
+
+    /**
+     * @brief Record a stored file in the index
+     */
+    void index_stored(const std::string& key,
+                      uint64_t size,
+                      const store_options& options) {
+        std::shared_lock lock(index_mutex);
+        if (!index) return;
+
+        stored_object_metadata metadata;
+        metadata.key = std::filesystem::path(key).generic_string();
+        metadata.size = size;
+        metadata.backend = storage_backend_type::local;
+        metadata.tier = options.tier;
+        metadata.content_hash = options.content_hash;
+        metadata.content_type = options.content_type;
+        metadata.custom_metadata = options.custom_metadata;
+
+        std::error_code ec;
+        auto last_write = std::filesystem::last_write_time(full_path_for(key), ec);
+        metadata.last_modified = ec ? std::chrono::system_clock::now()
+                                    : to_system_time(last_write);
+
+        (void)index->put(metadata);
+    }
+
+    void index_removed(const std::string& key) {
+        std::shared_lock lock(index_mutex);
+        if (index) {
+            (void)index->erase(std::filesystem::path(key).generic_string());
+        }
+    }
+
     void report_progress(const storage_progress& progress) {
         std::shared_lock lock(mutex);
         if (progress_callback) {
             progress_callback(progress);
         }
     }
+
+    // Async operations; declared last so no queued task outlives the backend
+    io_scope io{"local/" + base_path.string()};
 };
 
 local_storage_backend::local_storage_backend(const std::filesystem::path& base_path)
@@ -75,12 +185,17 @@ auto local_storage_backend::connect() -> result<void> {
         }
     }
 
+    impl_->open_index();
     impl_->connected = true;
     return result<void>();
 }
 
 auto local_storage_backend::disconnect() -> result<void> {
     impl_->connected = false;
+
+    // Closing the index marks it clean, so the next connect skips the rebuild
+    std::unique_lock lock(impl_->index_mutex);
+    impl_->index.reset();
     return result<void>();
 }
 
@@ -150,6 +265,7 @@ auto local_storage_backend::store(
     }
 
     file.close();
+    impl_->index_stored(key, data.size(), options);
 
     auto end_time = std::chrono::steady_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
@@ -204,9 +320,13 @@ auto local_storage_backend::store_file(
         std::filesystem::create_directories(parent_path, ec);
     }
 
-    // Copy file
-    std::filesystem::copy_file(file_path, target_path,
-        std::filesystem::copy_options::overwrite_existing, ec);
+    // Re-storing the backend's own file (a tier change) only updates the index
+    if (!std::filesystem::equivalent(file_path, target_path, ec)) {
+        std::filesystem::copy_file(file_path, target_path,
+            std::filesystem::copy_options::overwrite_existing, ec);
+    } else {
+        ec.clear();
+    }
 
     if (ec) {
         return unexpected{error{
@@ -215,6 +335,8 @@ auto local_storage_backend::store_file(
         }};
     }
 
+    impl_->index_stored(key, file_size, options);
+
     auto end_time = std::chrono::steady_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
 
@@ -356,6 +478,7 @@ auto local_storage_backend::remove(const std::string& key) -> result<void> {
         }};
     }
 
+    impl_->index_removed(key);
     return result<void>();
 }
 
@@ -398,12 +521,34 @@ auto local_storage_backend::get_metadata(const std::string& key)
         metadata.last_modified = sctp;
     }
 
+    // Attributes recorded at store time are only available from the index
+    {
+        std::shared_lock lock(impl_->index_mutex);
+        if (impl_->index) {
+            if (auto indexed = impl_->index->find(
+                    std::filesystem::path(key).generic_string())) {
+                metadata.tier = indexed->tier;
+                metadata.content_hash = std::move(indexed->content_hash);
+                metadata.content_type = std::move(indexed->content_type);
+                metadata.custom_metadata = std::move(indexed->custom_metadata);
+            }
+        }
+    }
+
     return result<stored_object_metadata>(std::move(metadata));
 }
 
 auto local_storage_backend::list(const list_storage_options& options)
     -> result<list_storage_result> {
 
+    {
+        std::shared_lock lock(impl_->index_mutex);
+        if (impl_->index) {
+            return result<list_storage_result>(impl_->index->query(options));
+        }
+    }
+
+    // Not connected (or index unavailable): scan the directory tree
     list_storage_result res;
 
     std::error_code ec;
@@ -422,6 +567,11 @@ auto local_storage_backend::list(const list_storage_options& options)
         // Use generic_string for cross-platform path handling (forward slashes)
         std::string key = relative_path.generic_string();
 
+        // Skip internal directories such as the metadata index
+        if (key.starts_with(internal_directory_prefix)) {
+            continue;
+        }
+
         // Apply prefix filter
         if (options.prefix && !key.starts_with(*options.prefix)) {
             continue;
@@ -461,7 +611,7 @@ auto local_storage_backend::store_async(
     // Copy data since span may not outlive the async operation
     auto data_copy = std::make_shared<std::vector<std::byte>>(data.begin(), data.end());
 
-    return std::async(std::launch::async, [this, key, data_copy, options]() {
+    return impl_->io.submit([this, key, data_copy, options]() {
         return this->store(key, *data_copy, options);
     });
 }
@@ -471,7 +621,7 @@ auto local_storage_backend::store_file_async(
     const std::filesystem::path& file_path,
     const store_options& options) -> std::future<result<store_result>> {
 
-    return std::async(std::launch::async, [this, key, file_path, options]() {
+    return impl_->io.submit([this, key, file_path, options]() {
         return this->store_file(key, file_path, options);
     });
 }
@@ -480,7 +630,7 @@ auto local_storage_backend::retrieve_async(
     const std::string& key,
     const retrieve_options& options) -> std::future<result<std::vector<std::byte>>> {
 
-    return std::async(std::launch::async, [this, key, options]() {
+    return impl_->io.submit([this, key, options]() {
         return this->retrieve(key, options);
     });
 }
@@ -490,7 +640,7 @@ auto local_storage_backend::retrieve_file_async(
     const std::filesystem::path& file_path,
     const retrieve_options& options) -> std::future<result<retrieve_result>> {
 
-    return std::async(std::launch::async, [this, key, file_path, options]() {
+    return impl_->io.submit([this, key, file_path, options]() {
         return this->retrieve_file(key, file_path, options);
     });
 }
@@ -510,33 +660,45 @@ auto local_storage_backend::full_path(const std::string& key) const
     return impl_->full_path_for(key);
 }
 
+auto local_storage_backend::rebuild_index() -> result<std::size_t> {
+    std::shared_lock lock(impl_->index_mutex);
+    if (!impl_->index) {
+        return unexpected{error{
+            error_code::invalid_configuration,
+            "Metadata index is not open; connect the backend first"
+        }};
+    }
+    return impl_->index->rebuild(impl_->base_path);
+}
+
 // ============================================================================
 // cloud_storage_backend implementation
 // ============================================================================
 
 struct cloud_storage_backend::impl {
-    std::unique_ptr<cloud_storage_interface> storage;
+    std::shared_ptr<cloud_storage_interface> storage;
     storage_backend_type backend_type;
     std::string backend_name;
 
     mutable std::shared_mutex mutex;
     std::function<void(const storage_progress&)> progress_callback;
 
-    impl(std::unique_ptr<cloud_storage_interface> s, storage_backend_type type)
-        : storage(std::move(s)), backend_type(type) {
+    impl(std::shared_ptr<cloud_storage_interface> s, storage_backend_type type)
+        : storage(std::move(s)), backend_type(type), backend_name(name_for(type)) {
+        // The *_async calls wait on the cloud client's own part/range lanes
+        io.set_blocking();
+    }
+
+    static auto name_for(storage_backend_type type) -> std::string {
         switch (type) {
             case storage_backend_type::cloud_s3:
-                backend_name = "cloud_s3";
-                break;
+                return "cloud_s3";
             case storage_backend_type::cloud_azure:
-                backend_name = "cloud_azure";
-                break;
+                return "cloud_azure";
             case storage_backend_type::cloud_gcs:
-                backend_name = "cloud_gcs";
-                break;
+                return "cloud_gcs";
             default:
-                backend_name = "cloud_unknown";
-                break;
+                return "cloud_unknown";
         }
     }
 
@@ -546,10 +708,13 @@ struct cloud_storage_backend::impl {
             progress_callback(progress);
         }
     }
+
+    // Async operations; declared last so no queued task outlives the backend
+    io_scope io{"backend/" + backend_name};
 };
 
 cloud_storage_backend::cloud_storage_backend(
-    std::unique_ptr<cloud_storage_interface> storage,
+    std::shared_ptr<cloud_storage_interface> storage,
     storage_backend_type backend_type)
     : impl_(std::make_unique<impl>(std::move(storage), backend_type)) {}
 
@@ -569,6 +734,18 @@ auto cloud_storage_backend::create(
         new cloud_storage_backend(std::move(storage), backend_type));
 }
 
+auto cloud_storage_backend::create(
+    std::shared_ptr<cloud_storage_interface> storage,
+    storage_backend_type backend_type) -> std::unique_ptr<cloud_storage_backend> {
+
+    if (!storage) {
+        return nullptr;
+    }
+
+    return std::unique_ptr<cloud_storage_backend>(
+        new cloud_storage_backend(std::move(storage), backend_type));
+}
+
 auto cloud_storage_backend::type() const -> storage_backend_type {
     return impl_->backend_type;
 }
@@ -858,7 +1035,7 @@ auto cloud_storage_backend::store_async(
 
     auto data_copy = std::make_shared<std::vector<std::byte>>(data.begin(), data.end());
 
-    return std::async(std::launch::async, [this, key, data_copy, options]() {
+    return impl_->io.submit([this, key, data_copy, options]() {
         return this->store(key, *data_copy, options);
     });
 }
@@ -868,7 +1045,7 @@ auto cloud_storage_backend::store_file_async(
     const std::filesystem::path& file_path,
     const store_options& options) -> std::future<result<store_result>> {
 
-    return std::async(std::launch::async, [this, key, file_path, options]() {
+    return impl_->io.submit([this, key, file_path, options]() {
         return this->store_file(key, file_path, options);
     });
 }
@@ -877,7 +1054,7 @@ auto cloud_storage_backend::retrieve_async(
     const std::string& key,
     const retrieve_options& options) -> std::future<result<std::vector<std::byte>>> {
 
-    return std::async(std::launch::async, [this, key, options]() {
+    return impl_->io.submit([this, key, options]() {
         return this->retrieve(key, options);
     });
 }
@@ -887,7 +1064,7 @@ auto cloud_storage_backend::retrieve_file_async(
     const std::filesystem::path& file_path,
     const retrieve_options& options) -> std::future<result<retrieve_result>> {
 
-    return std::async(std::launch::async, [this, key, file_path, options]() {
+    return impl_->io.submit([this, key, file_path, options]() {
         return this->retrieve_file(key, file_path, options);
     });
 }
@@ -906,6 +1083,251 @@ auto cloud_storage_backend::cloud_storage() const -> const cloud_storage_interfa
     return *impl_->storage;
 }
 
+// ============================================================================
+// Streaming copy between backends
+// ============================================================================
+
+namespace {
+
+auto to_cloud_options(const store_options& options) -> cloud_transfer_options {
+    cloud_transfer_options cloud_options;
+    if (options.content_type) {
+        cloud_options.content_type = *options.content_type;
+    }
+    if (options.storage_class) {
+        cloud_options.storage_class = *options.storage_class;
+    }
+    for (const auto& [k, v] : options.custom_metadata) {
+        cloud_options.metadata.emplace_back(k, v);
+    }
+    return cloud_options;
+}
+
+// Unique name for a staged copy of key
+auto staging_name(const std::string& key) -> std::string {
+    static std::atomic<uint64_t> sequence{0};
+    return "copy-" + std::to_string(std::hash<std::string>{}(key)) + "-" +
+           std::to_string(sequence.fetch_add(1));
+}
+
+/**
+ * @brief Open a streaming reader for an object
+ * @return std::nullopt if the backend cannot be streamed from
+ */
+auto open_copy_source(storage_backend& backend, const std::string& key)
+    -> std::optional<result<stream_source>> {
+    if (auto* local = dynamic_cast<local_storage_backend*>(&backend)) {
+        auto in = std::make_shared<std::ifstream>(local->full_path(key), std::ios::binary);
+        if (!*in) {
+            return result<stream_source>(unexpected{error{
+                error_code::file_read_error, "Failed to open object: " + key}});
+        }
+        return result<stream_source>(stream_source(
+            [in](std::span<std::byte> buffer) -> result<std::size_t> {
+                in->read(reinterpret_cast<char*>(buffer.data()),
+                         static_cast<std::streamsize>(buffer.size()));
+                if (in->bad()) {
+                    return unexpected{error{error_code::file_read_error,
+                                           "Failed to read local object"}};
+                }
+                return static_cast<std::size_t>(in->gcount());
+            }));
+    }
+
+    if (auto* cloud = dynamic_cast<cloud_storage_backend*>(&backend)) {
+        std::shared_ptr<cloud_download_stream> stream =
+            cloud->cloud_storage().create_download_stream(key);
+        if (!stream) {
+            return result<stream_source>(unexpected{error{
+                error_code::file_read_error, "Failed to open cloud download stream: " + key}});
+        }
+        return result<stream_source>(stream_source(
+            [stream](std::span<std::byte> buffer) -> result<std::size_t> {
+                if (!stream->has_more()) {
+                    return std::size_t{0};
+                }
+                auto read = stream->read(buffer);
+                if (!read.has_value()) {
+                    return unexpected{error{error_code::file_read_error,
+                        "Cloud download failed: " + read.error().message}};
+                }
+                return read.value();
+            }));
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * @brief Destination of a streaming copy
+ *
+ * commit() makes the copy visible; abort() discards a partial one.
+ */
+struct copy_sink {
+    stream_sink write;
+    std::function<result<store_result>()> commit;
+    std::function<void()> abort;
+};
+
+/**
+ * @brief Open a streaming writer for an object
+ * @return std::nullopt if the backend cannot be streamed into
+ */
+auto open_copy_sink(storage_backend& backend, const std::string& key,
+                    const store_options& options)
+    -> std::optional<result<copy_sink>> {
+    if (auto* local = dynamic_cast<local_storage_backend*>(&backend)) {
+        // Stage outside the key space and rename into place on commit
+        auto staging_dir = local->base_path() / copy_staging_directory;
+        std::error_code ec;
+        std::filesystem::create_directories(staging_dir, ec);
+        auto staged = staging_dir / staging_name(key);
+        auto out = std::make_shared<std::ofstream>(staged, std::ios::binary | std::ios::trunc);
+        if (ec || !*out) {
+            return result<copy_sink>(unexpected{error{
+                error_code::file_write_error, "Failed to create staging file for: " + key}});
+        }
+
+        copy_sink sink;
+        sink.write = [out](std::span<const std::byte> data) -> result<void> {
+            out->write(reinterpret_cast<const char*>(data.data()),
+                       static_cast<std::streamsize>(data.size()));
+            if (!*out) {
+                return unexpected{error{error_code::file_write_error,
+                                       "Failed to write staging file"}};
+            }
+            return result<void>();
+        };
+        sink.commit = [out, staged, local, key, options]() -> result<store_result> {
+            out->close();
+            auto target = local->full_path(key);
+            std::error_code rename_ec;
+            if (!out->fail() && target.has_parent_path()) {
+                std::filesystem::create_directories(target.parent_path(), rename_ec);
+            }
+            if (!out->fail() && !rename_ec) {
+                std::filesystem::rename(staged, target, rename_ec);
+            }
+            if (out->fail() || rename_ec) {
+                std::filesystem::remove(staged, rename_ec);
+                return unexpected{error{error_code::file_write_error,
+                                       "Failed to move copied object into place: " + key}};
+            }
+            // The object is already in place; this only indexes it
+            return local->store_file(key, target, options);
+        };
+        sink.abort = [out, staged]() {
+            out->close();
+            std::error_code remove_ec;
+            std::filesystem::remove(staged, remove_ec);
+        };
+        return result<copy_sink>(std::move(sink));
+    }
+
+    if (auto* cloud = dynamic_cast<cloud_storage_backend*>(&backend)) {
+        std::shared_ptr<cloud_upload_stream> upload =
+            cloud->cloud_storage().create_upload_stream(key, to_cloud_options(options));
+        if (!upload) {
+            return result<copy_sink>(unexpected{error{
+                error_code::file_write_error, "Failed to open cloud upload stream: " + key}});
+        }
+
+        copy_sink sink;
+        sink.write = [upload](std::span<const std::byte> data) -> result<void> {
+            auto written = upload->write(data);
+            if (!written.has_value()) {
+                return unexpected{error{error_code::file_write_error,
+                    "Cloud upload failed: " + written.error().message}};
+            }
+            return result<void>();
+        };
+        sink.commit = [upload, key, options,
+                       type = backend.type()]() -> result<store_result> {
+            auto finished = upload->finalize();
+            if (!finished.has_value()) {
+                return unexpected{error{error_code::file_write_error,
+                    "Cloud upload failed: " + finished.error().message}};
+            }
+            store_result res;
+            res.key = key;
+            res.bytes_stored = finished.value().bytes_uploaded;
+            res.backend = type;
+            res.tier = options.tier;
+            res.etag = finished.value().etag;
+            return res;
+        };
+        sink.abort = [upload]() { (void)upload->abort(); };
+        return result<copy_sink>(std::move(sink));
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * @brief Copy an object between backends without buffering it in memory
+ *
+ * Local and cloud backends are streamed through stream_copy(); other
+ * backends are staged through a temporary file.
+ */
+auto copy_object(storage_backend& source,
+                 storage_backend& destination,
+                 const std::string& key,
+                 const store_options& options,
+                 const stream_copy_options& copy_options) -> result<store_result> {
+    // Rewriting a local object in place only changes its recorded tier
+    if (&source == &destination) {
+        if (auto* local = dynamic_cast<local_storage_backend*>(&source)) {
+            return local->store_file(key, local->full_path(key), options);
+        }
+    }
+
+    auto present = source.exists(key);
+    if (!present.has_value()) {
+        return unexpected{present.error()};
+    }
+    if (!present.value()) {
+        return unexpected{error{error_code::file_not_found, "Object not found: " + key}};
+    }
+
+    auto reader = open_copy_source(source, key);
+    auto writer = reader ? open_copy_sink(destination, key, options) : std::nullopt;
+    if (!reader || !writer) {
+        auto staged = std::filesystem::temp_directory_path() /
+                      ("file_trans_" + staging_name(key));
+        auto fetched = source.retrieve_file(key, staged);
+        if (!fetched.has_value()) {
+            std::error_code ec;
+            std::filesystem::remove(staged, ec);
+            return unexpected{fetched.error()};
+        }
+        auto stored = destination.store_file(key, staged, options);
+        std::error_code ec;
+        std::filesystem::remove(staged, ec);
+        return stored;
+    }
+
+    if (!reader->has_value()) {
+        return unexpected{reader->error()};
+    }
+    if (!writer->has_value()) {
+        return unexpected{writer->error()};
+    }
+
+    auto& sink = writer->value();
+    auto copied = stream_copy(reader->value(), sink.write, copy_options);
+    if (!copied.has_value()) {
+        sink.abort();
+        return unexpected{copied.error()};
+    }
+    auto committed = sink.commit();
+    if (!committed.has_value()) {
+        sink.abort();
+    }
+    return committed;
+}
+
+}  // namespace
+
 // ============================================================================
 // storage_manager implementation
 // ============================================================================
@@ -919,8 +1341,12 @@ struct storage_manager::impl {
 
     std::function<void(const storage_progress&)> progress_callback;
     std::function<void(const std::string&, const error&)> error_callback;
+    std::function<void(storage_operation, const std::string&)> event_callback;
 
-    explicit impl(const storage_manager_config& cfg) : config(cfg) {}
+    explicit impl(const storage_manager_config& cfg) : config(cfg) {
+        // Async operations wait on backend calls that fan out to other lanes
+        io.set_blocking();
+    }
 
     void report_progress(const storage_progress& progress) {
         std::shared_lock lock(mutex);
@@ -936,6 +1362,16 @@ struct storage_manager::impl {
         }
     }
 
+    void report_event(storage_operation operation, const std::string& key) {
+        if (operation == storage_operation::retrieve && !config.track_access) {
+            return;
+        }
+        std::shared_lock lock(mutex);
+        if (event_callback) {
+            event_callback(operation, key);
+        }
+    }
+
     void record_store(uint64_t bytes, storage_backend_type backend) {
         std::unique_lock lock(mutex);
         stats.bytes_stored += bytes;
@@ -964,6 +1400,201 @@ struct storage_manager::impl {
         std::unique_lock lock(mutex);
         stats.error_count++;
     }
+
+    // Read cache for objects on remote backends; null when disabled
+    std::unique_ptr<object_cache> cache;
+
+    struct cached_object {
+        object_cache::handle handle;
+        stored_object_metadata metadata;
+    };
+
+    auto open_cache() -> void {
+        if (cache || !config.cache_directory) return;
+
+        auto is_remote = [](const std::shared_ptr<storage_backend>& backend) {
+            return backend && backend->type() != storage_backend_type::local;
+        };
+        if (!is_remote(config.primary_backend) && !is_remote(config.secondary_backend)) {
+            return;
+        }
+
+        auto opened = object_cache::open({*config.cache_directory, config.max_cache_size});
+        if (!opened.has_value()) {
+            FT_LOG_WARN(log_category::server,
+                "Read cache unavailable, cloud reads go to the backend: " +
+                opened.error().message);
+            return;
+        }
+        cache = std::make_unique<object_cache>(std::move(opened.value()));
+    }
+
+    /**
+     * @brief Read an object from a remote backend through the cache
+     *
+     * The object's current ETag is looked up first; a cached copy with the
+     * same ETag is served as is, otherwise the object is downloaded into
+     * the cache. Returns std::nullopt when the cache does not apply (local
+     * backend, hash verification requested, object larger than the cache,
+     * metadata unavailable) and the caller should read the backend directly.
+     */
+    auto read_through_cache(storage_backend& backend,
+                            const std::string& key,
+                            const retrieve_options& options)
+        -> std::optional<result<cached_object>> {
+        if (!cache || backend.type() == storage_backend_type::local || options.verify_hash) {
+            return std::nullopt;
+        }
+
+        auto metadata = backend.get_metadata(key);
+        if (!metadata.has_value() || metadata.value().size > cache->capacity()) {
+            return std::nullopt;
+        }
+
+        auto acquired = cache->acquire(key, cache_version(metadata.value()),
+            [&](const std::filesystem::path& target) -> result<void> {
+                auto fetched = backend.retrieve_file(key, target, options);
+                if (!fetched.has_value()) {
+                    return unexpected{fetched.error()};
+                }
+                return result<void>();
+            });
+        if (!acquired.has_value()) {
+            return result<cached_object>(unexpected{acquired.error()});
+        }
+        return result<cached_object>(
+            cached_object{std::move(acquired.value()), std::move(metadata.value())});
+    }
+
+    void invalidate_cached(const std::string& key) {
+        if (cache) {
+            cache->invalidate(key);
+        }
+    }
+
+    // Write-behind replication to the secondary backend; null when writes
+    // are replicated inline (or not at all)
+    std::unique_ptr<replication_queue> replication;
+
+    auto open_replication() -> void {
+        if (replication || !config.replicate_writes || !config.secondary_backend ||
+            !config.async_replication) {
+            return;
+        }
+
+        auto queue_config = config.write_behind;
+        if (queue_config.journal_directory.empty()) {
+            auto* local = dynamic_cast<local_storage_backend*>(config.primary_backend.get());
+            if (!local) {
+                FT_LOG_WARN(log_category::server,
+                    "No replication journal directory configured, replicating writes inline");
+                return;
+            }
+            queue_config.journal_directory = local->base_path() / replication_journal_directory;
+        }
+
+        auto opened = replication_queue::open(
+            queue_config,
+            [this](const replication_request& request) { return replicate(request); },
+            [this](const replication_request& request, const error& err) {
+                record_error();
+                report_error(request.key, err);
+            });
+        if (!opened.has_value()) {
+            FT_LOG_WARN(log_category::server,
+                "Write-behind replication unavailable, replicating writes inline: " +
+                opened.error().message);
+            return;
+        }
+        replication = std::make_unique<replication_queue>(std::move(opened.value()));
+    }
+
+    /**
+     * @brief Apply one queued change to the secondary backend
+     *
+     * Puts copy the primary's current object, so a put that lost the race
+     * with a newer write still replicates the newest content.
+     */
+    auto replicate(const replication_request& request) -> result<void> {
+        auto& secondary = *config.secondary_backend;
+        if (request.op == replication_op::remove) {
+            auto removed = secondary.remove(request.key);
+            if (!removed.has_value() && removed.error().code != error_code::file_not_found) {
+                return removed;
+            }
+            return result<void>();
+        }
+
+        store_options options;
+        options.overwrite = true;
+        if (!request.storage_class.empty()) options.storage_class = request.storage_class;
+        if (!request.content_type.empty()) options.content_type = request.content_type;
+
+        if (auto* local = dynamic_cast<local_storage_backend*>(config.primary_backend.get())) {
+            auto source = local->full_path(request.key);
+            std::error_code ec;
+            if (!std::filesystem::exists(source, ec)) {
+                // Removed since; the remove that follows is queued for the key
+                return result<void>();
+            }
+            auto stored = secondary.store_file(request.key, source, options);
+            if (!stored.has_value()) {
+                return unexpected{stored.error()};
+            }
+            return result<void>();
+        }
+
+        // Other primaries (which need an explicit journal directory): stage
+        // the object next to the journal
+        auto staged = config.write_behind.journal_directory / ("stage-" + std::to_string(
+            std::hash<std::string>{}(request.key)) + "-" + std::to_string(
+            std::chrono::steady_clock::now().time_since_epoch().count()));
+
+        auto fetched = config.primary_backend->retrieve_file(request.key, staged);
+        if (!fetched.has_value()) {
+            std::error_code ec;
+            std::filesystem::remove(staged, ec);
+            if (fetched.error().code == error_code::file_not_found) {
+                return result<void>();
+            }
+            return unexpected{fetched.error()};
+        }
+        auto stored = secondary.store_file(request.key, staged, options);
+        std::error_code ec;
+        std::filesystem::remove(staged, ec);
+        if (!stored.has_value()) {
+            return unexpected{stored.error()};
+        }
+        return result<void>();
+    }
+
+    // Queue a change for the secondary; false if it must be replicated inline
+    auto enqueue_replication(const std::string& key, replication_op op,
+                             const store_options& options = {}) -> bool {
+        if (!replication) return false;
+
+        replication_request request;
+        request.key = key;
+        request.op = op;
+        request.storage_class = options.storage_class.value_or("");
+        request.content_type = options.content_type.value_or("");
+        auto queued = replication->enqueue(request);
+        if (!queued.has_value()) {
+            report_error(key, queued.error());
+            return false;
+        }
+        return true;
+    }
+
+    // Whether the secondary may answer reads for key: not while a change
+    // to it is still pending, or it could serve stale or deleted data
+    [[nodiscard]] auto fallback_allowed(const std::string& key) const -> bool {
+        return config.fallback_reads && config.secondary_backend &&
+               (!replication || !replication->pending(key).has_value());
+    }
+
+    // Async operations; declared last so no queued task outlives the manager
+    io_scope io{"storage_manager"};
 };
 
 storage_manager::storage_manager(const storage_manager_config& config)
@@ -1006,6 +1637,9 @@ auto storage_manager::initialize() -> result<void> {
         }
     }
 
+    impl_->open_cache();
+    impl_->open_replication();
+
     impl_->initialized = true;
     return result<void>();
 }
@@ -1015,6 +1649,9 @@ auto storage_manager::shutdown() -> result<void> {
         return result<void>();
     }
 
+    // Stop write-behind replication; pending changes stay journaled
+    impl_->replication.reset();
+
     // Disconnect secondary backend
     if (impl_->config.secondary_backend) {
         impl_->config.secondary_backend->disconnect();
@@ -1041,6 +1678,7 @@ auto storage_manager::store(
 
     // Store to primary backend
     auto primary_result = impl_->config.primary_backend->store(key, data, options);
+    impl_->invalidate_cached(key);
     if (!primary_result.has_value()) {
         impl_->record_error();
         impl_->report_error(key, primary_result.error());
@@ -1049,9 +1687,11 @@ auto storage_manager::store(
 
     impl_->record_store(primary_result.value().bytes_stored,
                         primary_result.value().backend);
+    impl_->report_event(storage_operation::store, key);
 
     // Replicate to secondary if configured
-    if (impl_->config.replicate_writes && impl_->config.secondary_backend) {
+    if (impl_->config.replicate_writes && impl_->config.secondary_backend &&
+        !impl_->enqueue_replication(key, replication_op::put, options)) {
         auto secondary_result = impl_->config.secondary_backend->store(key, data, options);
         if (!secondary_result.has_value()) {
             // Log error but don't fail the operation
@@ -1075,6 +1715,7 @@ auto storage_manager::store_file(
     }
 
     auto primary_result = impl_->config.primary_backend->store_file(key, file_path, options);
+    impl_->invalidate_cached(key);
     if (!primary_result.has_value()) {
         impl_->record_error();
         impl_->report_error(key, primary_result.error());
@@ -1083,9 +1724,11 @@ auto storage_manager::store_file(
 
     impl_->record_store(primary_result.value().bytes_stored,
                         primary_result.value().backend);
+    impl_->report_event(storage_operation::store, key);
 
     // Replicate to secondary if configured
-    if (impl_->config.replicate_writes && impl_->config.secondary_backend) {
+    if (impl_->config.replicate_writes && impl_->config.secondary_backend &&
+        !impl_->enqueue_replication(key, replication_op::put, options)) {
         auto secondary_result = impl_->config.secondary_backend->store_file(
             key, file_path, options);
         if (!secondary_result.has_value()) {
@@ -1107,18 +1750,31 @@ auto storage_manager::retrieve(
         }};
     }
 
+    auto read = [&](storage_backend& backend) -> result<std::vector<std::byte>> {
+        if (auto cached = impl_->read_through_cache(backend, key, options)) {
+            if (!cached->has_value()) {
+                return unexpected{cached->error()};
+            }
+            const auto& handle = cached->value().handle;
+            return read_whole_file(handle.path(), handle.size());
+        }
+        return backend.retrieve(key, options);
+    };
+
     // Try primary backend first
-    auto primary_result = impl_->config.primary_backend->retrieve(key, options);
+    auto primary_result = read(*impl_->config.primary_backend);
     if (primary_result.has_value()) {
         impl_->record_retrieve(primary_result.value().size());
+        impl_->report_event(storage_operation::retrieve, key);
         return primary_result;
     }
 
     // Fallback to secondary if configured
-    if (impl_->config.fallback_reads && impl_->config.secondary_backend) {
-        auto secondary_result = impl_->config.secondary_backend->retrieve(key, options);
+    if (impl_->fallback_allowed(key)) {
+        auto secondary_result = read(*impl_->config.secondary_backend);
         if (secondary_result.has_value()) {
             impl_->record_retrieve(secondary_result.value().size());
+            impl_->report_event(storage_operation::retrieve, key);
             return secondary_result;
         }
     }
@@ -1139,19 +1795,52 @@ auto storage_manager::retrieve_file(
         }};
     }
 
+    auto read = [&](storage_backend& backend) -> result<retrieve_result> {
+        auto start_time = std::chrono::steady_clock::now();
+        auto cached = impl_->read_through_cache(backend, key, options);
+        if (!cached) {
+            return backend.retrieve_file(key, file_path, options);
+        }
+        if (!cached->has_value()) {
+            return unexpected{cached->error()};
+        }
+
+        const auto& handle = cached->value().handle;
+        std::error_code ec;
+        if (file_path.has_parent_path()) {
+            std::filesystem::create_directories(file_path.parent_path(), ec);
+        }
+        std::filesystem::copy_file(handle.path(), file_path,
+                                   std::filesystem::copy_options::overwrite_existing, ec);
+        if (ec) {
+            return unexpected{error{error_code::file_write_error,
+                                   "Failed to copy cached object: " + ec.message()}};
+        }
+
+        retrieve_result res;
+        res.key = key;
+        res.bytes_retrieved = handle.size();
+        res.backend = backend.type();
+        res.metadata = std::move(cached->value().metadata);
+        res.duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start_time);
+        return res;
+    };
+
     // Try primary backend first
-    auto primary_result = impl_->config.primary_backend->retrieve_file(key, file_path, options);
+    auto primary_result = read(*impl_->config.primary_backend);
     if (primary_result.has_value()) {
         impl_->record_retrieve(primary_result.value().bytes_retrieved);
+        impl_->report_event(storage_operation::retrieve, key);
         return primary_result;
     }
 
     // Fallback to secondary if configured
-    if (impl_->config.fallback_reads && impl_->config.secondary_backend) {
-        auto secondary_result = impl_->config.secondary_backend->retrieve_file(
-            key, file_path, options);
+    if (impl_->fallback_allowed(key)) {
+        auto secondary_result = read(*impl_->config.secondary_backend);
         if (secondary_result.has_value()) {
             impl_->record_retrieve(secondary_result.value().bytes_retrieved);
+            impl_->report_event(storage_operation::retrieve, key);
             return secondary_result;
         }
     }
@@ -1170,14 +1859,17 @@ auto storage_manager::remove(const std::string& key) -> result<void> {
 
     // Remove from primary
     auto primary_result = impl_->config.primary_backend->remove(key);
+    impl_->invalidate_cached(key);
 
     // Also remove from secondary if configured
-    if (impl_->config.secondary_backend) {
+    if (impl_->config.secondary_backend &&
+        !impl_->enqueue_replication(key, replication_op::remove)) {
         impl_->config.secondary_backend->remove(key);
     }
 
     if (primary_result.has_value()) {
         impl_->record_delete();
+        impl_->report_event(storage_operation::remove, key);
     } else {
         impl_->record_error();
     }
@@ -1200,7 +1892,7 @@ auto storage_manager::exists(const std::string& key) -> result<bool> {
     }
 
     // Check secondary if configured and fallback enabled
-    if (impl_->config.fallback_reads && impl_->config.secondary_backend) {
+    if (impl_->fallback_allowed(key)) {
         auto secondary_result = impl_->config.secondary_backend->exists(key);
         if (secondary_result.has_value() && secondary_result.value()) {
             return result<bool>(true);
@@ -1227,7 +1919,7 @@ auto storage_manager::get_metadata(const std::string& key)
     }
 
     // Fallback to secondary
-    if (impl_->config.fallback_reads && impl_->config.secondary_backend) {
+    if (impl_->fallback_allowed(key)) {
         auto secondary_result = impl_->config.secondary_backend->get_metadata(key);
         if (secondary_result.has_value()) {
             return secondary_result;
@@ -1250,40 +1942,84 @@ auto storage_manager::list(const list_storage_options& options)
     // Merge results from both backends if hybrid storage
     if (impl_->config.hybrid_storage && impl_->config.secondary_backend) {
         list_storage_result merged_result;
-        std::unordered_map<std::string, stored_object_metadata> objects_map;
 
-        // Get from primary
-        auto primary_result = impl_->config.primary_backend->list(options);
-        if (primary_result.has_value()) {
-            for (auto& obj : primary_result.value().objects) {
-                objects_map[obj.key] = std::move(obj);
+        auto sort_value = [&options](const stored_object_metadata& obj) -> int64_t {
+            switch (options.sort_by) {
+                case storage_sort_field::size:
+                    return static_cast<int64_t>(obj.size);
+                case storage_sort_field::last_modified:
+                    return obj.last_modified.time_since_epoch().count();
+                default:
+                    return 0;
             }
-        }
-
-        // Get from secondary
-        auto secondary_result = impl_->config.secondary_backend->list(options);
-        if (secondary_result.has_value()) {
-            for (auto& obj : secondary_result.value().objects) {
-                if (objects_map.find(obj.key) == objects_map.end()) {
-                    objects_map[obj.key] = std::move(obj);
+        };
+        auto before = [&](const stored_object_metadata& a, const stored_object_metadata& b) {
+            auto va = sort_value(a);
+            auto vb = sort_value(b);
+            if (va != vb) {
+                return options.descending ? va > vb : va < vb;
+            }
+            return options.descending ? a.key > b.key : a.key < b.key;
+        };
+
+        // Each listing is already ordered (the local index returns the
+        // requested order); only sort the ones that are not
+        auto take_sorted = [&](result<list_storage_result> listed) {
+            std::vector<stored_object_metadata> objects;
+            if (listed.has_value()) {
+                merged_result.is_truncated |= listed.value().is_truncated;
+                objects = std::move(listed.value().objects);
+                if (!std::is_sorted(objects.begin(), objects.end(), before)) {
+                    std::sort(objects.begin(), objects.end(), before);
                 }
             }
-        }
+            return objects;
+        };
 
-        for (auto& [_, obj] : objects_map) {
-            merged_result.objects.push_back(std::move(obj));
+        auto primary = take_sorted(impl_->config.primary_backend->list(options));
+        auto secondary = take_sorted(impl_->config.secondary_backend->list(options));
+
+        // Linear merge; the primary copy wins when a key exists in both
+        std::unordered_set<std::string_view> primary_keys;
+        primary_keys.reserve(primary.size());
+        for (const auto& obj : primary) {
+            primary_keys.insert(obj.key);
         }
 
-        // Sort by key
-        std::sort(merged_result.objects.begin(), merged_result.objects.end(),
-            [](const auto& a, const auto& b) { return a.key < b.key; });
+        // Pick first and move afterwards; primary_keys views the primary keys
+        std::vector<stored_object_metadata*> picked;
+        picked.reserve(std::min(options.max_results, primary.size() + secondary.size()));
+        auto p = primary.begin();
+        auto s = secondary.begin();
+        // Secondary copies with a pending replication are stale or deleted
+        auto skip_duplicates = [&]() {
+            while (s != secondary.end() &&
+                   (primary_keys.contains(s->key) ||
+                    (impl_->replication && impl_->replication->pending(s->key)))) {
+                ++s;
+            }
+        };
+        skip_duplicates();
+        while (picked.size() < options.max_results &&
+               (p != primary.end() || s != secondary.end())) {
+            if (s == secondary.end() || (p != primary.end() && !before(*s, *p))) {
+                picked.push_back(&*p++);
+            } else {
+                picked.push_back(&*s++);
+                skip_duplicates();
+            }
+        }
 
         // Apply max_results
-        if (merged_result.objects.size() > options.max_results) {
-            merged_result.objects.resize(options.max_results);
+        if (p != primary.end() || s != secondary.end()) {
             merged_result.is_truncated = true;
         }
 
+        merged_result.objects.reserve(picked.size());
+        for (auto* obj : picked) {
+            merged_result.objects.push_back(std::move(*obj));
+        }
+
         return result<list_storage_result>(std::move(merged_result));
     }
 
@@ -1297,7 +2033,7 @@ auto storage_manager::store_async(
 
     auto data_copy = std::make_shared<std::vector<std::byte>>(data.begin(), data.end());
 
-    return std::async(std::launch::async, [this, key, data_copy, options]() {
+    return impl_->io.submit([this, key, data_copy, options]() {
         return this->store(key, *data_copy, options);
     });
 }
@@ -1307,7 +2043,7 @@ auto storage_manager::store_file_async(
     const std::filesystem::path& file_path,
     const store_options& options) -> std::future<result<store_result>> {
 
-    return std::async(std::launch::async, [this, key, file_path, options]() {
+    return impl_->io.submit([this, key, file_path, options]() {
         return this->store_file(key, file_path, options);
     });
 }
@@ -1316,7 +2052,7 @@ auto storage_manager::retrieve_async(
     const std::string& key,
     const retrieve_options& options) -> std::future<result<std::vector<std::byte>>> {
 
-    return std::async(std::launch::async, [this, key, options]() {
+    return impl_->io.submit([this, key, options]() {
         return this->retrieve(key, options);
     });
 }
@@ -1326,14 +2062,15 @@ auto storage_manager::retrieve_file_async(
     const std::filesystem::path& file_path,
     const retrieve_options& options) -> std::future<result<retrieve_result>> {
 
-    return std::async(std::launch::async, [this, key, file_path, options]() {
+    return impl_->io.submit([this, key, file_path, options]() {
         return this->retrieve_file(key, file_path, options);
     });
 }
 
 auto storage_manager::change_tier(
     const std::string& key,
-    storage_tier target_tier) -> result<void> {
+    storage_tier target_tier,
+    const stream_copy_options& copy_options) -> result<void> {
 
     if (!impl_->initialized) {
         return unexpected{error{
@@ -1342,12 +2079,6 @@ auto storage_manager::change_tier(
         }};
     }
 
-    // For tier change, we need to retrieve and re-store with new options
-    auto data = retrieve(key);
-    if (!data.has_value()) {
-        return unexpected{data.error()};
-    }
-
     store_options options;
     options.tier = target_tier;
     options.overwrite = true;
@@ -1368,13 +2099,39 @@ auto storage_manager::change_tier(
             break;
     }
 
-    auto store_res = store(key, data.value(), options);
-    if (!store_res.has_value()) {
-        return unexpected{store_res.error()};
+    // Rewrite into the primary, reading from the secondary if the primary
+    // does not have the object
+    auto& primary = *impl_->config.primary_backend;
+    storage_backend* source = &primary;
+    auto in_primary = primary.exists(key);
+    if ((!in_primary.has_value() || !in_primary.value()) && impl_->fallback_allowed(key)) {
+        source = impl_->config.secondary_backend.get();
     }
 
-    std::unique_lock lock(impl_->mutex);
-    impl_->stats.tier_change_count++;
+    auto stored = copy_object(*source, primary, key, options, copy_options);
+    impl_->invalidate_cached(key);
+    if (!stored.has_value()) {
+        impl_->record_error();
+        impl_->report_error(key, stored.error());
+        return unexpected{stored.error()};
+    }
+    impl_->record_store(stored.value().bytes_stored, stored.value().backend);
+
+    // Replicate to secondary if configured
+    if (impl_->config.replicate_writes && impl_->config.secondary_backend &&
+        !impl_->enqueue_replication(key, replication_op::put, options)) {
+        auto replicated = copy_object(primary, *impl_->config.secondary_backend,
+                                      key, options, copy_options);
+        if (!replicated.has_value()) {
+            impl_->report_error(key, replicated.error());
+        }
+    }
+
+    {
+        std::unique_lock lock(impl_->mutex);
+        impl_->stats.tier_change_count++;
+    }
+    impl_->report_event(storage_operation::store, key);
 
     return result<void>();
 }
@@ -1382,7 +2139,8 @@ auto storage_manager::change_tier(
 auto storage_manager::copy_between_backends(
     const std::string& key,
     storage_backend_type source,
-    storage_backend_type destination) -> result<void> {
+    storage_backend_type destination,
+    const stream_copy_options& copy_options) -> result<void> {
 
     if (!impl_->initialized) {
         return unexpected{error{
@@ -1416,16 +2174,10 @@ auto storage_manager::copy_between_backends(
         }};
     }
 
-    // Retrieve from source
-    auto data = src_backend->retrieve(key);
-    if (!data.has_value()) {
-        return unexpected{data.error()};
-    }
-
-    // Store to destination
     store_options options;
     options.overwrite = true;
-    auto store_res = dst_backend->store(key, data.value(), options);
+    auto store_res = copy_object(*src_backend, *dst_backend, key, options, copy_options);
+    impl_->invalidate_cached(key);
     if (!store_res.has_value()) {
         return unexpected{store_res.error()};
     }
@@ -1434,13 +2186,34 @@ auto storage_manager::copy_between_backends(
 }
 
 auto storage_manager::get_statistics() const -> storage_manager_statistics {
-    std::shared_lock lock(impl_->mutex);
-    return impl_->stats;
+    storage_manager_statistics stats;
+    {
+        std::shared_lock lock(impl_->mutex);
+        stats = impl_->stats;
+    }
+    if (impl_->cache) {
+        auto cache_stats = impl_->cache->statistics();
+        stats.cache_hits = cache_stats.hits;
+        stats.cache_misses = cache_stats.misses;
+        stats.cache_evictions = cache_stats.evictions;
+        stats.cache_bytes = cache_stats.current_bytes;
+    }
+    if (impl_->replication) {
+        auto queue_stats = impl_->replication->statistics();
+        stats.replication_pending = queue_stats.pending;
+        stats.replication_lag = queue_stats.lag;
+        stats.replicated_count = queue_stats.replicated;
+        stats.replication_failures = queue_stats.failed;
+    }
+    return stats;
 }
 
 void storage_manager::reset_statistics() {
     std::unique_lock lock(impl_->mutex);
     impl_->stats = storage_manager_statistics{};
+    if (impl_->cache) {
+        impl_->cache->reset_statistics();
+    }
 }
 
 auto storage_manager::config() const -> const storage_manager_config& {
@@ -1475,4 +2248,10 @@ void storage_manager::on_error(
     impl_->error_callback = std::move(callback);
 }
 
+void storage_manager::on_object_event(
+    std::function<void(storage_operation, const std::string&)> callback) {
+    std::unique_lock lock(impl_->mutex);
+    impl_->event_callback = std::move(callback);
+}
+
 }  // namespace kcenon::file_transfer
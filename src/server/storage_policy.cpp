@@ -5,10 +5,20 @@
 
 #include "kcenon/file_transfer/server/storage_policy.h"
 
+#include "kcenon/file_transfer/core/bandwidth_limiter.h"
+#include "kcenon/file_transfer/core/io_executor.h"
+#include "kcenon/file_transfer/server/access_sketch.h"
+
 #include <algorithm>
+#include <atomic>
+#include <future>
 #include <mutex>
+#include <queue>
 #include <regex>
 #include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace kcenon::file_transfer {
 
@@ -60,6 +70,171 @@ auto matches_glob_pattern(const std::string& pattern, const std::string& key) ->
     }
 }
 
+// ============================================================================
+// Incremental evaluation index
+// ============================================================================
+
+using policy_clock = std::chrono::system_clock;
+
+/// First path component of a key; evaluation shards are selected by it
+auto shard_component(std::string_view key) -> std::string_view {
+    return key.substr(0, key.find('/'));
+}
+
+/// Why an indexed object has to be evaluated again
+enum class recheck : uint8_t {
+    reevaluate,  ///< Clock or access count moved; the indexed snapshot is current
+    refresh      ///< Object was written; fetch its metadata first
+};
+
+/// Compact snapshot of the metadata the rules look at
+struct tracked_object {
+    uint64_t size = 0;
+    policy_clock::time_point last_modified;
+    storage_tier tier = storage_tier::hot;
+    std::optional<policy_clock::time_point> next_check;
+    uint64_t accessed_epoch = 0;  // Sketch generation of the last recorded access
+};
+
+struct scheduled_check {
+    policy_clock::time_point due;
+    std::string key;
+
+    auto operator>(const scheduled_check& other) const -> bool {
+        return due > other.due;
+    }
+};
+
+struct evaluation_shard {
+    std::mutex mutex;
+    std::unordered_map<std::string, tracked_object> objects;
+
+    // Earliest time each object could match an age threshold. Entries are
+    // not removed when an object changes; stale ones are skipped on pop.
+    std::priority_queue<scheduled_check, std::vector<scheduled_check>,
+                        std::greater<>> schedule;
+
+    std::unordered_map<std::string, recheck> dirty;
+
+    // Keys first accessed in each sketch generation; re-evaluated when
+    // that generation is dropped and their count falls
+    std::vector<std::string> accessed[2];
+
+    void track(const std::string& key, const tracked_object& object) {
+        objects.insert_or_assign(key, object);
+        if (object.next_check) {
+            schedule.push(scheduled_check{*object.next_check, key});
+        }
+        // Stale entries pile up as objects are re-scheduled
+        if (schedule.size() > 2 * objects.size() + 1024) {
+            decltype(schedule) compacted;
+            for (const auto& [k, o] : objects) {
+                if (o.next_check) compacted.push(scheduled_check{*o.next_check, k});
+            }
+            schedule = std::move(compacted);
+        }
+    }
+};
+
+/**
+ * Objects known to the policy, split into shards by key prefix.
+ *
+ * Shared with the storage manager's event callback, so events arriving
+ * after the policy is destroyed land in an orphaned index instead of
+ * freed memory.
+ */
+struct evaluation_index {
+    evaluation_index(std::size_t shard_count, std::size_t sketch_width)
+        : sketch(sketch_width) {
+        shards.reserve(shard_count);
+        for (std::size_t i = 0; i < shard_count; ++i) {
+            shards.push_back(std::make_unique<evaluation_shard>());
+        }
+    }
+
+    std::vector<std::unique_ptr<evaluation_shard>> shards;
+    access_sketch sketch;
+    std::atomic<uint64_t> epoch{1};
+    std::atomic<bool> seeded{false};
+    std::atomic<bool> rules_changed{false};
+    std::atomic<bool> access_sensitive{false};  // Some rule reads access counts
+
+    std::mutex rotation_mutex;
+    std::optional<policy_clock::time_point> next_rotation;
+
+    [[nodiscard]] auto shard_for(std::string_view key) -> evaluation_shard& {
+        auto hash = std::hash<std::string_view>{}(shard_component(key));
+        return *shards[hash % shards.size()];
+    }
+
+    void clear() {
+        for (auto& shard : shards) {
+            std::lock_guard lock(shard->mutex);
+            shard->objects.clear();
+            shard->schedule = {};
+            shard->dirty.clear();
+            shard->accessed[0].clear();
+            shard->accessed[1].clear();
+        }
+        sketch.clear();
+        seeded = false;
+    }
+
+    void on_event(storage_operation operation, const std::string& key) {
+        if (operation == storage_operation::retrieve) {
+            sketch.record(key);
+        }
+
+        auto& shard = shard_for(key);
+        std::lock_guard lock(shard.mutex);
+        switch (operation) {
+            case storage_operation::store:
+                shard.dirty[key] = recheck::refresh;
+                break;
+
+            case storage_operation::remove:
+                shard.objects.erase(key);
+                shard.dirty.erase(key);
+                break;
+
+            case storage_operation::retrieve: {
+                auto it = shard.objects.find(key);
+                if (it == shard.objects.end()) break;
+                auto current = epoch.load();
+                if (it->second.accessed_epoch != current) {
+                    it->second.accessed_epoch = current;
+                    shard.accessed[current & 1].push_back(key);
+                }
+                if (access_sensitive) {
+                    shard.dirty.try_emplace(key, recheck::reevaluate);
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    // Drops the oldest sketch generation; objects whose count it held are
+    // re-evaluated against the lower estimate
+    void rotate() {
+        auto next = epoch.load() + 1;
+        sketch.rotate();
+        epoch = next;
+        for (auto& shard : shards) {
+            std::lock_guard lock(shard->mutex);
+            auto& expired = shard->accessed[next & 1];
+            for (auto& key : expired) {
+                if (shard->objects.contains(key)) {
+                    shard->dirty.try_emplace(std::move(key), recheck::reevaluate);
+                }
+            }
+            expired.clear();
+        }
+    }
+};
+
 }  // namespace
 
 // ============================================================================
@@ -75,6 +250,9 @@ struct storage_policy::builder::builder_data {
     std::chrono::seconds auto_eval_interval{0};
     bool auto_execution = false;
     bool dry_run = false;
+    std::size_t max_concurrent_actions = 1;
+    std::size_t bandwidth_limit = 0;
+    std::size_t evaluation_shards = 16;
 };
 
 // ============================================================================
@@ -96,6 +274,10 @@ struct storage_policy::impl {
     bool auto_execution = false;
     bool dry_run = false;
 
+    // Concurrent actions in execute_pending() and the budget they share
+    std::size_t max_concurrent_actions = 1;
+    std::shared_ptr<bandwidth_limiter> limiter;
+
     mutable std::shared_mutex stats_mutex;
     tiering_statistics stats;
 
@@ -109,6 +291,10 @@ struct storage_policy::impl {
     mutable std::mutex pending_mutex;
     std::vector<policy_evaluation_result> pending_actions;
 
+    // State for evaluate_incremental(); replaced on build()
+    std::shared_ptr<evaluation_index> index =
+        std::make_shared<evaluation_index>(1, 1);
+
     void report_eval(const policy_evaluation_result& result) {
         std::lock_guard lock(callbacks_mutex);
         if (eval_callback) {
@@ -310,6 +496,229 @@ struct storage_policy::impl {
 
         return result;
     }
+
+    // Access counts come from the sketch; backends do not track them
+    auto with_access_count(stored_object_metadata metadata) -> stored_object_metadata {
+        metadata.access_count = std::max(metadata.access_count,
+                                         index->sketch.estimate(metadata.key));
+        return metadata;
+    }
+
+    void queue_pending(const policy_evaluation_result& result) {
+        if (result.target_tier == result.current_tier || result.blocked_by_retention) {
+            return;
+        }
+        std::lock_guard lock(pending_mutex);
+        pending_actions.push_back(result);
+    }
+
+    void refresh_access_sensitivity() {
+        bool sensitive = false;
+        std::shared_lock lock(rules_mutex);
+        for (const auto& rule : rules) {
+            if (rule.enabled && rule.trigger == tiering_trigger::access_pattern) {
+                sensitive = true;
+            }
+        }
+        index->access_sensitive = sensitive;
+    }
+
+    void rules_changed() {
+        refresh_access_sensitivity();
+        index->rules_changed = true;
+    }
+
+    /**
+     * Earliest time after now at which the result for this object could
+     * change by age alone (rule age bounds, built-in age thresholds and
+     * minimum retention), or nullopt if it never will.
+     */
+    auto next_age_check(const stored_object_metadata& metadata,
+                        policy_clock::time_point now)
+        -> std::optional<policy_clock::time_point> {
+
+        std::optional<policy_clock::time_point> earliest;
+        auto consider = [&](std::chrono::hours age) {
+            auto at = metadata.last_modified + age;
+            if (at > now && (!earliest || at < *earliest)) {
+                earliest = at;
+            }
+        };
+
+        {
+            std::shared_lock lock(rules_mutex);
+            for (const auto& rule : rules) {
+                if (!rule.enabled || rule.trigger != tiering_trigger::age) continue;
+                if (rule.source_tier && *rule.source_tier != metadata.tier) continue;
+                if (rule.key_pattern &&
+                    !matches_glob_pattern(*rule.key_pattern, metadata.key)) {
+                    continue;
+                }
+                if (rule.min_age) consider(*rule.min_age);
+                // Ages are compared in whole hours, so max_age stops
+                // matching one hour after it is reached
+                if (rule.max_age) consider(*rule.max_age + std::chrono::hours{1});
+            }
+        }
+
+        if (age_config) {
+            switch (metadata.tier) {
+                case storage_tier::hot: consider(age_config->hot_to_warm_age); break;
+                case storage_tier::warm: consider(age_config->warm_to_cold_age); break;
+                case storage_tier::cold: consider(age_config->cold_to_archive_age); break;
+                case storage_tier::archive: break;
+            }
+        }
+
+        std::lock_guard lock(retention_mutex);
+        if (retention_policy_.min_retention.count() > 0) {
+            consider(retention_policy_.min_retention);
+        }
+        return earliest;
+    }
+
+    auto evaluate_shard(evaluation_shard& shard, policy_clock::time_point now, bool full)
+        -> result<std::vector<policy_evaluation_result>> {
+
+        std::vector<std::pair<std::string, recheck>> work;
+        {
+            std::lock_guard lock(shard.mutex);
+            if (full) {
+                for (const auto& [key, object] : shard.objects) {
+                    work.emplace_back(key, recheck::reevaluate);
+                }
+                for (const auto& [key, reason] : shard.dirty) {
+                    if (reason == recheck::refresh || !shard.objects.contains(key)) {
+                        work.emplace_back(key, recheck::refresh);
+                    }
+                }
+            } else {
+                std::unordered_set<std::string> queued;
+                for (auto& [key, reason] : shard.dirty) {
+                    queued.insert(key);
+                    work.emplace_back(key, reason);
+                }
+                while (!shard.schedule.empty() && shard.schedule.top().due <= now) {
+                    auto check = shard.schedule.top();
+                    shard.schedule.pop();
+                    auto it = shard.objects.find(check.key);
+                    if (it == shard.objects.end() || it->second.next_check != check.due) {
+                        continue;  // Removed or re-scheduled since
+                    }
+                    if (queued.insert(check.key).second) {
+                        work.emplace_back(std::move(check.key), recheck::reevaluate);
+                    }
+                }
+            }
+            shard.dirty.clear();
+        }
+
+        // A full pass may list a refreshed key twice
+        if (full) {
+            std::sort(work.begin(), work.end(), [](const auto& a, const auto& b) {
+                return a.first < b.first || (a.first == b.first && a.second > b.second);
+            });
+            work.erase(std::unique(work.begin(), work.end(),
+                [](const auto& a, const auto& b) { return a.first == b.first; }),
+                work.end());
+        }
+
+        std::vector<policy_evaluation_result> results;
+        results.reserve(work.size());
+        for (auto& [key, reason] : work) {
+            stored_object_metadata metadata;
+            uint64_t accessed_epoch = 0;
+            if (reason == recheck::refresh) {
+                auto fetched = manager->get_metadata(key);
+                if (!fetched.has_value()) {
+                    std::lock_guard lock(shard.mutex);
+                    shard.objects.erase(key);
+                    continue;
+                }
+                metadata = std::move(fetched.value());
+            } else {
+                std::lock_guard lock(shard.mutex);
+                auto it = shard.objects.find(key);
+                if (it == shard.objects.end()) continue;
+                metadata.key = key;
+                metadata.size = it->second.size;
+                metadata.last_modified = it->second.last_modified;
+                metadata.tier = it->second.tier;
+            }
+
+            auto evaluated = evaluate_object(with_access_count(metadata));
+
+            tracked_object object;
+            object.size = metadata.size;
+            object.last_modified = metadata.last_modified;
+            object.tier = metadata.tier;
+            object.next_check = next_age_check(metadata, now);
+
+            std::lock_guard lock(shard.mutex);
+            if (auto it = shard.objects.find(key); it != shard.objects.end()) {
+                accessed_epoch = it->second.accessed_epoch;
+            } else if (reason == recheck::reevaluate) {
+                continue;  // Removed while being evaluated
+            }
+            object.accessed_epoch = accessed_epoch;
+            shard.track(key, object);
+            results.push_back(std::move(evaluated));
+        }
+        return results;
+    }
+
+    // Loads every object into the index; only the first tick pays for a listing
+    auto seed_index() -> result<void> {
+        list_storage_options options;
+        while (true) {
+            auto page = manager->list(options);
+            if (!page.has_value()) {
+                return unexpected{page.error()};
+            }
+            for (auto& object : page.value().objects) {
+                tracked_object tracked;
+                tracked.size = object.size;
+                tracked.last_modified = object.last_modified;
+                tracked.tier = object.tier;
+
+                auto& shard = index->shard_for(object.key);
+                std::lock_guard lock(shard.mutex);
+                shard.objects.insert_or_assign(object.key, tracked);
+                shard.dirty.try_emplace(object.key, recheck::reevaluate);
+            }
+            if (!page.value().is_truncated || !page.value().continuation_token) {
+                break;
+            }
+            options.continuation_token = page.value().continuation_token;
+        }
+        index->seeded = true;
+        return result<void>();
+    }
+
+    void rotate_access_window(policy_clock::time_point now) {
+        auto window = access_config.value_or(access_pattern_config{}).access_window;
+        auto period = std::chrono::duration_cast<policy_clock::duration>(window) / 2;
+        if (period <= policy_clock::duration::zero()) return;
+
+        std::lock_guard lock(index->rotation_mutex);
+        if (!index->next_rotation) {
+            index->next_rotation = now + period;
+            return;
+        }
+        // Two rotations drop every count, so more are never needed
+        for (int i = 0; i < 2 && now >= *index->next_rotation; ++i) {
+            index->rotate();
+            *index->next_rotation += period;
+        }
+        if (now >= *index->next_rotation) {
+            index->next_rotation = now + period;
+        }
+    }
+
+    // Concurrent actions and shard evaluations; declared last so none
+    // outlives the policy
+    io_scope io{"storage_policy"};
+    io_scope evaluation_io{"storage_policy_eval"};
 };
 
 storage_policy::builder::builder()
@@ -363,6 +772,21 @@ auto storage_policy::builder::with_dry_run(bool enable) -> builder& {
     return *this;
 }
 
+auto storage_policy::builder::with_max_concurrent_actions(std::size_t max_actions) -> builder& {
+    data_->max_concurrent_actions = std::max<std::size_t>(max_actions, 1);
+    return *this;
+}
+
+auto storage_policy::builder::with_bandwidth_limit(std::size_t bytes_per_second) -> builder& {
+    data_->bandwidth_limit = bytes_per_second;
+    return *this;
+}
+
+auto storage_policy::builder::with_evaluation_shards(std::size_t shards) -> builder& {
+    data_->evaluation_shards = std::max<std::size_t>(shards, 1);
+    return *this;
+}
+
 auto storage_policy::builder::build() -> std::unique_ptr<storage_policy> {
     auto policy = std::unique_ptr<storage_policy>(new storage_policy());
 
@@ -374,12 +798,22 @@ auto storage_policy::builder::build() -> std::unique_ptr<storage_policy> {
     policy->impl_->auto_eval_interval = data_->auto_eval_interval;
     policy->impl_->auto_execution = data_->auto_execution;
     policy->impl_->dry_run = data_->dry_run;
+    policy->impl_->max_concurrent_actions = data_->max_concurrent_actions;
+    if (data_->bandwidth_limit > 0) {
+        policy->impl_->limiter = std::make_shared<bandwidth_limiter>(data_->bandwidth_limit);
+    }
+    policy->impl_->io.set_concurrency_limit(data_->max_concurrent_actions);
+    policy->impl_->index = std::make_shared<evaluation_index>(
+        data_->evaluation_shards,
+        data_->access_config.value_or(access_pattern_config{}).sketch_width);
+    policy->impl_->evaluation_io.set_concurrency_limit(data_->evaluation_shards);
 
     // Sort rules by priority
     std::sort(policy->impl_->rules.begin(), policy->impl_->rules.end(),
         [](const tiering_rule& a, const tiering_rule& b) {
             return a.priority > b.priority;
         });
+    policy->impl_->refresh_access_sensitivity();
 
     return policy;
 }
@@ -388,17 +822,31 @@ auto storage_policy::builder::build() -> std::unique_ptr<storage_policy> {
 // storage_policy implementation
 
 storage_policy::storage_policy()
-    : impl_(std::make_unique<impl>()) {}
+    : impl_(std::make_unique<impl>()) {
+    // Actions wait on storage calls that submit to other lanes
+    impl_->io.set_blocking();
+}
 
 storage_policy::storage_policy(storage_policy&&) noexcept = default;
 auto storage_policy::operator=(storage_policy&&) noexcept -> storage_policy& = default;
 storage_policy::~storage_policy() = default;
 
 void storage_policy::attach(storage_manager& manager) {
+    if (impl_->manager) {
+        impl_->manager->on_object_event(nullptr);
+    }
+    impl_->index->clear();
     impl_->manager = &manager;
+    manager.on_object_event(
+        [index = impl_->index](storage_operation operation, const std::string& key) {
+            index->on_event(operation, key);
+        });
 }
 
 void storage_policy::detach() {
+    if (impl_->manager) {
+        impl_->manager->on_object_event(nullptr);
+    }
     impl_->manager = nullptr;
 }
 
@@ -422,15 +870,12 @@ auto storage_policy::evaluate(const std::string& key)
     }
 
     impl_->record_evaluation();
-    auto eval_result = impl_->evaluate_object(metadata_result.value());
+    auto eval_result = impl_->evaluate_object(
+        impl_->with_access_count(std::move(metadata_result.value())));
     impl_->report_eval(eval_result);
 
     // Store for pending execution if action needed
-    if (eval_result.target_tier != eval_result.current_tier &&
-        !eval_result.blocked_by_retention) {
-        std::lock_guard lock(impl_->pending_mutex);
-        impl_->pending_actions.push_back(eval_result);
-    }
+    impl_->queue_pending(eval_result);
 
     return result<policy_evaluation_result>(std::move(eval_result));
 }
@@ -454,14 +899,9 @@ auto storage_policy::evaluate_all()
 
     for (const auto& obj : list_result.value().objects) {
         impl_->record_evaluation();
-        auto eval_result = impl_->evaluate_object(obj);
+        auto eval_result = impl_->evaluate_object(impl_->with_access_count(obj));
         impl_->report_eval(eval_result);
-
-        if (eval_result.target_tier != eval_result.current_tier &&
-            !eval_result.blocked_by_retention) {
-            std::lock_guard lock(impl_->pending_mutex);
-            impl_->pending_actions.push_back(eval_result);
-        }
+        impl_->queue_pending(eval_result);
 
         results.push_back(std::move(eval_result));
     }
@@ -491,16 +931,82 @@ auto storage_policy::evaluate_prefix(const std::string& prefix)
 
     for (const auto& obj : list_result.value().objects) {
         impl_->record_evaluation();
-        auto eval_result = impl_->evaluate_object(obj);
+        auto eval_result = impl_->evaluate_object(impl_->with_access_count(obj));
         impl_->report_eval(eval_result);
+        impl_->queue_pending(eval_result);
+
+        results.push_back(std::move(eval_result));
+    }
+
+    return result<std::vector<policy_evaluation_result>>(std::move(results));
+}
+
+auto storage_policy::evaluate_incremental()
+    -> result<std::vector<policy_evaluation_result>> {
 
-        if (eval_result.target_tier != eval_result.current_tier &&
-            !eval_result.blocked_by_retention) {
-            std::lock_guard lock(impl_->pending_mutex);
-            impl_->pending_actions.push_back(eval_result);
+    if (!impl_->manager) {
+        return unexpected{error{
+            error_code::not_initialized,
+            "Storage policy not attached to a storage manager"
+        }};
+    }
+
+    auto& index = *impl_->index;
+    if (!index.seeded) {
+        auto seeded = impl_->seed_index();
+        if (!seeded.has_value()) {
+            return unexpected{seeded.error()};
         }
+    }
 
-        results.push_back(std::move(eval_result));
+    auto now = policy_clock::now();
+    impl_->rotate_access_window(now);
+    bool full = index.rules_changed.exchange(false);
+
+    std::vector<policy_evaluation_result> results;
+    auto collect = [&](result<std::vector<policy_evaluation_result>> shard_results)
+        -> result<void> {
+        if (!shard_results.has_value()) {
+            return unexpected{shard_results.error()};
+        }
+        auto& evaluated = shard_results.value();
+        std::move(evaluated.begin(), evaluated.end(), std::back_inserter(results));
+        return result<void>();
+    };
+
+    if (index.shards.size() == 1) {
+        auto collected = collect(impl_->evaluate_shard(*index.shards.front(), now, full));
+        if (!collected.has_value()) {
+            return unexpected{collected.error()};
+        }
+    } else {
+        std::vector<std::future<result<std::vector<policy_evaluation_result>>>> running;
+        running.reserve(index.shards.size());
+        for (auto& shard : index.shards) {
+            running.push_back(impl_->evaluation_io.submit(
+                [this, &shard, now, full]() {
+                    return impl_->evaluate_shard(*shard, now, full);
+                }));
+        }
+        std::optional<error> failure;
+        for (auto& future : running) {
+            auto collected = collect(future.get());
+            if (!collected.has_value() && !failure) {
+                failure = collected.error();
+            }
+        }
+        if (failure) {
+            // Work taken by a rejected shard is lost; rescan everything next tick
+            index.rules_changed = true;
+            return unexpected{*failure};
+        }
+    }
+
+    // Callbacks run here, on the caller's thread, as in evaluate_all()
+    for (const auto& evaluated : results) {
+        impl_->record_evaluation();
+        impl_->report_eval(evaluated);
+        impl_->queue_pending(evaluated);
     }
 
     return result<std::vector<policy_evaluation_result>>(std::move(results));
@@ -542,15 +1048,38 @@ auto storage_policy::execute_pending() -> result<std::size_t> {
         impl_->pending_actions.clear();
     }
 
-    std::size_t executed = 0;
+    std::vector<const policy_evaluation_result*> runnable;
     for (const auto& action : actions) {
         if (action.blocked_by_retention) continue;
         if (action.target_tier == action.current_tier) continue;
+        runnable.push_back(&action);
+    }
 
-        auto result = execute_action(
-            action.key, action.target_tier, action.recommended_action);
+    std::size_t executed = 0;
+    if (impl_->max_concurrent_actions <= 1 || runnable.size() <= 1) {
+        for (const auto* action : runnable) {
+            auto result = execute_action(
+                action->key, action->target_tier, action->recommended_action);
 
-        if (result.has_value()) {
+            if (result.has_value()) {
+                executed++;
+            }
+        }
+        return result<std::size_t>(executed);
+    }
+
+    // The lane limit bounds how many moves run at once
+    std::vector<std::future<result<void>>> running;
+    running.reserve(runnable.size());
+    for (const auto* action : runnable) {
+        running.push_back(impl_->io.submit([this, action]() {
+            return execute_action(
+                action->key, action->target_tier, action->recommended_action);
+        }));
+    }
+    for (auto& future : running) {
+        // Actions the executor rejects complete with an error
+        if (future.get().has_value()) {
             executed++;
         }
     }
@@ -593,7 +1122,8 @@ auto storage_policy::execute_action(
         case tiering_action::move:
         case tiering_action::copy:
         case tiering_action::archive:
-            action_result = impl_->manager->change_tier(key, target_tier);
+            action_result = impl_->manager->change_tier(
+                key, target_tier, stream_copy_options{.limiter = impl_->limiter});
             break;
 
         case tiering_action::delete_obj:
@@ -621,6 +1151,8 @@ void storage_policy::add_rule(tiering_rule rule) {
         [](const tiering_rule& a, const tiering_rule& b) {
             return a.priority > b.priority;
         });
+    lock.unlock();
+    impl_->rules_changed();
 }
 
 auto storage_policy::remove_rule(const std::string& name) -> bool {
@@ -630,6 +1162,8 @@ auto storage_policy::remove_rule(const std::string& name) -> bool {
 
     if (it != impl_->rules.end()) {
         impl_->rules.erase(it, impl_->rules.end());
+        lock.unlock();
+        impl_->rules_changed();
         return true;
     }
     return false;
@@ -647,6 +1181,8 @@ void storage_policy::set_rule_enabled(const std::string& name, bool enable) {
             break;
         }
     }
+    lock.unlock();
+    impl_->rules_changed();
 }
 
 auto storage_policy::can_delete(const std::string& key) -> result<bool> {
@@ -723,8 +1259,11 @@ auto storage_policy::retention() const -> const retention_policy& {
 }
 
 void storage_policy::set_retention(retention_policy policy) {
-    std::lock_guard lock(impl_->retention_mutex);
-    impl_->retention_policy_ = std::move(policy);
+    {
+        std::lock_guard lock(impl_->retention_mutex);
+        impl_->retention_policy_ = std::move(policy);
+    }
+    impl_->rules_changed();
 }
 
 auto storage_policy::get_statistics() const -> tiering_statistics {
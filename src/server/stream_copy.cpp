@@ -0,0 +1,170 @@
+/**
+ * @file stream_copy.cpp
+ * @brief Bounded-memory streaming copy implementation
+ */
+
+#include "kcenon/file_transfer/server/stream_copy.h"
+
+#include "kcenon/file_transfer/core/bandwidth_limiter.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace kcenon::file_transfer {
+
+namespace {
+
+struct filled_buffer {
+    std::vector<std::byte> data;
+    std::size_t size = 0;
+};
+
+struct buffer_ring {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::vector<std::byte>> free;
+    std::deque<filled_buffer> filled;
+    std::optional<error> read_error;
+    bool end_of_stream = false;
+    bool cancelled = false;
+};
+
+// Fills free buffers from the source until it ends, fails or is cancelled
+auto produce(const stream_source& source, buffer_ring& ring) -> void {
+    while (true) {
+        std::vector<std::byte> buffer;
+        {
+            std::unique_lock lock(ring.mutex);
+            ring.changed.wait(lock, [&] { return ring.cancelled || !ring.free.empty(); });
+            if (ring.cancelled) return;
+            buffer = std::move(ring.free.back());
+            ring.free.pop_back();
+        }
+
+        // Fill the whole buffer so every chunk but the last is full-sized
+        std::size_t size = 0;
+        bool ended = false;
+        std::optional<error> failure;
+        while (size < buffer.size()) {
+            result<std::size_t> read;
+            try {
+                read = source(std::span<std::byte>(buffer).subspan(size));
+            } catch (const std::exception& e) {
+                read = unexpected{error{error_code::file_read_error,
+                    std::string("Stream source failed: ") + e.what()}};
+            }
+            if (!read.has_value()) {
+                failure = read.error();
+                break;
+            }
+            if (read.value() == 0) {
+                ended = true;
+                break;
+            }
+            size += read.value();
+        }
+
+        std::lock_guard lock(ring.mutex);
+        if (size > 0 && !failure) {
+            ring.filled.push_back(filled_buffer{std::move(buffer), size});
+        }
+        if (failure) {
+            ring.read_error = std::move(failure);
+        }
+        ring.end_of_stream = ended || ring.read_error.has_value();
+        ring.changed.notify_all();
+        if (ring.end_of_stream) return;
+    }
+}
+
+// Takes tokens in slices no larger than the bucket so large buffers cannot stall
+auto throttle(bandwidth_limiter& limiter, std::size_t bytes) -> void {
+    auto slice = std::max<std::size_t>(limiter.bucket_capacity(), 1);
+    while (bytes > 0 && limiter.is_enabled()) {
+        auto take = std::min(bytes, slice);
+        limiter.acquire(take);
+        bytes -= take;
+    }
+}
+
+}  // namespace
+
+auto stream_copy(
+    const stream_source& source,
+    const stream_sink& sink,
+    const stream_copy_options& options) -> result<uint64_t> {
+
+    if (!source || !sink) {
+        return unexpected{error{error_code::invalid_configuration,
+                               "Stream copy needs a source and a sink"}};
+    }
+
+    buffer_ring ring;
+    auto buffer_size = std::max<std::size_t>(options.buffer_size, 1);
+    auto buffer_count = std::max<std::size_t>(options.buffer_count, 1);
+    ring.free.reserve(buffer_count);
+    for (std::size_t i = 0; i < buffer_count; ++i) {
+        ring.free.emplace_back(buffer_size);
+    }
+
+    // A dedicated thread rather than an io_executor task: the reader blocks on
+    // the sink for the whole copy and would hold a worker that long, or run
+    // inline and deadlock on the full ring when copying from a blocking task
+    std::thread reader([&] { produce(source, ring); });
+
+    uint64_t copied = 0;
+    std::optional<error> write_error;
+    while (true) {
+        filled_buffer chunk;
+        {
+            std::unique_lock lock(ring.mutex);
+            ring.changed.wait(lock, [&] { return !ring.filled.empty() || ring.end_of_stream; });
+            if (ring.filled.empty()) break;
+            chunk = std::move(ring.filled.front());
+            ring.filled.pop_front();
+        }
+
+        if (options.limiter) {
+            throttle(*options.limiter, chunk.size);
+        }
+
+        result<void> written;
+        try {
+            written = sink(std::span<const std::byte>(chunk.data.data(), chunk.size));
+        } catch (const std::exception& e) {
+            written = unexpected{error{error_code::file_write_error,
+                std::string("Stream sink failed: ") + e.what()}};
+        }
+        if (!written.has_value()) {
+            write_error = written.error();
+            break;
+        }
+        copied += chunk.size;
+
+        std::lock_guard lock(ring.mutex);
+        ring.free.push_back(std::move(chunk.data));
+        ring.changed.notify_all();
+    }
+
+    {
+        std::lock_guard lock(ring.mutex);
+        ring.cancelled = true;
+        ring.changed.notify_all();
+    }
+    reader.join();
+
+    if (write_error) {
+        return unexpected{*write_error};
+    }
+    if (ring.read_error) {
+        return unexpected{*ring.read_error};
+    }
+    return copied;
+}
+
+}  // namespace kcenon::file_transfer
@@ -184,7 +184,7 @@ TEST_F(BuilderTest, ClientBuilderInvalidChunkSize) {
 
     // Chunk size too large
     auto result2 = file_transfer_client::builder()
-        .with_chunk_size(2 * 1024 * 1024)
+        .with_chunk_size(128 * 1024 * 1024)
         .build();
     EXPECT_FALSE(result2.has_value());
     EXPECT_EQ(result2.error().code, error_code::invalid_chunk_size);
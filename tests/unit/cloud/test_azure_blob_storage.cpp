@@ -7,6 +7,9 @@
 
 #include "kcenon/file_transfer/cloud/azure_blob_storage.h"
 
+#include <filesystem>
+#include <fstream>
+
 namespace kcenon::file_transfer {
 namespace {
 
@@ -574,6 +577,37 @@ TEST_F(AzureBlobUploadStreamTest, AbortStream) {
     EXPECT_TRUE(result.has_value());
 }
 
+TEST_F(AzureBlobUploadStreamTest, UploadFileStreamsBlocksFromDisk) {
+    auto path = std::filesystem::temp_directory_path() / "azure_streaming_upload_test.bin";
+    constexpr std::size_t file_size = 600 * 1024 + 17;
+    {
+        std::ofstream file(path, std::ios::binary);
+        std::vector<char> data(file_size, 'a');
+        file.write(data.data(), static_cast<std::streamsize>(file_size));
+    }
+
+    multipart_config multipart;
+    multipart.threshold = 256 * 1024;
+    multipart.part_size = 256 * 1024;
+    multipart.max_concurrent_parts = 2;
+
+    auto config = cloud_config_builder::azure_blob()
+        .with_account_name("mystorageaccount")
+        .with_bucket("test-container")
+        .with_multipart(multipart)
+        .build_azure_blob();
+    auto storage = azure_blob_storage::create(config, provider_, mock_http_client_);
+    ASSERT_NE(storage, nullptr);
+    storage->connect();
+
+    auto result = storage->upload_file(path, "stream/file-from-disk.bin");
+    std::filesystem::remove(path);
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value().bytes_uploaded, file_size);
+    EXPECT_EQ(storage->get_statistics().bytes_uploaded, file_size);
+}
+
 // ============================================================================
 // Azure Blob SAS Token Tests
 // ============================================================================
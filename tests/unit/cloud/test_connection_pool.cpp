@@ -0,0 +1,248 @@
+/**
+ * @file test_connection_pool.cpp
+ * @brief Unit tests for the per-endpoint cloud connection pool
+ */
+
+#include <gtest/gtest.h>
+
+#include "kcenon/file_transfer/cloud/cloud_connection_pool.h"
+#include "kcenon/file_transfer/cloud/cloud_utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace kcenon::file_transfer {
+namespace {
+
+struct fake_connection {
+    int id = 0;
+    std::string endpoint;
+    bool healthy = true;
+};
+
+class ConnectionPoolTest : public ::testing::Test {
+protected:
+    using pool_type = connection_pool<fake_connection>;
+
+    auto make_pool(connection_pool_config config,
+                   pool_type::health_check_type health_check = {})
+        -> std::unique_ptr<pool_type> {
+        return std::make_unique<pool_type>(
+            config,
+            [this](const std::string& endpoint) {
+                auto connection = std::make_shared<fake_connection>();
+                connection->id = ++opened_;
+                connection->endpoint = endpoint;
+                return connection;
+            },
+            std::move(health_check));
+    }
+
+    static auto small_config(std::size_t max_connections) -> connection_pool_config {
+        connection_pool_config config;
+        config.max_connections_per_endpoint = max_connections;
+        config.acquire_timeout = std::chrono::milliseconds(50);
+        return config;
+    }
+
+    std::atomic<int> opened_{0};
+};
+
+TEST_F(ConnectionPoolTest, ReleasedConnectionIsReused) {
+    auto pool = make_pool(small_config(4));
+
+    int first_id = 0;
+    {
+        auto lease = pool->acquire("https://a:443");
+        ASSERT_TRUE(lease.has_value());
+        first_id = lease.value()->id;
+    }
+    {
+        auto lease = pool->acquire("https://a:443");
+        ASSERT_TRUE(lease.has_value());
+        EXPECT_EQ(lease.value()->id, first_id);
+    }
+
+    auto stats = pool->statistics();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.idle, 1);
+    EXPECT_EQ(stats.leased, 0);
+    EXPECT_EQ(opened_.load(), 1);
+}
+
+TEST_F(ConnectionPoolTest, EndpointsArePooledSeparately) {
+    auto pool = make_pool(small_config(4));
+
+    { auto lease = pool->acquire("https://a:443"); }
+    auto other = pool->acquire("https://b:443");
+    ASSERT_TRUE(other.has_value());
+    EXPECT_EQ(other.value()->endpoint, "https://b:443");
+    EXPECT_EQ(pool->statistics().misses, 2);
+    EXPECT_EQ(pool->statistics().hits, 0);
+}
+
+TEST_F(ConnectionPoolTest, LimitBlocksUntilRelease) {
+    auto config = small_config(1);
+    config.acquire_timeout = std::chrono::seconds(2);
+    auto pool = make_pool(config);
+
+    auto held = pool->acquire("https://a:443");
+    ASSERT_TRUE(held.has_value());
+    int held_id = held.value()->id;
+
+    auto waiter = std::async(std::launch::async, [&] {
+        auto lease = pool->acquire("https://a:443");
+        return lease.has_value() ? lease.value()->id : -1;
+    });
+    EXPECT_EQ(waiter.wait_for(std::chrono::milliseconds(30)), std::future_status::timeout);
+
+    held = pool_type::lease{};
+    EXPECT_EQ(waiter.get(), held_id);
+    EXPECT_EQ(pool->statistics().waits, 1);
+    EXPECT_EQ(opened_.load(), 1);
+}
+
+TEST_F(ConnectionPoolTest, ExhaustedPoolTimesOut) {
+    auto pool = make_pool(small_config(2));
+
+    auto a = pool->acquire("https://a:443");
+    auto b = pool->acquire("https://a:443");
+    ASSERT_TRUE(a.has_value());
+    ASSERT_TRUE(b.has_value());
+
+    auto c = pool->acquire("https://a:443");
+    ASSERT_FALSE(c.has_value());
+    EXPECT_EQ(c.error().code, error_code::connection_timeout);
+    EXPECT_EQ(pool->statistics().timeouts, 1);
+    EXPECT_EQ(pool->statistics().leased, 2);
+}
+
+TEST_F(ConnectionPoolTest, BrokenConnectionIsNotReused) {
+    auto pool = make_pool(small_config(2));
+
+    int broken_id = 0;
+    {
+        auto lease = pool->acquire("https://a:443");
+        ASSERT_TRUE(lease.has_value());
+        broken_id = lease.value()->id;
+        lease.value().mark_broken();
+    }
+
+    auto lease = pool->acquire("https://a:443");
+    ASSERT_TRUE(lease.has_value());
+    EXPECT_NE(lease.value()->id, broken_id);
+    EXPECT_EQ(pool->statistics().discarded, 1);
+    EXPECT_EQ(pool->statistics().misses, 2);
+}
+
+TEST_F(ConnectionPoolTest, UnhealthyIdleConnectionIsReplaced) {
+    auto pool = make_pool(small_config(2),
+                          [](const fake_connection& connection) { return connection.healthy; });
+
+    int first_id = 0;
+    {
+        auto lease = pool->acquire("https://a:443");
+        ASSERT_TRUE(lease.has_value());
+        first_id = lease.value()->id;
+        lease.value()->healthy = false;
+    }
+
+    auto lease = pool->acquire("https://a:443");
+    ASSERT_TRUE(lease.has_value());
+    EXPECT_NE(lease.value()->id, first_id);
+    EXPECT_EQ(pool->statistics().discarded, 1);
+    EXPECT_EQ(pool->statistics().hits, 0);
+}
+
+TEST_F(ConnectionPoolTest, IdleConnectionsAreReaped) {
+    auto config = small_config(4);
+    config.idle_timeout = std::chrono::milliseconds(10);
+    auto pool = make_pool(config);
+
+    { auto lease = pool->acquire("https://a:443"); }
+    EXPECT_EQ(pool->statistics().idle, 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(pool->reap_idle(), 1);
+    EXPECT_EQ(pool->statistics().idle, 0);
+
+    // The next acquire opens a fresh connection
+    { auto lease = pool->acquire("https://a:443"); }
+    EXPECT_EQ(pool->statistics().misses, 2);
+}
+
+TEST_F(ConnectionPoolTest, KeepAliveDisabledNeverReuses) {
+    auto config = small_config(4);
+    config.keep_alive = false;
+    auto pool = make_pool(config);
+
+    for (int i = 0; i < 3; ++i) {
+        auto lease = pool->acquire("https://a:443");
+        ASSERT_TRUE(lease.has_value());
+    }
+
+    auto stats = pool->statistics();
+    EXPECT_EQ(stats.misses, 3);
+    EXPECT_EQ(stats.hits, 0);
+    EXPECT_EQ(stats.idle, 0);
+}
+
+TEST_F(ConnectionPoolTest, ConcurrentLeasesStayWithinLimit) {
+    auto config = small_config(3);
+    config.acquire_timeout = std::chrono::seconds(5);
+    auto pool = make_pool(config);
+
+    std::atomic<int> active{0};
+    std::atomic<int> peak{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 20; ++i) {
+                auto lease = pool->acquire("https://a:443");
+                ASSERT_TRUE(lease.has_value());
+                int now = ++active;
+                int expected = peak.load();
+                while (now > expected && !peak.compare_exchange_weak(expected, now)) {
+                }
+                std::this_thread::yield();
+                --active;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    auto stats = pool->statistics();
+    EXPECT_LE(peak.load(), 3);
+    EXPECT_LE(opened_.load(), 3);
+    EXPECT_EQ(stats.hits + stats.misses, 160);
+    EXPECT_EQ(stats.leased, 0);
+}
+
+TEST_F(ConnectionPoolTest, MakeConfigFromStorageConfig) {
+    s3_config storage;
+    storage.connection_pool_size = 7;
+    storage.keep_alive = false;
+    storage.idle_connection_timeout = std::chrono::milliseconds(1234);
+
+    auto config = make_connection_pool_config(storage);
+    EXPECT_EQ(config.max_connections_per_endpoint, 7);
+    EXPECT_FALSE(config.keep_alive);
+    EXPECT_EQ(config.idle_timeout, std::chrono::milliseconds(1234));
+}
+
+TEST_F(ConnectionPoolTest, ConnectionEndpointNormalizesUrls) {
+    using cloud_utils::connection_endpoint;
+    EXPECT_EQ(connection_endpoint("https://Bucket.S3.amazonaws.com/key?x=1"),
+              "https://bucket.s3.amazonaws.com:443");
+    EXPECT_EQ(connection_endpoint("http://localhost:9000/bucket/key"), "http://localhost:9000");
+    EXPECT_EQ(connection_endpoint("http://minio/bucket"), "http://minio:80");
+    EXPECT_EQ(connection_endpoint("https://[::1]/x"), "https://[::1]:443");
+    EXPECT_EQ(connection_endpoint("https://[::1]:8443/x"), "https://[::1]:8443");
+}
+
+}  // namespace
+}  // namespace kcenon::file_transfer
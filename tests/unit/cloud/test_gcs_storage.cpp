@@ -7,6 +7,9 @@
 
 #include "kcenon/file_transfer/cloud/gcs_storage.h"
 
+#include <filesystem>
+#include <fstream>
+
 namespace kcenon::file_transfer {
 namespace {
 
@@ -748,6 +751,37 @@ TEST_F(GcsStorageStreamTest, CreateDownloadStream) {
     EXPECT_EQ(stream->bytes_read(), 0);
 }
 
+TEST_F(GcsStorageStreamTest, UploadFileStreamsChunksFromDisk) {
+    auto path = std::filesystem::temp_directory_path() / "gcs_streaming_upload_test.bin";
+    constexpr std::size_t file_size = 600 * 1024 + 17;
+    {
+        std::ofstream file(path, std::ios::binary);
+        std::vector<char> data(file_size, 'g');
+        file.write(data.data(), static_cast<std::streamsize>(file_size));
+    }
+
+    multipart_config multipart;
+    multipart.threshold = 256 * 1024;
+    multipart.part_size = 256 * 1024;
+    multipart.max_concurrent_parts = 2;
+
+    auto config = cloud_config_builder::gcs()
+        .with_project_id("my-project-id")
+        .with_bucket("my-bucket")
+        .with_multipart(multipart)
+        .build_gcs();
+    auto storage = gcs_storage::create(config, provider_, mock_http_client_);
+    ASSERT_NE(storage, nullptr);
+    storage->connect();
+
+    auto result = storage->upload_file(path, "test/streamed-file.bin");
+    std::filesystem::remove(path);
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value().bytes_uploaded, file_size);
+    EXPECT_EQ(storage->get_statistics().bytes_uploaded, file_size);
+}
+
 // ============================================================================
 // GCS-specific Feature Tests
 // ============================================================================
@@ -0,0 +1,190 @@
+/**
+ * @file test_parallel_download.cpp
+ * @brief Unit tests for the parallel ranged download engine
+ */
+
+#include <gtest/gtest.h>
+
+#include "kcenon/file_transfer/cloud/cloud_utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kcenon::file_transfer {
+namespace {
+
+using cloud_utils::byte_range;
+
+class ParallelDownloadTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = std::filesystem::temp_directory_path() / "parallel_download_test";
+        std::filesystem::remove_all(test_dir_);
+        std::filesystem::create_directories(test_dir_);
+
+        object_.resize(100 * 1024 + 17);
+        for (std::size_t i = 0; i < object_.size(); ++i) {
+            object_[i] = static_cast<std::byte>((i * 31 + 7) & 0xFF);
+        }
+
+        config_.range_size = 8 * 1024;
+        config_.max_range_retries = 3;
+
+        retry_.initial_delay = std::chrono::milliseconds(1);
+        retry_.max_delay = std::chrono::milliseconds(5);
+        retry_.use_jitter = false;
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(test_dir_, ec);
+    }
+
+    auto slice(const byte_range& range) const -> std::vector<std::byte> {
+        auto first = object_.begin() + static_cast<std::ptrdiff_t>(range.offset);
+        return std::vector<std::byte>(first, first + static_cast<std::ptrdiff_t>(range.length));
+    }
+
+    auto read_file(const std::filesystem::path& path) const -> std::vector<std::byte> {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<char> data((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+        std::vector<std::byte> bytes(data.size());
+        std::memcpy(bytes.data(), data.data(), data.size());
+        return bytes;
+    }
+
+    auto run(const cloud_utils::range_reader& reader, std::size_t max_concurrency)
+        -> result<cloud_utils::parallel_download_result> {
+        io_scope io("parallel-download-test", executor_);
+        io.set_concurrency_limit(max_concurrency);
+        return cloud_utils::download_ranges_to_file(
+            io, reader, object_.size(), target_, config_, max_concurrency, retry_);
+    }
+
+    std::filesystem::path test_dir_;
+    std::filesystem::path target_ = std::filesystem::temp_directory_path() /
+                                    "parallel_download_test" / "nested" / "object.bin";
+    std::vector<std::byte> object_;
+    parallel_download_config config_;
+    cloud_retry_policy retry_;
+    io_executor executor_{io_executor_config{8, 1000, 0}};
+};
+
+TEST_F(ParallelDownloadTest, SplitByteRanges_CoversObject) {
+    auto ranges = cloud_utils::split_byte_ranges(20, 8);
+    ASSERT_EQ(ranges.size(), 3);
+    EXPECT_EQ(ranges[0].offset, 0);
+    EXPECT_EQ(ranges[0].length, 8);
+    EXPECT_EQ(ranges[2].offset, 16);
+    EXPECT_EQ(ranges[2].length, 4);
+
+    EXPECT_TRUE(cloud_utils::split_byte_ranges(0, 8).empty());
+    EXPECT_EQ(cloud_utils::split_byte_ranges(16, 8).size(), 2);
+}
+
+TEST_F(ParallelDownloadTest, FormatRangeHeader_IsInclusive) {
+    EXPECT_EQ(cloud_utils::format_range_header(byte_range{0, 8}), "bytes=0-7");
+    EXPECT_EQ(cloud_utils::format_range_header(byte_range{16, 4}), "bytes=16-19");
+}
+
+TEST_F(ParallelDownloadTest, WritesRangesIntoFile) {
+    auto res = run([this](const byte_range& range) -> result<std::vector<std::byte>> {
+        return slice(range);
+    }, 4);
+
+    ASSERT_TRUE(res.has_value()) << res.error().message;
+    EXPECT_EQ(res.value().bytes_written, object_.size());
+    EXPECT_EQ(res.value().range_count, 13);
+    EXPECT_EQ(res.value().retried_ranges, 0);
+    EXPECT_EQ(read_file(target_), object_);
+}
+
+TEST_F(ParallelDownloadTest, ConcurrencyIsBounded) {
+    std::atomic<int> running{0};
+    std::atomic<int> peak{0};
+
+    auto res = run([&](const byte_range& range) -> result<std::vector<std::byte>> {
+        int now = ++running;
+        int expected = peak.load();
+        while (now > expected && !peak.compare_exchange_weak(expected, now)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        --running;
+        return slice(range);
+    }, 3);
+
+    ASSERT_TRUE(res.has_value()) << res.error().message;
+    EXPECT_LE(peak.load(), 3);
+    EXPECT_GE(peak.load(), 1);
+}
+
+TEST_F(ParallelDownloadTest, RetriesOnlyTheFailedRange) {
+    std::mutex mutex;
+    std::map<uint64_t, int> calls;
+
+    auto res = run([&](const byte_range& range) -> result<std::vector<std::byte>> {
+        int attempt;
+        {
+            std::lock_guard lock(mutex);
+            attempt = ++calls[range.offset];
+        }
+        if (range.offset == 5 * config_.range_size && attempt == 1) {
+            return unexpected{error{error_code::connection_failed, "reset"}};
+        }
+        return slice(range);
+    }, 4);
+
+    ASSERT_TRUE(res.has_value()) << res.error().message;
+    EXPECT_EQ(res.value().retried_ranges, 1);
+    EXPECT_EQ(read_file(target_), object_);
+    for (const auto& [offset, count] : calls) {
+        EXPECT_EQ(count, offset == 5 * config_.range_size ? 2 : 1) << "offset " << offset;
+    }
+}
+
+TEST_F(ParallelDownloadTest, NonRetryableErrorRemovesFile) {
+    std::atomic<int> calls{0};
+
+    auto res = run([&](const byte_range& range) -> result<std::vector<std::byte>> {
+        ++calls;
+        if (range.offset == 2 * config_.range_size) {
+            return unexpected{error{error_code::file_hash_mismatch, "changed"}};
+        }
+        return slice(range);
+    }, 2);
+
+    ASSERT_FALSE(res.has_value());
+    EXPECT_EQ(res.error().code, error_code::file_hash_mismatch);
+    EXPECT_FALSE(std::filesystem::exists(target_));
+    EXPECT_LT(calls.load(), 13);
+}
+
+TEST_F(ParallelDownloadTest, ShortRangeIsRetriedThenFails) {
+    std::atomic<int> short_calls{0};
+
+    auto res = run([&](const byte_range& range) -> result<std::vector<std::byte>> {
+        auto data = slice(range);
+        if (range.offset == 0) {
+            ++short_calls;
+            data.resize(data.size() / 2);
+        }
+        return data;
+    }, 4);
+
+    ASSERT_FALSE(res.has_value());
+    EXPECT_EQ(res.error().code, error_code::chunk_size_error);
+    EXPECT_EQ(short_calls.load(), 1 + static_cast<int>(config_.max_range_retries));
+    EXPECT_FALSE(std::filesystem::exists(target_));
+}
+
+}  // namespace
+}  // namespace kcenon::file_transfer
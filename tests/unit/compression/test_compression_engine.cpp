@@ -200,6 +200,24 @@ TEST_F(CompressionEngineTest, IsCompressible_SmallSample) {
     [[maybe_unused]] bool result = engine_->is_compressible(small);
 }
 
+TEST_F(CompressionEngineTest, IsCompressible_WithEntropy) {
+    auto text_data = create_text_data(10000);
+    auto random_data = create_random_data(10000);
+    std::vector<std::byte> zeros(10000);
+
+    // Decided by the entropy alone
+    EXPECT_FALSE(engine_->is_compressible(text_data, 7.95));
+    EXPECT_TRUE(engine_->is_compressible(random_data, 0.5));
+    EXPECT_TRUE(engine_->is_compressible(zeros, 0.0));
+
+    // In between, the trial compression decides
+    EXPECT_TRUE(engine_->is_compressible(text_data, 4.0));
+    EXPECT_FALSE(engine_->is_compressible(random_data, 4.0));
+
+    std::vector<std::byte> empty;
+    EXPECT_FALSE(engine_->is_compressible(empty, 0.0));
+}
+
 // Pre-compressed Format Detection Tests
 
 TEST_F(CompressionEngineTest, IsCompressible_ZipFile) {
@@ -0,0 +1,350 @@
+/**
+ * @file test_stream_compression.cpp
+ * @brief Unit tests for stream_compressor and stream_decompressor
+ */
+
+#include <gtest/gtest.h>
+
+#include <kcenon/file_transfer/core/compression_engine.h>
+#include <kcenon/file_transfer/core/stream_compression.h>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace kcenon::file_transfer::test {
+
+TEST(StreamCompressionConfigTest, Validation) {
+    EXPECT_TRUE(stream_compression_config{}.validate().has_value());
+
+    stream_compression_config no_segments;
+    no_segments.resync_interval = 0;
+    EXPECT_FALSE(no_segments.validate().has_value());
+
+    stream_compression_config too_wide;
+    too_wide.window_size = stream_compression_config::max_window_size + 1;
+    EXPECT_FALSE(too_wide.validate().has_value());
+
+    stream_compression_config four;
+    four.resync_interval = 4;
+    EXPECT_EQ(four.segment_start(0), 0);
+    EXPECT_EQ(four.segment_start(3), 0);
+    EXPECT_EQ(four.segment_start(4), 4);
+    EXPECT_EQ(four.segment_start(9), 8);
+}
+
+#ifndef FILE_TRANS_ENABLE_LZ4
+
+// Skip all compression tests when LZ4 is not enabled
+class StreamCompressionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        GTEST_SKIP() << "LZ4 compression is not enabled";
+    }
+};
+
+#else
+
+class StreamCompressionTest : public ::testing::Test {
+protected:
+    // Log lines: the same few templates with changing numbers, so most
+    // repeats lie in earlier chunks rather than in the chunk itself
+    static auto create_log_data(std::size_t size, unsigned int seed = 42)
+        -> std::vector<std::byte> {
+        static const char* const templates[] = {
+            "INFO  [worker-%02u] chunk %08u of transfer %04x written in %u us\n",
+            "DEBUG [session-%02u] heartbeat ack after %u ms, window %u, rtt %u us\n",
+            "WARN  [pipeline-%02u] queue %u above high-water mark, %u stalls, %u us\n",
+        };
+        std::mt19937 gen(seed);
+        std::string text;
+        char line[160];
+        while (text.size() < size) {
+            auto n = std::snprintf(line, sizeof(line), templates[gen() % 3], gen() % 16,
+                                   gen() % 100000, gen() % 65536, gen() % 10000);
+            text.append(line, static_cast<std::size_t>(n));
+        }
+        std::vector<std::byte> data(size);
+        std::memcpy(data.data(), text.data(), size);
+        return data;
+    }
+
+    static auto split(const std::vector<std::byte>& data, std::size_t chunk_size)
+        -> std::vector<chunk> {
+        std::vector<chunk> chunks;
+        for (std::size_t offset = 0; offset < data.size(); offset += chunk_size) {
+            auto size = std::min(chunk_size, data.size() - offset);
+            chunk c;
+            c.header.chunk_index = chunks.size();
+            c.header.chunk_offset = offset;
+            c.header.original_size = static_cast<uint32_t>(size);
+            c.header.compressed_size = static_cast<uint32_t>(size);
+            c.data.assign(data.begin() + static_cast<std::ptrdiff_t>(offset),
+                          data.begin() + static_cast<std::ptrdiff_t>(offset + size));
+            chunks.push_back(std::move(c));
+        }
+        return chunks;
+    }
+
+    static auto restore(stream_decompressor& decompressor, const chunk& c)
+        -> result<std::vector<std::byte>> {
+        if (!c.is_compressed()) {
+            decompressor.record(c.header.chunk_index, c.header.flags, c.data,
+                                c.header.original_size);
+            return c.data;
+        }
+        return decompressor.decompress(c.header.chunk_index, c.header.flags, c.data,
+                                       c.header.original_size);
+    }
+
+    static auto total_size(const std::vector<chunk>& chunks) -> std::size_t {
+        std::size_t total = 0;
+        for (const auto& c : chunks) {
+            total += c.data.size();
+        }
+        return total;
+    }
+};
+
+TEST_F(StreamCompressionTest, LinkedChunksRoundTrip) {
+    auto data = create_log_data(256 * 1024);
+    auto originals = split(data, 8 * 1024);
+    auto chunks = originals;
+
+    stream_compressor compressor;
+    for (auto& c : chunks) {
+        ASSERT_TRUE(compressor.compress(c).has_value());
+        EXPECT_TRUE(c.is_compressed());
+        EXPECT_EQ(c.header.compressed_size, c.data.size());
+        // Only the first chunk of a segment stands alone
+        auto first = c.header.chunk_index % stream_compression_config::default_resync_interval == 0;
+        EXPECT_EQ(is_linked(c.header.flags), !first) << c.header.chunk_index;
+    }
+
+    stream_decompressor decompressor;
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        ASSERT_TRUE(decompressor.ready(i, chunks[i].header.flags));
+        auto restored = restore(decompressor, chunks[i]);
+        ASSERT_TRUE(restored.has_value()) << restored.error().message;
+        EXPECT_EQ(restored.value(), originals[i].data);
+    }
+
+    // Repeats across chunk boundaries beat compressing each chunk alone
+    compression_engine engine;
+    std::size_t independent = 0;
+    for (const auto& c : originals) {
+        independent += engine.compress(c.data).value().size();
+    }
+    EXPECT_LT(total_size(chunks), independent * 9 / 10);
+    EXPECT_EQ(compressor.stats().compressed_chunks, chunks.size());
+}
+
+TEST_F(StreamCompressionTest, FirstChunkOfSegmentIsPlainLz4) {
+    stream_compression_config config;
+    config.resync_interval = 4;
+    auto originals = split(create_log_data(64 * 1024), 4096);
+    auto chunks = originals;
+
+    stream_compressor compressor(config);
+    for (auto& c : chunks) {
+        ASSERT_TRUE(compressor.compress(c).has_value());
+    }
+
+    compression_engine engine;
+    for (uint64_t i : {0, 4, 8, 12}) {
+        EXPECT_FALSE(is_linked(chunks[i].header.flags));
+        auto plain = engine.decompress(chunks[i].data, chunks[i].header.original_size);
+        ASSERT_TRUE(plain.has_value());
+        EXPECT_EQ(plain.value(), originals[i].data);
+    }
+}
+
+TEST_F(StreamCompressionTest, OutOfOrderChunkWaitsForHistory) {
+    auto originals = split(create_log_data(32 * 1024), 4096);
+    auto chunks = originals;
+    stream_compressor compressor;
+    for (auto& c : chunks) {
+        ASSERT_TRUE(compressor.compress(c).has_value());
+    }
+
+    stream_decompressor decompressor;
+    ASSERT_TRUE(restore(decompressor, chunks[0]).has_value());
+
+    // Chunk 2 refers back into chunk 1, which has not arrived
+    EXPECT_FALSE(decompressor.ready(2, chunks[2].header.flags));
+    auto early = decompressor.decompress(2, chunks[2].header.flags, chunks[2].data,
+                                         chunks[2].header.original_size);
+    ASSERT_FALSE(early.has_value());
+    EXPECT_EQ(early.error().code, error_code::chunk_sequence_error);
+
+    ASSERT_TRUE(restore(decompressor, chunks[1]).has_value());
+    ASSERT_TRUE(decompressor.ready(2, chunks[2].header.flags));
+    auto restored = restore(decompressor, chunks[2]);
+    ASSERT_TRUE(restored.has_value());
+    EXPECT_EQ(restored.value(), originals[2].data);
+}
+
+TEST_F(StreamCompressionTest, RetransmissionIsCompressedAlone) {
+    auto originals = split(create_log_data(32 * 1024), 4096);
+    auto chunks = originals;
+    stream_compressor compressor;
+    for (std::size_t i = 0; i < 6; ++i) {
+        ASSERT_TRUE(compressor.compress(chunks[i]).has_value());
+    }
+
+    auto resent = originals[3];
+    ASSERT_TRUE(compressor.compress(resent).has_value());
+    EXPECT_TRUE(resent.is_compressed());
+    EXPECT_FALSE(is_linked(resent.header.flags));
+
+    // A receiver that has nothing else of the segment decodes it
+    stream_decompressor decompressor;
+    ASSERT_TRUE(decompressor.ready(3, resent.header.flags));
+    auto restored = restore(decompressor, resent);
+    ASSERT_TRUE(restored.has_value());
+    EXPECT_EQ(restored.value(), originals[3].data);
+
+    // ... and the stream carries on where it was
+    ASSERT_TRUE(compressor.compress(chunks[6]).has_value());
+    EXPECT_TRUE(is_linked(chunks[6].header.flags));
+    stream_decompressor in_order;
+    for (std::size_t i = 0; i <= 6; ++i) {
+        auto r = restore(in_order, chunks[i]);
+        ASSERT_TRUE(r.has_value());
+        EXPECT_EQ(r.value(), originals[i].data);
+    }
+}
+
+TEST_F(StreamCompressionTest, GapStopsLinkingUntilNextSegment) {
+    stream_compression_config config;
+    config.resync_interval = 4;
+    auto originals = split(create_log_data(32 * 1024), 4096);
+    auto chunks = originals;
+
+    stream_compressor compressor(config);
+    for (uint64_t i : {0, 1, 3, 4, 5}) {
+        ASSERT_TRUE(compressor.compress(chunks[i]).has_value());
+    }
+    EXPECT_TRUE(is_linked(chunks[1].header.flags));
+    EXPECT_FALSE(is_linked(chunks[3].header.flags));
+    EXPECT_FALSE(is_linked(chunks[4].header.flags));
+    EXPECT_TRUE(is_linked(chunks[5].header.flags));
+
+    stream_decompressor decompressor(config);
+    for (uint64_t i : {3, 4, 5}) {
+        ASSERT_TRUE(decompressor.ready(i, chunks[i].header.flags));
+        auto r = restore(decompressor, chunks[i]);
+        ASSERT_TRUE(r.has_value());
+        EXPECT_EQ(r.value(), originals[i].data);
+    }
+}
+
+TEST_F(StreamCompressionTest, UncompressedChunksStayInHistory) {
+    auto originals = split(create_log_data(32 * 1024), 4096);
+
+    // Chunk 2 becomes a run of zeros and chunk 3 is sent as is
+    originals[2].header.flags = chunk_flags::zero_range;
+    originals[2].data.clear();
+    auto chunks = originals;
+
+    stream_compressor compressor;
+    for (auto& c : chunks) {
+        auto mode = c.header.chunk_index == 3 ? compression_mode::disabled
+                                              : compression_mode::enabled;
+        ASSERT_TRUE(compressor.compress(c, mode).has_value());
+    }
+    EXPECT_TRUE(chunks[2].is_zero_range());
+    EXPECT_FALSE(chunks[3].is_compressed());
+    EXPECT_TRUE(is_linked(chunks[4].header.flags));
+
+    stream_decompressor decompressor;
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        auto r = restore(decompressor, chunks[i]);
+        ASSERT_TRUE(r.has_value());
+        EXPECT_EQ(r.value(), originals[i].data);
+    }
+}
+
+TEST_F(StreamCompressionTest, OldSegmentsAreDropped) {
+    stream_compression_config config;
+    config.resync_interval = 4;
+    auto originals = split(create_log_data(64 * 1024), 4096);
+    auto chunks = originals;
+    stream_compressor compressor(config);
+    for (auto& c : chunks) {
+        ASSERT_TRUE(compressor.compress(c).has_value());
+    }
+
+    // Everything but chunk 1 arrives; segment 0 falls out of the history
+    stream_decompressor decompressor(config);
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        if (i == 1 || i == 2 || i == 3) {
+            continue;
+        }
+        ASSERT_TRUE(restore(decompressor, chunks[i]).has_value()) << i;
+    }
+
+    // Chunk 2 will never be decodable; it is passed on to fail, not held
+    EXPECT_TRUE(decompressor.ready(2, chunks[2].header.flags));
+    auto stale = restore(decompressor, chunks[2]);
+    ASSERT_FALSE(stale.has_value());
+    EXPECT_EQ(stale.error().code, error_code::chunk_sequence_error);
+}
+
+TEST_F(StreamCompressionTest, HighLevelAndSmallWindow) {
+    for (auto level : {compression_level::fast, compression_level::high}) {
+        stream_compression_config config;
+        config.level = level;
+        config.window_size = 1024;
+        auto originals = split(create_log_data(64 * 1024), 3000);
+        auto chunks = originals;
+
+        stream_compressor compressor(config);
+        stream_decompressor decompressor(config);
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            ASSERT_TRUE(compressor.compress(chunks[i]).has_value());
+            auto r = restore(decompressor, chunks[i]);
+            ASSERT_TRUE(r.has_value()) << i;
+            EXPECT_EQ(r.value(), originals[i].data) << i;
+        }
+    }
+}
+
+TEST_F(StreamCompressionTest, LongSegmentOutgrowsTheBuffer) {
+    stream_compression_config config;
+    config.resync_interval = 1000;
+    auto originals = split(create_log_data(1024 * 1024), 5000);
+    auto chunks = originals;
+
+    stream_compressor compressor(config);
+    stream_decompressor decompressor(config);
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        auto mode = i % 7 == 3 ? compression_mode::disabled : compression_mode::enabled;
+        ASSERT_TRUE(compressor.compress(chunks[i], mode).has_value());
+        EXPECT_EQ(chunks[i].is_compressed(), mode == compression_mode::enabled) << i;
+        auto r = restore(decompressor, chunks[i]);
+        ASSERT_TRUE(r.has_value()) << i;
+        EXPECT_EQ(r.value(), originals[i].data) << i;
+    }
+}
+
+TEST_F(StreamCompressionTest, CorruptPayloadIsRejected) {
+    auto chunks = split(create_log_data(16 * 1024), 4096);
+    stream_compressor compressor;
+    for (auto& c : chunks) {
+        ASSERT_TRUE(compressor.compress(c).has_value());
+    }
+
+    stream_decompressor decompressor;
+    ASSERT_TRUE(restore(decompressor, chunks[0]).has_value());
+    chunks[1].data.resize(chunks[1].data.size() / 2);
+    EXPECT_FALSE(restore(decompressor, chunks[1]).has_value());
+
+    chunk compressed = chunks[2];
+    EXPECT_FALSE(compressor.compress(compressed).has_value());
+}
+
+#endif  // FILE_TRANS_ENABLE_LZ4
+
+}  // namespace kcenon::file_transfer::test
@@ -328,6 +328,28 @@ TEST_F(BandwidthLimiterTest, AcquireAsync_ReturnsValidFuture) {
     // Should complete without exception
 }
 
+TEST_F(BandwidthLimiterTest, AcquireAsync_WaitsForRefill) {
+    bandwidth_limiter limiter(1 * MB);
+    limiter.acquire(1 * MB);  // Drain the bucket
+
+    auto start = std::chrono::steady_clock::now();
+    auto future = limiter.acquire_async(100 * KB);
+    EXPECT_EQ(future.wait_for(std::chrono::milliseconds(20)), std::future_status::timeout);
+
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(80));
+}
+
+TEST_F(BandwidthLimiterTest, AcquireAsync_ReleasedOnDisable) {
+    bandwidth_limiter limiter(1 * KB);
+    limiter.acquire(1 * KB);
+
+    auto future = limiter.acquire_async(1 * MB);  // Would take ~17 minutes
+    limiter.disable();
+
+    EXPECT_EQ(future.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+}
+
 // Scoped acquire tests
 
 TEST_F(BandwidthLimiterTest, ScopedAcquire_AcquiresOnConstruction) {
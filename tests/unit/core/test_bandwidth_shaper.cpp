@@ -0,0 +1,206 @@
+/**
+ * @file test_bandwidth_shaper.cpp
+ * @brief Unit tests for hierarchical bandwidth shaping
+ */
+
+#include <gtest/gtest.h>
+
+#include <kcenon/file_transfer/core/bandwidth_shaper.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace kcenon::file_transfer::test {
+
+class BandwidthShaperTest : public ::testing::Test {
+protected:
+    static constexpr std::size_t MB = 1024 * 1024;
+    static constexpr std::size_t KB = 1024;
+
+    // Take chunks until the shaper refuses one
+    static auto drain(bandwidth_shaper& shaper, uint64_t tenant, const transfer_id& id,
+                      std::size_t chunk) -> std::size_t {
+        std::size_t taken = 0;
+        while (taken < 1000 && shaper.try_acquire(tenant, id, chunk)) {
+            ++taken;
+        }
+        return taken;
+    }
+
+    // Counts callbacks and lets the test wait for them
+    struct completions {
+        std::mutex mutex;
+        std::condition_variable cv;
+        int count = 0;
+
+        auto callback() -> bandwidth_shaper::ready_callback {
+            return [this] {
+                std::lock_guard lock(mutex);
+                ++count;
+                cv.notify_all();
+            };
+        }
+
+        auto wait_for(int n, std::chrono::milliseconds timeout) -> bool {
+            std::unique_lock lock(mutex);
+            return cv.wait_for(lock, timeout, [&] { return count >= n; });
+        }
+    };
+};
+
+TEST_F(BandwidthShaperTest, UnlimitedGrantsEverything) {
+    bandwidth_shaper shaper;
+    auto id = transfer_id::generate();
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(shaper.try_acquire(1, id, 10 * MB));
+    }
+    EXPECT_EQ(shaper.stats().granted, 100);
+    EXPECT_EQ(shaper.stats().granted_bytes, 1000 * MB);
+}
+
+TEST_F(BandwidthShaperTest, GlobalLimitRefusesPastBurst) {
+    // 64KB costs 62.5ms at 1MB/s, more than the 50ms burst
+    bandwidth_shaper shaper(1 * MB, std::chrono::milliseconds(50));
+    auto id = transfer_id::generate();
+    EXPECT_TRUE(shaper.try_acquire(1, id, 64 * KB));
+    EXPECT_FALSE(shaper.try_acquire(1, id, 64 * KB));
+    EXPECT_FALSE(shaper.try_acquire(2, transfer_id::generate(), 64 * KB));
+    EXPECT_EQ(shaper.global_limit(), 1 * MB);
+}
+
+TEST_F(BandwidthShaperTest, ParkedAcquireCompletesWithoutBlocking) {
+    bandwidth_shaper shaper(1 * MB, std::chrono::milliseconds(10));
+    auto id = transfer_id::generate();
+    ASSERT_TRUE(shaper.try_acquire(1, id, 32 * KB));
+
+    completions done;
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(shaper.acquire_or_park(1, id, 32 * KB, done.callback()));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(5));
+    EXPECT_EQ(shaper.stats().waiting, 1);
+
+    // The first 32KB (31ms) must mostly drain before the second is admitted
+    ASSERT_TRUE(done.wait_for(1, std::chrono::seconds(2)));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(15));
+
+    auto stats = shaper.stats();
+    EXPECT_EQ(stats.parked, 1);
+    EXPECT_EQ(stats.released, 1);
+    EXPECT_EQ(stats.waiting, 0);
+    EXPECT_EQ(stats.granted_bytes, 64 * KB);
+}
+
+TEST_F(BandwidthShaperTest, TenantGuaranteeHoldsWhenGlobalIsSpent) {
+    bandwidth_shaper shaper(1 * MB, std::chrono::milliseconds(50));
+    shaper.set_tenant_limits(1, {512 * KB, 0});
+    auto guaranteed = transfer_id::generate();
+    auto other = transfer_id::generate();
+
+    // Tenant 2 has no guarantee and uses up the global bucket
+    EXPECT_GT(drain(shaper, 2, other, 16 * KB), 0);
+    EXPECT_FALSE(shaper.try_acquire(2, other, 16 * KB));
+
+    // Tenant 1 still gets its guaranteed share
+    EXPECT_TRUE(shaper.try_acquire(1, guaranteed, 16 * KB));
+}
+
+TEST_F(BandwidthShaperTest, BorrowsCapacityAnIdleSiblingLeaves) {
+    bandwidth_shaper shaper(1 * MB, std::chrono::milliseconds(50));
+    shaper.set_tenant_limits(1, {256 * KB, 0});
+    shaper.set_tenant_limits(2, {256 * KB, 0});
+    auto id = transfer_id::generate();
+
+    // 256KB/s guaranteed allows 12.8KB in the burst window; the global
+    // 1MB/s allows 51.2KB, so tenant 1 borrows the rest while 2 is idle
+    auto taken = drain(shaper, 1, id, 4 * KB);
+    EXPECT_GE(taken, 12);
+    EXPECT_GT(shaper.stats().borrowed, 0);
+}
+
+TEST_F(BandwidthShaperTest, TenantCeilingCapsBorrowing) {
+    bandwidth_shaper shaper;  // No global limit
+    shaper.set_tenant_limits(1, {0, 1 * MB});
+    auto id = transfer_id::generate();
+
+    EXPECT_TRUE(shaper.try_acquire(1, id, 64 * KB));
+    EXPECT_FALSE(shaper.try_acquire(1, id, 64 * KB));
+    EXPECT_TRUE(shaper.try_acquire(2, transfer_id::generate(), 64 * KB));
+}
+
+TEST_F(BandwidthShaperTest, TransferLimitsApplyUnderTheirTenant) {
+    bandwidth_shaper shaper;
+    auto capped = transfer_id::generate();
+    auto free = transfer_id::generate();
+    shaper.set_transfer_limits(1, capped, {0, 1 * MB});
+
+    EXPECT_TRUE(shaper.try_acquire(1, capped, 64 * KB));
+    EXPECT_FALSE(shaper.try_acquire(1, capped, 64 * KB));
+    EXPECT_TRUE(shaper.try_acquire(1, free, 64 * KB));
+
+    // A tenant ceiling also binds the transfers below it
+    shaper.set_tenant_limits(1, {0, 1 * MB});
+    EXPECT_TRUE(shaper.try_acquire(1, free, 64 * KB));
+    EXPECT_FALSE(shaper.try_acquire(1, free, 64 * KB));
+
+    shaper.remove_transfer(capped);
+    shaper.set_tenant_limits(1, {});
+    EXPECT_TRUE(shaper.try_acquire(1, capped, 64 * KB));
+}
+
+TEST_F(BandwidthShaperTest, ResolvedPathSharesBuckets) {
+    bandwidth_shaper shaper;
+    auto id = transfer_id::generate();
+    shaper.set_transfer_limits(3, id, {0, 1 * MB});
+    auto path = shaper.resolve(3, id);
+
+    EXPECT_TRUE(shaper.try_acquire(path, 64 * KB));
+    EXPECT_FALSE(shaper.try_acquire(3, id, 64 * KB));
+    EXPECT_FALSE(shaper.try_acquire(path, 64 * KB));
+
+    // A default path is charged to the global bucket only
+    EXPECT_TRUE(shaper.try_acquire(bandwidth_shaper::path{}, 64 * KB));
+}
+
+TEST_F(BandwidthShaperTest, ReleaseAndDropParked) {
+    bandwidth_shaper shaper(64 * KB, std::chrono::milliseconds(10));
+    auto id = transfer_id::generate();
+    ASSERT_TRUE(shaper.try_acquire(1, id, 64 * KB));
+
+    completions done;
+    EXPECT_FALSE(shaper.acquire_or_park(1, id, 64 * KB, done.callback()));
+    EXPECT_FALSE(shaper.acquire_or_park(1, id, 64 * KB, done.callback()));
+    shaper.release_parked();
+    EXPECT_EQ(done.count, 2);
+
+    EXPECT_FALSE(shaper.acquire_or_park(1, id, 64 * KB, done.callback()));
+    shaper.drop_parked();
+    auto stats = shaper.stats();
+    EXPECT_EQ(stats.dropped, 1);
+    EXPECT_EQ(stats.waiting, 0);
+    EXPECT_EQ(done.count, 2);
+}
+
+TEST_F(BandwidthShaperTest, ParkedAcquiresFollowTheRate) {
+    // 64 x 16KB = 1MB at 2MB/s: about 0.5s once the burst is spent
+    bandwidth_shaper shaper(2 * MB, std::chrono::milliseconds(10));
+    auto id = transfer_id::generate();
+    completions done;
+    int parked = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 64; ++i) {
+        if (!shaper.acquire_or_park(1, id, 16 * KB, done.callback())) {
+            ++parked;
+        }
+    }
+    EXPECT_GT(parked, 60);
+    ASSERT_TRUE(done.wait_for(parked, std::chrono::seconds(5)));
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(400));
+    EXPECT_LE(elapsed, std::chrono::milliseconds(800));
+}
+
+}  // namespace kcenon::file_transfer::test
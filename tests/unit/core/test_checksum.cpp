@@ -156,6 +156,164 @@ TEST_F(ChecksumTest, CRC32_CorruptedDataDetection) {
     EXPECT_FALSE(checksum::verify_crc32(data, original_crc));
 }
 
+// Fused scan Tests
+
+TEST_F(ChecksumTest, Scan_MatchesCRC32AtEveryLengthAndAlignment) {
+    std::mt19937 gen(7);
+    std::vector<std::byte> data(300);
+    for (auto& b : data) {
+        b = static_cast<std::byte>(gen());
+    }
+
+    for (std::size_t offset = 0; offset < 8; ++offset) {
+        for (std::size_t length = 0; length + offset <= 100; ++length) {
+            std::span<const std::byte> part(data.data() + offset, length);
+            auto scan = checksum::scan(part);
+            ASSERT_EQ(scan.digest, checksum::crc32(part)) << offset << "+" << length;
+            EXPECT_EQ(scan.size, length);
+        }
+    }
+}
+
+TEST_F(ChecksumTest, Scan_CountsEveryByte) {
+    std::vector<std::byte> data(1000);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<std::byte>(i % 10);
+    }
+    auto scan = checksum::scan(data);
+
+    uint64_t total = 0;
+    for (std::size_t v = 0; v < 256; ++v) {
+        EXPECT_EQ(scan.histogram[v], v < 10 ? 100u : 0u) << v;
+        total += scan.histogram[v];
+    }
+    EXPECT_EQ(total, data.size());
+    EXPECT_FALSE(scan.all_zero());
+}
+
+TEST_F(ChecksumTest, Scan_Entropy) {
+    std::vector<std::byte> zeros(4096);
+    auto zero_scan = checksum::scan(zeros);
+    EXPECT_TRUE(zero_scan.all_zero());
+    EXPECT_DOUBLE_EQ(zero_scan.entropy(), 0.0);
+
+    // Two equally frequent values carry one bit each
+    std::vector<std::byte> two(4096);
+    for (std::size_t i = 0; i < two.size(); ++i) {
+        two[i] = static_cast<std::byte>(i & 1);
+    }
+    EXPECT_NEAR(checksum::scan(two).entropy(), 1.0, 0.01);
+
+    // Random data scores close to 8 even from a small sample
+    std::mt19937 gen(3);
+    std::vector<std::byte> random(4096);
+    for (auto& b : random) {
+        b = static_cast<std::byte>(gen());
+    }
+    EXPECT_GT(checksum::scan(random).entropy(), 7.9);
+    EXPECT_LE(checksum::scan(random).entropy(), 8.0);
+
+    EXPECT_DOUBLE_EQ(checksum::scan(std::span<const std::byte>{}).entropy(), 0.0);
+}
+
+// Integrity algorithm Tests
+
+TEST_F(ChecksumTest, CRC32C_KnownValue) {
+    // CRC32C("123456789") = 0xE3069283
+    std::string test_data = "123456789";
+    std::vector<std::byte> data(test_data.size());
+    std::memcpy(data.data(), test_data.data(), test_data.size());
+
+    EXPECT_EQ(checksum::crc32c(data), 0xE3069283u);
+    EXPECT_EQ(checksum::crc32c(std::span<const std::byte>{}), 0u);
+    EXPECT_EQ(checksum::digest(chunk_integrity::crc32c, data), 0xE3069283u);
+    EXPECT_EQ(checksum::digest(chunk_integrity::crc32, data), 0xCBF43926u);
+}
+
+TEST_F(ChecksumTest, CRC32C_MatchesBitwiseReference) {
+    // Exercises every tail length and alignment of the 8-byte steps
+    auto reference = [](std::span<const std::byte> data) {
+        uint32_t crc = 0xFFFFFFFF;
+        for (auto b : data) {
+            crc ^= static_cast<uint8_t>(b);
+            for (int k = 0; k < 8; ++k) {
+                crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78 : crc >> 1;
+            }
+        }
+        return crc ^ 0xFFFFFFFF;
+    };
+
+    std::mt19937 gen(7);
+    std::vector<std::byte> data(80);
+    for (auto& b : data) {
+        b = static_cast<std::byte>(gen());
+    }
+    for (std::size_t offset = 0; offset < 8; ++offset) {
+        for (std::size_t length = 0; length + offset <= data.size(); ++length) {
+            std::span<const std::byte> part(data.data() + offset, length);
+            ASSERT_EQ(checksum::crc32c(part), reference(part)) << offset << "+" << length;
+        }
+    }
+}
+
+TEST_F(ChecksumTest, ScanDigestMatchesEachAlgorithm) {
+    std::mt19937 gen(11);
+    std::vector<std::byte> data(10000);
+    for (auto& b : data) {
+        b = static_cast<std::byte>(gen() % 16);
+    }
+
+    for (auto algorithm : {chunk_integrity::crc32, chunk_integrity::crc32c,
+                           chunk_integrity::xxh3_64}) {
+        if (!checksum::is_supported(algorithm)) {
+            continue;
+        }
+        auto scan = checksum::scan(data, algorithm);
+        EXPECT_EQ(scan.algorithm, algorithm);
+        EXPECT_EQ(scan.digest, checksum::digest(algorithm, data)) << to_string(algorithm);
+        EXPECT_EQ(scan.size, data.size());
+        EXPECT_EQ(scan.histogram[16], 0u);
+        EXPECT_NEAR(scan.entropy(), 4.0, 0.05);
+    }
+}
+
+TEST_F(ChecksumTest, VerifyWithAlgorithm) {
+    std::vector<std::byte> data(1000, std::byte{0x5A});
+    auto crc = checksum::crc32c(data);
+
+    EXPECT_TRUE(checksum::verify(chunk_integrity::crc32c, data, crc));
+    EXPECT_FALSE(checksum::verify(chunk_integrity::crc32c, data, crc ^ 1));
+    EXPECT_FALSE(checksum::verify(chunk_integrity::crc32, data, crc));
+    EXPECT_FALSE(checksum::verify(static_cast<chunk_integrity>(0x7F), data, 0));
+    EXPECT_FALSE(checksum::is_supported(static_cast<chunk_integrity>(0x7F)));
+    EXPECT_TRUE(has_capability(checksum::integrity_capabilities(),
+                               client_capabilities::integrity_crc32c));
+}
+
+#ifdef FILE_TRANS_ENABLE_XXHASH
+TEST_F(ChecksumTest, XXH3_KnownValue) {
+    EXPECT_TRUE(checksum::is_supported(chunk_integrity::xxh3_64));
+    EXPECT_EQ(checksum::digest(chunk_integrity::xxh3_64, std::span<const std::byte>{}),
+              0x2D06800538D394C2ULL);
+
+    // A 64-bit digest survives the round trip through a chunk
+    std::vector<std::byte> data(4096, std::byte{1});
+    chunk c;
+    c.data = data;
+    c.set_digest(chunk_integrity::xxh3_64, checksum::digest(chunk_integrity::xxh3_64, data));
+    EXPECT_TRUE(checksum::verify(c.header.integrity, c.data, c.digest()));
+    EXPECT_NE(c.checksum_high, 0u);
+}
+#else
+TEST_F(ChecksumTest, XXH3_UnsupportedWithoutXXHash) {
+    std::vector<std::byte> data(16);
+    EXPECT_FALSE(checksum::is_supported(chunk_integrity::xxh3_64));
+    EXPECT_FALSE(checksum::verify(chunk_integrity::xxh3_64, data, 0));
+    EXPECT_FALSE(has_capability(checksum::integrity_capabilities(),
+                                client_capabilities::integrity_xxh3));
+}
+#endif
+
 // SHA-256 Tests
 
 TEST_F(ChecksumTest, SHA256_EmptyData) {
@@ -303,4 +461,37 @@ TEST_F(ChecksumTest, SHA256_MatchesFileHash) {
     EXPECT_EQ(memory_hash, file_hash_result.value());
 }
 
+TEST_F(ChecksumTest, SHA256Hasher_IncrementalMatchesOneShot) {
+    std::vector<std::byte> data(200 * 1024 + 13);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<std::byte>((i * 31 + 7) & 0xFF);
+    }
+    auto expected = checksum::sha256(data);
+
+    // Piece sizes that straddle the 64-byte block boundary in different ways
+    for (std::size_t piece : {1u, 63u, 64u, 65u, 4096u, 65536u}) {
+        sha256_hasher hasher;
+        for (std::size_t offset = 0; offset < data.size(); offset += piece) {
+            auto size = std::min(piece, data.size() - offset);
+            hasher.update(std::span<const std::byte>(data.data() + offset, size));
+        }
+        EXPECT_EQ(hasher.bytes_hashed(), data.size());
+        EXPECT_EQ(hasher.finalize(), expected) << "piece size " << piece;
+    }
+}
+
+TEST_F(ChecksumTest, SHA256Hasher_FinalizeResets) {
+    sha256_hasher hasher;
+    std::string content = "hello";
+    std::vector<std::byte> data(content.size());
+    std::memcpy(data.data(), content.data(), content.size());
+
+    hasher.update(data);
+    EXPECT_EQ(hasher.finalize(),
+              "2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824");
+    EXPECT_EQ(hasher.bytes_hashed(), 0);
+    EXPECT_EQ(hasher.finalize(),
+              "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+}
+
 }  // namespace kcenon::file_transfer::test
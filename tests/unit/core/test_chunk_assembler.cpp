@@ -220,6 +220,25 @@ TEST_F(ChunkAssemblerTest, ProcessChunk_InvalidChecksum) {
     EXPECT_EQ(result.error().code, error_code::chunk_checksum_error);
 }
 
+TEST_F(ChunkAssemblerTest, ProcessChunk_VerifiesHeaderAlgorithm) {
+    chunk_assembler assembler(output_dir_);
+
+    auto id = transfer_id::generate();
+    std::vector<std::byte> data(1000, std::byte{0x42});
+    assembler.start_session(id, "crc32c.bin", data.size(), 1);
+
+    // A CRC32 value is not a valid CRC32C checksum
+    auto c = create_chunk(id, 0, 1, 0, data, true);
+    c.header.integrity = chunk_integrity::crc32c;
+    auto rejected = assembler.process_chunk(c);
+    ASSERT_FALSE(rejected.has_value());
+    EXPECT_EQ(rejected.error().code, error_code::chunk_checksum_error);
+
+    c.set_digest(chunk_integrity::crc32c, checksum::crc32c(data));
+    EXPECT_TRUE(assembler.process_chunk(c).has_value());
+    EXPECT_TRUE(assembler.is_complete(id));
+}
+
 // Sequential Assembly Tests
 
 TEST_F(ChunkAssemblerTest, ProcessChunk_SequentialAssembly) {
@@ -633,4 +652,181 @@ TEST_F(ChunkAssemblerTest, MoveAssign) {
     EXPECT_TRUE(assembler2.has_session(id));
 }
 
+// Variable-Size Session Tests
+
+TEST_F(ChunkAssemblerTest, VariableSession_AssemblesMixedSizes) {
+    constexpr std::size_t small = 64 * 1024;
+    constexpr std::size_t file_size = small * 11 + 1234;
+    auto source = create_test_file("variable_source.bin", file_size);
+    auto hash = checksum::sha256_file(source).value();
+    auto id = transfer_id::generate();
+
+    // Sizes grow and shrink again, as an adaptive sender would do
+    chunk_splitter splitter(chunk_config{small});
+    auto iterator = splitter.split(source, id);
+    ASSERT_TRUE(iterator.has_value());
+    std::vector<std::size_t> sizes = {small, small * 4, small * 2, small};
+    std::vector<chunk> chunks;
+    for (std::size_t i = 0; iterator.value().has_next(); ++i) {
+        ASSERT_TRUE(iterator.value().set_chunk_size(sizes[i % sizes.size()]).has_value());
+        chunks.push_back(iterator.value().next().value());
+    }
+    ASSERT_GT(chunks.size(), 4);
+
+    chunk_assembler assembler(output_dir_);
+    ASSERT_TRUE(assembler.start_variable_session(id, "variable.bin", file_size).has_value());
+
+    // Out of order, with the last chunk early
+    std::reverse(chunks.begin(), chunks.end());
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        EXPECT_FALSE(assembler.is_complete(id));
+        ASSERT_TRUE(assembler.process_chunk(chunks[i]).has_value()) << i;
+    }
+    EXPECT_TRUE(assembler.is_complete(id));
+    EXPECT_TRUE(assembler.get_missing_chunks(id).empty());
+    EXPECT_TRUE(assembler.get_missing_ranges(id).empty());
+
+    auto progress = assembler.get_progress(id);
+    ASSERT_TRUE(progress.has_value());
+    EXPECT_EQ(progress->total_chunks, chunks.size());
+    EXPECT_EQ(progress->bytes_written, file_size);
+
+    auto finalized = assembler.finalize(id, hash);
+    ASSERT_TRUE(finalized.has_value());
+    EXPECT_EQ(read_file_content(finalized.value()), read_file_content(source));
+}
+
+TEST_F(ChunkAssemblerTest, VariableSession_TracksMissingRanges) {
+    constexpr std::size_t size = 64 * 1024;
+    auto id = transfer_id::generate();
+    chunk_assembler assembler(output_dir_);
+    ASSERT_TRUE(assembler.start_variable_session(id, "gaps.bin", size * 4).has_value());
+
+    std::vector<std::byte> one(size, std::byte{1});
+    std::vector<std::byte> two(size * 2, std::byte{2});
+    ASSERT_TRUE(assembler.process_chunk(create_chunk(id, 0, 0, 0, one)).has_value());
+    ASSERT_TRUE(assembler.process_chunk(create_chunk(id, 2, 0, size * 2, one)).has_value());
+
+    // Index 1 is below one received; the tail beyond is unknown by index
+    EXPECT_EQ(assembler.get_missing_chunks(id), std::vector<uint64_t>{1});
+    auto gaps = assembler.get_missing_ranges(id);
+    ASSERT_EQ(gaps.size(), 2);
+    EXPECT_EQ(gaps[0], (file_byte_range{size, size}));
+    EXPECT_EQ(gaps[1], (file_byte_range{size * 3, size}));
+
+    auto finalized = assembler.finalize(id);
+    ASSERT_FALSE(finalized.has_value());
+    EXPECT_EQ(finalized.error().code, error_code::missing_chunks);
+}
+
+TEST_F(ChunkAssemblerTest, VariableSession_RejectsOverlapAndOutOfFileChunks) {
+    constexpr std::size_t size = 64 * 1024;
+    auto id = transfer_id::generate();
+    chunk_assembler assembler(output_dir_);
+    ASSERT_TRUE(assembler.start_variable_session(id, "overlap.bin", size * 4).has_value());
+
+    std::vector<std::byte> data(size * 2, std::byte{7});
+    ASSERT_TRUE(assembler.process_chunk(create_chunk(id, 1, 0, size, data)).has_value());
+
+    // Starts inside chunk 1, ends inside chunk 1, and past the end of the file
+    EXPECT_FALSE(assembler.process_chunk(create_chunk(id, 2, 0, size * 2, data)).has_value());
+    EXPECT_FALSE(assembler.process_chunk(create_chunk(id, 0, 0, 0, data)).has_value());
+    EXPECT_FALSE(assembler.process_chunk(create_chunk(id, 3, 0, size * 3, data)).has_value());
+
+    // A last chunk must end the file
+    std::vector<std::byte> short_tail(size / 2, std::byte{9});
+    auto early_end = assembler.process_chunk(create_chunk(id, 2, 0, size * 3, short_tail, true));
+    ASSERT_FALSE(early_end.has_value());
+    EXPECT_EQ(early_end.error().code, error_code::invalid_chunk_index);
+
+    // An index no file of this size can reach
+    std::vector<std::byte> one(1, std::byte{1});
+    EXPECT_FALSE(assembler.process_chunk(create_chunk(id, 1000, 0, 0, one)).has_value());
+    EXPECT_EQ(assembler.get_progress(id)->received_chunks, 1);
+}
+
+TEST_F(ChunkAssemblerTest, VariableSession_EmptyFile) {
+    auto id = transfer_id::generate();
+    chunk_assembler assembler(output_dir_);
+    ASSERT_TRUE(assembler.start_variable_session(id, "empty.bin", 0).has_value());
+    EXPECT_FALSE(assembler.is_complete(id));
+
+    ASSERT_TRUE(assembler.process_chunk(create_chunk(id, 0, 1, 0, {}, true)).has_value());
+    EXPECT_TRUE(assembler.is_complete(id));
+    EXPECT_TRUE(assembler.finalize(id).has_value());
+}
+
+TEST_F(ChunkAssemblerTest, ZeroRanges_ReassembleSparseFile) {
+    constexpr std::size_t small = 64 * 1024;
+    constexpr std::size_t file_size = small * 6 + 500;
+    auto source = test_dir_ / "sparse_source.bin";
+    {
+        std::vector<char> data(small, 'y');
+        std::ofstream file(source, std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(small * 2));
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+    std::filesystem::resize_file(source, file_size);
+    auto hash = checksum::sha256_file(source).value();
+
+    chunk_config config(small);
+    config.elide_zero_ranges = true;
+    chunk_splitter splitter(config);
+    auto metadata = splitter.calculate_metadata(source);
+    ASSERT_TRUE(metadata.has_value());
+
+    auto id = transfer_id::generate();
+    chunk_assembler assembler(output_dir_);
+    ASSERT_TRUE(assembler
+                    .start_session(id, "sparse.bin", file_size, metadata.value().total_chunks)
+                    .has_value());
+
+    auto iterator = splitter.split(source, id);
+    ASSERT_TRUE(iterator.has_value());
+    while (iterator.value().has_next()) {
+        ASSERT_TRUE(assembler.process_chunk(iterator.value().next().value()).has_value());
+    }
+    EXPECT_GT(iterator.value().zero_bytes(), 0);
+    EXPECT_TRUE(assembler.is_complete(id));
+    EXPECT_EQ(assembler.get_progress(id)->bytes_written, file_size);
+
+    auto finalized = assembler.finalize(id, hash);
+    ASSERT_TRUE(finalized.has_value());
+    EXPECT_EQ(read_file_content(finalized.value()), read_file_content(source));
+}
+
+TEST_F(ChunkAssemblerTest, ZeroRanges_VariableSessionTracksLength) {
+    constexpr std::size_t small = 64 * 1024;
+    auto id = transfer_id::generate();
+    chunk_assembler assembler(output_dir_);
+    ASSERT_TRUE(assembler.start_variable_session(id, "zero_variable.bin", small * 3).has_value());
+
+    chunk zero;
+    zero.header.id = id;
+    zero.header.chunk_index = 0;
+    zero.header.chunk_offset = 0;
+    zero.header.original_size = small * 2;
+    zero.header.flags = chunk_flags::first_chunk | chunk_flags::zero_range;
+    zero.header.checksum = checksum::crc32(std::span<const std::byte>{});
+    ASSERT_TRUE(assembler.process_chunk(zero).has_value());
+
+    auto missing = assembler.get_missing_ranges(id);
+    ASSERT_EQ(missing.size(), 1);
+    EXPECT_EQ(missing[0], (file_byte_range{small * 2, small}));
+
+    // A zero range may not carry a payload or overlap what is already there
+    auto overlapping = zero;
+    overlapping.header.chunk_index = 1;
+    overlapping.header.chunk_offset = small;
+    EXPECT_FALSE(assembler.process_chunk(overlapping).has_value());
+
+    auto with_payload = zero;
+    with_payload.header.chunk_index = 1;
+    with_payload.header.chunk_offset = small * 2;
+    with_payload.header.original_size = small;
+    with_payload.data.assign(small, std::byte{0});
+    with_payload.header.checksum = checksum::crc32(std::span<const std::byte>(with_payload.data));
+    EXPECT_FALSE(assembler.process_chunk(with_payload).has_value());
+}
+
 }  // namespace kcenon::file_transfer::test
@@ -0,0 +1,187 @@
+/**
+ * @file test_chunk_size_controller.cpp
+ * @brief Unit tests for adaptive chunk sizing
+ */
+
+#include <gtest/gtest.h>
+
+#include <kcenon/file_transfer/core/chunk_size_controller.h>
+
+#include <bit>
+#include <chrono>
+
+namespace kcenon::file_transfer::test {
+
+using namespace std::chrono_literals;
+
+class ChunkSizeControllerTest : public ::testing::Test {
+protected:
+    static constexpr std::size_t KB = 1024;
+    static constexpr std::size_t MB = 1024 * 1024;
+    static constexpr uint64_t gbit = 125'000'000;  // Bytes/sec in 1 Gbit/s
+
+    // A chunk sent first time at the given rate with the given CPU cost
+    static auto sample(std::size_t bytes, uint64_t rate, std::chrono::microseconds cpu,
+                       bool retransmitted = false) -> chunk_sample {
+        auto wire = std::chrono::microseconds(static_cast<int64_t>(bytes * 1'000'000 / rate));
+        return {bytes, wire, cpu, retransmitted};
+    }
+
+    // Record enough samples of the controller's own size for n adjustments
+    static auto run(chunk_size_controller& controller, int adjustments, uint64_t rate,
+                    int retransmit_every = 0) -> std::size_t {
+        auto interval = controller.config().adjust_interval;
+        int n = 0;
+        for (int i = 0; i < adjustments; ++i) {
+            for (std::size_t j = 0; j < interval; ++j, ++n) {
+                auto size = controller.chunk_size();
+                auto retransmitted = retransmit_every > 0 && n % retransmit_every == 0;
+                controller.record(sample(size, rate, 50us, retransmitted));
+            }
+        }
+        return controller.chunk_size();
+    }
+};
+
+TEST_F(ChunkSizeControllerTest, DefaultConfigIsValid) {
+    EXPECT_TRUE(adaptive_chunk_config{}.validate().has_value());
+
+    adaptive_chunk_config config;
+    config.max_size = 128 * MB;
+    EXPECT_EQ(config.validate().error().code, error_code::invalid_chunk_size);
+
+    config = {};
+    config.min_size = 2 * MB;
+    config.max_size = 1 * MB;
+    EXPECT_FALSE(config.validate().has_value());
+
+    config = {};
+    config.smoothing = 0.0;
+    EXPECT_EQ(config.validate().error().code, error_code::invalid_configuration);
+}
+
+TEST_F(ChunkSizeControllerTest, UnknownLinkUsesDefaultSize) {
+    EXPECT_EQ(chunk_size_controller::initial_size({}), chunk_config::default_chunk_size);
+
+    chunk_size_controller controller;
+    EXPECT_EQ(controller.chunk_size(), chunk_config::default_chunk_size);
+}
+
+TEST_F(ChunkSizeControllerTest, FastCleanLinkGetsLargeChunks) {
+    // 10 Gbit/s LAN: 250ms worth is far above the maximum
+    auto size = chunk_size_controller::initial_size({200us, 10 * gbit, 0.0});
+    EXPECT_EQ(size, chunk_config::max_chunk_size);
+
+    // 100 Mbit/s: 250ms is about 3MB
+    size = chunk_size_controller::initial_size({200us, gbit / 10, 0.0});
+    EXPECT_EQ(size, 4 * MB);
+}
+
+TEST_F(ChunkSizeControllerTest, LossyLinkGetsSmallChunks) {
+    auto clean = chunk_size_controller::initial_size({20ms, gbit, 0.0});
+    auto lossy = chunk_size_controller::initial_size({20ms, gbit, 0.001});
+    auto very_lossy = chunk_size_controller::initial_size({20ms, gbit, 0.05});
+
+    EXPECT_LT(lossy, clean);
+    EXPECT_LE(very_lossy, lossy);
+    EXPECT_GE(very_lossy, chunk_config::min_chunk_size);
+}
+
+TEST_F(ChunkSizeControllerTest, WindowMustCoverBandwidthDelayProduct) {
+    // Lossy long fat pipe: loss alone would pick small chunks, but 16 of
+    // them must still cover 1 Gbit/s x 200ms = 25MB
+    auto size = chunk_size_controller::initial_size({200ms, gbit, 0.01});
+    EXPECT_GE(size * 16, gbit / 5 / 2);
+}
+
+TEST_F(ChunkSizeControllerTest, SizesArePowersOfTwoWithinBounds) {
+    adaptive_chunk_config config;
+    config.min_size = 128 * KB;
+    config.max_size = 8 * MB;
+    for (uint64_t rate : {uint64_t{1'000'000}, gbit / 3, gbit, 40 * gbit}) {
+        for (double loss : {0.0, 0.0001, 0.01, 0.2}) {
+            auto size = chunk_size_controller::initial_size({5ms, rate, loss}, config);
+            EXPECT_TRUE(std::has_single_bit(size)) << size;
+            EXPECT_GE(size, config.min_size);
+            EXPECT_LE(size, config.max_size);
+        }
+    }
+}
+
+TEST_F(ChunkSizeControllerTest, GrowsOnCleanFastLink) {
+    chunk_size_controller controller;
+    ASSERT_EQ(controller.start({1ms, 0, 0.0}), chunk_config::default_chunk_size);
+
+    // Steps are limited to x4 per adjustment: 256KB -> 1MB -> 4MB -> ...
+    EXPECT_EQ(run(controller, 1, 10 * gbit), 1 * MB);
+    EXPECT_EQ(run(controller, 1, 10 * gbit), 4 * MB);
+    EXPECT_EQ(run(controller, 4, 10 * gbit), chunk_config::max_chunk_size);
+
+    auto stats = controller.stats();
+    EXPECT_EQ(stats.samples, 6 * controller.config().adjust_interval);
+    EXPECT_EQ(stats.adjustments, 4);
+    EXPECT_NEAR(stats.bandwidth, static_cast<double>(10 * gbit), 0.05 * 10 * gbit);
+}
+
+TEST_F(ChunkSizeControllerTest, ShrinksWhenChunksAreRetransmitted) {
+    chunk_size_controller controller;
+    auto start = controller.start({1ms, gbit, 0.0});
+    ASSERT_EQ(start, 32 * MB);
+
+    // Every other chunk lost
+    auto size = run(controller, 6, gbit, 2);
+    EXPECT_LT(size, start / 16);
+    EXPECT_GT(controller.stats().retransmit_rate, 0.3);
+    EXPECT_EQ(controller.stats().retransmits, 6 * controller.config().adjust_interval / 2);
+}
+
+TEST_F(ChunkSizeControllerTest, RecoversAfterLossStops) {
+    chunk_size_controller controller;
+    controller.start({1ms, gbit, 0.0});
+    auto shrunk = run(controller, 6, gbit, 2);
+    auto recovered = run(controller, 30, gbit);
+    EXPECT_GT(recovered, shrunk);
+}
+
+TEST_F(ChunkSizeControllerTest, EstimatesFixedCpuCostPerChunk) {
+    adaptive_chunk_config config;
+    config.adjust_interval = 1000;  // Keep the size; only measure
+    chunk_size_controller controller(config);
+
+    // 2ms per chunk plus 1ns per byte
+    for (int i = 0; i < 200; ++i) {
+        std::size_t bytes = (i % 2 == 0 ? 256 : 1024) * KB;
+        auto cpu = std::chrono::microseconds(2000 + static_cast<int64_t>(bytes / 1000));
+        controller.record({bytes, 1ms, cpu, false});
+    }
+
+    auto stats = controller.stats();
+    EXPECT_NEAR(static_cast<double>(stats.cpu_per_chunk.count()), 2000.0, 100.0);
+    EXPECT_NEAR(stats.cpu_ns_per_byte, 1.0, 0.1);
+}
+
+TEST_F(ChunkSizeControllerTest, HighPerChunkCpuCostFavoursLargerChunks) {
+    adaptive_chunk_config cheap;
+    adaptive_chunk_config costly;
+    costly.per_chunk_overhead = 20ms;
+
+    link_probe probe{1ms, gbit, 0.0005};
+    EXPECT_GT(chunk_size_controller::initial_size(probe, costly),
+              chunk_size_controller::initial_size(probe, cheap));
+}
+
+TEST_F(ChunkSizeControllerTest, StartResetsMeasurements) {
+    chunk_size_controller controller;
+    controller.start({1ms, gbit, 0.0});
+    run(controller, 2, gbit, 2);
+    ASSERT_GT(controller.stats().samples, 0);
+
+    controller.start({1ms, 0, 0.0});
+    auto stats = controller.stats();
+    EXPECT_EQ(stats.samples, 0);
+    EXPECT_EQ(stats.adjustments, 0);
+    EXPECT_EQ(stats.chunk_size, chunk_config::default_chunk_size);
+    EXPECT_EQ(stats.retransmit_rate, 0.0);
+}
+
+}  // namespace kcenon::file_transfer::test
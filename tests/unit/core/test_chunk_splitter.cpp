@@ -88,7 +88,7 @@ TEST_F(ChunkSplitterTest, ChunkConfig_TooSmall) {
 }
 
 TEST_F(ChunkSplitterTest, ChunkConfig_TooLarge) {
-    chunk_config config(2 * 1024 * 1024);  // 2MB - above maximum
+    chunk_config config(128 * 1024 * 1024);  // 128MB - above maximum
 
     auto result = config.validate();
     EXPECT_FALSE(result.has_value());
@@ -367,6 +367,58 @@ TEST_F(ChunkSplitterTest, Iterator_NoMoreChunksError) {
     EXPECT_EQ(error_result.error().code, error_code::invalid_chunk_index);
 }
 
+TEST_F(ChunkSplitterTest, Iterator_DigestMatchesFileHash) {
+    std::size_t chunk_size = 64 * 1024;
+    chunk_config config(chunk_size);
+    chunk_splitter splitter(config);
+    auto path = create_test_file("digest.txt", chunk_size * 3 + 500);
+
+    auto result = splitter.split(path, transfer_id::generate(), true);
+    ASSERT_TRUE(result.has_value());
+    auto& iterator = result.value();
+
+    while (iterator.has_next()) {
+        // Not available until the last chunk has been read
+        auto early = iterator.digest();
+        ASSERT_FALSE(early.has_value());
+        EXPECT_EQ(early.error().code, error_code::missing_chunks);
+        ASSERT_TRUE(iterator.next().has_value());
+    }
+
+    auto digest = iterator.digest();
+    ASSERT_TRUE(digest.has_value());
+    auto expected = checksum::sha256_file(path);
+    ASSERT_TRUE(expected.has_value());
+    EXPECT_EQ(digest.value(), expected.value());
+}
+
+TEST_F(ChunkSplitterTest, Iterator_DigestOfEmptyFile) {
+    auto path = create_test_file("empty_digest.txt", 0);
+    chunk_splitter splitter;
+
+    auto result = splitter.split(path, transfer_id::generate(), true);
+    ASSERT_TRUE(result.has_value());
+    ASSERT_TRUE(result.value().next().has_value());
+
+    auto digest = result.value().digest();
+    ASSERT_TRUE(digest.has_value());
+    EXPECT_EQ(digest.value(),
+              "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+}
+
+TEST_F(ChunkSplitterTest, Iterator_DigestNotRequested) {
+    auto path = create_test_file("no_digest.txt", 100);
+    chunk_splitter splitter;
+
+    auto result = splitter.split(path, transfer_id::generate());
+    ASSERT_TRUE(result.has_value());
+    ASSERT_TRUE(result.value().next().has_value());
+
+    auto digest = result.value().digest();
+    ASSERT_FALSE(digest.has_value());
+    EXPECT_EQ(digest.error().code, error_code::invalid_configuration);
+}
+
 // Calculate Metadata Tests
 
 TEST_F(ChunkSplitterTest, CalculateMetadata_BasicFile) {
@@ -400,6 +452,16 @@ TEST_F(ChunkSplitterTest, CalculateMetadata_MultipleChunks) {
     EXPECT_EQ(metadata.total_chunks, 6);
 }
 
+TEST_F(ChunkSplitterTest, CalculateMetadata_WithoutDigest) {
+    auto path = create_test_file("metadata_no_digest.txt", 1000);
+
+    chunk_splitter splitter;
+    auto result = splitter.calculate_metadata(path, false);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value().file_size, 1000);
+    EXPECT_TRUE(result.value().sha256_hash.empty());
+}
+
 TEST_F(ChunkSplitterTest, CalculateMetadata_FileNotFound) {
     chunk_splitter splitter;
     auto result = splitter.calculate_metadata(test_dir_ / "nonexistent.txt");
@@ -483,4 +545,168 @@ TEST_F(ChunkSplitterTest, Iterator_MoveConstruct) {
     EXPECT_TRUE(chunk_result.has_value());
 }
 
+// Variable Chunk Size Tests
+
+TEST_F(ChunkSplitterTest, Iterator_SetChunkSizeChangesRemainingChunks) {
+    constexpr std::size_t small = 64 * 1024;
+    constexpr std::size_t file_size = small * 5 + 100;
+    auto path = create_test_file("variable.bin", file_size);
+
+    chunk_splitter splitter(chunk_config{small});
+    auto result = splitter.split(path, transfer_id::generate(), true);
+    ASSERT_TRUE(result.has_value());
+    auto& iterator = result.value();
+    EXPECT_EQ(iterator.total_chunks(), 6);
+
+    auto first = iterator.next();
+    ASSERT_TRUE(first.has_value());
+    ASSERT_TRUE(iterator.set_chunk_size(small * 2).has_value());
+    EXPECT_EQ(iterator.chunk_size(), small * 2);
+    EXPECT_EQ(iterator.total_chunks(), 4);
+
+    std::vector<chunk> chunks;
+    chunks.push_back(std::move(first.value()));
+    while (iterator.has_next()) {
+        auto c = iterator.next();
+        ASSERT_TRUE(c.has_value());
+        chunks.push_back(std::move(c.value()));
+    }
+
+    ASSERT_EQ(chunks.size(), 4);
+    uint64_t offset = 0;
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        EXPECT_EQ(chunks[i].header.chunk_index, i);
+        EXPECT_EQ(chunks[i].header.chunk_offset, offset);
+        EXPECT_EQ(chunks[i].header.original_size, chunks[i].data.size());
+        EXPECT_EQ(chunks[i].is_last(), i == chunks.size() - 1);
+        offset += chunks[i].data.size();
+    }
+    EXPECT_EQ(chunks[1].data.size(), small * 2);
+    EXPECT_EQ(chunks[3].data.size(), 100);
+    EXPECT_EQ(offset, file_size);
+    EXPECT_EQ(iterator.digest().value(), checksum::sha256_file(path).value());
+}
+
+TEST_F(ChunkSplitterTest, Iterator_SetChunkSizeRejectsOutOfBounds) {
+    auto path = create_test_file("variable_bounds.bin", 1000);
+    chunk_splitter splitter;
+    auto result = splitter.split(path, transfer_id::generate());
+    ASSERT_TRUE(result.has_value());
+
+    auto too_large = result.value().set_chunk_size(chunk_config::max_chunk_size + 1);
+    ASSERT_FALSE(too_large.has_value());
+    EXPECT_EQ(too_large.error().code, error_code::invalid_chunk_size);
+    EXPECT_EQ(result.value().chunk_size(), chunk_config::default_chunk_size);
+    EXPECT_TRUE(result.value().set_chunk_size(chunk_config::max_chunk_size).has_value());
+    EXPECT_EQ(result.value().total_chunks(), 1);
+}
+
+TEST_F(ChunkSplitterTest, ZeroRanges_HolesAreNotSent) {
+    constexpr std::size_t small = 64 * 1024;
+    auto path = test_dir_ / "sparse.bin";
+
+    // Hole, data, hole: filesystems without holes read them back as zeros
+    std::vector<char> data(small, 'x');
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(small * 4));
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+    std::filesystem::resize_file(path, small * 8 + 10);
+
+    chunk_config config(small);
+    config.elide_zero_ranges = true;
+    chunk_splitter splitter(config);
+    auto result = splitter.split(path, transfer_id::generate());
+    ASSERT_TRUE(result.has_value());
+    auto& iterator = result.value();
+
+    std::vector<chunk> chunks;
+    while (iterator.has_next()) {
+        auto c = iterator.next();
+        ASSERT_TRUE(c.has_value());
+        chunks.push_back(std::move(c.value()));
+    }
+
+    ASSERT_EQ(chunks.size(), 9);
+    uint64_t offset = 0;
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        EXPECT_EQ(chunks[i].header.chunk_offset, offset);
+        EXPECT_EQ(chunks[i].is_zero_range(), i != 4) << i;
+        if (chunks[i].is_zero_range()) {
+            EXPECT_TRUE(chunks[i].data.empty());
+            EXPECT_EQ(chunks[i].header.checksum, checksum::crc32(std::span<const std::byte>{}));
+        }
+        offset += chunks[i].header.original_size;
+    }
+    EXPECT_TRUE(chunks.front().is_first());
+    EXPECT_TRUE(chunks.back().is_last());
+    EXPECT_EQ(chunks.back().header.original_size, 10);
+    EXPECT_EQ(offset, small * 8 + 10);
+    EXPECT_EQ(iterator.zero_bytes(), small * 7 + 10);
+}
+
+TEST_F(ChunkSplitterTest, ZeroRanges_AllZeroDataIsElided) {
+    constexpr std::size_t small = 64 * 1024;
+    std::vector<std::byte> content(small * 3, std::byte{0});
+    content[small * 2 + 17] = std::byte{1};
+    auto path = create_test_file_with_content("zeros.bin", content);
+
+    chunk_config config(small);
+    config.elide_zero_ranges = true;
+    chunk_splitter splitter(config);
+    auto result = splitter.split(path, transfer_id::generate(), true);
+    ASSERT_TRUE(result.has_value());
+    auto& iterator = result.value();
+
+    std::vector<bool> zero;
+    while (iterator.has_next()) {
+        zero.push_back(iterator.next().value().is_zero_range());
+    }
+    EXPECT_EQ(zero, (std::vector<bool>{true, true, false}));
+    EXPECT_EQ(iterator.zero_bytes(), small * 2);
+
+    // The digest still covers the elided zeros
+    EXPECT_EQ(iterator.digest().value(), checksum::sha256_file(path).value());
+}
+
+TEST_F(ChunkSplitterTest, ZeroRanges_OffByDefault) {
+    auto path = create_test_file_with_content("zeros_default.bin",
+                                              std::vector<std::byte>(1000, std::byte{0}));
+    chunk_splitter splitter;
+    auto result = splitter.split(path, transfer_id::generate());
+    ASSERT_TRUE(result.has_value());
+
+    auto c = result.value().next();
+    ASSERT_TRUE(c.has_value());
+    EXPECT_FALSE(c.value().is_zero_range());
+    EXPECT_EQ(c.value().data.size(), 1000);
+    EXPECT_EQ(result.value().zero_bytes(), 0);
+}
+
+TEST_F(ChunkSplitterTest, Iterator_LastEntropyDescribesLastChunk) {
+    constexpr std::size_t small = 64 * 1024;
+    std::vector<std::byte> content(small * 2);
+    std::mt19937 gen(5);
+    for (std::size_t i = 0; i < small; ++i) {
+        content[i] = static_cast<std::byte>(gen());
+        content[small + i] = static_cast<std::byte>(i & 1 ? 'a' : 'b');
+    }
+    auto path = create_test_file_with_content("entropy.bin", content);
+
+    chunk_splitter splitter(chunk_config{small});
+    auto result = splitter.split(path, transfer_id::generate());
+    ASSERT_TRUE(result.has_value());
+    auto& iterator = result.value();
+
+    auto random_chunk = iterator.next();
+    ASSERT_TRUE(random_chunk.has_value());
+    EXPECT_GT(iterator.last_entropy(), 7.9);
+    EXPECT_EQ(random_chunk.value().header.checksum,
+              checksum::crc32(std::span<const std::byte>(content.data(), small)));
+
+    ASSERT_TRUE(iterator.next().has_value());
+    EXPECT_NEAR(iterator.last_entropy(), 1.0, 0.01);
+}
+
 }  // namespace kcenon::file_transfer::test
@@ -481,6 +481,18 @@ TEST_F(ClientCapabilitiesTest, BitwiseOperations) {
     EXPECT_FALSE(has_capability(caps, client_capabilities::batch_transfer));
 }
 
+TEST_F(ClientCapabilitiesTest, NegotiateIntegrity) {
+    auto both = client_capabilities::integrity_crc32c | client_capabilities::integrity_xxh3;
+
+    EXPECT_EQ(negotiate_integrity(both, both), chunk_integrity::xxh3_64);
+    EXPECT_EQ(negotiate_integrity(both, client_capabilities::integrity_crc32c),
+              chunk_integrity::crc32c);
+    EXPECT_EQ(negotiate_integrity(client_capabilities::integrity_crc32c,
+                                  client_capabilities::integrity_xxh3),
+              chunk_integrity::crc32);
+    EXPECT_EQ(negotiate_integrity(both, client_capabilities::none), chunk_integrity::crc32);
+}
+
 // =============================================================================
 // transfer_direction Tests
 // =============================================================================
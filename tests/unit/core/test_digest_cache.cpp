@@ -0,0 +1,292 @@
+/**
+ * @file test_digest_cache.cpp
+ * @brief Unit tests for the persistent file digest cache
+ */
+
+#include <gtest/gtest.h>
+
+#include <kcenon/file_transfer/core/checksum.h>
+#include <kcenon/file_transfer/core/chunk_splitter.h>
+#include <kcenon/file_transfer/core/digest_cache.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace kcenon::file_transfer::test {
+
+class DigestCacheTest : public ::testing::Test {
+protected:
+    static constexpr std::size_t chunk_size = 64 * 1024;
+
+    void SetUp() override {
+        test_dir_ = std::filesystem::temp_directory_path() / "file_trans_test_digest_cache";
+        std::filesystem::remove_all(test_dir_);
+        std::filesystem::create_directories(test_dir_);
+        table_ = test_dir_ / "state" / "digests.tbl";
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(test_dir_, ec);
+    }
+
+    // Files are back-dated so they are outside the racy window
+    auto create_file(const std::string& name, std::size_t size, uint8_t seed = 1)
+        -> std::filesystem::path {
+        auto path = test_dir_ / name;
+        std::vector<char> data(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            data[i] = static_cast<char>((i * 131 + seed) & 0xFF);
+        }
+        std::ofstream(path, std::ios::binary)
+            .write(data.data(), static_cast<std::streamsize>(data.size()));
+        backdate(path, std::chrono::hours(1));
+        return path;
+    }
+
+    static void backdate(const std::filesystem::path& path, std::chrono::seconds age) {
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now() - age);
+    }
+
+    auto table_only() const -> digest_cache_config {
+        digest_cache_config config(table_);
+        config.use_xattr = false;
+        return config;
+    }
+
+    std::filesystem::path test_dir_;
+    std::filesystem::path table_;
+};
+
+TEST_F(DigestCacheTest, ComputeMatchesChecksums) {
+    auto path = create_file("data.bin", chunk_size * 3 + 100);
+    digest_cache cache(table_only());
+
+    auto digest = cache.compute(path, chunk_size);
+    ASSERT_TRUE(digest.has_value());
+    EXPECT_EQ(digest.value().sha256, checksum::sha256_file(path).value());
+    EXPECT_EQ(digest.value().file_size, chunk_size * 3 + 100);
+
+    chunk_splitter splitter(chunk_config{chunk_size});
+    auto iterator = splitter.split(path, transfer_id::generate());
+    ASSERT_TRUE(iterator.has_value());
+    std::vector<uint32_t> expected;
+    while (iterator.value().has_next()) {
+        expected.push_back(iterator.value().next().value().header.checksum);
+    }
+    EXPECT_EQ(digest.value().chunk_crc32, expected);
+}
+
+TEST_F(DigestCacheTest, EmptyFileHasOneChunk) {
+    auto path = create_file("empty.bin", 0);
+    digest_cache cache(table_only());
+
+    auto digest = cache.compute(path, chunk_size);
+    ASSERT_TRUE(digest.has_value());
+    EXPECT_EQ(digest.value().sha256,
+              "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    ASSERT_EQ(digest.value().chunk_crc32.size(), 1);
+    EXPECT_EQ(digest.value().chunk_crc32[0], 0u);
+}
+
+TEST_F(DigestCacheTest, UnchangedFileIsNotReadAgain) {
+    auto path = create_file("data.bin", chunk_size * 2);
+    digest_cache cache(table_only());
+
+    auto first = cache.compute(path, chunk_size);
+    auto second = cache.compute(path, chunk_size);
+    ASSERT_TRUE(first.has_value());
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(first.value().sha256, second.value().sha256);
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.stores, 1);
+    EXPECT_EQ(stats.entries, 1);
+}
+
+TEST_F(DigestCacheTest, ModifiedFileIsRehashed) {
+    auto path = create_file("data.bin", 1000);
+    digest_cache cache(table_only());
+    auto before = cache.compute(path, chunk_size);
+    ASSERT_TRUE(before.has_value());
+
+    // Same size, new content and mtime
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(10);
+        file.put('x');
+    }
+    backdate(path, std::chrono::minutes(30));
+
+    EXPECT_FALSE(cache.lookup(path, chunk_size).has_value());
+    EXPECT_EQ(cache.stats().stale, 1);
+
+    auto after = cache.compute(path, chunk_size);
+    ASSERT_TRUE(after.has_value());
+    EXPECT_NE(after.value().sha256, before.value().sha256);
+    EXPECT_EQ(after.value().sha256, checksum::sha256_file(path).value());
+}
+
+TEST_F(DigestCacheTest, ReplacedFileIsRehashed) {
+    auto path = create_file("data.bin", 1000, 1);
+    digest_cache cache(table_only());
+    ASSERT_TRUE(cache.compute(path, chunk_size).has_value());
+
+    // A different file renamed into place has another inode
+    auto other = create_file("other.bin", 1000, 2);
+    std::filesystem::last_write_time(other, std::filesystem::last_write_time(path));
+    std::filesystem::rename(other, path);
+
+    EXPECT_FALSE(cache.lookup(path, chunk_size).has_value());
+}
+
+TEST_F(DigestCacheTest, ChunkSizeIsPartOfTheKey) {
+    auto path = create_file("data.bin", chunk_size * 2);
+    digest_cache cache(table_only());
+    ASSERT_TRUE(cache.compute(path, chunk_size).has_value());
+
+    EXPECT_FALSE(cache.lookup(path, chunk_size * 2).has_value());
+    auto larger = cache.compute(path, chunk_size * 2);
+    ASSERT_TRUE(larger.has_value());
+    EXPECT_EQ(larger.value().chunk_crc32.size(), 1);
+    EXPECT_TRUE(cache.lookup(path, chunk_size).has_value());
+}
+
+TEST_F(DigestCacheTest, RecentlyModifiedFileIsNotStored) {
+    auto path = create_file("fresh.bin", 1000);
+    backdate(path, std::chrono::seconds(0));
+    digest_cache cache(table_only());
+
+    ASSERT_TRUE(cache.compute(path, chunk_size).has_value());
+    EXPECT_EQ(cache.stats().skipped, 1);
+    EXPECT_FALSE(cache.lookup(path, chunk_size).has_value());
+}
+
+TEST_F(DigestCacheTest, TablePersistsAcrossInstances) {
+    auto path = create_file("data.bin", chunk_size + 1);
+    std::string sha;
+    {
+        digest_cache cache(table_only());
+        sha = cache.compute(path, chunk_size).value().sha256;
+    }
+    ASSERT_TRUE(std::filesystem::exists(table_));
+
+    digest_cache reloaded(table_only());
+    auto digest = reloaded.lookup(path, chunk_size);
+    ASSERT_TRUE(digest.has_value());
+    EXPECT_EQ(digest->sha256, sha);
+    EXPECT_EQ(digest->chunk_crc32.size(), 2);
+}
+
+TEST_F(DigestCacheTest, TornTableTailIsIgnored) {
+    auto path = create_file("data.bin", 1000);
+    {
+        digest_cache cache(table_only());
+        ASSERT_TRUE(cache.compute(path, chunk_size).has_value());
+    }
+    std::ofstream(table_, std::ios::binary | std::ios::app).write("\x40\x00\x00\x00garbage", 11);
+
+    digest_cache reloaded(table_only());
+    EXPECT_TRUE(reloaded.lookup(path, chunk_size).has_value());
+}
+
+TEST_F(DigestCacheTest, InvalidateIsPersisted) {
+    auto path = create_file("data.bin", 1000);
+    {
+        digest_cache cache(table_only());
+        ASSERT_TRUE(cache.compute(path, chunk_size).has_value());
+        ASSERT_TRUE(cache.compute(path, chunk_size * 2).has_value());
+        cache.invalidate(path);
+        EXPECT_FALSE(cache.lookup(path, chunk_size).has_value());
+        EXPECT_EQ(cache.stats().entries, 0);
+    }
+
+    digest_cache reloaded(table_only());
+    EXPECT_FALSE(reloaded.lookup(path, chunk_size).has_value());
+    EXPECT_FALSE(reloaded.lookup(path, chunk_size * 2).has_value());
+}
+
+TEST_F(DigestCacheTest, LeastRecentlyUsedEntriesAreEvicted) {
+    auto config = table_only();
+    config.max_entries = 2;
+    digest_cache cache(config);
+
+    auto a = create_file("a.bin", 100, 1);
+    auto b = create_file("b.bin", 100, 2);
+    auto c = create_file("c.bin", 100, 3);
+    ASSERT_TRUE(cache.compute(a, chunk_size).has_value());
+    ASSERT_TRUE(cache.compute(b, chunk_size).has_value());
+    ASSERT_TRUE(cache.lookup(a, chunk_size).has_value());
+    ASSERT_TRUE(cache.compute(c, chunk_size).has_value());
+
+    EXPECT_EQ(cache.stats().entries, 2);
+    EXPECT_TRUE(cache.lookup(a, chunk_size).has_value());
+    EXPECT_FALSE(cache.lookup(b, chunk_size).has_value());
+    EXPECT_TRUE(cache.lookup(c, chunk_size).has_value());
+}
+
+TEST_F(DigestCacheTest, CompactKeepsLiveEntries) {
+    auto path = create_file("data.bin", 1000);
+    digest_cache cache(table_only());
+    for (int i = 0; i < 10; ++i) {
+        cache.invalidate(path);
+        ASSERT_TRUE(cache.compute(path, chunk_size).has_value());
+    }
+    auto before = std::filesystem::file_size(table_);
+    ASSERT_TRUE(cache.compact().has_value());
+    EXPECT_LT(std::filesystem::file_size(table_), before);
+
+    digest_cache reloaded(table_only());
+    EXPECT_TRUE(reloaded.lookup(path, chunk_size).has_value());
+}
+
+TEST_F(DigestCacheTest, ExtendedAttributeTravelsWithTheFile) {
+    auto path = create_file("data.bin", chunk_size + 5);
+    {
+        digest_cache cache{digest_cache_config(table_)};
+        ASSERT_TRUE(cache.compute(path, chunk_size).has_value());
+        if (cache.stats().xattr_stores == 0) {
+            GTEST_SKIP() << "Extended attributes not supported here";
+        }
+    }
+
+    // Another cache without the table still finds it
+    digest_cache other{digest_cache_config(test_dir_ / "other.tbl")};
+    auto digest = other.lookup(path, chunk_size);
+    ASSERT_TRUE(digest.has_value());
+    EXPECT_EQ(digest->sha256, checksum::sha256_file(path).value());
+
+    // A copy carries the attribute but not the inode
+    auto copy = test_dir_ / "copy.bin";
+    std::filesystem::copy_file(path, copy);
+    std::filesystem::last_write_time(copy, std::filesystem::last_write_time(path));
+    EXPECT_FALSE(other.lookup(copy, chunk_size).has_value());
+}
+
+TEST_F(DigestCacheTest, MissingFileIsAnError) {
+    digest_cache cache(table_only());
+    auto digest = cache.compute(test_dir_ / "missing.bin", chunk_size);
+    ASSERT_FALSE(digest.has_value());
+    EXPECT_EQ(digest.error().code, error_code::file_not_found);
+    EXPECT_FALSE(cache.lookup(test_dir_ / "missing.bin", chunk_size).has_value());
+}
+
+TEST_F(DigestCacheTest, SplitterMetadataUsesTheCache) {
+    auto path = create_file("data.bin", chunk_size * 2);
+    auto cache = std::make_shared<digest_cache>(table_only());
+    chunk_splitter splitter(chunk_config{chunk_size});
+    splitter.set_digest_cache(cache);
+
+    auto first = splitter.calculate_metadata(path);
+    auto second = splitter.calculate_metadata(path);
+    ASSERT_TRUE(first.has_value());
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(second.value().sha256_hash, checksum::sha256_file(path).value());
+    EXPECT_EQ(cache->stats().hits, 1);
+}
+
+}  // namespace kcenon::file_transfer::test
@@ -0,0 +1,384 @@
+/**
+ * @file test_fec_codec.cpp
+ * @brief Unit tests for forward error correction of chunk groups
+ */
+
+#include <gtest/gtest.h>
+
+#include <kcenon/file_transfer/core/checksum.h>
+#include <kcenon/file_transfer/core/chunk_assembler.h>
+#include <kcenon/file_transfer/core/chunk_config.h>
+#include <kcenon/file_transfer/core/fec_codec.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace kcenon::file_transfer::test {
+
+class FecCodecTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = std::filesystem::temp_directory_path() / "file_trans_test_fec";
+        std::filesystem::remove_all(test_dir_);
+        std::filesystem::create_directories(test_dir_);
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(test_dir_, ec);
+    }
+
+    static auto random_bytes(std::size_t size, uint32_t seed) -> std::vector<std::byte> {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<int> dis(0, 255);
+        std::vector<std::byte> data(size);
+        for (auto& b : data) {
+            b = static_cast<std::byte>(dis(gen));
+        }
+        return data;
+    }
+
+    // Consecutive data chunks of the given sizes, as a splitter produces them
+    static auto make_chunks(const transfer_id& id, const std::vector<std::size_t>& sizes)
+        -> std::vector<chunk> {
+        std::vector<chunk> chunks;
+        uint64_t offset = 0;
+        for (std::size_t i = 0; i < sizes.size(); ++i) {
+            chunk c;
+            c.data = random_bytes(sizes[i], static_cast<uint32_t>(i + 1));
+            c.header.id = id;
+            c.header.chunk_index = i;
+            c.header.chunk_offset = offset;
+            c.header.original_size = static_cast<uint32_t>(sizes[i]);
+            c.header.compressed_size = c.header.original_size;
+            c.header.flags = i == 0 ? chunk_flags::first_chunk : chunk_flags::none;
+            if (i + 1 == sizes.size()) {
+                c.header.flags |= chunk_flags::last_chunk;
+            }
+            c.header.checksum = checksum::crc32(c.data);
+            offset += sizes[i];
+            chunks.push_back(std::move(c));
+        }
+        return chunks;
+    }
+
+    static auto encode(const fec_config& config, const std::vector<chunk>& chunks)
+        -> std::vector<chunk> {
+        fec_encoder encoder(config);
+        std::vector<chunk> parity;
+        for (const auto& c : chunks) {
+            auto out = encoder.add(c);
+            EXPECT_TRUE(out.has_value());
+            parity.insert(parity.end(), out.value().begin(), out.value().end());
+        }
+        auto rest = encoder.flush();
+        parity.insert(parity.end(), rest.begin(), rest.end());
+        return parity;
+    }
+
+    static auto read_file(const std::filesystem::path& path) -> std::vector<std::byte> {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(file)),
+                                std::istreambuf_iterator<char>());
+        std::vector<std::byte> data(bytes.size());
+        std::memcpy(data.data(), bytes.data(), bytes.size());
+        return data;
+    }
+
+    std::filesystem::path test_dir_;
+};
+
+TEST_F(FecCodecTest, ConfigValidation) {
+    EXPECT_TRUE(fec_config{}.validate().has_value());
+    EXPECT_FALSE(fec_config{}.enabled());
+    EXPECT_TRUE((fec_config{16, 4}.enabled()));
+    EXPECT_DOUBLE_EQ((fec_config{16, 4}.overhead()), 0.25);
+
+    EXPECT_FALSE((fec_config{0, 2}.validate().has_value()));
+    EXPECT_TRUE((fec_config{200, 56}.validate().has_value()));
+    EXPECT_FALSE((fec_config{200, 57}.validate().has_value()));
+}
+
+TEST_F(FecCodecTest, ParityFollowsLossRate) {
+    EXPECT_FALSE(fec_config::for_loss_rate(0.0).enabled());
+
+    auto low = fec_config::for_loss_rate(0.01);
+    auto high = fec_config::for_loss_rate(0.10);
+    EXPECT_EQ(low.data_chunks, fec_config::default_data_chunks);
+    EXPECT_GE(low.parity_chunks, 1);
+    EXPECT_GT(high.parity_chunks, low.parity_chunks);
+    EXPECT_TRUE(high.validate().has_value());
+
+    // A looser target needs less parity; total loss is capped at K
+    EXPECT_LE(fec_config::for_loss_rate(0.10, 16, 0.05).parity_chunks, high.parity_chunks);
+    EXPECT_EQ(fec_config::for_loss_rate(1.0, 8).parity_chunks, 8);
+}
+
+TEST_F(FecCodecTest, ParityWeighsRttAgainstBandwidth) {
+    using std::chrono::milliseconds;
+    constexpr double bandwidth = 50e6 / 8;
+    constexpr std::size_t chunk_size = 256 * 1024;
+
+    EXPECT_FALSE(fec_config::for_link(0.0, milliseconds(600), bandwidth, chunk_size).enabled());
+
+    // A satellite round trip is worth a few chunks of parity...
+    auto satellite = fec_config::for_link(0.05, milliseconds(600), bandwidth, chunk_size);
+    EXPECT_TRUE(satellite.enabled());
+    EXPECT_LE(satellite.parity_chunks, fec_config::for_loss_rate(0.05).parity_chunks);
+
+    // ... a LAN round trip is not
+    EXPECT_FALSE(fec_config::for_link(0.05, milliseconds(1), bandwidth, chunk_size).enabled());
+}
+
+TEST_F(FecCodecTest, VectorAndScalarMultiplyAgree) {
+    auto src = random_bytes(1000, 7);
+    for (int c : {0, 1, 2, 0x53, 0xFF}) {
+        auto coefficient = static_cast<uint8_t>(c);
+        std::vector<std::byte> whole(src.size(), std::byte{0x5A});
+        std::vector<std::byte> bytewise(src.size(), std::byte{0x5A});
+
+        fec::multiply_add(coefficient, src, whole);
+        for (std::size_t i = 0; i < src.size(); ++i) {
+            fec::multiply_add(coefficient, std::span(src).subspan(i, 1),
+                              std::span(bytewise).subspan(i, 1));
+        }
+        EXPECT_EQ(whole, bytewise) << c;
+
+        // Adding the same product again cancels it
+        fec::multiply_add(coefficient, src, whole);
+        EXPECT_EQ(whole, std::vector<std::byte>(src.size(), std::byte{0x5A})) << c;
+    }
+}
+
+TEST_F(FecCodecTest, EncoderEmitsParityPerGroup) {
+    auto id = transfer_id::generate();
+    auto chunks = make_chunks(id, std::vector<std::size_t>(10, 1000));
+
+    fec_encoder encoder(fec_config{4, 2});
+    std::vector<std::size_t> emitted;
+    for (const auto& c : chunks) {
+        auto out = encoder.add(c);
+        ASSERT_TRUE(out.has_value());
+        emitted.push_back(out.value().size());
+        for (const auto& p : out.value()) {
+            EXPECT_TRUE(p.is_parity());
+            EXPECT_EQ(p.header.id, id);
+            EXPECT_EQ(p.header.chunk_index, c.header.chunk_index - 3);
+            EXPECT_TRUE(checksum::verify(p.header.integrity, p.data, p.digest()));
+        }
+    }
+    EXPECT_EQ(emitted, (std::vector<std::size_t>{0, 0, 0, 2, 0, 0, 0, 2, 0, 0}));
+
+    auto tail = encoder.flush();
+    ASSERT_EQ(tail.size(), 2);
+    EXPECT_EQ(tail[0].header.chunk_index, 8);
+    EXPECT_TRUE(encoder.flush().empty());
+
+    // Parity is computed before compression
+    auto compressed = chunks[0];
+    compressed.header.flags |= chunk_flags::compressed;
+    EXPECT_FALSE(encoder.add(compressed).has_value());
+}
+
+TEST_F(FecCodecTest, AnyLossesUpToParityAreRecovered) {
+    auto id = transfer_id::generate();
+    // Unequal sizes, so shorter chunks are padded inside the code
+    auto chunks = make_chunks(id, {700, 1024, 33, 1024, 512});
+    auto parity = encode(fec_config{5, 3}, chunks);
+    ASSERT_EQ(parity.size(), 3);
+
+    auto read = [&](uint64_t index) -> result<std::vector<std::byte>> {
+        return chunks[index].data;
+    };
+
+    // Every set of up to three lost data chunks, from the parity rows that remain
+    for (unsigned lost_mask = 1; lost_mask < (1u << chunks.size()); ++lost_mask) {
+        std::vector<uint64_t> missing;
+        for (uint64_t i = 0; i < chunks.size(); ++i) {
+            if (lost_mask & (1u << i)) {
+                missing.push_back(i);
+            }
+        }
+        if (missing.size() > parity.size()) {
+            continue;
+        }
+        // Use the last parity rows, so the rows are not always the first ones
+        auto group = fec_group::from_parity(parity[parity.size() - missing.size()]);
+        ASSERT_TRUE(group.has_value());
+        for (auto row = parity.size() - missing.size() + 1; row < parity.size(); ++row) {
+            ASSERT_TRUE(group.value().add_parity(parity[row]).has_value());
+        }
+
+        auto rebuilt = group.value().recover(id, missing, read);
+        ASSERT_TRUE(rebuilt.has_value()) << lost_mask;
+        ASSERT_EQ(rebuilt.value().size(), missing.size());
+        for (std::size_t k = 0; k < missing.size(); ++k) {
+            const auto& original = chunks[missing[k]];
+            const auto& c = rebuilt.value()[k];
+            EXPECT_EQ(c.data, original.data) << lost_mask;
+            EXPECT_EQ(c.header.chunk_index, original.header.chunk_index);
+            EXPECT_EQ(c.header.chunk_offset, original.header.chunk_offset);
+            EXPECT_EQ(c.header.flags, original.header.flags);
+            EXPECT_EQ(c.digest(), original.digest());
+        }
+    }
+}
+
+TEST_F(FecCodecTest, TooFewParityRowsFail) {
+    auto id = transfer_id::generate();
+    auto chunks = make_chunks(id, {100, 100, 100, 100});
+    auto parity = encode(fec_config{4, 2}, chunks);
+
+    auto group = fec_group::from_parity(parity[0]);
+    ASSERT_TRUE(group.has_value());
+    std::vector<uint64_t> missing{1, 2};
+    auto rebuilt = group.value().recover(
+        id, missing, [&](uint64_t index) -> result<std::vector<std::byte>> {
+            return chunks[index].data;
+        });
+    ASSERT_FALSE(rebuilt.has_value());
+    EXPECT_EQ(rebuilt.error().code, error_code::missing_chunks);
+}
+
+TEST_F(FecCodecTest, MalformedParityIsRejected) {
+    auto id = transfer_id::generate();
+    auto chunks = make_chunks(id, {100, 100});
+    auto parity = encode(fec_config{2, 2}, chunks);
+
+    auto truncated = parity[0];
+    truncated.data.resize(truncated.data.size() - 1);
+    EXPECT_FALSE(fec_group::from_parity(truncated).has_value());
+
+    auto oversized_group = parity[0];
+    oversized_group.data[10] = std::byte{255};  // parity_count
+    EXPECT_FALSE(fec_group::from_parity(oversized_group).has_value());
+
+    auto group = fec_group::from_parity(parity[0]);
+    ASSERT_TRUE(group.has_value());
+    auto other_group = encode(fec_config{2, 2}, make_chunks(id, {100, 101}));
+    EXPECT_FALSE(group.value().add_parity(other_group[1]).has_value());
+}
+
+TEST_F(FecCodecTest, AssemblerRebuildsLostChunks) {
+    auto id = transfer_id::generate();
+    auto chunks = make_chunks(id, std::vector<std::size_t>(10, 4096));
+    auto parity = encode(fec_config{4, 2}, chunks);
+    ASSERT_EQ(parity.size(), 6);
+
+    std::vector<std::byte> expected;
+    for (const auto& c : chunks) {
+        expected.insert(expected.end(), c.data.begin(), c.data.end());
+    }
+
+    chunk_assembler assembler(test_dir_);
+    std::set<uint64_t> acknowledged;
+    assembler.on_chunk_recovered([&](const transfer_id& tid, const chunk& rebuilt) {
+        EXPECT_EQ(tid, id);
+        acknowledged.insert(rebuilt.header.chunk_index);
+        const auto& original = chunks[rebuilt.header.chunk_index];
+        EXPECT_EQ(rebuilt.data, original.data);
+    });
+    ASSERT_TRUE(assembler.start_session(id, "fec.bin", expected.size(), chunks.size()).has_value());
+
+    // Two lost in the first group, one in the second, one in the short last group
+    std::set<uint64_t> lost{0, 2, 5, 9};
+    for (const auto& c : chunks) {
+        if (!lost.contains(c.header.chunk_index)) {
+            ASSERT_TRUE(assembler.process_chunk(c).has_value());
+        }
+    }
+    EXPECT_FALSE(assembler.is_complete(id));
+    for (const auto& p : parity) {
+        ASSERT_TRUE(assembler.process_chunk(p).has_value());
+    }
+
+    EXPECT_TRUE(assembler.is_complete(id));
+    EXPECT_EQ(acknowledged, lost);
+    EXPECT_EQ(assembler.get_progress(id)->recovered_chunks, lost.size());
+
+    auto path = assembler.finalize(id, checksum::sha256(expected));
+    ASSERT_TRUE(path.has_value());
+    EXPECT_EQ(read_file(path.value()), expected);
+}
+
+TEST_F(FecCodecTest, ParityBeforeDataAndRetransmission) {
+    auto id = transfer_id::generate();
+    auto chunks = make_chunks(id, std::vector<std::size_t>(4, 2048));
+    auto parity = encode(fec_config{4, 1}, chunks);
+
+    chunk_assembler assembler(test_dir_);
+    ASSERT_TRUE(assembler.start_session(id, "late.bin", 4 * 2048, 4).has_value());
+
+    // Parity first; the chunk it stands in for is rebuilt when the rest arrive
+    ASSERT_TRUE(assembler.process_chunk(parity[0]).has_value());
+    for (uint64_t i : {0, 1, 3}) {
+        ASSERT_TRUE(assembler.process_chunk(chunks[i]).has_value());
+    }
+    EXPECT_TRUE(assembler.is_complete(id));
+
+    // The original arriving late is a duplicate
+    EXPECT_TRUE(assembler.process_chunk(chunks[2]).has_value());
+    EXPECT_EQ(assembler.get_progress(id)->recovered_chunks, 1);
+
+    // More losses than parity: the gaps are left for retransmission
+    auto second = transfer_id::generate();
+    auto more = make_chunks(second, std::vector<std::size_t>(4, 2048));
+    ASSERT_TRUE(assembler.start_session(second, "lossy.bin", 4 * 2048, 4).has_value());
+    ASSERT_TRUE(assembler.process_chunk(more[0]).has_value());
+    ASSERT_TRUE(assembler.process_chunk(more[3]).has_value());
+    ASSERT_TRUE(assembler.process_chunk(encode(fec_config{4, 1}, more)[0]).has_value());
+    EXPECT_EQ(assembler.get_missing_chunks(second), (std::vector<uint64_t>{1, 2}));
+
+    ASSERT_TRUE(assembler.process_chunk(more[1]).has_value());
+    EXPECT_TRUE(assembler.is_complete(second));
+}
+
+TEST_F(FecCodecTest, ZeroRangeChunksTakePartInGroups) {
+    auto id = transfer_id::generate();
+    auto chunks = make_chunks(id, {4096, 4096, 4096});
+    chunks[1].data.clear();
+    chunks[1].header.flags |= chunk_flags::zero_range;
+    chunks[1].header.compressed_size = 0;
+    chunks[1].header.checksum = checksum::crc32(chunks[1].data);
+    auto parity = encode(fec_config{3, 1}, chunks);
+
+    chunk_assembler assembler(test_dir_);
+    ASSERT_TRUE(assembler.start_session(id, "sparse.bin", 3 * 4096, 3).has_value());
+    ASSERT_TRUE(assembler.process_chunk(chunks[0]).has_value());
+    ASSERT_TRUE(assembler.process_chunk(chunks[2]).has_value());
+    ASSERT_TRUE(assembler.process_chunk(parity[0]).has_value());
+    ASSERT_TRUE(assembler.is_complete(id));
+
+    auto path = assembler.finalize(id);
+    ASSERT_TRUE(path.has_value());
+    auto content = read_file(path.value());
+    ASSERT_EQ(content.size(), 3 * 4096);
+    EXPECT_EQ(std::vector<std::byte>(content.begin() + 4096, content.begin() + 8192),
+              std::vector<std::byte>(4096, std::byte{0}));
+}
+
+TEST_F(FecCodecTest, VariableSessionRecoversLastChunk) {
+    auto id = transfer_id::generate();
+    std::vector<std::size_t> sizes{chunk_config::min_chunk_size, chunk_config::min_chunk_size * 2,
+                                   1000};
+    auto chunks = make_chunks(id, sizes);
+    auto parity = encode(fec_config{3, 1}, chunks);
+
+    chunk_assembler assembler(test_dir_);
+    uint64_t file_size = sizes[0] + sizes[1] + sizes[2];
+    ASSERT_TRUE(assembler.start_variable_session(id, "variable.bin", file_size).has_value());
+    ASSERT_TRUE(assembler.process_chunk(chunks[0]).has_value());
+    ASSERT_TRUE(assembler.process_chunk(chunks[1]).has_value());
+    ASSERT_TRUE(assembler.process_chunk(parity[0]).has_value());
+
+    // The rebuilt chunk carries last_chunk, which fixes the chunk count
+    EXPECT_TRUE(assembler.is_complete(id));
+    EXPECT_TRUE(assembler.finalize(id).has_value());
+}
+
+}  // namespace kcenon::file_transfer::test
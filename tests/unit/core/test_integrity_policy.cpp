@@ -0,0 +1,115 @@
+/**
+ * @file test_integrity_policy.cpp
+ * @brief Unit tests for the integrity policy engine
+ */
+
+#include <gtest/gtest.h>
+
+#include <kcenon/file_transfer/core/checksum.h>
+#include <kcenon/file_transfer/core/chunk_assembler.h>
+#include <kcenon/file_transfer/core/integrity_policy.h>
+
+#include <filesystem>
+#include <vector>
+
+namespace kcenon::file_transfer::test {
+
+class IntegrityPolicyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = std::filesystem::temp_directory_path() / "file_trans_test_integrity_policy";
+        std::filesystem::remove_all(test_dir_);
+        std::filesystem::create_directories(test_dir_);
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(test_dir_, ec);
+    }
+
+    static auto make_chunk(const transfer_id& id, const std::vector<std::byte>& data) -> chunk {
+        chunk c;
+        c.header.id = id;
+        c.header.original_size = static_cast<uint32_t>(data.size());
+        c.header.compressed_size = static_cast<uint32_t>(data.size());
+        c.header.flags = chunk_flags::first_chunk | chunk_flags::last_chunk;
+        c.header.checksum = checksum::crc32(data);
+        c.data = data;
+        return c;
+    }
+
+    std::filesystem::path test_dir_;
+};
+
+TEST_F(IntegrityPolicyTest, PlanPicksOneChunkCheck) {
+    EXPECT_EQ(integrity_policy::plan({}), integrity_check::chunk_checksum);
+    EXPECT_EQ(integrity_policy::plan({true, false}), integrity_check::aead_tag);
+    EXPECT_EQ(integrity_policy::plan({false, true}),
+              integrity_check::chunk_checksum | integrity_check::file_digest);
+
+    // The file digest is never replaced by per-chunk tags
+    auto authenticated = integrity_policy::plan({true, true});
+    EXPECT_TRUE(has_check(authenticated, integrity_check::aead_tag));
+    EXPECT_TRUE(has_check(authenticated, integrity_check::file_digest));
+    EXPECT_FALSE(has_check(authenticated, integrity_check::chunk_checksum));
+}
+
+TEST_F(IntegrityPolicyTest, OutstandingChecks) {
+    EXPECT_EQ(integrity_policy::outstanding(integrity_check::none),
+              integrity_check::chunk_checksum);
+    EXPECT_EQ(integrity_policy::outstanding(integrity_check::chunk_checksum),
+              integrity_check::none);
+    EXPECT_EQ(integrity_policy::outstanding(integrity_check::aead_tag), integrity_check::none);
+    EXPECT_EQ(integrity_policy::outstanding(integrity_check::file_digest),
+              integrity_check::chunk_checksum);
+}
+
+TEST_F(IntegrityPolicyTest, CostModelLearnsFromChecks) {
+    integrity_policy policy;
+    EXPECT_LT(policy.ns_per_byte(chunk_integrity::crc32), 0.0);
+
+    policy.record_check(chunk_integrity::crc32, 1000, std::chrono::nanoseconds(500));
+    EXPECT_DOUBLE_EQ(policy.ns_per_byte(chunk_integrity::crc32), 0.5);
+    EXPECT_EQ(policy.estimate_cost(chunk_integrity::crc32, 4000), std::chrono::nanoseconds(2000));
+
+    // Later samples move the estimate part of the way
+    policy.record_check(chunk_integrity::crc32, 1000, std::chrono::nanoseconds(1500));
+    EXPECT_GT(policy.ns_per_byte(chunk_integrity::crc32), 0.5);
+    EXPECT_LT(policy.ns_per_byte(chunk_integrity::crc32), 1.5);
+
+    // Other algorithms are priced separately
+    EXPECT_LT(policy.ns_per_byte(chunk_integrity::crc32c), 0.0);
+}
+
+TEST_F(IntegrityPolicyTest, UnmeasuredAlgorithmIsCalibrated) {
+    integrity_policy policy;
+    auto cost = policy.estimate_cost(chunk_integrity::crc32c, 1024 * 1024);
+    EXPECT_GT(cost.count(), 0);
+    EXPECT_GT(policy.ns_per_byte(chunk_integrity::crc32c), 0.0);
+
+    EXPECT_EQ(policy.estimate_cost(static_cast<chunk_integrity>(0x7F), 1024).count(), 0);
+}
+
+TEST_F(IntegrityPolicyTest, AssemblerSkipsChecksumAlreadyVerified) {
+    chunk_assembler assembler(test_dir_);
+    std::vector<std::byte> data(1000, std::byte{0x42});
+
+    // A wrong checksum is caught when nothing upstream checked the chunk
+    auto unchecked = transfer_id::generate();
+    ASSERT_TRUE(assembler.start_session(unchecked, "unchecked.bin", data.size(), 1).has_value());
+    auto bad = make_chunk(unchecked, data);
+    bad.header.checksum ^= 1;
+    auto rejected = assembler.process_chunk(bad, integrity_check::none);
+    ASSERT_FALSE(rejected.has_value());
+    EXPECT_EQ(rejected.error().code, error_code::chunk_checksum_error);
+
+    // ... and not looked at again once an AEAD tag vouched for the data
+    auto sealed = transfer_id::generate();
+    ASSERT_TRUE(assembler.start_session(sealed, "sealed.bin", data.size(), 1).has_value());
+    auto c = make_chunk(sealed, data);
+    c.header.checksum ^= 1;
+    EXPECT_TRUE(assembler.process_chunk(c, integrity_check::aead_tag).has_value());
+    EXPECT_TRUE(assembler.is_complete(sealed));
+}
+
+}  // namespace kcenon::file_transfer::test
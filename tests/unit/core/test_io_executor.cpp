@@ -0,0 +1,326 @@
+/**
+ * @file test_io_executor.cpp
+ * @brief Unit tests for the shared bounded I/O executor
+ */
+
+#include <gtest/gtest.h>
+
+#include <kcenon/file_transfer/core/io_executor.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace kcenon::file_transfer::test {
+
+class IoExecutorTest : public ::testing::Test {
+protected:
+    static auto make_config(std::size_t workers, std::size_t max_queue = 1000)
+        -> io_executor_config {
+        io_executor_config config;
+        config.worker_count = workers;
+        config.max_queue_depth = max_queue;
+        return config;
+    }
+
+    // Blocks tasks until released
+    struct gate {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool open = false;
+
+        void wait() {
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [this] { return open; });
+        }
+
+        void release() {
+            {
+                std::lock_guard lock(mutex);
+                open = true;
+            }
+            cv.notify_all();
+        }
+    };
+};
+
+TEST_F(IoExecutorTest, Submit_ReturnsValue) {
+    io_executor executor(make_config(2));
+
+    auto future = executor.submit("lane", [] { return 42; });
+    EXPECT_EQ(future.get(), 42);
+
+    auto res = executor.submit("lane", []() -> result<int> { return 7; }).get();
+    ASSERT_TRUE(res.has_value());
+    EXPECT_EQ(res.value(), 7);
+}
+
+TEST_F(IoExecutorTest, Submit_PropagatesExceptions) {
+    io_executor executor(make_config(1));
+
+    auto future = executor.submit("lane", []() -> int { throw std::runtime_error("boom"); });
+    EXPECT_THROW(future.get(), std::runtime_error);
+}
+
+TEST_F(IoExecutorTest, LaneLimit_CapsConcurrency) {
+    io_executor executor(make_config(8));
+    executor.set_lane_limit("slow", 2);
+
+    std::atomic<int> running{0};
+    std::atomic<int> peak{0};
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 16; ++i) {
+        futures.push_back(executor.submit("slow", [&] {
+            int now = ++running;
+            int expected = peak.load();
+            while (now > expected && !peak.compare_exchange_weak(expected, now)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            --running;
+        }));
+    }
+    for (auto& f : futures) f.get();
+
+    EXPECT_LE(peak.load(), 2);
+    EXPECT_GE(peak.load(), 1);
+}
+
+TEST_F(IoExecutorTest, LaneLimit_SlowLaneDoesNotStarveOthers) {
+    io_executor executor(make_config(4));
+    executor.set_lane_limit("slow", 1);
+
+    gate blocker;
+    std::vector<std::future<void>> slow;
+    for (int i = 0; i < 4; ++i) {
+        slow.push_back(executor.submit("slow", [&] { blocker.wait(); }));
+    }
+
+    auto fast = executor.submit("fast", [] { return 1; });
+    EXPECT_EQ(fast.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+
+    blocker.release();
+    for (auto& f : slow) f.get();
+}
+
+TEST_F(IoExecutorTest, QueueFull_RejectsWithError) {
+    io_executor executor(make_config(1, 2));
+
+    gate blocker;
+    std::atomic<bool> started{false};
+    auto running = executor.submit("lane", [&]() -> result<void> {
+        started = true;
+        blocker.wait();
+        return {};
+    });
+    while (!started) std::this_thread::yield();
+
+    auto queued1 = executor.submit("lane", []() -> result<void> { return {}; });
+    auto queued2 = executor.submit("lane", []() -> result<void> { return {}; });
+    auto rejected = executor.submit("lane", []() -> result<void> { return {}; });
+
+    auto res = rejected.get();
+    ASSERT_FALSE(res.has_value());
+    EXPECT_EQ(res.error().code, error_code::queue_full);
+    EXPECT_EQ(executor.metrics().rejected, 1);
+
+    blocker.release();
+    EXPECT_TRUE(running.get().has_value());
+    EXPECT_TRUE(queued1.get().has_value());
+    EXPECT_TRUE(queued2.get().has_value());
+}
+
+TEST_F(IoExecutorTest, CancellationToken_DropsQueuedTask) {
+    io_executor executor(make_config(1));
+
+    gate blocker;
+    auto running = executor.submit("lane", [&] { blocker.wait(); });
+
+    io_cancellation_token token;
+    std::atomic<bool> ran{false};
+    auto cancelled = executor.submit(
+        "lane",
+        [&]() -> result<void> {
+            ran = true;
+            return {};
+        },
+        token);
+    token.cancel();
+    blocker.release();
+
+    auto res = cancelled.get();
+    ASSERT_FALSE(res.has_value());
+    EXPECT_EQ(res.error().code, error_code::operation_cancelled);
+    EXPECT_FALSE(ran.load());
+    running.get();
+    for (int i = 0; i < 100 && executor.metrics().cancelled < 1; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(executor.metrics().cancelled, 1);
+}
+
+TEST_F(IoExecutorTest, SubmitAfter_DelaysWithoutOccupyingWorker) {
+    io_executor executor(make_config(1));
+
+    auto start = std::chrono::steady_clock::now();
+    auto delayed = executor.submit_after(std::chrono::milliseconds(100), "lane",
+                                         [] { return std::chrono::steady_clock::now(); });
+
+    // The only worker stays free for immediate work while the timer runs
+    auto immediate = executor.submit("lane", [] { return 1; });
+    EXPECT_EQ(immediate.wait_for(std::chrono::milliseconds(50)), std::future_status::ready);
+    EXPECT_EQ(executor.metrics().delayed_tasks, 1);
+
+    auto ran_at = delayed.get();
+    EXPECT_GE(ran_at - start, std::chrono::milliseconds(100));
+}
+
+TEST_F(IoExecutorTest, Shutdown_CancelsQueuedWork) {
+    auto executor = std::make_unique<io_executor>(make_config(1));
+
+    gate blocker;
+    std::atomic<bool> started{false};
+    auto running = executor->submit("lane", [&] {
+        started = true;
+        blocker.wait();
+    });
+    while (!started) std::this_thread::yield();
+    auto queued = executor->submit("lane", []() -> result<void> { return {}; });
+    auto delayed = executor->submit_after(std::chrono::hours(1), "lane",
+                                          []() -> result<void> { return {}; });
+
+    std::thread releaser([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        blocker.release();
+    });
+    executor->shutdown();
+    releaser.join();
+
+    running.get();
+    EXPECT_EQ(queued.get().error().code, error_code::operation_cancelled);
+    EXPECT_EQ(delayed.get().error().code, error_code::operation_cancelled);
+
+    auto late = executor->submit("lane", []() -> result<void> { return {}; });
+    EXPECT_EQ(late.get().error().code, error_code::operation_cancelled);
+}
+
+TEST_F(IoExecutorTest, NestedSubmit_RunsConcurrentlyOnItsLane) {
+    io_executor executor(make_config(4));
+    executor.set_lane_blocking("async");
+
+    // Both nested tasks must be running at once to pass the barrier; run
+    // inline one after the other they would time out
+    auto outer = executor.submit("async", [&] {
+        EXPECT_TRUE(io_executor::on_blocking_task());
+        std::atomic<int> arrived{0};
+        auto part = [&] {
+            EXPECT_FALSE(io_executor::on_blocking_task());
+            ++arrived;
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+            while (arrived.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return arrived.load() == 2;
+        };
+        auto first = executor.submit("parts", part);
+        auto second = executor.submit("parts", part);
+        return first.get() && second.get();
+    });
+    ASSERT_EQ(outer.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_TRUE(outer.get());
+    EXPECT_FALSE(io_executor::on_worker_thread());
+}
+
+TEST_F(IoExecutorTest, BlockingLanes_LeaveWorkersForNestedWork) {
+    io_executor executor(make_config(2));
+    executor.set_lane_blocking("async");
+
+    // Two outer tasks on two workers would each hold one while waiting on
+    // nested work; the cap lets only one run, the other worker serves parts
+    std::vector<std::future<int>> outers;
+    for (int i = 0; i < 4; ++i) {
+        outers.push_back(executor.submit("async", [&executor, i] {
+            return executor.submit("parts", [i] { return i; }).get() + 1;
+        }));
+    }
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_EQ(outers[i].wait_for(std::chrono::seconds(2)), std::future_status::ready);
+        EXPECT_EQ(outers[i].get(), i + 1);
+    }
+    EXPECT_EQ(executor.metrics().active_blocking, 0);
+}
+
+TEST_F(IoExecutorTest, BlockingLanes_NestedBlockingRunsInline) {
+    io_executor executor(make_config(2));
+    executor.set_lane_blocking("async");
+    executor.set_lane_blocking("storage");
+
+    auto outer = executor.submit("storage", [&] {
+        return executor.submit("async", [] { return 5; }).get() + 1;
+    });
+    ASSERT_EQ(outer.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    EXPECT_EQ(outer.get(), 6);
+}
+
+TEST_F(IoExecutorTest, BlockingLanes_SingleWorkerRunsNestedWorkInline) {
+    io_executor executor(make_config(1));
+    executor.set_lane_blocking("async");
+
+    auto outer = executor.submit("async", [&] {
+        return executor.submit("parts", [] { return 5; }).get() + 1;
+    });
+    ASSERT_EQ(outer.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    EXPECT_EQ(outer.get(), 6);
+}
+
+TEST_F(IoExecutorTest, Metrics_ReportLanes) {
+    io_executor executor(make_config(2));
+    executor.set_lane_limit("a", 3);
+
+    executor.submit("a", [] {}).get();
+    executor.submit("b", [] {}).get();
+
+    auto m = executor.metrics();
+    EXPECT_EQ(m.worker_count, 2);
+    EXPECT_EQ(m.submitted, 2);
+    ASSERT_EQ(m.lanes.size(), 2);
+    EXPECT_EQ(m.lanes[0].name, "a");
+    EXPECT_EQ(m.lanes[0].concurrency_limit, 3);
+    EXPECT_EQ(m.lanes[1].concurrency_limit, 2);
+
+    // Completion is recorded after the future is fulfilled
+    for (int i = 0; i < 100 && executor.metrics().completed < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(executor.metrics().completed, 2);
+}
+
+TEST_F(IoExecutorTest, Scope_DestructionCancelsQueuedAndWaitsForRunning) {
+    io_executor executor(make_config(1));
+
+    std::atomic<bool> first_started{false};
+    std::atomic<bool> first_done{false};
+    std::atomic<bool> second_ran{false};
+    std::future<void> first;
+    std::future<result<void>> second;
+    {
+        io_scope scope("scoped", executor);
+        first = scope.submit([&] {
+            first_started = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+            first_done = true;
+        });
+        second = scope.submit([&]() -> result<void> {
+            second_ran = true;
+            return {};
+        });
+        EXPECT_EQ(scope.in_flight(), 2);
+        while (!first_started) std::this_thread::yield();
+    }
+
+    EXPECT_TRUE(first_done.load());
+    EXPECT_FALSE(second_ran.load());
+    EXPECT_EQ(second.get().error().code, error_code::operation_cancelled);
+}
+
+}  // namespace kcenon::file_transfer::test
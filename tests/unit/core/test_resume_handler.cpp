@@ -495,4 +495,120 @@ TEST_F(ResumeHandlerTest, Handler_ConcurrentMarkChunks) {
     EXPECT_TRUE(missing.value().empty());
 }
 
+// ============================================================================
+// Byte range Tests
+// ============================================================================
+
+TEST_F(ResumeHandlerTest, TransferState_AddReceivedRangeMerges) {
+    transfer_state state(transfer_id::generate(), "ranges.dat", 1000, 0, "");
+    state.variable_chunks = true;
+
+    state.add_received_range({100, 100});
+    state.add_received_range({400, 100});
+    state.add_received_range({200, 50});   // Touches the first
+    state.add_received_range({0, 0});      // Empty, ignored
+    ASSERT_EQ(state.received_ranges.size(), 2);
+    EXPECT_EQ(state.received_ranges[0], (file_byte_range{100, 150}));
+    EXPECT_EQ(state.received_ranges[1], (file_byte_range{400, 100}));
+
+    state.add_received_range({150, 300});  // Bridges both
+    ASSERT_EQ(state.received_ranges.size(), 1);
+    EXPECT_EQ(state.received_ranges[0], (file_byte_range{100, 400}));
+    EXPECT_DOUBLE_EQ(state.completion_percentage(), 40.0);
+
+    auto missing = state.missing_ranges();
+    ASSERT_EQ(missing.size(), 2);
+    EXPECT_EQ(missing[0], (file_byte_range{0, 100}));
+    EXPECT_EQ(missing[1], (file_byte_range{500, 500}));
+    EXPECT_FALSE(state.is_complete());
+
+    state.add_received_range({0, 100});
+    state.add_received_range({500, 500});
+    EXPECT_TRUE(state.is_complete());
+    EXPECT_TRUE(state.missing_ranges().empty());
+}
+
+TEST_F(ResumeHandlerTest, Handler_RangesSurviveRestart) {
+    resume_handler_config config(test_dir_);
+    config.checkpoint_interval = 2;
+
+    transfer_state state(transfer_id::generate(), "ranges.dat", 64ULL << 20, 0, "abc");
+    state.variable_chunks = true;
+    {
+        resume_handler handler(config);
+        ASSERT_TRUE(handler.save_state(state).has_value());
+        ASSERT_TRUE(handler.mark_range_received(state.id, 0, 16 << 20).has_value());
+        ASSERT_TRUE(handler.mark_range_received(state.id, 32 << 20, 4 << 20).has_value());
+    }
+
+    resume_handler reloaded(config);
+    auto loaded = reloaded.load_state(state.id);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_TRUE(loaded.value().variable_chunks);
+    ASSERT_EQ(loaded.value().received_ranges.size(), 2);
+
+    auto missing = reloaded.get_missing_ranges(state.id);
+    ASSERT_TRUE(missing.has_value());
+    ASSERT_EQ(missing.value().size(), 2);
+    EXPECT_EQ(missing.value()[0], (file_byte_range{16 << 20, 16 << 20}));
+    EXPECT_EQ(missing.value()[1], (file_byte_range{36 << 20, 28 << 20}));
+}
+
+TEST_F(ResumeHandlerTest, Handler_MarkRangeOutsideFile) {
+    resume_handler handler{resume_handler_config(test_dir_)};
+    auto state = create_test_state(4);
+    ASSERT_TRUE(handler.save_state(state).has_value());
+
+    auto result = handler.mark_range_received(state.id, 1024 * 1024 - 10, 11);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, error_code::invalid_chunk_index);
+    EXPECT_TRUE(handler.mark_range_received(state.id, 1024 * 1024 - 10, 10).has_value());
+}
+
+TEST_F(ResumeHandlerTest, Handler_StateWithoutRangesLoads) {
+    auto state = create_test_state(8);
+    auto path = test_dir_ / (state.id.to_string() + ".json");
+    std::ofstream(path) << "{\n  \"id\": \"" << state.id.to_string()
+                        << "\",\n  \"filename\": \"old.dat\",\n  \"total_size\": 100,\n"
+                        << "  \"transferred_bytes\": 0,\n  \"total_chunks\": 8,\n"
+                        << "  \"chunk_bitmap\": \"00\",\n  \"sha256\": \"\",\n"
+                        << "  \"started_at\": 0,\n  \"last_activity\": 0\n}";
+
+    resume_handler handler{resume_handler_config(test_dir_)};
+    auto loaded = handler.load_state(state.id);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_FALSE(loaded.value().variable_chunks);
+    EXPECT_TRUE(loaded.value().received_ranges.empty());
+    EXPECT_EQ(loaded.value().total_chunks, 8);
+}
+
+TEST_F(ResumeHandlerTest, Handler_ZeroRangeHeaderCountsAsReceived) {
+    resume_handler handler{resume_handler_config(test_dir_)};
+
+    chunk_header header;
+    header.chunk_offset = 0;
+    header.original_size = 256 * 1024;
+    header.flags = chunk_flags::first_chunk | chunk_flags::zero_range;
+
+    // Fixed-size transfer: by index
+    auto fixed = create_test_state(4);
+    ASSERT_TRUE(handler.save_state(fixed).has_value());
+    header.id = fixed.id;
+    header.chunk_index = 0;
+    ASSERT_TRUE(handler.mark_chunk_received(header).has_value());
+    EXPECT_TRUE(handler.is_chunk_received(fixed.id, 0));
+
+    // Variable-size transfer: by the range the zeros cover
+    transfer_state variable(transfer_id::generate(), "sparse.img", 1024 * 1024, 0, "abc");
+    variable.variable_chunks = true;
+    ASSERT_TRUE(handler.save_state(variable).has_value());
+    header.id = variable.id;
+    ASSERT_TRUE(handler.mark_chunk_received(header).has_value());
+
+    auto missing = handler.get_missing_ranges(variable.id);
+    ASSERT_TRUE(missing.has_value());
+    ASSERT_EQ(missing.value().size(), 1);
+    EXPECT_EQ(missing.value()[0], (file_byte_range{256 * 1024, 768 * 1024}));
+}
+
 }  // namespace kcenon::file_transfer::test
@@ -0,0 +1,198 @@
+/**
+ * @file test_transfer_registry.cpp
+ * @brief Unit tests for the sharded transfer registry
+ */
+
+#include <gtest/gtest.h>
+
+#include <kcenon/file_transfer/core/transfer_registry.h>
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace kcenon::file_transfer::test {
+
+class TransferRegistryTest : public ::testing::Test {
+protected:
+    struct entry {
+        explicit entry(int v = 0) : value(v) {}
+        int value;
+        std::atomic<int> hits{0};
+    };
+};
+
+TEST_F(TransferRegistryTest, InsertFindErase) {
+    transfer_registry<entry> registry;
+    auto id = transfer_id::generate();
+
+    EXPECT_FALSE(registry.contains(id));
+    EXPECT_EQ(registry.find(id), nullptr);
+
+    auto [stored, inserted] = registry.insert(id, std::make_shared<entry>(7));
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(stored->value, 7);
+    EXPECT_TRUE(registry.contains(id));
+    EXPECT_EQ(registry.find(id)->value, 7);
+    EXPECT_EQ(registry.size(), 1);
+
+    auto removed = registry.erase(id);
+    ASSERT_NE(removed, nullptr);
+    EXPECT_EQ(removed->value, 7);
+    EXPECT_FALSE(registry.contains(id));
+    EXPECT_EQ(registry.erase(id), nullptr);
+    EXPECT_TRUE(registry.empty());
+}
+
+TEST_F(TransferRegistryTest, InsertKeepsExistingValue) {
+    transfer_registry<entry> registry;
+    auto id = transfer_id::generate();
+    registry.insert(id, std::make_shared<entry>(1));
+
+    auto [stored, inserted] = registry.insert(id, std::make_shared<entry>(2));
+    EXPECT_FALSE(inserted);
+    EXPECT_EQ(stored->value, 1);
+    EXPECT_EQ(registry.size(), 1);
+}
+
+TEST_F(TransferRegistryTest, ShardCountIsRoundedToPowerOfTwo) {
+    EXPECT_EQ(transfer_registry<entry>(1).shard_count(), 1);
+    EXPECT_EQ(transfer_registry<entry>(5).shard_count(), 8);
+    EXPECT_EQ(transfer_registry<entry>(0).shard_count(), 1);
+    EXPECT_EQ(transfer_registry<entry>().shard_count(),
+              transfer_registry<entry>::default_shard_count);
+}
+
+TEST_F(TransferRegistryTest, GrowsAndSurvivesChurn) {
+    // A single shard exercises growth, tombstones and rehashing directly
+    transfer_registry<entry> registry(1);
+    std::vector<transfer_id> ids(5000);
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        ids[i] = transfer_id::generate();
+        ASSERT_TRUE(registry.insert(ids[i], std::make_shared<entry>(static_cast<int>(i))).second);
+    }
+    EXPECT_EQ(registry.size(), ids.size());
+
+    for (std::size_t i = 0; i < ids.size(); i += 2) {
+        ASSERT_NE(registry.erase(ids[i]), nullptr);
+    }
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        auto found = registry.find(ids[i]);
+        if (i % 2 == 0) {
+            EXPECT_EQ(found, nullptr) << i;
+        } else {
+            ASSERT_NE(found, nullptr) << i;
+            EXPECT_EQ(found->value, static_cast<int>(i));
+        }
+    }
+
+    // Reuse the freed slots many times over
+    for (int round = 0; round < 20; ++round) {
+        auto id = transfer_id::generate();
+        registry.insert(id, std::make_shared<entry>(round));
+        EXPECT_EQ(registry.find(id)->value, round);
+        registry.erase(id);
+    }
+    EXPECT_EQ(registry.size(), ids.size() / 2);
+}
+
+TEST_F(TransferRegistryTest, SequentialIntegerKeysSpreadAcrossShards) {
+    transfer_registry<entry, uint64_t> registry(16);
+    for (uint64_t handle = 1; handle <= 1000; ++handle) {
+        registry.insert(handle, std::make_shared<entry>(static_cast<int>(handle)));
+    }
+    EXPECT_EQ(registry.size(), 1000);
+    EXPECT_EQ(registry.find(500)->value, 500);
+
+    std::set<int> values;
+    registry.for_each([&](uint64_t key, const auto& value) {
+        EXPECT_EQ(static_cast<uint64_t>(value->value), key);
+        values.insert(value->value);
+    });
+    EXPECT_EQ(values.size(), 1000);
+}
+
+TEST_F(TransferRegistryTest, ErasedValueOutlivesReaders) {
+    transfer_registry<entry> registry;
+    auto id = transfer_id::generate();
+    registry.insert(id, std::make_shared<entry>(3));
+
+    auto held = registry.find(id);
+    std::weak_ptr<entry> watch = held;
+    registry.erase(id);
+    EXPECT_FALSE(watch.expired());
+    EXPECT_EQ(held->value, 3);
+
+    held.reset();
+    EXPECT_TRUE(watch.expired());
+}
+
+TEST_F(TransferRegistryTest, ClearReturnsEveryValue) {
+    transfer_registry<entry> registry(4);
+    for (int i = 0; i < 100; ++i) {
+        registry.insert(transfer_id::generate(), std::make_shared<entry>(i));
+    }
+    EXPECT_EQ(registry.clear().size(), 100);
+    EXPECT_TRUE(registry.empty());
+}
+
+TEST_F(TransferRegistryTest, ConcurrentInsertFindErase) {
+    constexpr int threads = 8;
+    constexpr int per_thread = 2000;
+    transfer_registry<entry> registry(8);
+
+    std::vector<std::vector<transfer_id>> ids(threads);
+    for (auto& list : ids) {
+        for (int i = 0; i < per_thread; ++i) {
+            list.push_back(transfer_id::generate());
+        }
+    }
+
+    std::atomic<int> misses{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (const auto& id : ids[t]) {
+                registry.insert(id, std::make_shared<entry>(t));
+            }
+            // Look up everyone's keys while others are still inserting and erasing
+            for (int round = 0; round < 3; ++round) {
+                for (const auto& id : ids[(t + round) % threads]) {
+                    if (auto found = registry.find(id)) {
+                        found->hits++;
+                    }
+                }
+            }
+            for (std::size_t i = 0; i < ids[t].size(); i += 2) {
+                if (!registry.erase(ids[t][i])) {
+                    misses++;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    EXPECT_EQ(misses.load(), 0);
+    EXPECT_EQ(registry.size(), threads * per_thread / 2);
+    for (int t = 0; t < threads; ++t) {
+        EXPECT_EQ(registry.find(ids[t][1])->value, t);
+    }
+}
+
+TEST_F(TransferRegistryTest, TransferIdHashUsesEveryByte) {
+    std::hash<transfer_id> hash;
+    transfer_id a;
+    std::set<std::size_t> hashes;
+    for (std::size_t i = 0; i < a.bytes.size(); ++i) {
+        auto b = a;
+        b.bytes[i] = 1;
+        hashes.insert(hash(b));
+    }
+    hashes.insert(hash(a));
+    EXPECT_EQ(hashes.size(), a.bytes.size() + 1);
+}
+
+}  // namespace kcenon::file_transfer::test
@@ -8,6 +8,8 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <random>
 #include <thread>
 #include <vector>
@@ -546,6 +548,175 @@ TEST_F(AesGcmEngineTest, EncryptSingleByte) {
     EXPECT_EQ(decrypt_result.value().plaintext, single_byte);
 }
 
+// ============================================================================
+// In-place and Batch Chunk Tests
+// ============================================================================
+
+TEST_F(AesGcmEngineTest, InPlaceChunkRoundTrip) {
+    auto original = generate_random_data(65536);
+    auto buffer = original;
+    std::array<std::byte, AES_GCM_TAG_SIZE> tag{};
+
+    ASSERT_TRUE(engine_->encrypt_chunk_in_place(std::span<std::byte>(buffer), 7,
+                                                std::span<std::byte>(tag)).has_value());
+    EXPECT_NE(buffer, original);
+
+    ASSERT_TRUE(engine_->decrypt_chunk_in_place(std::span<std::byte>(buffer), 7,
+                                                std::span<const std::byte>(tag)).has_value());
+    EXPECT_EQ(buffer, original);
+}
+
+TEST_F(AesGcmEngineTest, ChunkIvIsSaltAndIndex) {
+    auto salt = engine_->iv_salt();
+    ASSERT_EQ(salt.size(), AES_GCM_IV_SIZE - 8);
+
+    auto iv = engine_->chunk_iv(0x0102030405060708ULL);
+    ASSERT_EQ(iv.size(), AES_GCM_IV_SIZE);
+    EXPECT_TRUE(std::equal(salt.begin(), salt.end(), iv.begin()));
+    for (std::size_t i = 0; i < 8; ++i) {
+        EXPECT_EQ(iv[salt.size() + i], static_cast<std::byte>(i + 1));
+    }
+    EXPECT_NE(engine_->chunk_iv(1), engine_->chunk_iv(2));
+
+    // A new key comes with a new salt
+    ASSERT_TRUE(engine_->set_key(std::span<const std::byte>(key_)).has_value());
+    EXPECT_NE(engine_->iv_salt(), salt);
+}
+
+TEST_F(AesGcmEngineTest, InPlaceChunkDecryptsWithChunkIv) {
+    auto original = generate_random_data(4096);
+    auto buffer = original;
+    std::array<std::byte, AES_GCM_TAG_SIZE> tag{};
+    ASSERT_TRUE(engine_->encrypt_chunk_in_place(std::span<std::byte>(buffer), 3,
+                                                std::span<std::byte>(tag)).has_value());
+
+    encryption_metadata metadata;
+    metadata.iv = engine_->chunk_iv(3);
+    metadata.auth_tag.assign(tag.begin(), tag.end());
+    auto decrypted = engine_->decrypt(std::span<const std::byte>(buffer), metadata);
+    ASSERT_TRUE(decrypted.has_value());
+    EXPECT_EQ(decrypted.value().plaintext, original);
+}
+
+TEST_F(AesGcmEngineTest, BatchRoundTripAndTamperDetection) {
+    constexpr std::size_t sizes[] = {0, 1, 1000, 16384, 65536, 262144};
+    std::vector<std::vector<std::byte>> originals;
+    std::vector<std::vector<std::byte>> buffers;
+    for (auto size : sizes) {
+        originals.push_back(generate_random_data(size));
+        buffers.push_back(originals.back());
+    }
+
+    std::vector<aes_gcm_chunk> chunks(buffers.size());
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        chunks[i].index = 100 + i;
+        chunks[i].data = std::span<std::byte>(buffers[i]);
+    }
+
+    engine_->reset_statistics();
+    ASSERT_TRUE(engine_->encrypt_chunks(std::span<aes_gcm_chunk>(chunks)).has_value());
+    EXPECT_EQ(engine_->get_statistics().encryption_ops, chunks.size());
+    EXPECT_NE(chunks[0].tag, chunks[1].tag);
+
+    ASSERT_TRUE(engine_->decrypt_chunks(std::span<aes_gcm_chunk>(chunks)).has_value());
+    for (std::size_t i = 0; i < buffers.size(); ++i) {
+        EXPECT_EQ(buffers[i], originals[i]) << "chunk " << i;
+    }
+
+    // Decrypting needs the right index as well as the right tag
+    ASSERT_TRUE(engine_->encrypt_chunks(std::span<aes_gcm_chunk>(chunks)).has_value());
+    buffers[3][0] ^= std::byte{0x01};
+    auto result = engine_->decrypt_chunks(std::span<aes_gcm_chunk>(chunks));
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code, error_code::chunk_checksum_error);
+
+    std::array<std::byte, AES_GCM_TAG_SIZE> tag{};
+    auto buffer = originals[2];
+    ASSERT_TRUE(engine_->encrypt_chunk_in_place(std::span<std::byte>(buffer), 1,
+                                                std::span<std::byte>(tag)).has_value());
+    EXPECT_FALSE(engine_->decrypt_chunk_in_place(std::span<std::byte>(buffer), 2,
+                                                 std::span<const std::byte>(tag)).has_value());
+}
+
+TEST_F(AesGcmEngineTest, ReceiverAdoptsSenderSalt) {
+    auto receiver = aes_gcm_engine::create();
+    ASSERT_TRUE(receiver->set_key(std::span<const std::byte>(key_)).has_value());
+
+    auto original = generate_random_data(8192);
+    auto buffer = original;
+    std::array<std::byte, AES_GCM_TAG_SIZE> tag{};
+    ASSERT_TRUE(engine_->encrypt_chunk_in_place(std::span<std::byte>(buffer), 0,
+                                                std::span<std::byte>(tag)).has_value());
+
+    auto sender_salt = engine_->iv_salt();
+    EXPECT_FALSE(receiver->set_iv_salt(std::span<const std::byte>(key_)).has_value());
+    ASSERT_TRUE(receiver->set_iv_salt(std::span<const std::byte>(sender_salt)).has_value());
+    ASSERT_TRUE(receiver->decrypt_chunk_in_place(std::span<std::byte>(buffer), 0,
+                                                 std::span<const std::byte>(tag)).has_value());
+    EXPECT_EQ(buffer, original);
+}
+
+TEST_F(AesGcmEngineTest, ChunkOperationsFollowKeyChanges) {
+    auto original = generate_random_data(1024);
+    auto buffer = original;
+    std::array<std::byte, AES_GCM_TAG_SIZE> tag{};
+    ASSERT_TRUE(engine_->encrypt_chunk_in_place(std::span<std::byte>(buffer), 0,
+                                                std::span<std::byte>(tag)).has_value());
+    auto salt = engine_->iv_salt();
+
+    engine_->clear_key();
+    auto cleared = engine_->decrypt_chunk_in_place(std::span<std::byte>(buffer), 0,
+                                                   std::span<const std::byte>(tag));
+    ASSERT_FALSE(cleared.has_value());
+    EXPECT_EQ(cleared.error().code, error_code::not_initialized);
+
+    // Pooled contexts keyed with the old key must not be reused
+    auto other_key = generate_random_data(AES_256_KEY_SIZE);
+    ASSERT_TRUE(engine_->set_key(std::span<const std::byte>(other_key)).has_value());
+    ASSERT_TRUE(engine_->set_iv_salt(std::span<const std::byte>(salt)).has_value());
+    EXPECT_FALSE(engine_->decrypt_chunk_in_place(std::span<std::byte>(buffer), 0,
+                                                 std::span<const std::byte>(tag)).has_value());
+}
+
+TEST_F(AesGcmEngineTest, ConcurrentChunkBatches) {
+    constexpr int num_threads = 4;
+    constexpr int batches_per_thread = 20;
+    constexpr std::size_t batch_size = 8;
+
+    std::vector<std::thread> threads;
+    std::atomic<int> success_count{0};
+
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([this, t, &success_count]() {
+            auto original = generate_random_data(4096);
+            std::vector<std::vector<std::byte>> buffers(batch_size);
+            std::vector<aes_gcm_chunk> chunks(batch_size);
+            for (int b = 0; b < batches_per_thread; ++b) {
+                for (std::size_t i = 0; i < batch_size; ++i) {
+                    buffers[i] = original;
+                    chunks[i].index = (static_cast<uint64_t>(t) << 32) +
+                                      static_cast<uint64_t>(b) * batch_size + i;
+                    chunks[i].data = std::span<std::byte>(buffers[i]);
+                }
+                if (!engine_->encrypt_chunks(std::span<aes_gcm_chunk>(chunks)) ||
+                    !engine_->decrypt_chunks(std::span<aes_gcm_chunk>(chunks))) {
+                    continue;
+                }
+                if (std::all_of(buffers.begin(), buffers.end(),
+                                [&](const auto& buffer) { return buffer == original; })) {
+                    ++success_count;
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(success_count.load(), num_threads * batches_per_thread);
+}
+
 // ============================================================================
 // Thread Safety Tests
 // ============================================================================
@@ -0,0 +1,263 @@
+/**
+ * @file test_frame_codec.cpp
+ * @brief Unit tests for wire frame encoding and stream decoding
+ */
+
+#include <gtest/gtest.h>
+
+#include <kcenon/file_transfer/core/checksum.h>
+#include <kcenon/file_transfer/core/frame_codec.h>
+
+#include <vector>
+
+namespace kcenon::file_transfer::test {
+
+class FrameCodecTest : public ::testing::Test {
+protected:
+    static auto make_payload(std::size_t size) -> std::vector<uint8_t> {
+        std::vector<uint8_t> payload(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            payload[i] = static_cast<uint8_t>(i * 31 + 7);
+        }
+        return payload;
+    }
+
+    static auto make_chunk(uint64_t index, std::size_t size) -> chunk {
+        chunk c;
+        c.header.id = transfer_id::generate();
+        c.header.chunk_index = index;
+        c.header.chunk_offset = index * size;
+        c.data.resize(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            c.data[i] = static_cast<std::byte>(i % 253);
+        }
+        c.header.original_size = static_cast<uint32_t>(size);
+        c.header.compressed_size = static_cast<uint32_t>(size);
+        c.header.checksum = checksum::crc32(c.data);
+        c.header.flags = chunk_flags::last_chunk;
+        return c;
+    }
+};
+
+TEST_F(FrameCodecTest, EncodesSpecLayout) {
+    std::vector<uint8_t> payload{0x01, 0x02};
+    auto bytes = encode_frame(message_type::heartbeat, payload);
+
+    ASSERT_EQ(bytes.size(), frame_header::total_overhead + payload.size());
+    EXPECT_EQ(bytes[0], 0x46);
+    EXPECT_EQ(bytes[3], 0x31);
+    EXPECT_EQ(bytes[4], static_cast<uint8_t>(message_type::heartbeat));
+    EXPECT_EQ(bytes[8], 2);  // payload_length, big-endian
+
+    uint16_t sum = 0;
+    for (std::size_t i = 0; i < 11; ++i) {
+        sum += bytes[i];
+    }
+    EXPECT_EQ(bytes[11], sum >> 8);
+    EXPECT_EQ(bytes[12], sum & 0xFF);
+    EXPECT_EQ(bytes[13], 0);
+    EXPECT_EQ(bytes[14], 2);  // length_echo
+}
+
+TEST_F(FrameCodecTest, DecodesAcrossArbitrarySplits) {
+    auto first = encode_frame(message_type::chunk_data, make_payload(5000));
+    auto second = encode_frame(message_type::upload_complete, make_payload(40));
+    std::vector<uint8_t> stream(first);
+    stream.insert(stream.end(), second.begin(), second.end());
+
+    frame_decoder decoder;
+    std::vector<frame> frames;
+    for (std::size_t pos = 0; pos < stream.size(); pos += 7) {
+        auto end = std::min(stream.size(), pos + 7);
+        decoder.feed(std::span<const uint8_t>(stream.data() + pos, end - pos));
+        while (auto f = decoder.next()) {
+            frames.push_back(std::move(*f));
+        }
+    }
+
+    ASSERT_EQ(frames.size(), 2);
+    EXPECT_EQ(frames[0].type, message_type::chunk_data);
+    EXPECT_EQ(frames[0].payload, make_payload(5000));
+    EXPECT_EQ(frames[1].type, message_type::upload_complete);
+    EXPECT_EQ(decoder.buffered(), 0);
+    EXPECT_EQ(decoder.discarded_frames(), 0);
+}
+
+TEST_F(FrameCodecTest, ResyncsAfterCorruptFrame) {
+    auto bad = encode_frame(message_type::chunk_data, make_payload(100));
+    bad[50] ^= 0xFF;  // Payload corruption breaks the checksum
+    auto good = encode_frame(message_type::heartbeat, {});
+
+    std::vector<uint8_t> stream{0x00, 0x46, 0x54};  // Leading garbage
+    stream.insert(stream.end(), bad.begin(), bad.end());
+    stream.insert(stream.end(), good.begin(), good.end());
+
+    frame_decoder decoder;
+    decoder.feed(stream);
+    auto f = decoder.next();
+
+    ASSERT_TRUE(f.has_value());
+    EXPECT_EQ(f->type, message_type::heartbeat);
+    EXPECT_FALSE(decoder.next().has_value());
+    EXPECT_GE(decoder.discarded_frames(), 2);
+}
+
+TEST_F(FrameCodecTest, RejectsOversizedLength) {
+    auto bytes = encode_frame(message_type::chunk_data, make_payload(2048));
+    frame_decoder decoder(1024);
+    decoder.feed(bytes);
+
+    EXPECT_FALSE(decoder.next().has_value());
+    EXPECT_EQ(decoder.discarded_frames(), 1);
+    EXPECT_LT(decoder.buffered(), frame_header::size);
+}
+
+TEST_F(FrameCodecTest, ChunkDataRoundTrip) {
+    auto original = make_chunk(3, 4096);
+    auto decoded = decode_chunk_data(encode_chunk_data(original));
+
+    ASSERT_TRUE(decoded.has_value());
+    const auto& c = decoded.value();
+    EXPECT_EQ(c.header.id, original.header.id);
+    EXPECT_EQ(c.header.chunk_index, 3);
+    EXPECT_EQ(c.header.chunk_offset, 3 * 4096);
+    EXPECT_EQ(c.header.checksum, original.header.checksum);
+    EXPECT_TRUE(c.is_last());
+    EXPECT_EQ(c.data, original.data);
+}
+
+TEST_F(FrameCodecTest, ChunkDataSizeMismatchRejected) {
+    auto payload = encode_chunk_data(make_chunk(0, 100));
+    payload.pop_back();
+
+    auto decoded = decode_chunk_data(payload);
+    ASSERT_FALSE(decoded.has_value());
+    EXPECT_EQ(decoded.error().code, error_code::chunk_size_error);
+
+    auto truncated = decode_chunk_data(std::span<const uint8_t>(payload.data(), 20));
+    ASSERT_FALSE(truncated.has_value());
+    EXPECT_EQ(truncated.error().code, error_code::invalid_message);
+}
+
+TEST_F(FrameCodecTest, ChunkDataCarriesIntegrityAlgorithm) {
+    auto original = make_chunk(1, 1000);
+    original.set_digest(chunk_integrity::crc32c, checksum::crc32c(original.data));
+    auto payload = encode_chunk_data(original);
+    EXPECT_EQ(payload.size(), chunk_header::size + 1000);
+    EXPECT_EQ(payload[45], static_cast<uint8_t>(chunk_integrity::crc32c));
+
+    auto decoded = decode_chunk_data(payload);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded.value().header.integrity, chunk_integrity::crc32c);
+    EXPECT_EQ(decoded.value().digest(), original.digest());
+}
+
+TEST_F(FrameCodecTest, ChunkData64BitDigestTrailer) {
+    auto original = make_chunk(2, 1000);
+    original.set_digest(chunk_integrity::xxh3_64, 0x0123456789ABCDEFULL);
+    auto payload = encode_chunk_data(original);
+    EXPECT_EQ(payload.size(), chunk_header::size + 1000 + 4);
+    EXPECT_EQ(payload.size(), original.total_size());
+
+    auto decoded = decode_chunk_data(payload);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded.value().header.integrity, chunk_integrity::xxh3_64);
+    EXPECT_EQ(decoded.value().digest(), 0x0123456789ABCDEFULL);
+    EXPECT_EQ(decoded.value().data, original.data);
+}
+
+TEST_F(FrameCodecTest, UnknownIntegrityAlgorithmRejected) {
+    auto payload = encode_chunk_data(make_chunk(0, 100));
+    payload[45] = 0x7F;
+
+    auto decoded = decode_chunk_data(payload);
+    ASSERT_FALSE(decoded.has_value());
+    EXPECT_EQ(decoded.error().code, error_code::invalid_message);
+}
+
+TEST_F(FrameCodecTest, UploadRequestRoundTrip) {
+    msg_upload_request request{};
+    request.transfer_id = transfer_id::generate().bytes;
+    request.filename = "reports/q3.csv";
+    request.file_size = 5ULL * 1024 * 1024 * 1024;
+    request.sha256_hash.fill(0xAB);
+    request.compression = wire_compression_mode::lz4;
+    request.encryption = wire_encryption_algorithm::none;
+    request.options = transfer_options::verify_checksum;
+    request.resume_from = 0;
+
+    auto payload = encode_upload_request(request);
+    EXPECT_EQ(payload.size(), msg_upload_request::min_serialized_size + request.filename.size());
+
+    auto decoded = decode_upload_request(payload);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded.value().transfer_id, request.transfer_id);
+    EXPECT_EQ(decoded.value().filename, request.filename);
+    EXPECT_EQ(decoded.value().file_size, request.file_size);
+    EXPECT_EQ(decoded.value().sha256_hash, request.sha256_hash);
+    EXPECT_EQ(decoded.value().compression, wire_compression_mode::lz4);
+    EXPECT_TRUE(has_option(decoded.value().options, transfer_options::verify_checksum));
+}
+
+TEST_F(FrameCodecTest, FixedSizeMessagesRoundTrip) {
+    msg_upload_complete complete{transfer_id::generate().bytes, 12, 3000, 2000};
+    auto payload = encode_upload_complete(complete);
+    EXPECT_EQ(payload.size(), msg_upload_complete::serialized_size);
+    auto decoded = decode_upload_complete(payload);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded.value().total_chunks, 12);
+    EXPECT_EQ(decoded.value().bytes_on_wire, 2000);
+
+    msg_chunk_nack nack{complete.transfer_id, 7, -120, 0};
+    auto nack_payload = encode_chunk_nack(nack);
+    EXPECT_EQ(nack_payload.size(), msg_chunk_nack::serialized_size);
+    auto decoded_nack = decode_chunk_nack(nack_payload);
+    ASSERT_TRUE(decoded_nack.has_value());
+    EXPECT_EQ(decoded_nack.value().chunk_index, 7);
+    EXPECT_EQ(decoded_nack.value().reason_code, -120);
+
+    // Trailing bytes make a fixed-size payload invalid
+    payload.push_back(0);
+    EXPECT_FALSE(decode_upload_complete(payload).has_value());
+}
+
+TEST_F(FrameCodecTest, UploadCompleteCarriesDeferredDigest) {
+    msg_upload_complete complete{transfer_id::generate().bytes, 4, 1000, 1000};
+    for (std::size_t i = 0; i < complete.sha256_hash.size(); ++i) {
+        complete.sha256_hash[i] = static_cast<uint8_t>(i + 1);
+    }
+    auto payload = encode_upload_complete(complete);
+    EXPECT_EQ(payload.size(), msg_upload_complete::serialized_size_with_digest);
+
+    auto decoded = decode_upload_complete(payload);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_TRUE(decoded.value().has_digest());
+    EXPECT_EQ(decoded.value().sha256_hash, complete.sha256_hash);
+    EXPECT_EQ(decoded.value().total_chunks, 4);
+
+    // Without a digest the 40-byte layout is unchanged and decodes as absent
+    complete.sha256_hash = {};
+    auto short_decoded = decode_upload_complete(encode_upload_complete(complete));
+    ASSERT_TRUE(short_decoded.has_value());
+    EXPECT_FALSE(short_decoded.value().has_digest());
+
+    // A truncated digest is rejected
+    payload.pop_back();
+    EXPECT_FALSE(decode_upload_complete(payload).has_value());
+}
+
+TEST_F(FrameCodecTest, VariableLengthMessagesRoundTrip) {
+    msg_upload_ack ack{transfer_id::generate().bytes, 1, "/data/reports/q3.csv"};
+    auto decoded = decode_upload_ack(encode_upload_ack(ack));
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded.value().verified, 1);
+    EXPECT_EQ(decoded.value().stored_path, ack.stored_path);
+
+    msg_upload_reject reject{ack.transfer_id, -749, "quota exceeded"};
+    auto rejected = decode_upload_reject(encode_upload_reject(reject));
+    ASSERT_TRUE(rejected.has_value());
+    EXPECT_EQ(rejected.value().reason_code, -749);
+    EXPECT_EQ(rejected.value().message, "quota exceeded");
+}
+
+}  // namespace kcenon::file_transfer::test
@@ -0,0 +1,92 @@
+/**
+ * @file test_access_sketch.cpp
+ * @brief Unit tests for the windowed count-min access sketch
+ */
+
+#include <gtest/gtest.h>
+
+#include <kcenon/file_transfer/server/access_sketch.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace kcenon::file_transfer::test {
+
+class AccessSketchTest : public ::testing::Test {};
+
+TEST_F(AccessSketchTest, UnseenKeyEstimatesZero) {
+    access_sketch sketch;
+    EXPECT_EQ(sketch.estimate("never.bin"), 0);
+}
+
+TEST_F(AccessSketchTest, EstimatesNeverUndercount) {
+    access_sketch sketch(256, 4);
+    for (int i = 0; i < 1000; ++i) {
+        sketch.record("key-" + std::to_string(i), static_cast<uint32_t>(i % 7 + 1));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_GE(sketch.estimate("key-" + std::to_string(i)), static_cast<uint64_t>(i % 7 + 1));
+    }
+}
+
+TEST_F(AccessSketchTest, SeparatesHotFromColdKeys) {
+    access_sketch sketch;
+    for (int i = 0; i < 500; ++i) {
+        sketch.record("hot.bin");
+    }
+    for (int i = 0; i < 2000; ++i) {
+        sketch.record("cold-" + std::to_string(i));
+    }
+    EXPECT_GE(sketch.estimate("hot.bin"), 500);
+    EXPECT_LT(sketch.estimate("hot.bin"), 510);
+    EXPECT_LE(sketch.estimate("cold-42"), 3);
+}
+
+TEST_F(AccessSketchTest, RotationForgetsOldGenerations) {
+    access_sketch sketch;
+    sketch.record("a.bin", 5);
+
+    sketch.rotate();
+    EXPECT_EQ(sketch.estimate("a.bin"), 5);  // Still within the window
+    sketch.record("a.bin", 2);
+    EXPECT_EQ(sketch.estimate("a.bin"), 7);
+
+    sketch.rotate();
+    EXPECT_EQ(sketch.estimate("a.bin"), 2);
+
+    sketch.rotate();
+    EXPECT_EQ(sketch.estimate("a.bin"), 0);
+}
+
+TEST_F(AccessSketchTest, WidthRoundsUpToPowerOfTwo) {
+    access_sketch sketch(1000, 3);
+    EXPECT_EQ(sketch.width(), 1024);
+    EXPECT_EQ(sketch.depth(), 3);
+    EXPECT_EQ(sketch.memory_usage(), 2 * 1024 * 3 * sizeof(uint32_t));
+}
+
+TEST_F(AccessSketchTest, ClearDropsAllCounts) {
+    access_sketch sketch;
+    sketch.record("a.bin", 3);
+    sketch.clear();
+    EXPECT_EQ(sketch.estimate("a.bin"), 0);
+}
+
+TEST_F(AccessSketchTest, ConcurrentRecordsAreCounted) {
+    access_sketch sketch;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&sketch] {
+            for (int i = 0; i < 1000; ++i) {
+                sketch.record("shared.bin");
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_GE(sketch.estimate("shared.bin"), 4000);
+}
+
+}  // namespace kcenon::file_transfer::test
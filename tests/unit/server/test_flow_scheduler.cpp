@@ -0,0 +1,211 @@
+/**
+ * @file test_flow_scheduler.cpp
+ * @brief Unit tests for weighted deficit round-robin upload scheduling
+ */
+
+#include <gtest/gtest.h>
+
+#include <kcenon/file_transfer/server/flow_scheduler.h>
+#include <kcenon/file_transfer/server/server_pipeline.h>
+
+#include <map>
+#include <vector>
+
+namespace kcenon::file_transfer::test {
+
+class FlowSchedulerTest : public ::testing::Test {
+protected:
+    static auto make_chunk(client_id client, const transfer_id& id, uint64_t index,
+                           std::size_t size = 1024) -> pipeline_chunk {
+        pipeline_chunk chunk;
+        chunk.id = id;
+        chunk.client = client;
+        chunk.chunk_index = index;
+        chunk.data.resize(size);
+        chunk.checksum = 0;
+        chunk.is_compressed = false;
+        chunk.original_size = size;
+        return chunk;
+    }
+
+    static auto find_stats(const std::vector<flow_stats>& stats, const transfer_id& id)
+        -> const flow_stats* {
+        for (const auto& s : stats) {
+            if (s.key.transfer == id) {
+                return &s;
+            }
+        }
+        return nullptr;
+    }
+};
+
+TEST_F(FlowSchedulerTest, EmptySchedulerPopsNothing) {
+    flow_scheduler scheduler;
+    EXPECT_TRUE(scheduler.empty());
+    EXPECT_FALSE(scheduler.pop().has_value());
+}
+
+TEST_F(FlowSchedulerTest, SingleFlowKeepsOrder) {
+    flow_scheduler scheduler;
+    auto id = transfer_id::generate();
+    for (uint64_t i = 0; i < 5; ++i) {
+        scheduler.push(make_chunk(client_id{1}, id, i));
+    }
+    EXPECT_EQ(scheduler.size(), 5);
+    for (uint64_t i = 0; i < 5; ++i) {
+        auto chunk = scheduler.pop();
+        ASSERT_TRUE(chunk.has_value());
+        EXPECT_EQ(chunk->chunk_index, i);
+    }
+    EXPECT_TRUE(scheduler.empty());
+}
+
+TEST_F(FlowSchedulerTest, SmallFlowIsNotQueuedBehindBulkBacklog) {
+    flow_scheduler scheduler(64 * 1024);
+    auto bulk = transfer_id::generate();
+    auto small = transfer_id::generate();
+    for (uint64_t i = 0; i < 100; ++i) {
+        scheduler.push(make_chunk(client_id{1}, bulk, i, 64 * 1024));
+    }
+    scheduler.push(make_chunk(client_id{2}, small, 0, 4096));
+
+    std::size_t position = 0;
+    while (auto chunk = scheduler.pop()) {
+        ++position;
+        if (chunk->id == small) {
+            break;
+        }
+    }
+    EXPECT_LE(position, 2);
+}
+
+TEST_F(FlowSchedulerTest, ClientsShareBytesByWeight) {
+    flow_scheduler scheduler(16 * 1024);
+    scheduler.set_client_weight(client_id{1}, 3);
+    auto heavy = transfer_id::generate();
+    auto light = transfer_id::generate();
+    for (uint64_t i = 0; i < 400; ++i) {
+        scheduler.push(make_chunk(client_id{1}, heavy, i, 4096));
+        scheduler.push(make_chunk(client_id{2}, light, i, 4096));
+    }
+
+    std::map<uint64_t, uint64_t> bytes;
+    for (int i = 0; i < 400; ++i) {
+        auto chunk = scheduler.pop();
+        ASSERT_TRUE(chunk.has_value());
+        bytes[chunk->client.value] += chunk->data.size();
+    }
+    auto ratio = static_cast<double>(bytes[1]) / static_cast<double>(bytes[2]);
+    EXPECT_NEAR(ratio, 3.0, 0.2);
+}
+
+TEST_F(FlowSchedulerTest, TransfersOfOneClientTakeTurns) {
+    flow_scheduler scheduler;
+    auto a = transfer_id::generate();
+    auto b = transfer_id::generate();
+    for (uint64_t i = 0; i < 4; ++i) {
+        scheduler.push(make_chunk(client_id{1}, a, i));
+    }
+    for (uint64_t i = 0; i < 4; ++i) {
+        scheduler.push(make_chunk(client_id{1}, b, i));
+    }
+
+    std::vector<transfer_id> order;
+    while (auto chunk = scheduler.pop()) {
+        order.push_back(chunk->id);
+    }
+    ASSERT_EQ(order.size(), 8);
+    for (std::size_t i = 1; i < order.size(); ++i) {
+        EXPECT_NE(order[i], order[i - 1]);
+    }
+}
+
+TEST_F(FlowSchedulerTest, HigherPriorityClassServedFirst) {
+    flow_scheduler scheduler;
+    auto background = transfer_id::generate();
+    auto interactive = transfer_id::generate();
+    scheduler.set_transfer_priority(background, flow_priority::bulk);
+    for (uint64_t i = 0; i < 3; ++i) {
+        scheduler.push(make_chunk(client_id{1}, background, i));
+    }
+    scheduler.push(make_chunk(client_id{2}, interactive, 0));
+
+    auto first = scheduler.pop();
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(first->id, interactive);
+}
+
+TEST_F(FlowSchedulerTest, PriorityChangeMovesQueuedChunks) {
+    flow_scheduler scheduler;
+    auto a = transfer_id::generate();
+    auto b = transfer_id::generate();
+    scheduler.push(make_chunk(client_id{1}, a, 0));
+    scheduler.push(make_chunk(client_id{2}, b, 0));
+    scheduler.set_transfer_priority(b, flow_priority::high);
+
+    auto first = scheduler.pop();
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(first->id, b);
+    EXPECT_EQ(scheduler.size(), 1);
+
+    auto stats = scheduler.stats();
+    auto* s = find_stats(stats, b);
+    ASSERT_NE(s, nullptr);
+    EXPECT_EQ(s->priority, flow_priority::high);
+}
+
+TEST_F(FlowSchedulerTest, StatsReportDepthAndWaits) {
+    flow_scheduler scheduler;
+    scheduler.set_client_weight(client_id{7}, 2);
+    auto id = transfer_id::generate();
+    for (uint64_t i = 0; i < 3; ++i) {
+        scheduler.push(make_chunk(client_id{7}, id, i, 100));
+    }
+    ASSERT_TRUE(scheduler.pop().has_value());
+
+    auto stats = scheduler.stats();
+    auto* s = find_stats(stats, id);
+    ASSERT_NE(s, nullptr);
+    EXPECT_EQ(s->key.client, client_id{7});
+    EXPECT_EQ(s->weight, 2);
+    EXPECT_EQ(s->queued_chunks, 2);
+    EXPECT_EQ(s->queued_bytes, 200);
+    EXPECT_EQ(s->dispatched_chunks, 1);
+    EXPECT_EQ(s->dispatched_bytes, 100);
+    EXPECT_EQ(s->wait.count, 1);
+    EXPECT_GT(s->wait.percentile(50).count(), 0);
+}
+
+TEST_F(FlowSchedulerTest, RemoveTransferDropsQueuedChunks) {
+    flow_scheduler scheduler;
+    auto a = transfer_id::generate();
+    auto b = transfer_id::generate();
+    scheduler.push(make_chunk(client_id{1}, a, 0));
+    scheduler.push(make_chunk(client_id{1}, a, 1));
+    scheduler.push(make_chunk(client_id{1}, b, 0));
+
+    auto dropped = scheduler.remove_transfer(a);
+    EXPECT_EQ(dropped.size(), 2);
+    EXPECT_EQ(scheduler.size(), 1);
+    EXPECT_EQ(find_stats(scheduler.stats(), a), nullptr);
+
+    auto next = scheduler.pop();
+    ASSERT_TRUE(next.has_value());
+    EXPECT_EQ(next->id, b);
+}
+
+TEST_F(FlowSchedulerTest, WaitHistogramBuckets) {
+    wait_histogram histogram;
+    histogram.record(std::chrono::microseconds(10));
+    histogram.record(std::chrono::microseconds(100));
+    histogram.record(std::chrono::seconds(10));
+
+    EXPECT_EQ(histogram.buckets[0], 1);
+    EXPECT_EQ(histogram.buckets[1], 1);
+    EXPECT_EQ(histogram.buckets[wait_histogram::bucket_count - 1], 1);
+    EXPECT_EQ(histogram.count, 3);
+    EXPECT_EQ(histogram.max, std::chrono::seconds(10));
+    EXPECT_EQ(histogram.percentile(50), wait_histogram::upper_bound(1));
+}
+
+}  // namespace kcenon::file_transfer::test
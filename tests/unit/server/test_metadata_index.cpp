@@ -0,0 +1,293 @@
+/**
+ * @file test_metadata_index.cpp
+ * @brief Unit tests for the persistent metadata index
+ */
+
+#include <gtest/gtest.h>
+
+#include <kcenon/file_transfer/server/metadata_index.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace kcenon::file_transfer::test {
+
+class MetadataIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = std::filesystem::temp_directory_path() / "metadata_index_test";
+        std::filesystem::remove_all(test_dir_);
+        std::filesystem::create_directories(test_dir_);
+        index_dir_ = test_dir_ / ".file_trans_index";
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(test_dir_, ec);
+    }
+
+    static auto make_entry(const std::string& key, uint64_t size, int64_t modified_s = 0)
+        -> stored_object_metadata {
+        stored_object_metadata metadata;
+        metadata.key = key;
+        metadata.size = size;
+        metadata.last_modified =
+            std::chrono::system_clock::time_point{std::chrono::seconds{modified_s}};
+        return metadata;
+    }
+
+    static auto keys_of(const list_storage_result& res) -> std::vector<std::string> {
+        std::vector<std::string> keys;
+        for (const auto& obj : res.objects) {
+            keys.push_back(obj.key);
+        }
+        return keys;
+    }
+
+    void create_test_file(const std::string& name, std::size_t size) {
+        auto path = test_dir_ / name;
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream file(path, std::ios::binary);
+        std::vector<char> data(size, 'x');
+        file.write(data.data(), static_cast<std::streamsize>(size));
+    }
+
+    std::filesystem::path test_dir_;
+    std::filesystem::path index_dir_;
+};
+
+TEST_F(MetadataIndexTest, Open_NewIndexNeedsRebuild) {
+    auto index = metadata_index::open(index_dir_);
+    ASSERT_TRUE(index.has_value());
+    EXPECT_TRUE(index.value().needs_rebuild());
+    EXPECT_EQ(index.value().size(), 0);
+    EXPECT_EQ(index.value().shard_count(), metadata_index::default_shard_count);
+}
+
+TEST_F(MetadataIndexTest, Open_ZeroShardsFails) {
+    auto index = metadata_index::open(index_dir_, 0);
+    EXPECT_FALSE(index.has_value());
+}
+
+TEST_F(MetadataIndexTest, PutFindErase) {
+    auto index = metadata_index::open(index_dir_);
+    ASSERT_TRUE(index.has_value());
+    auto& idx = index.value();
+
+    auto entry = make_entry("docs/readme.md", 42);
+    entry.tier = storage_tier::cold;
+    entry.content_type = "text/markdown";
+    entry.custom_metadata.emplace_back("owner", "alice");
+    ASSERT_TRUE(idx.put(entry).has_value());
+
+    auto found = idx.find("docs/readme.md");
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ(found->size, 42);
+    EXPECT_EQ(found->tier, storage_tier::cold);
+    EXPECT_EQ(found->content_type, "text/markdown");
+    ASSERT_EQ(found->custom_metadata.size(), 1);
+    EXPECT_EQ(found->custom_metadata[0].second, "alice");
+
+    ASSERT_TRUE(idx.erase("docs/readme.md").has_value());
+    EXPECT_FALSE(idx.find("docs/readme.md").has_value());
+    EXPECT_TRUE(idx.erase("missing").has_value());
+}
+
+TEST_F(MetadataIndexTest, Query_PrefixInKeyOrder) {
+    auto index = metadata_index::open(index_dir_);
+    ASSERT_TRUE(index.has_value());
+    auto& idx = index.value();
+
+    for (const auto* key : {"logs/b.log", "data.txt", "logs/a.log", "logsx/c.log", "zeta"}) {
+        ASSERT_TRUE(idx.put(make_entry(key, 1)).has_value());
+    }
+
+    list_storage_options options;
+    options.prefix = "logs/";
+    auto res = idx.query(options);
+    EXPECT_EQ(keys_of(res), (std::vector<std::string>{"logs/a.log", "logs/b.log"}));
+    EXPECT_FALSE(res.is_truncated);
+
+    // A prefix without '/' spans shards
+    options.prefix = "logs";
+    res = idx.query(options);
+    EXPECT_EQ(keys_of(res),
+              (std::vector<std::string>{"logs/a.log", "logs/b.log", "logsx/c.log"}));
+
+    options.prefix.reset();
+    options.descending = true;
+    res = idx.query(options);
+    EXPECT_EQ(keys_of(res).front(), "zeta");
+    EXPECT_EQ(keys_of(res).back(), "data.txt");
+}
+
+TEST_F(MetadataIndexTest, Query_PaginatesWithContinuationToken) {
+    auto index = metadata_index::open(index_dir_, 4);
+    ASSERT_TRUE(index.has_value());
+    auto& idx = index.value();
+
+    constexpr int file_count = 25;
+    for (int i = 0; i < file_count; ++i) {
+        auto key = "dir" + std::to_string(i % 5) + "/file" + std::to_string(i);
+        ASSERT_TRUE(idx.put(make_entry(key, static_cast<uint64_t>(i))).has_value());
+    }
+
+    for (auto field : {storage_sort_field::key, storage_sort_field::size}) {
+        for (bool descending : {false, true}) {
+            list_storage_options options;
+            options.max_results = 7;
+            options.sort_by = field;
+            options.descending = descending;
+
+            std::vector<std::string> seen;
+            std::vector<uint64_t> sizes;
+            for (int page = 0; page < 10; ++page) {
+                auto res = idx.query(options);
+                for (const auto& obj : res.objects) {
+                    seen.push_back(obj.key);
+                    sizes.push_back(obj.size);
+                }
+                if (!res.is_truncated) break;
+                ASSERT_TRUE(res.continuation_token.has_value());
+                options.continuation_token = res.continuation_token;
+            }
+
+            SCOPED_TRACE(std::string(field == storage_sort_field::key ? "key" : "size") +
+                         (descending ? " descending" : " ascending"));
+            EXPECT_EQ(seen.size(), static_cast<std::size_t>(file_count));
+            EXPECT_EQ(std::set<std::string>(seen.begin(), seen.end()).size(),
+                      static_cast<std::size_t>(file_count));
+            if (field == storage_sort_field::key) {
+                EXPECT_EQ(std::is_sorted(seen.begin(), seen.end()), !descending);
+            } else {
+                EXPECT_EQ(sizes.front(), descending ? file_count - 1 : 0);
+                EXPECT_EQ(sizes.back(), descending ? 0 : file_count - 1);
+            }
+        }
+    }
+}
+
+TEST_F(MetadataIndexTest, Query_SortByLastModifiedWithTierFilter) {
+    auto index = metadata_index::open(index_dir_);
+    ASSERT_TRUE(index.has_value());
+    auto& idx = index.value();
+
+    auto old_cold = make_entry("old", 1, 100);
+    old_cold.tier = storage_tier::cold;
+    auto new_cold = make_entry("new", 1, 300);
+    new_cold.tier = storage_tier::cold;
+    auto mid_hot = make_entry("mid", 1, 200);
+    ASSERT_TRUE(idx.put(old_cold).has_value());
+    ASSERT_TRUE(idx.put(new_cold).has_value());
+    ASSERT_TRUE(idx.put(mid_hot).has_value());
+
+    list_storage_options options;
+    options.sort_by = storage_sort_field::last_modified;
+    options.descending = true;
+    options.tier_filter = storage_tier::cold;
+
+    auto res = idx.query(options);
+    EXPECT_EQ(keys_of(res), (std::vector<std::string>{"new", "old"}));
+}
+
+TEST_F(MetadataIndexTest, Reopen_ReplaysLogAfterCleanClose) {
+    {
+        auto index = metadata_index::open(index_dir_);
+        ASSERT_TRUE(index.has_value());
+        ASSERT_TRUE(index.value().put(make_entry("a/1", 10)).has_value());
+        ASSERT_TRUE(index.value().put(make_entry("a/2", 20)).has_value());
+        ASSERT_TRUE(index.value().put(make_entry("b/3", 30)).has_value());
+        ASSERT_TRUE(index.value().erase("a/2").has_value());
+    }
+
+    auto index = metadata_index::open(index_dir_);
+    ASSERT_TRUE(index.has_value());
+    EXPECT_FALSE(index.value().needs_rebuild());
+    EXPECT_EQ(index.value().size(), 2);
+    EXPECT_EQ(index.value().find("b/3")->size, 30);
+    EXPECT_FALSE(index.value().find("a/2").has_value());
+}
+
+TEST_F(MetadataIndexTest, Reopen_ShardCountChangeRequiresRebuild) {
+    {
+        auto index = metadata_index::open(index_dir_, 4);
+        ASSERT_TRUE(index.has_value());
+        ASSERT_TRUE(index.value().put(make_entry("a", 1)).has_value());
+    }
+
+    auto index = metadata_index::open(index_dir_, 8);
+    ASSERT_TRUE(index.has_value());
+    EXPECT_TRUE(index.value().needs_rebuild());
+    EXPECT_EQ(index.value().size(), 0);
+}
+
+TEST_F(MetadataIndexTest, Reopen_TornLogTailIsDropped) {
+    {
+        auto index = metadata_index::open(index_dir_, 1);
+        ASSERT_TRUE(index.has_value());
+        ASSERT_TRUE(index.value().put(make_entry("kept", 1)).has_value());
+    }
+
+    // Simulate a crash in the middle of an append
+    {
+        std::ofstream log(index_dir_ / "shard-0.log", std::ios::binary | std::ios::app);
+        log.write("\x01\xff\xff", 3);
+    }
+
+    auto index = metadata_index::open(index_dir_, 1);
+    ASSERT_TRUE(index.has_value());
+    EXPECT_TRUE(index.value().needs_rebuild());
+    EXPECT_TRUE(index.value().find("kept").has_value());
+}
+
+TEST_F(MetadataIndexTest, Rebuild_ScansFilesAndKeepsAttributes) {
+    create_test_file("top.bin", 10);
+    create_test_file("nested/deep/file.bin", 20);
+    create_test_file(".file_trans_quota/usage.idx", 5);
+
+    auto index = metadata_index::open(index_dir_);
+    ASSERT_TRUE(index.has_value());
+    auto& idx = index.value();
+
+    auto stale = make_entry("top.bin", 999);
+    stale.tier = storage_tier::archive;
+    ASSERT_TRUE(idx.put(stale).has_value());
+    ASSERT_TRUE(idx.put(make_entry("gone.bin", 1)).has_value());
+
+    auto rebuilt = idx.rebuild(test_dir_);
+    ASSERT_TRUE(rebuilt.has_value());
+    EXPECT_EQ(rebuilt.value(), 2);
+    EXPECT_FALSE(idx.needs_rebuild());
+
+    auto top = idx.find("top.bin");
+    ASSERT_TRUE(top.has_value());
+    EXPECT_EQ(top->size, 10);
+    EXPECT_EQ(top->tier, storage_tier::archive);
+    EXPECT_EQ(idx.find("nested/deep/file.bin")->size, 20);
+    EXPECT_FALSE(idx.find("gone.bin").has_value());
+    EXPECT_FALSE(idx.find(".file_trans_quota/usage.idx").has_value());
+}
+
+TEST_F(MetadataIndexTest, Compact_PreservesEntries) {
+    {
+        auto index = metadata_index::open(index_dir_, 2);
+        ASSERT_TRUE(index.has_value());
+        auto& idx = index.value();
+        for (int i = 0; i < 100; ++i) {
+            ASSERT_TRUE(idx.put(make_entry("k" + std::to_string(i % 10),
+                                           static_cast<uint64_t>(i))).has_value());
+        }
+        ASSERT_TRUE(idx.compact().has_value());
+    }
+
+    auto index = metadata_index::open(index_dir_, 2);
+    ASSERT_TRUE(index.has_value());
+    EXPECT_EQ(index.value().size(), 10);
+    EXPECT_EQ(index.value().find("k3")->size, 93);
+}
+
+}  // namespace kcenon::file_transfer::test
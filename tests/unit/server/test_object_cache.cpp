@@ -0,0 +1,272 @@
+/**
+ * @file test_object_cache.cpp
+ * @brief Unit tests for the disk-backed object read cache
+ */
+
+#include <gtest/gtest.h>
+
+#include <kcenon/file_transfer/server/object_cache.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace kcenon::file_transfer::test {
+
+class ObjectCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        cache_dir_ = std::filesystem::temp_directory_path() / "object_cache_test";
+        std::filesystem::remove_all(cache_dir_);
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(cache_dir_, ec);
+    }
+
+    auto open_cache(uint64_t max_bytes) -> object_cache {
+        auto cache = object_cache::open({cache_dir_, max_bytes});
+        EXPECT_TRUE(cache.has_value());
+        return std::move(cache.value());
+    }
+
+    // Fetch that writes `size` copies of `fill` and counts calls
+    auto writer(std::size_t size, char fill = 'x') -> object_cache::fetch_function {
+        return [this, size, fill](const std::filesystem::path& target) -> result<void> {
+            ++fetches_;
+            std::ofstream out(target, std::ios::binary);
+            std::string data(size, fill);
+            out.write(data.data(), static_cast<std::streamsize>(data.size()));
+            return result<void>();
+        };
+    }
+
+    static auto read_file(const std::filesystem::path& path) -> std::string {
+        std::ifstream in(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(in)),
+                           std::istreambuf_iterator<char>());
+    }
+
+    auto data_file_count() const -> std::size_t {
+        std::size_t count = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(cache_dir_)) {
+            if (entry.path().extension() == ".dat") {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    std::filesystem::path cache_dir_;
+    std::atomic<int> fetches_{0};
+};
+
+TEST_F(ObjectCacheTest, MissThenHit) {
+    auto cache = open_cache(1024);
+
+    {
+        auto first = cache.acquire("a", "v1", writer(100));
+        ASSERT_TRUE(first.has_value());
+        EXPECT_FALSE(first.value().hit());
+        EXPECT_EQ(first.value().size(), 100);
+        EXPECT_EQ(read_file(first.value().path()), std::string(100, 'x'));
+    }
+
+    auto second = cache.acquire("a", "v1", writer(100));
+    ASSERT_TRUE(second.has_value());
+    EXPECT_TRUE(second.value().hit());
+    EXPECT_EQ(fetches_.load(), 1);
+
+    auto stats = cache.statistics();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.entry_count, 1);
+    EXPECT_EQ(stats.current_bytes, 100);
+}
+
+TEST_F(ObjectCacheTest, VersionChangeRefetches) {
+    auto cache = open_cache(1024);
+
+    { auto h = cache.acquire("a", "v1", writer(10, '1')); }
+    auto h = cache.acquire("a", "v2", writer(20, '2'));
+    ASSERT_TRUE(h.has_value());
+    EXPECT_FALSE(h.value().hit());
+    EXPECT_EQ(read_file(h.value().path()), std::string(20, '2'));
+
+    auto stats = cache.statistics();
+    EXPECT_EQ(stats.stale, 1);
+    EXPECT_EQ(stats.entry_count, 1);
+    EXPECT_EQ(stats.current_bytes, 20);
+    EXPECT_TRUE(cache.contains("a", "v2"));
+    EXPECT_FALSE(cache.contains("a", "v1"));
+    EXPECT_EQ(data_file_count(), 1);
+}
+
+TEST_F(ObjectCacheTest, EvictsLeastRecentlyUsed) {
+    auto cache = open_cache(300);
+
+    { auto h = cache.acquire("a", "v", writer(100)); }
+    { auto h = cache.acquire("b", "v", writer(100)); }
+    { auto h = cache.acquire("c", "v", writer(100)); }
+    { auto h = cache.acquire("a", "v", writer(100)); }  // a is now most recent
+    { auto h = cache.acquire("d", "v", writer(100)); }  // evicts b
+
+    EXPECT_TRUE(cache.contains("a", "v"));
+    EXPECT_FALSE(cache.contains("b", "v"));
+    EXPECT_TRUE(cache.contains("c", "v"));
+    EXPECT_TRUE(cache.contains("d", "v"));
+
+    auto stats = cache.statistics();
+    EXPECT_EQ(stats.evictions, 1);
+    EXPECT_EQ(stats.bytes_evicted, 100);
+    EXPECT_LE(stats.current_bytes, 300);
+    EXPECT_EQ(data_file_count(), 3);
+}
+
+TEST_F(ObjectCacheTest, PinnedEntryIsNotEvicted) {
+    auto cache = open_cache(200);
+
+    auto held = cache.acquire("a", "v", writer(100, 'a'));
+    ASSERT_TRUE(held.has_value());
+    { auto h = cache.acquire("b", "v", writer(100)); }
+    { auto h = cache.acquire("c", "v", writer(100)); }
+
+    EXPECT_TRUE(cache.contains("a", "v"));
+    EXPECT_FALSE(cache.contains("b", "v"));
+    EXPECT_EQ(read_file(held.value().path()), std::string(100, 'a'));
+}
+
+TEST_F(ObjectCacheTest, InvalidatedEntryStaysReadableWhilePinned) {
+    auto cache = open_cache(1024);
+
+    auto held = cache.acquire("a", "v", writer(50, 'a'));
+    ASSERT_TRUE(held.has_value());
+    auto path = held.value().path();
+
+    cache.invalidate("a");
+    EXPECT_FALSE(cache.contains("a", "v"));
+    EXPECT_EQ(cache.statistics().entry_count, 0);
+    EXPECT_EQ(read_file(path), std::string(50, 'a'));
+
+    held = object_cache::handle{};
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST_F(ObjectCacheTest, OversizedObjectIsServedButNotKept) {
+    auto cache = open_cache(100);
+
+    std::filesystem::path path;
+    {
+        auto h = cache.acquire("big", "v", writer(500));
+        ASSERT_TRUE(h.has_value());
+        path = h.value().path();
+        EXPECT_EQ(read_file(path).size(), 500);
+    }
+    EXPECT_FALSE(std::filesystem::exists(path));
+    EXPECT_FALSE(cache.contains("big", "v"));
+    EXPECT_EQ(cache.statistics().current_bytes, 0);
+}
+
+TEST_F(ObjectCacheTest, FetchErrorIsReturnedAndNotCached) {
+    auto cache = open_cache(1024);
+
+    auto failed = cache.acquire("a", "v", [](const std::filesystem::path&) -> result<void> {
+        return unexpected{error{error_code::connection_failed, "down"}};
+    });
+    ASSERT_FALSE(failed.has_value());
+    EXPECT_EQ(failed.error().code, error_code::connection_failed);
+    EXPECT_EQ(cache.statistics().fill_errors, 1);
+
+    auto retried = cache.acquire("a", "v", writer(10));
+    ASSERT_TRUE(retried.has_value());
+    EXPECT_FALSE(retried.value().hit());
+}
+
+TEST_F(ObjectCacheTest, ConcurrentMissesFetchOnce) {
+    auto cache = open_cache(1024 * 1024);
+
+    auto slow = [this](const std::filesystem::path& target) -> result<void> {
+        ++fetches_;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        std::ofstream out(target, std::ios::binary);
+        out << "payload";
+        return result<void>();
+    };
+
+    std::atomic<int> ok{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&] {
+            auto h = cache.acquire("hot", "v", slow);
+            if (h.has_value() && read_file(h.value().path()) == "payload") {
+                ++ok;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_EQ(ok.load(), 8);
+    EXPECT_EQ(fetches_.load(), 1);
+    auto stats = cache.statistics();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.hits, 7);
+    EXPECT_LE(stats.coalesced, 7);
+}
+
+TEST_F(ObjectCacheTest, RestoresIndexOnReopen) {
+    {
+        auto cache = open_cache(1024);
+        { auto h = cache.acquire("a", "v1", writer(100, 'a')); }
+        { auto h = cache.acquire("b", "v1", writer(100, 'b')); }
+    }
+
+    // Leftovers of an interrupted fill are removed on open
+    std::ofstream(cache_dir_ / "99.part") << "partial";
+
+    auto cache = open_cache(1024);
+    auto stats = cache.statistics();
+    EXPECT_EQ(stats.entry_count, 2);
+    EXPECT_EQ(stats.current_bytes, 200);
+    EXPECT_FALSE(std::filesystem::exists(cache_dir_ / "99.part"));
+
+    auto h = cache.acquire("a", "v1", writer(100));
+    ASSERT_TRUE(h.has_value());
+    EXPECT_TRUE(h.value().hit());
+    EXPECT_EQ(read_file(h.value().path()), std::string(100, 'a'));
+    EXPECT_EQ(fetches_.load(), 2);
+}
+
+TEST_F(ObjectCacheTest, ReopenWithSmallerCapacityEvicts) {
+    {
+        auto cache = open_cache(1024);
+        { auto h = cache.acquire("a", "v", writer(100)); }
+        { auto h = cache.acquire("b", "v", writer(100)); }
+        { auto h = cache.acquire("c", "v", writer(100)); }
+    }
+
+    auto cache = open_cache(150);
+    EXPECT_EQ(cache.statistics().entry_count, 1);
+    EXPECT_LE(cache.statistics().current_bytes, 150);
+    EXPECT_EQ(data_file_count(), 1);
+}
+
+TEST_F(ObjectCacheTest, ForeignFilesAreLeftAlone) {
+    std::filesystem::create_directories(cache_dir_);
+    std::ofstream(cache_dir_ / "notes.txt") << "keep";
+
+    auto cache = open_cache(1024);
+    { auto h = cache.acquire("a", "v", writer(10)); }
+    cache.clear();
+
+    EXPECT_EQ(cache.statistics().entry_count, 0);
+    EXPECT_EQ(data_file_count(), 0);
+    EXPECT_TRUE(std::filesystem::exists(cache_dir_ / "notes.txt"));
+}
+
+}  // namespace kcenon::file_transfer::test
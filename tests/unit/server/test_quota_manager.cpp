@@ -455,6 +455,208 @@ TEST_F(QuotaManagerTest, ExecuteCleanup_RespectsExclusions) {
     EXPECT_TRUE(std::filesystem::exists(test_dir_ / "important.txt"));
 }
 
+// Usage index tests
+
+TEST_F(QuotaManagerTest, RecordFileStored_UpdatesUsage) {
+    auto result = quota_manager::create(test_dir_, 100 * KB);
+    ASSERT_TRUE(result.has_value());
+    auto& manager = result.value();
+
+    create_test_file("stored.bin", 40 * KB);
+    manager.record_file_stored(test_dir_ / "stored.bin", 40 * KB);
+
+    auto usage = manager.get_usage();
+    EXPECT_EQ(usage.used_bytes, 40 * KB);
+    EXPECT_EQ(usage.file_count, 1);
+
+    // Re-storing the same name replaces the previous entry
+    create_test_file("stored.bin", 10 * KB);
+    manager.record_file_stored(test_dir_ / "stored.bin", 10 * KB);
+    usage = manager.get_usage();
+    EXPECT_EQ(usage.used_bytes, 10 * KB);
+    EXPECT_EQ(usage.file_count, 1);
+
+    std::filesystem::remove(test_dir_ / "stored.bin");
+    manager.record_file_deleted(test_dir_ / "stored.bin");
+    usage = manager.get_usage();
+    EXPECT_EQ(usage.used_bytes, 0);
+    EXPECT_EQ(usage.file_count, 0);
+}
+
+TEST_F(QuotaManagerTest, RefreshUsage_DetectsExternalChanges) {
+    auto result = quota_manager::create(test_dir_, 100 * KB);
+    ASSERT_TRUE(result.has_value());
+    auto& manager = result.value();
+
+    // Ensure the directory timestamp changes on coarse-grained filesystems
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    create_test_file("external.bin", 25 * KB);
+    manager.refresh_usage();
+
+    auto usage = manager.get_usage();
+    EXPECT_EQ(usage.used_bytes, 25 * KB);
+    EXPECT_EQ(usage.file_count, 1);
+}
+
+TEST_F(QuotaManagerTest, IndexSnapshot_ReloadedOnCreate) {
+    create_test_file("a.bin", 10 * KB);
+    create_test_file("b.bin", 20 * KB);
+
+    {
+        auto result = quota_manager::create(test_dir_, 100 * KB);
+        ASSERT_TRUE(result.has_value());
+        EXPECT_TRUE(result.value().save_index_snapshot().has_value());
+    }
+
+    auto result = quota_manager::create(test_dir_, 100 * KB);
+    ASSERT_TRUE(result.has_value());
+    auto usage = result.value().get_usage();
+    EXPECT_EQ(usage.used_bytes, 30 * KB);
+    EXPECT_EQ(usage.file_count, 2);
+}
+
+TEST_F(QuotaManagerTest, ExecuteCleanup_UsesRecordedFiles) {
+    auto result = quota_manager::create(test_dir_, 100 * KB);
+    ASSERT_TRUE(result.has_value());
+    auto& manager = result.value();
+
+    create_test_file("first.bin", 45 * KB);
+    manager.record_file_stored(test_dir_ / "first.bin", 45 * KB);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    create_test_file("second.bin", 45 * KB);
+    manager.record_file_stored(test_dir_ / "second.bin", 45 * KB);
+
+    cleanup_policy policy;
+    policy.enabled = true;
+    policy.trigger_threshold = 80.0;
+    policy.target_threshold = 50.0;
+    manager.set_cleanup_policy(policy);
+
+    EXPECT_EQ(manager.execute_cleanup(), 45 * KB);
+    EXPECT_FALSE(std::filesystem::exists(test_dir_ / "first.bin"));
+    EXPECT_TRUE(std::filesystem::exists(test_dir_ / "second.bin"));
+    EXPECT_EQ(manager.get_usage().file_count, 1);
+}
+
+TEST_F(QuotaManagerTest, ExecuteCleanup_NothingToFreeDeletesNothing) {
+    create_test_file("keep.bin", 60 * KB);
+
+    auto result = quota_manager::create(test_dir_, 100 * KB);
+    ASSERT_TRUE(result.has_value());
+    auto& manager = result.value();
+
+    // Triggered at 50%, but usage (60%) is already below the 70% target
+    cleanup_policy policy;
+    policy.enabled = true;
+    policy.trigger_threshold = 50.0;
+    policy.target_threshold = 70.0;
+    manager.set_cleanup_policy(policy);
+
+    EXPECT_EQ(manager.execute_cleanup(), 0);
+    EXPECT_TRUE(std::filesystem::exists(test_dir_ / "keep.bin"));
+    EXPECT_EQ(manager.get_usage().file_count, 1);
+}
+
+TEST_F(QuotaManagerTest, RebuildIndex_SkipsAssemblerTempFiles) {
+    create_test_file("stored.bin", 10 * KB);
+    create_test_file(".tmp_0123456789abcdef", 30 * KB);
+
+    auto result = quota_manager::create(test_dir_, 100 * KB);
+    ASSERT_TRUE(result.has_value());
+    auto& manager = result.value();
+
+    manager.rebuild_index();
+    auto usage = manager.get_usage();
+    EXPECT_EQ(usage.used_bytes, 10 * KB);
+    EXPECT_EQ(usage.file_count, 1);
+}
+
+// Reservation tests
+
+TEST_F(QuotaManagerTest, Reserve_CountsAgainstQuota) {
+    auto result = quota_manager::create(test_dir_, 100 * KB);
+    ASSERT_TRUE(result.has_value());
+    auto& manager = result.value();
+
+    auto first = manager.reserve(60 * KB);
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(manager.get_reserved_bytes(), 60 * KB);
+    EXPECT_EQ(manager.get_usage().reserved_bytes, 60 * KB);
+
+    auto second = manager.reserve(50 * KB);
+    EXPECT_FALSE(second.has_value());
+    EXPECT_EQ(second.error().code, error_code::quota_exceeded);
+    EXPECT_FALSE(manager.check_quota(50 * KB).has_value());
+}
+
+TEST_F(QuotaManagerTest, ReleaseReservation_FreesSpace) {
+    auto result = quota_manager::create(test_dir_, 100 * KB);
+    ASSERT_TRUE(result.has_value());
+    auto& manager = result.value();
+
+    auto reservation = manager.reserve(80 * KB, 7);
+    ASSERT_TRUE(reservation.has_value());
+    EXPECT_EQ(manager.get_reserved_bytes(7), 80 * KB);
+
+    manager.release_reservation(reservation.value());
+    EXPECT_EQ(manager.get_reserved_bytes(), 0);
+    EXPECT_EQ(manager.get_reserved_bytes(7), 0);
+    EXPECT_TRUE(manager.reserve(80 * KB).has_value());
+}
+
+TEST_F(QuotaManagerTest, CommitReservation_MovesBytesToUsed) {
+    auto result = quota_manager::create(test_dir_, 100 * KB);
+    ASSERT_TRUE(result.has_value());
+    auto& manager = result.value();
+
+    auto reservation = manager.reserve(40 * KB);
+    ASSERT_TRUE(reservation.has_value());
+
+    create_test_file("committed.bin", 30 * KB);
+    manager.commit_reservation(reservation.value(), test_dir_ / "committed.bin", 30 * KB);
+
+    auto usage = manager.get_usage();
+    EXPECT_EQ(usage.used_bytes, 30 * KB);
+    EXPECT_EQ(usage.reserved_bytes, 0);
+    EXPECT_EQ(usage.file_count, 1);
+}
+
+TEST_F(QuotaManagerTest, TenantReservationLimit_IsEnforced) {
+    auto result = quota_manager::create(test_dir_, 100 * KB);
+    ASSERT_TRUE(result.has_value());
+    auto& manager = result.value();
+    manager.set_tenant_reservation_limit(30 * KB);
+
+    EXPECT_TRUE(manager.reserve(20 * KB, 1).has_value());
+    EXPECT_FALSE(manager.reserve(20 * KB, 1).has_value());
+    EXPECT_TRUE(manager.reserve(20 * KB, 2).has_value());
+    EXPECT_EQ(manager.get_reserved_bytes(), 40 * KB);
+}
+
+TEST_F(QuotaManagerTest, ThreadSafety_ConcurrentReservationsNeverOvershoot) {
+    auto result = quota_manager::create(test_dir_, 100 * KB);
+    ASSERT_TRUE(result.has_value());
+    auto& manager = result.value();
+
+    std::atomic<int> granted{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 16; ++i) {
+        threads.emplace_back([&manager, &granted, i]() {
+            for (int j = 0; j < 10; ++j) {
+                if (manager.reserve(1 * KB, static_cast<uint64_t>(i)).has_value()) {
+                    granted++;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(granted.load(), 100);
+    EXPECT_EQ(manager.get_reserved_bytes(), 100 * KB);
+}
+
 // quota_usage struct tests
 
 TEST_F(QuotaManagerTest, QuotaUsage_IsExceeded_TrueWhenOver) {
@@ -0,0 +1,278 @@
+/**
+ * @file test_replication_queue.cpp
+ * @brief Unit tests for the write-behind replication queue
+ */
+
+#include <gtest/gtest.h>
+
+#include <kcenon/file_transfer/server/replication_queue.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace kcenon::file_transfer::test {
+
+class ReplicationQueueTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        journal_dir_ = std::filesystem::temp_directory_path() / "replication_queue_test";
+        std::filesystem::remove_all(journal_dir_);
+
+        config_.journal_directory = journal_dir_;
+        config_.initial_retry_delay = std::chrono::milliseconds(1);
+        config_.max_retry_delay = std::chrono::milliseconds(5);
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(journal_dir_, ec);
+    }
+
+    // Records every applied request
+    auto recorder() -> replication_queue::replicate_function {
+        return [this](const replication_request& request) -> result<void> {
+            std::lock_guard lock(mutex_);
+            applied_.push_back(request);
+            return result<void>();
+        };
+    }
+
+    auto applied() -> std::vector<replication_request> {
+        std::lock_guard lock(mutex_);
+        return applied_;
+    }
+
+    static auto put(const std::string& key) -> replication_request {
+        return replication_request{key, replication_op::put, {}, {}};
+    }
+
+    std::filesystem::path journal_dir_;
+    replication_queue_config config_;
+    std::mutex mutex_;
+    std::vector<replication_request> applied_;
+};
+
+TEST_F(ReplicationQueueTest, ReplicatesEnqueuedRequests) {
+    auto queue = replication_queue::open(config_, recorder());
+    ASSERT_TRUE(queue.has_value());
+
+    replication_request request = put("a.bin");
+    request.storage_class = "STANDARD_IA";
+    ASSERT_TRUE(queue.value().enqueue(request).has_value());
+    ASSERT_TRUE(queue.value().enqueue({"b.bin", replication_op::remove, {}, {}}).has_value());
+    ASSERT_TRUE(queue.value().drain(std::chrono::seconds(5)));
+
+    auto done = applied();
+    ASSERT_EQ(done.size(), 2);
+    std::map<std::string, replication_request> by_key;
+    for (const auto& r : done) by_key[r.key] = r;
+    EXPECT_EQ(by_key["a.bin"].op, replication_op::put);
+    EXPECT_EQ(by_key["a.bin"].storage_class, "STANDARD_IA");
+    EXPECT_EQ(by_key["b.bin"].op, replication_op::remove);
+
+    auto stats = queue.value().statistics();
+    EXPECT_EQ(stats.replicated, 2);
+    EXPECT_EQ(stats.pending, 0);
+    EXPECT_FALSE(queue.value().pending("a.bin").has_value());
+}
+
+TEST_F(ReplicationQueueTest, PendingUntilReplicated) {
+    std::atomic<bool> release{false};
+    auto queue = replication_queue::open(config_, [&](const replication_request&) -> result<void> {
+        while (!release.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return result<void>();
+    });
+    ASSERT_TRUE(queue.has_value());
+
+    ASSERT_TRUE(queue.value().enqueue({"gone.bin", replication_op::remove, {}, {}}).has_value());
+    EXPECT_EQ(queue.value().pending("gone.bin"), replication_op::remove);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_GE(queue.value().statistics().lag.count(), 10);
+
+    release = true;
+    ASSERT_TRUE(queue.value().drain(std::chrono::seconds(5)));
+    EXPECT_FALSE(queue.value().pending("gone.bin").has_value());
+    EXPECT_EQ(queue.value().statistics().lag.count(), 0);
+}
+
+TEST_F(ReplicationQueueTest, CoalescesRequestsForSameKey) {
+    config_.max_concurrency = 1;
+    std::atomic<bool> release{false};
+    auto queue = replication_queue::open(config_, [&](const replication_request& request) {
+        while (request.key == "blocker" && !release.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::lock_guard lock(mutex_);
+        applied_.push_back(request);
+        return result<void>();
+    });
+    ASSERT_TRUE(queue.has_value());
+
+    // Occupy the single worker so the next requests stay queued
+    ASSERT_TRUE(queue.value().enqueue(put("blocker")).has_value());
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(queue.value().enqueue(put("hot.bin")).has_value());
+    }
+    ASSERT_TRUE(queue.value().enqueue({"hot.bin", replication_op::remove, {}, {}}).has_value());
+
+    release = true;
+    ASSERT_TRUE(queue.value().drain(std::chrono::seconds(5)));
+
+    auto done = applied();
+    ASSERT_EQ(done.size(), 2);
+    EXPECT_EQ(done[1].key, "hot.bin");
+    EXPECT_EQ(done[1].op, replication_op::remove);
+    EXPECT_EQ(queue.value().statistics().coalesced, 5);
+}
+
+TEST_F(ReplicationQueueTest, ReenqueueDuringReplicationReplicatesAgain) {
+    std::atomic<int> calls{0};
+    std::atomic<bool> release{false};
+    auto queue = replication_queue::open(config_, [&](const replication_request&) -> result<void> {
+        if (++calls == 1) {
+            while (!release.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        return result<void>();
+    });
+    ASSERT_TRUE(queue.has_value());
+
+    ASSERT_TRUE(queue.value().enqueue(put("a.bin")).has_value());
+    while (queue.value().statistics().in_flight == 0) {
+        std::this_thread::yield();
+    }
+    ASSERT_TRUE(queue.value().enqueue(put("a.bin")).has_value());
+    release = true;
+
+    ASSERT_TRUE(queue.value().drain(std::chrono::seconds(5)));
+    EXPECT_EQ(calls.load(), 2);
+}
+
+TEST_F(ReplicationQueueTest, RetriesFailedRequests) {
+    std::atomic<int> calls{0};
+    auto queue = replication_queue::open(config_, [&](const replication_request&) -> result<void> {
+        if (++calls < 3) {
+            return unexpected{error{error_code::connection_failed, "offline"}};
+        }
+        return result<void>();
+    });
+    ASSERT_TRUE(queue.has_value());
+
+    ASSERT_TRUE(queue.value().enqueue(put("a.bin")).has_value());
+    ASSERT_TRUE(queue.value().drain(std::chrono::seconds(5)));
+
+    EXPECT_EQ(calls.load(), 3);
+    auto stats = queue.value().statistics();
+    EXPECT_EQ(stats.retries, 2);
+    EXPECT_EQ(stats.replicated, 1);
+    EXPECT_EQ(stats.failed, 0);
+}
+
+TEST_F(ReplicationQueueTest, DropsRequestAfterMaxAttempts) {
+    config_.max_attempts = 3;
+    std::atomic<int> calls{0};
+    std::vector<std::string> failed;
+    auto queue = replication_queue::open(
+        config_,
+        [&](const replication_request&) -> result<void> {
+            ++calls;
+            return unexpected{error{error_code::file_access_denied, "denied"}};
+        },
+        [&](const replication_request& request, const error& err) {
+            std::lock_guard lock(mutex_);
+            failed.push_back(request.key);
+            EXPECT_EQ(err.code, error_code::file_access_denied);
+        });
+    ASSERT_TRUE(queue.has_value());
+
+    ASSERT_TRUE(queue.value().enqueue(put("bad.bin")).has_value());
+    ASSERT_TRUE(queue.value().drain(std::chrono::seconds(5)));
+
+    EXPECT_EQ(calls.load(), 3);
+    EXPECT_EQ(queue.value().statistics().failed, 1);
+    std::lock_guard lock(mutex_);
+    EXPECT_EQ(failed, std::vector<std::string>{"bad.bin"});
+}
+
+TEST_F(ReplicationQueueTest, ConcurrencyIsBounded) {
+    config_.max_concurrency = 2;
+    config_.batch_size = 1;
+    std::atomic<int> running{0};
+    std::atomic<int> peak{0};
+    auto queue = replication_queue::open(config_, [&](const replication_request&) -> result<void> {
+        int now = ++running;
+        int expected = peak.load();
+        while (now > expected && !peak.compare_exchange_weak(expected, now)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        --running;
+        return result<void>();
+    });
+    ASSERT_TRUE(queue.has_value());
+
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_TRUE(queue.value().enqueue(put("k" + std::to_string(i))).has_value());
+    }
+    ASSERT_TRUE(queue.value().drain(std::chrono::seconds(5)));
+    EXPECT_LE(peak.load(), 2);
+    EXPECT_EQ(queue.value().statistics().replicated, 20);
+}
+
+TEST_F(ReplicationQueueTest, PendingRequestsSurviveRestart) {
+    {
+        // A replica that is down: nothing completes before close()
+        auto queue = replication_queue::open(config_, [](const replication_request&) -> result<void> {
+            return unexpected{error{error_code::connection_failed, "offline"}};
+        });
+        ASSERT_TRUE(queue.has_value());
+        ASSERT_TRUE(queue.value().enqueue(put("a.bin")).has_value());
+        ASSERT_TRUE(queue.value().enqueue({"b.bin", replication_op::remove, {}, {}}).has_value());
+        queue.value().close();
+    }
+
+    auto queue = replication_queue::open(config_, recorder());
+    ASSERT_TRUE(queue.has_value());
+    ASSERT_TRUE(queue.value().drain(std::chrono::seconds(5)));
+
+    auto done = applied();
+    ASSERT_EQ(done.size(), 2);
+    std::map<std::string, replication_op> ops;
+    for (const auto& r : done) ops[r.key] = r.op;
+    EXPECT_EQ(ops["a.bin"], replication_op::put);
+    EXPECT_EQ(ops["b.bin"], replication_op::remove);
+}
+
+TEST_F(ReplicationQueueTest, CompletedRequestsAreNotReplayed) {
+    {
+        auto queue = replication_queue::open(config_, recorder());
+        ASSERT_TRUE(queue.has_value());
+        ASSERT_TRUE(queue.value().enqueue(put("a.bin")).has_value());
+        ASSERT_TRUE(queue.value().drain(std::chrono::seconds(5)));
+    }
+    applied_.clear();
+
+    auto queue = replication_queue::open(config_, recorder());
+    ASSERT_TRUE(queue.has_value());
+    EXPECT_EQ(queue.value().statistics().pending, 0);
+    EXPECT_TRUE(applied().empty());
+}
+
+TEST_F(ReplicationQueueTest, EnqueueAfterCloseFails) {
+    auto queue = replication_queue::open(config_, recorder());
+    ASSERT_TRUE(queue.has_value());
+    queue.value().close();
+    EXPECT_FALSE(queue.value().enqueue(put("a.bin")).has_value());
+}
+
+}  // namespace kcenon::file_transfer::test
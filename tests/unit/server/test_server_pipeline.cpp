@@ -5,15 +5,22 @@
 
 #include "kcenon/file_transfer/server/server_pipeline.h"
 #include "kcenon/file_transfer/core/checksum.h"
+#include "kcenon/file_transfer/core/chunk_assembler.h"
 #include "kcenon/file_transfer/core/compression_engine.h"
+#include "kcenon/file_transfer/core/stream_compression.h"
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
 #include <random>
+#include <set>
 #include <thread>
 
 namespace kcenon::file_transfer {
@@ -61,6 +68,35 @@ protected:
         return chunk;
     }
 
+    /**
+     * @brief Holds upload callbacks until opened
+     *
+     * Opens on destruction as well, so a failed ASSERT that returns early
+     * never leaves stop() waiting on a blocked worker.
+     */
+    class write_gate {
+    public:
+        ~write_gate() { open(); }
+
+        void wait() {
+            std::unique_lock lock(mutex_);
+            cv_.wait(lock, [this] { return open_; });
+        }
+
+        void open() {
+            {
+                std::lock_guard lock(mutex_);
+                open_ = true;
+            }
+            cv_.notify_all();
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool open_ = false;
+    };
+
     std::filesystem::path test_dir_;
 };
 
@@ -286,6 +322,53 @@ TEST_F(ServerPipelineTest, DownloadChunkProcessing) {
     (void)pipeline.stop();
 }
 
+TEST_F(ServerPipelineTest, DownloadChunkUsesRequestedIntegrity) {
+    pipeline_config config;
+    config.io_workers = 1;
+    config.compression_workers = 1;
+    config.network_workers = 1;
+    config.queue_size = 16;
+
+    auto pipeline_result = server_pipeline::create(config);
+    ASSERT_TRUE(pipeline_result.has_value());
+    auto& pipeline = pipeline_result.value();
+
+    auto file_path = create_test_file("download_crc32c.bin", 4096);
+
+    std::mutex mutex;
+    std::vector<pipeline_chunk> ready;
+    pipeline.on_download_ready([&](const pipeline_chunk& c) {
+        std::lock_guard lock(mutex);
+        ready.push_back(c);
+    });
+
+    ASSERT_TRUE(pipeline.start().has_value());
+
+    auto id = transfer_id::generate();
+    ASSERT_TRUE(pipeline.submit_download_request(id, 0, file_path, 0, 4096, client_id{},
+                                                 chunk_integrity::crc32c).has_value());
+    for (int i = 0; i < 100; ++i) {
+        {
+            std::lock_guard lock(mutex);
+            if (!ready.empty()) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    (void)pipeline.stop();
+
+    std::lock_guard lock(mutex);
+    ASSERT_EQ(ready.size(), 1);
+    EXPECT_EQ(ready[0].integrity, chunk_integrity::crc32c);
+
+    // The checksum covers the file bytes, whether or not they were compressed
+    std::ifstream file(file_path, std::ios::binary);
+    std::vector<std::byte> original(4096);
+    file.read(reinterpret_cast<char*>(original.data()), 4096);
+    EXPECT_EQ(ready[0].checksum, checksum::crc32c(original));
+}
+
 // Statistics tests
 
 TEST_F(ServerPipelineTest, StatsInitialState) {
@@ -405,9 +488,7 @@ TEST_F(ServerPipelineTest, StageCompleteCallback) {
 
 // Backpressure tests
 
-// TODO: Re-enable once backpressure is implemented with thread_pool
-// thread_pool uses unbounded queue, so bounded_job_queue backpressure doesn't apply
-TEST_F(ServerPipelineTest, DISABLED_BackpressureWithSmallQueue) {
+TEST_F(ServerPipelineTest, BackpressureWithSmallQueue) {
     pipeline_config config;
     config.io_workers = 1;
     config.compression_workers = 1;
@@ -459,6 +540,507 @@ TEST_F(ServerPipelineTest, DISABLED_BackpressureWithSmallQueue) {
     (void)pipeline.stop();
 }
 
+TEST_F(ServerPipelineTest, UploadWindowBoundsInFlightChunks) {
+    pipeline_config config;
+    config.io_workers = 1;
+    config.compression_workers = 1;
+    config.network_workers = 1;
+    config.queue_size = 4;
+
+    auto pipeline_result = server_pipeline::create(config);
+    ASSERT_TRUE(pipeline_result.has_value());
+    auto& pipeline = pipeline_result.value();
+
+    // Hold chunks in the write stage so the window fills up
+    std::mutex gate_mutex;
+    std::condition_variable gate_cv;
+    bool open = false;
+    pipeline.on_upload_complete([&](const transfer_id&, uint64_t) {
+        std::unique_lock lock(gate_mutex);
+        gate_cv.wait(lock, [&] { return open; });
+    });
+
+    ASSERT_TRUE(pipeline.start().has_value());
+
+    auto id = transfer_id::generate();
+    std::vector<std::byte> data(100, std::byte{0x42});
+    std::size_t admitted = 0;
+    for (uint64_t i = 0; i < 8; ++i) {
+        if (pipeline.submit_upload_chunk(create_pipeline_chunk(id, i, data)).has_value()) {
+            ++admitted;
+        }
+    }
+    EXPECT_EQ(admitted, config.queue_size);
+    EXPECT_LE(pipeline.upload_in_flight(), config.queue_size);
+
+    auto timed_out = pipeline.submit_upload_chunk(
+        create_pipeline_chunk(id, 8, data), std::chrono::milliseconds(50));
+    EXPECT_FALSE(timed_out.has_value());
+    if (!timed_out.has_value()) {
+        EXPECT_EQ(timed_out.error().code, error_code::queue_full);
+    }
+
+    // A waiting submitter proceeds once the write stage drains
+    std::thread releaser([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        {
+            std::lock_guard lock(gate_mutex);
+            open = true;
+        }
+        gate_cv.notify_all();
+    });
+    auto waited = pipeline.submit_upload_chunk(
+        create_pipeline_chunk(id, 9, data), std::chrono::seconds(5));
+    releaser.join();
+    EXPECT_TRUE(waited.has_value());
+
+    (void)pipeline.stop();
+}
+
+TEST_F(ServerPipelineTest, UploadWindowBoundsInFlightBytes) {
+    pipeline_config config;
+    config.io_workers = 1;
+    config.compression_workers = 1;
+    config.network_workers = 1;
+    config.queue_size = 64;
+    config.max_memory_per_transfer = 4096;
+
+    auto pipeline_result = server_pipeline::create(config);
+    ASSERT_TRUE(pipeline_result.has_value());
+    auto& pipeline = pipeline_result.value();
+
+    // Declared after the pipeline so it opens before the pipeline is torn down
+    write_gate gate;
+    pipeline.on_upload_complete([&](const transfer_id&, uint64_t) { gate.wait(); });
+
+    ASSERT_TRUE(pipeline.start().has_value());
+
+    // Four 1 KiB chunks fill the budget long before the chunk count does
+    auto id = transfer_id::generate();
+    std::vector<std::byte> data(1024, std::byte{0x42});
+    for (uint64_t i = 0; i < 4; ++i) {
+        EXPECT_TRUE(pipeline.try_submit_upload_chunk(create_pipeline_chunk(id, i, data)));
+    }
+    EXPECT_FALSE(pipeline.try_submit_upload_chunk(create_pipeline_chunk(id, 4, data)));
+
+#ifdef FILE_TRANS_ENABLE_LZ4
+    // A compressed chunk counts at its decompressed size
+    auto other = transfer_id::generate();
+    std::vector<std::byte> original(3584, std::byte{0x42});
+    compression_engine engine;
+    auto packed = engine.compress(original);
+    ASSERT_TRUE(packed.has_value());
+    ASSERT_LT(packed.value().size(), data.size());
+    auto compressed = create_pipeline_chunk(other, 0, packed.value(), true);
+    compressed.checksum = checksum::crc32(std::span<const std::byte>(original));
+    compressed.original_size = original.size();
+    EXPECT_TRUE(pipeline.try_submit_upload_chunk(std::move(compressed)));
+    EXPECT_FALSE(pipeline.try_submit_upload_chunk(create_pipeline_chunk(other, 1, data)));
+#endif
+
+    // A flow with nothing in flight takes one chunk larger than the budget
+    auto large = transfer_id::generate();
+    std::vector<std::byte> large_data(8192, std::byte{0x17});
+    EXPECT_TRUE(pipeline.try_submit_upload_chunk(create_pipeline_chunk(large, 0, large_data)));
+    EXPECT_FALSE(pipeline.try_submit_upload_chunk(create_pipeline_chunk(large, 1, data)));
+
+    gate.open();
+    (void)pipeline.stop();
+}
+
+TEST_F(ServerPipelineTest, OfferKeepsChunkUntilCapacityFrees) {
+    pipeline_config config;
+    config.io_workers = 1;
+    config.compression_workers = 1;
+    config.network_workers = 1;
+    config.queue_size = 2;
+
+    auto pipeline_result = server_pipeline::create(config);
+    ASSERT_TRUE(pipeline_result.has_value());
+    auto& pipeline = pipeline_result.value();
+
+    // Declared after the pipeline so it opens before the pipeline is torn down
+    write_gate gate;
+    pipeline.on_upload_complete([&](const transfer_id&, uint64_t) { gate.wait(); });
+    std::atomic<int> freed{0};
+    pipeline.on_upload_capacity([&] { freed++; });
+
+    ASSERT_TRUE(pipeline.start().has_value());
+
+    auto id = transfer_id::generate();
+    std::vector<std::byte> data(100, std::byte{0x42});
+    for (uint64_t i = 0; i < config.queue_size; ++i) {
+        auto chunk = create_pipeline_chunk(id, i, data);
+        ASSERT_TRUE(pipeline.offer_upload_chunk(chunk));
+    }
+
+    // A full window leaves the chunk with the caller
+    auto held = create_pipeline_chunk(id, 2, data);
+    EXPECT_FALSE(pipeline.offer_upload_chunk(held));
+    EXPECT_EQ(held.data.size(), data.size());
+    EXPECT_EQ(held.chunk_index, 2u);
+
+    gate.open();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (freed.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_GT(freed.load(), 0);
+    EXPECT_TRUE(pipeline.offer_upload_chunk(held));
+
+    (void)pipeline.stop();
+}
+
+#ifdef FILE_TRANS_ENABLE_LZ4
+TEST_F(ServerPipelineTest, RebuiltChunkReleasesLinkedStreamChunks) {
+    pipeline_config config;
+    config.io_workers = 1;
+    config.compression_workers = 1;
+    config.network_workers = 1;
+
+    auto pipeline_result = server_pipeline::create(config);
+    ASSERT_TRUE(pipeline_result.has_value());
+    auto& pipeline = pipeline_result.value();
+
+    std::mutex mutex;
+    std::set<uint64_t> written;
+    std::atomic<int> errors{0};
+    pipeline.on_stage_complete([&](pipeline_stage stage, const pipeline_chunk& chunk) {
+        if (stage == pipeline_stage::file_write) {
+            std::lock_guard lock(mutex);
+            written.insert(chunk.chunk_index);
+        }
+    });
+    pipeline.on_chunk_error([&](pipeline_stage, const pipeline_chunk&, const std::string&) {
+        errors++;
+    });
+    ASSERT_TRUE(pipeline.start().has_value());
+
+    // Repetitive text, so chunks 1 and 2 refer back to the chunks before them
+    auto id = transfer_id::generate();
+    std::string text;
+    while (text.size() < 3 * 4096) {
+        text += "INFO chunk " + std::to_string(text.size() % 97) + " written\n";
+    }
+    std::vector<chunk> originals(3);
+    for (uint64_t i = 0; i < originals.size(); ++i) {
+        auto& c = originals[i];
+        c.header.id = id;
+        c.header.chunk_index = i;
+        c.header.chunk_offset = i * 4096;
+        c.header.original_size = 4096;
+        c.header.compressed_size = 4096;
+        auto begin = reinterpret_cast<const std::byte*>(text.data()) + i * 4096;
+        c.data.assign(begin, begin + 4096);
+    }
+    stream_compressor compressor;
+    auto sent = originals;
+    for (auto& c : sent) {
+        ASSERT_TRUE(compressor.compress(c, compression_mode::enabled).has_value());
+    }
+    ASSERT_TRUE(is_linked(sent[1].header.flags));
+    ASSERT_TRUE(is_linked(sent[2].header.flags));
+
+    // Chunk 0 is lost; the chunks after it wait for its history
+    pipeline.open_stream(id);
+    for (uint64_t i : {1, 2}) {
+        pipeline_chunk pc(sent[i]);
+        pc.checksum = checksum::crc32(std::span<const std::byte>(originals[i].data));
+        pc.integrity = chunk_integrity::crc32;
+        ASSERT_TRUE(pipeline.submit_upload_chunk(std::move(pc)).has_value());
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    {
+        std::lock_guard lock(mutex);
+        EXPECT_TRUE(written.empty());
+    }
+
+    // Rebuilt from parity instead, it releases both
+    pipeline.record_rebuilt_chunk(id, originals[0]);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline) {
+        {
+            std::lock_guard lock(mutex);
+            if (written.size() == 2) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    {
+        std::lock_guard lock(mutex);
+        EXPECT_EQ(written, (std::set<uint64_t>{1, 2}));
+    }
+    EXPECT_EQ(errors.load(), 0);
+
+    pipeline.close_stream(id);
+    (void)pipeline.stop();
+}
+#endif
+
+TEST_F(ServerPipelineTest, SmallUploadNotQueuedBehindBulkUpload) {
+    pipeline_config config;
+    config.io_workers = 1;
+    config.compression_workers = 1;
+    config.network_workers = 1;
+    config.queue_size = 32;
+    config.dispatch_limit = 1;
+    config.scheduler_quantum = 4096;  // One chunk per round
+
+    auto pipeline_result = server_pipeline::create(config);
+    ASSERT_TRUE(pipeline_result.has_value());
+    auto& pipeline = pipeline_result.value();
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool open = false;
+    std::vector<transfer_id> completed;
+    pipeline.on_upload_complete([&](const transfer_id& id, uint64_t) {
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [&] { return open; });
+        completed.push_back(id);
+        cv.notify_all();
+    });
+
+    ASSERT_TRUE(pipeline.start().has_value());
+
+    auto bulk = transfer_id::generate();
+    auto small = transfer_id::generate();
+    std::vector<std::byte> data(4096, std::byte{0x5A});
+    for (uint64_t i = 0; i < 20; ++i) {
+        auto chunk = create_pipeline_chunk(bulk, i, data);
+        chunk.client = client_id{1};
+        ASSERT_TRUE(pipeline.submit_upload_chunk(std::move(chunk)).has_value());
+    }
+    auto chunk = create_pipeline_chunk(small, 0, data);
+    chunk.client = client_id{2};
+    ASSERT_TRUE(pipeline.submit_upload_chunk(std::move(chunk)).has_value());
+
+    auto stats = pipeline.flow_statistics();
+    EXPECT_EQ(stats.size(), 2);
+
+    {
+        std::unique_lock lock(mutex);
+        open = true;
+        cv.notify_all();
+        ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(10),
+                                [&] { return completed.size() == 21; }));
+    }
+
+    auto position = std::find(completed.begin(), completed.end(), small) - completed.begin();
+    EXPECT_LE(position, 2);
+    EXPECT_EQ(pipeline.upload_in_flight(), 0);
+
+    pipeline.close_transfer(bulk);
+    pipeline.close_transfer(small);
+    EXPECT_TRUE(pipeline.flow_statistics().empty());
+
+    (void)pipeline.stop();
+}
+
+TEST_F(ServerPipelineTest, WriteStageStoresChunksThroughAssembler) {
+    pipeline_config config;
+    config.io_workers = 1;
+    config.compression_workers = 2;
+    config.network_workers = 1;
+    config.queue_size = 8;
+
+    auto pipeline_result = server_pipeline::create(config);
+    ASSERT_TRUE(pipeline_result.has_value());
+    auto& pipeline = pipeline_result.value();
+
+    auto assembler = std::make_shared<chunk_assembler>(test_dir_);
+    pipeline.set_chunk_assembler(assembler);
+
+    std::atomic<int> written{0};
+    pipeline.on_upload_complete([&](const transfer_id&, uint64_t) { written++; });
+
+    ASSERT_TRUE(pipeline.start().has_value());
+
+    constexpr std::size_t chunk_size = 4096;
+    constexpr uint64_t chunk_count = 6;
+    auto id = transfer_id::generate();
+    ASSERT_TRUE(assembler->start_session(id, "assembled.bin",
+                                         chunk_size * chunk_count, chunk_count).has_value());
+
+    std::vector<std::byte> expected(chunk_size * chunk_count);
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        expected[i] = static_cast<std::byte>((i * 13) % 256);
+    }
+    // Submit out of order; the write stage places chunks by offset
+    for (uint64_t index : {3, 0, 5, 1, 4, 2}) {
+        std::vector<std::byte> data(expected.begin() + index * chunk_size,
+                                    expected.begin() + (index + 1) * chunk_size);
+        auto chunk = create_pipeline_chunk(id, index, data);
+        chunk.chunk_offset = index * chunk_size;
+        ASSERT_TRUE(pipeline.submit_upload_chunk(std::move(chunk),
+                                                 std::chrono::seconds(5)).has_value());
+    }
+
+    for (int i = 0; i < 200 && written.load() < static_cast<int>(chunk_count); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(assembler->is_complete(id));
+
+    // Checked once by the verify stage; the assembler does not check again
+    EXPECT_EQ(pipeline.stats().checksums_verified, chunk_count);
+    EXPECT_EQ(pipeline.stats().checksums_skipped, chunk_count);
+    EXPECT_EQ(pipeline.stats().checksum_bytes_skipped, chunk_size * chunk_count);
+    EXPECT_GT(pipeline.stats().integrity_cpu_saved_ns, 0);
+
+    auto path = assembler->finalize(id);
+    ASSERT_TRUE(path.has_value());
+    std::ifstream file(path.value(), std::ios::binary);
+    std::vector<char> contents((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+    ASSERT_EQ(contents.size(), expected.size());
+    EXPECT_EQ(std::memcmp(contents.data(), expected.data(), expected.size()), 0);
+
+    (void)pipeline.stop();
+}
+
+TEST_F(ServerPipelineTest, ChunkErrorCallbackIdentifiesChunk) {
+    pipeline_config config;
+    config.io_workers = 1;
+    config.compression_workers = 1;
+    config.network_workers = 1;
+    config.queue_size = 4;
+
+    auto pipeline_result = server_pipeline::create(config);
+    ASSERT_TRUE(pipeline_result.has_value());
+    auto& pipeline = pipeline_result.value();
+
+    std::atomic<uint64_t> failed_index{0};
+    std::atomic<int> failures{0};
+    pipeline.on_chunk_error([&](pipeline_stage stage, const pipeline_chunk& chunk,
+                                const std::string&) {
+        EXPECT_EQ(stage, pipeline_stage::chunk_verify);
+        failed_index = chunk.chunk_index;
+        failures++;
+    });
+
+    ASSERT_TRUE(pipeline.start().has_value());
+
+    std::vector<std::byte> data(100, std::byte{0x42});
+    auto chunk = create_pipeline_chunk(transfer_id::generate(), 7, data);
+    chunk.checksum ^= 1;
+    ASSERT_TRUE(pipeline.submit_upload_chunk(std::move(chunk)).has_value());
+
+    for (int i = 0; i < 100 && failures.load() == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(failures.load(), 1);
+    EXPECT_EQ(failed_index.load(), 7);
+
+    // The failed chunk no longer occupies the upload window
+    for (int i = 0; i < 100 && pipeline.upload_in_flight() > 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(pipeline.upload_in_flight(), 0);
+
+    (void)pipeline.stop();
+}
+
+// Bandwidth shaping tests
+
+TEST_F(ServerPipelineTest, ThrottledSendsDoNotPinWorkers) {
+    pipeline_config config;
+    config.io_workers = 1;
+    config.compression_workers = 1;
+    config.network_workers = 1;
+    config.queue_size = 16;
+    config.send_bandwidth_limit = 64 * 1024;  // 16KB chunks: ~4 per second
+
+    auto pipeline_result = server_pipeline::create(config);
+    ASSERT_TRUE(pipeline_result.has_value());
+    auto& pipeline = pipeline_result.value();
+
+    std::atomic<int> sent{0};
+    std::atomic<int> written{0};
+    pipeline.on_download_ready([&](const pipeline_chunk&) { sent++; });
+    pipeline.on_upload_complete([&](const transfer_id&, uint64_t) { written++; });
+    ASSERT_TRUE(pipeline.start().has_value());
+
+    auto file_path = create_test_file("shaped_download.bin", 8 * 16384);
+    auto download = transfer_id::generate();
+    for (uint64_t i = 0; i < 8; ++i) {
+        ASSERT_TRUE(pipeline.submit_download_request(download, i, file_path, i * 16384, 16384,
+                                                     client_id{1}).has_value());
+    }
+    for (int i = 0; i < 100 && pipeline.send_shaping_stats().waiting == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_GT(pipeline.send_shaping_stats().waiting, 0);
+
+    // With every worker blocked on tokens this upload would wait seconds
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::byte> data(1024, std::byte{0x33});
+    ASSERT_TRUE(pipeline.submit_upload_chunk(
+        create_pipeline_chunk(transfer_id::generate(), 0, data)).has_value());
+    for (int i = 0; i < 200 && written.load() == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(written.load(), 1);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+    EXPECT_LT(sent.load(), 8);
+
+    for (int i = 0; i < 400 && sent.load() < 8; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(sent.load(), 8);
+    auto stats = pipeline.send_shaping_stats();
+    EXPECT_GT(stats.parked, 0);
+    EXPECT_EQ(stats.released, stats.parked);
+
+    (void)pipeline.stop();
+}
+
+TEST_F(ServerPipelineTest, ThrottledUploadsParkInsteadOfBlockingSubmit) {
+    pipeline_config config;
+    config.io_workers = 1;
+    config.compression_workers = 1;
+    config.network_workers = 1;
+    config.queue_size = 16;
+
+    auto pipeline_result = server_pipeline::create(config);
+    ASSERT_TRUE(pipeline_result.has_value());
+    auto& pipeline = pipeline_result.value();
+    pipeline.set_client_recv_limits(client_id{5}, {0, 128 * 1024});
+    EXPECT_EQ(pipeline.get_recv_bandwidth_limit(), 0);
+
+    std::atomic<int> written{0};
+    pipeline.on_upload_complete([&](const transfer_id&, uint64_t) { written++; });
+    ASSERT_TRUE(pipeline.start().has_value());
+
+    // 8 x 16KB at 128KB/s takes about a second to admit
+    auto id = transfer_id::generate();
+    std::vector<std::byte> data(16384, std::byte{0x44});
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < 8; ++i) {
+        auto chunk = create_pipeline_chunk(id, i, data);
+        chunk.client = client_id{5};
+        ASSERT_TRUE(pipeline.submit_upload_chunk(std::move(chunk),
+                                                 std::chrono::seconds(5)).has_value());
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+    EXPECT_GT(pipeline.recv_shaping_stats().waiting, 0);
+    EXPECT_GE(pipeline.upload_in_flight(), 6);  // The first chunk fits the burst
+
+    for (int i = 0; i < 300 && written.load() < 8; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(written.load(), 8);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(700));
+
+    // Another client is not held back by client 5's ceiling
+    ASSERT_TRUE(pipeline.try_submit_upload_chunk(
+        create_pipeline_chunk(transfer_id::generate(), 0, data)));
+    EXPECT_EQ(pipeline.recv_shaping_stats().waiting, 0);
+
+    (void)pipeline.stop();
+}
+
 // Move semantics tests
 
 TEST_F(ServerPipelineTest, MoveConstruction) {
@@ -532,11 +1114,39 @@ TEST_F(ServerPipelineTest, PipelineChunkFromChunk) {
     EXPECT_EQ(pc.id, c.header.id);
     EXPECT_EQ(pc.chunk_index, 42);
     EXPECT_EQ(pc.checksum, 0x12345678);
+    EXPECT_EQ(pc.integrity, chunk_integrity::crc32);
     EXPECT_EQ(pc.original_size, 100);
     EXPECT_FALSE(pc.is_compressed);
     EXPECT_EQ(pc.data.size(), 100);
 }
 
+TEST_F(ServerPipelineTest, PipelineChunkKeeps64BitDigest) {
+    chunk c;
+    c.header.id = transfer_id::generate();
+    c.set_digest(chunk_integrity::xxh3_64, 0xFEDCBA9876543210ULL);
+
+    pipeline_chunk pc(c);
+    EXPECT_EQ(pc.integrity, chunk_integrity::xxh3_64);
+    EXPECT_EQ(pc.checksum, 0xFEDCBA9876543210ULL);
+
+    pipeline_chunk copy(pc);
+    EXPECT_EQ(copy.integrity, chunk_integrity::xxh3_64);
+    EXPECT_EQ(copy.checksum, pc.checksum);
+}
+
+TEST_F(ServerPipelineTest, PipelineChunkCarriesVerifiedChecks) {
+    pipeline_chunk chunk;
+    EXPECT_EQ(chunk.verified, integrity_check::none);
+
+    chunk.verified |= integrity_check::aead_tag;
+    pipeline_chunk copy(chunk);
+    EXPECT_TRUE(has_check(copy.verified, integrity_check::aead_tag));
+
+    pipeline_chunk assigned;
+    assigned = chunk;
+    EXPECT_EQ(assigned.verified, integrity_check::aead_tag);
+}
+
 TEST_F(ServerPipelineTest, PipelineChunkFromCompressedChunk) {
     chunk c;
     c.header.id = transfer_id::generate();
@@ -616,6 +1226,28 @@ TEST_F(ServerPipelineTest, EncryptionStatsReset) {
     EXPECT_EQ(pipeline.stats().encryption_bytes, 0);
 }
 
+TEST_F(ServerPipelineTest, IntegrityStatsReset) {
+    auto pipeline_result = server_pipeline::create(pipeline_config{});
+    ASSERT_TRUE(pipeline_result.has_value());
+    auto& pipeline = pipeline_result.value();
+
+    EXPECT_EQ(pipeline.stats().checksums_verified, 0);
+    EXPECT_EQ(pipeline.stats().checksums_skipped, 0);
+
+    auto& stats = const_cast<pipeline_stats&>(pipeline.stats());
+    stats.checksums_verified = 4;
+    stats.checksums_skipped = 3;
+    stats.checksum_bytes_skipped = 3000;
+    stats.integrity_cpu_saved_ns = 120;
+
+    pipeline.reset_stats();
+
+    EXPECT_EQ(pipeline.stats().checksums_verified, 0);
+    EXPECT_EQ(pipeline.stats().checksums_skipped, 0);
+    EXPECT_EQ(pipeline.stats().checksum_bytes_skipped, 0);
+    EXPECT_EQ(pipeline.stats().integrity_cpu_saved_ns, 0);
+}
+
 TEST_F(ServerPipelineTest, QueueSizesIncludeEncryption) {
     pipeline_config config;
     config.enable_encryption = true;
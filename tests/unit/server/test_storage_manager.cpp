@@ -7,6 +7,7 @@
 
 #include <kcenon/file_transfer/server/storage_manager.h>
 
+#include <atomic>
 #include <chrono>
 #include <filesystem>
 #include <fstream>
@@ -15,6 +16,90 @@
 
 namespace kcenon::file_transfer::test {
 
+/**
+ * @brief Local directory posing as a cloud backend
+ *
+ * Reports a cloud backend type, tags objects with an ETag that changes on
+ * every write, and counts object downloads.
+ */
+class remote_backend_stub : public storage_backend {
+public:
+    explicit remote_backend_stub(const std::filesystem::path& root)
+        : local_(local_storage_backend::create(root)) {}
+
+    std::atomic<int> downloads{0};
+    std::atomic<bool> offline{false};
+
+    auto type() const -> storage_backend_type override { return storage_backend_type::cloud_s3; }
+    auto name() const -> std::string_view override { return "remote_stub"; }
+    auto is_available() const -> bool override { return local_->is_available(); }
+    auto connect() -> result<void> override { return local_->connect(); }
+    auto disconnect() -> result<void> override { return local_->disconnect(); }
+
+    auto store(const std::string& key, std::span<const std::byte> data,
+               const store_options& options) -> result<store_result> override {
+        if (offline) return unexpected{error{error_code::connection_failed, "offline"}};
+        ++version_;
+        return local_->store(key, data, options);
+    }
+    auto store_file(const std::string& key, const std::filesystem::path& file_path,
+                    const store_options& options) -> result<store_result> override {
+        if (offline) return unexpected{error{error_code::connection_failed, "offline"}};
+        ++version_;
+        return local_->store_file(key, file_path, options);
+    }
+    auto retrieve(const std::string& key, const retrieve_options& options)
+        -> result<std::vector<std::byte>> override {
+        ++downloads;
+        return local_->retrieve(key, options);
+    }
+    auto retrieve_file(const std::string& key, const std::filesystem::path& file_path,
+                       const retrieve_options& options) -> result<retrieve_result> override {
+        ++downloads;
+        return local_->retrieve_file(key, file_path, options);
+    }
+    auto remove(const std::string& key) -> result<void> override {
+        if (offline) return unexpected{error{error_code::connection_failed, "offline"}};
+        return local_->remove(key);
+    }
+    auto exists(const std::string& key) -> result<bool> override { return local_->exists(key); }
+    auto get_metadata(const std::string& key) -> result<stored_object_metadata> override {
+        auto metadata = local_->get_metadata(key);
+        if (metadata.has_value()) {
+            metadata.value().etag = "\"v" + std::to_string(version_.load()) + "\"";
+        }
+        return metadata;
+    }
+    auto list(const list_storage_options& options) -> result<list_storage_result> override {
+        return local_->list(options);
+    }
+    auto store_async(const std::string& key, std::span<const std::byte> data,
+                     const store_options& options) -> std::future<result<store_result>> override {
+        return local_->store_async(key, data, options);
+    }
+    auto store_file_async(const std::string& key, const std::filesystem::path& file_path,
+                          const store_options& options)
+        -> std::future<result<store_result>> override {
+        return local_->store_file_async(key, file_path, options);
+    }
+    auto retrieve_async(const std::string& key, const retrieve_options& options)
+        -> std::future<result<std::vector<std::byte>>> override {
+        return local_->retrieve_async(key, options);
+    }
+    auto retrieve_file_async(const std::string& key, const std::filesystem::path& file_path,
+                             const retrieve_options& options)
+        -> std::future<result<retrieve_result>> override {
+        return local_->retrieve_file_async(key, file_path, options);
+    }
+    void on_progress(std::function<void(const storage_progress&)> callback) override {
+        local_->on_progress(std::move(callback));
+    }
+
+private:
+    std::unique_ptr<local_storage_backend> local_;
+    std::atomic<int> version_{0};
+};
+
 class StorageManagerTest : public ::testing::Test {
 protected:
     static constexpr uint64_t MB = 1024 * 1024;
@@ -198,6 +283,80 @@ TEST_F(StorageManagerTest, LocalBackend_ListWithPrefix) {
     EXPECT_EQ(list_result.value().objects.size(), 2);
 }
 
+TEST_F(StorageManagerTest, LocalBackend_ListSortedAndPaginated) {
+    auto backend = local_storage_backend::create(test_dir_);
+    ASSERT_NE(backend, nullptr);
+    ASSERT_TRUE(backend->connect().has_value());
+
+    backend->store("b.bin", create_test_data(300));
+    backend->store("a.bin", create_test_data(100));
+    backend->store("c.bin", create_test_data(200));
+
+    list_storage_options options;
+    options.sort_by = storage_sort_field::size;
+    options.descending = true;
+    options.max_results = 2;
+
+    auto first_page = backend->list(options);
+    ASSERT_TRUE(first_page.has_value());
+    ASSERT_EQ(first_page.value().objects.size(), 2);
+    EXPECT_EQ(first_page.value().objects[0].key, "b.bin");
+    EXPECT_EQ(first_page.value().objects[1].key, "c.bin");
+    ASSERT_TRUE(first_page.value().is_truncated);
+
+    options.continuation_token = first_page.value().continuation_token;
+    auto second_page = backend->list(options);
+    ASSERT_TRUE(second_page.has_value());
+    ASSERT_EQ(second_page.value().objects.size(), 1);
+    EXPECT_EQ(second_page.value().objects[0].key, "a.bin");
+    EXPECT_FALSE(second_page.value().is_truncated);
+}
+
+TEST_F(StorageManagerTest, LocalBackend_IndexSurvivesReconnect) {
+    {
+        auto backend = local_storage_backend::create(test_dir_);
+        ASSERT_TRUE(backend->connect().has_value());
+
+        store_options opts;
+        opts.tier = storage_tier::warm;
+        opts.content_type = "application/octet-stream";
+        backend->store("kept.bin", create_test_data(100), opts);
+        backend->store("removed.bin", create_test_data(100));
+        backend->remove("removed.bin");
+        backend->disconnect();
+    }
+
+    auto backend = local_storage_backend::create(test_dir_);
+    ASSERT_TRUE(backend->connect().has_value());
+
+    auto list_result = backend->list();
+    ASSERT_TRUE(list_result.has_value());
+    ASSERT_EQ(list_result.value().objects.size(), 1);
+    EXPECT_EQ(list_result.value().objects[0].key, "kept.bin");
+
+    auto meta = backend->get_metadata("kept.bin");
+    ASSERT_TRUE(meta.has_value());
+    EXPECT_EQ(meta.value().tier, storage_tier::warm);
+    EXPECT_EQ(meta.value().content_type, "application/octet-stream");
+}
+
+TEST_F(StorageManagerTest, LocalBackend_RebuildIndexPicksUpExternalFiles) {
+    auto backend = local_storage_backend::create(test_dir_);
+    ASSERT_TRUE(backend->connect().has_value());
+
+    create_test_file("external.bin", 64);
+    ASSERT_EQ(backend->list().value().objects.size(), 0);
+
+    auto rebuilt = backend->rebuild_index();
+    ASSERT_TRUE(rebuilt.has_value());
+    EXPECT_EQ(rebuilt.value(), 1);
+
+    auto list_result = backend->list();
+    ASSERT_TRUE(list_result.has_value());
+    ASSERT_EQ(list_result.value().objects.size(), 1);
+    EXPECT_EQ(list_result.value().objects[0].size, 64);
+}
+
 TEST_F(StorageManagerTest, LocalBackend_StoreOverwriteProtection) {
     auto backend = local_storage_backend::create(test_dir_);
     ASSERT_NE(backend, nullptr);
@@ -496,6 +655,34 @@ TEST_F(StorageManagerTest, Manager_ErrorCallback) {
     // Error callback should be triggered
 }
 
+TEST_F(StorageManagerTest, Manager_ObjectEventCallback) {
+    storage_manager_config config;
+    config.primary_backend = local_storage_backend::create(test_dir_);
+    config.track_access = true;
+
+    auto manager = storage_manager::create(config);
+    ASSERT_TRUE(manager->initialize().has_value());
+
+    std::vector<std::pair<storage_operation, std::string>> events;
+    manager->on_object_event([&events](storage_operation operation, const std::string& key) {
+        events.emplace_back(operation, key);
+    });
+
+    ASSERT_TRUE(manager->store("event.bin", create_test_data(KB)).has_value());
+    ASSERT_TRUE(manager->retrieve("event.bin").has_value());
+    ASSERT_TRUE(manager->change_tier("event.bin", storage_tier::cold).has_value());
+    ASSERT_TRUE(manager->remove("event.bin").has_value());
+    EXPECT_FALSE(manager->retrieve("event.bin").has_value());
+
+    std::vector<std::pair<storage_operation, std::string>> expected{
+        {storage_operation::store, "event.bin"},
+        {storage_operation::retrieve, "event.bin"},
+        {storage_operation::store, "event.bin"},
+        {storage_operation::remove, "event.bin"},
+    };
+    EXPECT_EQ(events, expected);
+}
+
 TEST_F(StorageManagerTest, Manager_Shutdown) {
     auto backend = local_storage_backend::create(test_dir_);
 
@@ -536,4 +723,259 @@ TEST_F(StorageManagerTest, Manager_ChangeTier) {
     ASSERT_TRUE(meta.has_value());
 }
 
+TEST_F(StorageManagerTest, Manager_ChangeTierOnLocalKeepsFileInPlace) {
+    storage_manager_config config;
+    config.primary_backend = local_storage_backend::create(test_dir_ / "local");
+
+    auto manager = storage_manager::create(config);
+    ASSERT_TRUE(manager->initialize().has_value());
+
+    auto data = create_test_data(64 * KB);
+    ASSERT_TRUE(manager->store("big.bin", data).has_value());
+    auto path = test_dir_ / "local" / "big.bin";
+    auto mtime_before = std::filesystem::last_write_time(path);
+
+    ASSERT_TRUE(manager->change_tier("big.bin", storage_tier::warm).has_value());
+
+    auto meta = manager->get_metadata("big.bin");
+    ASSERT_TRUE(meta.has_value());
+    EXPECT_EQ(meta.value().tier, storage_tier::warm);
+    EXPECT_EQ(meta.value().size, data.size());
+    EXPECT_EQ(std::filesystem::last_write_time(path), mtime_before);
+    EXPECT_EQ(manager->retrieve("big.bin").value(), data);
+    EXPECT_EQ(manager->get_statistics().tier_change_count, 1);
+}
+
+TEST_F(StorageManagerTest, Manager_ChangeTierPullsFromSecondary) {
+    auto remote = std::make_shared<remote_backend_stub>(test_dir_ / "remote");
+
+    storage_manager_config config;
+    config.primary_backend = local_storage_backend::create(test_dir_ / "local");
+    config.secondary_backend = remote;
+    config.hybrid_storage = true;
+
+    auto manager = storage_manager::create(config);
+    ASSERT_TRUE(manager->initialize().has_value());
+
+    auto data = create_test_data(3 * KB);
+    ASSERT_TRUE(remote->store("only_remote.bin", data, {}).has_value());
+
+    ASSERT_TRUE(manager->change_tier("only_remote.bin", storage_tier::cold).has_value());
+    auto local = manager->primary_backend().retrieve("only_remote.bin");
+    ASSERT_TRUE(local.has_value());
+    EXPECT_EQ(local.value(), data);
+    EXPECT_EQ(manager->get_metadata("only_remote.bin").value().tier, storage_tier::cold);
+
+    EXPECT_FALSE(manager->change_tier("missing.bin", storage_tier::cold).has_value());
+}
+
+TEST_F(StorageManagerTest, Manager_CopyBetweenBackends) {
+    auto remote = std::make_shared<remote_backend_stub>(test_dir_ / "remote");
+
+    storage_manager_config config;
+    config.primary_backend = local_storage_backend::create(test_dir_ / "local");
+    config.secondary_backend = remote;
+
+    auto manager = storage_manager::create(config);
+    ASSERT_TRUE(manager->initialize().has_value());
+
+    auto data = create_test_data(200 * KB);
+    ASSERT_TRUE(manager->store("a.bin", data).has_value());
+    ASSERT_TRUE(manager->copy_between_backends(
+        "a.bin", storage_backend_type::local, storage_backend_type::cloud_s3).has_value());
+    EXPECT_EQ(remote->retrieve("a.bin", {}).value(), data);
+
+    auto other = create_test_data(5 * KB);
+    ASSERT_TRUE(remote->store("b.bin", other, {}).has_value());
+    ASSERT_TRUE(manager->copy_between_backends(
+        "b.bin", storage_backend_type::cloud_s3, storage_backend_type::local).has_value());
+    EXPECT_EQ(manager->primary_backend().retrieve("b.bin").value(), other);
+
+    // Staging files are gone once the copies are committed
+    for (const auto& entry :
+         std::filesystem::recursive_directory_iterator(test_dir_ / "local")) {
+        EXPECT_EQ(entry.path().filename().string().rfind("copy-", 0), std::string::npos)
+            << entry.path();
+    }
+
+    EXPECT_FALSE(manager->copy_between_backends(
+        "missing.bin", storage_backend_type::local, storage_backend_type::cloud_s3).has_value());
+}
+
+// ============================================================================
+// Read cache tests
+// ============================================================================
+
+TEST_F(StorageManagerTest, Manager_ReadCacheServesRepeatedCloudReads) {
+    auto remote = std::make_shared<remote_backend_stub>(test_dir_ / "remote");
+
+    storage_manager_config config;
+    config.primary_backend = remote;
+    config.cache_directory = test_dir_ / "cache";
+
+    auto manager = storage_manager::create(config);
+    ASSERT_TRUE(manager->initialize().has_value());
+
+    auto data = create_test_data(4 * KB);
+    ASSERT_TRUE(manager->store("hot.bin", data).has_value());
+
+    for (int i = 0; i < 3; ++i) {
+        auto read = manager->retrieve("hot.bin");
+        ASSERT_TRUE(read.has_value());
+        EXPECT_EQ(read.value(), data);
+    }
+    auto copied = manager->retrieve_file("hot.bin", test_dir_ / "out" / "hot.bin");
+    ASSERT_TRUE(copied.has_value());
+    EXPECT_EQ(copied.value().bytes_retrieved, data.size());
+    EXPECT_EQ(std::filesystem::file_size(test_dir_ / "out" / "hot.bin"), data.size());
+
+    EXPECT_EQ(remote->downloads.load(), 1);
+    auto stats = manager->get_statistics();
+    EXPECT_EQ(stats.cache_misses, 1);
+    EXPECT_EQ(stats.cache_hits, 3);
+    EXPECT_EQ(stats.cache_bytes, data.size());
+}
+
+TEST_F(StorageManagerTest, Manager_ReadCacheRevalidatesAfterOverwrite) {
+    auto remote = std::make_shared<remote_backend_stub>(test_dir_ / "remote");
+
+    storage_manager_config config;
+    config.primary_backend = remote;
+    config.cache_directory = test_dir_ / "cache";
+
+    auto manager = storage_manager::create(config);
+    ASSERT_TRUE(manager->initialize().has_value());
+
+    store_options overwrite;
+    overwrite.overwrite = true;
+    ASSERT_TRUE(manager->store("obj.bin", create_test_data(100), overwrite).has_value());
+    ASSERT_TRUE(manager->retrieve("obj.bin").has_value());
+
+    auto updated = create_test_data(200);
+    ASSERT_TRUE(manager->store("obj.bin", updated, overwrite).has_value());
+    auto read = manager->retrieve("obj.bin");
+    ASSERT_TRUE(read.has_value());
+    EXPECT_EQ(read.value(), updated);
+    EXPECT_EQ(remote->downloads.load(), 2);
+
+    ASSERT_TRUE(manager->remove("obj.bin").has_value());
+    EXPECT_FALSE(manager->retrieve("obj.bin").has_value());
+    EXPECT_EQ(manager->get_statistics().cache_bytes, 0);
+}
+
+TEST_F(StorageManagerTest, Manager_ReadCacheSkipsLocalBackend) {
+    storage_manager_config config;
+    config.primary_backend = local_storage_backend::create(test_dir_ / "local");
+    config.cache_directory = test_dir_ / "cache";
+
+    auto manager = storage_manager::create(config);
+    ASSERT_TRUE(manager->initialize().has_value());
+    ASSERT_TRUE(manager->store("a.bin", create_test_data(10)).has_value());
+    ASSERT_TRUE(manager->retrieve("a.bin").has_value());
+
+    auto stats = manager->get_statistics();
+    EXPECT_EQ(stats.cache_hits, 0);
+    EXPECT_EQ(stats.cache_misses, 0);
+    EXPECT_FALSE(std::filesystem::exists(test_dir_ / "cache"));
+}
+
+// Polls until the write-behind queue is empty
+static auto wait_replicated(storage_manager& manager) -> bool {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (manager.get_statistics().replication_pending > 0) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    return true;
+}
+
+TEST_F(StorageManagerTest, Manager_WriteBehindReplicatesInBackground) {
+    auto remote = std::make_shared<remote_backend_stub>(test_dir_ / "remote");
+
+    storage_manager_config config;
+    config.primary_backend = local_storage_backend::create(test_dir_ / "local");
+    config.secondary_backend = remote;
+    config.hybrid_storage = true;
+    config.replicate_writes = true;
+    config.async_replication = true;
+
+    auto manager = storage_manager::create(config);
+    ASSERT_TRUE(manager->initialize().has_value());
+
+    auto data = create_test_data(2 * KB);
+    ASSERT_TRUE(manager->store("a.bin", data).has_value());
+    create_test_file("b.bin", 1 * KB);
+    ASSERT_TRUE(manager->store_file("b.bin", test_dir_ / "b.bin").has_value());
+    ASSERT_TRUE(wait_replicated(*manager));
+
+    auto replica = remote->retrieve("a.bin", {});
+    ASSERT_TRUE(replica.has_value());
+    EXPECT_EQ(replica.value(), data);
+    EXPECT_TRUE(remote->exists("b.bin").value());
+    EXPECT_TRUE(std::filesystem::exists(test_dir_ / "local" / ".file_trans_replication"));
+
+    auto stats = manager->get_statistics();
+    EXPECT_EQ(stats.replicated_count, 2);
+    EXPECT_EQ(stats.replication_failures, 0);
+}
+
+TEST_F(StorageManagerTest, Manager_WriteBehindPendingRemoveHidesReplica) {
+    auto remote = std::make_shared<remote_backend_stub>(test_dir_ / "remote");
+
+    storage_manager_config config;
+    config.primary_backend = local_storage_backend::create(test_dir_ / "local");
+    config.secondary_backend = remote;
+    config.hybrid_storage = true;
+    config.replicate_writes = true;
+    config.async_replication = true;
+    config.write_behind.initial_retry_delay = std::chrono::milliseconds(5);
+
+    auto manager = storage_manager::create(config);
+    ASSERT_TRUE(manager->initialize().has_value());
+    ASSERT_TRUE(manager->store("a.bin", create_test_data(100)).has_value());
+    ASSERT_TRUE(wait_replicated(*manager));
+
+    // The replica cannot be updated, so it still holds the removed object
+    remote->offline = true;
+    ASSERT_TRUE(manager->remove("a.bin").has_value());
+    EXPECT_EQ(manager->get_statistics().replication_pending, 1);
+
+    EXPECT_FALSE(manager->retrieve("a.bin").has_value());
+    EXPECT_FALSE(manager->exists("a.bin").value());
+    EXPECT_FALSE(manager->get_metadata("a.bin").has_value());
+    auto listed = manager->list();
+    ASSERT_TRUE(listed.has_value());
+    EXPECT_TRUE(listed.value().objects.empty());
+
+    remote->offline = false;
+    ASSERT_TRUE(wait_replicated(*manager));
+    EXPECT_FALSE(remote->exists("a.bin").value());
+}
+
+TEST_F(StorageManagerTest, Manager_WriteBehindResumesAfterRestart) {
+    auto remote = std::make_shared<remote_backend_stub>(test_dir_ / "remote");
+
+    storage_manager_config config;
+    config.primary_backend = local_storage_backend::create(test_dir_ / "local");
+    config.secondary_backend = remote;
+    config.hybrid_storage = true;
+    config.replicate_writes = true;
+    config.async_replication = true;
+
+    remote->offline = true;
+    {
+        auto manager = storage_manager::create(config);
+        ASSERT_TRUE(manager->initialize().has_value());
+        ASSERT_TRUE(manager->store("a.bin", create_test_data(100)).has_value());
+        ASSERT_TRUE(manager->shutdown().has_value());
+    }
+    EXPECT_FALSE(std::filesystem::exists(test_dir_ / "remote" / "a.bin"));
+
+    remote->offline = false;
+    auto manager = storage_manager::create(config);
+    ASSERT_TRUE(manager->initialize().has_value());
+    ASSERT_TRUE(wait_replicated(*manager));
+    EXPECT_TRUE(remote->exists("a.bin").value());
+}
+
 }  // namespace kcenon::file_transfer::test
@@ -8,6 +8,7 @@
 #include <kcenon/file_transfer/server/storage_policy.h>
 #include <kcenon/file_transfer/server/storage_manager.h>
 
+#include <atomic>
 #include <chrono>
 #include <filesystem>
 #include <fstream>
@@ -438,6 +439,219 @@ TEST_F(StoragePolicyTest, ExecuteDryRun) {
     EXPECT_TRUE(exists.value());
 }
 
+TEST_F(StoragePolicyTest, ExecutePendingRunsActionsConcurrently) {
+    tiering_rule rule;
+    rule.name = "cool_down";
+    rule.trigger = tiering_trigger::size;
+    rule.min_size = 50;
+    rule.target_tier = storage_tier::cold;
+
+    auto policy = storage_policy::builder()
+        .with_rule(rule)
+        .with_max_concurrent_actions(4)
+        .with_bandwidth_limit(64 * MB)
+        .build();
+    policy->attach(*manager_);
+
+    constexpr int object_count = 12;
+    for (int i = 0; i < object_count; ++i) {
+        manager_->store("move_" + std::to_string(i) + ".bin", create_test_data(4 * KB));
+    }
+
+    std::atomic<int> actions{0};
+    policy->on_action([&actions](const std::string&, tiering_action,
+                                 storage_tier, storage_tier to) {
+        EXPECT_EQ(to, storage_tier::cold);
+        ++actions;
+    });
+
+    ASSERT_TRUE(policy->evaluate_all().has_value());
+    auto executed = policy->execute_pending();
+    ASSERT_TRUE(executed.has_value());
+    EXPECT_EQ(executed.value(), object_count);
+    EXPECT_EQ(actions.load(), object_count);
+
+    for (int i = 0; i < object_count; ++i) {
+        auto meta = manager_->get_metadata("move_" + std::to_string(i) + ".bin");
+        ASSERT_TRUE(meta.has_value());
+        EXPECT_EQ(meta.value().tier, storage_tier::cold);
+    }
+    EXPECT_EQ(policy->get_statistics().objects_moved, object_count);
+}
+
+// ============================================================================
+// Incremental evaluation tests
+// ============================================================================
+
+TEST_F(StoragePolicyTest, IncrementalEvaluationTouchesOnlyChangedObjects) {
+    tiering_rule rule;
+    rule.name = "cool_large";
+    rule.trigger = tiering_trigger::size;
+    rule.min_size = 2 * KB;
+    rule.target_tier = storage_tier::cold;
+
+    auto policy = storage_policy::builder()
+        .with_rule(rule)
+        .with_evaluation_shards(4)
+        .build();
+    policy->attach(*manager_);
+
+    for (int i = 0; i < 20; ++i) {
+        auto key = std::string(i % 2 ? "logs/" : "data/") + std::to_string(i) + ".bin";
+        manager_->store(key, create_test_data(KB));
+    }
+
+    // The first pass indexes everything
+    auto first = policy->evaluate_incremental();
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(first.value().size(), 20);
+
+    // Nothing changed since
+    auto idle = policy->evaluate_incremental();
+    ASSERT_TRUE(idle.has_value());
+    EXPECT_TRUE(idle.value().empty());
+
+    store_options overwrite;
+    overwrite.overwrite = true;
+    manager_->store("data/0.bin", create_test_data(4 * KB), overwrite);
+    manager_->store("new.bin", create_test_data(KB));
+    manager_->remove("logs/1.bin");
+
+    auto changed = policy->evaluate_incremental();
+    ASSERT_TRUE(changed.has_value());
+    ASSERT_EQ(changed.value().size(), 2);
+    for (const auto& evaluated : changed.value()) {
+        if (evaluated.key == "data/0.bin") {
+            EXPECT_EQ(evaluated.target_tier, storage_tier::cold);
+        } else {
+            EXPECT_EQ(evaluated.key, "new.bin");
+            EXPECT_EQ(evaluated.target_tier, evaluated.current_tier);
+        }
+    }
+    EXPECT_EQ(policy->get_statistics().objects_evaluated, 22);
+
+    // Executing the move re-tiers the object, which is evaluated once more
+    auto executed = policy->execute_pending();
+    ASSERT_TRUE(executed.has_value());
+    EXPECT_EQ(executed.value(), 1);
+    auto settled = policy->evaluate_incremental();
+    ASSERT_TRUE(settled.has_value());
+    ASSERT_EQ(settled.value().size(), 1);
+    EXPECT_EQ(settled.value()[0].current_tier, storage_tier::cold);
+}
+
+TEST_F(StoragePolicyTest, IncrementalEvaluationTracksAccessCounts) {
+    tiering_rule rule;
+    rule.name = "demote_idle";
+    rule.trigger = tiering_trigger::access_pattern;
+    rule.source_tier = storage_tier::hot;
+    rule.max_access_count = 2;
+    rule.target_tier = storage_tier::warm;
+
+    auto policy = storage_policy::builder()
+        .with_rule(rule)
+        .build();
+    policy->attach(*manager_);
+
+    manager_->store("busy.bin", create_test_data(KB));
+    manager_->store("idle.bin", create_test_data(KB));
+
+    auto first = policy->evaluate_incremental();
+    ASSERT_TRUE(first.has_value());
+    for (const auto& evaluated : first.value()) {
+        EXPECT_EQ(evaluated.target_tier, storage_tier::warm) << evaluated.key;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(manager_->retrieve("busy.bin").has_value());
+    }
+
+    // Only the object that was read is looked at again
+    auto second = policy->evaluate_incremental();
+    ASSERT_TRUE(second.has_value());
+    ASSERT_EQ(second.value().size(), 1);
+    EXPECT_EQ(second.value()[0].key, "busy.bin");
+    EXPECT_EQ(second.value()[0].target_tier, storage_tier::hot);
+
+    auto single = policy->evaluate("busy.bin");
+    ASSERT_TRUE(single.has_value());
+    EXPECT_EQ(single.value().target_tier, storage_tier::hot);
+}
+
+TEST_F(StoragePolicyTest, IncrementalEvaluationWakesObjectsAtAgeThreshold) {
+    tiering_rule rule;
+    rule.name = "cool_old";
+    rule.trigger = tiering_trigger::age;
+    rule.min_age = std::chrono::hours{48};
+    rule.target_tier = storage_tier::cold;
+
+    auto policy = storage_policy::builder()
+        .with_rule(rule)
+        .build();
+    policy->attach(*manager_);
+
+    manager_->store("aging.bin", create_test_data(KB));
+    manager_->store("fresh.bin", create_test_data(KB));
+
+    // Backdate one object to just short of the threshold
+    std::filesystem::last_write_time(
+        test_dir_ / "aging.bin",
+        std::filesystem::file_time_type::clock::now() - std::chrono::hours{48} +
+            std::chrono::milliseconds(500));
+    auto& local = static_cast<local_storage_backend&>(manager_->primary_backend());
+    ASSERT_TRUE(local.rebuild_index().has_value());
+
+    auto first = policy->evaluate_incremental();
+    ASSERT_TRUE(first.has_value());
+    ASSERT_EQ(first.value().size(), 2);
+    for (const auto& evaluated : first.value()) {
+        EXPECT_EQ(evaluated.target_tier, evaluated.current_tier) << evaluated.key;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(700));
+
+    auto second = policy->evaluate_incremental();
+    ASSERT_TRUE(second.has_value());
+    ASSERT_EQ(second.value().size(), 1);
+    EXPECT_EQ(second.value()[0].key, "aging.bin");
+    EXPECT_EQ(second.value()[0].target_tier, storage_tier::cold);
+}
+
+TEST_F(StoragePolicyTest, IncrementalEvaluationRescansAfterRuleChange) {
+    auto policy = storage_policy::builder()
+        .with_evaluation_shards(2)
+        .build();
+    policy->attach(*manager_);
+
+    manager_->store("a.bin", create_test_data(4 * KB));
+    manager_->store("b.bin", create_test_data(KB));
+    ASSERT_TRUE(policy->evaluate_incremental().has_value());
+
+    tiering_rule rule;
+    rule.name = "cool_large";
+    rule.trigger = tiering_trigger::size;
+    rule.min_size = 2 * KB;
+    rule.target_tier = storage_tier::cold;
+    policy->add_rule(rule);
+
+    auto rescan = policy->evaluate_incremental();
+    ASSERT_TRUE(rescan.has_value());
+    ASSERT_EQ(rescan.value().size(), 2);
+    for (const auto& evaluated : rescan.value()) {
+        auto expected = evaluated.key == "a.bin" ? storage_tier::cold : storage_tier::hot;
+        EXPECT_EQ(evaluated.target_tier, expected) << evaluated.key;
+    }
+
+    auto idle = policy->evaluate_incremental();
+    ASSERT_TRUE(idle.has_value());
+    EXPECT_TRUE(idle.value().empty());
+}
+
+TEST_F(StoragePolicyTest, IncrementalEvaluationRequiresAttach) {
+    auto policy = storage_policy::builder().build();
+    EXPECT_FALSE(policy->evaluate_incremental().has_value());
+}
+
 // ============================================================================
 // Statistics tests
 // ============================================================================
@@ -0,0 +1,180 @@
+/**
+ * @file test_stream_copy.cpp
+ * @brief Unit tests for the bounded-memory streaming copy
+ */
+
+#include <gtest/gtest.h>
+
+#include <kcenon/file_transfer/core/bandwidth_limiter.h>
+#include <kcenon/file_transfer/server/stream_copy.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace kcenon::file_transfer::test {
+
+class StreamCopyTest : public ::testing::Test {
+protected:
+    static auto make_data(std::size_t size) -> std::vector<std::byte> {
+        std::vector<std::byte> data(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            data[i] = static_cast<std::byte>((i * 7) % 251);
+        }
+        return data;
+    }
+
+    // Source over `data` handing out at most `max_read` bytes per call
+    auto source_over(const std::vector<std::byte>& data, std::size_t max_read) -> stream_source {
+        return [this, &data, max_read](std::span<std::byte> buffer) -> result<std::size_t> {
+            auto n = std::min({buffer.size(), max_read, data.size() - read_pos_});
+            std::memcpy(buffer.data(), data.data() + read_pos_, n);
+            read_pos_ += n;
+            return n;
+        };
+    }
+
+    std::size_t read_pos_ = 0;
+};
+
+TEST_F(StreamCopyTest, CopiesAllBytesInOrder) {
+    auto data = make_data(100 * 1024 + 17);
+    std::vector<std::byte> out;
+
+    auto copied = stream_copy(source_over(data, 3000),
+        [&](std::span<const std::byte> chunk) -> result<void> {
+            out.insert(out.end(), chunk.begin(), chunk.end());
+            return result<void>();
+        },
+        stream_copy_options{.buffer_size = 8 * 1024, .buffer_count = 3});
+
+    ASSERT_TRUE(copied.has_value());
+    EXPECT_EQ(copied.value(), data.size());
+    EXPECT_EQ(out, data);
+}
+
+TEST_F(StreamCopyTest, OnlyLastChunkIsShort) {
+    auto data = make_data(10 * 1000 + 5);
+    std::vector<std::size_t> sizes;
+
+    auto copied = stream_copy(source_over(data, 333),
+        [&](std::span<const std::byte> chunk) -> result<void> {
+            sizes.push_back(chunk.size());
+            return result<void>();
+        },
+        stream_copy_options{.buffer_size = 1000, .buffer_count = 2});
+
+    ASSERT_TRUE(copied.has_value());
+    ASSERT_EQ(sizes.size(), 11);
+    for (std::size_t i = 0; i + 1 < sizes.size(); ++i) {
+        EXPECT_EQ(sizes[i], 1000);
+    }
+    EXPECT_EQ(sizes.back(), 5);
+}
+
+TEST_F(StreamCopyTest, EmptySourceCopiesNothing) {
+    std::vector<std::byte> data;
+    int writes = 0;
+
+    auto copied = stream_copy(source_over(data, 100),
+        [&](std::span<const std::byte>) -> result<void> {
+            ++writes;
+            return result<void>();
+        });
+
+    ASSERT_TRUE(copied.has_value());
+    EXPECT_EQ(copied.value(), 0);
+    EXPECT_EQ(writes, 0);
+}
+
+TEST_F(StreamCopyTest, ReaderStaysWithinRing) {
+    constexpr std::size_t buffer_size = 1024;
+    constexpr std::size_t buffer_count = 3;
+    auto data = make_data(64 * buffer_size);
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> max_ahead{0};
+
+    auto source = [&](std::span<std::byte> buffer) -> result<std::size_t> {
+        auto n = std::min(buffer.size(), data.size() - read_pos_);
+        std::memcpy(buffer.data(), data.data() + read_pos_, n);
+        read_pos_ += n;
+        auto ahead = read_pos_ - written.load();
+        max_ahead = std::max<uint64_t>(max_ahead.load(), ahead);
+        return n;
+    };
+    auto slow_sink = [&](std::span<const std::byte> chunk) -> result<void> {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        written += chunk.size();
+        return result<void>();
+    };
+
+    auto copied = stream_copy(source, slow_sink,
+        stream_copy_options{.buffer_size = buffer_size, .buffer_count = buffer_count});
+
+    ASSERT_TRUE(copied.has_value());
+    // Filled buffers plus the one being written
+    EXPECT_LE(max_ahead.load(), (buffer_count + 1) * buffer_size);
+}
+
+TEST_F(StreamCopyTest, SourceErrorIsReturned) {
+    int calls = 0;
+    auto failing = [&](std::span<std::byte> buffer) -> result<std::size_t> {
+        if (++calls > 3) {
+            return unexpected{error{error_code::connection_failed, "reset"}};
+        }
+        return buffer.size();
+    };
+
+    auto copied = stream_copy(failing,
+        [](std::span<const std::byte>) -> result<void> { return result<void>(); },
+        stream_copy_options{.buffer_size = 100, .buffer_count = 2});
+
+    ASSERT_FALSE(copied.has_value());
+    EXPECT_EQ(copied.error().code, error_code::connection_failed);
+}
+
+TEST_F(StreamCopyTest, SinkErrorStopsReader) {
+    std::atomic<int> reads{0};
+    auto endless = [&](std::span<std::byte> buffer) -> result<std::size_t> {
+        ++reads;
+        return buffer.size();
+    };
+
+    auto copied = stream_copy(endless,
+        [](std::span<const std::byte>) -> result<void> {
+            return unexpected{error{error_code::file_write_error, "disk full"}};
+        },
+        stream_copy_options{.buffer_size = 100, .buffer_count = 2});
+
+    ASSERT_FALSE(copied.has_value());
+    EXPECT_EQ(copied.error().code, error_code::file_write_error);
+    EXPECT_LE(reads.load(), 3);
+}
+
+TEST_F(StreamCopyTest, SharedLimiterPacesCopies) {
+    // Drain the initial burst so the copy has to wait for refills
+    auto limiter = std::make_shared<bandwidth_limiter>(512 * 1024);
+    limiter->acquire(limiter->bucket_capacity());
+
+    auto data = make_data(128 * 1024);
+    auto start = std::chrono::steady_clock::now();
+    auto copied = stream_copy(source_over(data, data.size()),
+        [](std::span<const std::byte>) -> result<void> { return result<void>(); },
+        stream_copy_options{.buffer_size = 32 * 1024, .buffer_count = 2, .limiter = limiter});
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_TRUE(copied.has_value());
+    // 128KB at 512KB/s
+    EXPECT_GE(elapsed, std::chrono::milliseconds(200));
+}
+
+TEST_F(StreamCopyTest, MissingCallbacksAreRejected) {
+    auto copied = stream_copy({}, {});
+    ASSERT_FALSE(copied.has_value());
+    EXPECT_EQ(copied.error().code, error_code::invalid_configuration);
+}
+
+}  // namespace kcenon::file_transfer::test